@@ -1,4 +1,4 @@
-macro(check_nasm_support _object_format _support_x64 _support_x64_and_avx2 _support_x64_and_avx512)
+macro(check_nasm_support _object_format _support_x64 _support_x64_and_avx2 _support_x64_and_avx512 _support_x64_and_gfni)
   execute_process(
     COMMAND which nasm
     RESULT_VARIABLE no_nasm
@@ -37,6 +37,22 @@ macro(check_nasm_support _object_format _support_x64 _support_x64_and_avx2 _supp
         if(NOT rt)
           set(${_support_x64_and_avx512} TRUE)
         endif()
+        # the GFNI kernels only ship with ISA-L 2.31 and up
+        set(gfni_asm
+          ${CMAKE_SOURCE_DIR}/src/isa-l/erasure_code/gf_vect_dot_prod_avx512_gfni.asm)
+        if(${_support_x64_and_avx512} AND EXISTS ${gfni_asm})
+          execute_process(COMMAND nasm -D HAVE_AS_KNOWS_AVX512 -D AS_FEATURE_LEVEL=10
+            -f ${object_format}
+            -i ${CMAKE_SOURCE_DIR}/src/isa-l/include/
+            ${gfni_asm}
+            -o /dev/null
+            RESULT_VARIABLE rg
+            OUTPUT_QUIET
+            ERROR_QUIET)
+          if(NOT rg)
+            set(${_support_x64_and_gfni} TRUE)
+          endif()
+        endif()
       endif(${_support_x64})
     endif(CMAKE_SYSTEM_PROCESSOR MATCHES "amd64|x86_64")
   endif(NOT no_nasm)
@@ -44,6 +60,8 @@ macro(check_nasm_support _object_format _support_x64 _support_x64_and_avx2 _supp
     message(STATUS "Could NOT find nasm")
   elseif(NOT ${_support_x64})
     message(STATUS "Found nasm: but x86_64 with x32 ABI is not supported")
+  elseif(${_support_x64_and_gfni})
+    message(STATUS "Found nasm: best -- capable of assembling AVX512 and GFNI")
   elseif(${_support_x64_and_avx512})
     message(STATUS "Found nasm: best -- capable of assembling AVX512")
   elseif(${_support_x64_and_avx2})
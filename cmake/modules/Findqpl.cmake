@@ -0,0 +1,27 @@
+# - Find qpl
+# Find the Intel Query Processing Library, used to drive the Intel
+# In-Memory Analytics Accelerator (IAA)
+#
+# qpl_INCLUDE_DIR - where to find qpl/qpl.h, etc.
+# qpl_LIBRARIES - List of libraries when using qpl.
+# qpl_FOUND - True if qpl found.
+
+find_path(qpl_INCLUDE_DIR NAMES qpl/qpl.h)
+find_library(qpl_LIBRARIES NAMES qpl HINTS /usr/local/lib64/)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(qpl DEFAULT_MSG qpl_LIBRARIES qpl_INCLUDE_DIR)
+
+mark_as_advanced(
+  qpl_LIBRARIES
+  qpl_INCLUDE_DIR)
+
+if(qpl_FOUND AND NOT TARGET qpl::qpl)
+  add_library(qpl::qpl UNKNOWN IMPORTED)
+  # the accelerator configuration library is loaded at runtime
+  set_target_properties(qpl::qpl PROPERTIES
+    INTERFACE_INCLUDE_DIRECTORIES "${qpl_INCLUDE_DIR}"
+    INTERFACE_LINK_LIBRARIES "${CMAKE_DL_LIBS}"
+    IMPORTED_LINK_INTERFACE_LANGUAGES "CXX"
+    IMPORTED_LOCATION "${qpl_LIBRARIES}")
+endif()
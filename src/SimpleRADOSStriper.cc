@@ -61,6 +61,10 @@ enum {
   P_SHRINK_BYTES,
   P_LOCK,
   P_UNLOCK,
+  P_CACHE_HIT,
+  P_CACHE_MISS,
+  P_READAHEAD,
+  P_WRITE_COALESCED,
   P_LAST,
 };
 
@@ -75,6 +79,10 @@ int SimpleRADOSStriper::config_logger(CephContext* cct, std::string_view name, s
   plb.add_u64_counter(P_SHRINK_BYTES, "shrink_bytes", "Bytes shrunk");
   plb.add_u64_counter(P_LOCK, "lock", "Number of locks");
   plb.add_u64_counter(P_UNLOCK, "unlock", "Number of unlocks");
+  plb.add_u64_counter(P_CACHE_HIT, "cache_hit", "Blocks read from the cache");
+  plb.add_u64_counter(P_CACHE_MISS, "cache_miss", "Blocks read from RADOS");
+  plb.add_u64_counter(P_READAHEAD, "readahead", "Blocks read ahead");
+  plb.add_u64_counter(P_WRITE_COALESCED, "write_coalesced", "Writes merged into a preceding write");
   l->reset(plb.create_perf_counters());
   return 0;
 }
@@ -93,6 +101,8 @@ SimpleRADOSStriper::~SimpleRADOSStriper()
     if (is_locked()) {
       unlock();
     }
+    flush_wbuf();
+    trim_cache(0);
   }
 }
 
@@ -148,6 +158,11 @@ int SimpleRADOSStriper::truncate(uint64_t size)
     return -EBLOCKLISTED;
   }
 
+  if (int rc = flush_wbuf(); rc < 0) {
+    return rc;
+  }
+  invalidate_cache(size, UINT64_MAX);
+
   /* TODO: (not currently used by SQLite) handle growth + sparse */
   if (int rc = set_metadata(size, true); rc < 0) {
     return rc;
@@ -189,6 +204,10 @@ int SimpleRADOSStriper::flush()
     return -EBLOCKLISTED;
   }
 
+  if (int rc = flush_wbuf(); rc < 0) {
+    return rc;
+  }
+
   if (size_dirty) {
     if (int rc = set_metadata(size, true); rc < 0) {
       return rc;
@@ -441,6 +460,44 @@ int SimpleRADOSStriper::set_metadata(uint64_t new_size, bool update_size)
   return 0;
 }
 
+ssize_t SimpleRADOSStriper::submit_write(const bufferlist& bl, uint64_t off)
+{
+  size_t len = bl.length();
+  size_t w = 0;
+  auto p = bl.begin();
+  while ((len-w) > 0) {
+    auto ext = get_next_extent(off+w, len-w);
+    auto aiocp = aiocompletionptr(librados::Rados::aio_create_completion());
+    bufferlist extbl;
+    p.copy(ext.len, extbl);
+    if (int rc = ioctx.aio_write(ext.soid, aiocp.get(), extbl, ext.len, ext.off); rc < 0) {
+      break;
+    }
+    aios.emplace(std::move(aiocp));
+    w += ext.len;
+  }
+
+  wait_for_aios(false); // clean up finished completions
+
+  return (ssize_t)w;
+}
+
+int SimpleRADOSStriper::flush_wbuf()
+{
+  if (wbuf.length() == 0) {
+    return 0;
+  }
+
+  d(15) << wbuf_off << "~" << wbuf.length() << dendl;
+  bufferlist bl;
+  bl.swap(wbuf);
+  if (ssize_t w = submit_write(bl, wbuf_off); w < (ssize_t)bl.length()) {
+    d(1) << " write failure at " << (wbuf_off+w) << dendl;
+    return -EIO;
+  }
+  return 0;
+}
+
 ssize_t SimpleRADOSStriper::write(const void* data, size_t len, uint64_t off)
 {
   d(5) << off << "~" << len << dendl;
@@ -455,28 +512,44 @@ ssize_t SimpleRADOSStriper::write(const void* data, size_t len, uint64_t off)
     }
   }
 
-  size_t w = 0;
-  while ((len-w) > 0) {
-    auto ext = get_next_extent(off+w, len-w);
-    auto aiocp = aiocompletionptr(librados::Rados::aio_create_completion());
-    bufferlist bl;
-    bl.append((const char*)data+w, ext.len);
-    if (int rc = ioctx.aio_write(ext.soid, aiocp.get(), bl, ext.len, ext.off); rc < 0) {
-      break;
+  invalidate_cache(off, len);
+
+  ssize_t w;
+  if (wbuf_max > 0 && is_locked()) {
+    /* SQLite writes pages one at a time; gather runs of them into larger
+     * writes, which are submitted when the run ends or before anything
+     * that must see them (reads, sync, truncate, unlock).
+     */
+    if (wbuf.length() > 0 && wbuf_off+wbuf.length() != off) {
+      if (int rc = flush_wbuf(); rc < 0) {
+        return rc;
+      }
     }
-    aios.emplace(std::move(aiocp));
-    w += ext.len;
+    if (wbuf.length() == 0) {
+      wbuf_off = off;
+    } else if (logger) {
+      logger->inc(P_WRITE_COALESCED);
+    }
+    wbuf.append((const char*)data, len);
+    if (wbuf.length() >= wbuf_max) {
+      if (int rc = flush_wbuf(); rc < 0) {
+        return rc;
+      }
+    }
+    w = len;
+  } else {
+    bufferlist bl;
+    bl.append((const char*)data, len);
+    w = submit_write(bl, off);
   }
 
-  wait_for_aios(false); // clean up finished completions
-
-  if (size < (len+off)) {
-    size = len+off;
+  if (size < (off+w)) {
+    size = off+w;
     size_dirty = true;
     d(10) << " dirty size: " << size << dendl;
   }
 
-  return (ssize_t)w;
+  return w;
 }
 
 ssize_t SimpleRADOSStriper::read(void* data, size_t len, uint64_t off)
@@ -487,6 +560,15 @@ ssize_t SimpleRADOSStriper::read(void* data, size_t len, uint64_t off)
     return -EBLOCKLISTED;
   }
 
+  /* writes in RADOS are ordered before later reads of the same object */
+  if (int rc = flush_wbuf(); rc < 0) {
+    return rc;
+  }
+
+  if (use_cache()) {
+    return cached_read(data, len, off);
+  }
+
   size_t r = 0;
   // Don't use std::vector to store bufferlists (e.g for parallelizing aio_reads),
   // as they are being moved whenever the vector resizes
@@ -517,6 +599,125 @@ ssize_t SimpleRADOSStriper::read(void* data, size_t len, uint64_t off)
   return r;
 }
 
+void SimpleRADOSStriper::start_block_read(uint64_t b)
+{
+  auto [it, inserted] = cache.try_emplace(b);
+  ceph_assert(inserted);
+  auto& blk = it->second;
+  cache_lru.push_front(b);
+  blk.lru = cache_lru.begin();
+  /* a block never spans objects: cache_block_size <= object_size */
+  auto ext = get_next_extent(b, 1<<cache_block_size);
+  blk.aiocp = aiocompletionptr(librados::Rados::aio_create_completion());
+  if (int rc = ioctx.aio_read(ext.soid, blk.aiocp.get(), &blk.bl, ext.len, ext.off); rc < 0) {
+    d(1) << " read failure: " << cpp_strerror(rc) << dendl;
+    blk.aiocp.reset();
+    cache_lru.erase(blk.lru);
+    cache.erase(it);
+  }
+}
+
+ssize_t SimpleRADOSStriper::cached_read(void* data, size_t len, uint64_t off)
+{
+  const uint64_t bsize = 1<<cache_block_size;
+  const uint64_t first = off & ~(bsize-1);
+  const uint64_t end = off+len;
+
+  /* start all the misses at once, then any readahead */
+  for (uint64_t b = first; b < end; b += bsize) {
+    if (!cache.count(b)) {
+      start_block_read(b);
+      if (logger) {
+        logger->inc(P_CACHE_MISS);
+      }
+    } else if (logger) {
+      logger->inc(P_CACHE_HIT);
+    }
+  }
+  if (readahead_blocks > 0 && off == next_seq_off) {
+    uint64_t b = (end+bsize-1) & ~(bsize-1);
+    for (unsigned i = 0; i < readahead_blocks && b < size; ++i, b += bsize) {
+      if (!cache.count(b)) {
+        d(15) << " readahead " << b << dendl;
+        start_block_read(b);
+        if (logger) {
+          logger->inc(P_READAHEAD);
+        }
+      }
+    }
+  }
+  next_seq_off = end;
+
+  size_t r = 0;
+  for (uint64_t b = first; b < end && r < len; b += bsize) {
+    auto it = cache.find(b);
+    if (it == cache.end()) {
+      return -EIO; /* failed to start the read */
+    }
+    auto& blk = it->second;
+    if (blk.aiocp) {
+      int rc = blk.aiocp->wait_for_complete();
+      if (rc == 0) {
+        rc = blk.aiocp->get_return_value();
+      }
+      blk.aiocp.reset();
+      if (rc < 0) {
+        d(1) << " read failure: " << cpp_strerror(rc) << dendl;
+        cache_lru.erase(blk.lru);
+        cache.erase(it);
+        return rc;
+      }
+    }
+    cache_lru.splice(cache_lru.begin(), cache_lru, blk.lru);
+    uint64_t boff = off+r-b;
+    if (blk.bl.length() <= boff) {
+      break; /* short read */
+    }
+    size_t n = std::min<size_t>(blk.bl.length()-boff, len-r);
+    blk.bl.begin(boff).copy(n, ((char*)data)+r);
+    r += n;
+    if (boff+n < bsize && r < len) {
+      break; /* short read */
+    }
+  }
+
+  trim_cache(cache_max);
+
+  return r;
+}
+
+void SimpleRADOSStriper::invalidate_cache(uint64_t off, uint64_t len)
+{
+  if (cache.empty() || len == 0) {
+    return;
+  }
+  const uint64_t bsize = 1<<cache_block_size;
+  auto it = cache.lower_bound(off & ~(bsize-1));
+  const uint64_t end = len > UINT64_MAX-off ? UINT64_MAX : off+len;
+  while (it != cache.end() && it->first < end) {
+    auto& blk = it->second;
+    if (blk.aiocp) {
+      /* it must not land in a buffer we have freed */
+      blk.aiocp->wait_for_complete();
+    }
+    cache_lru.erase(blk.lru);
+    it = cache.erase(it);
+  }
+}
+
+void SimpleRADOSStriper::trim_cache(uint64_t max)
+{
+  while (!cache_lru.empty() && (cache.size()<<cache_block_size) > max) {
+    auto it = cache.find(cache_lru.back());
+    ceph_assert(it != cache.end());
+    if (it->second.aiocp) {
+      it->second.aiocp->wait_for_complete();
+    }
+    cache_lru.pop_back();
+    cache.erase(it);
+  }
+}
+
 int SimpleRADOSStriper::print_lockers(std::ostream& out)
 {
   int exclusive;
@@ -755,6 +956,10 @@ int SimpleRADOSStriper::unlock()
     return rc;
   }
 
+  /* others may write once we let go */
+  trim_cache(0);
+  next_seq_off = 0;
+
   const auto ext = get_first_extent();
   auto op = librados::ObjectWriteOperation();
   op.cmpxattr(XATTR_EXCL, LIBRADOS_CMPXATTR_OP_EQ, str2bl(myaddrs));
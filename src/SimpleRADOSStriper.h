@@ -15,6 +15,8 @@
 #ifndef _SIMPLERADOSSTRIPER_H
 #define _SIMPLERADOSSTRIPER_H
 
+#include <list>
+#include <map>
 #include <queue>
 #include <string_view>
 #include <thread>
@@ -36,6 +38,7 @@ public:
 
   static inline const uint64_t object_size = 22; /* power of 2 */
   static inline const uint64_t min_growth = (1<<27); /* 128 MB */
+  static inline const uint64_t cache_block_size = 16; /* power of 2 */
   static int config_logger(CephContext* cct, std::string_view name, std::shared_ptr<PerfCounters>* l);
 
   SimpleRADOSStriper() = default;
@@ -79,6 +82,18 @@ public:
   void set_blocklist_the_dead(bool b) {
     blocklist_the_dead = b;
   }
+  /* The read cache and write coalescing are only used while we hold the
+   * (exclusive) lock, so nobody else can change the data under us.
+   */
+  void set_cache_size(uint64_t bytes) {
+    cache_max = bytes;
+  }
+  void set_readahead_blocks(unsigned n) {
+    readahead_blocks = n;
+  }
+  void set_write_coalesce_size(uint64_t bytes) {
+    wbuf_max = bytes;
+  }
 
 protected:
   struct extent {
@@ -98,6 +113,15 @@ protected:
   extent get_first_extent() const {
     return get_next_extent(0, 0);
   }
+  ssize_t submit_write(const ceph::bufferlist& bl, uint64_t off);
+  int flush_wbuf();
+  bool use_cache() const {
+    return cache_max > 0 && is_locked();
+  }
+  ssize_t cached_read(void* data, size_t len, uint64_t off);
+  void start_block_read(uint64_t b);
+  void invalidate_cache(uint64_t off, uint64_t len);
+  void trim_cache(uint64_t max);
 
 private:
   static inline const char XATTR_EXCL[] = "striper.excl";
@@ -134,6 +158,21 @@ private:
   std::queue<aiocompletionptr> aios;
   int aios_failure = 0;
   std::string myaddrs;
+
+  struct cache_block {
+    ceph::bufferlist bl;
+    aiocompletionptr aiocp; /* set while the read is in flight */
+    std::list<uint64_t>::iterator lru;
+  };
+  std::map<uint64_t, cache_block> cache; /* by block offset */
+  std::list<uint64_t> cache_lru; /* most recently used first */
+  uint64_t cache_max = 0;
+  unsigned readahead_blocks = 0;
+  uint64_t next_seq_off = 0;
+  /* contiguous writes not yet submitted */
+  uint64_t wbuf_off = 0;
+  ceph::bufferlist wbuf;
+  uint64_t wbuf_max = 0;
 };
 
 #endif /* _SIMPLERADOSSTRIPER_H */
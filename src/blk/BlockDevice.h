@@ -178,6 +178,7 @@ protected:
   uint64_t block_size = 0;
   uint64_t optimal_io_size = 0;
   bool support_discard = false;
+  bool support_write_zeroes = false;
   bool rotational = true;
   bool lock_exclusive = true;
 
@@ -236,6 +237,7 @@ public:
   uint64_t get_size() const { return size; }
   uint64_t get_block_size() const { return block_size; }
   uint64_t get_optimal_io_size() const { return optimal_io_size; }
+  bool is_write_zeroes_supported() const { return support_write_zeroes; }
 
   /// hook to provide utilization of thinly-provisioned device
   virtual int get_ebd_state(ExtBlkDevState &state) const {
@@ -287,6 +289,17 @@ public:
     bool buffered,
     int write_hint = WRITE_LIFE_NOT_SET) = 0;
   virtual int flush() = 0;
+  /**
+   * Synchronously zero [off, off+len), or copy [src_off, src_off+len) to
+   * dst_off, without moving the data through host memory.  Both return
+   * -EOPNOTSUPP if the device cannot offload the operation, in which case
+   * the caller is expected to do it by hand.  Like write(), the result is
+   * only durable after flush().
+   */
+  virtual int write_zeroes(uint64_t off, uint64_t len) { return -EOPNOTSUPP; }
+  virtual int copy_range(uint64_t src_off, uint64_t dst_off, uint64_t len) {
+    return -EOPNOTSUPP;
+  }
   virtual bool try_discard(interval_set<uint64_t> &to_release, bool async=true) { return false; }
   virtual void discard_drain() { return; }
 
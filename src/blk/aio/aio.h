@@ -103,6 +103,14 @@ struct io_queue_t {
   virtual int submit_batch(aio_iter begin, aio_iter end, uint16_t aios_size,
 			   void *priv, int *retries) = 0;
   virtual int get_next_completed(int timeout_ms, aio_t **paio, int max) = 0;
+
+  // pin long-lived buffers in the kernel so that ios landing entirely
+  // within one of them can skip the per-io page mapping. only meaningful
+  // for io_uring; must be called after init() and before any submission.
+  virtual int register_buffers(const std::vector<iovec> &iovs) {
+    (void)iovs;
+    return -EOPNOTSUPP;
+  }
 };
 
 struct aio_queue_t final : public io_queue_t {
@@ -247,8 +247,15 @@ int KernelDevice::open(const string& p)
 	goto out_fail;
       }
       size = s;
+      block_device = true;
+      support_write_zeroes = blkdev_direct.support_write_zeroes();
     } else {
       size = st.st_size;
+      block_device = false;
+#if defined(CEPH_HAVE_FALLOCATE) && defined(FALLOC_FL_ZERO_RANGE)
+      // may still fail with EOPNOTSUPP, depending on the file system
+      support_write_zeroes = true;
+#endif
     }
 
     char partition[PATH_MAX], devname[PATH_MAX];
@@ -352,6 +359,7 @@ void KernelDevice::close()
 int KernelDevice::collect_metadata(const string& prefix, map<string,string> *pm) const
 {
   (*pm)[prefix + "support_discard"] = stringify((int)(bool)support_discard);
+  (*pm)[prefix + "support_write_zeroes"] = stringify((int)(bool)support_write_zeroes);
   (*pm)[prefix + "rotational"] = stringify((int)(bool)rotational);
   (*pm)[prefix + "size"] = stringify(get_size());
   (*pm)[prefix + "block_size"] = stringify(get_block_size());
@@ -500,6 +508,90 @@ int KernelDevice::flush()
   return r;
 }
 
+// a fixed set of page-aligned read buffers carved out of one mapping,
+// registered with io_uring so reads into them skip get_user_pages() on
+// every submission. buffers are handed out as raws that return their
+// slot on release; each raw keeps the pool (and thus the mapping) alive
+// so bufferlists may safely outlive the device.
+struct KernelDevice::FixedBufferPool
+  : public std::enable_shared_from_this<FixedBufferPool> {
+  using slot_queue_t = boost::lockfree::queue<void*>;
+
+  struct fixed_buffer_raw : public buffer::raw {
+    std::shared_ptr<FixedBufferPool> pool; // for recycling
+
+    fixed_buffer_raw(void* slot, unsigned len,
+		     std::shared_ptr<FixedBufferPool> parent)
+      : buffer::raw(static_cast<char*>(slot), len),
+	pool(std::move(parent)) {
+    }
+    ~fixed_buffer_raw() override {
+      // don't free; recycle the slot instead
+      pool->slot_q.push(data);
+    }
+  };
+
+  FixedBufferPool(const size_t buffer_size, const size_t buffers_in_pool)
+    : buffer_size(p2roundup<size_t>(buffer_size, CEPH_PAGE_SIZE)),
+      buffers_in_pool(buffers_in_pool),
+      slot_q(buffers_in_pool) {
+  }
+  ~FixedBufferPool() {
+    if (region != MAP_FAILED) {
+      ::munmap(region, buffer_size * buffers_in_pool);
+    }
+  }
+
+  int init() {
+    region = ::mmap(
+      nullptr,
+      buffer_size * buffers_in_pool,
+      PROT_READ | PROT_WRITE,
+#if defined(__FreeBSD__)
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_PREFAULT_READ,
+#else
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE,
+#endif
+      -1,
+      0);
+    if (region == MAP_FAILED) {
+      return -errno;
+    }
+    for (size_t i = 0; i < buffers_in_pool; ++i) {
+      slot_q.push(static_cast<char*>(region) + i * buffer_size);
+    }
+    return 0;
+  }
+
+  std::vector<iovec> get_iovecs() const {
+    std::vector<iovec> iovs(buffers_in_pool);
+    for (size_t i = 0; i < buffers_in_pool; ++i) {
+      iovs[i].iov_base = static_cast<char*>(region) + i * buffer_size;
+      iovs[i].iov_len = buffer_size;
+    }
+    return iovs;
+  }
+
+  ceph::unique_leakable_ptr<buffer::raw> try_create(const size_t len) {
+    if (len > buffer_size) {
+      return nullptr;
+    }
+    if (void* slot; slot_q.pop(slot)) {
+      return ceph::unique_leakable_ptr<buffer::raw> {
+	new fixed_buffer_raw(slot, len, shared_from_this())
+      };
+    }
+    // all slots are in flight or cached by the upper layers
+    return nullptr;
+  }
+
+private:
+  const size_t buffer_size;
+  const size_t buffers_in_pool;
+  void* region = MAP_FAILED;
+  slot_queue_t slot_q;
+};
+
 int KernelDevice::_aio_start()
 {
   if (aio) {
@@ -514,6 +606,7 @@ int KernelDevice::_aio_start()
       }
       return r;
     }
+    _fixed_buffers_start();
     aio_thread.create("bstore_aio");
   }
   return 0;
@@ -527,7 +620,35 @@ void KernelDevice::_aio_stop()
     aio_thread.join();
     aio_stop = false;
     io_queue->shutdown();
+    // outstanding buffers keep the mapping alive until they're released
+    fixed_buffers.reset();
+  }
+}
+
+void KernelDevice::_fixed_buffers_start()
+{
+  const uint64_t count = cct->_conf.get_val<uint64_t>("bdev_ioring_fixed_buffers");
+  if (!count || !cct->_conf.get_val<bool>("bdev_ioring")) {
+    return;
   }
+  auto pool = std::make_shared<FixedBufferPool>(
+    cct->_conf.get_val<Option::size_t>("bdev_ioring_fixed_buffer_size"),
+    count);
+  int r = pool->init();
+  if (r < 0) {
+    derr << __func__ << " failed to map " << count << " fixed buffers: "
+	 << cpp_strerror(r) << dendl;
+    return;
+  }
+  r = io_queue->register_buffers(pool->get_iovecs());
+  if (r < 0) {
+    // e.g. libaio fallback or RLIMIT_MEMLOCK too low; not fatal
+    derr << __func__ << " unable to register " << count << " fixed buffers: "
+	 << cpp_strerror(r) << dendl;
+    return;
+  }
+  dout(1) << __func__ << " registered " << count << " fixed buffers" << dendl;
+  fixed_buffers = std::move(pool);
 }
 
 void KernelDevice::_discard_start()
@@ -1063,6 +1184,90 @@ int KernelDevice::aio_write(
   return 0;
 }
 
+int KernelDevice::write_zeroes(uint64_t off, uint64_t len)
+{
+  dout(20) << __func__ << " 0x" << std::hex << off << "~" << len << std::dec
+	   << dendl;
+  ceph_assert(is_valid_io(off, len));
+  if (cct->_conf->objectstore_blackhole) {
+    lderr(cct) << __func__ << " objectstore_blackhole=true, throwing out IO"
+	       << dendl;
+    return 0;
+  }
+  int r = -EOPNOTSUPP;
+  if (block_device) {
+    // without device support BLKZEROOUT would just write zero pages for us
+    if (support_write_zeroes) {
+      r = BlkDev{fd_directs[WRITE_LIFE_NOT_SET]}.zeroout(off, len);
+    }
+  } else {
+#if defined(CEPH_HAVE_FALLOCATE) && defined(FALLOC_FL_ZERO_RANGE)
+    r = ::fallocate(fd_directs[WRITE_LIFE_NOT_SET],
+		    FALLOC_FL_ZERO_RANGE | FALLOC_FL_KEEP_SIZE, off, len);
+    if (r < 0) {
+      r = -errno;
+    }
+#endif
+  }
+  if (r == 0) {
+    io_since_flush.store(true);
+  } else {
+    dout(10) << __func__ << " 0x" << std::hex << off << "~" << len << std::dec
+	     << " not offloaded: " << cpp_strerror(r) << dendl;
+  }
+  return r;
+}
+
+int KernelDevice::copy_range(uint64_t src_off, uint64_t dst_off, uint64_t len)
+{
+  dout(20) << __func__ << " 0x" << std::hex << src_off << "~" << len
+	   << " -> 0x" << dst_off << std::dec << dendl;
+  ceph_assert(is_valid_io(src_off, len));
+  ceph_assert(is_valid_io(dst_off, len));
+  ceph_assert(src_off + len <= dst_off || dst_off + len <= src_off);
+  if (cct->_conf->objectstore_blackhole) {
+    lderr(cct) << __func__ << " objectstore_blackhole=true, throwing out IO"
+	       << dendl;
+    return 0;
+  }
+  int r = -EOPNOTSUPP;
+#ifdef __linux__
+  // copy_file_range(2) only works within regular files, where it lets the
+  // file system share or copy the blocks.  go through the buffered fd: the
+  // kernel may fall back to a page cache copy, which O_DIRECT reads and
+  // flush() both see.
+  if (!block_device) {
+    int fd = fd_buffereds[WRITE_LIFE_NOT_SET];
+    loff_t src = src_off, dst = dst_off;
+    uint64_t left = len;
+    r = 0;
+    while (left > 0) {
+      ssize_t n = ::copy_file_range(fd, &src, fd, &dst, left, 0);
+      if (n < 0) {
+	r = -errno;
+	break;
+      } else if (n == 0) {
+	r = -EIO;
+	break;
+      }
+      left -= n;
+    }
+    if (r == -EXDEV || r == -EINVAL || r == -ENOSYS) {
+      r = -EOPNOTSUPP;
+    }
+    if (left < len) {
+      io_since_flush.store(true);
+    }
+  }
+#endif
+  if (r < 0) {
+    dout(10) << __func__ << " 0x" << std::hex << src_off << "~" << len
+	     << " -> 0x" << dst_off << std::dec
+	     << " not offloaded: " << cpp_strerror(r) << dendl;
+  }
+  return r;
+}
+
 int KernelDevice::_discard(uint64_t offset, uint64_t len)
 {
   int r = 0;
@@ -1306,8 +1511,14 @@ int KernelDevice::aio_read(
     ioc->pending_aios.push_back(aio_t(ioc, fd_directs[WRITE_LIFE_NOT_SET]));
     ++ioc->num_pending;
     aio_t& aio = ioc->pending_aios.back();
-    aio.bl.push_back(
-      ceph::buffer::ptr_node::create(create_custom_aligned(len, ioc)));
+    ceph::unique_leakable_ptr<buffer::raw> raw;
+    if (fixed_buffers) {
+      raw = fixed_buffers->try_create(len);
+    }
+    if (!raw) {
+      raw = create_custom_aligned(len, ioc);
+    }
+    aio.bl.push_back(ceph::buffer::ptr_node::create(std::move(raw)));
     aio.bl.prepare_iov(&aio.iov);
     aio.preadv(off, len);
     dout(30) << aio << dendl;
@@ -35,6 +35,7 @@ private:
   std::vector<int> fd_directs, fd_buffereds;
   bool enable_wrt = true;
   bool aio, dio;
+  bool block_device = true;  ///< false if backed by a regular file
 
   ExtBlkDevInterfaceRef ebd_impl;  // structure for retrieving compression state from extended block device
 
@@ -47,6 +48,8 @@ private:
   ceph::mutex flush_mutex = ceph::make_mutex("KernelDevice::flush_mutex");
 
   std::unique_ptr<io_queue_t> io_queue;
+  struct FixedBufferPool;
+  std::shared_ptr<FixedBufferPool> fixed_buffers;  ///< io_uring registered read buffers
   aio_callback_t discard_callback;
   void *discard_callback_priv;
   bool aio_stop;
@@ -89,6 +92,7 @@ private:
 
   int _aio_start();
   void _aio_stop();
+  void _fixed_buffers_start();
 
   void _discard_start();
   void _discard_stop();
@@ -145,6 +149,8 @@ public:
 		bool buffered,
 		int write_hint = WRITE_LIFE_NOT_SET) override;
   int flush() override;
+  int write_zeroes(uint64_t off, uint64_t len) override;
+  int copy_range(uint64_t src_off, uint64_t dst_off, uint64_t len) override;
   int _discard(uint64_t offset, uint64_t len);
 
   // for managing buffered readers/writers
@@ -17,6 +17,8 @@ struct ioring_data {
   pthread_mutex_t sq_mutex;
   int epoll_fd = -1;
   std::map<int, int> fixed_fds_map;
+  // registered buffer base -> (length, index in the registered table)
+  std::map<uintptr_t, std::pair<size_t, int>> fixed_bufs_map;
 };
 
 static int ioring_get_cqe(struct ioring_data *d, unsigned int max,
@@ -50,6 +52,24 @@ static int find_fixed_fd(struct ioring_data *d, int real_fd)
   return it->second;
 }
 
+static int find_fixed_buf(struct ioring_data *d, const iovec &iov)
+{
+  if (d->fixed_bufs_map.empty())
+    return -1;
+
+  uintptr_t base = reinterpret_cast<uintptr_t>(iov.iov_base);
+  auto it = d->fixed_bufs_map.upper_bound(base);
+  if (it == d->fixed_bufs_map.begin())
+    return -1;
+  --it;
+
+  auto [len, index] = it->second;
+  if (base + iov.iov_len > it->first + len)
+    return -1;
+
+  return index;
+}
+
 static void init_sqe(struct ioring_data *d, struct io_uring_sqe *sqe,
 		     struct aio_t *io)
 {
@@ -57,7 +77,21 @@ static void init_sqe(struct ioring_data *d, struct io_uring_sqe *sqe,
 
   ceph_assert(fixed_fd != -1);
 
-  if (io->iocb.aio_lio_opcode == IO_CMD_PWRITEV)
+  int fixed_buf = -1;
+  if (io->iov.size() == 1)
+    fixed_buf = find_fixed_buf(d, io->iov[0]);
+
+  if (fixed_buf != -1) {
+    /* Single segment within a registered buffer, skip the page pinning */
+    if (io->iocb.aio_lio_opcode == IO_CMD_PWRITEV)
+      io_uring_prep_write_fixed(sqe, fixed_fd, io->iov[0].iov_base,
+				io->iov[0].iov_len, io->offset, fixed_buf);
+    else if (io->iocb.aio_lio_opcode == IO_CMD_PREADV)
+      io_uring_prep_read_fixed(sqe, fixed_fd, io->iov[0].iov_base,
+			       io->iov[0].iov_len, io->offset, fixed_buf);
+    else
+      ceph_assert(0);
+  } else if (io->iocb.aio_lio_opcode == IO_CMD_PWRITEV)
     io_uring_prep_writev(sqe, fixed_fd, &io->iov[0],
 			 io->iov.size(), io->offset);
   else if (io->iocb.aio_lio_opcode == IO_CMD_PREADV)
@@ -170,6 +204,7 @@ close_ring_fd:
 void ioring_queue_t::shutdown()
 {
   d->fixed_fds_map.clear();
+  d->fixed_bufs_map.clear();
   close(d->epoll_fd);
   d->epoll_fd = -1;
   io_uring_queue_exit(&d->io_uring);
@@ -209,6 +244,23 @@ get_cqe:
   return events;
 }
 
+int ioring_queue_t::register_buffers(const std::vector<iovec> &iovs)
+{
+  ceph_assert(d->fixed_bufs_map.empty());
+
+  int ret = io_uring_register_buffers(&d->io_uring, &iovs[0], iovs.size());
+  if (ret < 0)
+    return ret;
+
+  int index = 0;
+  for (auto &iov : iovs) {
+    d->fixed_bufs_map[reinterpret_cast<uintptr_t>(iov.iov_base)] =
+      std::make_pair(iov.iov_len, index++);
+  }
+
+  return 0;
+}
+
 bool ioring_queue_t::supported()
 {
   struct io_uring ring;
@@ -256,6 +308,11 @@ int ioring_queue_t::get_next_completed(int timeout_ms, aio_t **paio, int max)
   ceph_assert(0);
 }
 
+int ioring_queue_t::register_buffers(const std::vector<iovec> &iovs)
+{
+  ceph_assert(0);
+}
+
 bool ioring_queue_t::supported()
 {
   return false;
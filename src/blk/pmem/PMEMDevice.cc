@@ -23,7 +23,9 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <filesystem>
+#include <limits>
 #include <fstream>
 
 #include <fmt/format.h>
@@ -36,6 +38,7 @@
 #include "common/errno.h"
 #include "common/debug.h"
 #include "common/blkdev.h"
+#include "include/buffer_raw.h"
 
 #if defined(HAVE_LIBDML)
 #include <dml/dml.hpp>
@@ -47,6 +50,35 @@ using execution_path = dml::automatic;
 #undef dout_prefix
 #define dout_prefix *_dout << "bdev-PMEM("  << path << ") "
 
+/**
+ * A second, read-only mapping of the device.  Buffers returned by zero-copy
+ * reads point into it, so that a stray write through one of them faults
+ * instead of landing on the media, and each of them holds a reference so
+ * that the mapping outlives close() until the last buffer is released.
+ */
+struct PMEMDevice::ReadMap {
+  char *addr;
+  size_t len;
+
+  ReadMap(char *addr, size_t len) : addr(addr), len(len) {}
+  ~ReadMap() {
+    ::munmap(addr, len);
+  }
+};
+
+namespace {
+
+class pmem_mapped_raw : public ceph::buffer::raw {
+  std::shared_ptr<PMEMDevice::ReadMap> map;
+public:
+  pmem_mapped_raw(std::shared_ptr<PMEMDevice::ReadMap> m,
+		  uint64_t off, unsigned len)
+    : raw(m->addr + off, len), map(std::move(m)) {}
+  ~pmem_mapped_raw() override {}
+};
+
+} // anonymous namespace
+
 PMEMDevice::PMEMDevice(CephContext *cct, aio_callback_t cb, void *cbpriv)
   : BlockDevice(cct, cb, cbpriv),
     fd(-1), addr(0),
@@ -143,6 +175,16 @@ int PMEMDevice::open(const std::string& p)
   }
   size = map_len;
 
+  if (g_conf()->bdev_pmem_zero_copy_read) {
+    void *ro = ::mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (ro == MAP_FAILED) {
+      dout(1) << __func__ << " read-only mmap failed: " << cpp_strerror(errno)
+	      << ", zero-copy reads disabled" << dendl;
+    } else {
+      read_map = std::make_shared<ReadMap>((char *)ro, size);
+    }
+  }
+
   // Operate as though the block size is 4 KB.  The backing file
   // blksize doesn't strictly matter except that some file systems may
   // require a read/modify/write if we write something smaller than
@@ -177,6 +219,8 @@ void PMEMDevice::close()
     devdax_device = false;
   }
   pmem_unmap(addr, size);
+  // outstanding zero-copy buffers keep their mapping alive
+  read_map.reset();
 
   ceph_assert(fd >= 0);
   VOID_TEMP_FAILURE_RETRY(::close(fd));
@@ -328,6 +372,14 @@ int PMEMDevice::read(uint64_t off, uint64_t len, bufferlist *pbl,
   dout(5) << __func__ << " " << off << "~" << len  << dendl;
   ceph_assert(is_valid_io(off, len));
 
+  if (read_map && len <= std::numeric_limits<unsigned>::max()) {
+    // hand out the mapping itself instead of a copy
+    pbl->clear();
+    pbl->push_back(bufferptr(ceph::unique_leakable_ptr<buffer::raw>(
+      new pmem_mapped_raw(read_map, off, len))));
+    return 0;
+  }
+
   bufferptr p = buffer::create_small_page_aligned(len);
 
 #if defined(HAVE_LIBDML)
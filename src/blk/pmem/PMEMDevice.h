@@ -19,6 +19,7 @@
 
 #include <atomic>
 #include <map>
+#include <memory>
 #include <string>
 
 #include "os/fs/FS.h"
@@ -38,6 +39,12 @@ class PMEMDevice : public BlockDevice {
   std::atomic_int injecting_crash;
   int _lock();
 
+public:
+  struct ReadMap;
+private:
+  /// read-only mapping handed out by zero-copy reads, pinned by their buffers
+  std::shared_ptr<ReadMap> read_map;
+
 public:
   PMEMDevice(CephContext *cct, aio_callback_t cb, void *cbpriv);
 
@@ -27,6 +27,7 @@
 #include <fstream>
 #include <functional>
 #include <map>
+#include <memory>
 #include <thread>
 #include <boost/intrusive/slist.hpp>
 
@@ -85,6 +86,11 @@ class SharedDriverData {
 
   public:
   std::vector<NVMEDevice*> registered_devices;
+  /// io qpairs currently allocated on this controller
+  std::atomic<unsigned> num_qpairs = {0};
+  /// used by threads which could not get a qpair of their own
+  ceph::mutex shared_queue_lock = ceph::make_mutex("SharedDriverData::shared_queue_lock");
+  SharedDriverQueueData *shared_queue = nullptr;
   friend class SharedDriverQueueData;
   SharedDriverData(unsigned id_, const spdk_nvme_transport_id& trid_,
                    spdk_nvme_ctrlr *c, spdk_nvme_ns *ns_)
@@ -114,11 +120,7 @@ class SharedDriverData {
   bool is_equal(const spdk_nvme_transport_id& trid2) const {
     return spdk_nvme_transport_id_compare(&trid, &trid2) == 0;
   }
-  ~SharedDriverData() {
-    if (admin_thread.joinable()) {
-      admin_thread.join();
-    }
-  }
+  ~SharedDriverData();
 
   void register_device(NVMEDevice *device) {
     registered_devices.push_back(device);
@@ -139,6 +141,9 @@ class SharedDriverData {
   uint64_t get_size() {
     return size;
   }
+  bool support_write_zeroes() {
+    return spdk_nvme_ns_get_flags(ns) & SPDK_NVME_NS_WRITE_ZEROES_SUPPORTED;
+  }
 };
 
 class SharedDriverQueueData {
@@ -171,7 +176,14 @@ class SharedDriverQueueData {
     // usable queue depth should minus 1 to avoid overflow.
     max_queue_depth = opts.io_queue_size - 1;
     qpair = spdk_nvme_ctrlr_alloc_io_qpair(ctrlr, &opts, sizeof(opts));
-    ceph_assert(qpair != NULL);
+    if (qpair == NULL) {
+      // the controller is out of io queues; the caller falls back to a
+      // shared one
+      dout(1) << __func__ << " failed to allocate io qpair, "
+              << driver->num_qpairs << " in use" << dendl;
+      return;
+    }
+    ++driver->num_qpairs;
 
     // allocate spdk dma memory
     for (uint16_t i = 0; i < data_buffer_default_num; i++) {
@@ -187,12 +199,59 @@ class SharedDriverQueueData {
   ~SharedDriverQueueData() {
     if (qpair) {
       spdk_nvme_ctrlr_free_io_qpair(qpair);
+      --driver->num_qpairs;
     }
 
     data_buf_list.clear_and_dispose(spdk_dma_free);
   }
+
+  bool valid() const {
+    return qpair != NULL;
+  }
 };
 
+SharedDriverData::~SharedDriverData()
+{
+  delete shared_queue;
+  if (admin_thread.joinable()) {
+    admin_thread.join();
+  }
+}
+
+/**
+ * Return the calling thread's own queue on @driver, creating it on first
+ * use, or nullptr if the thread has to use driver->shared_queue.
+ *
+ * Qpairs are not thread safe, and submission polls its own completions
+ * before returning, so giving every submitting thread (i.e. every OSD shard
+ * thread) a qpair per controller keeps both submission and completion
+ * lock-free and on the submitting core.  Once the controller, or
+ * bluestore_spdk_max_io_qpairs, runs out of qpairs the remaining threads
+ * serialize on a shared one.
+ */
+static SharedDriverQueueData *get_thread_queue(NVMEDevice *bdev,
+                                               SharedDriverData *driver)
+{
+  struct thread_queue_t {
+    std::unique_ptr<SharedDriverQueueData> queue;
+    bool tried = false;
+  };
+  thread_local std::map<SharedDriverData*, thread_queue_t> thread_queues;
+
+  auto& tq = thread_queues[driver];
+  if (!tq.tried) {
+    tq.tried = true;
+    uint64_t max_qpairs = g_conf().get_val<uint64_t>("bluestore_spdk_max_io_qpairs");
+    if (max_qpairs == 0 || driver->num_qpairs < max_qpairs) {
+      tq.queue = std::make_unique<SharedDriverQueueData>(bdev, driver);
+      if (!tq.queue->valid()) {
+        tq.queue.reset();
+      }
+    }
+  }
+  return tq.queue.get();
+}
+
 struct Task {
   NVMEDevice *device;
   IOContext *ctx = nullptr;
@@ -416,6 +475,19 @@ void SharedDriverQueueData::_aio_handle(Task *t, IOContext *ioc)
           }
           break;
         }
+        case IOCommand::WRITE_ZEROES_COMMAND:
+        {
+          dout(20) << __func__ << " write zeroes command issued " << lba_off << "~" << lba_count << dendl;
+          r = spdk_nvme_ns_cmd_write_zeroes(
+              ns, qpair, lba_off, lba_count, io_complete, t, 0);
+          if (r < 0) {
+            derr << __func__ << " failed to do write zeroes command: " << cpp_strerror(r) << dendl;
+            t->ctx->nvme_task_first = t->ctx->nvme_task_last = nullptr;
+            delete t;
+            ceph_abort();
+          }
+          break;
+        }
         case IOCommand::FLUSH_COMMAND:
         {
           dout(20) << __func__ << " flush command issueed " << dendl;
@@ -654,7 +726,8 @@ void io_complete(void *t, const struct spdk_nvme_cpl *completion)
   ceph_assert(queue != NULL);
   ceph_assert(ctx != NULL);
   --queue->current_queue_depth;
-  if (task->command == IOCommand::WRITE_COMMAND) {
+  if (task->command == IOCommand::WRITE_COMMAND ||
+      task->command == IOCommand::WRITE_ZEROES_COMMAND) {
     ceph_assert(!spdk_nvme_cpl_is_error(completion));
     dout(20) << __func__ << " write/zero op successfully, left "
              << queue->queue_op_seq - queue->completed_op_seq << dendl;
@@ -756,6 +829,7 @@ int NVMEDevice::open(const string& p)
 
   //nvme is non-rotational device.
   rotational = false;
+  support_write_zeroes = driver->support_write_zeroes();
 
   // round size down to an even block
   size &= ~(block_size - 1);
@@ -810,8 +884,16 @@ void NVMEDevice::aio_submit(IOContext *ioc)
     // Only need to push the first entry
     ioc->nvme_task_first = ioc->nvme_task_last = nullptr;
 
-    thread_local SharedDriverQueueData queue_t = SharedDriverQueueData(this, driver);
-    queue_t._aio_handle(t, ioc);
+    if (auto queue = get_thread_queue(this, driver); queue) {
+      queue->_aio_handle(t, ioc);
+    } else {
+      std::lock_guard l(driver->shared_queue_lock);
+      if (!driver->shared_queue) {
+        driver->shared_queue = new SharedDriverQueueData(this, driver);
+        ceph_assert(driver->shared_queue->valid());
+      }
+      driver->shared_queue->_aio_handle(t, ioc);
+    }
   }
 }
 
@@ -928,6 +1010,31 @@ int NVMEDevice::write(uint64_t off, bufferlist &bl, bool buffered, int write_hin
   return 0;
 }
 
+int NVMEDevice::write_zeroes(uint64_t off, uint64_t len)
+{
+  dout(20) << __func__ << " " << off << "~" << len << dendl;
+  if (!support_write_zeroes) {
+    return -EOPNOTSUPP;
+  }
+  ceph_assert(off % block_size == 0);
+  ceph_assert(len % block_size == 0);
+  ceph_assert(len > 0);
+  ceph_assert(off + len <= size);
+
+  // the command carries a 16 bit block count
+  uint64_t split_size = 65536ull * block_size;
+  IOContext ioc(cct, NULL);
+  for (uint64_t pos = 0; pos < len; pos += split_size) {
+    Task *t = new Task(this, IOCommand::WRITE_ZEROES_COMMAND, off + pos,
+                       std::min(len - pos, split_size));
+    t->ctx = &ioc;
+    ioc_append_task(&ioc, t);
+  }
+  aio_submit(&ioc);
+  ioc.aio_wait();
+  return 0;
+}
+
 int NVMEDevice::read(uint64_t off, uint64_t len, bufferlist *pbl,
                      IOContext *ioc,
                      bool buffered)
@@ -32,6 +32,7 @@
 enum class IOCommand {
   READ_COMMAND,
   WRITE_COMMAND,
+  WRITE_ZEROES_COMMAND,
   FLUSH_COMMAND
 };
 
@@ -72,6 +73,7 @@ class NVMEDevice : public BlockDevice {
 		int write_hint = WRITE_LIFE_NOT_SET) override;
   int write(uint64_t off, bufferlist& bl, bool buffered, int write_hint = WRITE_LIFE_NOT_SET) override;
   int flush() override;
+  int write_zeroes(uint64_t off, uint64_t len) override;
   int read_random(uint64_t off, uint64_t len, char *buf, bool buffered) override;
 
   // for managing buffered readers/writers
@@ -1854,11 +1854,11 @@ int Client::verify_reply_trace(int r, MetaSession *session,
      created_ino = ocres.created_ino;
      /*
       * The userland cephfs client doesn't have a way to do an async create
-      * (yet), so just discard delegated_inos for now. Eventually we should
-      * store them and use them in create calls, even if they are synchronous,
-      * if only for testing purposes.
+      * (yet), but keep the delegated inos so that creates can use them,
+      * see client_use_delegated_inos.
       */
      ldout(cct, 10) << "delegated_inos: " << ocres.delegated_inos << dendl;
+     session->delegated_inos.union_of(ocres.delegated_inos);
     } else {
      // u64 containing number of created ino
      decode(created_ino, extra_bl);
@@ -2530,6 +2530,19 @@ void Client::send_request(MetaRequest *request, MetaSession *session,
     if (request->target)
       r->head.ino = request->target->ino;
   } else {
+    if (cct->_conf.get_val<bool>("client_use_delegated_inos")) {
+      switch (r->head.op) {
+      case CEPH_MDS_OP_CREATE:
+      case CEPH_MDS_OP_MKDIR:
+      case CEPH_MDS_OP_MKNOD:
+      case CEPH_MDS_OP_SYMLINK:
+	// delegations are per rank, so pick again on every (re)send
+	r->head.ino = session->take_delegated_ino();
+	break;
+      default:
+	break;
+      }
+    }
     encode_cap_releases(request, mds);
     if (drop_cap_releases) // we haven't send cap reconnect yet, drop cap releases
       request->cap_releases.clear();
@@ -10044,6 +10057,15 @@ Fh *Client::_create_fh(Inode *in, int flags, int cmode, const UserPerm& perms)
     max_readahead = std::min(max_readahead, in->layout.get_period()*(uint64_t)conf->client_readahead_max_periods);
   }
   f->readahead.set_max_readahead_size(max_readahead);
+  if (conf->client_readahead_adaptive_max_periods > 0) {
+    // keep every object of a stripe set busy, and let the window grow
+    // while the stream gets faster for it
+    uint64_t period = in->layout.get_period();
+    f->readahead.set_min_readahead_size(
+      std::max<uint64_t>(conf->client_readahead_min, period));
+    f->readahead.set_adaptive_max_readahead_size(
+      period * (uint64_t)conf->client_readahead_adaptive_max_periods);
+  }
   vector<uint64_t> alignments;
   alignments.push_back(in->layout.get_period());
   alignments.push_back(in->layout.stripe_unit);
@@ -10756,6 +10778,11 @@ int Client::write(int fd, const char *buf, loff_t size, loff_t offset)
   tout(cct) << size << std::endl;
   tout(cct) << offset << std::endl;
 
+  /* We can't return bytes written larger than INT_MAX, clamp size to that */
+  size = std::min(size, (loff_t)INT_MAX);
+  struct iovec iov = { const_cast<char*>(buf), (size_t)size };
+  bufferlist bl = _copy_write_data(&iov, 1, size);
+
   std::scoped_lock lock(client_lock);
   Fh *fh = get_filehandle(fd);
   if (!fh)
@@ -10764,9 +10791,7 @@ int Client::write(int fd, const char *buf, loff_t size, loff_t offset)
   if (fh->flags & O_PATH)
     return -CEPHFS_EBADF;
 #endif
-  /* We can't return bytes written larger than INT_MAX, clamp size to that */
-  size = std::min(size, (loff_t)INT_MAX);
-  int r = _write(fh, offset, size, buf, NULL, false);
+  int r = _write(fh, offset, std::move(bl));
   ldout(cct, 3) << "write(" << fd << ", \"...\", " << size << ", " << offset << ") = " << r << dendl;
   return r;
 }
@@ -10780,7 +10805,8 @@ int Client::pwritev(int fd, const struct iovec *iov, int iovcnt, int64_t offset)
 
 int64_t Client::_preadv_pwritev_locked(Fh *fh, const struct iovec *iov,
                                        unsigned iovcnt, int64_t offset,
-                                       bool write, bool clamp_to_int)
+                                       bool write, bool clamp_to_int,
+                                       bufferlist *data)
 {
     ceph_assert(ceph_mutex_is_locked_by_me(client_lock));
 
@@ -10802,7 +10828,12 @@ int64_t Client::_preadv_pwritev_locked(Fh *fh, const struct iovec *iov,
       totallen = std::min(totallen, (loff_t)INT_MAX);
     }
     if (write) {
-        int64_t w = _write(fh, offset, totallen, NULL, iov, iovcnt);
+        bufferlist bl;
+        if (data)
+          bl = std::move(*data);
+        else
+          bl = _copy_write_data(iov, iovcnt, totallen);
+        int64_t w = _write(fh, offset, std::move(bl));
         ldout(cct, 3) << "pwritev(" << fh << ", \"...\", " << totallen << ", " << offset << ") = " << w << dendl;
         return w;
     } else {
@@ -10838,18 +10869,37 @@ int Client::_preadv_pwritev(int fd, const struct iovec *iov, unsigned iovcnt, in
     tout(cct) << fd << std::endl;
     tout(cct) << offset << std::endl;
 
+    bufferlist bl;
+    if (write)
+      bl = _copy_write_data(iov, iovcnt, INT_MAX);
+
     std::scoped_lock cl(client_lock);
     Fh *fh = get_filehandle(fd);
     if (!fh)
       return -CEPHFS_EBADF;
-    return _preadv_pwritev_locked(fh, iov, iovcnt, offset, write, true);
+    return _preadv_pwritev_locked(fh, iov, iovcnt, offset, write, true,
+                                  write ? &bl : nullptr);
 }
 
-int64_t Client::_write(Fh *f, int64_t offset, uint64_t size, const char *buf,
-	                const struct iovec *iov, int iovcnt)
+bufferlist Client::_copy_write_data(const struct iovec *iov, unsigned iovcnt,
+                                    uint64_t size)
+{
+  // copy into fresh buffer (since our write may be resub, async)
+  bufferlist bl;
+  for (unsigned i = 0; i < iovcnt && bl.length() < size; i++) {
+    uint64_t len = std::min<uint64_t>(iov[i].iov_len, size - bl.length());
+    if (len > 0) {
+      bl.append((const char *)iov[i].iov_base, len);
+    }
+  }
+  return bl;
+}
+
+int64_t Client::_write(Fh *f, int64_t offset, bufferlist&& bl)
 {
   ceph_assert(ceph_mutex_is_locked_by_me(client_lock));
 
+  const uint64_t size = bl.length();
   uint64_t fpos = 0;
   Inode *in = f->inode.get();
 
@@ -10909,19 +10959,6 @@ int64_t Client::_write(Fh *f, int64_t offset, uint64_t size, const char *buf,
     ceph_assert(in->inline_version > 0);
   }
 
-  // copy into fresh buffer (since our write may be resub, async)
-  bufferlist bl;
-  if (buf) {
-    if (size > 0)
-      bl.append(buf, size);
-  } else if (iov){
-    for (int i = 0; i < iovcnt; i++) {
-      if (iov[i].iov_len > 0) {
-        bl.append((const char *)iov[i].iov_base, iov[i].iov_len);
-      }
-    }
-  }
-
   utime_t lat;
   uint64_t totalwritten;
   int want, have;
@@ -15069,9 +15106,34 @@ int Client::ll_write(Fh *fh, loff_t off, loff_t len, const char *data)
 
   /* We can't return bytes written larger than INT_MAX, clamp len to that */
   len = std::min(len, (loff_t)INT_MAX);
+  struct iovec iov = { const_cast<char*>(data), (size_t)len };
+  bufferlist bl = _copy_write_data(&iov, 1, len);
+
+  std::scoped_lock lock(client_lock);
+
+  int r = _write(fh, off, std::move(bl));
+  ldout(cct, 3) << "ll_write " << fh << " " << off << "~" << len << " = " << r
+		<< dendl;
+  return r;
+}
+
+int Client::ll_write(Fh *fh, loff_t off, bufferlist&& bl)
+{
+  ldout(cct, 3) << "ll_write " << fh << " " << fh->inode->ino << " " << off <<
+    "~" << bl.length() << dendl;
+  tout(cct) << "ll_write" << std::endl;
+  tout(cct) << (uintptr_t)fh << std::endl;
+  tout(cct) << off << std::endl;
+  tout(cct) << bl.length() << std::endl;
+
+  RWRef_t mref_reader(mount_state, CLIENT_MOUNTING);
+  if (!mref_reader.is_state_satisfied())
+    return -CEPHFS_ENOTCONN;
+
+  uint64_t len = bl.length();
   std::scoped_lock lock(client_lock);
 
-  int r = _write(fh, off, len, data, NULL, 0);
+  int r = _write(fh, off, std::move(bl));
   ldout(cct, 3) << "ll_write " << fh << " " << off << "~" << len << " = " << r
 		<< dendl;
   return r;
@@ -15083,8 +15145,10 @@ int64_t Client::ll_writev(struct Fh *fh, const struct iovec *iov, int iovcnt, in
   if (!mref_reader.is_state_satisfied())
     return -CEPHFS_ENOTCONN;
 
+  bufferlist bl = _copy_write_data(iov, iovcnt, UINT64_MAX);
+
   std::scoped_lock cl(client_lock);
-  return _preadv_pwritev_locked(fh, iov, iovcnt, off, true, false);
+  return _preadv_pwritev_locked(fh, iov, iovcnt, off, true, false, &bl);
 }
 
 int64_t Client::ll_readv(struct Fh *fh, const struct iovec *iov, int iovcnt, int64_t off)
@@ -644,6 +644,7 @@ public:
 
   int ll_read(Fh *fh, loff_t off, loff_t len, bufferlist *bl);
   int ll_write(Fh *fh, loff_t off, loff_t len, const char *data);
+  int ll_write(Fh *fh, loff_t off, bufferlist&& bl);
   int64_t ll_readv(struct Fh *fh, const struct iovec *iov, int iovcnt, int64_t off);
   int64_t ll_writev(struct Fh *fh, const struct iovec *iov, int iovcnt, int64_t off);
   loff_t ll_lseek(Fh *fh, loff_t offset, int whence);
@@ -1399,11 +1400,17 @@ private:
 
   loff_t _lseek(Fh *fh, loff_t offset, int whence);
   int64_t _read(Fh *fh, int64_t offset, uint64_t size, bufferlist *bl);
-  int64_t _write(Fh *fh, int64_t offset, uint64_t size, const char *buf,
-          const struct iovec *iov, int iovcnt);
+  /*
+   * the data to write is copied into a bufferlist by the caller, before
+   * taking client_lock, so that writers don't serialize on the memcpy
+   */
+  static bufferlist _copy_write_data(const struct iovec *iov,
+                                     unsigned iovcnt, uint64_t size);
+  int64_t _write(Fh *fh, int64_t offset, bufferlist&& bl);
   int64_t _preadv_pwritev_locked(Fh *fh, const struct iovec *iov,
                                  unsigned iovcnt, int64_t offset,
-                                 bool write, bool clamp_to_int);
+                                 bool write, bool clamp_to_int,
+                                 bufferlist *data = nullptr);
   int _preadv_pwritev(int fd, const struct iovec *iov, unsigned iovcnt,
                       int64_t offset, bool write);
   int _flush(Fh *fh);
@@ -57,6 +57,9 @@ struct MetaSession {
   xlist<MetaRequest*> unsafe_requests;
   std::set<ceph_tid_t> flushing_caps_tids;
 
+  // inode numbers the MDS preallocated for creates issued on this session
+  interval_set<inodeno_t> delegated_inos;
+
   ceph::ref_t<MClientCapRelease> release;
 
   MetaSession(mds_rank_t mds_num, ConnectionRef con, const entity_addrvec_t& addrs)
@@ -71,6 +74,14 @@ struct MetaSession {
 
   void enqueue_cap_release(inodeno_t ino, uint64_t cap_id, ceph_seq_t iseq,
       ceph_seq_t mseq, epoch_t osd_barrier);
+
+  inodeno_t take_delegated_ino() {
+    if (delegated_inos.empty())
+      return 0;
+    inodeno_t ino = delegated_inos.range_start();
+    delegated_inos.erase(ino);
+    return ino;
+  }
 };
 
 using MetaSessionRef = std::shared_ptr<MetaSession>;
@@ -901,6 +901,37 @@ static void fuse_ll_write(fuse_req_t req, fuse_ino_t ino, const char *buf,
     fuse_reply_err(req, get_sys_errno(-r));
 }
 
+#if FUSE_VERSION >= FUSE_MAKE_VERSION(2, 9)
+static void fuse_ll_write_buf(fuse_req_t req, fuse_ino_t ino,
+			      struct fuse_bufvec *in_buf, off_t off,
+			      struct fuse_file_info *fi)
+{
+  CephFuse::Handle *cfuse = fuse_ll_req_prepare(req);
+  Fh *fh = reinterpret_cast<Fh*>(fi->fh);
+
+  // copy (or splice) the payload straight into the buffer that is handed
+  // to the client, instead of having libfuse copy it into its own first
+  size_t size = fuse_buf_size(in_buf);
+  bufferptr ptr = buffer::create_page_aligned(size);
+  struct fuse_bufvec out_buf = FUSE_BUFVEC_INIT(size);
+  out_buf.buf[0].mem = ptr.c_str();
+  ssize_t res = fuse_buf_copy(&out_buf, in_buf, (fuse_buf_copy_flags)0);
+  if (res < 0) {
+    fuse_reply_err(req, -res);
+    return;
+  }
+  ptr.set_length(res);
+  bufferlist bl;
+  bl.append(std::move(ptr));
+
+  int r = cfuse->client->ll_write(fh, off, std::move(bl));
+  if (r >= 0)
+    fuse_reply_write(req, r);
+  else
+    fuse_reply_err(req, get_sys_errno(-r));
+}
+#endif
+
 static void fuse_ll_flush(fuse_req_t req, fuse_ino_t ino,
 			  struct fuse_file_info *fi)
 {
@@ -1357,7 +1388,7 @@ const static struct fuse_lowlevel_ops fuse_ll_oper = {
  poll: 0,
 #endif
 #if FUSE_VERSION >= FUSE_MAKE_VERSION(2, 9)
- write_buf: 0,
+ write_buf: fuse_ll_write_buf,
  retrieve_reply: 0,
  forget_multi: 0,
  flock: fuse_ll_flock,
@@ -1420,7 +1451,7 @@ int CephFuse::Handle::init(int argc, const char *argv[])
 
   // set up fuse argc/argv
   int newargc = 0;
-  const char **newargv = (const char **) malloc((argc + 17) * sizeof(char *));
+  const char **newargv = (const char **) malloc((argc + 19) * sizeof(char *));
   if(!newargv)
     return ENOMEM;
 
@@ -1445,6 +1476,10 @@ int CephFuse::Handle::init(int argc, const char *argv[])
     "fuse_splice_write");
   auto fuse_splice_move = client->cct->_conf.get_val<bool>(
     "fuse_splice_move");
+#if FUSE_VERSION >= FUSE_MAKE_VERSION(3, 0)
+  auto fuse_clone_fd = client->cct->_conf.get_val<bool>(
+    "fuse_clone_fd");
+#endif
   auto fuse_debug = client->cct->_conf.get_val<bool>(
     "fuse_debug");
 
@@ -1485,6 +1520,12 @@ int CephFuse::Handle::init(int argc, const char *argv[])
     newargv[newargc++] = "-o";
     newargv[newargc++] = "splice_move";
   }
+#endif
+#if FUSE_VERSION >= FUSE_MAKE_VERSION(3, 0)
+  if (fuse_clone_fd) {
+    newargv[newargc++] = "-o";
+    newargv[newargc++] = "clone_fd";
+  }
 #endif
   if (fuse_debug)
     newargv[newargc++] = "-d";
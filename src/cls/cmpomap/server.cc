@@ -243,6 +243,7 @@ static int cmp_rm_keys(cls_method_context_t hctx, bufferlist *in, bufferlist *ou
     return r;
   }
 
+  std::set<std::string> to_remove;
   auto v = values.cbegin();
   for (const auto& [key, input] : op.values) {
     if (v == values.end() || v->first != key) {
@@ -270,15 +271,21 @@ static int cmp_rm_keys(cls_method_context_t hctx, bufferlist *in, bufferlist *ou
     } else {
       // successful comparison
       CLS_LOG(20, "cmp_rm_keys() removing key=%s", key.c_str());
-      r = cls_cxx_map_remove_key(hctx, key);
-      if (r < 0) {
-        CLS_LOG(1, "ERROR: cmp_rm_keys() failed to remove key=%s r=%d",
-                key.c_str(), r);
-        return r;
-      }
+      to_remove.insert(key);
     }
   }
 
+  if (to_remove.empty()) {
+    CLS_LOG(20, "cmp_rm_keys() has no keys to remove");
+    return 0;
+  }
+
+  CLS_LOG(20, "cmp_rm_keys() removing count=%d", (int)to_remove.size());
+  r = cls_cxx_map_remove_keys(hctx, to_remove);
+  if (r < 0) {
+    CLS_LOG(1, "ERROR: cmp_rm_keys() failed to remove keys r=%d", r);
+    return r;
+  }
   return 0;
 }
 
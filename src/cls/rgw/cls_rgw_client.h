@@ -357,6 +357,11 @@ void cls_rgw_bucket_complete_op(librados::ObjectWriteOperation& o, RGWModifyOp o
 				const std::list<cls_rgw_obj_key> *remove_objs, bool log_op,
                                 uint16_t bilog_op, const rgw_zone_set *zones_trace);
 
+// applies several completions to the same bucket index shard in one
+// call; requires OSDs that know RGW_BUCKET_COMPLETE_OPS
+void cls_rgw_bucket_complete_ops(librados::ObjectWriteOperation& o,
+                                 const std::vector<rgw_cls_obj_complete_op>& ops);
+
 void cls_rgw_remove_obj(librados::ObjectWriteOperation& o, std::list<std::string>& keep_attr_prefixes);
 void cls_rgw_obj_store_pg_ver(librados::ObjectWriteOperation& o, const std::string& attr);
 void cls_rgw_obj_check_attrs_prefix(librados::ObjectOperation& o, const std::string& prefix, bool fail_if_exist);
@@ -14,11 +14,21 @@ AsyncOpTracker::~AsyncOpTracker() {
 }
 
 void AsyncOpTracker::start_op() {
-  std::lock_guard locker(m_lock);
   ++m_pending_ops;
 }
 
 void AsyncOpTracker::finish_op() {
+  // while other ops are pending, the count cannot reach zero here and
+  // nobody can be waiting on us specifically
+  uint32_t pending_ops = m_pending_ops.load();
+  while (pending_ops > 1) {
+    if (m_pending_ops.compare_exchange_weak(pending_ops, pending_ops - 1)) {
+      return;
+    }
+  }
+
+  // possibly the last op: drop the count to zero under the lock, so that
+  // a waiter cannot see it (and tear us down) before we are done
   Context *on_finish = nullptr;
   {
     std::lock_guard locker(m_lock);
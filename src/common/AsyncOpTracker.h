@@ -6,6 +6,7 @@
 
 #include "common/ceph_mutex.h"
 #include "include/Context.h"
+#include <atomic>
 
 class AsyncOpTracker {
 public:
@@ -20,8 +21,10 @@ public:
   bool empty();
 
 private:
+  // ops are counted without m_lock unless the count may drop to zero,
+  // since start/finish are on the I/O path of every dispatch layer
   ceph::mutex m_lock = ceph::make_mutex("AsyncOpTracker::m_lock");
-  uint32_t m_pending_ops = 0;
+  std::atomic<uint32_t> m_pending_ops = {0};
   Context *m_on_finish = nullptr;
 
 };
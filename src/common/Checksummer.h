@@ -7,6 +7,7 @@
 #include "include/buffer.h"
 #include "include/byteorder.h"
 #include "include/ceph_assert.h"
+#include "include/crc32c.h"
 
 #include "xxHash/xxhash.h"
 
@@ -19,6 +20,7 @@ public:
     CSUM_CRC32C = 4,
     CSUM_CRC32C_16 = 5, // low 16 bits of crc32c
     CSUM_CRC32C_8 = 6,  // low 8 bits of crc32c
+    CSUM_XXH3_64 = 7,
     CSUM_MAX,
   };
   static const char *get_csum_type_string(unsigned t) {
@@ -29,6 +31,7 @@ public:
     case CSUM_CRC32C: return "crc32c";
     case CSUM_CRC32C_16: return "crc32c_16";
     case CSUM_CRC32C_8: return "crc32c_8";
+    case CSUM_XXH3_64: return "xxh3_64";
     default: return "???";
     }
   }
@@ -45,6 +48,8 @@ public:
       return CSUM_CRC32C_16;
     if (s == "crc32c_8")
       return CSUM_CRC32C_8;
+    if (s == "xxh3_64")
+      return CSUM_XXH3_64;
     return -EINVAL;
   }
 
@@ -56,6 +61,7 @@ public:
     case CSUM_CRC32C: return sizeof(crc32c::init_value_t);
     case CSUM_CRC32C_16: return sizeof(crc32c_16::init_value_t);
     case CSUM_CRC32C_8: return sizeof(crc32c_8::init_value_t);
+    case CSUM_XXH3_64: return sizeof(xxh3_64::init_value_t);
     default: return 0;
     }
   }
@@ -67,6 +73,7 @@ public:
     case CSUM_CRC32C: return 4;
     case CSUM_CRC32C_16: return 2;
     case CSUM_CRC32C_8: return 1;
+    case CSUM_XXH3_64: return 8;
     default: return 0;
     }
   }
@@ -90,6 +97,14 @@ public:
       ) {
       return p.crc32c(len, init_value);
     }
+    static init_value_t calc(
+      state_t state,
+      init_value_t init_value,
+      size_t len,
+      const char *data
+      ) {
+      return ceph_crc32c(init_value, (const unsigned char*)data, len);
+    }
   };
 
   struct crc32c_16 {
@@ -111,6 +126,14 @@ public:
       ) {
       return p.crc32c(len, init_value) & 0xffff;
     }
+    static init_value_t calc(
+      state_t state,
+      init_value_t init_value,
+      size_t len,
+      const char *data
+      ) {
+      return ceph_crc32c(init_value, (const unsigned char*)data, len) & 0xffff;
+    }
   };
 
   struct crc32c_8 {
@@ -132,6 +155,14 @@ public:
       ) {
       return p.crc32c(len, init_value) & 0xff;
     }
+    static init_value_t calc(
+      state_t state,
+      init_value_t init_value,
+      size_t len,
+      const char *data
+      ) {
+      return ceph_crc32c(init_value, (const unsigned char*)data, len) & 0xff;
+    }
   };
 
   struct xxhash32 {
@@ -161,6 +192,14 @@ public:
       }
       return XXH32_digest(state);
     }
+    static init_value_t calc(
+      state_t state,
+      init_value_t init_value,
+      size_t len,
+      const char *data
+      ) {
+      return XXH32(data, len, init_value);
+    }
   };
 
   struct xxhash64 {
@@ -190,8 +229,86 @@ public:
       }
       return XXH64_digest(state);
     }
+    static init_value_t calc(
+      state_t state,
+      init_value_t init_value,
+      size_t len,
+      const char *data
+      ) {
+      return XXH64(data, len, init_value);
+    }
   };
 
+  struct xxh3_64 {
+    typedef uint64_t init_value_t;
+    typedef ceph_le64 value_t;
+
+    typedef XXH3_state_t *state_t;
+    static void init(state_t *s) {
+      *s = XXH3_createState();
+    }
+    static void fini(state_t *s) {
+      XXH3_freeState(*s);
+    }
+
+    static init_value_t calc(
+      state_t state,
+      init_value_t init_value,
+      size_t len,
+      ceph::buffer::list::const_iterator& p
+      ) {
+      XXH3_64bits_reset_withSeed(state, init_value);
+      while (len > 0) {
+	const char *data;
+	size_t l = p.get_ptr_and_advance(len, &data);
+	XXH3_64bits_update(state, data, l);
+	len -= l;
+      }
+      return XXH3_64bits_digest(state);
+    }
+    static init_value_t calc(
+      state_t state,
+      init_value_t init_value,
+      size_t len,
+      const char *data
+      ) {
+      return XXH3_64bits_withSeed(data, len, init_value);
+    }
+  };
+
+  /// Call @f with the checksum of each of the next @blocks blocks of @p,
+  /// until it returns false.  Blocks that lie within one buffer are hashed
+  /// straight from memory, back to back; only those that straddle two
+  /// buffers go through the iterator.
+  template<class Alg, class F>
+  static void for_each_block(
+    typename Alg::state_t state,
+    typename Alg::init_value_t init_value,
+    size_t csum_block_size,
+    size_t blocks,
+    ceph::buffer::list::const_iterator& p,
+    F&& f) {
+    while (blocks > 0) {
+      auto cur = p.get_current_ptr();
+      size_t n = std::min(cur.length() / csum_block_size, blocks);
+      if (n == 0) {
+	if (!f(Alg::calc(state, init_value, csum_block_size, p))) {
+	  return;
+	}
+	--blocks;
+	continue;
+      }
+      const char *data = cur.c_str();
+      for (size_t i = 0; i < n; ++i, data += csum_block_size) {
+	if (!f(Alg::calc(state, init_value, csum_block_size, data))) {
+	  return;
+	}
+      }
+      p += n * csum_block_size;
+      blocks -= n;
+    }
+  }
+
   template<class Alg>
   static int calculate(
     size_t csum_block_size,
@@ -225,10 +342,12 @@ public:
     typename Alg::value_t *pv =
       reinterpret_cast<typename Alg::value_t*>(csum_data->c_str());
     pv += offset / csum_block_size;
-    while (blocks--) {
-      *pv = Alg::calc(state, init_value, csum_block_size, p);
-      ++pv;
-    }
+    for_each_block<Alg>(state, init_value, csum_block_size, blocks, p,
+      [&pv](typename Alg::init_value_t v) {
+	*pv = v;
+	++pv;
+	return true;
+      });
     Alg::fini(&state);
     return 0;
   }
@@ -253,21 +372,22 @@ public:
       reinterpret_cast<const typename Alg::value_t*>(csum_data.c_str());
     pv += offset / csum_block_size;
     size_t pos = offset;
-    while (length > 0) {
-      typename Alg::init_value_t v = Alg::calc(state, -1, csum_block_size, p);
-      if (*pv != v) {
-	if (bad_csum) {
-	  *bad_csum = v;
+    int bad = -1;  // no errors
+    for_each_block<Alg>(state, -1, csum_block_size, length / csum_block_size, p,
+      [&](typename Alg::init_value_t v) {
+	if (*pv != v) {
+	  if (bad_csum) {
+	    *bad_csum = v;
+	  }
+	  bad = pos;
+	  return false;
 	}
-	Alg::fini(&state);
-	return pos;
-      }
-      ++pv;
-      pos += csum_block_size;
-      length -= csum_block_size;
-    }
+	++pv;
+	pos += csum_block_size;
+	return true;
+      });
     Alg::fini(&state);
-    return -1;  // no errors
+    return bad;
   }
 };
 
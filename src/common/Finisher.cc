@@ -94,3 +94,140 @@ void *Finisher::finisher_thread_entry()
   return 0;
 }
 
+
+#undef dout_prefix
+#define dout_prefix *_dout << "finisher_pool(" << this << ") "
+
+FinisherPool::FinisherPool(CephContext *cct_, std::string name,
+			   std::string tn, unsigned n)
+  : cct(cct_), thread_name(std::move(tn)), num_threads(std::max(n, 1u)),
+    lock(ceph::make_mutex("FinisherPool::" + name))
+{
+  PerfCountersBuilder b(cct, std::string("finisher-") + name,
+			l_finisher_pool_first, l_finisher_pool_last);
+  b.add_u64(l_finisher_pool_queue_len, "queue_len");
+  b.add_time_avg(l_finisher_pool_queue_lat, "queue_latency",
+		 "Time contexts waited before being completed");
+  b.add_time_avg(l_finisher_pool_complete_lat, "complete_latency",
+		 "Time spent completing a context");
+  logger = b.create_perf_counters();
+  cct->get_perfcounters_collection()->add(logger);
+}
+
+FinisherPool::~FinisherPool()
+{
+  if (!threads.empty()) {
+    stop();
+  }
+  cct->get_perfcounters_collection()->remove(logger);
+  delete logger;
+}
+
+void FinisherPool::_queue(uint64_t key, Context *c, int r,
+			  ceph::mono_time now)
+{
+  if (num_threads == 1) {
+    // a single worker preserves the overall queue order
+    key = 0;
+  }
+  if (key) {
+    auto [p, inserted] = keyed.try_emplace(key);
+    p->second.push_back(Item{key, c, r, now});
+    if (inserted) {
+      ready.push_back(Item{key, nullptr, 0, now});
+    }
+  } else {
+    ready.push_back(Item{0, c, r, now});
+  }
+  logger->inc(l_finisher_pool_queue_len);
+}
+
+void FinisherPool::start()
+{
+  ldout(cct, 10) << __func__ << " " << num_threads << " threads" << dendl;
+  for (unsigned i = 0; i < num_threads; ++i) {
+    threads.push_back(make_named_thread(thread_name,
+					&FinisherPool::worker_entry, this));
+  }
+}
+
+void FinisherPool::stop()
+{
+  ldout(cct, 10) << __func__ << dendl;
+  {
+    std::lock_guard l(lock);
+    stopping = true;
+    cond.notify_all();
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  threads.clear();
+  std::lock_guard l(lock);
+  stopping = false;
+  empty_cond.notify_all();
+  ldout(cct, 10) << __func__ << " finish" << dendl;
+}
+
+void FinisherPool::wait_for_empty()
+{
+  std::unique_lock l(lock);
+  while ((!ready.empty() || running) && !stopping) {
+    ldout(cct, 10) << __func__ << " waiting" << dendl;
+    empty_wait = true;
+    empty_cond.wait(l);
+  }
+  ldout(cct, 10) << __func__ << " empty" << dendl;
+  empty_wait = false;
+}
+
+void FinisherPool::worker_entry()
+{
+  std::unique_lock l(lock);
+  ldout(cct, 10) << __func__ << " start" << dendl;
+  std::deque<Item> batch;
+  while (!stopping) {
+    if (ready.empty()) {
+      if (!running && unlikely(empty_wait)) {
+	empty_cond.notify_all();
+      }
+      cond.wait(l);
+      continue;
+    }
+    Item i = ready.front();
+    ready.pop_front();
+    if (i.c) {
+      batch.push_back(i);
+    } else {
+      // take everything pending for the key; the key stays in keyed, so
+      // contexts queued meanwhile wait for us rather than for another worker
+      batch.swap(keyed[i.key]);
+    }
+    ++running;
+    l.unlock();
+
+    for (auto& b : batch) {
+      auto start = ceph::mono_clock::now();
+      logger->tinc(l_finisher_pool_queue_lat, start - b.stamp);
+      b.c->complete(b.r);
+      logger->tinc(l_finisher_pool_complete_lat,
+		   ceph::mono_clock::now() - start);
+    }
+    logger->dec(l_finisher_pool_queue_len, batch.size());
+    batch.clear();
+
+    l.lock();
+    --running;
+    if (!i.c) {
+      auto p = keyed.find(i.key);
+      ceph_assert(p != keyed.end());
+      if (p->second.empty()) {
+	keyed.erase(p);
+      } else {
+	// more arrived while we ran; go to the back of the line
+	ready.push_back(Item{i.key, nullptr, 0, {}});
+      }
+    }
+  }
+  ldout(cct, 10) << __func__ << " stop" << dendl;
+}
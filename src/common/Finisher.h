@@ -15,6 +15,10 @@
 #ifndef CEPH_FINISHER_H
 #define CEPH_FINISHER_H
 
+#include <deque>
+#include <thread>
+#include <unordered_map>
+
 #include "include/Context.h"
 #include "include/common_fwd.h"
 #include "common/Thread.h"
@@ -31,6 +35,14 @@ enum {
   l_finisher_last
 };
 
+enum {
+  l_finisher_pool_first = 997090,
+  l_finisher_pool_queue_len,
+  l_finisher_pool_queue_lat,
+  l_finisher_pool_complete_lat,
+  l_finisher_pool_last
+};
+
 /** @brief Asynchronous cleanup class.
  * Finisher asynchronously completes Contexts, which are simple classes
  * representing callbacks, in a dedicated worker thread. Enqueuing
@@ -167,6 +179,93 @@ class Finisher {
   }
 };
 
+/** @brief Finisher with a pool of worker threads.
+ * Contexts queued with the same non-zero key are completed one at a
+ * time, in the order they were queued; contexts queued without a key
+ * are started in queue order but may run concurrently with anything
+ * else.  A pool with a single thread completes everything in queue
+ * order, exactly like a Finisher.
+ */
+class FinisherPool {
+  struct Item {
+    uint64_t key;
+    Context *c;  ///< nullptr: run the pending contexts of key
+    int r;
+    ceph::mono_time stamp;
+  };
+
+  CephContext *cct;
+  std::string thread_name;
+  unsigned num_threads;
+  ceph::mutex lock;
+  ceph::condition_variable cond;        ///< signaled when something is ready
+  ceph::condition_variable empty_cond;  ///< signaled when the pool drains
+  bool stopping = false;
+  bool empty_wait = false;
+  unsigned running = 0;     ///< workers currently completing contexts
+
+  /// unkeyed contexts and one placeholder per key that has work and is idle
+  std::deque<Item> ready;
+  /// contexts of keys that are ready or running; a key stays here, possibly
+  /// with nothing pending, while a worker completes its contexts
+  std::unordered_map<uint64_t, std::deque<Item>> keyed;
+
+  std::vector<std::thread> threads;
+  PerfCounters *logger = nullptr;
+
+  void _queue(uint64_t key, Context *c, int r, ceph::mono_time now);
+  void worker_entry();
+
+ public:
+  FinisherPool(CephContext *cct_, std::string name, std::string tn,
+	       unsigned n);
+  ~FinisherPool();
+
+  /// complete @c in queue order, but not necessarily one at a time
+  void queue(Context *c, int r = 0) {
+    queue(0, c, r);
+  }
+  /// complete @c after everything queued before it with the same @key
+  void queue(uint64_t key, Context *c, int r = 0) {
+    std::lock_guard l(lock);
+    _queue(key, c, r, ceph::mono_clock::now());
+    cond.notify_one();
+  }
+  template <typename C>
+  void queue(uint64_t key, C& ls) {
+    if (ls.empty()) {
+      return;
+    }
+    {
+      std::lock_guard l(lock);
+      auto now = ceph::mono_clock::now();
+      for (auto c : ls) {
+	_queue(key, c, 0, now);
+      }
+      if (!key && ls.size() > 1) {
+	cond.notify_all();
+      } else {
+	cond.notify_one();
+      }
+    }
+    ls.clear();
+  }
+  void queue(std::list<Context*>& ls) {
+    queue(0, ls);
+  }
+
+  unsigned get_num_threads() const {
+    return num_threads;
+  }
+
+  /// Start the worker threads.
+  void start();
+  /// Stop the worker threads; see Finisher::stop().
+  void stop();
+  /// Blocks until nothing is queued or running.
+  void wait_for_empty();
+};
+
 /// Context that is completed asynchronously on the supplied finisher.
 class C_OnFinisher : public Context {
   Context *con;
@@ -20,6 +20,7 @@
 
 #include <fmt/format.h>
 #include <algorithm>
+#include <charconv>
 #include <set>
 #include <limits>
 
@@ -157,44 +158,57 @@ JSONFormatter::JSONFormatter(bool p)
 void JSONFormatter::flush(std::ostream& os)
 {
   finish_pending_string();
-  os << m_ss.str();
+  os.write(m_buf.data(), m_buf.size());
   if (m_line_break_enabled)
     os << "\n";
-  m_ss.clear();
-  m_ss.str("");
+  m_buf.clear();
+}
+
+void JSONFormatter::flush(bufferlist &bl)
+{
+  finish_pending_string();
+  if (m_line_break_enabled)
+    m_buf += '\n';
+  bl.append(m_buf);
+  m_buf.clear();
 }
 
 void JSONFormatter::reset()
 {
   m_stack.clear();
-  m_ss.clear();
-  m_ss.str("");
+  m_buf.clear();
   m_pending_string.clear();
   m_pending_string.str("");
 }
 
+void JSONFormatter::print_indent()
+{
+  for (unsigned i = 1; i < m_stack.size(); i++)
+    m_buf.append("    ", 4);
+}
+
 void JSONFormatter::print_comma(json_formatter_stack_entry_d& entry)
 {
   if (entry.size) {
     if (m_pretty) {
-      m_ss << ",\n";
-      for (unsigned i = 1; i < m_stack.size(); i++)
-        m_ss << "    ";
+      m_buf.append(",\n", 2);
+      print_indent();
     } else {
-      m_ss << ",";
+      m_buf += ',';
     }
   } else if (m_pretty) {
-    m_ss << "\n";
-    for (unsigned i = 1; i < m_stack.size(); i++)
-      m_ss << "    ";
+    m_buf += '\n';
+    print_indent();
   }
   if (m_pretty && entry.is_array)
-    m_ss << "    ";
+    m_buf.append("    ", 4);
 }
 
 void JSONFormatter::print_quoted_string(std::string_view s)
 {
-  m_ss << '\"' << json_stream_escaper(s) << '\"';
+  m_buf += '\"';
+  escape_json_append(s, m_buf);
+  m_buf += '\"';
 }
 
 void JSONFormatter::print_name(std::string_view name)
@@ -206,13 +220,15 @@ void JSONFormatter::print_name(std::string_view name)
   print_comma(entry);
   if (!entry.is_array) {
     if (m_pretty) {
-      m_ss << "    ";
+      m_buf.append("    ", 4);
     }
-    m_ss << "\"" << name << "\"";
+    m_buf += '\"';
+    m_buf += name;
+    m_buf += '\"';
     if (m_pretty)
-      m_ss << ": ";
+      m_buf.append(": ", 2);
     else
-      m_ss << ':';
+      m_buf += ':';
   }
   ++entry.size;
 }
@@ -230,9 +246,9 @@ void JSONFormatter::open_section(std::string_view name, const char *ns, bool is_
     print_name(name);
   }
   if (is_array)
-    m_ss << '[';
+    m_buf += '[';
   else
-    m_ss << '{';
+    m_buf += '{';
 
   json_formatter_stack_entry_d n;
   n.is_array = is_array;
@@ -270,14 +286,14 @@ void JSONFormatter::close_section()
 
   struct json_formatter_stack_entry_d& entry = m_stack.back();
   if (m_pretty && entry.size) {
-    m_ss << "\n";
-    for (unsigned i = 1; i < m_stack.size(); i++)
-      m_ss << "    ";
+    m_buf += '\n';
+    print_indent();
   }
-  m_ss << (entry.is_array ? ']' : '}');
+  m_buf += (entry.is_array ? ']' : '}');
   m_stack.pop_back();
   if (m_pretty && m_stack.empty())
-    m_ss << "\n";
+    m_buf += '\n';
+  maybe_spill();
 }
 
 void JSONFormatter::finish_pending_string()
@@ -292,10 +308,16 @@ void JSONFormatter::finish_pending_string()
 template <class T>
 void JSONFormatter::add_value(std::string_view name, T val)
 {
-  std::stringstream ss;
-  ss.precision(std::numeric_limits<T>::max_digits10);
-  ss << val;
-  add_value(name, ss.str(), false);
+  char buf[32];
+  int len;
+  if constexpr (std::is_floating_point_v<T>) {
+    // what an ostream with precision max_digits10 prints
+    len = snprintf(buf, sizeof(buf), "%.*g",
+		   std::numeric_limits<T>::max_digits10, val);
+  } else {
+    len = std::to_chars(buf, buf + sizeof(buf), val).ptr - buf;
+  }
+  add_value(name, std::string_view(buf, len), false);
 }
 
 void JSONFormatter::add_value(std::string_view name, std::string_view val, bool quoted)
@@ -305,10 +327,11 @@ void JSONFormatter::add_value(std::string_view name, std::string_view val, bool
   }
   print_name(name);
   if (!quoted) {
-    m_ss << val;
+    m_buf += val;
   } else {
     print_quoted_string(val);
   }
+  maybe_spill();
 }
 
 void JSONFormatter::dump_unsigned(std::string_view name, uint64_t u)
@@ -349,12 +372,12 @@ void JSONFormatter::dump_format_va(std::string_view name, const char *ns, bool q
 
 int JSONFormatter::get_len() const
 {
-  return m_ss.str().size();
+  return m_buf.size();
 }
 
 void JSONFormatter::write_raw_data(const char *data)
 {
-  m_ss << data;
+  m_buf += data;
 }
 
 const char *XMLFormatter::XML_1_DTD =
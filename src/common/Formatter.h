@@ -7,11 +7,13 @@
 #include "include/buffer_fwd.h"
 
 #include <deque>
+#include <functional>
 #include <list>
 #include <memory>
 #include <vector>
 #include <stdarg.h>
 #include <sstream>
+#include <string>
 #include <map>
 
 namespace ceph {
@@ -75,7 +77,7 @@ namespace ceph {
 
     virtual void enable_line_break() = 0;
     virtual void flush(std::ostream& os) = 0;
-    void flush(bufferlist &bl);
+    virtual void flush(bufferlist &bl);
     virtual void reset() = 0;
 
     virtual void set_status(int status, const char* status_name) = 0;
@@ -149,7 +151,7 @@ namespace ceph {
     void output_footer() override {};
     void enable_line_break() override { m_line_break_enabled = true; }
     void flush(std::ostream& os) override;
-    using Formatter::flush; // don't hide Formatter::flush(bufferlist &bl)
+    void flush(bufferlist &bl) override;
     void reset() override;
     void open_array_section(std::string_view name) override;
     void open_array_section_in_ns(std::string_view name, const char *ns) override;
@@ -165,6 +167,17 @@ namespace ceph {
     int get_len() const override;
     void write_raw_data(const char *data) override;
 
+    /**
+     * hand the output to @c sink whenever at least @c threshold bytes have
+     * accumulated, instead of buffering all of it until flush().  flush()
+     * then only returns what has not been passed to @c sink yet.
+     */
+    void set_spill(std::function<void(std::string_view)> sink,
+		   size_t threshold) {
+      m_spill = std::move(sink);
+      m_spill_threshold = threshold;
+    }
+
   protected:
     virtual bool handle_value(std::string_view name, std::string_view s, bool quoted) {
       return false; /* is handling done? */
@@ -193,16 +206,26 @@ namespace ceph {
     void print_quoted_string(std::string_view s);
     void print_name(std::string_view name);
     void print_comma(json_formatter_stack_entry_d& entry);
+    void print_indent();
     void finish_pending_string();
 
     template <class T>
     void add_value(std::string_view name, T val);
     void add_value(std::string_view name, std::string_view val, bool quoted);
+    void maybe_spill() {
+      if (m_spill && m_buf.size() >= m_spill_threshold) {
+	m_spill(m_buf);
+	m_buf.clear();
+      }
+    }
 
-    copyable_sstream m_ss;
+    // output is appended here directly; flushing keeps the capacity
+    std::string m_buf;
+    std::function<void(std::string_view)> m_spill;
+    size_t m_spill_threshold = 0;
     copyable_sstream m_pending_string;
     std::string m_pending_name;
-    std::list<json_formatter_stack_entry_d> m_stack;
+    std::vector<json_formatter_stack_entry_d> m_stack;
     bool m_is_pending_string;
     bool m_line_break_enabled = false;
   };
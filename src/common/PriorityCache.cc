@@ -12,6 +12,8 @@
  *
  */
 
+#include <algorithm>
+
 #include "PriorityCache.h"
 #include "common/dout.h"
 #include "perfglue/heap_profiler.h"
@@ -400,6 +402,68 @@ namespace PriorityCache
     }
   }
 
+  Consumer::Consumer(const std::string& name, Priority pri,
+                     std::function<uint64_t()> usage,
+                     std::function<void(double)> on_scale)
+    : name(name), pri(pri), usage_fn(std::move(usage)),
+      on_scale(std::move(on_scale))
+  {
+    ceph_assert(pri > Priority::PRI0 && pri < Priority::LAST);
+  }
+
+  void Consumer::set_min_scale(double s)
+  {
+    s = std::clamp(s, 0.0, 1.0);
+    min_scale = s;
+    if (get_scale() < s) {
+      scale = s;
+    }
+  }
+
+  int64_t Consumer::request_cache_bytes(Priority p, uint64_t total_cache) const
+  {
+    int64_t floor = full_bytes * min_scale.load(std::memory_order_relaxed);
+    int64_t request = 0;
+    if (p == Priority::PRI0) {
+      request = floor;
+    } else if (p == pri) {
+      request = full_bytes - floor;
+    }
+    int64_t assigned = get_cache_bytes(p);
+    return request > assigned ? request - assigned : 0;
+  }
+
+  int64_t Consumer::get_cache_bytes() const
+  {
+    int64_t total = 0;
+    for (int i = 0; i < Priority::LAST + 1; i++) {
+      total += cache_bytes[i];
+    }
+    return total;
+  }
+
+  int64_t Consumer::commit_cache_size(uint64_t total_cache)
+  {
+    int64_t assigned = get_cache_bytes();
+    committed_bytes = get_chunk(assigned, total_cache);
+    double old_scale = get_scale();
+    double new_scale = old_scale;
+    if (full_bytes > 0) {
+      new_scale = std::clamp((double)assigned / full_bytes,
+                             min_scale.load(std::memory_order_relaxed), 1.0);
+    }
+    // the usage was reached at the old scale; an idle owner asks for
+    // nothing and keeps its scale until it is busy again
+    full_bytes = usage_fn() / std::max(old_scale, 0.01);
+    if (new_scale != old_scale) {
+      scale = new_scale;
+      if (on_scale) {
+        on_scale(new_scale);
+      }
+    }
+    return committed_bytes;
+  }
+
   PriCache::~PriCache()
   {
   }
@@ -16,6 +16,8 @@
 #define CEPH_PRIORITY_CACHE_H
 
 #include <stdint.h>
+#include <atomic>
+#include <functional>
 #include <string>
 #include <vector>
 #include <memory>
@@ -114,6 +116,71 @@ namespace PriorityCache {
     virtual uint64_t get_bins(PriorityCache::Priority pri) const = 0;
   };
 
+  /* A memory user that is not a cache but can be made to use less, e.g. a
+   * log that can be trimmed harder.  The owner runs at get_scale() (between
+   * the minimum scale and 1) times its configured limits; the consumer
+   * samples its usage, asks for the memory to run at full scale (the part
+   * below the minimum scale at PRI0, the rest at the given priority) and
+   * turns its assignment back into a scale.  The owner's memory use is
+   * assumed to be roughly proportional to the scale.
+   */
+  class Consumer : public PriCache {
+  public:
+    Consumer(const std::string& name, Priority pri,
+             std::function<uint64_t()> usage,
+             std::function<void(double)> on_scale = nullptr);
+
+    double get_scale() const {
+      return scale.load(std::memory_order_relaxed);
+    }
+    void set_min_scale(double s);
+
+    int64_t request_cache_bytes(Priority pri, uint64_t total_cache) const override;
+    int64_t get_cache_bytes(Priority pri) const override {
+      return cache_bytes[pri];
+    }
+    int64_t get_cache_bytes() const override;
+    void set_cache_bytes(Priority pri, int64_t bytes) override {
+      cache_bytes[pri] = bytes;
+    }
+    void add_cache_bytes(Priority pri, int64_t bytes) override {
+      cache_bytes[pri] += bytes;
+    }
+    int64_t commit_cache_size(uint64_t total_cache) override;
+    int64_t get_committed_size() const override {
+      return committed_bytes;
+    }
+    double get_cache_ratio() const override {
+      return cache_ratio;
+    }
+    void set_cache_ratio(double ratio) override {
+      cache_ratio = ratio;
+    }
+    std::string get_cache_name() const override {
+      return name;
+    }
+    void shift_bins() override {}
+    void import_bins(const std::vector<uint64_t> &bins) override {}
+    void set_bins(Priority pri, uint64_t end_bin) override {}
+    uint64_t get_bins(Priority pri) const override {
+      return 0;
+    }
+
+  private:
+    const std::string name;
+    const Priority pri;
+    std::function<uint64_t()> usage_fn;
+    std::function<void(double)> on_scale;
+    std::atomic<double> scale = {1.0};
+    std::atomic<double> min_scale = {0.0};
+
+    // state of the cache manager, which calls us from a single thread
+    uint64_t full_bytes = 0;  ///< estimated usage at scale 1
+    int64_t cache_bytes[Priority::LAST + 1] = {0};
+    int64_t committed_bytes = 0;
+    double cache_ratio = 0;
+  };
+
   class Manager {
     CephContext* cct = nullptr;
     PerfCounters* logger;
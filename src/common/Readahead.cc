@@ -10,6 +10,7 @@ Readahead::Readahead()
   : m_trigger_requests(10),
     m_readahead_min_bytes(0),
     m_readahead_max_bytes(NO_LIMIT),
+    m_readahead_cur_max_bytes(NO_LIMIT),
     m_alignments(),
     m_nr_consec_read(0),
     m_consec_read_bytes(0),
@@ -24,46 +25,91 @@ Readahead::~Readahead() {
 }
 
 Readahead::extent_t Readahead::update(const vector<extent_t>& extents, uint64_t limit) {
+  auto now = ceph::mono_clock::now();
   m_lock.lock();
   for (vector<extent_t>::const_iterator p = extents.begin(); p != extents.end(); ++p) {
-    _observe_read(p->first, p->second);
+    _observe_read(p->first, p->second, now);
   }
   if (m_readahead_pos >= limit|| m_last_pos >= limit) {
     m_lock.unlock();
     return extent_t(0, 0);
   }
-  std::pair<uint64_t, uint64_t> extent = _compute_readahead(limit);
+  std::pair<uint64_t, uint64_t> extent = _compute_readahead(limit, now);
   m_lock.unlock();
   return extent;
 }
 
 Readahead::extent_t Readahead::update(uint64_t offset, uint64_t length, uint64_t limit) {
+  return update(offset, length, limit, ceph::mono_clock::now());
+}
+
+Readahead::extent_t Readahead::update(uint64_t offset, uint64_t length, uint64_t limit,
+				      ceph::mono_time now) {
   m_lock.lock();
-  _observe_read(offset, length);
+  _observe_read(offset, length, now);
   if (m_readahead_pos >= limit || m_last_pos >= limit) {
     m_lock.unlock();
     return extent_t(0, 0);
   }
-  extent_t extent = _compute_readahead(limit);
+  extent_t extent = _compute_readahead(limit, now);
   m_lock.unlock();
   return extent;
 }
 
-void Readahead::_observe_read(uint64_t offset, uint64_t length) {
+void Readahead::_observe_read(uint64_t offset, uint64_t length,
+			      ceph::mono_time now) {
+  if (m_rate_start == ceph::mono_time()) {
+    m_rate_start = now;
+  }
   if (offset == m_last_pos) {
     m_nr_consec_read++;
     m_consec_read_bytes += length;
+    // the stream moved on, so the previous read is done
+    m_rate_bytes += m_last_length;
   } else {
     m_nr_consec_read = 0;
     m_consec_read_bytes = 0;
     m_readahead_trigger_pos = 0;
     m_readahead_size = 0;
     m_readahead_pos = 0;
+    // a new stream; keep what we learned about the window size
+    m_rate_start = now;
+    m_rate_bytes = 0;
+    m_rate = 0;
   }
   m_last_pos = offset + length;
+  m_last_length = length;
 }
 
-Readahead::extent_t Readahead::_compute_readahead(uint64_t limit) {
+void Readahead::_adapt_max(ceph::mono_time now) {
+  if (m_readahead_settled ||
+      m_readahead_cur_max_bytes >= m_readahead_adaptive_max_bytes ||
+      m_rate_bytes < m_readahead_cur_max_bytes) {
+    return;
+  }
+  // the stream has read a full window at the current maximum
+  double elapsed = std::chrono::duration<double>(now - m_rate_start).count();
+  if (elapsed <= 0) {
+    return;
+  }
+  double rate = m_rate_bytes / elapsed;
+  m_rate_start = now;
+  m_rate_bytes = 0;
+  if (m_rate > 0 && rate <= m_rate * 1.125) {
+    // no better than with half the window: bandwidth has plateaued
+    if (m_readahead_cur_max_bytes / 2 >= m_readahead_max_bytes) {
+      m_readahead_cur_max_bytes /= 2;
+    }
+    m_readahead_settled = true;
+    return;
+  }
+  m_rate = rate;
+  m_readahead_cur_max_bytes = std::min(m_readahead_cur_max_bytes * 2,
+				       m_readahead_adaptive_max_bytes);
+}
+
+Readahead::extent_t Readahead::_compute_readahead(uint64_t limit,
+						  ceph::mono_time now) {
   uint64_t readahead_offset = 0;
   uint64_t readahead_length = 0;
   if (m_nr_consec_read >= m_trigger_requests) {
@@ -81,8 +127,12 @@ Readahead::extent_t Readahead::_compute_readahead(uint64_t limit) {
 	  m_readahead_pos = m_last_pos;
 	}
       }
+      if (m_readahead_size >= m_readahead_cur_max_bytes &&
+	  m_readahead_adaptive_max_bytes) {
+	_adapt_max(now);
+      }
       m_readahead_size = std::max(m_readahead_size, m_readahead_min_bytes);
-      m_readahead_size = std::min(m_readahead_size, m_readahead_max_bytes);
+      m_readahead_size = std::min(m_readahead_size, m_readahead_cur_max_bytes);
       readahead_offset = m_readahead_pos;
       readahead_length = m_readahead_size;
 
@@ -186,9 +236,22 @@ void Readahead::set_min_readahead_size(uint64_t min_readahead_size) {
 void Readahead::set_max_readahead_size(uint64_t max_readahead_size) {
   m_lock.lock();
   m_readahead_max_bytes = max_readahead_size;
+  m_readahead_cur_max_bytes = max_readahead_size;
+  m_readahead_settled = false;
   m_lock.unlock();
 }
 
+void Readahead::set_adaptive_max_readahead_size(uint64_t max_readahead_size) {
+  std::lock_guard lock(m_lock);
+  m_readahead_adaptive_max_bytes = max_readahead_size;
+  m_readahead_settled = false;
+}
+
+uint64_t Readahead::get_cur_max_readahead_size(void) {
+  std::lock_guard lock(m_lock);
+  return m_readahead_cur_max_bytes;
+}
+
 void Readahead::set_alignments(const vector<uint64_t> &alignments) {
   m_lock.lock();
   m_alignments = alignments;
@@ -9,6 +9,7 @@
 
 #include "include/Context.h"
 #include "common/ceph_mutex.h"
+#include "common/ceph_time.h"
 
 /**
    This class provides common state and logic for code that needs to perform readahead
@@ -58,6 +59,12 @@ public:
    */
   extent_t update(uint64_t offset, uint64_t length, uint64_t limit);
 
+  /**
+     As above, with the current time given by the caller.
+   */
+  extent_t update(uint64_t offset, uint64_t length, uint64_t limit,
+		  ceph::mono_time now);
+
   /**
      Increment the pending counter.
    */
@@ -100,6 +107,22 @@ public:
    */
   void set_max_readahead_size(uint64_t max_readahead_size);
 
+  /**
+     Lets the maximum readahead size grow past the configured one, up to
+     \c max_readahead_size, as long as doing so raises the rate at which
+     the stream is read.  Whenever the window is at its maximum and the
+     stream has read a full window since the last check, the maximum is
+     doubled if the rate went up by more than 1/8, and otherwise goes
+     back to the last size that helped and stays there.  0 disables.
+   */
+  void set_adaptive_max_readahead_size(uint64_t max_readahead_size);
+
+  /**
+     Gets the maximum size of a readahead request currently in effect, in
+     bytes.
+   */
+  uint64_t get_cur_max_readahead_size(void);
+
   /**
      Sets the alignment units.
      If the end point of a readahead request can be aligned to an alignment unit
@@ -113,13 +136,20 @@ private:
      Records that a read request has been received.
      m_lock must be held while calling.
    */
-  void _observe_read(uint64_t offset, uint64_t length);
+  void _observe_read(uint64_t offset, uint64_t length, ceph::mono_time now);
+
+  /**
+     Grows or settles m_readahead_cur_max_bytes, see
+     set_adaptive_max_readahead_size().
+     m_lock must be held while calling.
+   */
+  void _adapt_max(ceph::mono_time now);
 
   /**
      Computes the next readahead request.
      m_lock must be held while calling.
   */
-  extent_t _compute_readahead(uint64_t limit);
+  extent_t _compute_readahead(uint64_t limit, ceph::mono_time now);
 
   /// Number of sequential requests necessary to trigger readahead
   int m_trigger_requests;
@@ -129,6 +159,19 @@ private:
 
   /// Maximum size of a readahead request, in bytes
   uint64_t m_readahead_max_bytes;
+  /// Upper bound for adapting the maximum size, or 0
+  uint64_t m_readahead_adaptive_max_bytes = 0;
+  /// Maximum size in effect, m_readahead_max_bytes unless adapted
+  uint64_t m_readahead_cur_max_bytes;
+  /// Whether adapting the maximum stopped helping
+  bool m_readahead_settled = false;
+  /// Start and bytes read of the current rate sample
+  ceph::mono_time m_rate_start;
+  uint64_t m_rate_bytes = 0;
+  /// Length of the last read
+  uint64_t m_last_length = 0;
+  /// Rate at the current maximum size, in bytes per second, or 0
+  double m_rate = 0;
 
   /// Alignment units, in bytes
   std::vector<uint64_t> m_alignments;
@@ -38,9 +38,29 @@ enum {
   l_throttle_put,
   l_throttle_put_sum,
   l_throttle_wait,
+  l_throttle_wait_histogram,
   l_throttle_last,
 };
 
+// Wait time axis configuration for the wait histogram, values are in
+// nanoseconds
+static PerfHistogramCommon::axis_config_d wait_hist_x_axis_config{
+  "Latency (usec)",
+  PerfHistogramCommon::SCALE_LOG2, ///< Latency in logarithmic scale
+  0,                               ///< Start at 0
+  1000,                            ///< Quantization unit is 1usec
+  32,                              ///< Enough to cover the longest waits
+};
+
+// Slots requested axis configuration for the wait histogram
+static PerfHistogramCommon::axis_config_d wait_hist_y_axis_config{
+  "Request size (slots)",
+  PerfHistogramCommon::SCALE_LOG2, ///< Request size in logarithmic scale
+  0,                               ///< Start at 0
+  1,                               ///< Quantization unit is 1 slot
+  40,                              ///< Enough to cover byte throttles
+};
+
 Throttle::Throttle(CephContext *cct, const std::string& n, int64_t m,
 		   bool _use_perf)
   : cct(cct), name(n), max(m),
@@ -65,6 +85,10 @@ Throttle::Throttle(CephContext *cct, const std::string& n, int64_t m,
     b.add_u64_counter(l_throttle_put, "put", "Puts");
     b.add_u64_counter(l_throttle_put_sum, "put_sum", "Put data");
     b.add_time_avg(l_throttle_wait, "wait", "Waiting latency");
+    b.add_u64_counter_histogram(
+      l_throttle_wait_histogram, "wait_histogram",
+      wait_hist_x_axis_config, wait_hist_y_axis_config,
+      "Histogram of waiting latency vs. slots requested");
 
     logger = { b.create_perf_counters(), cct };
     cct->get_perfcounters_collection()->add(logger.get());
@@ -94,22 +118,29 @@ bool Throttle::_wait(int64_t c, std::unique_lock<std::mutex>& l)
 {
   mono_time start;
   bool waited = false;
-  if (_should_wait(c) || !conds.empty()) { // always wait behind other waiters.
+  if (!conds.empty() || !_try_get(c)) { // always wait behind other waiters.
     {
       auto cv = conds.emplace(conds.end());
+      ++waiting;
       auto w = make_scope_guard([this, cv]() {
 	  conds.erase(cv);
+	  --waiting;
 	});
       waited = true;
       ldout(cct, 2) << "_wait waiting..." << dendl;
       if (logger)
 	start = mono_clock::now();
 
-      cv->wait(l, [this, c, cv]() { return (!_should_wait(c) &&
-					    cv == conds.begin()); });
+      // a put() that sees no waiter has already lowered count, and we
+      // check it here after counting ourselves in
+      cv->wait(l, [this, c, cv]() { return (cv == conds.begin() &&
+					    _try_get(c)); });
       ldout(cct, 2) << "_wait finished waiting" << dendl;
       if (logger) {
-	logger->tinc(l_throttle_wait, mono_clock::now() - start);
+	auto dur = mono_clock::now() - start;
+	logger->tinc(l_throttle_wait, dur);
+	logger->hinc(l_throttle_wait_histogram,
+		     std::chrono::nanoseconds(dur).count(), c);
       }
     }
     // wake up the next guy
@@ -163,14 +194,13 @@ bool Throttle::get(int64_t c, int64_t m)
     logger->inc(l_throttle_get_started);
   }
   bool waited = false;
-  {
+  if (m || waiting || !_try_get(c)) {
     std::unique_lock l(lock);
     if (m) {
       ceph_assert(m > 0);
       _reset_max(m);
     }
     waited = _wait(c, l);
-    count += c;
   }
   if (logger) {
     logger->inc(l_throttle_get);
@@ -192,17 +222,12 @@ bool Throttle::get_or_fail(int64_t c)
 
   assert (c >= 0);
   bool result = false;
-  {
-    std::lock_guard l(lock);
-    if (_should_wait(c) || !conds.empty()) {
-      ldout(cct, 10) << "get_or_fail " << c << " failed" << dendl;
-      result = false;
-    } else {
-      ldout(cct, 10) << "get_or_fail " << c << " success (" << count.load()
-	<< " -> " << (count.load() + c) << ")" << dendl;
-      count += c;
-      result = true;
-    }
+  if (waiting || !_try_get(c)) {
+    ldout(cct, 10) << "get_or_fail " << c << " failed" << dendl;
+    result = false;
+  } else {
+    ldout(cct, 10) << "get_or_fail " << c << " success" << dendl;
+    result = true;
   }
 
   if (logger) {
@@ -228,16 +253,15 @@ int64_t Throttle::put(int64_t c)
   ceph_assert(c >= 0);
   ldout(cct, 10) << "put " << c << " (" << count.load() << " -> "
 		 << (count.load()-c) << ")" << dendl;
-  int64_t new_count;
-  {
-    std::lock_guard l(lock);
-    new_count = count;
-    if (c) {
+  int64_t new_count = count;
+  if (c) {
+    new_count = count -= c;
+    // if count goes negative, we failed somewhere!
+    ceph_assert(new_count >= 0);
+    if (waiting) {
+      std::lock_guard l(lock);
       if (!conds.empty())
 	conds.front().notify_one();
-      // if count goes negative, we failed somewhere!
-      ceph_assert(count >= c);
-      new_count = count -= c;
     }
   }
   if (logger) {
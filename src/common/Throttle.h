@@ -36,6 +36,8 @@ class Throttle final : public ThrottleInterface {
   std::atomic<int64_t> count = { 0 }, max = { 0 };
   std::mutex lock;
   std::list<std::condition_variable> conds;
+  /// conds.size(), so that get() and put() can skip the lock without waiters
+  std::atomic<unsigned> waiting = { 0 };
   const bool use_perf;
 
 public:
@@ -44,15 +46,25 @@ public:
 
 private:
   void _reset_max(int64_t m);
-  bool _should_wait(int64_t c) const {
+  bool _should_wait(int64_t cur, int64_t c) const {
     int64_t m = max;
-    int64_t cur = count;
     return
       m &&
       ((c <= m && cur + c > m) || // normally stay under max
        (c >= m && cur > m));     // except for large c
   }
+  /// take @c slots if that does not exceed the limit
+  bool _try_get(int64_t c) {
+    int64_t cur = count;
+    do {
+      if (_should_wait(cur, c)) {
+	return false;
+      }
+    } while (!count.compare_exchange_weak(cur, cur + c));
+    return true;
+  }
 
+  /// take @c slots, waiting behind earlier waiters until they fit
   bool _wait(int64_t c, std::unique_lock<std::mutex>& l);
 
 public:
@@ -146,7 +146,10 @@ Context* CommonSafeTimer<Mutex>::add_event_at(CommonSafeTimer<Mutex>::clock_t::t
     return nullptr;
   }
   scheduled_map_t::value_type s_val(when, callback);
-  scheduled_map_t::iterator i = schedule.insert(s_val);
+  // most events are timeouts a fixed delay from now, which go last; the
+  // hint makes inserting those constant time, and keeps events due at the
+  // same time in the order they were added
+  scheduled_map_t::iterator i = schedule.insert(schedule.end(), s_val);
 
   event_lookup_map_t::value_type e_val(callback, i);
   pair < event_lookup_map_t::iterator, bool > rval(events.insert(e_val));
@@ -486,7 +486,11 @@ void TrackedOp::mark_event(std::string_view event, utime_t stamp)
 
   {
     std::lock_guard l(lock);
-    events.emplace_back(stamp, event);
+    if (sampled) {
+      events.emplace_back(stamp, event);
+    } else {
+      _ring_push(stamp, event);
+    }
   }
   dout(6) << " seq: " << seq
 	  << ", time: " << stamp
@@ -505,9 +509,35 @@ void TrackedOp::dump(utime_t now, Formatter *f) const
   f->dump_stream("initiated_at") << get_initiated();
   f->dump_float("age", now - get_initiated());
   f->dump_float("duration", get_duration());
+  {
+    std::lock_guard l(lock);
+    _flush_ring();
+  }
   {
     f->open_object_section("type_data");
     _dump(f);
     f->close_section();
   }
 }
+
+void TrackedOp::_flush_ring() const
+{
+  if (sampled)
+    return;
+  uint32_t n = std::min<uint32_t>(ring_count, OPTRACKER_RING_EVENTS);
+  uint32_t first = ring_count - n;
+  events.reserve(n + 2);
+  if (first > 0) {
+    // the oldest events were overwritten, "initiated" among them
+    events.emplace_back(initiated_at, "initiated");
+    if (first > 1) {
+      events.emplace_back(ring[first % OPTRACKER_RING_EVENTS].stamp,
+			  "(" + std::to_string(first - 1) + " events not recorded)");
+    }
+  }
+  for (uint32_t i = first; i < ring_count; ++i) {
+    auto& e = ring[i % OPTRACKER_RING_EVENTS];
+    events.emplace_back(e.stamp, e.get_str());
+  }
+  sampled = true;
+}
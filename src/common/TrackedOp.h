@@ -14,6 +14,7 @@
 #ifndef TRACKEDREQUEST_H_
 #define TRACKEDREQUEST_H_
 
+#include <array>
 #include <atomic>
 #include "common/ceph_mutex.h"
 #include "common/histogram.h"
@@ -23,6 +24,8 @@
 #include "msg/Message.h"
 
 #define OPTRACKER_PREALLOC_EVENTS 20
+#define OPTRACKER_RING_EVENTS 12
+#define OPTRACKER_RING_EVENT_LEN 31
 
 class TrackedOp;
 class OpHistory;
@@ -114,6 +117,9 @@ public:
     history_slow_op_size = new_size;
     history_slow_op_threshold = new_threshold;
   }
+  uint32_t get_slow_op_threshold() const {
+    return history_slow_op_threshold;
+  }
 };
 
 struct ShardedTrackingData;
@@ -126,6 +132,7 @@ class OpTracker {
   float complaint_time;
   int log_threshold;
   std::atomic<bool> tracking_enabled;
+  std::atomic<uint32_t> sample_rate = {1};
   ceph::shared_mutex lock = ceph::make_shared_mutex("OpTracker::lock");
 
 public:
@@ -148,6 +155,22 @@ public:
   void set_tracking(bool enable) {
     tracking_enabled = enable;
   }
+  /**
+   * record the full event timeline of only one in @rate ops
+   *
+   * the others keep their latest events in a small fixed-size ring and only
+   * make it to the op history if they turn out to be slow.
+   */
+  void set_sample_rate(uint32_t rate) {
+    sample_rate = std::max(rate, 1u);
+  }
+  bool is_sampled(uint64_t op_seq) const {
+    uint32_t rate = sample_rate.load(std::memory_order_relaxed);
+    return rate <= 1 || op_seq % rate == 0;
+  }
+  uint32_t get_history_slow_op_threshold() const {
+    return history.get_slow_op_threshold();
+  }
   bool dump_ops_in_flight(ceph::Formatter *f, bool print_only_blocked = false, std::set<std::string> filters = {""}, bool count_only = false);
   bool dump_historic_ops(ceph::Formatter *f, bool by_duration = false, std::set<std::string> filters = {""});
   bool dump_historic_slow_ops(ceph::Formatter *f, std::set<std::string> filters = {""});
@@ -265,10 +288,26 @@ protected:
     }
   };
 
-  std::vector<Event> events;    ///< std::list of events and their times
+  /// event of an unsampled op, recorded without allocating
+  struct CompactEvent {
+    utime_t stamp;
+    uint8_t len = 0;
+    char str[OPTRACKER_RING_EVENT_LEN];
+
+    std::string_view get_str() const {
+      return std::string_view(str, len);
+    }
+  };
+
+  mutable std::vector<Event> events;    ///< std::list of events and their times
   mutable ceph::mutex lock = ceph::make_mutex("TrackedOp::lock"); ///< to protect the events list
   uint64_t seq = 0;        ///< a unique value std::set by the OpTracker
 
+  /// false if events go to the ring until someone looks at them
+  mutable bool sampled = true;  ///< protected by lock
+  mutable uint32_t ring_count = 0;  ///< events ever put in the ring
+  mutable std::array<CompactEvent, OPTRACKER_RING_EVENTS> ring;
+
   uint32_t warn_interval_multiplier = 1; //< limits output of a given op warning
 
   enum {
@@ -286,7 +325,18 @@ protected:
     tracker(_tracker),
     initiated_at(initiated)
   {
-    events.reserve(OPTRACKER_PREALLOC_EVENTS);
+  }
+
+  void _ring_push(utime_t stamp, std::string_view event) const {
+    auto& e = ring[ring_count++ % OPTRACKER_RING_EVENTS];
+    e.stamp = stamp;
+    e.len = std::min<size_t>(event.size(), OPTRACKER_RING_EVENT_LEN);
+    memcpy(e.str, event.data(), e.len);
+  }
+  /// move the ring into events; called with lock held
+  void _flush_ring() const;
+  const CompactEvent* _ring_back() const {
+    return ring_count ? &ring[(ring_count - 1) % OPTRACKER_RING_EVENTS] : nullptr;
   }
 
   /// output any type-specific data you want to get when dump() is called
@@ -325,7 +375,9 @@ public:
 	mark_event("done");
 	tracker->unregister_inflight_op(this);
 	_unregistered();
-	if (!tracker->is_tracking()) {
+	if (!tracker->is_tracking() ||
+	    (!is_sampled() &&
+	     get_duration() < tracker->get_history_slow_op_threshold())) {
 	  delete this;
 	} else {
 	  state = TrackedOp::STATE_HISTORY;
@@ -372,20 +424,42 @@ public:
 
   double get_duration() const {
     std::lock_guard l(lock);
-    if (!events.empty() && events.rbegin()->compare("done") == 0)
+    if (!sampled) {
+      auto e = _ring_back();
+      if (e && e->get_str() == "done")
+	return e->stamp - get_initiated();
+    } else if (!events.empty() && events.rbegin()->compare("done") == 0)
       return events.rbegin()->stamp - get_initiated();
-    else
-      return ceph_clock_now() - get_initiated();
+    return ceph_clock_now() - get_initiated();
+  }
+
+  bool is_sampled() const {
+    std::lock_guard l(lock);
+    return sampled;
   }
 
   void mark_event(std::string_view event, utime_t stamp=ceph_clock_now());
 
+  /// call @f with each event recorded so far, oldest first
+  template <typename Func>
+  void visit_events(Func&& f) const {
+    std::lock_guard l(lock);
+    _flush_ring();
+    for (auto& e : events) {
+      f(e.stamp, std::string_view(e.str));
+    }
+  }
+
   void mark_nowarn() {
     warn_interval_multiplier = 0;
   }
 
   virtual std::string_view state_string() const {
     std::lock_guard l(lock);
+    if (!sampled) {
+      auto e = _ring_back();
+      return e ? e->get_str() : std::string_view();
+    }
     return events.empty() ? std::string_view() : std::string_view(events.rbegin()->str);
   }
 
@@ -393,7 +467,13 @@ public:
 
   void tracking_start() {
     if (tracker->register_inflight_op(this)) {
-      events.emplace_back(initiated_at, "initiated");
+      sampled = tracker->is_sampled(seq);
+      if (sampled) {
+	events.reserve(OPTRACKER_PREALLOC_EVENTS);
+	events.emplace_back(initiated_at, "initiated");
+      } else {
+	_ring_push(initiated_at, "initiated");
+      }
       state = STATE_LIVE;
     }
   }
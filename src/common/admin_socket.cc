@@ -18,6 +18,9 @@
 #include "common/admin_socket_client.h"
 #include "common/dout.h"
 #include "common/errno.h"
+#include "common/Finisher.h"
+#include "common/perf_counters.h"
+#include "common/perf_counters_key.h"
 #include "common/safe_io.h"
 #include "common/Thread.h"
 #include "common/version.h"
@@ -104,6 +107,34 @@ static void add_cleanup_file(std::string file) {
   }
 }
 
+enum {
+  l_asok_first = 96900,
+  l_asok_calls,
+  l_asok_latency,
+  l_asok_last,
+};
+
+/// size of the chunks a streamed reply is sent in
+static constexpr size_t stream_chunk_size = 64 << 10;
+
+namespace {
+/// a request read from the socket; closed when the reply is out
+struct AsokConnection {
+  int fd;
+  bool streaming = false;  ///< CEPH_ADMIN_SOCK_STREAM has been sent
+  bool failed = false;
+
+  explicit AsokConnection(int fd) : fd(fd) {}
+  ~AsokConnection() {
+    retry_sys_call(::compat_closesocket, fd);
+  }
+  int send_len(uint32_t len) {
+    uint32_t be = htonl(len);
+    return safe_send(fd, &be, sizeof(be));
+  }
+};
+}
+
 AdminSocket::AdminSocket(CephContext *cct)
   : m_cct(cct)
 {}
@@ -115,7 +146,8 @@ AdminSocket::~AdminSocket()
 
 /*
  * This thread listens on the UNIX domain socket for incoming connections.
- * It only handles one connection at a time at the moment. All I/O is nonblocking,
+ * It reads one request at a time and hands it to the worker pool, which
+ * runs the command and sends the reply. All I/O is nonblocking,
  * so that we can implement sensible timeouts. [TODO: make all I/O nonblocking]
  *
  * This thread also listens to m_wakeup_rd_fd. If there is any data sent to this
@@ -374,36 +406,65 @@ void AdminSocket::do_accept()
     }
   }
 
+  auto conn = std::make_shared<AsokConnection>(connection_fd);
   std::vector<std::string> cmdvec = { c };
-  bufferlist empty, out;
-  ostringstream err;
-  int rval = execute_command(cmdvec, empty /* inbl */, err, &out);
-
-  // Unfortunately, the asok wire protocol does not let us pass an error code,
-  // and many asok command implementations return helpful error strings.  So,
-  // let's prepend an error string to the output if there is an error code.
-  if (rval < 0) {
-    ostringstream ss;
-    ss << "ERROR: " << cpp_strerror(rval) << "\n";
-    ss << err.str() << "\n";
-    bufferlist o;
-    o.append(ss.str());
-    o.claim_append(out);
-    out.claim_append(o);
-  }
-  uint32_t len = htonl(out.length());
-  int ret = safe_send(connection_fd, &len, sizeof(len));
-  if (ret < 0) {
-    lderr(m_cct) << "AdminSocket: error writing response length "
-		 << cpp_strerror(ret) << dendl;
-  } else {
-    int r = out.send_fd(connection_fd);
-    if (r < 0) {
-      lderr(m_cct) << "AdminSocket: error writing response payload "
-		   << cpp_strerror(ret) << dendl;
-    }
-  }
-  retry_sys_call(::compat_closesocket, connection_fd);
+  queue_command(
+    cmdvec, bufferlist() /* inbl */,
+    [this, conn](std::string_view chunk) {
+      if (conn->failed || chunk.empty()) {
+	return;
+      }
+      int r = 0;
+      if (!conn->streaming) {
+	conn->streaming = true;
+	r = conn->send_len(CEPH_ADMIN_SOCK_STREAM);
+      }
+      if (r >= 0) {
+	r = conn->send_len(chunk.size());
+      }
+      if (r >= 0) {
+	r = safe_send(conn->fd, chunk.data(), chunk.size());
+      }
+      if (r < 0) {
+	lderr(m_cct) << "AdminSocket: error streaming response "
+		     << cpp_strerror(r) << dendl;
+	conn->failed = true;
+      }
+    },
+    [this, conn](int rval, const std::string& err, bufferlist& out) {
+      // Unfortunately, the asok wire protocol does not let us pass an error
+      // code, and many asok command implementations return helpful error
+      // strings.  So, let's prepend an error string to the output if there
+      // is an error code.
+      if (rval < 0) {
+	ostringstream ss;
+	ss << "ERROR: " << cpp_strerror(rval) << "\n";
+	ss << err << "\n";
+	bufferlist o;
+	o.append(ss.str());
+	o.claim_append(out);
+	out.claim_append(o);
+      }
+      if (conn->failed) {
+	return;
+      }
+      // a streamed reply ends with an empty chunk
+      int ret = conn->send_len(out.length());
+      if (ret < 0) {
+	lderr(m_cct) << "AdminSocket: error writing response length "
+		     << cpp_strerror(ret) << dendl;
+	return;
+      }
+      int r = out.send_fd(conn->fd);
+      if (r < 0) {
+	lderr(m_cct) << "AdminSocket: error writing response payload "
+		     << cpp_strerror(r) << dendl;
+	return;
+      }
+      if (conn->streaming && out.length()) {
+	conn->send_len(0);
+      }
+    });
 }
 
 void AdminSocket::do_tell_queue()
@@ -417,10 +478,10 @@ void AdminSocket::do_tell_queue()
     lq.swap(tell_legacy_queue);
   }
   for (auto& m : q) {
-    bufferlist outbl;
-    execute_command(
+    queue_command(
       m->cmd,
       m->get_data(),
+      nullptr,
       [m](int r, const std::string& err, bufferlist& outbl) {
 	auto reply = new MCommandReply(r, err);
 	reply->set_tid(m->get_tid());
@@ -433,10 +494,10 @@ void AdminSocket::do_tell_queue()
       });
   }
   for (auto& m : lq) {
-    bufferlist outbl;
-    execute_command(
+    queue_command(
       m->cmd,
       m->get_data(),
+      nullptr,
       [m](int r, const std::string& err, bufferlist& outbl) {
 	auto reply = new MMonCommandAck(m->cmd, r, err, 0);
 	reply->set_tid(m->get_tid());
@@ -487,55 +548,142 @@ void AdminSocket::execute_command(
   std::function<void(int,const std::string&,bufferlist&)> on_finish)
 {
   cmdmap_t cmdmap;
+  string prefix;
+  auto hook = prepare_command(cmdvec, cmdmap, prefix, on_finish);
+  if (hook) {
+    run_command(hook, prefix, cmdmap, inbl, nullptr, std::move(on_finish));
+  }
+}
+
+void AdminSocket::queue_command(
+  const std::vector<std::string>& cmdvec,
+  const bufferlist& inbl,
+  spill_t spill,
+  on_finish_t on_finish)
+{
+  cmdmap_t cmdmap;
+  string prefix;
+  auto hook = prepare_command(cmdvec, cmdmap, prefix, on_finish);
+  if (!hook) {
+    return;
+  }
+  // keyed by hook: handlers were written for a single asok thread and
+  // must not race with themselves
+  workers->queue(
+    reinterpret_cast<uint64_t>(hook),
+    new LambdaContext(
+      [this, hook, prefix = std::move(prefix), cmdmap = std::move(cmdmap),
+       inbl, spill = std::move(spill),
+       on_finish = std::move(on_finish)](int) mutable {
+	run_command(hook, prefix, cmdmap, inbl, std::move(spill),
+		    std::move(on_finish));
+      }));
+}
+
+AdminSocketHook* AdminSocket::prepare_command(
+  const std::vector<std::string>& cmdvec,
+  cmdmap_t& cmdmap,
+  std::string& prefix,
+  const on_finish_t& on_finish)
+{
   string format;
   stringstream errss;
   bufferlist empty;
   ldout(m_cct,10) << __func__ << " cmdvec='" << cmdvec << "'" << dendl;
   if (!cmdmap_from_json(cmdvec, &cmdmap, errss)) {
     ldout(m_cct, 0) << "AdminSocket: " << errss.str() << dendl;
-    return on_finish(-EINVAL, "invalid json", empty);
+    on_finish(-EINVAL, "invalid json", empty);
+    return nullptr;
   }
-  string prefix;
   try {
     cmd_getval(cmdmap, "format", format);
     cmd_getval(cmdmap, "prefix", prefix);
   } catch (const bad_cmd_get& e) {
-    return on_finish(-EINVAL, "invalid json, missing format and/or prefix",
-		     empty);
+    on_finish(-EINVAL, "invalid json, missing format and/or prefix", empty);
+    return nullptr;
   }
 
-  auto f = Formatter::create(format, "json-pretty", "json-pretty");
-
   auto [retval, hook] = find_matched_hook(prefix, cmdmap);
   switch (retval) {
   case ENOENT:
     lderr(m_cct) << "AdminSocket: request '" << cmdvec
 		 << "' not defined" << dendl;
-    delete f;
-    return on_finish(-EINVAL, "unknown command prefix "s + prefix, empty);
+    on_finish(-EINVAL, "unknown command prefix "s + prefix, empty);
+    return nullptr;
   case EINVAL:
-    delete f;
-    return on_finish(-EINVAL, "invalid command json", empty);
+    on_finish(-EINVAL, "invalid command json", empty);
+    return nullptr;
   default:
     assert(retval == 0);
   }
+  return hook;
+}
+
+void AdminSocket::run_command(
+  AdminSocketHook* hook,
+  const std::string& prefix,
+  const cmdmap_t& cmdmap,
+  const bufferlist& inbl,
+  spill_t spill,
+  on_finish_t on_finish)
+{
+  string format;
+  cmd_getval(cmdmap, "format", format);
+  auto f = Formatter::create(format, "json-pretty", "json-pretty");
+
+  bool stream = false;
+  try {
+    cmd_getval(cmdmap, "stream", stream);
+  } catch (const bad_cmd_get& e) {
+  }
+  if (stream && spill) {
+    // only JSON output can be cut into pieces as it is produced
+    if (auto jf = dynamic_cast<ceph::JSONFormatter*>(f); jf) {
+      jf->set_spill(std::move(spill), stream_chunk_size);
+    }
+  }
 
+  auto start = ceph::mono_clock::now();
   hook->call_async(
     prefix, cmdmap, f, inbl,
-    [f, on_finish](int r, const std::string& err, bufferlist& out) {
+    [this, f, prefix, start, on_finish = std::move(on_finish)](
+      int r, const std::string& err, bufferlist& out) {
       // handle either existing output in bufferlist *or* via formatter
       if (r >= 0 && out.length() == 0) {
 	f->flush(out);
       }
       delete f;
+      account(prefix, ceph::mono_clock::now() - start);
       on_finish(r, err, out);
     });
 
   std::unique_lock l(lock);
-  in_hook = false;
+  --in_hook;
   in_hook_cond.notify_all();
 }
 
+void AdminSocket::account(const std::string& prefix, ceph::timespan lat)
+{
+  std::lock_guard l(stats_lock);
+  if (stats_shutdown) {
+    return;
+  }
+  auto p = command_stats.find(prefix);
+  if (p == command_stats.end()) {
+    PerfCountersBuilder plb(
+      m_cct,
+      ceph::perf_counters::key_create("asok_command", {{"prefix", prefix}}),
+      l_asok_first, l_asok_last);
+    plb.add_u64_counter(l_asok_calls, "calls", "Commands executed");
+    plb.add_time_avg(l_asok_latency, "latency", "Command execution latency");
+    auto logger = plb.create_perf_counters();
+    m_cct->get_perfcounters_collection()->add(logger);
+    p = command_stats.emplace(prefix, logger).first;
+  }
+  p->second->inc(l_asok_calls);
+  p->second->tinc(l_asok_latency, lat);
+}
+
 std::pair<int, AdminSocketHook*>
 AdminSocket::find_matched_hook(std::string& prefix,
 			       const cmdmap_t& cmdmap)
@@ -553,7 +701,7 @@ AdminSocket::find_matched_hook(std::string& prefix,
   stringstream errss;
   for (auto hook = hooks_begin; hook != hooks_end; ++hook) {
     if (validate_cmd(hook->second.desc, cmdmap, errss)) {
-      in_hook = true;
+      ++in_hook;
       return {0, hook->second.hook};
     }
   }
@@ -612,7 +760,7 @@ void AdminSocket::unregister_commands(const AdminSocketHook *hook)
       // If we are currently processing a command, wait for it to
       // complete in case it referenced the hook that we are
       // unregistering.
-      in_hook_cond.wait(l, [this]() { return !in_hook; });
+      in_hook_cond.wait(l, [this]() { return in_hook == 0; });
       hooks.erase(i++);
     } else {
       i++;
@@ -654,6 +802,7 @@ public:
 	   Formatter *f,
 	   std::ostream& errss,
 	   bufferlist& out) override {
+    std::lock_guard l(m_as->lock);
     f->open_object_section("help");
     for (const auto& [command, info] : m_as->hooks) {
       if (info.help.length())
@@ -673,6 +822,7 @@ public:
 	   Formatter *f,
 	   std::ostream& errss,
 	   bufferlist& out) override {
+    std::lock_guard l(m_as->lock);
     int cmdnum = 0;
     f->open_object_section("command_descriptions");
     for (const auto& [command, info] : m_as->hooks) {
@@ -745,6 +895,14 @@ bool AdminSocket::init(const std::string& path)
   register_command("get_command_descriptions",
 		   getdescs_hook.get(), "list available commands");
 
+  workers = std::make_unique<FinisherPool>(
+    m_cct, "admin_socket", "asok_cmd", m_cct->_conf->admin_socket_threads);
+  workers->start();
+  {
+    std::lock_guard l(stats_lock);
+    stats_shutdown = false;
+  }
+
   th = make_named_thread("admin_socket", &AdminSocket::entry, this);
   add_cleanup_file(m_path.c_str());
   return true;
@@ -768,6 +926,22 @@ void AdminSocket::shutdown()
 
   retry_sys_call(::compat_closesocket, m_sock_fd);
 
+  // nothing is queued once the accept thread is gone; let running commands
+  // finish before their hooks go away
+  workers->wait_for_empty();
+  workers->stop();
+  workers.reset();
+
+  {
+    std::lock_guard l(stats_lock);
+    stats_shutdown = true;
+    for (auto& [prefix, logger] : command_stats) {
+      m_cct->get_perfcounters_collection()->remove(logger);
+      delete logger;
+    }
+    command_stats.clear();
+  }
+
   unregister_commands(version_hook.get());
   version_hook.reset();
 
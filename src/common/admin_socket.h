@@ -20,6 +20,8 @@
 #else
 
 #include <condition_variable>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <string_view>
@@ -27,14 +29,20 @@
 
 #include "include/buffer.h"
 #include "include/common_fwd.h"
+#include "common/ceph_time.h"
 #include "common/ref.h"
 #include "common/cmdparse.h"
 
+class FinisherPool;
 class MCommand;
 class MMonCommand;
 
 inline constexpr auto CEPH_ADMIN_SOCK_VERSION = std::string_view("2");
 
+/// sent instead of the reply length when a reply is streamed; the
+/// output then follows as __be32 length prefixed chunks up to an empty one
+inline constexpr uint32_t CEPH_ADMIN_SOCK_STREAM = 0xffffffff;
+
 class AdminSocketHook {
 public:
   /**
@@ -164,6 +172,33 @@ public:
   void queue_tell_command(ceph::cref_t<MMonCommand> m); // for compat
 
 private:
+  using on_finish_t =
+    std::function<void(int,const std::string&,ceph::buffer::list&)>;
+  using spill_t = std::function<void(std::string_view)>;
+
+  /// parse @p cmdvec and look up its hook; on error @p on_finish is
+  /// called and nullptr returned.  on success the caller must run_command().
+  AdminSocketHook* prepare_command(
+    const std::vector<std::string>& cmdvec,
+    cmdmap_t& cmdmap,
+    std::string& prefix,
+    const on_finish_t& on_finish);
+  /// call @p hook; output goes to @p spill as it is produced if the
+  /// command asked for "stream" and the formatter supports it
+  void run_command(
+    AdminSocketHook* hook,
+    const std::string& prefix,
+    const cmdmap_t& cmdmap,
+    const ceph::buffer::list& inbl,
+    spill_t spill,
+    on_finish_t on_finish);
+  /// run the command on the worker pool
+  void queue_command(
+    const std::vector<std::string>& cmdvec,
+    const ceph::buffer::list& inbl,
+    spill_t spill,
+    on_finish_t on_finish);
+  void account(const std::string& prefix, ceph::timespan lat);
 
   void shutdown();
   void wakeup();
@@ -177,6 +212,10 @@ private:
   void do_accept();
   void do_tell_queue();
 
+  /// runs socket and tell commands; a hook is never called concurrently
+  /// with itself
+  std::unique_ptr<FinisherPool> workers;
+
   CephContext *m_cct;
   std::string m_path;
   int m_sock_fd = -1;
@@ -184,7 +223,7 @@ private:
   int m_wakeup_wr_fd = -1;
   bool m_shutdown = false;
 
-  bool in_hook = false;
+  unsigned in_hook = 0;  ///< commands between lookup and call
   std::condition_variable in_hook_cond;
   std::mutex lock;  // protects `hooks`
   std::unique_ptr<AdminSocketHook> version_hook;
@@ -212,6 +251,11 @@ private:
 
   std::multimap<std::string, hook_info, std::less<>> hooks;
 
+  std::mutex stats_lock;  // protects `command_stats`
+  bool stats_shutdown = false;
+  /// per command prefix call counts and latencies, created on first use
+  std::map<std::string, PerfCounters*, std::less<>> command_stats;
+
   friend class AdminSocketTest;
   friend class HelpHook;
   friend class GetdescsHook;
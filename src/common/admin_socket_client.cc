@@ -154,14 +154,42 @@ std::string AdminSocketClient::do_request(std::string request, std::string *resu
     goto done;
   }
   message_size = ntohl(message_size_raw);
-  buffer.resize(message_size, 0);
-  res = safe_recv_exact(socket_fd, &buffer[0], message_size);
-  if (res < 0) {
-    int e = res;
-    ostringstream oss;
-    oss << "safe_recv(" << socket_fd << ") failed: " << cpp_strerror(e);
-    err = oss.str();
-    goto done;
+  if (message_size == CEPH_ADMIN_SOCK_STREAM) {
+    // streamed reply: chunks up to an empty one
+    while (true) {
+      res = safe_recv_exact(socket_fd, &message_size_raw,
+			    sizeof(message_size_raw));
+      if (res < 0) {
+	ostringstream oss;
+	oss << "safe_recv(" << socket_fd << ") failed to read chunk size: "
+	    << cpp_strerror(res);
+	err = oss.str();
+	goto done;
+      }
+      message_size = ntohl(message_size_raw);
+      if (message_size == 0) {
+	break;
+      }
+      size_t pos = buffer.size();
+      buffer.resize(pos + message_size, 0);
+      res = safe_recv_exact(socket_fd, &buffer[pos], message_size);
+      if (res < 0) {
+	ostringstream oss;
+	oss << "safe_recv(" << socket_fd << ") failed: " << cpp_strerror(res);
+	err = oss.str();
+	goto done;
+      }
+    }
+  } else {
+    buffer.resize(message_size, 0);
+    res = safe_recv_exact(socket_fd, &buffer[0], message_size);
+    if (res < 0) {
+      int e = res;
+      ostringstream oss;
+      oss << "safe_recv(" << socket_fd << ") failed: " << cpp_strerror(e);
+      err = oss.str();
+      goto done;
+    }
   }
   //printf("MESSAGE FROM SERVER: %s\n", buffer.c_str());
   std::swap(*result, buffer);
@@ -217,6 +217,20 @@ int BlkDev::discard(int64_t offset, int64_t len) const
   return ioctl(fd, BLKDISCARD, range);
 }
 
+bool BlkDev::support_write_zeroes() const
+{
+  return get_int_property("queue/write_zeroes_max_bytes") > 0;
+}
+
+int BlkDev::zeroout(int64_t offset, int64_t len) const
+{
+  uint64_t range[2] = {(uint64_t)offset, (uint64_t)len};
+  if (ioctl(fd, BLKZEROOUT, range) < 0) {
+    return -errno;
+  }
+  return 0;
+}
+
 int BlkDev::get_optimal_io_size() const
 {
 	return get_int_property("queue/optimal_io_size");
@@ -775,6 +789,16 @@ int BlkDev::discard(int64_t offset, int64_t len) const
   return -EOPNOTSUPP;
 }
 
+bool BlkDev::support_write_zeroes() const
+{
+  return false;
+}
+
+int BlkDev::zeroout(int64_t offset, int64_t len) const
+{
+  return -EOPNOTSUPP;
+}
+
 int BlkDev::get_optimal_io_size() const
 {
   return 0;
@@ -894,6 +918,16 @@ int BlkDev::discard(int64_t offset, int64_t len) const
   return -EOPNOTSUPP;
 }
 
+bool BlkDev::support_write_zeroes() const
+{
+  return false;
+}
+
+int BlkDev::zeroout(int64_t offset, int64_t len) const
+{
+  return -EOPNOTSUPP;
+}
+
 int BlkDev::get_optimal_io_size() const
 {
   return 0;
@@ -1084,6 +1118,16 @@ int BlkDev::discard(int fd, int64_t offset, int64_t len) const
   return -EOPNOTSUPP;
 }
 
+bool BlkDev::support_write_zeroes() const
+{
+  return false;
+}
+
+int BlkDev::zeroout(int64_t offset, int64_t len) const
+{
+  return -EOPNOTSUPP;
+}
+
 bool BlkDev::is_rotational(const char *devname) const
 {
   return false;
@@ -45,11 +45,13 @@ public:
 
   // from an fd
   int discard(int64_t offset, int64_t len) const;
+  int zeroout(int64_t offset, int64_t len) const;
   int get_size(int64_t *psize) const;
   int get_devid(dev_t *id) const;
   int partition(char* partition, size_t max) const;
   // from a device (e.g., "sdb")
   bool support_discard() const;
+  bool support_write_zeroes() const;
   int get_optimal_io_size() const;
   bool is_rotational() const;
   int get_numa_node(int *node) const;
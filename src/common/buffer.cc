@@ -81,6 +81,51 @@ static ceph::spinlock debug_lock;
     return buffer_missed_crc;
   }
 
+  /*
+   * Per-thread free lists for the two allocations every encode makes over
+   * and over: ptr_nodes, and the page-sized raw_combined that append()
+   * starts a bufferlist with.  Blocks freed on a thread are handed out
+   * again by the next allocation on it; the lists are small and bounded,
+   * and drained when the thread exits.
+   */
+  namespace {
+  struct buffer_tls_cache_t {
+    static constexpr unsigned MAX_NODES = 64;
+    static constexpr unsigned MAX_PAGES = 8;
+    void *nodes[MAX_NODES];
+    void *pages[MAX_PAGES];
+    unsigned num_nodes;
+    unsigned num_pages;
+    bool registered;  ///< reaper below is set up
+    bool dead;        ///< thread is exiting; don't cache anymore
+  };
+  // trivial, so it is still there for frees after the reaper ran
+  thread_local buffer_tls_cache_t buffer_tls_cache;
+
+  struct buffer_tls_cache_reaper_t {
+    ~buffer_tls_cache_reaper_t() {
+      auto& c = buffer_tls_cache;
+      while (c.num_nodes) {
+        ::operator delete(c.nodes[--c.num_nodes]);
+      }
+      while (c.num_pages) {
+        aligned_free(c.pages[--c.num_pages]);
+      }
+      c.dead = true;
+    }
+  };
+
+  buffer_tls_cache_t* get_buffer_tls_cache() {
+    auto& c = buffer_tls_cache;
+    if (unlikely(!c.registered)) {
+      static thread_local buffer_tls_cache_reaper_t reaper;
+      (void)&reaper;
+      c.registered = true;
+    }
+    return c.dead ? nullptr : &c;
+  }
+  } // anonymous namespace
+
   /*
    * raw_combined is always placed within a single allocation along
    * with the data buffer.  the data goes at the beginning, and
@@ -99,18 +144,24 @@ static ceph::spinlock debug_lock;
     {
       // posix_memalign() requires a multiple of sizeof(void *)
       align = std::max<unsigned>(align, sizeof(void *));
-      size_t rawlen = round_up_to(sizeof(buffer::raw_combined),
-				  alignof(buffer::raw_combined));
       size_t datalen = round_up_to(len, alignof(buffer::raw_combined));
 
+      char *ptr = 0;
+      if (align == sizeof(void *) &&
+	  alloc_size(len) == CEPH_BUFFER_ALLOC_UNIT) {
+	if (auto c = get_buffer_tls_cache(); c && c->num_pages) {
+	  ptr = (char *)c->pages[--c->num_pages];
+	}
+      }
+      if (!ptr) {
 #ifdef DARWIN
-      char *ptr = (char *) valloc(rawlen + datalen);
+	ptr = (char *) valloc(alloc_size(len));
 #else
-      char *ptr = 0;
-      int r = ::posix_memalign((void**)(void*)&ptr, align, rawlen + datalen);
-      if (r)
-	throw bad_alloc();
+	int r = ::posix_memalign((void**)(void*)&ptr, align, alloc_size(len));
+	if (r)
+	  throw bad_alloc();
 #endif /* DARWIN */
+      }
       if (!ptr)
 	throw bad_alloc();
 
@@ -122,8 +173,23 @@ static ceph::spinlock debug_lock;
 
     static void operator delete(void *ptr) {
       raw_combined *raw = (raw_combined *)ptr;
+      if (alloc_size(raw->len) == CEPH_BUFFER_ALLOC_UNIT) {
+	auto c = get_buffer_tls_cache();
+	if (c && c->num_pages < buffer_tls_cache_t::MAX_PAGES) {
+	  c->pages[c->num_pages++] = raw->data;
+	  return;
+	}
+      }
       aligned_free((void *)raw->data);
     }
+
+  private:
+    /// bytes of the allocation holding @len bytes of data and the raw
+    static size_t alloc_size(unsigned len) {
+      return round_up_to(sizeof(buffer::raw_combined),
+			 alignof(buffer::raw_combined)) +
+	round_up_to(len, alignof(buffer::raw_combined));
+    }
   };
 
   class buffer::raw_malloc : public buffer::raw {
@@ -2209,6 +2275,28 @@ buffer::ptr_node::create_hypercombined(ceph::unique_leakable_ptr<buffer::raw> r)
     new ptr_node(std::move(r)));
 }
 
+void* buffer::ptr_node::operator new(std::size_t size)
+{
+  if (size == sizeof(ptr_node)) {
+    if (auto c = get_buffer_tls_cache(); c && c->num_nodes) {
+      return c->nodes[--c->num_nodes];
+    }
+  }
+  return ::operator new(size);
+}
+
+void buffer::ptr_node::operator delete(void* p, std::size_t size)
+{
+  if (size == sizeof(ptr_node)) {
+    auto c = get_buffer_tls_cache();
+    if (c && c->num_nodes < buffer_tls_cache_t::MAX_NODES) {
+      c->nodes[c->num_nodes++] = p;
+      return;
+    }
+  }
+  ::operator delete(p);
+}
+
 buffer::ptr_node* buffer::ptr_node::cloner::operator()(
   const buffer::ptr_node& clone_this)
 {
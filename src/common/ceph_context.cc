@@ -167,6 +167,7 @@ public:
   const char** get_tracked_conf_keys() const override {
     static const char *KEYS[] = {
       "mempool_debug",
+      "mempool_sample_rate",
       NULL
     };
     return KEYS;
@@ -178,6 +179,10 @@ public:
     if (changed.count("mempool_debug")) {
       mempool::set_debug_mode(cct->_conf->mempool_debug);
     }
+    if (changed.count("mempool_sample_rate")) {
+      mempool::set_sample_rate(
+	cct->_conf.get_val<uint64_t>("mempool_sample_rate"));
+    }
   }
 
   // AdminSocketHook
@@ -283,6 +288,7 @@ public:
       "log_file",
       "log_max_new",
       "log_max_recent",
+      "log_thread_queue_size",
       "log_to_file",
       "log_to_syslog",
       "err_to_syslog",
@@ -342,6 +348,11 @@ public:
       log->set_max_recent(conf->log_max_recent);
     }
 
+    if (changed.count("log_thread_queue_size")) {
+      log->set_thread_queue_size(
+	conf.get_val<uint64_t>("log_thread_queue_size"));
+    }
+
     // graylog
     if (changed.count("log_to_graylog") || changed.count("err_to_graylog")) {
       int l = conf->log_to_graylog ? 99 : (conf->err_to_graylog ? -1 : -2);
@@ -547,6 +558,13 @@ int CephContext::_do_command(
   else if (command == "counter dump") {
     _perf_counters_collection->dump_formatted(f, false, true);
   }
+  else if (command == "counter dump delta") {
+    std::string client;
+    bool full = false;
+    cmd_getval(cmdmap, "client", client);
+    cmd_getval(cmdmap, "full", full);
+    _perf_counters_collection->dump_formatted_changed(f, client, full);
+  }
   else if (command == "counter schema") {
     _perf_counters_collection->dump_formatted(f, true, true);
   }
@@ -757,6 +775,7 @@ CephContext::CephContext(uint32_t module_type_,
   _admin_socket->register_command("2", _admin_hook, "");
   _admin_socket->register_command("perf schema", _admin_hook, "dump non-labeled counters schemas");
   _admin_socket->register_command("counter dump", _admin_hook, "dump all labeled and non-labeled counters and their values");
+  _admin_socket->register_command("counter dump delta name=client,type=CephString name=full,type=CephBool,req=false", _admin_hook, "dump the counters changed since the last delta dump for this client");
   _admin_socket->register_command("counter schema", _admin_hook, "dump all labeled and non-labeled counters schemas");
   _admin_socket->register_command("perf histogram schema", _admin_hook, "dump perf histogram schema");
   _admin_socket->register_command("perf reset name=var,type=CephString", _admin_hook, "perf reset <name>: perf reset all or one perfcounter name");
@@ -251,6 +251,73 @@ void escape_json_attr(const char *buf, size_t src_len, char *out)
 	*o = '\0';
 }
 
+static inline bool json_needs_escape(unsigned char c)
+{
+  return c < 0x20 || c == '"' || c == '\\' || c == 0x7f;
+}
+
+// true if any of the 8 bytes in w needs escaping; see "Determine if a
+// word has a byte less than n" in Bit Twiddling Hacks
+static inline bool json_word_needs_escape(uint64_t w)
+{
+  constexpr uint64_t ones = ~0ull / 255;
+  constexpr uint64_t highs = ones * 0x80;
+  auto has_zero = [](uint64_t v) {
+    return (v - ones) & ~v & highs;
+  };
+  return ((w - ones * 0x20) & ~w & highs) ||
+    has_zero(w ^ (ones * '"')) ||
+    has_zero(w ^ (ones * '\\')) ||
+    has_zero(w ^ (ones * 0x7f));
+}
+
+void escape_json_append(std::string_view in, std::string& out)
+{
+  const char *p = in.data();
+  const char *end = p + in.size();
+  while (p < end) {
+    // copy the run that needs no escaping, a word at a time
+    const char *run = p;
+    while (end - p >= 8) {
+      uint64_t w;
+      memcpy(&w, p, sizeof(w));
+      if (json_word_needs_escape(w)) {
+	break;
+      }
+      p += 8;
+    }
+    while (p < end && !json_needs_escape(*p)) {
+      ++p;
+    }
+    out.append(run, p - run);
+    if (p == end) {
+      break;
+    }
+    unsigned char c = *p++;
+    switch (c) {
+    case '"':
+      out.append(DBL_QUOTE_JESCAPE, SSTRL(DBL_QUOTE_JESCAPE));
+      break;
+    case '\\':
+      out.append(BACKSLASH_JESCAPE, SSTRL(BACKSLASH_JESCAPE));
+      break;
+    case '\t':
+      out.append(TAB_JESCAPE, SSTRL(TAB_JESCAPE));
+      break;
+    case '\n':
+      out.append(NEWLINE_JESCAPE, SSTRL(NEWLINE_JESCAPE));
+      break;
+    default:
+      {
+	char buf[7];
+	snprintf(buf, sizeof(buf), "\\u%04x", c);
+	out.append(buf, 6);
+      }
+      break;
+    }
+  }
+}
+
 std::ostream& operator<<(std::ostream& out, const json_stream_escaper& e)
 {
   boost::optional<hex_formatter> fmt;
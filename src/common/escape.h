@@ -16,6 +16,7 @@
 #define CEPH_RGW_ESCAPE_H
 
 #include <ostream>
+#include <string>
 #include <string_view>
 
 /* Returns the length of a buffer that would be needed to escape 'buf'
@@ -40,6 +41,11 @@ size_t escape_json_attr_len(const char *buf, size_t src_len);
  */
 void escape_json_attr(const char *buf, size_t src_len, char *out);
 
+/* Appends 'in', escaped as a JSON string (without the quotes), to 'out'.
+ * Runs of characters that need no escaping are copied in one go.
+ */
+void escape_json_append(std::string_view in, std::string& out);
+
 /* Note: we escape control characters. Although the XML spec doesn't actually
  * require this, Amazon does it in their XML responses.
  */
@@ -12,16 +12,87 @@
  *
  */
 
+#include <algorithm>
+#include <iterator>
+
+#include "acconfig.h"
+#ifdef HAVE_EXECINFO_H
+#include <execinfo.h>
+#endif
+
 #include "include/mempool.h"
 #include "include/demangle.h"
 
-// Thread local variables should save index, not &shard[index],
-// because shard[] is defined in the class
-static thread_local size_t thread_shard_index = mempool::num_shards;
-
 // default to debug_mode off
 bool mempool::debug_mode = false;
 
+std::atomic<unsigned> mempool::sample_rate = {0};
+
+thread_local mempool::thread_counters_t *mempool::thread_counters = nullptr;
+
+namespace {
+
+// the counters of all live threads
+struct thread_registry_t {
+  std::mutex lock;
+  std::set<mempool::thread_counters_t*> threads;
+};
+
+thread_registry_t& get_thread_registry()
+{
+  // never destroyed: threads may exit after static destructors ran
+  static thread_registry_t *registry = new thread_registry_t;
+  return *registry;
+}
+
+// set while and after this thread's counters are torn down, so that
+// allocations made by later thread_local destructors go to the shards
+thread_local bool thread_exited = false;
+
+struct thread_holder_t {
+  mempool::thread_counters_t counters;
+
+  thread_holder_t() {
+    auto& r = get_thread_registry();
+    std::lock_guard l(r.lock);
+    r.threads.insert(&counters);
+  }
+  ~thread_holder_t() {
+    thread_exited = true;
+    mempool::thread_counters = nullptr;
+    auto& r = get_thread_registry();
+    std::lock_guard l(r.lock);
+    for (size_t i = 0; i < mempool::num_pools; ++i) {
+      auto& c = counters.pool[i];
+      mempool::get_pool((mempool::pool_index_t)i).add_to_shard(
+	c.items.load(std::memory_order_relaxed),
+	c.bytes.load(std::memory_order_relaxed));
+    }
+    r.threads.erase(&counters);
+  }
+};
+
+} // anonymous namespace
+
+void mempool::account_slow(pool_index_t ix, ssize_t items, ssize_t bytes)
+{
+  thread_counters_t *c = thread_counters;
+  if (!c) {
+    if (thread_exited) {
+      get_pool(ix).add_to_shard(items, bytes);
+      return;
+    }
+    static thread_local thread_holder_t holder;
+    c = thread_counters = &holder.counters;
+  }
+  c->add(ix, items, bytes);
+  unsigned rate = sample_rate.load(std::memory_order_relaxed);
+  if (rate && items > 0 && ++c->pool[ix].since_sample >= rate) {
+    c->pool[ix].since_sample = 0;
+    get_pool(ix).sample(bytes);
+  }
+}
+
 // --------------------------------------------------------------
 
 mempool::pool_t& mempool::get_pool(mempool::pool_index_t ix)
@@ -64,15 +135,30 @@ void mempool::set_debug_mode(bool d)
   debug_mode = d;
 }
 
+void mempool::set_sample_rate(unsigned n)
+{
+  if (n == sample_rate) {
+    return;
+  }
+  sample_rate = n;
+  for (size_t i = 0; i < num_pools; ++i) {
+    get_pool((pool_index_t)i).clear_samples();
+  }
+}
+
 // --------------------------------------------------------------
 // pool_t
 
+mempool::pool_index_t mempool::pool_t::get_index() const
+{
+  return (pool_index_t)(this - &get_pool((pool_index_t)0));
+}
+
 size_t mempool::pool_t::allocated_bytes() const
 {
-  ssize_t result = 0;
-  for (size_t i = 0; i < num_shards; ++i) {
-    result += shard[i].bytes;
-  }
+  stats_t total;
+  get_stats(&total, nullptr);
+  ssize_t result = total.bytes;
   if (result < 0) {
     // we raced with some unbalanced allocations/deallocations
     result = 0;
@@ -82,10 +168,9 @@ size_t mempool::pool_t::allocated_bytes() const
 
 size_t mempool::pool_t::allocated_items() const
 {
-  ssize_t result = 0;
-  for (size_t i = 0; i < num_shards; ++i) {
-    result += shard[i].items;
-  }
+  stats_t total;
+  get_stats(&total, nullptr);
+  ssize_t result = total.items;
   if (result < 0) {
     // we raced with some unbalanced allocations/deallocations
     result = 0;
@@ -93,22 +178,54 @@ size_t mempool::pool_t::allocated_items() const
   return (size_t) result;
 }
 
-void mempool::pool_t::adjust_count(ssize_t items, ssize_t bytes)
+void mempool::pool_t::sample(size_t bytes)
+{
+#ifdef HAVE_EXECINFO_H
+  // skip ourselves and account_slow()
+  constexpr int skip = 2;
+  void *frames[skip + 8];
+  int n = backtrace(frames, std::size(frames));
+  if (n <= skip) {
+    return;
+  }
+  size_t h = 0;
+  for (int i = skip; i < n; ++i) {
+    h = h * 31 + (size_t)frames[i];
+  }
+  std::lock_guard l(sample_lock);
+  auto& s = samples[h];
+  if (s.frames.empty()) {
+    s.frames.assign(frames + skip, frames + n);
+  }
+  s.count++;
+  s.bytes += bytes;
+#endif
+}
+
+void mempool::pool_t::clear_samples()
 {
-  thread_shard_index = (thread_shard_index == num_shards) ? pick_a_shard_int() : thread_shard_index;
-  shard[thread_shard_index].items += items;
-  shard[thread_shard_index].bytes += bytes;
+  std::lock_guard l(sample_lock);
+  samples.clear();
 }
 
 void mempool::pool_t::get_stats(
   stats_t *total,
   std::map<std::string, stats_t> *by_type) const
 {
-  for (size_t i = 0; i < num_shards; ++i) {
-    total->items += shard[i].items;
-    total->bytes += shard[i].bytes;
+  pool_index_t ix = get_index();
+  {
+    auto& r = get_thread_registry();
+    std::lock_guard l(r.lock);
+    for (auto c : r.threads) {
+      total->items += c->pool[ix].items.load(std::memory_order_relaxed);
+      total->bytes += c->pool[ix].bytes.load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < num_shards; ++i) {
+      total->items += shard[i].items;
+      total->bytes += shard[i].bytes;
+    }
   }
-  if (debug_mode) {
+  if (debug_mode && by_type) {
     std::lock_guard shard_lock(lock);
     for (auto &p : type_map) {
       std::string n = ceph_demangle(p.second.type_name);
@@ -137,4 +254,36 @@ void mempool::pool_t::dump(ceph::Formatter *f, stats_t *ptotal) const
     }
     f->close_section();
   }
+
+  std::vector<const sample_t*> top;
+  std::lock_guard l(sample_lock);
+  for (auto& [h, s] : samples) {
+    top.push_back(&s);
+  }
+  if (top.empty()) {
+    return;
+  }
+  constexpr size_t max_dump = 20;
+  std::sort(top.begin(), top.end(), [](auto a, auto b) {
+    return a->bytes > b->bytes;
+  });
+  top.resize(std::min(top.size(), max_dump));
+  f->dump_unsigned("sample_rate", sample_rate);
+  f->open_array_section("samples");
+  for (auto s : top) {
+    f->open_object_section("sample");
+    f->dump_unsigned("count", s->count);
+    f->dump_unsigned("bytes", s->bytes);
+    f->open_array_section("backtrace");
+#ifdef HAVE_EXECINFO_H
+    char **syms = backtrace_symbols(s->frames.data(), s->frames.size());
+    for (size_t i = 0; syms && i < s->frames.size(); ++i) {
+      f->dump_string("frame", syms[i]);
+    }
+    free(syms);
+#endif
+    f->close_section();
+    f->close_section();
+  }
+  f->close_section();
 }
@@ -6,6 +6,10 @@
 #include <cstring>
 #include <errno.h>
 #include <iostream>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include "include/stringify.h"
 #include "common/safe_io.h"
@@ -138,6 +142,16 @@ int get_numa_node_cpu_set(
   return r;
 }
 
+int get_current_numa_node()
+{
+  unsigned cpu, node;
+  // getcpu() is served from the vdso, so this is cheap enough for hot paths
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) < 0) {
+    return -1;
+  }
+  return node;
+}
+
 static int easy_readdir(const std::string& dir, std::set<std::string> *out)
 {
   DIR *h = ::opendir(dir.c_str());
@@ -257,4 +271,9 @@ int set_cpu_affinity_all_threads(size_t cpu_set_size,
   return -ENOTSUP;
 }
 
+int get_current_numa_node()
+{
+  return -1;
+}
+
 #endif
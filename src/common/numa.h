@@ -22,3 +22,6 @@ int get_numa_node_cpu_set(int node,
 
 int set_cpu_affinity_all_threads(size_t cpu_set_size,
 				 cpu_set_t *cpu_set);
+
+/// numa node of the cpu the calling thread currently runs on, or -1
+int get_current_numa_node();
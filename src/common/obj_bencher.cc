@@ -21,6 +21,8 @@
 #include "common/Clock.h"
 #include "obj_bencher.h"
 
+#include <thread>
+
 using std::ostream;
 using std::cerr;
 using std::cout;
@@ -98,6 +100,90 @@ ostream& ObjBencher::out(ostream& os)
   return out(os, cur_time);
 }
 
+void bench_latency_histogram::add(double seconds)
+{
+  uint64_t us = seconds > 0 ? (uint64_t)(seconds * 1000000) : 0;
+  unsigned b;
+  if (us < SUB) {
+    b = us;
+  } else {
+    unsigned e = std::min<unsigned>(63 - __builtin_clzll(us), MAX_EXP);
+    unsigned sub = (us >> (e - SUB_BITS)) & (SUB - 1);
+    b = SUB + (e - SUB_BITS) * SUB + sub;
+  }
+  ++buckets[b];
+  ++count;
+}
+
+double bench_latency_histogram::percentile(double p) const
+{
+  if (!count)
+    return 0;
+  uint64_t want = std::max<uint64_t>(1, std::ceil(p * count));
+  uint64_t seen = 0;
+  unsigned b = 0;
+  for (; b < std::size(buckets) - 1; ++b) {
+    seen += buckets[b];
+    if (seen >= want)
+      break;
+  }
+  uint64_t upper;
+  if (b < SUB) {
+    upper = b + 1;
+  } else {
+    unsigned e = (b - SUB) / SUB + SUB_BITS;
+    unsigned sub = (b - SUB) % SUB;
+    upper = (uint64_t)(SUB + sub + 1) << (e - SUB_BITS);
+  }
+  return (double)upper / 1000000;
+}
+
+void ObjBencher::record_latency(double *total_latency)
+{
+  double lat = data.cur_latency.count();
+  *total_latency += lat;
+  if (lat > data.max_latency)
+    data.max_latency = lat;
+  if (lat < data.min_latency)
+    data.min_latency = lat;
+  ++data.finished;
+  double delta = lat - data.avg_latency;
+  data.avg_latency = *total_latency / data.finished;
+  data.latency_diff_sum += delta * (lat - data.avg_latency);
+  data.latency_hist.add(lat);
+}
+
+mono_time ObjBencher::pace_op()
+{
+  mono_time now = mono_clock::now();
+  if (target_rate <= 0)
+    return now;
+  // data.started is only written by the issuing thread, i.e. us
+  mono_time due = data.start_time +
+    std::chrono::duration_cast<mono_clock::duration>(
+      std::chrono::duration<double>(data.started / target_rate));
+  if (due > now)
+    std::this_thread::sleep_for(due - now);
+  return due;
+}
+
+void ObjBencher::dump_latency_percentiles()
+{
+  static const std::pair<const char*, double> pcts[] = {
+    {"50", .5}, {"90", .9}, {"99", .99}, {"99.9", .999}};
+  for (auto& [name, p] : pcts) {
+    double v = data.latency_hist.percentile(p);
+    if (!formatter) {
+      std::string label = std::string("p") + name + " latency(s):";
+      out(cout) << std::left << setw(24) << label << std::right
+		<< v << std::endl;
+    } else {
+      formatter->dump_format(
+	(std::string("latency_p") + name).c_str(), "%f", v);
+    }
+  }
+}
+
 void *ObjBencher::status_printer(void *_bencher) {
   ObjBencher *bencher = static_cast<ObjBencher *>(_bencher);
   bench_data& data = bencher->data;
@@ -295,6 +381,7 @@ int ObjBencher::aio_bench(
   data.max_latency = 0;
   data.avg_latency = 0;
   data.latency_diff_sum = 0;
+  data.latency_hist.reset();
   data.object_contents = contentsChars;
   lock.unlock();
 
@@ -459,7 +546,7 @@ int ObjBencher::write_bench(int secondsToRun,
   data.start_time = mono_clock::now();
   locker.unlock();
   for (int i = 0; i<concurrentios; ++i) {
-    start_times[i] = mono_clock::now();
+    start_times[i] = pace_op();
     r = create_completion(i, _aio_cb, (void *)&lc);
     if (r < 0)
       goto ERR;
@@ -510,15 +597,7 @@ int ObjBencher::write_bench(int secondsToRun,
       goto ERR;
     }
     data.cur_latency = mono_clock::now() - start_times[slot];
-    total_latency += data.cur_latency.count();
-    if( data.cur_latency.count() > data.max_latency)
-      data.max_latency = data.cur_latency.count();
-    if (data.cur_latency.count() < data.min_latency)
-      data.min_latency = data.cur_latency.count();
-    ++data.finished;
-    double delta = data.cur_latency.count() - data.avg_latency;
-    data.avg_latency = total_latency / data.finished;
-    data.latency_diff_sum += delta * (data.cur_latency.count() - data.avg_latency);
+    record_latency(&total_latency);
     --data.in_flight;
     locker.unlock();
     release_completion(slot);
@@ -545,7 +624,7 @@ int ObjBencher::write_bench(int secondsToRun,
     // we wrote to buffer, going around internal crc cache, so invalidate it now.
     newContents->invalidate_crc();
 
-    start_times[slot] = mono_clock::now();
+    start_times[slot] = pace_op();
     r = create_completion(slot, _aio_cb, &lc);
     if (r < 0)
       goto ERR;
@@ -609,6 +688,7 @@ int ObjBencher::write_bench(int secondsToRun,
        << "Stddev Latency(s):      " << latency_stddev << std::endl
        << "Max latency(s):         " << data.max_latency << std::endl
        << "Min latency(s):         " << data.min_latency << std::endl;
+    dump_latency_percentiles();
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_writes_made", "%d", data.finished);
@@ -626,6 +706,7 @@ int ObjBencher::write_bench(int secondsToRun,
     formatter->dump_format("stddev_latency", "%f", latency_stddev);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles();
   }
   //write object size/number data for read benchmarks
   encode(data.object_size, b_write);
@@ -697,7 +778,7 @@ int ObjBencher::seq_read_bench(
   //start initial reads
   for (int i = 0; i < concurrentios; ++i) {
     index[i] = i;
-    start_times[i] = mono_clock::now();
+    start_times[i] = pace_op();
     create_completion(i, _aio_cb, (void *)&lc);
     r = aio_read(name[i], i, contents[i].get(), data.op_size,
 		 data.op_size * (i % reads_per_object));
@@ -771,13 +852,7 @@ int ObjBencher::seq_read_bench(
       locker.unlock();
       goto ERR;
     }
-    total_latency += data.cur_latency.count();
-    if (data.cur_latency.count() > data.max_latency)
-      data.max_latency = data.cur_latency.count();
-    if (data.cur_latency.count() < data.min_latency)
-      data.min_latency = data.cur_latency.count();
-    ++data.finished;
-    data.avg_latency = total_latency / data.finished;
+    record_latency(&total_latency);
     --data.in_flight;
     locker.unlock();
     release_completion(slot);
@@ -786,7 +861,7 @@ int ObjBencher::seq_read_bench(
       continue;
 
     //start new read and check data if requested
-    start_times[slot] = mono_clock::now();
+    start_times[slot] = pace_op();
     create_completion(slot, _aio_cb, (void *)&lc);
     r = aio_read(newName, slot, contents[slot].get(), data.op_size,
 		 data.op_size * (data.started % reads_per_object));
@@ -831,6 +906,7 @@ int ObjBencher::seq_read_bench(
        << "Average Latency(s):   " << data.avg_latency << std::endl
        << "Max latency(s):       " << data.max_latency << std::endl
        << "Min latency(s):       " << data.min_latency << std::endl;
+    dump_latency_percentiles();
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_reads_made", "%d", data.finished);
@@ -844,6 +920,7 @@ int ObjBencher::seq_read_bench(
     formatter->dump_format("average_latency", "%f", data.avg_latency);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles();
   }
 
   completions_done();
@@ -909,7 +986,7 @@ int ObjBencher::rand_read_bench(
   //start initial reads
   for (int i = 0; i < concurrentios; ++i) {
     index[i] = i;
-    start_times[i] = mono_clock::now();
+    start_times[i] = pace_op();
     create_completion(i, _aio_cb, (void *)&lc);
     r = aio_read(name[i], i, contents[i].get(), data.op_size,
 		 data.op_size * (i % reads_per_object));
@@ -966,13 +1043,7 @@ int ObjBencher::rand_read_bench(
       goto ERR;
     }
 
-    total_latency += data.cur_latency.count();
-    if (data.cur_latency.count() > data.max_latency)
-      data.max_latency = data.cur_latency.count();
-    if (data.cur_latency.count() < data.min_latency)
-      data.min_latency = data.cur_latency.count();
-    ++data.finished;
-    data.avg_latency = total_latency / data.finished;
+    record_latency(&total_latency);
     --data.in_flight;
 
     if (!no_verify) {
@@ -999,7 +1070,7 @@ int ObjBencher::rand_read_bench(
     // invalidate internal crc cache
     cur_contents->invalidate_crc();
 
-    start_times[slot] = mono_clock::now();
+    start_times[slot] = pace_op();
     create_completion(slot, _aio_cb, (void *)&lc);
     r = aio_read(newName, slot, contents[slot].get(), data.op_size,
 		 data.op_size * (rand_id % reads_per_object));
@@ -1044,6 +1115,7 @@ int ObjBencher::rand_read_bench(
        << "Average Latency(s):   " << data.avg_latency << std::endl
        << "Max latency(s):       " << data.max_latency << std::endl
        << "Min latency(s):       " << data.min_latency << std::endl;
+    dump_latency_percentiles();
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_reads_made", "%d", data.finished);
@@ -1057,6 +1129,7 @@ int ObjBencher::rand_read_bench(
     formatter->dump_format("average_latency", "%f", data.avg_latency);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles();
   }
   completions_done();
 
@@ -35,6 +35,23 @@ struct bench_interval_data {
   double iops_diff_sum = 0;
 };
 
+/// log-linear histogram of op latencies, to report percentiles with about
+/// 6% precision without keeping every sample
+struct bench_latency_histogram {
+  static constexpr unsigned SUB_BITS = 4;
+  static constexpr unsigned SUB = 1 << SUB_BITS;
+  static constexpr unsigned MAX_EXP = 40;  // ~12 days in usec
+  uint64_t buckets[SUB + (MAX_EXP - SUB_BITS + 1) * SUB] = {0};
+  uint64_t count = 0;
+
+  void reset() {
+    *this = bench_latency_histogram();
+  }
+  void add(double seconds);
+  /// @p is in [0, 1]; returns the upper bound of the bucket, in seconds
+  double percentile(double p) const;
+};
+
 struct bench_data {
   bool done; //is the benchmark is done
   uint64_t object_size; //the size of the objects
@@ -49,6 +66,7 @@ struct bench_data {
   double avg_latency;
   struct bench_interval_data idata; // data that is updated by time intervals and not by events
   double latency_diff_sum;
+  bench_latency_histogram latency_hist;
   std::chrono::duration<double> cur_latency; //latency of last completed transaction - in seconds by default
   mono_time start_time; //start time for benchmark - use the monotonic clock as we'll measure the passage of time
   char *object_contents; //pointer to the contents written to each object
@@ -63,6 +81,7 @@ typedef std::pair<std::string, std::string> Object;
 
 class ObjBencher {
   bool show_time;
+  double target_rate = 0;  ///< ops/sec for open-loop runs, 0 for closed-loop
   Formatter *formatter = NULL;
   std::ostream *outstream = NULL;
 public:
@@ -104,6 +123,12 @@ protected:
   virtual bool get_objects(std::list< std::pair<std::string, std::string> >* objects, int num) = 0;
   virtual void set_namespace(const std::string&) {}
 
+  /// account one completed op with latency data.cur_latency
+  void record_latency(double *total_latency);
+  /// when the op about to start is due; in open-loop mode waits for it
+  mono_time pace_op();
+  void dump_latency_percentiles();
+
   std::ostream& out(std::ostream& os);
   std::ostream& out(std::ostream& os, utime_t& t);
 public:
@@ -118,6 +143,15 @@ public:
   void set_show_time(bool dt) {
     show_time = dt;
   }
+  /**
+   * Issue ops at a fixed rate instead of as soon as earlier ones complete.
+   * Concurrency is still bounded by the number of concurrent ios; an op
+   * that can't start on time is started as soon as a slot frees up, and
+   * its latency is counted from when it was due.
+   */
+  void set_target_rate(double ops_per_sec) {
+    target_rate = ops_per_sec;
+  }
   void set_formatter(Formatter *f) {
     formatter = f;
   }
@@ -355,6 +355,58 @@ void PerfCounters::reset()
   }
 }
 
+/// the value of a non-histogram counter as <u64, avgcount>
+static pair<uint64_t, uint64_t> read_value(
+  const PerfCounters::perf_counter_data_any_d& d)
+{
+  if (d.type & PERFCOUNTER_LONGRUNAVG) {
+    return d.read_avg();
+  }
+  return {d.u64, 0};
+}
+
+static void dump_value(Formatter *f,
+		       const PerfCounters::perf_counter_data_any_d& d,
+		       const pair<uint64_t, uint64_t>& a)
+{
+  if (d.type & PERFCOUNTER_LONGRUNAVG) {
+    f->open_object_section(d.name);
+    if (d.type & PERFCOUNTER_U64) {
+      f->dump_unsigned("avgcount", a.second);
+      f->dump_unsigned("sum", a.first);
+    } else if (d.type & PERFCOUNTER_TIME) {
+      f->dump_unsigned("avgcount", a.second);
+      f->dump_format_unquoted("sum", "%" PRId64 ".%09" PRId64,
+			      a.first / 1000000000ull,
+			      a.first % 1000000000ull);
+      uint64_t count = a.second;
+      uint64_t sum_ns = a.first;
+      if (count) {
+	uint64_t avg_ns = sum_ns / count;
+	f->dump_format_unquoted("avgtime", "%" PRId64 ".%09" PRId64,
+				avg_ns / 1000000000ull,
+				avg_ns % 1000000000ull);
+      } else {
+	f->dump_format_unquoted("avgtime", "%" PRId64 ".%09" PRId64, 0, 0);
+      }
+    } else {
+      ceph_abort();
+    }
+    f->close_section();
+  } else {
+    uint64_t v = a.first;
+    if (d.type & PERFCOUNTER_U64) {
+      f->dump_unsigned(d.name, v);
+    } else if (d.type & PERFCOUNTER_TIME) {
+      f->dump_format_unquoted(d.name, "%" PRId64 ".%09" PRId64,
+			      v / 1000000000ull,
+			      v % 1000000000ull);
+    } else {
+      ceph_abort();
+    }
+  }
+}
+
 void PerfCounters::dump_formatted_generic(Formatter *f, bool schema,
     bool histograms, bool dump_labeled, const std::string &counter) const
 {
@@ -442,48 +494,14 @@ void PerfCounters::dump_formatted_generic(Formatter *f, bool schema,
       }
       f->close_section();
     } else {
-      if (d->type & PERFCOUNTER_LONGRUNAVG) {
-	f->open_object_section(d->name);
-	pair<uint64_t,uint64_t> a = d->read_avg();
-	if (d->type & PERFCOUNTER_U64) {
-	  f->dump_unsigned("avgcount", a.second);
-	  f->dump_unsigned("sum", a.first);
-	} else if (d->type & PERFCOUNTER_TIME) {
-	  f->dump_unsigned("avgcount", a.second);
-	  f->dump_format_unquoted("sum", "%" PRId64 ".%09" PRId64,
-				  a.first / 1000000000ull,
-				  a.first % 1000000000ull);
-          uint64_t count = a.second;
-          uint64_t sum_ns = a.first;
-          if (count) {
-            uint64_t avg_ns = sum_ns / count;
-            f->dump_format_unquoted("avgtime", "%" PRId64 ".%09" PRId64,
-                                    avg_ns / 1000000000ull,
-                                    avg_ns % 1000000000ull);
-          } else {
-            f->dump_format_unquoted("avgtime", "%" PRId64 ".%09" PRId64, 0, 0);
-          }
-	} else {
-	  ceph_abort();
-	}
-	f->close_section();
-      } else if (d->type & PERFCOUNTER_HISTOGRAM) {
+      if (d->type & PERFCOUNTER_HISTOGRAM) {
         ceph_assert(d->type == (PERFCOUNTER_HISTOGRAM | PERFCOUNTER_COUNTER | PERFCOUNTER_U64));
         ceph_assert(d->histogram);
         f->open_object_section(d->name);
         d->histogram->dump_formatted(f);
         f->close_section();
       } else {
-	uint64_t v = d->u64;
-	if (d->type & PERFCOUNTER_U64) {
-	  f->dump_unsigned(d->name, v);
-	} else if (d->type & PERFCOUNTER_TIME) {
-	  f->dump_format_unquoted(d->name, "%" PRId64 ".%09" PRId64,
-				  v / 1000000000ull,
-				  v % 1000000000ull);
-	} else {
-	  ceph_abort();
-	}
+	dump_value(f, *d, read_value(*d));
       }
     }
   }
@@ -493,6 +511,46 @@ void PerfCounters::dump_formatted_generic(Formatter *f, bool schema,
   f->close_section();
 }
 
+void PerfCounters::dump_formatted_changed(
+  Formatter *f,
+  std::vector<std::pair<uint64_t, uint64_t>> *last) const
+{
+  const bool full = last->empty();
+  if (full) {
+    last->resize(m_data.size());
+  }
+  bool opened = false;
+  for (size_t i = 0; i < m_data.size(); ++i) {
+    const auto& d = m_data[i];
+    if (d.type & PERFCOUNTER_HISTOGRAM) {
+      continue;
+    }
+    auto v = read_value(d);
+    if (!full && v == (*last)[i]) {
+      continue;
+    }
+    (*last)[i] = v;
+    if (!opened) {
+      // same layout as dump_formatted_generic() with dump_labeled
+      f->open_object_section(ceph::perf_counters::key_name(m_name));
+      f->open_object_section("labels");
+      for (auto label : ceph::perf_counters::key_labels(m_name)) {
+	if (!label.first.empty()) {
+	  f->dump_string(label.first, label.second);
+	}
+      }
+      f->close_section(); // labels
+      f->open_object_section("counters");
+      opened = true;
+    }
+    dump_value(f, d, v);
+  }
+  if (opened) {
+    f->close_section(); // counters
+    f->close_section();
+  }
+}
+
 const std::string &PerfCounters::get_name() const
 {
   return m_name;
@@ -17,6 +17,7 @@
 #ifndef CEPH_COMMON_PERF_COUNTERS_H
 #define CEPH_COMMON_PERF_COUNTERS_H
 
+#include <map>
 #include <string>
 #include <vector>
 #include <memory>
@@ -254,6 +255,12 @@ public:
                                  const std::string &counter = "") const {
     dump_formatted_generic(f, schema, true, false, counter);
   }
+  /// dump, labeled, the non-histogram counters whose <value, avgcount>
+  /// differ from @last, and record what was dumped there; an empty @last
+  /// dumps everything
+  void dump_formatted_changed(
+    ceph::Formatter *f,
+    std::vector<std::pair<uint64_t, uint64_t>> *last) const;
   std::pair<uint64_t, uint64_t> get_tavg_ns(int idx) const;
 
   const std::string& get_name() const;
@@ -336,6 +343,21 @@ public:
     dump_formatted_generic(f, schema, true, false, logger, counter);
   }
 
+  /// what a "counter dump delta" consumer was last sent
+  struct DumpCursor {
+    uint64_t epoch = 0;
+    std::map<std::string, std::vector<std::pair<uint64_t, uint64_t>>> last;
+  };
+  /**
+   * Like dump_formatted(f, false, true), but only the counters which
+   * changed since the previous dump with @cursor.  If loggers were added
+   * or removed in between, or @full is set, everything is dumped and
+   * "full" is true in the output, telling the consumer to drop what it
+   * has.
+   */
+  void dump_formatted_changed(ceph::Formatter *f, DumpCursor *cursor,
+                              bool full) const;
+
   // A reference to a perf_counter_data_any_d, with an accompanying
   // pointer to the enclosing PerfCounters, in order that the consumer
   // can see the prio_adjust
@@ -359,6 +381,9 @@ private:
   perf_counters_set_t m_loggers;
 
   CounterMap by_path; 
+
+  /// bumped whenever m_loggers changes
+  uint64_t m_epoch = 1;
 };
 
 
@@ -48,6 +48,25 @@ void PerfCountersCollection::dump_formatted_histograms(ceph::Formatter *f, bool
   std::lock_guard lck(m_lock);
   perf_impl.dump_formatted_histograms(f,schema,logger,counter);
 }
+void PerfCountersCollection::dump_formatted_changed(ceph::Formatter *f,
+                                 const std::string &client,
+                                 bool full)
+{
+  std::lock_guard lck(m_lock);
+  auto p = m_dump_clients.find(client);
+  if (p == m_dump_clients.end()) {
+    if (m_dump_clients.size() >= MAX_DUMP_CURSORS) {
+      m_dump_clients.erase(std::min_element(
+        m_dump_clients.begin(), m_dump_clients.end(),
+        [](const auto& a, const auto& b) {
+          return a.second.last_used < b.second.last_used;
+        }));
+    }
+    p = m_dump_clients.emplace(client, DumpClient{}).first;
+  }
+  p->second.last_used = ++m_dump_seq;
+  perf_impl.dump_formatted_changed(f, &p->second.cursor, full);
+}
 void PerfCountersCollection::with_counters(std::function<void(const PerfCountersCollectionImpl::CounterMap &)> fn) const
 {
   std::lock_guard lck(m_lock);
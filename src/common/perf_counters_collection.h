@@ -12,6 +12,15 @@ class PerfCountersCollection
   /** Protects perf_impl->m_loggers */
   mutable ceph::mutex m_lock;
   PerfCountersCollectionImpl perf_impl;
+
+  /// delta dump consumers we remember, least recently used are forgotten
+  static constexpr size_t MAX_DUMP_CURSORS = 16;
+  struct DumpClient {
+    uint64_t last_used = 0;
+    PerfCountersCollectionImpl::DumpCursor cursor;
+  };
+  std::map<std::string, DumpClient> m_dump_clients;
+  uint64_t m_dump_seq = 0;
 public:
   PerfCountersCollection(CephContext *cct);
   ~PerfCountersCollection();
@@ -26,6 +35,10 @@ public:
   void dump_formatted_histograms(ceph::Formatter *f, bool schema,
                                  const std::string &logger = "",
                                  const std::string &counter = "");
+  /// "counter dump delta": the counters changed since the last dump
+  /// for @client
+  void dump_formatted_changed(ceph::Formatter *f, const std::string &client,
+                              bool full);
 
   void with_counters(std::function<void(const PerfCountersCollectionImpl::CounterMap &)>) const;
 
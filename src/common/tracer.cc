@@ -1,6 +1,8 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 // vim: ts=8 sw=2 smarttab
 
+#include <algorithm>
+
 #include "common/ceph_context.h"
 #include "global/global_context.h"
 #include "tracer.h"
@@ -69,6 +71,57 @@ jspan Tracer::add_span(opentelemetry::nostd::string_view span_name, const jspan_
   return noop_span;
 }
 
+static opentelemetry::common::SystemTimestamp to_system_timestamp(ceph::real_time t) {
+  return opentelemetry::common::SystemTimestamp(
+    std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(t.time_since_epoch())));
+}
+
+// spans measure their duration on the steady clock; place `t` on it
+// relative to now
+static opentelemetry::common::SteadyTimestamp to_steady_timestamp(ceph::real_time t) {
+  auto ago = ceph::real_clock::now() - t;
+  return opentelemetry::common::SteadyTimestamp(
+    std::chrono::steady_clock::now() -
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(ago));
+}
+
+jspan Tracer::add_span(std::string_view span_name, const trace_id_t& trace_id,
+                       ceph::real_time start) {
+  if (!is_enabled()) {
+    return noop_span;
+  }
+  using namespace opentelemetry;
+  using namespace trace;
+  // every process recording a span for the same trace id hangs it below
+  // the same (remote) parent, derived from the trace id
+  std::array<uint8_t, TraceId::kSize> tid = trace_id;
+  std::array<uint8_t, SpanId::kSize> parent_id;
+  std::copy_n(tid.begin() + TraceId::kSize - SpanId::kSize, SpanId::kSize,
+              parent_id.begin());
+  StartSpanOptions span_opts;
+  span_opts.parent = SpanContext(
+    TraceId(nostd::span<uint8_t, TraceId::kSize>(tid)),
+    SpanId(nostd::span<uint8_t, SpanId::kSize>(parent_id)),
+    TraceFlags(TraceFlags::kIsSampled),
+    true);
+  span_opts.start_system_time = to_system_timestamp(start);
+  span_opts.start_steady_time = to_steady_timestamp(start);
+  return tracer->StartSpan(nostd::string_view(span_name.data(), span_name.size()),
+                           span_opts);
+}
+
+void Tracer::add_event(const jspan& span, std::string_view event, ceph::real_time stamp) {
+  span->AddEvent(opentelemetry::nostd::string_view(event.data(), event.size()),
+                 to_system_timestamp(stamp));
+}
+
+void Tracer::end_span(const jspan& span, ceph::real_time end) {
+  opentelemetry::trace::EndSpanOptions end_opts;
+  end_opts.end_steady_time = to_steady_timestamp(end);
+  span->End(end_opts);
+}
+
 bool Tracer::is_enabled() const {
   return g_ceph_context->_conf->jaeger_tracing_enable;
 }
@@ -3,9 +3,18 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <string_view>
+
 #include "acconfig.h"
+#include "common/ceph_time.h"
 #include "include/buffer.h"
 
+namespace tracing {
+using trace_id_t = std::array<uint8_t, 16>;
+}
+
 #ifdef HAVE_JAEGER
 #include "opentelemetry/trace/provider.h"
 
@@ -43,6 +52,14 @@ class Tracer {
   // parent_ctx contains the required information of the trace.
   jspan add_span(opentelemetry::nostd::string_view span_name, const jspan_context& parent_ctx);
 
+  // creates and returns a new span with `span_name` that started at `start`,
+  // in the trace identified by `trace_id`. for recording an operation after
+  // the fact, once it turned out to be worth tracing; add its events with
+  // add_event() and finish it with end_span().
+  jspan add_span(std::string_view span_name, const trace_id_t& trace_id,
+                 ceph::real_time start);
+  void add_event(const jspan& span, std::string_view event, ceph::real_time stamp);
+  void end_span(const jspan& span, ceph::real_time end);
 };
 
 void encode(const jspan_context& span, ceph::buffer::list& bl, uint64_t f = 0);
@@ -98,6 +115,9 @@ struct Tracer {
   jspan start_trace(std::string_view, bool enabled = true) { return {}; }
   jspan add_span(std::string_view, const jspan&) { return {}; }
   jspan add_span(std::string_view span_name, const jspan_context& parent_ctx) { return {}; }
+  jspan add_span(std::string_view, const trace_id_t&, ceph::real_time) { return {}; }
+  void add_event(const jspan&, std::string_view, ceph::real_time) {}
+  void end_span(const jspan&, ceph::real_time) {}
   void init(std::string_view service_name) {}
 };
   inline void encode(const jspan_context& span, bufferlist& bl, uint64_t f=0) {}
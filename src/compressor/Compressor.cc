@@ -16,6 +16,9 @@
 #include <sstream>
 #include <iterator>
 #include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
 
 #include "CompressionPlugin.h"
 #include "Compressor.h"
@@ -29,6 +32,9 @@ namespace TOPNSPC {
 #ifdef HAVE_QATZIP
   QatAccel Compressor::qat_accel;
 #endif
+#ifdef HAVE_QPL
+  IaaAccel Compressor::iaa_accel;
+#endif
 
 const char* Compressor::get_comp_alg_name(int a) {
 
@@ -74,6 +80,60 @@ Compressor::get_comp_mode_type(std::string_view s) {
   return {};
 }
 
+void Compressor::compress_batch(std::vector<BatchItem>& batch)
+{
+  if (batch.empty()) {
+    return;
+  }
+  std::mutex lock;
+  std::condition_variable cond;
+  bool done = false;
+  compress_async(batch, [&] {
+    std::lock_guard l(lock);
+    done = true;
+    cond.notify_one();
+  });
+  std::unique_lock l(lock);
+  cond.wait(l, [&] { return done; });
+}
+
+double Compressor::estimate_entropy(const ceph::bufferlist& bl,
+				    unsigned samples,
+				    unsigned sample_len)
+{
+  uint64_t len = bl.length();
+  if (len == 0 || samples == 0 || sample_len == 0) {
+    return 0;
+  }
+  uint64_t stride = std::max<uint64_t>(len / samples, sample_len);
+  uint32_t hist[256] = {0};
+  uint64_t total = 0;
+  auto p = bl.begin();
+  for (uint64_t off = 0; off < len; off += stride) {
+    uint64_t want = std::min<uint64_t>(sample_len, len - off);
+    for (uint64_t left = want; left;) {
+      const char *data;
+      size_t got = p.get_ptr_and_advance(left, &data);
+      for (size_t i = 0; i < got; ++i) {
+	++hist[(uint8_t)data[i]];
+      }
+      left -= got;
+    }
+    total += want;
+    if (off + stride < len) {
+      p += stride - want;
+    }
+  }
+  double entropy = 0;
+  for (auto n : hist) {
+    if (n) {
+      double q = (double)n / total;
+      entropy -= q * std::log2(q);
+    }
+  }
+  return entropy;
+}
+
 CompressorRef Compressor::create(CephContext *cct, const std::string &type)
 {
   // support "random" for teuthology testing
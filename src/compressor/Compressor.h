@@ -15,16 +15,23 @@
 #ifndef CEPH_COMPRESSOR_H
 #define CEPH_COMPRESSOR_H
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 #include "include/ceph_assert.h"    // boost clobbers this
 #include "include/common_fwd.h"
 #include "include/buffer.h"
 #include "include/int_types.h"
+
+// the accelerators are included at the end; they use Compressor::BatchItem
 #ifdef HAVE_QATZIP
-  #include "QatAccel.h"
+class QatAccel;
+#endif
+#ifdef HAVE_QPL
+class IaaAccel;
 #endif
 
 namespace TOPNSPC {
@@ -74,6 +81,10 @@ public:
   bool qat_enabled;
   static QatAccel qat_accel;
 #endif
+#ifdef HAVE_QPL
+  bool iaa_enabled = false;
+  static IaaAccel iaa_accel;
+#endif
 
   static const char* get_comp_alg_name(int a);
   static std::optional<CompressionAlgorithm> get_comp_alg_type(std::string_view s);
@@ -96,6 +107,57 @@ public:
   // alignment with decode methods
   virtual int decompress(ceph::bufferlist::const_iterator &p, size_t compressed_len, ceph::bufferlist &out, std::optional<int32_t> compressor_message) = 0;
 
+  /**
+   * A compression context that keeps its history across calls, so that a
+   * buffer can refer back to everything compressed before it.  Buffers
+   * must be decompressed in the order they were compressed, each by a
+   * stream of its own; a stream is unusable after an error.
+   */
+  class Stream {
+  public:
+    virtual ~Stream() {}
+    virtual int compress(const ceph::bufferlist &in, ceph::bufferlist &out) = 0;
+    virtual int decompress(const ceph::bufferlist &in, ceph::bufferlist &out) = 0;
+  };
+  /// nullptr if the algorithm has no streaming mode
+  virtual std::unique_ptr<Stream> create_stream() {
+    return nullptr;
+  }
+
+  /// one buffer of a compress_async() or compress_batch() call
+  struct BatchItem {
+    const ceph::bufferlist *in = nullptr;
+    ceph::bufferlist out;
+    std::optional<int32_t> compressor_message;
+    int r = 0;  ///< what compress() would have returned
+  };
+  /**
+   * Compress every item of @c batch, then call @c on_finish, possibly
+   * from another thread.  @c batch must stay alive until then.
+   *
+   * Hardware offload submits the whole batch before waiting for any of
+   * it; by default the items are compressed in turn and @c on_finish is
+   * called before returning.
+   */
+  virtual void compress_async(std::vector<BatchItem>& batch,
+			      std::function<void()> on_finish) {
+    for (auto& i : batch) {
+      i.r = compress(*i.in, i.out, i.compressor_message);
+    }
+    on_finish();
+  }
+  /// compress_async() and wait for it
+  void compress_batch(std::vector<BatchItem>& batch);
+
+  /**
+   * Estimate the byte entropy of @c bl, in bits per byte, from
+   * @c samples pieces of @c sample_len bytes spread over it.  Close to 8
+   * for encrypted or already compressed data.
+   */
+  static double estimate_entropy(const ceph::bufferlist& bl,
+				 unsigned samples = 16,
+				 unsigned sample_len = 256);
+
   static CompressorRef create(CephContext *cct, const std::string &type);
   static CompressorRef create(CephContext *cct, int alg);
 
@@ -106,4 +168,12 @@ protected:
 };
 
 } // namespace TOPNSPC
+
+#ifdef HAVE_QATZIP
+  #include "QatAccel.h"
+#endif
+#ifdef HAVE_QPL
+  #include "IaaAccel.h"
+#endif
+
 #endif
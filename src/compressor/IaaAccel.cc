@@ -0,0 +1,198 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+#include <qpl/qpl.h>
+
+#include "common/ceph_context.h"
+#include "common/debug.h"
+#include "common/dout.h"
+#include "IaaAccel.h"
+
+// -----------------------------------------------------------------------------
+#define dout_context g_ceph_context
+#define dout_subsys ceph_subsys_compressor
+#undef dout_prefix
+#define dout_prefix _prefix(_dout)
+
+static std::ostream& _prefix(std::ostream* _dout)
+{
+  return *_dout << "IaaAccel: ";
+}
+// -----------------------------------------------------------------------------
+// default window size for Zlib 1.2.8, negated for raw deflate
+#define ZLIB_DEFAULT_WIN_SIZE -15
+
+static qpl_job* to_job(const std::unique_ptr<uint8_t[]>& p) {
+  return reinterpret_cast<qpl_job*>(p.get());
+}
+
+// room for the compressor variation mark and for stored blocks, which is
+// all deflate falls back to on incompressible input
+static uint32_t max_compressed_len(uint32_t len) {
+  return 1 + len + len / 16 + 64;
+}
+
+IaaAccel::IaaAccel() {}
+
+IaaAccel::~IaaAccel() {
+  for (auto& job : jobs) {
+    qpl_fini_job(to_job(job));
+  }
+}
+
+IaaAccel::job_ptr IaaAccel::get_job() {
+  {
+    std::scoped_lock lock{mutex};
+    if (!jobs.empty()) {
+      auto job = std::move(jobs.back());
+      jobs.pop_back();
+      return job;
+    }
+  }
+
+  uint32_t size = 0;
+  if (qpl_get_job_size(qpl_path_hardware, &size) != QPL_STS_OK) {
+    return nullptr;
+  }
+  job_ptr job(new uint8_t[size]);
+  if (qpl_init_job(qpl_path_hardware, to_job(job)) != QPL_STS_OK) {
+    return nullptr;
+  }
+  return job;
+}
+
+void IaaAccel::put_job(job_ptr&& job) {
+  std::scoped_lock lock{mutex};
+  uint64_t jobs_num = g_ceph_context->_conf.get_val<uint64_t>("iaa_compressor_job_max_number");
+  if (jobs.size() < jobs_num) {
+    jobs.push_back(std::move(job));
+  } else {
+    qpl_fini_job(to_job(job));
+  }
+}
+
+bool IaaAccel::init(const std::string &alg) {
+  if (alg != "zlib") {
+    return false;
+  }
+  {
+    std::scoped_lock lock{mutex};
+    if (initialized) {
+      return true;
+    }
+  }
+  dout(15) << "First use for IAA compressor" << dendl;
+  // fails if there is no accelerator we may use
+  auto job = get_job();
+  if (!job) {
+    dout(1) << "no IAA device available" << dendl;
+    return false;
+  }
+  put_job(std::move(job));
+  std::scoped_lock lock{mutex};
+  initialized = true;
+  return true;
+}
+
+namespace {
+/// a buffer being compressed by the accelerator
+struct iaa_request_t {
+  IaaAccel::job_ptr job;
+  bufferptr flat;  ///< contiguous copy of the input, if it was not
+  bufferptr out;
+  bool submitted = false;
+};
+}
+
+static int submit(iaa_request_t &req, const bufferlist &in) {
+  const char* src;
+  if (in.get_num_buffers() == 1) {
+    src = in.front().c_str();
+  } else {
+    req.flat = buffer::create(in.length());
+    in.begin().copy(in.length(), req.flat.c_str());
+    src = req.flat.c_str();
+  }
+  req.out = buffer::create_small_page_aligned(max_compressed_len(in.length()));
+  // put a compressor variation mark in front of compressed stream, not used at the moment
+  req.out.c_str()[0] = 0;
+
+  auto job = to_job(req.job);
+  job->op = qpl_op_compress;
+  job->level = qpl_default_level;
+  job->next_in_ptr = (uint8_t*)src;
+  job->available_in = in.length();
+  job->next_out_ptr = (uint8_t*)req.out.c_str() + 1;
+  job->available_out = req.out.length() - 1;
+  job->flags = QPL_FLAG_FIRST | QPL_FLAG_LAST | QPL_FLAG_DYNAMIC_HUFFMAN |
+    QPL_FLAG_OMIT_VERIFY;
+  return qpl_submit_job(job);
+}
+
+static int finish(iaa_request_t &req, bufferlist &out,
+		  std::optional<int32_t> &compressor_message) {
+  auto job = to_job(req.job);
+  qpl_status rc = qpl_wait_job(job);
+  if (rc != QPL_STS_OK) {
+    dout(10) << "IAA compress failed with " << rc << dendl;
+    return -1;
+  }
+  compressor_message = ZLIB_DEFAULT_WIN_SIZE;
+  out.append(req.out, 0, job->total_out + 1);
+  return 0;
+}
+
+int IaaAccel::compress(const bufferlist &in, bufferlist &out, std::optional<int32_t> &compressor_message) {
+  iaa_request_t req;
+  req.job = get_job();
+  if (!req.job) {
+    return -1;
+  }
+  int r = -1;
+  if (submit(req, in) == QPL_STS_OK) {
+    r = finish(req, out, compressor_message);
+  }
+  put_job(std::move(req.job));
+  return r;
+}
+
+void IaaAccel::compress_async(std::vector<TOPNSPC::Compressor::BatchItem>& batch,
+			      std::function<void()> on_finish) {
+  std::vector<iaa_request_t> reqs(batch.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    batch[i].r = -1;
+    reqs[i].job = get_job();
+    if (!reqs[i].job) {
+      continue;
+    }
+    int rc = submit(reqs[i], *batch[i].in);
+    if (rc == QPL_STS_QUEUES_ARE_BUSY_ERR) {
+      // the work queues are full: let what is in flight drain and retry
+      for (size_t j = 0; j < i; ++j) {
+	if (reqs[j].submitted) {
+	  batch[j].r = finish(reqs[j], batch[j].out, batch[j].compressor_message);
+	  reqs[j].submitted = false;
+	}
+      }
+      rc = submit(reqs[i], *batch[i].in);
+    }
+    reqs[i].submitted = rc == QPL_STS_OK;
+  }
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (reqs[i].submitted) {
+      batch[i].r = finish(reqs[i], batch[i].out, batch[i].compressor_message);
+    }
+    if (reqs[i].job) {
+      put_job(std::move(reqs[i].job));
+    }
+  }
+  on_finish();
+}
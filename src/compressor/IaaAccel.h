@@ -0,0 +1,56 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#ifndef CEPH_IAAACCEL_H
+#define CEPH_IAAACCEL_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "include/buffer.h"
+#include "Compressor.h"
+
+/**
+ * Deflate offload to the Intel In-Memory Analytics Accelerator through
+ * QPL.  The output is a raw deflate stream, so it is decompressed by the
+ * software zlib path; only compression is offloaded.
+ */
+class IaaAccel {
+ public:
+  /// memory of an initialized qpl_job
+  using job_ptr = std::unique_ptr<uint8_t[]>;
+
+  IaaAccel();
+  ~IaaAccel();
+
+  bool init(const std::string &alg);
+
+  int compress(const bufferlist &in, bufferlist &out, std::optional<int32_t> &compressor_message);
+  /// submit every item to the accelerator before waiting for the first;
+  /// items the hardware could not handle are left with r < 0
+  void compress_async(std::vector<TOPNSPC::Compressor::BatchItem>& batch,
+		      std::function<void()> on_finish);
+
+ private:
+  // get a job from the pool or create a new one. returns null if job init fails
+  job_ptr get_job();
+  void put_job(job_ptr&& job);
+
+  std::vector<job_ptr> jobs;
+  std::mutex mutex;
+  bool initialized = false;
+};
+
+#endif
@@ -11,6 +11,8 @@
  * Foundation.  See file COPYING.
  *
  */
+#include <atomic>
+
 #include <qatzip.h>
 
 #include "common/ceph_context.h"
@@ -126,6 +128,14 @@ QatAccel::session_ptr QatAccel::get_session() {
 QatAccel::QatAccel() {}
 
 QatAccel::~QatAccel() {
+  {
+    std::scoped_lock lock{mutex};
+    stopping = true;
+    work_cond.notify_all();
+  }
+  for (auto& t : workers) {
+    t.join();
+  }
   // First, we should uninitialize all QATzip session that disconnects all session
   // from a hardware instance and deallocates buffers.
   sessions.clear();
@@ -147,9 +157,56 @@ bool QatAccel::init(const std::string &alg) {
   }
 
   alg_name = alg;
+  unsigned n = g_ceph_context->_conf.get_val<uint64_t>("qat_compressor_batch_threads");
+  for (unsigned i = 0; i < n; ++i) {
+    workers.emplace_back(&QatAccel::worker_entry, this);
+  }
   return true;
 }
 
+void QatAccel::worker_entry() {
+  std::unique_lock lock{mutex};
+  while (true) {
+    work_cond.wait(lock, [this] { return stopping || !work.empty(); });
+    if (work.empty()) {
+      return;
+    }
+    auto f = std::move(work.front());
+    work.pop_front();
+    lock.unlock();
+    f();
+    lock.lock();
+  }
+}
+
+void QatAccel::compress_async(std::vector<TOPNSPC::Compressor::BatchItem>& batch,
+			      std::function<void()> on_finish) {
+  if (workers.empty() || batch.size() < 2) {
+    for (auto &i : batch) {
+      i.r = compress(*i.in, i.out, i.compressor_message);
+    }
+    on_finish();
+    return;
+  }
+  struct batch_state_t {
+    std::atomic<size_t> left;
+    std::function<void()> on_finish;
+  };
+  auto state = std::make_shared<batch_state_t>();
+  state->left = batch.size();
+  state->on_finish = std::move(on_finish);
+  std::scoped_lock lock{mutex};
+  for (auto &i : batch) {
+    work.emplace_back([this, &i, state] {
+      i.r = compress(*i.in, i.out, i.compressor_message);
+      if (--state->left == 0) {
+	state->on_finish();
+      }
+    });
+  }
+  work_cond.notify_all();
+}
+
 int QatAccel::compress(const bufferlist &in, bufferlist &out, std::optional<int32_t> &compressor_message) {
   auto s = get_session(); // get a session from the pool
   if (!s) {
@@ -16,12 +16,16 @@
 #define CEPH_QATACCEL_H
 
 #include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <thread>
 #include <vector>
 
 #include "include/buffer.h"
+#include "Compressor.h"
 
 extern "C" struct QzSession_S; // typedef struct QzSession_S QzSession_T;
 
@@ -38,6 +42,9 @@ class QatAccel {
   bool init(const std::string &alg);
 
   int compress(const bufferlist &in, bufferlist &out, std::optional<int32_t> &compressor_message);
+  /// compress the items on the offload threads, each with its own session
+  void compress_async(std::vector<TOPNSPC::Compressor::BatchItem>& batch,
+		      std::function<void()> on_finish);
   int decompress(const bufferlist &in, bufferlist &out, std::optional<int32_t> compressor_message);
   int decompress(bufferlist::const_iterator &p, size_t compressed_len, bufferlist &dst, std::optional<int32_t> compressor_message);
 
@@ -49,6 +56,14 @@ class QatAccel {
   std::vector<session_ptr> sessions;
   std::mutex mutex;
   std::string alg_name;
+
+  // qzCompress() blocks until the hardware is done, so a batch is spread
+  // over threads to keep several requests in flight
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()>> work;
+  std::condition_variable work_cond;
+  bool stopping = false;
+  void worker_entry();
 };
 
 #endif
@@ -174,6 +174,40 @@ int ZlibCompressor::compress(const bufferlist &in, bufferlist &out, std::optiona
   if (qat_enabled)
     return qat_accel.compress(in, out, compressor_message);
 #endif
+#ifdef HAVE_QPL
+  if (iaa_enabled && iaa_accel.compress(in, out, compressor_message) == 0)
+    return 0;
+  out.clear();
+#endif
+  return sw_compress(in, out, compressor_message);
+}
+
+void ZlibCompressor::compress_async(std::vector<BatchItem>& batch,
+				    std::function<void()> on_finish)
+{
+#ifdef HAVE_QATZIP
+  if (qat_enabled)
+    return qat_accel.compress_async(batch, std::move(on_finish));
+#endif
+#ifdef HAVE_QPL
+  if (iaa_enabled) {
+    iaa_accel.compress_async(batch, [] {});
+    // whatever the accelerator could not take is done in software
+    for (auto& i : batch) {
+      if (i.r != 0) {
+	i.out.clear();
+	i.r = sw_compress(*i.in, i.out, i.compressor_message);
+      }
+    }
+    on_finish();
+    return;
+  }
+#endif
+  Compressor::compress_async(batch, std::move(on_finish));
+}
+
+int ZlibCompressor::sw_compress(const bufferlist &in, bufferlist &out, std::optional<int32_t> &compressor_message)
+{
 #if (__x86_64__ && defined(HAVE_NASM_X64_AVX2)) || defined(__aarch64__)
   if (isal_enabled)
     return isal_compress(in, out, compressor_message);
@@ -31,13 +31,19 @@ public:
       qat_enabled = true;
     else
       qat_enabled = false;
+#endif
+#ifdef HAVE_QPL
+    iaa_enabled = cct->_conf->iaa_compressor_enabled && iaa_accel.init("zlib");
 #endif
   }
 
   int compress(const ceph::buffer::list &in, ceph::buffer::list &out, std::optional<int32_t> &compressor_message) override;
+  void compress_async(std::vector<BatchItem>& batch,
+		      std::function<void()> on_finish) override;
   int decompress(const ceph::buffer::list &in, ceph::buffer::list &out, std::optional<int32_t> compressor_message) override;
   int decompress(ceph::buffer::list::const_iterator &p, size_t compressed_len, ceph::buffer::list &out, std::optional<int32_t> compressor_message) override;
 private:
+  int sw_compress(const ceph::buffer::list &in, ceph::buffer::list &out, std::optional<int32_t> &compressor_message);
   int zlib_compress(const ceph::buffer::list &in, ceph::buffer::list &out, std::optional<int32_t> &compressor_message);
   int isal_compress(const ceph::buffer::list &in, ceph::buffer::list &out, std::optional<int32_t> &compressor_message);
  };
@@ -100,6 +100,121 @@ class ZstdCompressor : public Compressor {
     dst.append(dstptr, 0, outbuf.pos);
     return 0;
   }
+
+  /**
+   * One zstd frame per stream that is never ended: every compress() call
+   * flushes a block, so that the peer can decode it at once, while the
+   * window keeps the history of the previous calls.
+   */
+  class ZstdStream : public Compressor::Stream {
+  public:
+    explicit ZstdStream(int level) : level(level) {}
+    ~ZstdStream() override {
+      ZSTD_freeCStream(cs);
+      ZSTD_freeDStream(ds);
+    }
+
+    int compress(const ceph::buffer::list &src, ceph::buffer::list &dst) override {
+      if (!cs) {
+	cs = ZSTD_createCStream();
+	if (!cs) {
+	  return -ENOMEM;
+	}
+	ZSTD_CCtx_setParameter(cs, ZSTD_c_compressionLevel, level);
+      }
+      ceph::buffer::list out;
+      ceph::buffer::ptr outptr;
+      ZSTD_outBuffer_s outbuf = {nullptr, 0, 0};
+      auto next_out = [&] {
+	if (outbuf.pos) {
+	  out.append(outptr, 0, outbuf.pos);
+	}
+	outptr = ceph::buffer::create_small_page_aligned(ZSTD_CStreamOutSize());
+	outbuf.dst = outptr.c_str();
+	outbuf.size = outptr.length();
+	outbuf.pos = 0;
+      };
+      next_out();
+
+      auto p = src.begin();
+      size_t left = src.length();
+      do {
+	ZSTD_inBuffer_s inbuf = {nullptr, 0, 0};
+	if (left) {
+	  inbuf.size = p.get_ptr_and_advance(left, (const char**)&inbuf.src);
+	  left -= inbuf.size;
+	}
+	ZSTD_EndDirective const zed = left ? ZSTD_e_continue : ZSTD_e_flush;
+	size_t r;
+	do {
+	  if (outbuf.pos == outbuf.size) {
+	    next_out();
+	  }
+	  r = ZSTD_compressStream2(cs, &outbuf, &inbuf, zed);
+	  if (ZSTD_isError(r)) {
+	    return -EINVAL;
+	  }
+	} while (zed == ZSTD_e_flush ? r != 0 : inbuf.pos < inbuf.size);
+      } while (left);
+      out.append(outptr, 0, outbuf.pos);
+
+      // prefix with decompressed length
+      ceph::encode((uint32_t)src.length(), dst);
+      dst.claim_append(out);
+      return 0;
+    }
+
+    int decompress(const ceph::buffer::list &src, ceph::buffer::list &dst) override {
+      if (src.length() < 4) {
+	return -EINVAL;
+      }
+      if (!ds) {
+	ds = ZSTD_createDStream();
+	if (!ds) {
+	  return -ENOMEM;
+	}
+	ZSTD_initDStream(ds);
+      }
+      auto p = std::cbegin(src);
+      size_t left = src.length() - 4;
+      uint32_t dst_len;
+      ceph::decode(dst_len, p);
+
+      ceph::buffer::ptr dstptr(dst_len);
+      ZSTD_outBuffer_s outbuf;
+      outbuf.dst = dstptr.c_str();
+      outbuf.size = dstptr.length();
+      outbuf.pos = 0;
+      while (left) {
+	ZSTD_inBuffer_s inbuf;
+	inbuf.pos = 0;
+	inbuf.size = p.get_ptr_and_advance(left, (const char**)&inbuf.src);
+	left -= inbuf.size;
+	while (inbuf.pos < inbuf.size) {
+	  size_t r = ZSTD_decompressStream(ds, &outbuf, &inbuf);
+	  if (ZSTD_isError(r) ||
+	      (outbuf.pos == outbuf.size && inbuf.pos < inbuf.size)) {
+	    return -EINVAL;
+	  }
+	}
+      }
+      if (outbuf.pos != outbuf.size) {
+	return -EINVAL;
+      }
+      dst.append(dstptr, 0, outbuf.pos);
+      return 0;
+    }
+
+  private:
+    const int level;
+    ZSTD_CStream *cs = nullptr;
+    ZSTD_DStream *ds = nullptr;
+  };
+
+  std::unique_ptr<Compressor::Stream> create_stream() override {
+    return std::make_unique<ZstdStream>(cct->_conf->compressor_zstd_level);
+  }
+
  private:
   CephContext *const cct;
 };
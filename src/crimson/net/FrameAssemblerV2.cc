@@ -388,21 +388,28 @@ FrameAssemblerV2::read_frame_payload()
       return rx_frame_asm.get_num_segments() == rx_segments_data.size();
     },
     [this] {
-      // TODO: create aligned and contiguous buffer from socket
       const size_t seg_idx = rx_segments_data.size();
+      uint32_t onwire_len = rx_frame_asm.get_segment_onwire_len(seg_idx);
       if (uint16_t alignment = rx_frame_asm.get_segment_align(seg_idx);
           alignment != segment_t::DEFAULT_ALIGNMENT) {
         logger().trace("{} cannot allocate {} aligned buffer at segment desc index {}",
                        conn, alignment, rx_segments_data.size());
+        // TODO: create aligned and contiguous buffer from socket
+        return read_exactly<may_cross_core>(onwire_len
+        ).then([this](auto bptr) {
+          logger().trace("{} RECV({}) frame segment[{}]",
+                         conn, bptr.length(), rx_segments_data.size());
+          bufferlist segment;
+          segment.append(std::move(bptr));
+          rx_segments_data.emplace_back(std::move(segment));
+        });
       }
-      uint32_t onwire_len = rx_frame_asm.get_segment_onwire_len(seg_idx);
-      // TODO: create aligned and contiguous buffer from socket
-      return read_exactly<may_cross_core>(onwire_len
-      ).then([this](auto bptr) {
+      // no alignment wanted, keep the packets the segment arrived in
+      // rather than copying them into one contiguous buffer
+      return read<may_cross_core>(onwire_len
+      ).then([this](auto segment) {
         logger().trace("{} RECV({}) frame segment[{}]",
-                       conn, bptr.length(), rx_segments_data.size());
-        bufferlist segment;
-        segment.append(std::move(bptr));
+                       conn, segment.length(), rx_segments_data.size());
         rx_segments_data.emplace_back(std::move(segment));
       });
     }
@@ -8,6 +8,7 @@
 #include <type_traits>
 #include <boost/lockfree/queue.hpp>
 #include <boost/optional.hpp>
+#include <seastar/core/alien.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/gate.hh>
 #include <seastar/core/reactor.hh>
@@ -41,7 +42,9 @@ struct Task final : WorkItem {
   using futurator_t = seastar::futurize<T>;
 public:
   explicit Task(Func&& f)
-    : func(std::move(f))
+    : func(std::move(f)),
+      alien(seastar::engine().alien()),
+      shard(seastar::this_shard_id())
   {}
   void process() override {
     try {
@@ -54,10 +57,14 @@ public:
     } catch (...) {
       state.set_exception(std::current_exception());
     }
-    on_done.write_side().signal(1);
+    // hand the completion to the reactor's alien queue, which it polls,
+    // instead of waking it up through an fd of our own
+    seastar::alien::run_on(alien, shard, [this]() noexcept {
+      on_done.set_value();
+    });
   }
   typename futurator_t::type get_future() {
-    return on_done.wait().then([this](size_t) {
+    return on_done.get_future().then([this] {
       if (state.failed()) {
         return futurator_t::make_exception_future(state.get_exception());
       } else {
@@ -68,7 +75,9 @@ public:
 private:
   Func func;
   seastar::future_state<future_stored_type_t> state;
-  seastar::readable_eventfd on_done;
+  seastar::alien::instance& alien;
+  const unsigned shard;
+  seastar::promise<> on_done;
 };
 
 struct SubmitQueue {
@@ -123,8 +132,6 @@ public:
    *                 multiple of the number of cores.
    * @param n_threads the number of threads in this thread pool.
    * @param cpu the CPU core to which this thread pool is assigned
-   * @note each @c Task has its own crimson::thread::Condition, which possesses
-   * an fd, so we should keep the size of queue under a reasonable limit.
    */
   ThreadPool(size_t n_threads, size_t queue_sz, const std::optional<seastar::resource::cpuset>& cpus);
   ~ThreadPool();
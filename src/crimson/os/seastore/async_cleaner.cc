@@ -934,6 +934,8 @@ void SegmentCleaner::register_metrics()
 		     sm::description("rewritten bytes due to reclaim")),
     sm::make_counter("reclaimed_segment_bytes", stats.reclaimed_segment_bytes,
 		     sm::description("rewritten bytes due to reclaim")),
+    sm::make_counter("written_bytes", stats.written_bytes,
+		     sm::description("bytes written to segments, including reclaim")),
     sm::make_counter("closed_journal_used_bytes", stats.closed_journal_used_bytes,
 		     sm::description("used bytes when close a journal segment")),
     sm::make_counter("closed_journal_total_bytes", stats.closed_journal_total_bytes,
@@ -949,6 +951,9 @@ void SegmentCleaner::register_metrics()
     sm::make_gauge("reclaim_ratio",
                    [this] { return get_reclaim_ratio(); },
                    sm::description("ratio of reclaimable space to unavailable space")),
+    sm::make_gauge("write_amplification",
+                   [this] { return get_write_amplification(); },
+                   sm::description("ratio of written bytes to bytes not rewritten by reclaim")),
 
     sm::make_histogram("segment_utilization_distribution",
 		       [this]() -> seastar::metrics::histogram& {
@@ -1469,6 +1474,9 @@ void SegmentCleaner::mark_space_used(
 
   auto& seg_addr = addr.as_seg_paddr();
   stats.used_bytes += len;
+  if (background_callback->get_state() == state_t::RUNNING) {
+    stats.written_bytes += len;
+  }
   auto old_usage = calc_utilization(seg_addr.get_segment_id());
   [[maybe_unused]] auto ret = space_tracker->allocate(
     seg_addr.get_segment_id(),
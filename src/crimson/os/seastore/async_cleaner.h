@@ -1488,6 +1488,16 @@ private:
     return ret;
   }
   /// the unavailable space that is not alive
+  /// bytes written to segments per byte written by the users of the store
+  double get_write_amplification() const {
+    auto reclaimed = stats.reclaimed_bytes + stats.reclaiming_bytes;
+    if (stats.written_bytes <= reclaimed) {
+      return 1;
+    }
+    return (double)stats.written_bytes /
+      (double)(stats.written_bytes - reclaimed);
+  }
+
   std::size_t get_unavailable_unused_bytes() const {
     assert(segments.get_unavailable_bytes() > stats.used_bytes);
     return segments.get_unavailable_bytes() - stats.used_bytes;
@@ -1582,6 +1592,10 @@ private:
     uint64_t reclaimed_bytes = 0;
     uint64_t reclaimed_segment_bytes = 0;
 
+    // bytes written to segments since mount, including the rewrites by
+    // reclaim, not counting the initial scan
+    uint64_t written_bytes = 0;
+
     seastar::metrics::histogram segment_util;
   } stats;
   seastar::metrics::metric_group metrics;
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 
 #include "seastar/core/shared_future.hh"
@@ -1247,20 +1248,64 @@ private:
    * lru
    *
    * holds references to recently used extents
+   *
+   * Segmented: extents enter the probation segment and are promoted to
+   * the protected segment when touched again, so that a scan that reads
+   * every extent once only evicts other extents of the probation
+   * segment.  Btree and other metadata extents go straight to the
+   * protected segment.  Extents overflowing the protected segment are
+   * demoted to probation, and eviction takes from probation first.
    */
   class LRU {
     // max size (bytes)
     const size_t capacity = 0;
+    // max size of the protected segment (bytes)
+    const size_t protected_capacity = 0;
 
     // current size (bytes)
     size_t contents = 0;
+    size_t protected_contents = 0;
+
+    CachedExtent::list probation_lru;
+    CachedExtent::list protected_lru;
+
+    static bool is_metadata(const CachedExtent &extent) {
+      return extent.get_type() != extent_types_t::OBJECT_DATA_BLOCK &&
+	extent.get_type() != extent_types_t::TEST_BLOCK;
+    }
+
+    void unlink(CachedExtent &extent) {
+      assert(extent.primary_ref_list_hook.is_linked());
+      if (extent.lru_protected) {
+	protected_lru.erase(protected_lru.s_iterator_to(extent));
+	assert(protected_contents >= extent.get_length());
+	protected_contents -= extent.get_length();
+	extent.lru_protected = false;
+      } else {
+	probation_lru.erase(probation_lru.s_iterator_to(extent));
+      }
+    }
 
-    CachedExtent::list lru;
+    void link(CachedExtent &extent, bool to_protected) {
+      if (to_protected) {
+	protected_lru.push_back(extent);
+	protected_contents += extent.get_length();
+	extent.lru_protected = true;
+      } else {
+	probation_lru.push_back(extent);
+      }
+    }
 
     void trim_to_capacity() {
+      while (protected_contents > protected_capacity) {
+	auto &extent = protected_lru.front();
+	unlink(extent);
+	link(extent, false);
+      }
       while (contents > capacity) {
-	assert(lru.size() > 0);
-	remove_from_lru(lru.front());
+	assert(probation_lru.size() > 0 || protected_lru.size() > 0);
+	remove_from_lru(probation_lru.size() > 0 ?
+			probation_lru.front() : protected_lru.front());
       }
     }
 
@@ -1270,13 +1315,15 @@ private:
       if (!extent.primary_ref_list_hook.is_linked()) {
 	contents += extent.get_length();
 	intrusive_ptr_add_ref(&extent);
-	lru.push_back(extent);
+	link(extent, is_metadata(extent));
       }
       trim_to_capacity();
     }
 
   public:
-    LRU(size_t capacity) : capacity(capacity) {}
+    LRU(size_t capacity, double protected_ratio)
+      : capacity(capacity),
+	protected_capacity(capacity * std::clamp(protected_ratio, 0.0, 1.0)) {}
 
     size_t get_capacity() const {
       return capacity;
@@ -1286,15 +1333,19 @@ private:
       return contents;
     }
 
+    size_t get_current_protected_bytes() const {
+      return protected_contents;
+    }
+
     size_t get_current_contents_extents() const {
-      return lru.size();
+      return probation_lru.size() + protected_lru.size();
     }
 
     void remove_from_lru(CachedExtent &extent) {
       assert(extent.is_clean() && !extent.is_placeholder());
 
       if (extent.primary_ref_list_hook.is_linked()) {
-	lru.erase(lru.s_iterator_to(extent));
+	unlink(extent);
 	assert(contents >= extent.get_length());
 	contents -= extent.get_length();
 	intrusive_ptr_release(&extent);
@@ -1305,19 +1356,22 @@ private:
       assert(extent.is_clean() && !extent.is_placeholder());
 
       if (extent.primary_ref_list_hook.is_linked()) {
-	lru.erase(lru.s_iterator_to(extent));
-	intrusive_ptr_release(&extent);
-	assert(contents >= extent.get_length());
-	contents -= extent.get_length();
+	// touched again while cached: promote
+	unlink(extent);
+	link(extent, true);
+	trim_to_capacity();
+      } else {
+	add_to_lru(extent);
       }
-      add_to_lru(extent);
     }
 
     void clear() {
       LOG_PREFIX(Cache::LRU::clear);
-      for (auto iter = lru.begin(); iter != lru.end();) {
-	SUBDEBUG(seastore_cache, "clearing {}", *iter);
-	remove_from_lru(*(iter++));
+      for (auto *l : {&probation_lru, &protected_lru}) {
+	for (auto iter = l->begin(); iter != l->end();) {
+	  SUBDEBUG(seastore_cache, "clearing {}", *iter);
+	  remove_from_lru(*(iter++));
+	}
       }
     }
 
@@ -1389,6 +1443,7 @@ private:
     counter_by_src_t<commit_trans_efforts_t> committed_efforts_by_src;
     counter_by_src_t<invalid_trans_efforts_t> invalidated_efforts_by_src;
     counter_by_src_t<query_counters_t> cache_query_by_src;
+    counter_by_extent_t<query_counters_t> cache_query_by_ext;
     success_read_trans_efforts_t success_read_efforts;
     uint64_t dirty_bytes = 0;
 
@@ -1550,9 +1605,15 @@ private:
       paddr_t offset,
       const src_ext_t* p_metric_key) {
     query_counters_t* p_counters = nullptr;
+    query_counters_t* p_ext_counters = nullptr;
     if (p_metric_key) {
       p_counters = &get_by_src(stats.cache_query_by_src, p_metric_key->first);
       ++p_counters->access;
+      if (p_metric_key->second < extent_types_t::NONE) {
+        p_ext_counters = &get_by_ext(stats.cache_query_by_ext,
+                                     p_metric_key->second);
+        ++p_ext_counters->access;
+      }
     }
     if (auto iter = extents.find_offset(offset);
         iter != extents.end()) {
@@ -1560,6 +1621,9 @@ private:
           // retired_placeholder is not really cached yet
           iter->get_type() != extent_types_t::RETIRED_PLACEHOLDER) {
         ++p_counters->hit;
+        if (p_ext_counters) {
+          ++p_ext_counters->hit;
+        }
       }
       return CachedExtentRef(&*iter);
     } else {
@@ -608,6 +608,8 @@ private:
   using list = boost::intrusive::list<
     CachedExtent,
     primary_ref_list_member_options>;
+  /// set while on the protected segment of the cache lru
+  bool lru_protected = false;
 
   /**
    * dirty_from_or_retired_at
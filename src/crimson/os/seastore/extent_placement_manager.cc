@@ -768,6 +768,19 @@ RandomBlockOolWriter::alloc_write_ool_extents(
   });
 }
 
+// extents that survived more rewrites are expected to live longer,
+// let the device keep them apart from the short lived ones
+static uint16_t get_write_life_hint(rewrite_gen_t gen)
+{
+  if (gen < MIN_REWRITE_GENERATION) {
+    return WRITE_LIFE_MEDIUM;
+  } else if (gen < MIN_COLD_GENERATION) {
+    return WRITE_LIFE_LONG;
+  } else {
+    return WRITE_LIFE_EXTREME;
+  }
+}
+
 RandomBlockOolWriter::alloc_write_iertr::future<>
 RandomBlockOolWriter::do_write(
   Transaction& t,
@@ -791,7 +804,8 @@ RandomBlockOolWriter::do_write(
 
     ex->prepare_write();
     return rbm->write(paddr,
-      ex->get_bptr()
+      ex->get_bptr(),
+      get_write_life_hint(ex->get_rewrite_generation())
     ).handle_error(
       alloc_write_iertr::pass_further{},
       crimson::ct_error::assert_all{
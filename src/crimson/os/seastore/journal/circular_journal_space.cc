@@ -160,7 +160,8 @@ CircularJournalSpace::write_ertr::future<> CircularJournalSpace::device_write_bl
     "overwrite in CircularJournalSpace, offset {}, length {}",
     offset,
     length);
-  return device->writev(offset, bl
+  // journal records are trimmed soon after they are written
+  return device->writev(offset, bl, WRITE_LIFE_SHORT
   ).handle_error(
     write_ertr::pass_further{},
     crimson::ct_error::assert_all{ "Invalid error device->write" }
@@ -36,6 +36,7 @@ RecordBatch::add_pending(
   if (state == state_t::EMPTY) {
     assert(!io_promise.has_value());
     io_promise = seastar::shared_promise<maybe_promise_result_t>();
+    pending_since = std::chrono::steady_clock::now();
   } else {
     assert(io_promise.has_value());
   }
@@ -299,13 +300,15 @@ RecordSubmitter::submit(
     DEBUG("{} fast submit {}, committed_to={}, outstanding_io={} ...",
           get_name(), sizes, get_committed_to(), num_outstanding_io);
     account_submission(1, sizes);
+    auto start = std::chrono::steady_clock::now();
     return journal_allocator.write(std::move(to_write)
     ).safe_then([mdlength = sizes.get_mdlength()](auto write_result) {
       return record_locator_t{
         write_result.start_seq.offset.add_offset(mdlength),
         write_result
       };
-    }).finally([this] {
+    }).finally([this, start] {
+      account_write(start);
       decrement_io_with_flush();
     });
   }
@@ -408,6 +411,24 @@ RecordSubmitter::open(bool is_mkfs)
           sm::description("bytes of data when write record groups"),
           label_instances
         ),
+        sm::make_counter(
+          "record_batch_flush_num",
+          stats.batch_flush_num,
+          sm::description("total number of record batches flushed"),
+          label_instances
+        ),
+        sm::make_counter(
+          "record_batch_wait_us",
+          stats.batch_wait_us,
+          sm::description("total microseconds batches waited before flush"),
+          label_instances
+        ),
+        sm::make_counter(
+          "io_write_us",
+          stats.io_write_us,
+          sm::description("total microseconds spent in io, see io_num"),
+          label_instances
+        ),
       }
     );
     return ret;
@@ -487,6 +508,13 @@ void RecordSubmitter::account_submission(
   stats.record_batch_stats.increment(num);
 }
 
+void RecordSubmitter::account_write(
+  std::chrono::steady_clock::time_point start)
+{
+  stats.io_write_us += std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start).count();
+}
+
 void RecordSubmitter::finish_submit_batch(
   RecordBatch* p_batch,
   maybe_result_t maybe_result)
@@ -507,15 +535,20 @@ void RecordSubmitter::flush_current_batch()
 
   increment_io();
   auto num = p_batch->get_num_records();
+  auto start = std::chrono::steady_clock::now();
+  ++stats.batch_flush_num;
+  stats.batch_wait_us += std::chrono::duration_cast<std::chrono::microseconds>(
+    start - p_batch->get_pending_since()).count();
   auto [to_write, sizes] = p_batch->encode_batch(
     get_committed_to(), journal_allocator.get_nonce());
   DEBUG("{} {} records, {}, committed_to={}, outstanding_io={} ...",
         get_name(), num, sizes, get_committed_to(), num_outstanding_io);
   account_submission(num, sizes);
   std::ignore = journal_allocator.write(std::move(to_write)
-  ).safe_then([this, p_batch, FNAME, num, sizes=sizes](auto write_result) {
+  ).safe_then([this, p_batch, FNAME, num, sizes=sizes, start](auto write_result) {
     TRACE("{} {} records, {}, write done with {}",
           get_name(), num, sizes, write_result);
+    account_write(start);
     finish_submit_batch(p_batch, write_result);
   }).handle_error(
     crimson::ct_error::all_same_way([this, p_batch, FNAME, num, sizes=sizes](auto e) {
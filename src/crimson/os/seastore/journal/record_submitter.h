@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <optional>
 #include <seastar/core/circular_buffer.hh>
 #include <seastar/core/metrics.hh>
@@ -96,6 +97,12 @@ public:
     return batch_capacity;
   }
 
+  // when the first record was added to the pending batch
+  std::chrono::steady_clock::time_point get_pending_since() const {
+    assert(state == state_t::PENDING);
+    return pending_since;
+  }
+
   const record_group_size_t& get_submit_size() const {
     assert(state != state_t::EMPTY);
     return pending.size;
@@ -180,6 +187,7 @@ private:
   }
 
   state_t state = state_t::EMPTY;
+  std::chrono::steady_clock::time_point pending_since;
   std::size_t index = 0;
   std::size_t batch_capacity = 0;
   std::size_t batch_flush_size = 0;
@@ -308,6 +316,8 @@ private:
 
   void account_submission(std::size_t, const record_group_size_t&);
 
+  void account_write(std::chrono::steady_clock::time_point start);
+
   using maybe_result_t = RecordBatch::maybe_result_t;
   void finish_submit_batch(RecordBatch*, maybe_result_t);
 
@@ -340,6 +350,11 @@ private:
     uint64_t record_group_padding_bytes = 0;
     uint64_t record_group_metadata_bytes = 0;
     uint64_t record_group_data_bytes = 0;
+    // time batched records waited for their batch to be flushed, summed
+    // per batch, and time spent in device writes
+    uint64_t batch_flush_num = 0;
+    uint64_t batch_wait_us = 0;
+    uint64_t io_write_us = 0;
   } stats;
   seastar::metrics::metric_group metrics;
 };
@@ -553,6 +553,34 @@ class TreeBuilder {
     });
   }
 
+  // find every inserted key in random order, timing the tree walks only
+  eagain_ifuture<> lookup(Transaction& t) {
+    logger().warn("start looking up {} kvs ...", kvs.size());
+    return seastar::do_with(
+      kvs.random_begin(), mono_clock::now(),
+      [this, &t] (auto &iter, auto &start_time) {
+      return trans_intr::repeat(
+        [this, &t, &iter, &start_time]()
+        -> eagain_iertr::future<seastar::stop_iteration> {
+        if (iter == kvs.random_end()) {
+          std::chrono::duration<double> duration =
+            mono_clock::now() - start_time;
+          logger().warn("Lookup done! {}s, {} lookups/s",
+                        duration.count(), kvs.size() / duration.count());
+          return seastar::make_ready_future<seastar::stop_iteration>(
+            seastar::stop_iteration::yes);
+        }
+        return tree->find(t, (*iter)->key
+        ).si_then([&iter] (auto cursor) {
+          ceph_assert(!cursor.is_end());
+          ++iter;
+          return seastar::make_ready_future<seastar::stop_iteration>(
+            seastar::stop_iteration::no);
+        });
+      });
+    });
+  }
+
  private:
   static seastar::logger& logger() {
     return crimson::get_logger(ceph_subsys_test);
@@ -70,7 +70,11 @@ public:
     crimson::ct_error::enospc,
     crimson::ct_error::erange
     >;
-  virtual write_ertr::future<> write(paddr_t addr, bufferptr &buf) = 0;
+  // stream is a write life hint for the device, see WRITE_LIFE_*
+  virtual write_ertr::future<> write(
+    paddr_t addr,
+    bufferptr &buf,
+    uint16_t stream = 0) = 0;
 
   using open_ertr = crimson::errorator<
     crimson::ct_error::input_output_error,
@@ -86,7 +86,8 @@ BlockRBManager::open_ertr::future<> BlockRBManager::open()
 
 BlockRBManager::write_ertr::future<> BlockRBManager::write(
   paddr_t paddr,
-  bufferptr &bptr)
+  bufferptr &bptr,
+  uint16_t stream)
 {
   LOG_PREFIX(BlockRBManager::write);
   ceph_assert(device);
@@ -102,7 +103,8 @@ BlockRBManager::write_ertr::future<> BlockRBManager::write(
   bp.copy_in(0, bptr.length(), bptr.c_str());
   return device->write(
     addr,
-    std::move(bp));
+    std::move(bp),
+    stream);
 }
 
 BlockRBManager::read_ertr::future<> BlockRBManager::read(
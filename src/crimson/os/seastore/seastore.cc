@@ -205,6 +205,17 @@ seastar::future<> SeaStore::start()
   device_type_t d_type = string_to_device_type(type);
   assert(d_type == device_type_t::SSD ||
          d_type == device_type_t::RANDOM_BLOCK_SSD);
+  if (d_type == device_type_t::RANDOM_BLOCK_SSD &&
+      seastar::smp::count > 1) {
+    // segmented devices are split across the shards, but the random
+    // block manager and its circular journal own the whole device, so
+    // shards would allocate from the same space
+    LOG_PREFIX(SeaStore::start);
+    ERROR("{} supports a single reactor, but {} are configured",
+          type, seastar::smp::count);
+    return seastar::make_exception_future<>(
+      std::runtime_error("store smp error"));
+  }
 
   ceph_assert(root != "");
   return Device::make_device(root, d_type
@@ -847,24 +858,48 @@ SeaStore::Shard::readv(
   interval_set<uint64_t>& m,
   uint32_t op_flags)
 {
-  return seastar::do_with(
+  LOG_PREFIX(SeaStore::readv);
+  DEBUG("oid {} {} extents", _oid, m.num_intervals());
+  // look the onode up once for all the extents rather than once per
+  // extent, as small objects are mostly metadata work
+  return repeat_with_onode<ceph::bufferlist>(
+    ch,
     _oid,
-    ceph::bufferlist{},
-    [=, this, &m](auto &oid, auto &ret) {
-    return crimson::do_for_each(
-      m,
-      [=, this, &oid, &ret](auto &p) {
-      return read(
-	ch, oid, p.first, p.second, op_flags
-	).safe_then([&ret](auto bl) {
-        ret.claim_append(bl);
+    Transaction::src_t::READ,
+    "readv_obj",
+    op_type_t::READ,
+    [=, this, &m](auto &t, auto &onode) -> ObjectDataHandler::read_ret {
+      return seastar::do_with(
+        ceph::bufferlist{},
+        [=, this, &m, &t, &onode](auto &ret) {
+        return trans_intr::do_for_each(
+          m,
+          [=, this, &t, &onode, &ret](auto &p)
+          -> ObjectDataHandler::read_iertr::future<> {
+          size_t size = onode.get_layout().size;
+          auto [offset, len] = p;
+          if (offset >= size) {
+            return seastar::now();
+          }
+          size_t corrected_len = (len == 0) ?
+            size - offset :
+            std::min(size - offset, len);
+          return ObjectDataHandler(max_object_size).read(
+            ObjectDataHandler::context_t{
+              *transaction_manager,
+              t,
+              onode,
+            },
+            offset,
+            corrected_len
+          ).si_then([&ret](auto bl) {
+            ret.claim_append(bl);
+          });
+        }).si_then([&ret] {
+          return std::move(ret);
+        });
       });
-    }).safe_then([&ret] {
-      return read_errorator::make_ready_future<ceph::bufferlist>
-        (std::move(ret));
     });
-  });
-  return read_errorator::make_ready_future<ceph::bufferlist>();
 }
 
 using crimson::os::seastore::omap_manager::BtreeOMapManager;
@@ -19,8 +19,9 @@ ECBackend::_read(const hobject_t& hoid,
                  const uint64_t len,
                  const uint32_t flags)
 {
-  // todo
-  return seastar::make_ready_future<bufferlist>();
+  // todo: client ops on erasure coded pools are refused by
+  // ClientRequest::do_process(), never pretend an empty object was read
+  return crimson::ct_error::input_output_error::make();
 }
 
 ECBackend::rep_op_fut_t
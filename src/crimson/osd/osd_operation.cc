@@ -44,6 +44,66 @@ OSDOperationRegistry::OSDOperationRegistry()
     static_cast<size_t>(OperationTypeCode::historic_client_request);
   auto& historic_registry = get_registry<historic_reg_index>();
   last_of_recents = std::begin(historic_registry);
+  register_metrics();
+}
+
+void OSDOperationRegistry::account_client_request_stage(
+  size_t stage, utime_t lat)
+{
+  assert(stage < client_request_stage_lat.size());
+  auto& stat = client_request_stage_lat[stage];
+  uint64_t us = lat.to_nsec() / 1000;
+  // bucket b holds samples up to 2^b us, longer ones only count towards
+  // the implicit +Inf bucket
+  size_t bucket = us ? 64 - __builtin_clzll(us) : 0;
+  ++stat.count;
+  stat.sum_us += us;
+  if (bucket < stat.buckets.size()) {
+    ++stat.buckets[bucket];
+  }
+}
+
+void OSDOperationRegistry::register_metrics()
+{
+  namespace sm = seastar::metrics;
+  // in the order ClientRequest enters them
+  static constexpr std::array<const char*, NUM_CLIENT_REQUEST_STAGES>
+    stage_names = {
+      "await_map",
+      "wait_for_map",
+      "wait_for_active",
+      "wait_pg_active",
+      "recover_missing",
+      "get_obc",
+      "process",
+      "wait_repop",
+      "send_reply",
+    };
+  for (size_t i = 0; i < stage_names.size(); ++i) {
+    metrics.add_group(
+      "osd",
+      {
+	sm::make_histogram(
+	  "client_request_stage_latency_us",
+	  [this, i] {
+	    const auto& stat = client_request_stage_lat[i];
+	    seastar::metrics::histogram h;
+	    h.sample_count = stat.count;
+	    h.sample_sum = stat.sum_us;
+	    uint64_t cumulative = 0;
+	    for (size_t b = 0; b < stat.buckets.size(); ++b) {
+	      cumulative += stat.buckets[b];
+	      h.buckets.push_back({cumulative, double(1ull << b)});
+	    }
+	    return h;
+	  },
+	  sm::description("microseconds client requests spent in a stage "
+			  "of the PG pipeline"),
+	  {sm::label_instance("stage", stage_names[i])}
+	),
+      }
+    );
+  }
 }
 
 static auto get_duration(const ClientRequest& client_request)
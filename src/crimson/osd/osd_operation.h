@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <array>
+#include <seastar/core/metrics.hh>
+
 #include "crimson/common/operation.h"
 #include "crimson/osd/pg_interval_interrupt_condition.h"
 #include "crimson/osd/scheduler/scheduler.h"
@@ -202,10 +205,27 @@ struct OSDOperationRegistry : OperationRegistryT<
   size_t dump_historic_client_requests(ceph::Formatter* f) const;
   size_t dump_slowest_historic_client_requests(ceph::Formatter* f) const;
 
+  /// stages of the PG pipeline a ClientRequest is accounted in, see
+  /// ClientRequest::account_pg_stages()
+  static constexpr size_t NUM_CLIENT_REQUEST_STAGES = 9;
+  /// record the time a client request spent in a PG pipeline stage
+  void account_client_request_stage(size_t stage, utime_t lat);
+
 private:
   op_list::const_iterator last_of_recents;
   size_t num_recent_ops = 0;
   size_t num_slow_ops = 0;
+
+  // log2 buckets of microseconds, exported as cumulative histograms
+  static constexpr size_t NUM_LAT_BUCKETS = 24;
+  struct stage_lat_t {
+    uint64_t count = 0;
+    double sum_us = 0;
+    std::array<uint64_t, NUM_LAT_BUCKETS> buckets = {};
+  };
+  std::array<stage_lat_t, NUM_CLIENT_REQUEST_STAGES> client_request_stage_lat;
+  seastar::metrics::metric_group metrics;
+  void register_metrics();
 };
 /**
  * Throttles set of currently running operations
@@ -48,6 +48,32 @@ void ClientRequest::complete_request()
   on_complete.set_value();
 }
 
+void ClientRequest::account_pg_stages(
+  ShardServices &shard_services,
+  const instance_handle_t &ih) const
+{
+  // a stage lasts until the next event recorded. blockers the request
+  // did not wait on were never triggered and have no timestamp.
+  std::array<utime_t, OSDOperationRegistry::NUM_CLIENT_REQUEST_STAGES + 1>
+    stamps;
+  std::apply([&stamps](const auto&... event) {
+    size_t i = 0;
+    ((stamps[i++] = event.internal_backend.timestamp), ...);
+  }, ih.pg_tracking_events);
+  stamps.back() = ceph_clock_now();
+  auto &registry = shard_services.get_registry();
+  for (size_t i = 0; i + 1 < stamps.size(); ++i) {
+    if (stamps[i].is_zero()) {
+      continue;
+    }
+    size_t next = i + 1;
+    while (stamps[next].is_zero()) {
+      ++next;
+    }
+    registry.account_client_request_stage(i, stamps[next] - stamps[i]);
+  }
+}
+
 ClientRequest::ClientRequest(
   ShardServices &shard_services, crimson::net::ConnectionRef conn,
   Ref<MOSDOp> &&m)
@@ -142,8 +168,10 @@ seastar::future<> ClientRequest::with_pg_int(
 	} else {
 	  return process_op(ihref, pgref);
 	}
-      }).then_interruptible([this, this_instance_id, pgref] {
+      }).then_interruptible([this, this_instance_id, pgref, &ihref,
+			     &shard_services] {
 	logger().debug("{}.{}: after process*", *this, this_instance_id);
+	account_pg_stages(shard_services, ihref);
 	pgref->client_request_orderer.remove_request(*this);
 	complete_request();
       });
@@ -261,6 +289,12 @@ ClientRequest::do_process(
       return reply_op_error(pg, -EIO);
     }
   }
+  if (pool.is_erasure()) {
+    // ECBackend has no read or write path yet
+    logger().info("{} pool {} is erasure coded, which is not supported",
+                  *this, pg->get_pgid().pool());
+    return reply_op_error(pg, -EOPNOTSUPP);
+  }
   if (m->get_oid().name.size()
     > crimson::common::local_conf()->osd_max_object_name_len) {
     return reply_op_error(pg, -ENAMETOOLONG);
@@ -155,6 +155,12 @@ public:
     }
   };
   instance_handle_t::ref_t instance_handle;
+  static_assert(
+    std::tuple_size_v<decltype(instance_handle_t::pg_tracking_events)> ==
+    OSDOperationRegistry::NUM_CLIENT_REQUEST_STAGES + 1 /* completion */);
+  /// feed the time spent in each PG pipeline stage to the registry
+  void account_pg_stages(ShardServices &shard_services,
+                         const instance_handle_t &ih) const;
   void reset_instance_handle() {
     instance_handle = new instance_handle_t;
   }
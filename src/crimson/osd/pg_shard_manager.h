@@ -9,6 +9,7 @@
 
 #include "crimson/osd/shard_services.h"
 #include "crimson/osd/pg_map.h"
+#include "osd/osd_perf_counters.h"
 
 namespace crimson::os {
   class FuturizedStore;
@@ -159,6 +160,7 @@ public:
         target_shard_services,
         std::move(op));
     }
+    get_local_state().perf->inc(l_osd_op_remote_submit);
     return op->prepare_remote_submission(
     ).then([op=std::move(op), f=std::move(f), this, core
            ](auto f_conn) mutable {
@@ -216,6 +216,12 @@ static seastar::future<> run(
         : public crimson::net::Dispatcher,
           public seastar::peering_sharded_service<Client> {
 
+      // reactor busy time of this shard, to account CPU per message
+      static double get_busy_s() {
+        return std::chrono::duration<double>(
+          seastar::engine().total_busy_time()).count();
+      }
+
       struct ConnStats {
         mono_time connecting_time = mono_clock::zero();
         mono_time connected_time = mono_clock::zero();
@@ -226,15 +232,18 @@ static seastar::future<> run(
 
         unsigned sampled_count = 0u;
         double total_lat_s = 0.0;
+        double start_busy_s = 0.0;
 
         // for reporting only
         mono_time finish_time = mono_clock::zero();
+        double busy_s = 0.0;
 
         void start() {
           start_time = mono_clock::now();
           start_count = received_count;
           sampled_count = 0u;
           total_lat_s = 0.0;
+          start_busy_s = get_busy_s();
           finish_time = mono_clock::zero();
         }
       };
@@ -245,13 +254,16 @@ static seastar::future<> run(
         unsigned start_count = 0u;
         unsigned sampled_count = 0u;
         double total_lat_s = 0.0;
+        double start_busy_s = 0.0;
 
         // for reporting only
         mono_time finish_time = mono_clock::zero();
         unsigned finish_count = 0u;
         unsigned depth = 0u;
+        double busy_s = 0.0;
 
         void reset(unsigned received_count, PeriodStats* snap = nullptr) {
+          double now_busy_s = get_busy_s();
           if (snap) {
             snap->start_time = start_time;
             snap->start_count = start_count;
@@ -259,11 +271,13 @@ static seastar::future<> run(
             snap->total_lat_s = total_lat_s;
             snap->finish_time = mono_clock::now();
             snap->finish_count = received_count;
+            snap->busy_s = now_busy_s - start_busy_s;
           }
           start_time = mono_clock::now();
           start_count = received_count;
           sampled_count = 0u;
           total_lat_s = 0.0;
+          start_busy_s = now_busy_s;
         }
       };
       PeriodStats period_stats;
@@ -436,7 +450,8 @@ static seastar::future<> run(
                << std::setw(6) << "depth"
                << std::setw(8) << "IOPS"
                << std::setw(8) << "MB/s"
-               << std::setw(8) << "lat(ms)";
+               << std::setw(8) << "lat(ms)"
+               << std::setw(10) << "cpu(us)";
           std::cout << sout.str() << std::endl;
         }
 
@@ -452,12 +467,14 @@ static seastar::future<> run(
           unsigned ops = 0u;
           unsigned sampled_count = 0u;
           double total_lat_s = 0.0;
+          double busy_s = 0.0;
           for (const auto& snap: snaps) {
             elapsed_d += (snap.finish_time - snap.start_time);
             depth += snap.depth;
             ops += (snap.finish_count - snap.start_count);
             sampled_count += snap.sampled_count;
             total_lat_s += snap.total_lat_s;
+            busy_s += snap.busy_s;
           }
           double elapsed_s = elapsed_d.count() / jobs;
           double iops = ops/elapsed_s;
@@ -467,7 +484,8 @@ static seastar::future<> run(
                << std::setw(6) << depth
                << std::setw(8) << iops
                << std::setw(8) << iops * bytes_of_block / 1048576
-               << std::setw(8) << (total_lat_s / sampled_count * 1000);
+               << std::setw(8) << (total_lat_s / sampled_count * 1000)
+               << std::setw(10) << (busy_s / ops * 1000000);
           std::cout << sout.str() << std::endl;
         }
 
@@ -476,11 +494,13 @@ static seastar::future<> run(
           unsigned ops = 0u;
           unsigned sampled_count = 0u;
           double total_lat_s = 0.0;
+          double busy_s = 0.0;
           for (const auto& summary: summaries) {
             elapsed_d += (summary.finish_time - summary.start_time);
             ops += (summary.received_count - summary.start_count);
             sampled_count += summary.sampled_count;
             total_lat_s += summary.total_lat_s;
+            busy_s += summary.busy_s;
           }
           double elapsed_s = elapsed_d.count() / jobs;
           double iops = ops / elapsed_s;
@@ -494,6 +514,7 @@ static seastar::future<> run(
                << std::setw(8) << iops
                << std::setw(8) << iops * bytes_of_block / 1048576
                << std::setw(8) << (total_lat_s / sampled_count * 1000)
+               << std::setw(10) << (busy_s / ops * 1000000)
                << "\n";
           std::cout << sout.str() << std::endl;
         }
@@ -518,6 +539,7 @@ static seastar::future<> run(
             ConnStats& summary = report.get_summary_by_job(client.sid);
             summary = client.conn_stats;
             summary.finish_time = mono_clock::now();
+            summary.busy_s = get_busy_s() - summary.start_busy_s;
           }
         }).then([&report] {
           report.report_summary();
@@ -60,6 +60,10 @@ class PerfTree : public TMTestState {
           with_trans_intr(*t, [&](auto &tr){
             return tree->validate(tr);
           }).unsafe_get();
+
+          with_trans_intr(*t, [&](auto &tr){
+            return tree->lookup(tr);
+          }).unsafe_get();
         }
         {
           auto t = create_mutate_transaction();
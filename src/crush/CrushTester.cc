@@ -570,6 +570,21 @@ int CrushTester::test(CephContext* cct)
         // create a vector to hold placement results temporarily 
         vector<int> temporary_per ( per.size() );
 
+        // map the whole batch through CRUSH at once
+        vector<vector<int>> batch_out;
+        if (use_crush) {
+          vector<int> real_xs;
+          real_xs.reserve(batch_max - batch_min + 1);
+          for (int x = batch_min; x <= batch_max; x++) {
+            uint32_t real_x = x;
+            if (pool_id != -1) {
+              real_x = crush_hash32_2(CRUSH_HASH_RJENKINS1, x, (uint32_t)pool_id);
+            }
+            real_xs.push_back(real_x);
+          }
+          crush.do_rule_batch(r, real_xs, &batch_out, nr, weight, 0);
+        }
+
         for (int x = batch_min; x <= batch_max; x++) {
           // create a vector to hold the results of a CRUSH placement or RNG simulation
           vector<int> out;
@@ -577,11 +592,7 @@ int CrushTester::test(CephContext* cct)
           if (use_crush) {
             if (output_mappings)
 	      err << "CRUSH"; // prepend CRUSH to placement output
-            uint32_t real_x = x;
-            if (pool_id != -1) {
-              real_x = crush_hash32_2(CRUSH_HASH_RJENKINS1, x, (uint32_t)pool_id);
-            }
-            crush.do_rule(r, real_x, out, nr, weight, 0);
+            out.swap(batch_out[x - batch_min]);
           } else {
             if (output_mappings)
 	      err << "RNG"; // prepend RNG to placement output to denote simulation
@@ -737,12 +748,15 @@ int CrushTester::compare(CrushWrapper& crush2)
     }
     int bad = 0;
     for (int nr = min_rep; nr <= max_rep; nr++) {
+      vector<int> xs;
       for (int x = min_x; x <= max_x; ++x) {
-	vector<int> out;
-	crush.do_rule(r, x, out, nr, weight, 0);
-	vector<int> out2;
-	crush2.do_rule(r, x, out2, nr, weight, 0);
-	if (out != out2) {
+	xs.push_back(x);
+      }
+      vector<vector<int>> out, out2;
+      crush.do_rule_batch(r, xs, &out, nr, weight, 0);
+      crush2.do_rule_batch(r, xs, &out2, nr, weight, 0);
+      for (size_t i = 0; i < xs.size(); ++i) {
+	if (out[i] != out2[i]) {
 	  ++bad;
 	}
       }
@@ -1298,6 +1298,17 @@ public:
       crush->max_devices = name_map.rbegin()->first + 1;
     }
     build_rmaps();
+    compile();
+  }
+  /// precompute what do_rule() needs, see crush_compile()
+  void compile() {
+    std::vector<crush_choose_arg_map> args;
+    args.reserve(choose_args.size());
+    for (auto& i : choose_args) {
+      args.push_back(i.second);
+    }
+    // without it mappings are just slower
+    crush_compile(crush, args.data(), args.size());
   }
   int bucket_set_alg(int id, int alg);
 
@@ -1527,6 +1538,32 @@ public:
       out[i] = rawout[i];
   }
 
+  /// map each of xs as do_rule() would, sharing one workspace
+  template<typename WeightVector>
+  void do_rule_batch(int rule, const std::vector<int>& xs,
+		     std::vector<std::vector<int>> *out, int maxout,
+		     const WeightVector& weight,
+		     uint64_t choose_args_index) const {
+    out->resize(xs.size());
+    if (xs.empty()) {
+      return;
+    }
+    std::vector<int> rawout(xs.size() * maxout);
+    std::vector<int> numrep(xs.size());
+    std::vector<char> work(crush_work_size(crush, maxout));
+    crush_init_workspace(crush, work.data());
+    crush_choose_arg_map arg_map = choose_args_get_with_fallback(
+      choose_args_index);
+    crush_do_rule_batch(crush, rule, xs.data(), xs.size(),
+			rawout.data(), numrep.data(), maxout,
+			std::data(weight), std::size(weight),
+			work.data(), arg_map.args);
+    for (size_t i = 0; i < xs.size(); ++i) {
+      auto first = rawout.begin() + i * maxout;
+      (*out)[i].assign(first, first + std::max(numrep[i], 0));
+    }
+  }
+
   int _choose_type_stack(
     CephContext *cct,
     const std::vector<std::pair<int,int>>& stack,
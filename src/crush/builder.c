@@ -61,6 +61,111 @@ void crush_finalize(struct crush_map *map)
 }
 
 
+/*
+ * The numerators of the straw2 draws are the magnitudes of the natural
+ * logs in generate_exponential_distribution(), at most 2^48.
+ */
+#define CRUSH_STRAW2_LN_BITS 49
+
+/*
+ * Division by an invariant integer, see Granlund and Montgomery,
+ * "Division by Invariant Integers using Multiplication": with
+ * l = ceil(log2(weight)) and m = floor(2^(N+l) / weight) + 1,
+ * n / weight == (n * m) >> (N + l) for every n < 2^N.
+ */
+static void crush_straw2_recip_init(struct crush_straw2_recip *r,
+				    __u32 weight)
+{
+	r->weight = weight;
+	r->magic = 0;
+	r->shift = 0;
+#ifdef __SIZEOF_INT128__
+	/* the mapper divides by the weight as a signed int */
+	if (weight && weight <= 0x7fffffff) {
+		int l = weight == 1 ? 0 : 32 - __builtin_clz(weight - 1);
+		r->shift = CRUSH_STRAW2_LN_BITS + l;
+		r->magic = (__u64)(((unsigned __int128)1 << r->shift) /
+				   weight) + 1;
+	}
+#endif
+}
+
+static int crush_compile_weights(struct crush_compiled_weights *set,
+				 const __u32 *weights, __u32 size)
+{
+	__u32 i;
+
+	set->weights = weights;
+	set->size = size;
+	if (!size)
+		return 0;
+	set->recips = malloc(sizeof(*set->recips) * size);
+	if (!set->recips)
+		return -ENOMEM;
+	for (i = 0; i < size; i++)
+		crush_straw2_recip_init(&set->recips[i], weights[i]);
+	return 0;
+}
+
+int crush_compile(struct crush_map *map,
+		  const struct crush_choose_arg_map *args,
+		  int num_args)
+{
+	__s32 b;
+	__u32 n, p;
+	int a;
+
+	crush_destroy_compiled(map);
+	if (map->max_buckets <= 0)
+		return 0;
+	map->compiled = calloc(map->max_buckets, sizeof(*map->compiled));
+	if (!map->compiled)
+		return -ENOMEM;
+	map->num_compiled = map->max_buckets;
+	for (b = 0; b < map->max_buckets; b++) {
+		struct crush_bucket_straw2 *bucket;
+		struct crush_compiled_bucket *c = &map->compiled[b];
+
+		if (!map->buckets[b] ||
+		    map->buckets[b]->alg != CRUSH_BUCKET_STRAW2)
+			continue;
+		bucket = (struct crush_bucket_straw2 *)map->buckets[b];
+		n = 1;
+		for (a = 0; a < num_args; a++) {
+			if ((__u32)b < args[a].size && args[a].args[b].weight_set)
+				n += args[a].args[b].weight_set_positions;
+		}
+		c->sets = calloc(n, sizeof(*c->sets));
+		if (!c->sets)
+			goto nomem;
+		c->num_sets = n;
+		n = 0;
+		if (crush_compile_weights(&c->sets[n++], bucket->item_weights,
+					  bucket->h.size) < 0)
+			goto nomem;
+		for (a = 0; a < num_args; a++) {
+			const struct crush_choose_arg *arg;
+
+			if ((__u32)b >= args[a].size)
+				continue;
+			arg = &args[a].args[b];
+			if (!arg->weight_set)
+				continue;
+			for (p = 0; p < arg->weight_set_positions; p++) {
+				if (crush_compile_weights(
+					    &c->sets[n++],
+					    arg->weight_set[p].weights,
+					    arg->weight_set[p].size) < 0)
+					goto nomem;
+			}
+		}
+	}
+	return 0;
+
+nomem:
+	crush_destroy_compiled(map);
+	return -ENOMEM;
+}
 
 /** rules **/
 
@@ -32,6 +32,29 @@ extern struct crush_map *crush_create();
  * @param map the crush_map
  */
 extern void crush_finalize(struct crush_map *map);
+/** @ingroup API
+ *
+ * Precompute the divisors of the straw2 draws of every bucket of
+ * __map__, for its item weights and for the weight sets of the
+ * __num_args__ choose_args maps in __args__, so that crush_do_rule()
+ * does not divide by the weight of each item it considers. The mappings
+ * are unchanged: the mapper falls back to dividing for weights that
+ * changed since, so the map may still be modified, though it should be
+ * compiled again to stay fast.
+ *
+ * Whatever was compiled before is deallocated first, and
+ * crush_destroy() deallocates the result.
+ *
+ * @param map the crush_map
+ * @param args the choose_args maps that will be passed to crush_do_rule()
+ * @param num_args the number of elements in __args__
+ *
+ * @returns 0 on success, -ENOMEM if it ran out of memory, in which
+ * case nothing is precomputed
+ */
+extern int crush_compile(struct crush_map *map,
+			 const struct crush_choose_arg_map *args,
+			 int num_args);
 
 /* rules */
 /** @ingroup API
@@ -127,10 +127,30 @@ void crush_destroy(struct crush_map *map)
 
 #ifndef __KERNEL__
 	kfree(map->choose_tries);
+	crush_destroy_compiled(map);
 #endif
 	kfree(map);
 }
 
+#ifndef __KERNEL__
+void crush_destroy_compiled(struct crush_map *map)
+{
+	__s32 b;
+	__u32 s;
+
+	if (map->compiled) {
+		for (b = 0; b < map->num_compiled; b++) {
+			for (s = 0; s < map->compiled[b].num_sets; s++)
+				kfree(map->compiled[b].sets[s].recips);
+			kfree(map->compiled[b].sets);
+		}
+		kfree(map->compiled);
+	}
+	map->compiled = NULL;
+	map->num_compiled = 0;
+}
+#endif
+
 void crush_destroy_rule(struct crush_rule *rule)
 {
 	kfree(rule);
@@ -283,6 +283,40 @@ struct crush_choose_arg_map {
   __u32 size;                    /*!< size of the __args__ array */
 };
 
+/** @ingroup API
+ *
+ * The divisor of a straw2 draw, precomputed by crush_compile() so that
+ * the mapper multiplies rather than divides. __weight__ is the 16.16
+ * fixed point weight it was computed for: the mapper ignores it if the
+ * weight changed since and __magic__ is 0 if it cannot be used at all.
+ */
+struct crush_straw2_recip {
+	__u64 magic;
+	__u32 weight;
+	__u32 shift;
+};
+
+/** @ingroup API
+ *
+ * The divisors of the __size__ weights found at __weights__, which are
+ * either the __item_weights__ of a straw2 bucket or one of the weight
+ * sets of its choose_args.
+ */
+struct crush_compiled_weights {
+	const __u32 *weights;
+	__u32 size;
+	struct crush_straw2_recip *recips;
+};
+
+/** @ingroup API
+ *
+ * Everything crush_compile() precomputed for a bucket.
+ */
+struct crush_compiled_bucket {
+	struct crush_compiled_weights *sets;
+	__u32 num_sets;
+};
+
 /** @ingroup API
  * The weight of each item in the bucket when
  * __h.alg__ == ::CRUSH_BUCKET_UNIFORM.
@@ -446,6 +480,11 @@ struct crush_map {
 	__u32 allowed_bucket_algs;
 
 	__u32 *choose_tries;
+
+	/*! Optional, precomputed by crush_compile() and indexed like
+	 * __buckets__, of size __num_compiled__. */
+	struct crush_compiled_bucket *compiled;
+	__s32 num_compiled;
 #endif
 	/*! @endcond */
 };
@@ -490,6 +529,15 @@ extern void crush_destroy_rule(struct crush_rule *r);
  * @param map the crush map
  */
 extern void crush_destroy(struct crush_map *map);
+#ifndef __KERNEL__
+/** @ingroup API
+ *
+ * Deallocate what crush_compile() precomputed for __map__.
+ *
+ * @param map the crush_map
+ */
+extern void crush_destroy_compiled(struct crush_map *map);
+#endif
 
 static inline int crush_calc_tree_node(int i)
 {
@@ -310,7 +310,8 @@ static inline __s32 *get_choose_arg_ids(const struct crush_bucket_straw2 *bucket
  * https://en.wikipedia.org/wiki/Inverse_transform_sampling#Examples
  */
 static inline __s64 generate_exponential_distribution(int type, int x, int y, int z, 
-                                                      int weight)
+                                                      int weight,
+                                                      const struct crush_straw2_recip *recip)
 {
 	unsigned int u = crush_hash32_3(type, x, y, z);
 	u &= 0xffff;
@@ -333,21 +334,52 @@ static inline __s64 generate_exponential_distribution(int type, int x, int y, in
 	 * weight means a larger (less negative) value
 	 * for draw.
 	 */
+#if !defined(__KERNEL__) && defined(__SIZEOF_INT128__)
+	if (recip && recip->magic && ln < 0)
+		return -(__s64)(((unsigned __int128)(__u64)-ln * recip->magic) >>
+				recip->shift);
+#endif
 	return div64_s64(ln, weight);
 }
 
+/*
+ * the divisors crush_compile() precomputed for these weights, if any
+ */
+static inline const struct crush_straw2_recip *get_compiled_recips(
+	const struct crush_compiled_bucket *compiled,
+	const struct crush_bucket_straw2 *bucket,
+	const __u32 *weights)
+{
+	__u32 s;
+
+	if (!compiled)
+		return NULL;
+	for (s = 0; s < compiled->num_sets; s++) {
+		if (compiled->sets[s].weights == weights &&
+		    compiled->sets[s].size >= bucket->h.size)
+			return compiled->sets[s].recips;
+	}
+	return NULL;
+}
+
 static int bucket_straw2_choose(const struct crush_bucket_straw2 *bucket,
 				int x, int r, const struct crush_choose_arg *arg,
-                                int position)
+                                int position,
+				const struct crush_compiled_bucket *compiled)
 {
 	unsigned int i, high = 0;
 	__s64 draw, high_draw = 0;
         __u32 *weights = get_choose_arg_weights(bucket, arg, position);
         __s32 *ids = get_choose_arg_ids(bucket, arg);
+	const struct crush_straw2_recip *recips =
+		get_compiled_recips(compiled, bucket, weights);
 	for (i = 0; i < bucket->h.size; i++) {
                 dprintk("weight 0x%x item %d\n", weights[i], ids[i]);
 		if (weights[i]) {
-			draw = generate_exponential_distribution(bucket->h.hash, x, ids[i], r, weights[i]);
+			draw = generate_exponential_distribution(
+				bucket->h.hash, x, ids[i], r, weights[i],
+				(recips && recips[i].weight == weights[i]) ?
+				&recips[i] : NULL);
 		} else {
 			draw = S64_MIN;
 		}
@@ -362,11 +394,22 @@ static int bucket_straw2_choose(const struct crush_bucket_straw2 *bucket,
 }
 
 
+static inline const struct crush_compiled_bucket *get_compiled_bucket(
+	const struct crush_map *map, const struct crush_bucket *in)
+{
+#ifndef __KERNEL__
+	if (map->compiled && -1-in->id < map->num_compiled)
+		return &map->compiled[-1-in->id];
+#endif
+	return NULL;
+}
+
 static int crush_bucket_choose(const struct crush_bucket *in,
 			       struct crush_work_bucket *work,
 			       int x, int r,
                                const struct crush_choose_arg *arg,
-                               int position)
+                               int position,
+			       const struct crush_compiled_bucket *compiled)
 {
 	dprintk(" crush_bucket_choose %d x=%d r=%d\n", in->id, x, r);
 	BUG_ON(in->size == 0);
@@ -388,7 +431,7 @@ static int crush_bucket_choose(const struct crush_bucket *in,
 	case CRUSH_BUCKET_STRAW2:
 		return bucket_straw2_choose(
 			(const struct crush_bucket_straw2 *)in,
-			x, r, arg, position);
+			x, r, arg, position, compiled);
 	default:
 		dprintk("unknown bucket %d alg %d\n", in->id, in->alg);
 		return in->items[0];
@@ -505,7 +548,8 @@ parent_r %d stable %d\n",
 						in, work->work[-1-in->id],
 						x, r,
                                                 (choose_args ? &choose_args[-1-in->id] : 0),
-                                                outpos);
+                                                outpos,
+						get_compiled_bucket(map, in));
 				if (item >= map->max_devices) {
 					dprintk("   bad item %d\n", item);
 					skip_rep = 1;
@@ -715,7 +759,8 @@ static void crush_choose_indep(const struct crush_map *map,
 					in, work->work[-1-in->id],
 					x, r,
                                         (choose_args ? &choose_args[-1-in->id] : 0),
-                                        outpos);
+                                        outpos,
+					get_compiled_bucket(map, in));
 				if (item >= map->max_devices) {
 					dprintk("   bad item %d\n", item);
 					out[rep] = CRUSH_ITEM_NONE;
@@ -1081,3 +1126,36 @@ int crush_do_rule(const struct crush_map *map,
 
 	return result_len;
 }
+
+/**
+ * crush_do_rule_batch - calculate the mappings of many inputs
+ * @map: the crush_map
+ * @ruleno: the rule id
+ * @x: hash inputs
+ * @n: number of inputs
+ * @result: n * result_max items, the mapping of x[i] starts at
+ *          result + i * result_max
+ * @result_len: n result sizes
+ * @result_max: maximum result size
+ * @weight: weight vector (for map leaves)
+ * @weight_max: size of weight vector
+ * @cwin: workspace initialized by crush_init_workspace
+ *
+ * Equivalent to calling crush_do_rule for each input, but the
+ * workspace only needs to be set up once for the whole batch.
+ */
+void crush_do_rule_batch(const struct crush_map *map,
+			 int ruleno, const int *x, int n,
+			 int *result, int *result_len, int result_max,
+			 const __u32 *weight, int weight_max,
+			 void *cwin, const struct crush_choose_arg *choose_args)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		result_len[i] = crush_do_rule(map, ruleno, x[i],
+					      result + i * result_max,
+					      result_max, weight, weight_max,
+					      cwin, choose_args);
+	}
+}
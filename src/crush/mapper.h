@@ -77,6 +77,24 @@ extern int crush_do_rule(const struct crush_map *map,
 			 const __u32 *weights, int weight_max,
 			 void *cwin, const struct crush_choose_arg *choose_args);
 
+/** @ingroup API
+ *
+ * Map each of the __n__ inputs __x[i]__ as crush_do_rule() would, storing
+ * the __result_len[i]__ items of the i-th mapping at
+ * __result[i * result_max]__.  The workspace is initialized once by the
+ * caller and shared by the whole batch, which saves setting up a
+ * workspace per input on maps with many buckets.
+ *
+ * @param result an array of items of size __n * result_max__
+ * @param result_len an array of size __n__
+ */
+extern void crush_do_rule_batch(const struct crush_map *map,
+				int ruleno, const int *x, int n,
+				int *result, int *result_len, int result_max,
+				const __u32 *weights, int weight_max,
+				void *cwin,
+				const struct crush_choose_arg *choose_args);
+
 /* Returns the exact amount of workspace that will need to be used
    for a given combination of crush_map and result_max. The caller can
    then allocate this much on its own, either on the stack, in a
@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <cerrno>
+#include <cstring>
 
 #include "ErasureCode.h"
 
@@ -38,6 +39,24 @@ using std::vector;
 
 using ceph::bufferlist;
 
+namespace {
+/// dst ^= src
+void xor_region(const char *src, char *dst, unsigned len)
+{
+  unsigned i = 0;
+  for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+    uint64_t a, b;
+    memcpy(&a, src + i, sizeof(a));
+    memcpy(&b, dst + i, sizeof(b));
+    b ^= a;
+    memcpy(dst + i, &b, sizeof(b));
+  }
+  for (; i < len; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+}
+
 namespace ceph {
 const unsigned ErasureCode::SIMD_ALIGN = 32;
 
@@ -345,4 +364,115 @@ int ErasureCode::decode_concat(const map<int, bufferlist> &chunks,
   }
   return r;
 }
+
+int ErasureCode::encode_delta(const bufferptr &old_data,
+                              const bufferptr &new_data,
+                              bufferptr *delta)
+{
+  ceph_assert(old_data.length() == new_data.length());
+  bufferptr d = buffer::create_aligned(new_data.length(), SIMD_ALIGN);
+  memcpy(d.c_str(), new_data.c_str(), new_data.length());
+  xor_region(old_data.c_str(), d.c_str(), old_data.length());
+  *delta = std::move(d);
+  return 0;
+}
+
+int ErasureCode::apply_delta(const map<int, bufferptr> &in,
+                             map<int, bufferptr> &out)
+{
+  // encoding is linear: the coding chunks of a stripe made of the
+  // deltas, all other data chunks being zero, are the coding deltas
+  if (in.empty() || out.empty()) {
+    return 0;
+  }
+  unsigned k = get_data_chunk_count();
+  unsigned len = in.begin()->second.length();
+  bufferptr zero = buffer::create_aligned(len, SIMD_ALIGN);
+  zero.zero();
+  map<int, bufferlist> chunks;
+  for (unsigned i = 0; i < k; i++) {
+    int c = chunk_index(i);
+    auto p = in.find(c);
+    if (p != in.end()) {
+      ceph_assert(p->second.length() == len);
+      chunks[c].push_back(p->second);
+    } else {
+      chunks[c].push_back(zero);
+    }
+  }
+  set<int> want;
+  for (unsigned i = k; i < get_chunk_count(); i++) {
+    int c = chunk_index(i);
+    chunks[c].push_back(buffer::create_aligned(len, SIMD_ALIGN));
+    want.insert(c);
+  }
+  int r = encode_chunks(want, &chunks);
+  if (r < 0) {
+    return r;
+  }
+  for (auto &[c, ptr] : out) {
+    auto p = chunks.find(c);
+    if (p == chunks.end() || !want.count(c)) {
+      return -EINVAL;
+    }
+    ceph_assert(ptr.length() == len);
+    xor_region(p->second.c_str(), ptr.c_str(), len);
+  }
+  return 0;
+}
+
+int ErasureCode::partial_decode(int want_to_read,
+                                const set<int> &helpers,
+                                const map<int, bufferlist> &chunks,
+                                bufferlist *partial)
+{
+  // decoding is linear too: decoding from the helpers, all but the
+  // given chunks being zero, yields the share of the given chunks
+  if (!supports_partial_decode()) {
+    return -EOPNOTSUPP;
+  }
+  if (chunks.empty() || helpers.count(want_to_read)) {
+    return -EINVAL;
+  }
+  unsigned len = chunks.begin()->second.length();
+  for (auto &[c, bl] : chunks) {
+    if (!helpers.count(c) || bl.length() != len) {
+      return -EINVAL;
+    }
+  }
+  bufferptr zero = buffer::create_aligned(len, SIMD_ALIGN);
+  zero.zero();
+  map<int, bufferlist> in;
+  for (int c : helpers) {
+    auto p = chunks.find(c);
+    if (p != chunks.end()) {
+      in[c] = p->second;
+    } else {
+      in[c].push_back(zero);
+    }
+  }
+  map<int, bufferlist> decoded;
+  int r = _decode({want_to_read}, in, &decoded);
+  if (r < 0) {
+    return r;
+  }
+  *partial = std::move(decoded[want_to_read]);
+  return 0;
+}
+
+int ErasureCode::combine_partial_decode(const bufferlist &in,
+                                        bufferlist *partial)
+{
+  if (in.length() != partial->length()) {
+    return -EINVAL;
+  }
+  // the buffers may be shared, e.g. with a message: xor into a copy
+  bufferptr sum = buffer::create_aligned(in.length(), SIMD_ALIGN);
+  partial->begin().copy(sum.length(), sum.c_str());
+  bufferlist src = in;
+  xor_region(src.c_str(), sum.c_str(), sum.length());
+  partial->clear();
+  partial->push_back(std::move(sum));
+  return 0;
+}
 }
@@ -113,6 +113,29 @@ namespace ceph {
     int decode_concat(const std::map<int, bufferlist> &chunks,
 			      bufferlist *decoded) override;
 
+    bool supports_parity_delta() const override {
+      return false;
+    }
+
+    int encode_delta(const bufferptr &old_data,
+                     const bufferptr &new_data,
+                     bufferptr *delta) override;
+
+    int apply_delta(const std::map<int, bufferptr> &in,
+                    std::map<int, bufferptr> &out) override;
+
+    bool supports_partial_decode() const override {
+      return supports_parity_delta();
+    }
+
+    int partial_decode(int want_to_read,
+                       const std::set<int> &helpers,
+                       const std::map<int, bufferlist> &chunks,
+                       bufferlist *partial) override;
+
+    int combine_partial_decode(const bufferlist &in,
+                               bufferlist *partial) override;
+
   protected:
     int parse(const ErasureCodeProfile &profile,
 	      std::ostream *ss);
@@ -459,6 +459,105 @@ namespace ceph {
      */
     virtual int decode_concat(const std::map<int, bufferlist> &chunks,
 			      bufferlist *decoded) = 0;
+
+    /**
+     * Return true if the coding chunks can be updated with
+     * **encode_delta** and **apply_delta** after some of the data
+     * chunks are modified, without reading the data chunks that are
+     * left unchanged. This holds for linear codes, where the content
+     * of a coding chunk at a given offset is a linear combination of
+     * the content of the data chunks at the same offset.
+     *
+     * @return true if parity delta updates are supported
+     */
+    virtual bool supports_parity_delta() const = 0;
+
+    /**
+     * Compute the delta between the previous and the new content of
+     * a data chunk, to be given to **apply_delta**. Both buffers must
+     * have the same size.
+     *
+     * @param [in] old_data previous content of the data chunk
+     * @param [in] new_data new content of the data chunk
+     * @param [out] delta allocated by the method, same size as the input
+     * @return **0** on success or a negative errno on error.
+     */
+    virtual int encode_delta(const bufferptr &old_data,
+                             const bufferptr &new_data,
+                             bufferptr *delta) = 0;
+
+    /**
+     * Update the coding chunks in **out** with the deltas of the
+     * modified data chunks found in **in**. The data chunks that are
+     * not in **in** are assumed to be unchanged. All buffers must
+     * have the same size.
+     *
+     * Assuming chunk 1 of a K=2,M=1 code is modified, it is used as
+     * follows:
+     *
+     *     encode_delta(old[1], new[1], &delta);
+     *     map<int, bufferptr> in = { {1, delta} };
+     *     map<int, bufferptr> out = { {2, old[2]} };
+     *     apply_delta(in, out);
+     *     out[2] == new[2]
+     *
+     * @param [in] in map data chunk indexes to deltas
+     * @param [in,out] out map coding chunk indexes to their previous
+     *                 content, updated in place
+     * @return **0** on success or a negative errno on error.
+     */
+    virtual int apply_delta(const std::map<int, bufferptr> &in,
+                            std::map<int, bufferptr> &out) = 0;
+
+    /**
+     * Return true if a chunk can be decoded piecewise with
+     * **partial_decode** and **combine_partial_decode**. This holds
+     * for linear codes, where the decoded chunk is a linear
+     * combination of the chunks it is decoded from: the share of each
+     * chunk can be computed where the chunk is stored and only the
+     * combined shares need to be moved around.
+     *
+     * @return true if partial decodes are supported
+     */
+    virtual bool supports_partial_decode() const = 0;
+
+    /**
+     * Compute the share of **chunks** in the content of chunk
+     * **want_to_read** when it is decoded from the chunks in
+     * **helpers**, typically the chunks returned by
+     * **minimum_to_decode**. **chunks** is a subset of **helpers**, all
+     * chunks have the same size.
+     *
+     * Combining with **combine_partial_decode** the shares of chunks
+     * that partition **helpers** gives the decoded chunk. For instance
+     * with a K=2,M=1 code and chunk 0 lost:
+     *
+     *     partial_decode(0, {1, 2}, {{1, chunk1}}, &p1);
+     *     partial_decode(0, {1, 2}, {{2, chunk2}}, &p2);
+     *     combine_partial_decode(p2, &p1);
+     *     p1 == chunk0
+     *
+     * @param [in] want_to_read the chunk to decode
+     * @param [in] helpers all the chunks it is decoded from
+     * @param [in] chunks map chunk indexes to chunk data
+     * @param [out] partial the share of **chunks**
+     * @return **0** on success or a negative errno on error.
+     */
+    virtual int partial_decode(int want_to_read,
+                               const std::set<int> &helpers,
+                               const std::map<int, bufferlist> &chunks,
+                               bufferlist *partial) = 0;
+
+    /**
+     * Add the share **in** returned by **partial_decode** to
+     * **partial**, another share of the same chunk and size.
+     *
+     * @param [in] in share to add
+     * @param [in,out] partial share updated in place
+     * @return **0** on success or a negative errno on error.
+     */
+    virtual int combine_partial_decode(const bufferlist &in,
+                                       bufferlist *partial) = 0;
   };
 
   typedef std::shared_ptr<ErasureCodeInterface> ErasureCodeInterfaceRef;
@@ -132,6 +132,49 @@ ErasureCodeIsaDefault::isa_encode(char **data,
 
 // -----------------------------------------------------------------------------
 
+int
+ErasureCodeIsaDefault::apply_delta(const map<int, bufferptr> &in,
+                                   map<int, bufferptr> &out)
+{
+  if (m == 1 || !chunk_mapping.empty())
+    // single parity stripe is a plain xor, see isa_encode
+    return ErasureCode::apply_delta(in, out);
+
+  if (in.empty() || out.empty())
+    return 0;
+  unsigned blocksize = in.begin()->second.length();
+  for (auto &[d, delta] : in) {
+    if (d < 0 || d >= k || delta.length() != blocksize)
+      return -EINVAL;
+  }
+  // ec_encode_data_update() updates all m coding chunks
+  std::vector<unsigned char*> coding(m);
+  std::vector<bufferptr> scratch;
+  for (int i = 0; i < m; i++) {
+    auto p = out.find(k + i);
+    if (p != out.end()) {
+      if (p->second.length() != blocksize)
+        return -EINVAL;
+      coding[i] = (unsigned char*) p->second.c_str();
+    } else {
+      scratch.push_back(buffer::create_aligned(blocksize, SIMD_ALIGN));
+      scratch.back().zero();
+      coding[i] = (unsigned char*) scratch.back().c_str();
+    }
+  }
+  for (auto &[c, coding_chunk] : out) {
+    if (c < k || c >= k + m)
+      return -EINVAL;
+  }
+  for (auto &[d, delta] : in) {
+    ec_encode_data_update(blocksize, k, m, d, encode_tbls,
+                          (unsigned char*) delta.c_str(), coding.data());
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+
 bool
 ErasureCodeIsaDefault::erasure_contains(int *erasures, int i)
 {
@@ -134,6 +134,14 @@ public:
                           char **coding,
                           int blocksize) override;
 
+  bool supports_parity_delta() const override
+  {
+    return true;
+  }
+
+  int apply_delta(const std::map<int, ceph::buffer::ptr> &in,
+                  std::map<int, ceph::buffer::ptr> &out) override;
+
   virtual bool erasure_contains(int *erasures, int i);
 
   int isa_decode(int *erasures,
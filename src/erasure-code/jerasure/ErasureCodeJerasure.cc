@@ -39,6 +39,7 @@ using std::map;
 using std::set;
 
 using ceph::bufferlist;
+using ceph::bufferptr;
 using ceph::ErasureCodeProfile;
 
 static ostream& _prefix(std::ostream* _dout)
@@ -137,6 +138,39 @@ int ErasureCodeJerasure::decode_chunks(const set<int> &want_to_read,
   return jerasure_decode(erasures, data, coding, blocksize);
 }
 
+int ErasureCodeJerasure::matrix_apply_delta(const int *matrix,
+					    const map<int, bufferptr> &in,
+					    map<int, bufferptr> &out)
+{
+  if (!chunk_mapping.empty() || (w != 8 && w != 16 && w != 32)) {
+    return ErasureCode::apply_delta(in, out);
+  }
+  for (auto &[d, delta] : in) {
+    if (d < 0 || d >= k)
+      return -EINVAL;
+  }
+  for (auto &[c, coding] : out) {
+    if (c < k || c >= k + m)
+      return -EINVAL;
+    for (auto &[d, delta] : in) {
+      ceph_assert(delta.length() == coding.length());
+      // coding[c] += matrix[c][d] * delta[d]
+      int multby = matrix[(c - k) * k + d];
+      char *src = const_cast<char*>(delta.c_str());
+      if (multby == 1) {
+	galois_region_xor(src, coding.c_str(), delta.length());
+      } else if (w == 8) {
+	galois_w08_region_multiply(src, multby, delta.length(), coding.c_str(), 1);
+      } else if (w == 16) {
+	galois_w16_region_multiply(src, multby, delta.length(), coding.c_str(), 1);
+      } else {
+	galois_w32_region_multiply(src, multby, delta.length(), coding.c_str(), 1);
+      }
+    }
+  }
+  return 0;
+}
+
 bool ErasureCodeJerasure::is_prime(int value)
 {
   int prime55[] = {
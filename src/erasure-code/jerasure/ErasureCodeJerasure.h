@@ -65,6 +65,10 @@ public:
 
   int init(ceph::ErasureCodeProfile &profile, std::ostream *ss) override;
 
+  bool supports_parity_delta() const override {
+    return true;
+  }
+
   virtual void jerasure_encode(char **data,
                                char **coding,
                                int blocksize) = 0;
@@ -77,6 +81,10 @@ public:
   static bool is_prime(int value);
 protected:
   virtual int parse(ceph::ErasureCodeProfile &profile, std::ostream *ss);
+  /// apply_delta() for codes defined by a w-bit coding matrix
+  int matrix_apply_delta(const int *matrix,
+			 const std::map<int, ceph::buffer::ptr> &in,
+			 std::map<int, ceph::buffer::ptr> &out);
 };
 class ErasureCodeJerasureReedSolomonVandermonde : public ErasureCodeJerasure {
 public:
@@ -102,6 +110,10 @@ public:
                                char **data,
                                char **coding,
                                int blocksize) override;
+  int apply_delta(const std::map<int, ceph::buffer::ptr> &in,
+		  std::map<int, ceph::buffer::ptr> &out) override {
+    return matrix_apply_delta(matrix, in, out);
+  }
   unsigned get_alignment() const override;
   void prepare() override;
 private:
@@ -132,6 +144,10 @@ public:
                                char **data,
                                char **coding,
                                int blocksize) override;
+  int apply_delta(const std::map<int, ceph::buffer::ptr> &in,
+		  std::map<int, ceph::buffer::ptr> &out) override {
+    return matrix_apply_delta(matrix, in, out);
+  }
   unsigned get_alignment() const override;
   void prepare() override;
 private:
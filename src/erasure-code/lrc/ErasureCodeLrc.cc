@@ -773,6 +773,17 @@ int ErasureCodeLrc::encode_chunks(const set<int> &want_to_encode,
   return 0;
 }
 
+bool ErasureCodeLrc::supports_partial_decode() const
+{
+  if (layers.empty())
+    return false;
+  for (const auto &layer : layers) {
+    if (!layer.erasure_code->supports_partial_decode())
+      return false;
+  }
+  return true;
+}
+
 int ErasureCodeLrc::decode_chunks(const set<int> &want_to_read,
 				  const map<int, bufferlist> &chunks,
 				  map<int, bufferlist> *decoded)
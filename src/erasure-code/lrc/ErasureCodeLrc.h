@@ -114,6 +114,10 @@ public:
 
   int init(ceph::ErasureCodeProfile &profile, std::ostream *ss) override;
 
+  /// decoding goes through layers chosen from the available chunks only,
+  /// so it is linear as long as the code of every layer is
+  bool supports_partial_decode() const override;
+
   virtual int parse(ceph::ErasureCodeProfile &profile, std::ostream *ss);
 
   int parse_kml(ceph::ErasureCodeProfile &profile, std::ostream *ss);
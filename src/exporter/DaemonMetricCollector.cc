@@ -1,13 +1,16 @@
 #include "DaemonMetricCollector.h"
 
 #include <boost/json/src.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <chrono>
 #include <filesystem>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <regex>
+#include <set>
 #include <string>
+#include <tuple>
 #include <utility>
 
 #include "common/admin_socket_client.h"
@@ -55,15 +58,15 @@ std::string DaemonMetricCollector::get_metrics() {
 
 template <class T>
 void add_metric(std::unique_ptr<MetricsBuilder> &builder, T value,
-                std::string name, std::string description, std::string mtype,
-                labels_t labels) {
+                const std::string &name, const std::string &description,
+                const std::string &mtype, const labels_t &labels) {
   builder->add(std::to_string(value), name, description, mtype, labels);
 }
 
 void add_double_or_int_metric(std::unique_ptr<MetricsBuilder> &builder,
-                              json_value value, std::string name,
-                              std::string description, std::string mtype,
-                              labels_t labels) {
+                              const json_value &value, const std::string &name,
+                              const std::string &description,
+                              const std::string &mtype, const labels_t &labels) {
   if (value.is_int64()) {
     int64_t v = value.as_int64();
     add_metric(builder, v, name, description, mtype, labels);
@@ -95,84 +98,52 @@ void DaemonMetricCollector::dump_asok_metrics() {
         std::unique_ptr<UnorderedMetricsBuilder>(new UnorderedMetricsBuilder());
   }
   auto prio_limit = g_conf().get_val<int64_t>("exporter_prio_limit");
-  for (auto &[daemon_name, sock_client] : clients) {
-    bool ok;
-    sock_client.ping(&ok);
-    if (!ok) {
-      failures++;
-      continue;
-    }
-    std::string counter_dump_response =
-      asok_request(sock_client, "counter dump", daemon_name);
-    if (counter_dump_response.size() == 0) {
-        failures++;
-        continue;
+  if (delta_client.empty()) {
+    delta_client = "ceph-exporter." + ceph_get_hostname() + "." +
+                   std::to_string(getpid());
+  }
+  // forget daemons that went away, and make room for new ones up front so
+  // that the workers below only touch their own entry
+  for (auto i = counters.begin(); i != counters.end(); ) {
+    if (clients.count(i->first)) {
+      ++i;
+    } else {
+      i = counters.erase(i);
     }
-    std::string counter_schema_response =
-        asok_request(sock_client, "counter schema", daemon_name);
-    if (counter_schema_response.size() == 0) {
-      failures++;
-      continue;
+  }
+  std::vector<std::tuple<const std::string *, AdminSocketClient *,
+                         daemon_counters *>> daemons;
+  for (auto &[daemon_name, sock_client] : clients) {
+    daemons.emplace_back(&daemon_name, &sock_client, &counters[daemon_name]);
+  }
+
+  // the time goes into waiting for and parsing the daemons' replies, so
+  // talk to several of them at once
+  std::vector<scrape_result> results(daemons.size());
+  {
+    auto nr_threads = g_conf().get_val<uint64_t>("exporter_scrape_threads");
+    boost::asio::thread_pool pool(
+        std::min<size_t>(nr_threads, std::max<size_t>(daemons.size(), 1)));
+    for (size_t i = 0; i < daemons.size(); ++i) {
+      boost::asio::post(pool, [this, &daemons, &results, i] {
+        auto [daemon_name, sock_client, c] = daemons[i];
+        results[i] = scrape_daemon(*sock_client, *daemon_name, *c);
+      });
     }
+    pool.join();
+  }
 
-    json_object counter_dump = boost::json::parse(counter_dump_response).as_object();
-    json_object counter_schema = boost::json::parse(counter_schema_response).as_object();
-
-    for (auto &perf_group_item : counter_schema) {
-      std::string perf_group = {perf_group_item.key().begin(),
-                                perf_group_item.key().end()};
-      json_object perf_group_object = perf_group_item.value().as_object();
-      auto counters = perf_group_object["counters"].as_object();
-      auto counters_labels = perf_group_object["labels"].as_object();
-      auto counters_values =
-          counter_dump[perf_group].as_object()["counters"].as_object();
-      labels_t labels;
-
-      for(auto &label: counters_labels) {
-        std::string label_key = {label.key().begin(), label.key().end()};
-        labels[label_key] = quote(label.value().as_string().c_str());
-      }
-      for (auto &counter : counters) {
-        json_object counter_group = counter.value().as_object();
-        if (counter_group["priority"].as_int64() < prio_limit) {
-          continue;        
-        }
-        std::string counter_name_init =  {counter.key().begin(), counter.key().end()};
-        std::string counter_name = perf_group + "_" + counter_name_init;
-        promethize(counter_name);
-
-        if (counters_labels.empty()) {
-          auto labels_and_name = get_labels_and_metric_name(daemon_name, counter_name);
-          labels = labels_and_name.first;
-          counter_name = labels_and_name.second;
-        }
-        // For now this is only required for rgw multi-site metrics
-        auto multisite_labels_and_name = add_fixed_name_metrics(counter_name);
-        if (!multisite_labels_and_name.first.empty()) {
-          labels.insert(multisite_labels_and_name.first.begin(), multisite_labels_and_name.first.end());
-          counter_name = multisite_labels_and_name.second;
-        }
-        labels.insert({"ceph_daemon", quote(daemon_name)});
-        auto perf_values = counters_values.at(counter_name_init);
-        dump_asok_metric(counter_group, perf_values, counter_name, labels);
-      }
+  for (size_t i = 0; i < daemons.size(); ++i) {
+    auto [daemon_name, sock_client, c] = daemons[i];
+    if (results[i].counters) {
+      dump_daemon_counters(*daemon_name, *c, prio_limit);
     }
-    std::string config_show =
-        asok_request(sock_client, "config show", daemon_name);
-    if (config_show.size() == 0) {
+    if (!results[i].ok) {
       failures++;
       continue;
     }
-    json_object pid_file_json = boost::json::parse(config_show).as_object();
-    std::string pid_path =
-        boost_string_to_std(pid_file_json["pid_file"].as_string());
-    std::string pid_str = read_file_to_string(pid_path);
-    if (!pid_path.size()) {
-      dout(1) << "pid path is empty; process metrics won't be fetched for: "
-              << daemon_name << dendl;
-    }
-    if (!pid_str.empty()) {
-      daemon_pids.push_back({daemon_name, std::stoi(pid_str)});
+    if (results[i].pid >= 0) {
+      daemon_pids.push_back({*daemon_name, results[i].pid});
     }
   }
   dout(10) << "Perf counters retrieved for " << clients.size() - failures << "/"
@@ -195,6 +166,90 @@ void DaemonMetricCollector::dump_asok_metrics() {
   metrics = builder->dump();
 }
 
+/*
+ Fetch the counters and the pid of one daemon.  Runs concurrently for
+ different daemons, so it must not touch anything but @c.
+ */
+DaemonMetricCollector::scrape_result
+DaemonMetricCollector::scrape_daemon(AdminSocketClient &asok,
+                                     const std::string &daemon_name,
+                                     daemon_counters &c) {
+  scrape_result result;
+  bool ok;
+  asok.ping(&ok);
+  if (!ok) {
+    return result;
+  }
+  if (!update_counters(asok, daemon_name, c)) {
+    return result;
+  }
+  result.counters = true;
+  std::string config_show = asok_request(asok, "config show", daemon_name);
+  if (config_show.size() == 0) {
+    return result;
+  }
+  result.ok = true;
+  json_object pid_file_json = boost::json::parse(config_show).as_object();
+  std::string pid_path =
+      boost_string_to_std(pid_file_json["pid_file"].as_string());
+  std::string pid_str = read_file_to_string(pid_path);
+  if (!pid_path.size()) {
+    dout(1) << "pid path is empty; process metrics won't be fetched for: "
+            << daemon_name << dendl;
+  }
+  if (!pid_str.empty()) {
+    result.pid = std::stoi(pid_str);
+  }
+  return result;
+}
+
+void DaemonMetricCollector::dump_daemon_counters(const std::string &daemon_name,
+                                                 daemon_counters &c,
+                                                 int64_t prio_limit) {
+  json_object &counter_dump = c.values;
+  json_object &counter_schema = c.schema;
+
+  for (auto &perf_group_item : counter_schema) {
+    std::string perf_group = {perf_group_item.key().begin(),
+                              perf_group_item.key().end()};
+    json_object &perf_group_object = perf_group_item.value().as_object();
+    auto &counters = perf_group_object["counters"].as_object();
+    auto &counters_labels = perf_group_object["labels"].as_object();
+    auto &counters_values =
+        counter_dump[perf_group].as_object()["counters"].as_object();
+    labels_t labels;
+
+    for(auto &label: counters_labels) {
+      std::string label_key = {label.key().begin(), label.key().end()};
+      labels[label_key] = quote(label.value().as_string().c_str());
+    }
+    for (auto &counter : counters) {
+      json_object &counter_group = counter.value().as_object();
+      if (counter_group["priority"].as_int64() < prio_limit) {
+        continue;
+      }
+      std::string counter_name_init =  {counter.key().begin(), counter.key().end()};
+      std::string counter_name = perf_group + "_" + counter_name_init;
+      promethize(counter_name);
+
+      if (counters_labels.empty()) {
+        auto labels_and_name = get_labels_and_metric_name(daemon_name, counter_name);
+        labels = labels_and_name.first;
+        counter_name = labels_and_name.second;
+      }
+      // For now this is only required for rgw multi-site metrics
+      auto multisite_labels_and_name = add_fixed_name_metrics(counter_name);
+      if (!multisite_labels_and_name.first.empty()) {
+        labels.insert(multisite_labels_and_name.first.begin(), multisite_labels_and_name.first.end());
+        counter_name = multisite_labels_and_name.second;
+      }
+      labels.insert({"ceph_daemon", quote(daemon_name)});
+      auto &perf_values = counters_values.at(counter_name_init);
+      dump_asok_metric(counter_group, perf_values, counter_name, labels);
+    }
+  }
+}
+
 std::vector<std::string> read_proc_stat_file(std::string path) {
   std::string stat = read_file_to_string(path);
   std::vector<std::string> strings;
@@ -265,10 +320,75 @@ void DaemonMetricCollector::get_process_metrics(
   }
 }
 
+/*
+ Bring counters[daemon_name] up to date.  Values are fetched as a delta
+ against the previous scrape; the schema only when the daemon's set of
+ counters changed.  Daemons without "counter dump delta" are sent the
+ full "counter dump" and "counter schema" requests every time.
+ */
+bool DaemonMetricCollector::update_counters(AdminSocketClient &asok,
+                                            const std::string &daemon_name,
+                                            daemon_counters &c) {
+  bool full = true;
+  json_object dump;
+  if (!c.delta_unsupported) {
+    std::string args = ", \"client\": \"" + delta_client + "\"";
+    if (c.schema.empty()) {
+      args += ", \"full\": true";
+    }
+    std::string response =
+        asok_request(asok, "counter dump delta", daemon_name, args);
+    if (response.size() == 0) {
+      c.delta_unsupported = true;
+    } else {
+      json_object delta = boost::json::parse(response).as_object();
+      full = delta["full"].as_bool();
+      dump = std::move(delta["counters"].as_object());
+    }
+  }
+  if (c.delta_unsupported) {
+    std::string response = asok_request(asok, "counter dump", daemon_name);
+    if (response.size() == 0) {
+      c = daemon_counters();
+      return false;
+    }
+    dump = boost::json::parse(response).as_object();
+  }
+  if (full) {
+    std::string response = asok_request(asok, "counter schema", daemon_name);
+    if (response.size() == 0) {
+      c = daemon_counters();
+      return false;
+    }
+    c.schema = boost::json::parse(response).as_object();
+    c.values = std::move(dump);
+    return true;
+  }
+  for (auto &group : dump) {
+    auto &cached = c.values[group.key()];
+    if (!cached.is_object()) {
+      cached = std::move(group.value());
+      continue;
+    }
+    auto &changed = group.value().as_object();
+    // instances of a labeled counter share their name, and like the full
+    // dump we only keep one of them
+    if (cached.as_object()["labels"] != changed["labels"]) {
+      continue;
+    }
+    auto &cached_counters = cached.as_object()["counters"].as_object();
+    for (auto &counter : changed["counters"].as_object()) {
+      cached_counters[counter.key()] = std::move(counter.value());
+    }
+  }
+  return true;
+}
+
 std::string DaemonMetricCollector::asok_request(AdminSocketClient &asok,
                                                 std::string command,
-                                                std::string daemon_name) {
-  std::string request("{\"prefix\": \"" + command + "\"}");
+                                                std::string daemon_name,
+                                                std::string args) {
+  std::string request("{\"prefix\": \"" + command + "\"" + args + "}");
   std::string response;
   std::string err = asok.do_request(request, &response);
   if (err.length() > 0 || response.substr(0, 5) == "ERROR") {
@@ -336,10 +456,10 @@ DaemonMetricCollector::add_fixed_name_metrics(std::string metric_name) {
 perf_values can be either a int/double or a json_object. Since
    json_value is a wrapper of both we use that class.
  */
-void DaemonMetricCollector::dump_asok_metric(json_object perf_info,
-                                             json_value perf_values,
-                                             std::string name,
-                                             labels_t labels) {
+void DaemonMetricCollector::dump_asok_metric(json_object &perf_info,
+                                             json_value &perf_values,
+                                             const std::string &name,
+                                             const labels_t &labels) {
   int64_t type = perf_info["type"].as_int64();
   std::string metric_type =
       boost_string_to_std(perf_info["metric_type"].as_string());
@@ -350,7 +470,7 @@ void DaemonMetricCollector::dump_asok_metric(json_object perf_info,
     int64_t count = perf_values.as_object()["avgcount"].as_int64();
     add_metric(builder, count, name + "_count", description, metric_type,
                labels);
-    json_value sum_value = perf_values.as_object()["sum"];
+    json_value &sum_value = perf_values.as_object()["sum"];
     add_double_or_int_metric(builder, sum_value, name + "_sum", description,
                              metric_type, labels);
   } else if (type & PERFCOUNTER_TIME) {
@@ -369,36 +489,48 @@ void DaemonMetricCollector::dump_asok_metric(json_object perf_info,
 
 void DaemonMetricCollector::update_sockets() {
   std::string sock_dir = g_conf().get_val<std::string>("exporter_sock_dir");
-  clients.clear();
   std::filesystem::path sock_path = sock_dir;
   if (!std::filesystem::is_directory(sock_path.parent_path())) {
     dout(1) << "ERROR: No such directory exist" << sock_dir << dendl;
+    clients.clear();
     return;
   }
+  // keep the clients of daemons that are still around
+  std::set<std::string> found;
   for (const auto &entry : std::filesystem::directory_iterator(sock_dir)) {
     if (entry.path().extension() == ".asok") {
       std::string daemon_socket_name = entry.path().filename().string();
       std::string daemon_name =
           daemon_socket_name.substr(0, daemon_socket_name.size() - 5);
-      if (clients.find(daemon_name) == clients.end() &&
-          !(daemon_name.find("mgr") != std::string::npos) &&
+      if (!(daemon_name.find("mgr") != std::string::npos) &&
           !(daemon_name.find("ceph-exporter") != std::string::npos)) {
-        AdminSocketClient sock(entry.path().string());
-        clients.insert({daemon_name, std::move(sock)});
+        found.insert(daemon_name);
+        if (clients.find(daemon_name) == clients.end()) {
+          AdminSocketClient sock(entry.path().string());
+          clients.insert({daemon_name, std::move(sock)});
+        }
       }
     }
   }
+  for (auto i = clients.begin(); i != clients.end(); ) {
+    if (found.count(i->first)) {
+      ++i;
+    } else {
+      i = clients.erase(i);
+    }
+  }
 }
 
-void OrderedMetricsBuilder::add(std::string value, std::string name,
-                                std::string description, std::string mtype,
-                                labels_t labels) {
-  if (metrics.find(name) == metrics.end()) {
-    Metric metric(name, mtype, description);
-    metrics[name] = std::move(metric);
+void OrderedMetricsBuilder::add(const std::string &value,
+                                const std::string &name,
+                                const std::string &description,
+                                const std::string &mtype,
+                                const labels_t &labels) {
+  auto it = metrics.find(name);
+  if (it == metrics.end()) {
+    it = metrics.emplace(name, Metric(name, mtype, description)).first;
   }
-  Metric &metric = metrics[name];
-  metric.add(labels, value);
+  it->second.add(labels, value);
 }
 
 std::string OrderedMetricsBuilder::dump() {
@@ -408,9 +540,11 @@ std::string OrderedMetricsBuilder::dump() {
   return out;
 }
 
-void UnorderedMetricsBuilder::add(std::string value, std::string name,
-                                  std::string description, std::string mtype,
-                                  labels_t labels) {
+void UnorderedMetricsBuilder::add(const std::string &value,
+                                  const std::string &name,
+                                  const std::string &description,
+                                  const std::string &mtype,
+                                  const labels_t &labels) {
   Metric metric(name, mtype, description);
   metric.add(labels, value);
   out += metric.dump() + "\n\n";
@@ -418,33 +552,36 @@ void UnorderedMetricsBuilder::add(std::string value, std::string name,
 
 std::string UnorderedMetricsBuilder::dump() { return out; }
 
-void Metric::add(labels_t labels, std::string value) {
-  metric_entry entry;
-  entry.labels = labels;
+void Metric::add(const labels_t &labels, const std::string &value) {
+  metric_entry &entry = entries.emplace_back();
+  for (auto &[label_name, label_value] : labels) {
+    if (!entry.labels.empty()) {
+      entry.labels += ',';
+    }
+    entry.labels += label_name;
+    entry.labels += '=';
+    entry.labels += label_value;
+  }
   entry.value = value;
-  entries.push_back(entry);
 }
 
 std::string Metric::dump() {
-  std::stringstream metric_ss;
-  metric_ss << "# HELP " << name << " " << description << "\n";
-  metric_ss << "# TYPE " << name << " " << mtype << "\n";
+  std::string out;
+  out.reserve(name.size() * 2 + description.size() + mtype.size() + 16 +
+              entries.size() * (name.size() + 64));
+  out += "# HELP " + name + " " + description + "\n";
+  out += "# TYPE " + name + " " + mtype + "\n";
   for (auto &entry : entries) {
-    std::stringstream labels_ss;
-    size_t i = 0;
-    for (auto &[label_name, label_value] : entry.labels) {
-      labels_ss << label_name << "=" << label_value;
-      if (i < entry.labels.size() - 1) {
-        labels_ss << ",";
-      }
-      i++;
-    }
-    metric_ss << name << "{" << labels_ss.str() << "} " << entry.value;
+    out += name;
+    out += '{';
+    out += entry.labels;
+    out += "} ";
+    out += entry.value;
     if (&entry != &entries.back()) {
-      metric_ss << "\n";
+      out += '\n';
     }
   }
-  return metric_ss.str();
+  return out;
 }
 
 DaemonMetricCollector &collector_instance() {
@@ -40,24 +40,47 @@ private:
   std::string metrics;
   std::mutex metrics_mutex;
   std::unique_ptr<MetricsBuilder> builder;
+  /// last counter schema and values of each daemon, kept up to date
+  /// with "counter dump delta"
+  struct daemon_counters {
+    boost::json::object schema;
+    boost::json::object values;
+    bool delta_unsupported = false;
+  };
+  std::map<std::string, daemon_counters> counters;
+  std::string delta_client;
+  /// outcome of scraping the admin socket of one daemon
+  struct scrape_result {
+    bool counters = false; ///< the daemon's counters are up to date
+    bool ok = false;
+    int pid = -1;
+  };
   void update_sockets();
   void request_loop(boost::asio::steady_timer &timer);
 
   void dump_asok_metrics();
-  void dump_asok_metric(boost::json::object perf_info,
-                        boost::json::value perf_values, std::string name,
-                        labels_t labels);
+  scrape_result scrape_daemon(AdminSocketClient &asok,
+                              const std::string &daemon_name,
+                              daemon_counters &c);
+  void dump_daemon_counters(const std::string &daemon_name, daemon_counters &c,
+                            int64_t prio_limit);
+  void dump_asok_metric(boost::json::object &perf_info,
+                        boost::json::value &perf_values,
+                        const std::string &name, const labels_t &labels);
   std::pair<labels_t, std::string>
   get_labels_and_metric_name(std::string daemon_name, std::string metric_name);
   std::pair<labels_t, std::string> add_fixed_name_metrics(std::string metric_name);
   void get_process_metrics(std::vector<std::pair<std::string, int>> daemon_pids);
-  std::string asok_request(AdminSocketClient &asok, std::string command, std::string daemon_name);
+  bool update_counters(AdminSocketClient &asok, const std::string &daemon_name,
+                       daemon_counters &c);
+  std::string asok_request(AdminSocketClient &asok, std::string command,
+                           std::string daemon_name, std::string args = "");
 };
 
 class Metric {
 private:
   struct metric_entry {
-    labels_t labels;
+    std::string labels; ///< rendered as name="value",...
     std::string value;
   };
   std::string name;
@@ -70,7 +93,7 @@ public:
       : name(name), mtype(mtype), description(description) {}
   Metric(const Metric &) = default;
   Metric() = default;
-  void add(labels_t labels, std::string value);
+  void add(const labels_t &labels, const std::string &value);
   std::string dump();
 };
 
@@ -78,8 +101,9 @@ class MetricsBuilder {
 public:
   virtual ~MetricsBuilder() = default;
   virtual std::string dump() = 0;
-  virtual void add(std::string value, std::string name, std::string description,
-                   std::string mtype, labels_t labels) = 0;
+  virtual void add(const std::string &value, const std::string &name,
+                   const std::string &description, const std::string &mtype,
+                   const labels_t &labels) = 0;
 
 protected:
   std::string out;
@@ -91,15 +115,17 @@ private:
 
 public:
   std::string dump();
-  void add(std::string value, std::string name, std::string description,
-           std::string mtype, labels_t labels);
+  void add(const std::string &value, const std::string &name,
+           const std::string &description, const std::string &mtype,
+           const labels_t &labels);
 };
 
 class UnorderedMetricsBuilder : public MetricsBuilder {
 public:
   std::string dump();
-  void add(std::string value, std::string name, std::string description,
-           std::string mtype, labels_t labels);
+  void add(const std::string &value, const std::string &name,
+           const std::string &description, const std::string &mtype,
+           const labels_t &labels);
 };
 
 DaemonMetricCollector &collector_instance();
@@ -256,6 +256,9 @@
 /* nasm can also build the isa-l:avx512 */
 #cmakedefine HAVE_NASM_X64_AVX512
 
+/* nasm can also build the isa-l:avx512 gfni kernels */
+#cmakedefine HAVE_NASM_X64_GFNI
+
 /* Define if the erasure code isa-l plugin is compiled */
 #cmakedefine WITH_EC_ISA_PLUGIN
 
@@ -369,6 +372,9 @@
 /* Defined if Intel QAT compress/decompress is supported */
 #cmakedefine HAVE_QATZIP
 
+/* Defined if Intel IAA compress offload through QPL is supported */
+#cmakedefine HAVE_QPL
+
 /* Define if seastar is available. */
 #cmakedefine HAVE_SEASTAR
 
@@ -15,6 +15,7 @@
 #ifndef _CEPH_INCLUDE_MEMPOOL_H
 #define _CEPH_INCLUDE_MEMPOOL_H
 
+#include <atomic>
 #include <cstddef>
 #include <map>
 #include <unordered_map>
@@ -28,6 +29,7 @@
 
 #include "common/Formatter.h"
 #include "common/ceph_atomic.h"
+#include "common/likely.h"
 #include "include/ceph_assert.h"
 #include "include/compact_map.h"
 #include "include/compact_set.h"
@@ -125,15 +127,28 @@ The simplest way to interrogate the process is with
   mempool::dump(f);
 
 This will dump information about *all* memory pools.  When debug mode
-is enabled, the runtime complexity of dump is O(num_shards *
-num_types).  When debug name is disabled it is O(num_shards).
+is enabled, the runtime complexity of dump is O(num_threads *
+num_types).  When debug name is disabled it is O(num_threads).
 
 You can also interrogate a specific pool programmatically with
 
   size_t bytes = mempool::unittest_2::allocated_bytes();
   size_t items = mempool::unittest_2::allocated_items();
 
-The runtime complexity is O(num_shards).
+The runtime complexity is O(num_threads).
+
+Every thread counts its own allocations for each pool, in counters
+that only it writes, so that allocating does neither a locked
+read-modify-write nor touch a cache line other threads write to.  The
+queries above add up the counters of all threads.
+
+Sampling
+--------
+
+With set_sample_rate(N), one in N allocations from each pool, per
+thread, records the call stack it was made from.  dump() then lists
+the call stacks that allocated the most bytes from the pool.  These are
+allocation volumes, not live memory: frees are not attributed.
 
 Note that you cannot easily query per-type, primarily because debug
 mode is optional and you should not rely on that information being
@@ -189,6 +204,10 @@ enum pool_index_t {
 extern bool debug_mode;
 extern void set_debug_mode(bool d);
 
+/// 0 to disable allocation sampling
+extern std::atomic<unsigned> sample_rate;
+extern void set_sample_rate(unsigned n);
+
 // --------------------------------------------------------------
 class pool_t;
 
@@ -219,6 +238,40 @@ struct shard_t {
 
 static_assert(sizeof(shard_t) == 128, "shard_t should be cacheline-sized");
 
+// A thread's own counts for every pool.  Only the owning thread writes
+// them, with plain loads and stores; they are atomic only so that
+// other threads may read them.
+struct thread_counters_t {
+  struct counter_t {
+    std::atomic<ssize_t> items = {0};
+    std::atomic<ssize_t> bytes = {0};
+    unsigned since_sample = 0;
+  };
+  counter_t pool[num_pools];
+
+  void add(pool_index_t ix, ssize_t items, ssize_t bytes) {
+    auto& c = pool[ix];
+    c.items.store(c.items.load(std::memory_order_relaxed) + items,
+		  std::memory_order_relaxed);
+    c.bytes.store(c.bytes.load(std::memory_order_relaxed) + bytes,
+		  std::memory_order_relaxed);
+  }
+};
+
+extern thread_local thread_counters_t *thread_counters;
+
+/// count on the shared shards, set up this thread's counters, or sample
+void account_slow(pool_index_t ix, ssize_t items, ssize_t bytes);
+
+inline void account(pool_index_t ix, ssize_t items, ssize_t bytes) {
+  thread_counters_t *c = thread_counters;
+  if (likely(c != nullptr) && likely(sample_rate.load(std::memory_order_relaxed) == 0)) {
+    c->add(ix, items, bytes);
+  } else {
+    account_slow(ix, items, bytes);
+  }
+}
+
 struct stats_t {
   ssize_t items = 0;
   ssize_t bytes = 0;
@@ -250,19 +303,42 @@ struct type_info_hash {
 };
 
 class pool_t {
+  /// counts of exited threads, and of threads while they exit
   shard_t shard[num_shards];
 
   mutable std::mutex lock;  // only used for types list
   std::unordered_map<const char *, type_t> type_map;
 
+  /// allocations made from one call stack, see set_sample_rate()
+  struct sample_t {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+    std::vector<void*> frames;
+  };
+  mutable std::mutex sample_lock;
+  std::unordered_map<size_t, sample_t> samples;  ///< by call stack hash
+
+  pool_index_t get_index() const;
+
 public:
   //
-  // How much this pool consumes. O(<num_shards>)
+  // How much this pool consumes. O(<num_threads>)
   //
   size_t allocated_bytes() const;
   size_t allocated_items() const;
 
-  void adjust_count(ssize_t items, ssize_t bytes);
+  void adjust_count(ssize_t items, ssize_t bytes) {
+    account(get_index(), items, bytes);
+  }
+  void add_to_shard(ssize_t items, ssize_t bytes) {
+    shard_t *s = pick_a_shard();
+    s->items += items;
+    s->bytes += bytes;
+  }
+
+  /// record the current call stack as having allocated @bytes
+  void sample(size_t bytes);
+  void clear_samples();
 
   static size_t pick_a_shard_int() {
     // Dirt cheap, see:
@@ -339,9 +415,7 @@ public:
 
   T* allocate(size_t n, void *p = nullptr) {
     size_t total = sizeof(T) * n;
-    shard_t *shard = pool->pick_a_shard();
-    shard->bytes += total;
-    shard->items += n;
+    account(pool_ix, n, total);
     if (type) {
       type->items += n;
     }
@@ -351,9 +425,7 @@ public:
 
   void deallocate(T* p, size_t n) {
     size_t total = sizeof(T) * n;
-    shard_t *shard = pool->pick_a_shard();
-    shard->bytes -= total;
-    shard->items -= n;
+    account(pool_ix, -(ssize_t)n, -(ssize_t)total);
     if (type) {
       type->items -= n;
     }
@@ -362,9 +434,7 @@ public:
 
   T* allocate_aligned(size_t n, size_t align, void *p = nullptr) {
     size_t total = sizeof(T) * n;
-    shard_t *shard = pool->pick_a_shard();
-    shard->bytes += total;
-    shard->items += n;
+    account(pool_ix, n, total);
     if (type) {
       type->items += n;
     }
@@ -378,9 +448,7 @@ public:
 
   void deallocate_aligned(T* p, size_t n) {
     size_t total = sizeof(T) * n;
-    shard_t *shard = pool->pick_a_shard();
-    shard->bytes -= total;
-    shard->items -= n;
+    account(pool_ix, -(ssize_t)n, -(ssize_t)total);
     if (type) {
       type->items -= n;
     }
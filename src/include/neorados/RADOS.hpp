@@ -23,6 +23,7 @@
 #include <string_view>
 #include <type_traits>
 #include <variant>
+#include <vector>
 
 #include <boost/asio.hpp>
 
@@ -604,6 +605,30 @@ public:
     return init.result.get();
   }
 
+  /// One operation of a batch; the data of a ReadOp goes to bl.
+  struct BatchOp {
+    Object oid;
+    std::variant<ReadOp, WriteOp> op;
+    ceph::buffer::list* bl = nullptr;
+  };
+  /// The first error in the batch, if any, and the result of each op
+  using BatchSig = void(boost::system::error_code,
+			std::vector<boost::system::error_code>);
+  using BatchComp = ceph::async::Completion<BatchSig>;
+  /// Execute operations on many objects of one IOContext with a single
+  /// completion.  At most max_in_flight of them are outstanding at a
+  /// time, the next being sent as each completes.
+  template<typename CompletionToken>
+  auto execute_batch(const IOContext& ioc, std::vector<BatchOp>&& ops,
+		     CompletionToken&& token,
+		     std::size_t max_in_flight = 64) {
+    boost::asio::async_completion<CompletionToken, BatchSig> init(token);
+    execute_batch(ioc, std::move(ops), max_in_flight,
+		  BatchComp::create(get_executor(),
+				    std::move(init.completion_handler)));
+    return init.result.get();
+  }
+
   boost::uuids::uuid get_fsid() const noexcept;
 
   using LookupPoolSig = void(boost::system::error_code,
@@ -995,6 +1020,10 @@ private:
 	       std::optional<std::string_view> key,
 	       uint64_t* objver);
 
+  struct BatchState;
+  void execute_batch(const IOContext& ioc, std::vector<BatchOp>&& ops,
+		     std::size_t max_in_flight, std::unique_ptr<BatchComp> c);
+
   void lookup_pool(std::string_view name, std::unique_ptr<LookupPoolComp> c);
   void list_pools(std::unique_ptr<LSPoolsComp> c);
   void create_pool_snap(int64_t pool, std::string_view snapName,
@@ -189,6 +189,19 @@ public:
 		  ceph::buffer::list *value) {
     return get(prefix, std::string(key, keylen), value);
   }
+  /// Retrieve several keys in one go; backends may batch the lookups
+  virtual int get(const std::string &prefix,     ///< [in] prefix or CF name
+		  const std::vector<std::string> &keys, ///< [in] keys
+		  std::vector<ceph::buffer::list> *values, ///< [out] value of keys[i]
+		  std::vector<int> *rs) {        ///< [out] 0 or -ENOENT for keys[i]
+    values->resize(keys.size());
+    rs->resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      (*values)[i].clear();
+      (*rs)[i] = get(prefix, keys[i], &(*values)[i]);
+    }
+    return 0;
+  }
 
   // This superclass is used both by kv iterators *and* by the ObjectMap
   // omap iterator.  The class hierarchies are unfortunately tied together
@@ -384,6 +397,10 @@ public:
 
   /// compact the underlying store
   virtual void compact() {}
+  /// compact the underlying store, using up to @threads threads
+  virtual void compact_parallel(unsigned threads) {
+    compact();
+  }
 
   /// compact the underlying store in async mode
   virtual void compact_async() {}
@@ -426,6 +443,16 @@ public:
     return;
   }
 
+  /**
+   * Verify the checksums of all data files of the store, reading up to
+   * @threads of them at once, and report damaged ones to @out.
+   *
+   * @returns the number of damaged files, or a negative error code
+   */
+  virtual int verify_checksums(unsigned threads, std::ostream &out) {
+    return -EOPNOTSUPP;
+  }
+
   /**
    * Return your perf counters if you have any.  Subclasses are not
    * required to implement this, and callers must respect a null return
@@ -1,11 +1,13 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 // vim: ts=8 sw=2 smarttab
 
+#include <algorithm>
 #include <filesystem>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <errno.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -23,6 +25,7 @@
 
 #include "common/perf_counters.h"
 #include "common/PriorityCache.h"
+#include "common/Thread.h"
 #include "include/common_fwd.h"
 #include "include/scope_guard.h"
 #include "include/str_list.h"
@@ -613,6 +616,7 @@ void RocksDBStore::add_column_family(const std::string& cf_name, uint32_t hash_l
     column.hash_l = hash_l;
     column.hash_h = hash_h;
   }
+  column.wal = !no_wal_columns.count(cf_name);
   if (column.handles.size() <= shard_idx)
     column.handles.resize(shard_idx + 1);
   column.handles[shard_idx] = handle;
@@ -916,6 +920,21 @@ int RocksDBStore::update_column_family_options(const std::string& base_name,
 	    << " options=" << more_options << dendl;
     return r;
   }
+  // ceph addition "wal=false" makes writes to this column skip the WAL
+  if (auto it = options_map.find("wal"); it != options_map.end()) {
+    bool wal = true;
+    if (string2bool(it->second, wal) != 0) {
+      dout(5) << __func__ << " invalid wal option; column family=" << base_name
+	      << " options=" << more_options << dendl;
+      return -EINVAL;
+    }
+    if (wal) {
+      no_wal_columns.erase(base_name);
+    } else {
+      no_wal_columns.insert(base_name);
+    }
+    options_map.erase(it);
+  }
   status = rocksdb::GetColumnFamilyOptionsFromMap(*cf_opt, options_map, cf_opt);
   if (!status.ok()) {
     dout(5) << __func__ << " invalid column family optionsp; column family="
@@ -1302,6 +1321,8 @@ void RocksDBStore::close()
     logger = nullptr;
   }
 
+  flush_no_wal_columns();
+
   // Ensure db is destroyed before dependent db_cache and filterpolicy
   for (auto& p : cf_handles) {
     for (size_t i = 0; i < p.second.handles.size(); i++) {
@@ -1535,6 +1556,27 @@ struct RocksDBStore::RocksWBHandler: public rocksdb::WriteBatch::Handler {
   bool Continue() override { return num_seen < 50; }
 };
 
+void RocksDBStore::flush_no_wal_columns()
+{
+  if (!no_wal_dirty.exchange(false)) {
+    return;
+  }
+  std::vector<rocksdb::ColumnFamilyHandle*> handles;
+  for (auto& [name, shards] : cf_handles) {
+    if (!shards.wal) {
+      handles.insert(handles.end(), shards.handles.begin(), shards.handles.end());
+    }
+  }
+  if (handles.empty()) {
+    return;
+  }
+  dout(10) << __func__ << " flushing " << handles.size() << " columns" << dendl;
+  rocksdb::Status status = db->Flush(rocksdb::FlushOptions(), handles);
+  if (!status.ok()) {
+    derr << __func__ << " failed to flush: " << status.ToString() << dendl;
+  }
+}
+
 int RocksDBStore::submit_common(rocksdb::WriteOptions& woptions, KeyValueDB::Transaction t) 
 {
   // enable rocksdb breakdown
@@ -1552,7 +1594,22 @@ int RocksDBStore::submit_common(rocksdb::WriteOptions& woptions, KeyValueDB::Tra
   _t->bat.Iterate(&bat_txc);
   *_dout << " Rocksdb transaction: " << bat_txc.seen.str() << dendl;
   
-  rocksdb::Status s = db->Write(woptions, &_t->bat);
+  rocksdb::Status s;
+  if (_t->bat_no_wal.Count()) {
+    // columns with wal=false are rebuildable; they only become durable
+    // once their memtables are flushed
+    rocksdb::WriteOptions no_wal_options(woptions);
+    no_wal_options.disableWAL = true;
+    no_wal_options.sync = false;
+    no_wal_dirty = true;
+    s = db->Write(no_wal_options, &_t->bat_no_wal);
+    if (!s.ok()) {
+      derr << __func__ << " no-wal batch error: " << s.ToString()
+	   << " code = " << s.code() << dendl;
+      return -1;
+    }
+  }
+  s = db->Write(woptions, &_t->bat);
   if (!s.ok()) {
     RocksWBHandler rocks_txc(*this);
     _t->bat.Iterate(&rocks_txc);
@@ -1616,6 +1673,18 @@ RocksDBStore::RocksDBTransactionImpl::RocksDBTransactionImpl(RocksDBStore *_db)
   db = _db;
 }
 
+rocksdb::WriteBatch& RocksDBStore::RocksDBTransactionImpl::get_bat(
+  const string &prefix)
+{
+  if (!db->no_wal_columns.empty()) {
+    auto p = db->cf_handles.find(prefix);
+    if (p != db->cf_handles.end() && !p->second.wal) {
+      return bat_no_wal;
+    }
+  }
+  return bat;
+}
+
 void RocksDBStore::RocksDBTransactionImpl::put_bat(
   rocksdb::WriteBatch& bat,
   rocksdb::ColumnFamilyHandle *cf,
@@ -1642,12 +1711,13 @@ void RocksDBStore::RocksDBTransactionImpl::set(
   const string &k,
   const bufferlist &to_set_bl)
 {
+  auto& b = get_bat(prefix);
   auto cf = db->get_cf_handle(prefix, k);
   if (cf) {
-    put_bat(bat, cf, k, to_set_bl);
+    put_bat(b, cf, k, to_set_bl);
   } else {
     string key = combine_strings(prefix, k);
-    put_bat(bat, db->default_cf, key, to_set_bl);
+    put_bat(b, db->default_cf, key, to_set_bl);
   }
 }
 
@@ -1656,25 +1726,27 @@ void RocksDBStore::RocksDBTransactionImpl::set(
   const char *k, size_t keylen,
   const bufferlist &to_set_bl)
 {
+  auto& b = get_bat(prefix);
   auto cf = db->get_cf_handle(prefix, k, keylen);
   if (cf) {
     string key(k, keylen);  // fixme?
-    put_bat(bat, cf, key, to_set_bl);
+    put_bat(b, cf, key, to_set_bl);
   } else {
     string key;
     combine_strings(prefix, k, keylen, &key);
-    put_bat(bat, cf, key, to_set_bl);
+    put_bat(b, cf, key, to_set_bl);
   }
 }
 
 void RocksDBStore::RocksDBTransactionImpl::rmkey(const string &prefix,
 					         const string &k)
 {
+  auto& b = get_bat(prefix);
   auto cf = db->get_cf_handle(prefix, k);
   if (cf) {
-    bat.Delete(cf, rocksdb::Slice(k));
+    b.Delete(cf, rocksdb::Slice(k));
   } else {
-    bat.Delete(db->default_cf, combine_strings(prefix, k));
+    b.Delete(db->default_cf, combine_strings(prefix, k));
   }
 }
 
@@ -1682,62 +1754,65 @@ void RocksDBStore::RocksDBTransactionImpl::rmkey(const string &prefix,
 					         const char *k,
 						 size_t keylen)
 {
+  auto& b = get_bat(prefix);
   auto cf = db->get_cf_handle(prefix, k, keylen);
   if (cf) {
-    bat.Delete(cf, rocksdb::Slice(k, keylen));
+    b.Delete(cf, rocksdb::Slice(k, keylen));
   } else {
     string key;
     combine_strings(prefix, k, keylen, &key);
-    bat.Delete(db->default_cf, rocksdb::Slice(key));
+    b.Delete(db->default_cf, rocksdb::Slice(key));
   }
 }
 
 void RocksDBStore::RocksDBTransactionImpl::rm_single_key(const string &prefix,
 					                 const string &k)
 {
+  auto& b = get_bat(prefix);
   auto cf = db->get_cf_handle(prefix, k);
   if (cf) {
-    bat.SingleDelete(cf, k);
+    b.SingleDelete(cf, k);
   } else {
-    bat.SingleDelete(db->default_cf, combine_strings(prefix, k));
+    b.SingleDelete(db->default_cf, combine_strings(prefix, k));
   }
 }
 
 void RocksDBStore::RocksDBTransactionImpl::rmkeys_by_prefix(const string &prefix)
 {
+  auto& b = get_bat(prefix);
   auto p_iter = db->cf_handles.find(prefix);
   if (p_iter == db->cf_handles.end()) {
     uint64_t cnt = db->get_delete_range_threshold();
-    bat.SetSavePoint();
+    b.SetSavePoint();
     auto it = db->get_iterator(prefix);
     for (it->seek_to_first(); it->valid() && (--cnt) != 0; it->next()) {
-      bat.Delete(db->default_cf, combine_strings(prefix, it->key()));
+      b.Delete(db->default_cf, combine_strings(prefix, it->key()));
     }
     if (cnt == 0) {
-	bat.RollbackToSavePoint();
+	b.RollbackToSavePoint();
 	string endprefix = prefix;
         endprefix.push_back('\x01');
-	bat.DeleteRange(db->default_cf,
+	b.DeleteRange(db->default_cf,
                         combine_strings(prefix, string()),
                         combine_strings(endprefix, string()));
     } else {
-      bat.PopSavePoint();
+      b.PopSavePoint();
     }
   } else {
     ceph_assert(p_iter->second.handles.size() >= 1);
     for (auto cf : p_iter->second.handles) {
       uint64_t cnt = db->get_delete_range_threshold();
-      bat.SetSavePoint();
+      b.SetSavePoint();
       auto it = db->new_shard_iterator(cf);
       for (it->seek_to_first(); it->valid() && (--cnt) != 0; it->next()) {
-	bat.Delete(cf, it->key());
+	b.Delete(cf, it->key());
       }
       if (cnt == 0) {
-	bat.RollbackToSavePoint();
+	b.RollbackToSavePoint();
 	string endprefix = "\xff\xff\xff\xff";  // FIXME: this is cheating...
-	bat.DeleteRange(cf, string(), endprefix);
+	b.DeleteRange(cf, string(), endprefix);
       } else {
-	bat.PopSavePoint();
+	b.PopSavePoint();
       }
     }
   }
@@ -1747,6 +1822,7 @@ void RocksDBStore::RocksDBTransactionImpl::rm_range_keys(const string &prefix,
                                                          const string &start,
                                                          const string &end)
 {
+  auto& b = get_bat(prefix);
   ldout(db->cct, 10) << __func__
                      << " enter prefix=" << prefix
                      << " start=" << pretty_binary_string(start)
@@ -1755,12 +1831,12 @@ void RocksDBStore::RocksDBTransactionImpl::rm_range_keys(const string &prefix,
   uint64_t cnt = db->get_delete_range_threshold();
   if (p_iter == db->cf_handles.end()) {
     uint64_t cnt0 = cnt;
-    bat.SetSavePoint();
+    b.SetSavePoint();
     auto it = db->get_iterator(prefix);
     for (it->lower_bound(start);
 	 it->valid() && db->comparator->Compare(it->key(), end) < 0 && (--cnt) != 0;
 	 it->next()) {
-      bat.Delete(db->default_cf, combine_strings(prefix, it->key()));
+      b.Delete(db->default_cf, combine_strings(prefix, it->key()));
     }
     ldout(db->cct, 15) << __func__
                        << " count = " << cnt0 - cnt
@@ -1768,19 +1844,19 @@ void RocksDBStore::RocksDBTransactionImpl::rm_range_keys(const string &prefix,
     if (cnt == 0) {
       ldout(db->cct, 10) << __func__ << " p_iter == end(), resorting to DeleteRange"
 			 << dendl;
-      bat.RollbackToSavePoint();
-      bat.DeleteRange(db->default_cf,
+      b.RollbackToSavePoint();
+      b.DeleteRange(db->default_cf,
 		      rocksdb::Slice(combine_strings(prefix, start)),
 		      rocksdb::Slice(combine_strings(prefix, end)));
     } else {
-      bat.PopSavePoint();
+      b.PopSavePoint();
     }
   } else if (cnt == 0) {
     ceph_assert(p_iter->second.handles.size() >= 1);
     for (auto cf : p_iter->second.handles) {
       ldout(db->cct, 10) << __func__ << " p_iter != end(), resorting to DeleteRange"
 			   << dendl;
-	bat.DeleteRange(cf, rocksdb::Slice(start), rocksdb::Slice(end));
+	b.DeleteRange(cf, rocksdb::Slice(start), rocksdb::Slice(end));
     }
   } else {
     auto bounds = KeyValueDB::IteratorBounds();
@@ -1790,12 +1866,12 @@ void RocksDBStore::RocksDBTransactionImpl::rm_range_keys(const string &prefix,
     for (auto cf : p_iter->second.handles) {
       cnt = db->get_delete_range_threshold();
       uint64_t cnt0 = cnt;
-      bat.SetSavePoint();
+      b.SetSavePoint();
       auto it = db->new_shard_iterator(cf, prefix, bounds);
       for (it->lower_bound(start);
 	   it->valid() && (--cnt) != 0;
 	   it->next()) {
-	bat.Delete(cf, it->key());
+	b.Delete(cf, it->key());
       }
       ldout(db->cct, 10) << __func__
                          << " count = " << cnt0 - cnt
@@ -1803,10 +1879,10 @@ void RocksDBStore::RocksDBTransactionImpl::rm_range_keys(const string &prefix,
       if (cnt == 0) {
         ldout(db->cct, 10) << __func__ << " p_iter != end(), resorting to DeleteRange"
 			   << dendl;
-	bat.RollbackToSavePoint();
-	bat.DeleteRange(cf, rocksdb::Slice(start), rocksdb::Slice(end));
+	b.RollbackToSavePoint();
+	b.DeleteRange(cf, rocksdb::Slice(start), rocksdb::Slice(end));
       } else {
-	bat.PopSavePoint();
+	b.PopSavePoint();
       }
     }
   }
@@ -1818,11 +1894,12 @@ void RocksDBStore::RocksDBTransactionImpl::merge(
   const string &k,
   const bufferlist &to_set_bl)
 {
+  auto& b = get_bat(prefix);
   auto cf = db->get_cf_handle(prefix, k);
   if (cf) {
     // bufferlist::c_str() is non-constant, so we can't call c_str()
     if (to_set_bl.is_contiguous() && to_set_bl.length() > 0) {
-      bat.Merge(
+      b.Merge(
 	cf,
 	rocksdb::Slice(k),
 	rocksdb::Slice(to_set_bl.buffers().front().c_str(), to_set_bl.length()));
@@ -1830,14 +1907,14 @@ void RocksDBStore::RocksDBTransactionImpl::merge(
       // make a copy
       rocksdb::Slice key_slice(k);
       vector<rocksdb::Slice> value_slices(to_set_bl.get_num_buffers());
-      bat.Merge(cf, rocksdb::SliceParts(&key_slice, 1),
+      b.Merge(cf, rocksdb::SliceParts(&key_slice, 1),
 		prepare_sliceparts(to_set_bl, &value_slices));
     }
   } else {
     string key = combine_strings(prefix, k);
     // bufferlist::c_str() is non-constant, so we can't call c_str()
     if (to_set_bl.is_contiguous() && to_set_bl.length() > 0) {
-      bat.Merge(
+      b.Merge(
 	db->default_cf,
 	rocksdb::Slice(key),
 	rocksdb::Slice(to_set_bl.buffers().front().c_str(), to_set_bl.length()));
@@ -1845,7 +1922,7 @@ void RocksDBStore::RocksDBTransactionImpl::merge(
       // make a copy
       rocksdb::Slice key_slice(key);
       vector<rocksdb::Slice> value_slices(to_set_bl.get_num_buffers());
-      bat.Merge(
+      b.Merge(
 	db->default_cf,
 	rocksdb::SliceParts(&key_slice, 1),
 	prepare_sliceparts(to_set_bl, &value_slices));
@@ -1858,35 +1935,60 @@ int RocksDBStore::get(
     const std::set<string> &keys,
     std::map<string, bufferlist> *out)
 {
-  rocksdb::PinnableSlice value;
+  std::vector<string> v(keys.begin(), keys.end());
+  std::vector<bufferlist> values;
+  std::vector<int> rs;
+  get(prefix, v, &values, &rs);
+  for (size_t i = 0; i < v.size(); ++i) {
+    if (rs[i] == 0) {
+      (*out)[v[i]] = std::move(values[i]);
+    }
+  }
+  return 0;
+}
+
+int RocksDBStore::get(
+    const string &prefix,
+    const std::vector<string> &keys,
+    std::vector<bufferlist> *values,
+    std::vector<int> *rs)
+{
+  size_t n = keys.size();
+  values->assign(n, bufferlist());
+  rs->assign(n, -ENOENT);
+  if (n == 0) {
+    return 0;
+  }
   utime_t start = ceph_clock_now();
-  if (cf_handles.count(prefix) > 0) {
-    for (auto& key : keys) {
-      auto cf_handle = get_cf_handle(prefix, key);
-      auto status = db->Get(rocksdb::ReadOptions(),
-			    cf_handle,
-			    rocksdb::Slice(key),
-			    &value);
-      if (status.ok()) {
-	(*out)[key].append(value.data(), value.size());
-      } else if (status.IsIOError()) {
-	ceph_abort_msg(status.getState());
-      }
-      value.Reset();
+  // one MultiGet for all keys lets rocksdb batch the filter checks and
+  // block reads instead of probing every level once per key
+  std::vector<rocksdb::ColumnFamilyHandle*> cfs(n);
+  std::vector<rocksdb::Slice> slices(n);
+  std::vector<string> combined;
+  bool sharded = cf_handles.count(prefix) > 0;
+  if (!sharded) {
+    combined.reserve(n);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if (sharded) {
+      cfs[i] = get_cf_handle(prefix, keys[i]);
+      slices[i] = rocksdb::Slice(keys[i]);
+    } else {
+      combined.push_back(combine_strings(prefix, keys[i]));
+      cfs[i] = default_cf;
+      slices[i] = rocksdb::Slice(combined.back());
     }
-  } else {
-    for (auto& key : keys) {
-      string k = combine_strings(prefix, key);
-      auto status = db->Get(rocksdb::ReadOptions(),
-			    default_cf,
-			    rocksdb::Slice(k),
-			    &value);
-      if (status.ok()) {
-	(*out)[key].append(value.data(), value.size());
-      } else if (status.IsIOError()) {
-	ceph_abort_msg(status.getState());
-      }
-      value.Reset();
+  }
+  std::vector<rocksdb::PinnableSlice> pvalues(n);
+  std::vector<rocksdb::Status> statuses(n);
+  db->MultiGet(rocksdb::ReadOptions(), n, cfs.data(), slices.data(),
+	       pvalues.data(), statuses.data());
+  for (size_t i = 0; i < n; ++i) {
+    if (statuses[i].ok()) {
+      (*values)[i].append(pvalues[i].data(), pvalues[i].size());
+      (*rs)[i] = 0;
+    } else if (!statuses[i].IsNotFound()) {
+      ceph_abort_msg(statuses[i].getState());
     }
   }
   utime_t lat = ceph_clock_now() - start;
@@ -2001,6 +2103,98 @@ void RocksDBStore::compact()
   }
 }
 
+void RocksDBStore::compact_parallel(unsigned threads)
+{
+  if (threads <= 1) {
+    compact();
+    return;
+  }
+  logger->inc(l_rocksdb_compact);
+  std::vector<rocksdb::ColumnFamilyHandle*> cfs{default_cf};
+  for (auto& cf : cf_handles) {
+    cfs.insert(cfs.end(), cf.second.handles.begin(), cf.second.handles.end());
+  }
+  // compact the column families side by side, and let rocksdb split each
+  // one's key range among the threads left over
+  unsigned workers = std::min<size_t>(threads, cfs.size());
+  rocksdb::CompactRangeOptions options;
+  options.exclusive_manual_compaction = false;
+  options.max_subcompactions = std::max(1u, threads / workers);
+  dout(10) << __func__ << " " << cfs.size() << " column families, "
+	   << workers << " at a time, " << options.max_subcompactions
+	   << " subcompactions each" << dendl;
+  std::atomic<size_t> next = 0;
+  std::vector<std::thread> compactors;
+  for (unsigned i = 0; i < workers; ++i) {
+    compactors.push_back(make_named_thread("rocksdb_compact", [&] {
+      for (size_t n = next++; n < cfs.size(); n = next++) {
+	db->CompactRange(options, cfs[n], nullptr, nullptr);
+      }
+    }));
+  }
+  for (auto& t : compactors) {
+    t.join();
+  }
+}
+
+int RocksDBStore::verify_checksums(unsigned threads, std::ostream &out)
+{
+  std::map<std::string, rocksdb::Options> cf_options;
+  cf_options.emplace(default_cf->GetName(), db->GetOptions(default_cf));
+  for (auto& cf : cf_handles) {
+    for (auto h : cf.second.handles) {
+      cf_options.emplace(h->GetName(), db->GetOptions(h));
+    }
+  }
+  std::vector<rocksdb::LiveFileMetaData> files;
+  db->GetLiveFilesMetaData(&files);
+
+  rocksdb::EnvOptions env_options(db->GetDBOptions());
+  rocksdb::ReadOptions read_options;
+  read_options.verify_checksums = true;
+  read_options.fill_cache = false;
+
+  // the files are read through the DB's Env, i.e. through BlueFS when
+  // embedded in BlueStore
+  ceph::mutex out_lock = ceph::make_mutex("RocksDBStore::verify_checksums");
+  int damaged = 0;
+  std::atomic<size_t> next = 0;
+  auto verify = [&] {
+    for (size_t n = next++; n < files.size(); n = next++) {
+      auto& file = files[n];
+      std::string file_path = file.db_path + file.name;
+      rocksdb::Status status;
+      auto p = cf_options.find(file.column_family_name);
+      if (p == cf_options.end()) {
+	status = rocksdb::Status::NotFound("unknown column family",
+					   file.column_family_name);
+      } else {
+	status = rocksdb::VerifySstFileChecksum(p->second, env_options,
+						read_options, file_path);
+      }
+      dout(20) << __func__ << " " << file_path << ": " << status.ToString()
+	       << dendl;
+      if (!status.ok()) {
+	std::lock_guard l(out_lock);
+	out << file_path << " (" << file.column_family_name << "): "
+	    << status.ToString() << std::endl;
+	++damaged;
+      }
+    }
+  };
+  std::vector<std::thread> verifiers;
+  unsigned workers = std::clamp<size_t>(threads, 1, std::max<size_t>(files.size(), 1));
+  for (unsigned i = 0; i < workers; ++i) {
+    verifiers.push_back(make_named_thread("rocksdb_verify", verify));
+  }
+  for (auto& t : verifiers) {
+    t.join();
+  }
+  dout(10) << __func__ << " checked " << files.size() << " files, "
+	   << damaged << " damaged" << dendl;
+  return damaged;
+}
+
 void RocksDBStore::compact_thread_entry()
 {
   std::unique_lock l{compact_queue_lock};
@@ -2263,12 +2457,16 @@ public:
   explicit CFIteratorImpl(const RocksDBStore* db,
                           const std::string& p,
                           rocksdb::ColumnFamilyHandle* cf,
+                          KeyValueDB::IteratorOpts opts,
                           KeyValueDB::IteratorBounds bounds_)
     : prefix(p), bounds(std::move(bounds_)),
       iterate_lower_bound(make_slice(bounds.lower_bound)),
       iterate_upper_bound(make_slice(bounds.upper_bound))
       {
       auto options = rocksdb::ReadOptions();
+      if (opts & KeyValueDB::ITERATOR_NOCACHE) {
+        options.fill_cache = false;
+      }
       if (db->cct->_conf->osd_rocksdb_iterator_bounds_enabled) {
         if (bounds.lower_bound) {
           options.iterate_lower_bound = &iterate_lower_bound;
@@ -2818,6 +3016,7 @@ public:
   explicit ShardMergeIteratorImpl(const RocksDBStore* db,
 				  const std::string& prefix,
 				  const std::vector<rocksdb::ColumnFamilyHandle*>& shards,
+                  KeyValueDB::IteratorOpts opts,
                   KeyValueDB::IteratorBounds bounds_)
     : db(db), keyless(db->comparator), prefix(prefix), bounds(std::move(bounds_)),
       iterate_lower_bound(make_slice(bounds.lower_bound)),
@@ -2825,6 +3024,9 @@ public:
   {
     iters.reserve(shards.size());
     auto options = rocksdb::ReadOptions();
+    if (opts & KeyValueDB::ITERATOR_NOCACHE) {
+      options.fill_cache = false;
+    }
     if (db->cct->_conf->osd_rocksdb_iterator_bounds_enabled) {
       if (bounds.lower_bound) {
         options.iterate_lower_bound = &iterate_lower_bound;
@@ -3020,12 +3222,14 @@ KeyValueDB::Iterator RocksDBStore::get_iterator(const std::string& prefix, Itera
               this,
               prefix,
               cf,
+              opts,
               std::move(bounds));
     } else {
       return std::make_shared<ShardMergeIteratorImpl>(
         this,
         prefix,
         cf_it->second.handles,
+        opts,
         std::move(bounds));
     }
   } else {
@@ -3034,7 +3238,7 @@ KeyValueDB::Iterator RocksDBStore::get_iterator(const std::string& prefix, Itera
     // matching cf for the specified prefix.
     auto w_it = cf_handles.size() == 0 || prefix.empty() ?
       get_wholespace_iterator(opts) :
-      get_default_cf_iterator();
+      get_default_cf_iterator(opts);
     return KeyValueDB::make_iterator(prefix, w_it);
   }
 }
@@ -3055,6 +3259,7 @@ KeyValueDB::Iterator RocksDBStore::new_shard_iterator(rocksdb::ColumnFamilyHandl
     this,
     prefix,
     cf,
+    0,
     std::move(bounds));
 }
 
@@ -3068,9 +3273,9 @@ RocksDBStore::WholeSpaceIterator RocksDBStore::get_wholespace_iterator(IteratorO
   }
 }
 
-RocksDBStore::WholeSpaceIterator RocksDBStore::get_default_cf_iterator()
+RocksDBStore::WholeSpaceIterator RocksDBStore::get_default_cf_iterator(IteratorOpts opts)
 {
-  return std::make_shared<RocksDBWholeSpaceIteratorImpl>(this, default_cf, 0);
+  return std::make_shared<RocksDBWholeSpaceIteratorImpl>(this, default_cf, opts);
 }
 
 int RocksDBStore::prepare_for_reshard(const std::string& new_sharding,
@@ -6,6 +6,7 @@
 #include "include/types.h"
 #include "include/buffer_fwd.h"
 #include "KeyValueDB.h"
+#include <atomic>
 #include <set>
 #include <map>
 #include <string>
@@ -119,12 +120,17 @@ private:
   struct prefix_shards {
     uint32_t hash_l;  //< first character to take for hash calc.
     uint32_t hash_h;  //< last character to take for hash calc.
+    bool wal = true;  //< false if writes bypass the WAL
     std::vector<rocksdb::ColumnFamilyHandle *> handles;
   };
   std::unordered_map<std::string, prefix_shards> cf_handles;
   typedef decltype(cf_handles)::iterator cf_handles_iterator;
   std::unordered_map<uint32_t, std::string> cf_ids_to_prefix;
   std::unordered_map<std::string, rocksdb::BlockBasedTableOptions> cf_bbt_opts;
+  /// columns with "wal=false" in their options; their contents must be
+  /// rebuildable as they are lost on crash unless flushed
+  std::set<std::string> no_wal_columns;
+  std::atomic<bool> no_wal_dirty = {false};  //< unflushed no-wal writes
   
   void add_column_family(const std::string& cf_name, uint32_t hash_l, uint32_t hash_h,
 			 size_t shard_idx, rocksdb::ColumnFamilyHandle *handle);
@@ -136,6 +142,8 @@ private:
   rocksdb::ColumnFamilyHandle *check_cf_handle_bounds(const cf_handles_iterator& it, const IteratorBounds& bounds);
 
   int submit_common(rocksdb::WriteOptions& woptions, KeyValueDB::Transaction t);
+  /// persist the memtables of wal=false columns
+  void flush_no_wal_columns();
   int install_cf_mergeop(const std::string &cf_name, rocksdb::ColumnFamilyOptions *cf_opt);
   int create_db_dir();
   int do_open(std::ostream &out, bool create_if_missing, bool open_readonly,
@@ -205,11 +213,14 @@ public:
   }
 
   void compact() override;
+  void compact_parallel(unsigned threads) override;
 
   void compact_async() override {
     compact_range_async({}, {});
   }
 
+  int verify_checksums(unsigned threads, std::ostream &out) override;
+
   int ParseOptionsFromString(const std::string& opt_str, rocksdb::Options& opt);
   static int ParseOptionsFromStringStatic(
     CephContext* cct,
@@ -287,10 +298,12 @@ public:
   class RocksDBTransactionImpl : public KeyValueDB::TransactionImpl {
   public:
     rocksdb::WriteBatch bat;
+    rocksdb::WriteBatch bat_no_wal;  //< updates to wal=false columns
     RocksDBStore *db;
 
     explicit RocksDBTransactionImpl(RocksDBStore *_db);
   private:
+    rocksdb::WriteBatch& get_bat(const std::string &prefix);
     void put_bat(
       rocksdb::WriteBatch& bat,
       rocksdb::ColumnFamilyHandle *cf,
@@ -350,6 +363,11 @@ public:
     const char *key,
     size_t keylen,
     ceph::bufferlist *out) override;
+  int get(
+    const std::string &prefix,
+    const std::vector<std::string> &keys,
+    std::vector<ceph::bufferlist> *values,
+    std::vector<int> *rs) override;
 
 
   class RocksDBWholeSpaceIteratorImpl :
@@ -524,7 +542,7 @@ err:
 
   WholeSpaceIterator get_wholespace_iterator(IteratorOpts opts = 0) override;
 private:
-  WholeSpaceIterator get_default_cf_iterator();
+  WholeSpaceIterator get_default_cf_iterator(IteratorOpts opts = 0);
 
   using cf_deleter_t = std::function<void(rocksdb::ColumnFamilyHandle*)>;
   using columns_t = std::map<std::string,
@@ -101,6 +101,65 @@ void BinnedLRUHandleTable::Resize() {
   length_ = new_length;
 }
 
+void FrequencySketch::Resize(size_t entries) {
+  entries_ = std::max<size_t>(entries, 64);
+  size_t counters = 1;
+  while (counters < entries_ * kDepth) {
+    counters <<= 1;
+  }
+  table_.assign(counters / 16, 0);
+  counter_mask_ = counters - 1;
+  additions_ = 0;
+  sample_size_ = entries_ * 10;
+}
+
+size_t FrequencySketch::IndexOf(uint32_t hash, int i) const {
+  static constexpr uint64_t seeds[kDepth] = {
+    0xc3a5c85c97cb3127ull, 0xb492b66fbe98f273ull,
+    0x9ae16a3b2f90404full, 0xcbf29ce484222325ull};
+  uint64_t h = (hash + seeds[i]) * seeds[i];
+  h ^= h >> 32;
+  return h & counter_mask_;
+}
+
+void FrequencySketch::Increment(uint32_t hash) {
+  if (table_.empty()) {
+    return;
+  }
+  bool added = false;
+  for (int i = 0; i < kDepth; i++) {
+    size_t idx = IndexOf(hash, i);
+    uint64_t& w = table_[idx / 16];
+    int shift = (idx % 16) * 4;
+    if (((w >> shift) & 0xf) < 0xf) {
+      w += 1ull << shift;
+      added = true;
+    }
+  }
+  if (added && ++additions_ >= sample_size_) {
+    Age();
+  }
+}
+
+uint32_t FrequencySketch::Estimate(uint32_t hash) const {
+  if (table_.empty()) {
+    return 0;
+  }
+  uint32_t r = 0xf;
+  for (int i = 0; i < kDepth; i++) {
+    size_t idx = IndexOf(hash, i);
+    r = std::min<uint32_t>(r, (table_[idx / 16] >> ((idx % 16) * 4)) & 0xf);
+  }
+  return r;
+}
+
+void FrequencySketch::Age() {
+  for (auto& w : table_) {
+    w = (w >> 1) & 0x7777777777777777ull;
+  }
+  additions_ /= 2;
+}
+
 BinnedLRUCacheShard::BinnedLRUCacheShard(CephContext *c, size_t capacity, bool strict_capacity_limit,
                              double high_pri_pool_ratio)
     : cct(c),
@@ -112,6 +171,8 @@ BinnedLRUCacheShard::BinnedLRUCacheShard(CephContext *c, size_t capacity, bool s
       usage_(0),
       lru_usage_(0),
       age_bins(1) {
+  admission_filter_ = cct->_conf->rocksdb_cache_admission_filter;
+  avg_charge_ = std::max<size_t>(cct->_conf->rocksdb_block_size, 1);
   shift_bins();
   // Make empty circular linked list
   lru_.next = &lru_;
@@ -197,6 +258,32 @@ size_t BinnedLRUCacheShard::GetHighPriPoolUsage() const {
   return high_pri_pool_usage_;
 }
 
+bool BinnedLRUCacheShard::Admit(uint32_t hash, size_t charge,
+                                rocksdb::Cache::Priority priority) {
+  if (!admission_filter_ ||
+      priority == rocksdb::Cache::Priority::HIGH ||
+      usage_ + charge <= capacity_ ||
+      lru_.next == &lru_) {
+    return true;
+  }
+  BinnedLRUHandle* victim = lru_.next;
+  if (sketch_.Estimate(hash) > sketch_.Estimate(victim->hash)) {
+    return true;
+  }
+  return false;
+}
+
+void BinnedLRUCacheShard::MaybeResizeSketch() {
+  if (!admission_filter_) {
+    return;
+  }
+  size_t want = std::max<size_t>(capacity_ / avg_charge_, 64);
+  size_t have = sketch_.GetEntries();
+  if (have == 0 || want > have * 2 || want < have / 2) {
+    sketch_.Resize(want);
+  }
+}
+
 void BinnedLRUCacheShard::LRU_Remove(BinnedLRUHandle* e) {
   ceph_assert(e->next != nullptr);
   ceph_assert(e->prev != nullptr);
@@ -290,6 +377,7 @@ void BinnedLRUCacheShard::SetCapacity(size_t capacity) {
     std::lock_guard<std::mutex> l(mutex_);
     capacity_ = capacity;
     high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
+    MaybeResizeSketch();
     EvictFromLRU(0, &last_reference_list);
   }
   // we free the entries here outside of mutex for
@@ -306,6 +394,9 @@ void BinnedLRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
 
 rocksdb::Cache::Handle* BinnedLRUCacheShard::Lookup(const rocksdb::Slice& key, uint32_t hash) {
   std::lock_guard<std::mutex> l(mutex_);
+  if (admission_filter_) {
+    sketch_.Increment(hash);
+  }
   BinnedLRUHandle* e = table_.Lookup(key, hash);
   if (e != nullptr) {
     ceph_assert(e->InCache());
@@ -400,9 +491,20 @@ rocksdb::Status BinnedLRUCacheShard::Insert(const rocksdb::Slice& key, uint32_t
     std::lock_guard<std::mutex> l(mutex_);
     // Free the space following strict LRU policy until enough space
     // is freed or the lru list is empty
-    EvictFromLRU(charge, &last_reference_list);
+    bool admit = Admit(hash, charge, priority);
+    if (admit) {
+      EvictFromLRU(charge, &last_reference_list);
+    }
 
-    if (usage_ - lru_usage_ + charge > capacity_ &&
+    if (!admit) {
+      if (handle == nullptr) {
+        last_reference_list.push_back(e);
+      } else {
+        delete e;
+        *handle = nullptr;
+        s = rocksdb::Status::Incomplete("Insert rejected by admission filter.");
+      }
+    } else if (usage_ - lru_usage_ + charge > capacity_ &&
         (strict_capacity_limit_ || handle == nullptr)) {
       if (handle == nullptr) {
         // Don't insert the entry but still return ok, as if the entry inserted
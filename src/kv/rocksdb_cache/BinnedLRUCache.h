@@ -12,6 +12,7 @@
 
 #include <string>
 #include <mutex>
+#include <vector>
 #include <boost/circular_buffer.hpp>
 
 #include "ShardedCache.h"
@@ -170,6 +171,31 @@ class BinnedLRUHandleTable {
   uint32_t elems_;
 };
 
+// Approximate per-key access counts for the TinyLFU admission filter: a
+// count-min sketch of 4-bit saturating counters, four per key, which are
+// all halved once the sketch has seen ten times as many accesses as the
+// shard holds entries, so that old popularity fades.
+class FrequencySketch {
+ public:
+  // size the sketch for about this many cached entries; resets all counts
+  void Resize(size_t entries);
+  void Increment(uint32_t hash);
+  uint32_t Estimate(uint32_t hash) const;
+  size_t GetEntries() const { return entries_; }
+
+ private:
+  static constexpr int kDepth = 4;
+  // 16 counters per word
+  std::vector<uint64_t> table_;
+  size_t counter_mask_ = 0;
+  size_t entries_ = 0;
+  size_t additions_ = 0;
+  size_t sample_size_ = 0;
+
+  size_t IndexOf(uint32_t hash, int i) const;
+  void Age();
+};
+
 // A single shard of sharded cache.
 class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
  public:
@@ -263,6 +289,16 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // holding the mutex_
   void EvictFromLRU(size_t charge, ceph::autovector<BinnedLRUHandle*>* deleted);
 
+  // TinyLFU: if making room for a low priority entry would evict anything,
+  // admit it only if it has been looked up more often than the LRU victim.
+  // Keeps one-off reads (scrub, backfill, listings) from flushing the
+  // working set.  Must be called with mutex_ held.
+  bool Admit(uint32_t hash, size_t charge, rocksdb::Cache::Priority priority);
+
+  // Resize the sketch to the expected entry count of capacity_, unless it
+  // is within a factor of two of it already.  Called with mutex_ held.
+  void MaybeResizeSketch();
+
   // Initialized before use.
   size_t capacity_;
 
@@ -313,6 +349,11 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
 
   // Circular buffer of byte counters for age binning
   boost::circular_buffer<std::shared_ptr<uint64_t>> age_bins;
+
+  // Admission filter state, see Admit()
+  bool admission_filter_ = false;
+  size_t avg_charge_ = 4096;
+  FrequencySketch sketch_;
 };
 
 class BinnedLRUCache : public ShardedCache {
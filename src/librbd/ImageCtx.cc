@@ -287,6 +287,11 @@ librados::IoCtx duplicate_io_ctx(librados::IoCtx& io_ctx) {
     plb.add_u64_counter(l_librbd_readahead, "readahead", "Read ahead");
     plb.add_u64_counter(l_librbd_readahead_bytes, "readahead_bytes", "Data size in read ahead", NULL, 0, unit_t(UNIT_BYTES));
     plb.add_u64_counter(l_librbd_invalidate_cache, "invalidate_cache", "Cache invalidates");
+    plb.add_u64_counter(l_librbd_journal_append, "journal_append", "Journal events appended");
+    plb.add_u64_counter(l_librbd_journal_append_bytes, "journal_append_bytes", "Data appended to the journal", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_time_avg(l_librbd_journal_append_latency, "journal_append_latency", "Latency of journal IO event appends");
+    plb.add_u64_counter(l_librbd_qos_throttled, "qos_throttled", "IOs delayed by QoS limits");
+    plb.add_time_avg(l_librbd_qos_throttle_latency, "qos_throttle_latency", "Time IOs waited for QoS tokens");
 
     plb.add_time(l_librbd_opened_time, "opened_time", "Opened time",
                  "ots", perf_prio);
@@ -5,6 +5,7 @@
 #include "include/rados/librados.hpp"
 #include "common/AsyncOpTracker.h"
 #include "common/errno.h"
+#include "common/perf_counters.h"
 #include "common/Timer.h"
 #include "common/WorkQueue.h"
 #include "cls/journal/cls_journal_types.h"
@@ -863,10 +864,13 @@ uint64_t Journal<I>::append_io_events(journal::EventType event_type,
   }
 
   Futures futures;
+  uint64_t append_bytes = 0;
   for (auto &bl : bufferlists) {
     ceph_assert(bl.length() <= m_max_append_size);
+    append_bytes += bl.length();
     futures.push_back(m_journaler->append(m_tag_tid, bl));
   }
+  update_append_perf_counters(futures.size(), append_bytes);
 
   {
     std::lock_guard event_locker{m_event_lock};
@@ -891,6 +895,14 @@ uint64_t Journal<I>::append_io_events(journal::EventType event_type,
   return tid;
 }
 
+template <typename I>
+void Journal<I>::update_append_perf_counters(uint64_t events, uint64_t bytes) {
+  if (m_image_ctx.perfcounter != nullptr) {
+    m_image_ctx.perfcounter->inc(l_librbd_journal_append, events);
+    m_image_ctx.perfcounter->inc(l_librbd_journal_append_bytes, bytes);
+  }
+}
+
 template <typename I>
 void Journal<I>::commit_io_event(uint64_t tid, int r) {
   CephContext *cct = m_image_ctx.cct;
@@ -958,6 +970,7 @@ void Journal<I>::append_op_event(uint64_t op_tid,
     ceph_assert(m_state == STATE_READY);
 
     future = m_journaler->append(m_tag_tid, bl);
+    update_append_perf_counters(1, bl.length());
 
     // delay committing op event to ensure consistent replay
     ceph_assert(m_op_futures.count(op_tid) == 0);
@@ -1002,6 +1015,7 @@ void Journal<I>::commit_op_event(uint64_t op_tid, int r, Context *on_safe) {
     m_op_futures.erase(it);
 
     op_finish_future = m_journaler->append(m_tag_tid, bl);
+    update_append_perf_counters(1, bl.length());
   }
 
   op_finish_future.flush(create_async_context_callback(
@@ -1568,6 +1582,10 @@ void Journal<I>::handle_io_event_safe(int r, uint64_t tid) {
 
     Event &event = it->second;
     on_safe_contexts.swap(event.on_safe_contexts);
+    if (m_image_ctx.perfcounter != nullptr) {
+      m_image_ctx.perfcounter->tinc(l_librbd_journal_append_latency,
+                                    ceph_clock_now() - event.append_time);
+    }
 
     if (r < 0 || event.committed_io) {
       // failed journal write so IO won't be sent -- or IO extent was
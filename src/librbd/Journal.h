@@ -197,12 +197,14 @@ private:
     bool committed_io = false;
     bool safe = false;
     int ret_val = 0;
+    utime_t append_time;
 
     Event() {
     }
     Event(const Futures &_futures, uint64_t offset, size_t length,
           int filter_ret_val)
-      : futures(_futures), filter_ret_val(filter_ret_val) {
+      : futures(_futures), filter_ret_val(filter_ret_val),
+        append_time(ceph_clock_now()) {
       if (length > 0) {
         pending_extents.insert(offset, length);
       }
@@ -326,6 +328,7 @@ private:
                             const Bufferlists &bufferlists,
                             uint64_t offset, size_t length, bool flush_entry,
                             int filter_ret_val);
+  void update_append_perf_counters(uint64_t events, uint64_t bytes);
   Future wait_event(ceph::mutex &lock, uint64_t tid, Context *on_safe);
 
   void create_journaler();
@@ -24,6 +24,7 @@
 #include "include/stringify.h"
 #include "osdc/Striper.h"
 #include <sstream>
+#include <vector>
 
 #define dout_subsys ceph_subsys_rbd
 #undef dout_prefix
@@ -312,6 +313,7 @@ void ObjectMap<I>::handle_detained_aio_update(BlockGuardCell *cell, int r,
 
   typename UpdateGuard::BlockOperations block_ops;
   m_update_guard->release(cell, &block_ops);
+  coalesce_detained_aio_updates(&block_ops);
 
   {
     std::shared_lock image_locker{m_image_ctx.image_lock};
@@ -325,6 +327,61 @@ void ObjectMap<I>::handle_detained_aio_update(BlockGuardCell *cell, int r,
   m_async_op_tracker.finish_op();
 }
 
+template <typename I>
+void ObjectMap<I>::coalesce_detained_aio_updates(
+    std::list<UpdateOperation> *block_ops) {
+  // consecutive updates that were waiting on the same in-flight update and
+  // set the same state over touching ranges are issued as a single object
+  // map update instead of being serialized behind each other
+  if (block_ops->size() < 2) {
+    return;
+  }
+
+  CephContext *cct = m_image_ctx.cct;
+  auto it = block_ops->begin();
+  std::vector<Context*> on_finishes;
+  auto merge_finishes = [this, &it, &on_finishes]() {
+    if (on_finishes.empty()) {
+      return;
+    }
+    on_finishes.insert(on_finishes.begin(), it->on_finish);
+    it->on_finish = new LambdaContext(
+      [this, on_finishes=std::move(on_finishes)](int r) {
+        for (size_t i = 0; i < on_finishes.size(); ++i) {
+          on_finishes[i]->complete(r);
+          if (i > 0) {
+            // the first op is accounted for by the detained update itself
+            m_async_op_tracker.finish_op();
+          }
+        }
+      });
+    on_finishes.clear();
+  };
+
+  for (auto next = std::next(it); next != block_ops->end(); ) {
+    if (next->new_state == it->new_state &&
+        next->current_state == it->current_state &&
+        next->ignore_enoent == it->ignore_enoent &&
+        next->start_object_no <= it->end_object_no &&
+        next->end_object_no >= it->start_object_no) {
+      ldout(cct, 20) << "coalescing object map update "
+                     << "[" << next->start_object_no << ","
+                     << next->end_object_no << ") into "
+                     << "[" << it->start_object_no << ","
+                     << it->end_object_no << ")" << dendl;
+      it->start_object_no = std::min(it->start_object_no,
+                                     next->start_object_no);
+      it->end_object_no = std::max(it->end_object_no, next->end_object_no);
+      on_finishes.push_back(next->on_finish);
+      next = block_ops->erase(next);
+    } else {
+      merge_finishes();
+      it = next++;
+    }
+  }
+  merge_finishes();
+}
+
 template <typename I>
 void ObjectMap<I>::aio_update(uint64_t snap_id, uint64_t start_object_no,
                               uint64_t end_object_no, uint8_t new_state,
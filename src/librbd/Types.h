@@ -52,6 +52,13 @@ enum {
 
   l_librbd_invalidate_cache,
 
+  l_librbd_journal_append,          // journal events appended
+  l_librbd_journal_append_bytes,    // bytes appended to the journal
+  l_librbd_journal_append_latency,  // append until the event is safe
+
+  l_librbd_qos_throttled,           // IOs delayed by QoS limits
+  l_librbd_qos_throttle_latency,    // time IOs waited for QoS tokens
+
   l_librbd_opened_time,
   l_librbd_lock_acquired_time,
 
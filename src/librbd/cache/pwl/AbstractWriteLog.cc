@@ -75,6 +75,10 @@ AbstractWriteLog<I>::AbstractWriteLog(
 {
   CephContext *cct = m_image_ctx.cct;
   m_plugin_api.get_image_timer_instance(cct, &m_timer, &m_timer_lock);
+  m_max_flush_ops_in_flight = image_ctx.config.template get_val<uint64_t>(
+    "rbd_persistent_cache_writeback_ops");
+  m_max_flush_bytes_in_flight = image_ctx.config.template get_val<Option::size_t>(
+    "rbd_persistent_cache_writeback_bytes");
 }
 
 template <typename I>
@@ -1643,8 +1647,8 @@ bool AbstractWriteLog<I>::can_flush_entry(std::shared_ptr<GenericLogEntry> log_e
   }
 
   return (log_entry->can_writeback() &&
-         (m_flush_ops_in_flight <= IN_FLIGHT_FLUSH_WRITE_LIMIT) &&
-         (m_flush_bytes_in_flight <= IN_FLIGHT_FLUSH_BYTES_LIMIT));
+         (m_flush_ops_in_flight <= m_max_flush_ops_in_flight) &&
+         (m_flush_bytes_in_flight <= m_max_flush_bytes_in_flight));
 }
 
 template <typename I>
@@ -1750,7 +1754,7 @@ void AbstractWriteLog<I>::process_writeback_dirty_entries() {
 
     std::shared_lock entry_reader_locker(m_entry_reader_lock);
     std::lock_guard locker(m_lock);
-    while (flushed < IN_FLIGHT_FLUSH_WRITE_LIMIT) {
+    while (flushed < m_max_flush_ops_in_flight) {
       if (m_shutting_down) {
         ldout(cct, 5) << "Flush during shutdown suppressed" << dendl;
         /* Do flush complete only when all flush ops are finished */
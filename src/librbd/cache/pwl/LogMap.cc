@@ -36,7 +36,7 @@ LogMapEntry<T>::LogMapEntry(std::shared_ptr<T> log_entry)
 template <typename T>
 LogMap<T>::LogMap(CephContext *cct)
   : m_cct(cct),
-    m_lock(ceph::make_mutex(pwl::unique_lock_name(
+    m_lock(ceph::make_shared_mutex(pwl::unique_lock_name(
            "librbd::cache::pwl::LogMap::m_lock", this))) {
 }
 
@@ -96,7 +96,7 @@ void LogMap<T>::remove_log_entries(std::list<std::shared_ptr<T>> &log_entries) {
  */
 template <typename T>
 std::list<std::shared_ptr<T>> LogMap<T>::find_log_entries(BlockExtent block_extent) {
-  std::lock_guard locker(m_lock);
+  std::shared_lock locker(m_lock);
   ldout(m_cct, 20) << dendl;
   return find_log_entries_locked(block_extent);
 }
@@ -107,7 +107,7 @@ std::list<std::shared_ptr<T>> LogMap<T>::find_log_entries(BlockExtent block_exte
  */
 template <typename T>
 LogMapEntries<T> LogMap<T>::find_map_entries(BlockExtent block_extent) {
-  std::lock_guard locker(m_lock);
+  std::shared_lock locker(m_lock);
   ldout(m_cct, 20) << dendl;
   return find_map_entries_locked(block_extent);
 }
@@ -216,7 +216,7 @@ std::list<std::shared_ptr<T>> LogMap<T>::find_log_entries_locked(const BlockExte
   std::list<std::shared_ptr<T>> overlaps;
   ldout(m_cct, 20) << "block_extent=" << block_extent << dendl;
 
-  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+  ceph_assert(ceph_mutex_is_locked(m_lock));
   LogMapEntries<T> map_entries = find_map_entries_locked(block_extent);
   for (auto &map_entry : map_entries) {
     overlaps.emplace_back(map_entry.log_entry);
@@ -233,7 +233,7 @@ LogMapEntries<T> LogMap<T>::find_map_entries_locked(const BlockExtent &block_ext
   LogMapEntries<T> overlaps;
 
   ldout(m_cct, 20) << "block_extent=" << block_extent << dendl;
-  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+  ceph_assert(ceph_mutex_is_locked(m_lock));
   auto p = m_block_to_log_entry_map.equal_range(LogMapEntry<T>(block_extent));
   ldout(m_cct, 20) << "count=" << std::distance(p.first, p.second) << dendl;
   for ( auto i = p.first; i != p.second; ++i ) {
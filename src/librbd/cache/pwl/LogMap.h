@@ -70,7 +70,8 @@ private:
                                               LogMapEntryCompare>;
 
   CephContext *m_cct;
-  ceph::mutex m_lock;
+  /* lookups on the read path only need it shared */
+  ceph::shared_mutex m_lock;
   BlockExtentToLogMapEntries m_block_to_log_entry_map;
 };
 
@@ -145,11 +145,12 @@ void ImageCopyRequest<I>::send_object_copies() {
     auto max_ops = m_src_image_ctx->config.template get_val<uint64_t>(
       "rbd_concurrent_management_ops");
 
-    // attempt to schedule at least 'max_ops' initial requests where
-    // some objects might be skipped if fast-diff notes no change
+    // schedule 'max_ops' initial requests -- objects that fast-diff notes
+    // as unchanged holes are skipped without taking a slot
     for (uint64_t i = 0; i < max_ops; i++) {
       send_next_object_copy();
     }
+    update_progress();
 
     complete = (m_current_ops == 0) && !m_updating_progress;
   }
@@ -168,21 +169,19 @@ void ImageCopyRequest<I>::send_next_object_copy() {
     m_ret_val = -ECANCELED;
   }
 
-  if (m_ret_val < 0 || m_object_no >= m_end_object_no) {
-    return;
-  }
-
-  uint64_t ono = m_object_no++;
-  Context *ctx = new LambdaContext(
-    [this, ono](int r) {
-      handle_object_copy(ono, r);
-    });
+  uint64_t ono;
+  uint8_t object_diff_state;
+  while (true) {
+    if (m_ret_val < 0 || m_object_no >= m_end_object_no) {
+      return;
+    }
 
-  ldout(m_cct, 20) << "object_num=" << ono << dendl;
-  ++m_current_ops;
+    ono = m_object_no++;
+    object_diff_state = object_map::DIFF_STATE_HOLE;
+    if (m_object_diff_state.size() == 0) {
+      break;
+    }
 
-  uint8_t object_diff_state = object_map::DIFF_STATE_HOLE;
-  if (m_object_diff_state.size() > 0) {
     std::set<uint64_t> src_objects;
     map_src_objects(ono, &src_objects);
 
@@ -201,13 +200,24 @@ void ImageCopyRequest<I>::send_next_object_copy() {
       }
     }
 
-    if (object_diff_state == object_map::DIFF_STATE_HOLE) {
-      ldout(m_cct, 20) << "skipping non-existent object " << ono << dendl;
-      create_async_context_callback(*m_src_image_ctx, ctx)->complete(0);
-      return;
+    if (object_diff_state != object_map::DIFF_STATE_HOLE) {
+      break;
     }
+
+    // nothing to copy: account for the object right away instead of
+    // spending an op slot (and a work queue round trip) on it
+    ldout(m_cct, 20) << "skipping non-existent object " << ono << dendl;
+    m_copied_objects.push(ono);
   }
 
+  Context *ctx = new LambdaContext(
+    [this, ono](int r) {
+      handle_object_copy(ono, r);
+    });
+
+  ldout(m_cct, 20) << "object_num=" << ono << dendl;
+  ++m_current_ops;
+
   uint32_t flags = 0;
   if (m_flatten) {
     flags |= OBJECT_COPY_REQUEST_FLAG_FLATTEN;
@@ -240,22 +250,10 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
       }
     } else {
       m_copied_objects.push(object_no);
-      while (!m_updating_progress && !m_copied_objects.empty() &&
-             m_copied_objects.top() ==
-               (m_object_number ? *m_object_number + 1 : 0)) {
-        m_object_number = m_copied_objects.top();
-        m_copied_objects.pop();
-        uint64_t progress_object_no = *m_object_number + 1;
-        m_updating_progress = true;
-        m_lock.unlock();
-        m_handler->update_progress(progress_object_no, m_end_object_no);
-        m_lock.lock();
-        ceph_assert(m_updating_progress);
-        m_updating_progress = false;
-      }
     }
 
     send_next_object_copy();
+    update_progress();
     complete = (m_current_ops == 0) && !m_updating_progress;
   }
 
@@ -264,6 +262,25 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
   }
 }
 
+template <typename I>
+void ImageCopyRequest<I>::update_progress() {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+
+  while (!m_updating_progress && !m_copied_objects.empty() &&
+         m_copied_objects.top() ==
+           (m_object_number ? *m_object_number + 1 : 0)) {
+    m_object_number = m_copied_objects.top();
+    m_copied_objects.pop();
+    uint64_t progress_object_no = *m_object_number + 1;
+    m_updating_progress = true;
+    m_lock.unlock();
+    m_handler->update_progress(progress_object_no, m_end_object_no);
+    m_lock.lock();
+    ceph_assert(m_updating_progress);
+    m_updating_progress = false;
+  }
+}
+
 template <typename I>
 void ImageCopyRequest<I>::finish(int r) {
   ldout(m_cct, 20) << "r=" << r << dendl;
@@ -111,6 +111,7 @@ private:
   void send_object_copies();
   void send_next_object_copy();
   void handle_object_copy(uint64_t object_no, int r);
+  void update_progress();
 
   void finish(int r);
 };
@@ -3,6 +3,7 @@
 
 #include "librbd/io/QosImageDispatch.h"
 #include "common/dout.h"
+#include "common/perf_counters.h"
 #include "librbd/AsioEngine.h"
 #include "librbd/ImageCtx.h"
 #include "librbd/io/FlushTracker.h"
@@ -290,6 +291,14 @@ bool QosImageDispatch<I>::needs_throttle(
   *dispatch_result = DISPATCH_RESULT_CONTINUE;
 
   auto qos_enabled_flag = m_qos_enabled_flag;
+  if (qos_enabled_flag == 0) {
+    // no limits configured: mark every throttle as passed in one go
+    image_dispatch_flags->fetch_or(IMAGE_DISPATCH_FLAG_QOS_MASK);
+    return false;
+  }
+
+  auto start_time = ceph_clock_now();
+  bool throttled = false;
   for (auto [flag, throttle] : m_throttles) {
     if ((qos_enabled_flag & flag) == 0) {
       all_qos_flags_set = set_throttle_flag(image_dispatch_flags, flag);
@@ -299,14 +308,19 @@ bool QosImageDispatch<I>::needs_throttle(
     auto tokens = calculate_tokens(read_op, extent_length, flag);
     if (tokens > 0 &&
         throttle->get(tokens, this, &QosImageDispatch<I>::handle_throttle_ready,
-                      Tag{image_dispatch_flags, on_dispatched}, flag)) {
+                      Tag{image_dispatch_flags, on_dispatched, start_time},
+                      flag)) {
       ldout(cct, 15) << "on_dispatched=" << on_dispatched << ", "
                      << "flag=" << flag << dendl;
       all_qos_flags_set = false;
+      throttled = true;
     } else {
       all_qos_flags_set = set_throttle_flag(image_dispatch_flags, flag);
     }
   }
+  if (throttled && m_image_ctx->perfcounter != nullptr) {
+    m_image_ctx->perfcounter->inc(l_librbd_qos_throttled);
+  }
   return !all_qos_flags_set;
 }
 
@@ -317,6 +331,10 @@ void QosImageDispatch<I>::handle_throttle_ready(Tag&& tag, uint64_t flag) {
                  << "flag=" << flag << dendl;
 
   if (set_throttle_flag(tag.image_dispatch_flags, flag)) {
+    if (m_image_ctx->perfcounter != nullptr) {
+      m_image_ctx->perfcounter->tinc(l_librbd_qos_throttle_latency,
+                                     ceph_clock_now() - tag.start_time);
+    }
     // timer_lock is held -- so dispatch from outside the timer thread
     m_image_ctx->asio_engine->post(tag.on_dispatched, 0);
   }
@@ -10,6 +10,7 @@
 #include "librbd/io/ImageDispatchInterface.h"
 #include "include/int_types.h"
 #include "include/buffer.h"
+#include "include/utime.h"
 #include "common/zipkin_trace.h"
 #include "common/Throttle.h"
 #include "librbd/io/ReadResult.h"
@@ -32,10 +33,12 @@ public:
   struct Tag {
     std::atomic<uint32_t>* image_dispatch_flags;
     Context* on_dispatched;
+    utime_t start_time;
 
-    Tag(std::atomic<uint32_t>* image_dispatch_flags, Context* on_dispatched)
+    Tag(std::atomic<uint32_t>* image_dispatch_flags, Context* on_dispatched,
+        utime_t start_time)
       : image_dispatch_flags(image_dispatch_flags),
-        on_dispatched(on_dispatched) {
+        on_dispatched(on_dispatched), start_time(start_time) {
     }
   };
 
@@ -56,6 +56,12 @@ public:
         // can skip because the object already exists
         return 1;
       }
+      if (!parent_object_may_exist()) {
+        // nothing to copy up -- the object would remain a hole anyway
+        ldout(cct, 20) << "skipping object " << m_object_no << " which "
+                       << "does not exist in the parent" << dendl;
+        return 1;
+      }
     }
 
     if (!io::util::trigger_copyup(
@@ -71,6 +77,40 @@ public:
 private:
   IOContext m_io_context;
   uint64_t m_object_no;
+
+  bool parent_object_may_exist() {
+    I &image_ctx = this->m_image_ctx;
+    ceph_assert(ceph_mutex_is_locked(image_ctx.image_lock));
+
+    auto parent = image_ctx.parent;
+    if (parent == nullptr) {
+      // let the copyup notice that the parent went away
+      return true;
+    }
+
+    std::shared_lock parent_image_lock{parent->image_lock};
+    if (parent->object_map == nullptr || parent->parent != nullptr) {
+      // without an object map, or if the parent is itself a clone, the data
+      // could be anywhere up the chain
+      return true;
+    }
+
+    auto [image_extents, area] = io::util::object_to_area_extents(
+      &image_ctx, m_object_no, {{0, image_ctx.layout.object_size}});
+    striper::LightweightObjectExtents parent_extents;
+    for (auto [off, len] : image_extents) {
+      io::util::area_to_object_extents(parent, off, len, area, 0,
+                                       &parent_extents);
+    }
+    for (auto& extent : parent_extents) {
+      // past the end of the parent there is nothing to copy
+      if (extent.object_no < parent->object_map->size() &&
+          parent->object_map->object_may_exist(extent.object_no)) {
+        return true;
+      }
+    }
+    return false;
+  }
 };
 
 template <typename I>
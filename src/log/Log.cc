@@ -39,6 +39,25 @@ namespace logging {
 
 static OnExitManager exit_callbacks;
 
+static std::atomic<uint64_t> next_log_id = {0};
+
+// set once this thread's ThreadQueues are destroyed, so that entries
+// logged by later thread_local destructors take the locked path
+static thread_local bool thread_queues_gone = false;
+
+/// this thread's queues, one per Log it logged to
+struct ThreadQueues {
+  std::vector<std::pair<uint64_t, std::shared_ptr<Log::ThreadQueue>>> queues;
+
+  ~ThreadQueues() {
+    thread_queues_gone = true;
+    for (auto& [id, q] : queues) {
+      // the flusher drops the queue once it is drained
+      q->exited = true;
+    }
+  }
+};
+
 static void log_on_exit(void *p)
 {
   Log *l = *(Log **)p;
@@ -50,7 +69,8 @@ static void log_on_exit(void *p)
 Log::Log(const SubsystemMap *s)
   : m_indirect_this(nullptr),
     m_subs(s),
-    m_recent(DEFAULT_MAX_RECENT)
+    m_recent(DEFAULT_MAX_RECENT),
+    m_id(next_log_id++)
 {
   m_log_buf.reserve(MAX_LOG_BUF);
   _configure_stderr();
@@ -138,6 +158,12 @@ void Log::set_max_recent(std::size_t n)
   m_recent.set_capacity(n);
 }
 
+void Log::set_thread_queue_size(std::size_t n)
+{
+  // queues that already exist keep their size
+  m_thread_queue_size = n;
+}
+
 void Log::set_log_file(std::string_view fn)
 {
   std::scoped_lock lock(m_flush_mutex);
@@ -249,12 +275,18 @@ void Log::stop_journald_logger()
 
 void Log::submit_entry(Entry&& e)
 {
-  std::unique_lock lock(m_queue_mutex);
-  m_queue_mutex_holder = pthread_self();
-
   if (unlikely(m_inject_segv))
     *(volatile int *)(0) = 0xdead;
 
+  if (m_thread_queue_size.load(std::memory_order_relaxed) &&
+      is_started() &&
+      _submit_thread_queue(e)) {
+    return;
+  }
+
+  std::unique_lock lock(m_queue_mutex);
+  m_queue_mutex_holder = pthread_self();
+
   // wait for flush to catch up
   while (is_started() &&
 	 m_new.size() > m_max_new) {
@@ -267,11 +299,96 @@ void Log::submit_entry(Entry&& e)
   m_queue_mutex_holder = 0;
 }
 
-void Log::flush()
+Log::ThreadQueue *Log::_get_thread_queue()
 {
-  std::scoped_lock lock1(m_flush_mutex);
-  m_flush_mutex_holder = pthread_self();
+  if (thread_queues_gone) {
+    return nullptr;
+  }
+  static thread_local ThreadQueues tq;
+  for (auto& [id, q] : tq.queues) {
+    if (id == m_id) {
+      return q.get();
+    }
+  }
+  // forget the queues of logs that are gone
+  std::erase_if(tq.queues, [](const auto& p) {
+    return p.second.use_count() == 1;
+  });
+  auto q = std::make_shared<ThreadQueue>(m_thread_queue_size.load());
+  {
+    std::scoped_lock lock(m_queue_mutex);
+    m_thread_queues.push_back(q);
+  }
+  tq.queues.emplace_back(m_id, q);
+  return q.get();
+}
 
+bool Log::_submit_thread_queue(Entry& e)
+{
+  ThreadQueue *q = _get_thread_queue();
+  if (!q || q->slots.empty()) {
+    return false;
+  }
+  const std::size_t n = q->slots.size();
+  const std::size_t t = q->tail.load(std::memory_order_relaxed);
+  if (t - q->head.load(std::memory_order_acquire) >= n) {
+    // wait for flush to catch up
+    std::unique_lock lock(m_queue_mutex);
+    m_queue_mutex_holder = pthread_self();
+    while (t - q->head.load(std::memory_order_acquire) >= n) {
+      if (m_stop) {
+	m_queue_mutex_holder = 0;
+	return false;
+      }
+      m_cond_flusher.notify_all();
+      m_cond_loggers.wait(lock);
+    }
+    m_queue_mutex_holder = 0;
+  }
+  q->slots[t % n].emplace(e);
+  q->tail.store(t + 1, std::memory_order_release);
+  if (t + 1 - q->head.load(std::memory_order_relaxed) == n / 2 + 1) {
+    // otherwise the flusher picks it up on its next poll
+    m_cond_flusher.notify_one();
+  }
+  return true;
+}
+
+bool Log::_drain_thread_queues(EntryVector& out)
+{
+  std::vector<std::shared_ptr<ThreadQueue>> queues;
+  {
+    std::scoped_lock lock(m_queue_mutex);
+    if (m_thread_queues.empty()) {
+      return false;
+    }
+    queues = m_thread_queues;
+  }
+  bool drained = false;
+  for (auto& q : queues) {
+    const std::size_t n = q->slots.size();
+    std::size_t h = q->head.load(std::memory_order_relaxed);
+    const std::size_t t = q->tail.load(std::memory_order_acquire);
+    for (; h != t; ++h) {
+      auto& slot = q->slots[h % n];
+      out.emplace_back(std::move(*slot));
+      slot.reset();
+      drained = true;
+    }
+    q->head.store(h, std::memory_order_release);
+  }
+  std::scoped_lock lock(m_queue_mutex);
+  m_queue_mutex_holder = pthread_self();
+  std::erase_if(m_thread_queues, [](const auto& q) {
+    return q->exited && q->head == q->tail;
+  });
+  m_cond_loggers.notify_all();
+  m_queue_mutex_holder = 0;
+  return drained;
+}
+
+void Log::_collect_new()
+{
   {
     std::scoped_lock lock2(m_queue_mutex);
     m_queue_mutex_holder = pthread_self();
@@ -280,6 +397,21 @@ void Log::flush()
     m_cond_loggers.notify_all();
     m_queue_mutex_holder = 0;
   }
+  if (_drain_thread_queues(m_flush)) {
+    // interleave the threads' entries in time, as a shared queue would
+    std::stable_sort(m_flush.begin(), m_flush.end(),
+		     [](const auto& a, const auto& b) {
+		       return a.m_stamp < b.m_stamp;
+		     });
+  }
+}
+
+void Log::flush()
+{
+  std::scoped_lock lock1(m_flush_mutex);
+  m_flush_mutex_holder = pthread_self();
+
+  _collect_new();
 
   _flush(m_flush, false);
   m_flush_mutex_holder = 0;
@@ -482,13 +614,7 @@ void Log::dump_recent()
   std::scoped_lock lock1(m_flush_mutex);
   m_flush_mutex_holder = pthread_self();
 
-  {
-    std::scoped_lock lock2(m_queue_mutex);
-    m_queue_mutex_holder = pthread_self();
-    assert(m_flush.empty());
-    m_flush.swap(m_new);
-    m_queue_mutex_holder = 0;
-  }
+  _collect_new();
 
   _flush(m_flush, false);
 
@@ -566,7 +692,10 @@ void *Log::entry()
     std::unique_lock lock(m_queue_mutex);
     m_queue_mutex_holder = pthread_self();
     while (!m_stop) {
-      if (!m_new.empty()) {
+      bool queued = std::any_of(
+	m_thread_queues.begin(), m_thread_queues.end(),
+	[](const auto& q) { return q->exited || q->head != q->tail; });
+      if (!m_new.empty() || queued) {
         m_queue_mutex_holder = 0;
         lock.unlock();
         flush();
@@ -575,7 +704,12 @@ void *Log::entry()
         continue;
       }
 
-      m_cond_flusher.wait(lock);
+      if (m_thread_queues.empty()) {
+	m_cond_flusher.wait(lock);
+      } else {
+	// producers only wake us when their queue is half full
+	m_cond_flusher.wait_for(lock, std::chrono::milliseconds(10));
+      }
     }
     m_queue_mutex_holder = 0;
   }
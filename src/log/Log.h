@@ -6,9 +6,11 @@
 
 #include <boost/circular_buffer.hpp>
 
+#include <atomic>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <string>
 #include <string_view>
@@ -42,6 +44,9 @@ public:
   void set_coarse_timestamps(bool coarse);
   void set_max_new(std::size_t n);
   void set_max_recent(std::size_t n);
+  /// entries each logging thread may queue without taking the log lock;
+  /// 0 to disable per-thread queues
+  void set_thread_queue_size(std::size_t n);
   void set_log_file(std::string_view fn);
   void reopen_log_file();
   void chown_log_file(uid_t uid, gid_t gid);
@@ -87,6 +92,16 @@ protected:
 private:
   using EntryRing = boost::circular_buffer<ConcreteEntry>;
 
+  /// single producer (the logging thread), single consumer (the flusher)
+  struct ThreadQueue {
+    explicit ThreadQueue(std::size_t n) : slots(n) {}
+    std::vector<std::optional<ConcreteEntry>> slots;
+    alignas(64) std::atomic<std::size_t> head = {0};  ///< next slot to drain
+    alignas(64) std::atomic<std::size_t> tail = {0};  ///< next slot to fill
+    std::atomic<bool> exited = {false};   ///< the producer is gone
+  };
+  friend struct ThreadQueues;
+
   static const std::size_t DEFAULT_MAX_NEW = 100;
   static const std::size_t DEFAULT_MAX_RECENT = 10000;
 
@@ -132,10 +147,21 @@ private:
 
   std::size_t m_max_new = DEFAULT_MAX_NEW;
 
+  const uint64_t m_id;  ///< tells us apart in the threads' queue lists
+  std::atomic<std::size_t> m_thread_queue_size = {0};
+  std::vector<std::shared_ptr<ThreadQueue>> m_thread_queues;  ///< under m_queue_mutex
+
   bool m_inject_segv = false;
 
   void *entry() override;
 
+  ThreadQueue *_get_thread_queue();
+  bool _submit_thread_queue(Entry& e);
+  /// move what the threads queued to @q; takes m_queue_mutex
+  bool _drain_thread_queues(EntryVector& q);
+  /// m_new and the thread queues to m_flush
+  void _collect_new();
+
   void _log_safe_write(std::string_view sv);
   void _flush_logbuf();
   void _log_message(std::string_view s, bool crash);
@@ -14,6 +14,9 @@
 
 #include <limits.h>
 
+#include <fstream>
+#include <thread>
+
 using namespace std;
 using namespace ceph::logging;
 
@@ -170,6 +173,50 @@ TEST(Log, ManyGather)
   log.stop();
 }
 
+TEST(Log, ThreadQueues)
+{
+  SubsystemMap subs;
+  subs.set_log_level(1, 20);
+  subs.set_gather_level(1, 10);
+  Log log(&subs);
+  log.set_thread_queue_size(64);
+  log.start();
+  log.set_log_file("threads");
+  log.reopen_log_file();
+  const int nthreads = 8, per_thread = 10000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nthreads; t++) {
+    threads.emplace_back([&log, t] {
+      for (int i = 0; i < per_thread; i++) {
+	MutableEntry e(10, 1);
+	e.get_ostream() << "thread " << t << " entry " << i;
+	log.submit_entry(std::move(e));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  log.flush();
+  log.stop();
+
+  // nothing lost, and each thread's entries in order
+  std::ifstream in("threads");
+  std::vector<int> next(nthreads, 0);
+  int lines = 0;
+  for (std::string line; std::getline(in, line); ) {
+    int t, i;
+    auto p = line.find("thread ");
+    ASSERT_NE(std::string::npos, p);
+    ASSERT_EQ(2, sscanf(line.c_str() + p, "thread %d entry %d", &t, &i));
+    ASSERT_EQ(next[t], i);
+    next[t]++;
+    lines++;
+  }
+  ASSERT_EQ(nthreads * per_thread, lines);
+  unlink("threads");
+}
+
 static void readpipe(int fd, int verify)
 {
   while (1) {
@@ -918,6 +918,19 @@ void MDBalancer::try_rebalance(balance_state_t& state)
     return;
   }
 
+  last_decisions.clear();
+  num_exports = 0;
+
+  auto now = clock::now();
+  auto settle = ceph::make_timespan(
+    g_conf().get_val<double>("mds_bal_export_settle_time"));
+  for (auto p = recent_imports.begin(); p != recent_imports.end(); ) {
+    if (now - p->second >= settle)
+      p = recent_imports.erase(p);
+    else
+      ++p;
+  }
+
   // make a sorted list of my imports
   multimap<double, CDir*> import_pop_map;
   multimap<mds_rank_t, pair<CDir*, double> > import_from_map;
@@ -933,13 +946,19 @@ void MDBalancer::try_rebalance(balance_state_t& state)
 
     mds_rank_t from = diri->authority().first;
     double pop = dir->pop_auth_subtree.meta_load();
+    if (is_settling(dir, now)) {
+      dout(7) << " not moving recently imported " << *dir << " pop " << pop
+	      << dendl;
+      last_decisions.push_back({dir->dirfrag(), MDS_RANK_NONE, pop, "settling"});
+      continue;
+    }
     if (g_conf()->mds_bal_idle_threshold > 0 &&
 	pop < g_conf()->mds_bal_idle_threshold &&
 	diri != mds->mdcache->get_root() &&
 	from != mds->get_nodeid()) {
       dout(5) << " exporting idle (" << pop << ") import " << *dir
 	      << " back to mds." << from << dendl;
-      mds->mdcache->migrator->export_dir_nicely(dir, from);
+      export_dir(dir, from, pop, "export_idle");
       continue;
     }
 
@@ -988,7 +1007,7 @@ void MDBalancer::try_rebalance(balance_state_t& state)
 	if (pop <= amount-have) {
 	  dout(7) << "reexporting " << *dir << " pop " << pop
 		  << " back to mds." << target << dendl;
-	  mds->mdcache->migrator->export_dir_nicely(dir, target);
+	  export_dir(dir, target, pop, "reexport_to_origin");
 	  have += pop;
 	  import_from_map.erase(plast);
 	  for (auto q = import_pop_map.equal_range(pop);
@@ -1032,7 +1051,7 @@ void MDBalancer::try_rebalance(balance_state_t& state)
 	dout(5) << "reexporting " << *dir << " pop " << pop
 		<< " to mds." << target << dendl;
 	have += pop;
-	mds->mdcache->migrator->export_dir_nicely(dir, target);
+	export_dir(dir, target, pop, "reexport");
 	import_pop_map.erase(p++);
       } else {
 	++p;
@@ -1071,7 +1090,7 @@ void MDBalancer::try_rebalance(balance_state_t& state)
       dout(5) << "   - exporting " << dir->pop_auth_subtree
 	      << " " << dir->pop_auth_subtree.meta_load()
 	      << " to mds." << target << " " << *dir << dendl;
-      mds->mdcache->migrator->export_dir_nicely(dir, target);
+      export_dir(dir, target, dir->pop_auth_subtree.meta_load(), "export");
     }
   }
 
@@ -1079,6 +1098,30 @@ void MDBalancer::try_rebalance(balance_state_t& state)
   mds->mdcache->show_subtrees();
 }
 
+bool MDBalancer::is_settling(CDir *dir, time now) const
+{
+  auto p = recent_imports.find(dir->dirfrag());
+  return p != recent_imports.end() &&
+    now - p->second < ceph::make_timespan(
+      g_conf().get_val<double>("mds_bal_export_settle_time"));
+}
+
+bool MDBalancer::export_dir(CDir *dir, mds_rank_t target, double pop,
+			    std::string_view why)
+{
+  auto max_exports = g_conf().get_val<uint64_t>("mds_bal_max_exports");
+  if (max_exports && num_exports >= max_exports) {
+    dout(7) << " export budget of " << max_exports << " spent, not exporting "
+	    << *dir << " to mds." << target << dendl;
+    last_decisions.push_back({dir->dirfrag(), target, pop, "throttled"});
+    return false;
+  }
+  num_exports++;
+  last_decisions.push_back({dir->dirfrag(), target, pop, why});
+  mds->mdcache->migrator->export_dir_nicely(dir, target);
+  return true;
+}
+
 void MDBalancer::find_exports(CDir *dir,
                               double amount,
                               std::vector<CDir*>* exports,
@@ -1359,6 +1402,8 @@ void MDBalancer::subtract_export(CDir *dir)
 
 void MDBalancer::add_import(CDir *dir)
 {
+  recent_imports[dir->dirfrag()] = clock::now();
+
   dirfrag_load_vec_t subload = dir->pop_auth_subtree;
 
   while (true) {
@@ -1510,6 +1555,30 @@ int MDBalancer::dump_loads(Formatter *f, int64_t depth) const
   }
   f->close_section(); // mds_import_map
 
+  f->open_object_section("balancer");
+  {
+    auto now = clock::now();
+    f->open_array_section("recent_imports");
+    for (auto& [df, when] : recent_imports) {
+      f->open_object_section("import");
+      f->dump_stream("dirfrag") << df;
+      f->dump_float("age", std::chrono::duration<double>(now - when).count());
+      f->close_section();
+    }
+    f->close_section(); // recent_imports
+    f->open_array_section("last_decisions");
+    for (auto& d : last_decisions) {
+      f->open_object_section("decision");
+      f->dump_stream("dirfrag") << d.dirfrag;
+      f->dump_int("target", d.target);
+      f->dump_float("pop", d.pop);
+      f->dump_string("action", d.action);
+      f->close_section();
+    }
+    f->close_section(); // last_decisions
+  }
+  f->close_section(); // balancer
+
   f->close_section(); // loads
   return 0;
 }
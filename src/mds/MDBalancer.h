@@ -119,6 +119,12 @@ private:
   void try_rebalance(balance_state_t& state);
   bool test_rank_mask(mds_rank_t rank);
 
+  /// true if dir was imported too recently to be moved on again
+  bool is_settling(CDir *dir, time now) const;
+  /// export unless this round's export budget is spent; logs the decision
+  bool export_dir(CDir *dir, mds_rank_t target, double pop,
+                  std::string_view why);
+
   bool bal_fragment_dirs;
   int64_t bal_fragment_interval;
   static const unsigned int AUTH_TREES_THRESHOLD = 5;
@@ -156,5 +162,20 @@ private:
   // per-epoch state
   double my_load = 0;
   double target_load = 0;
+
+  // subtrees imported recently, by import time.  They are not exported
+  // again until mds_bal_export_settle_time has passed, so that a busy
+  // subtree does not bounce between ranks.
+  std::map<dirfrag_t, time> recent_imports;
+
+  // what the last rebalance round did and why, for "dump loads"
+  struct decision_t {
+    dirfrag_t dirfrag;
+    mds_rank_t target;
+    double pop;
+    std::string_view action;
+  };
+  std::vector<decision_t> last_decisions;
+  unsigned num_exports = 0;  ///< in this round
 };
 #endif
@@ -69,6 +69,10 @@ void MDLog::create_logger()
   plb.add_u64_counter(l_mdl_replayed, "replayed", "Events replayed",
 		      "repl", PerfCountersBuilder::PRIO_INTERESTING);
   plb.add_time_avg(l_mdl_jlat, "jlat", "Journaler flush latency");
+  plb.add_time_avg(l_mdl_jhlat, "jhlat", "Journaler head write latency");
+  plb.add_time_avg(l_mdl_jrlat, "jrlat", "Journaler object read latency");
+  plb.add_time_avg(l_mdl_evqlat, "evqlat",
+                   "Time events wait in the submit queue");
   plb.add_u64_counter(l_mdl_evex, "evex", "Total expired events");
   plb.add_u64_counter(l_mdl_evtrm, "evtrm", "Trimmed events");
   plb.add_u64_counter(l_mdl_segadd, "segadd", "Segments added");
@@ -166,6 +170,7 @@ void MDLog::create(MDSContext *c)
   journaler = new Journaler("mdlog", ino, mds->get_metadata_pool(),
                             CEPH_FS_ONDISK_MAGIC, mds->objecter, logger,
                             l_mdl_jlat, mds->finisher);
+  journaler->set_latency_keys(l_mdl_jhlat, l_mdl_jrlat);
   ceph_assert(journaler->is_readonly());
   journaler->set_write_error_handler(new C_MDL_WriteError(this));
   journaler->set_writeable();
@@ -358,15 +363,30 @@ void MDLog::_submit_thread()
 
   std::unique_lock locker{submit_mutex};
 
+  // flush requests are deferred while more events are queued, so that a
+  // burst of events goes out in a few large journal writes
+  uint64_t deferred_flushes = 0;
+  auto flush_deferred = [&] {
+    if (deferred_flushes) {
+      deferred_flushes = 0;
+      locker.unlock();
+      journaler->flush();
+      locker.lock();
+    }
+  };
+
   while (!mds->is_daemon_stopping()) {
     if (g_conf()->mds_log_pause) {
+      flush_deferred();
       submit_cond.wait(locker);
       continue;
     }
 
     map<uint64_t,list<PendingEvent> >::iterator it = pending_events.begin();
     if (it == pending_events.end()) {
-      submit_cond.wait(locker);
+      flush_deferred();
+      if (pending_events.empty())
+        submit_cond.wait(locker);
       continue;
     }
 
@@ -379,8 +399,18 @@ void MDLog::_submit_thread()
     PendingEvent data = it->second.front();
     it->second.pop_front();
 
+    bool do_flush = false;
+    if (data.flush &&
+        ++deferred_flushes >= g_conf()->mds_log_group_flush_events) {
+      deferred_flushes = 0;
+      do_flush = true;
+    }
+
     locker.unlock();
 
+    if (logger)
+      logger->tinc(l_mdl_evqlat, ceph::mono_clock::now() - data.queued);
+
     if (data.le) {
       LogEvent *le = data.le;
       LogSegment *ls = le->_segment;
@@ -412,7 +442,7 @@ void MDLog::_submit_thread()
 
       journaler->wait_for_flush(fin);
 
-      if (data.flush)
+      if (do_flush)
 	journaler->flush();
 
       if (logger)
@@ -428,7 +458,7 @@ void MDLog::_submit_thread()
 	fin2->set_write_pos(journaler->get_write_pos());
 	journaler->wait_for_flush(fin2);
       }
-      if (data.flush)
+      if (do_flush)
 	journaler->flush();
     }
 
@@ -438,6 +468,7 @@ void MDLog::_submit_thread()
     else if (data.le)
       unflushed++;
   }
+  flush_deferred();
 }
 
 void MDLog::wait_for_safe(MDSContext *c)
@@ -1048,6 +1079,7 @@ void MDLog::_recovery_thread(MDSContext *completion)
   Journaler *front_journal = new Journaler("mdlog", jp.front,
       mds->get_metadata_pool(), CEPH_FS_ONDISK_MAGIC, mds->objecter,
       logger, l_mdl_jlat, mds->finisher);
+  front_journal->set_latency_keys(l_mdl_jhlat, l_mdl_jrlat);
 
   // Assign to ::journaler so that we can be aborted by ::shutdown while
   // waiting for journaler recovery
@@ -1133,6 +1165,7 @@ void MDLog::_reformat_journal(JournalPointer const &jp_in, Journaler *old_journa
   /* Create the new Journaler file */
   Journaler *new_journal = new Journaler("mdlog", jp.back,
       mds->get_metadata_pool(), CEPH_FS_ONDISK_MAGIC, mds->objecter, logger, l_mdl_jlat, mds->finisher);
+  new_journal->set_latency_keys(l_mdl_jhlat, l_mdl_jrlat);
   dout(4) << "Writing new journal header " << jp.back << dendl;
   file_layout_t new_layout = old_journal->get_layout();
   new_journal->set_writeable();
@@ -1295,9 +1328,37 @@ void MDLog::_replay_thread()
 {
   dout(10) << "_replay_thread start" << dendl;
 
+  // Events are read and decoded without mds_lock, then replayed under it
+  // in batches of whatever is readable without waiting, so that we do
+  // not hand the lock back and forth for every event.
+  const uint64_t replay_batch = std::max<uint64_t>(
+    1, g_conf().get_val<uint64_t>("mds_log_replay_batch"));
+  std::vector<std::unique_ptr<LogEvent>> pending;
+  auto replay_pending = [this, &pending] {
+    if (pending.empty()) {
+      return true;
+    }
+    std::lock_guard l(mds->mds_lock);
+    if (mds->is_daemon_stopping()) {
+      return false;
+    }
+    for (auto& le : pending) {
+      logger->inc(l_mdl_replayed);
+      le->replay(mds);
+    }
+    pending.clear();
+    return true;
+  };
+
   // loop
   int r = 0;
   while (1) {
+    if (pending.size() >= replay_batch || !journaler->is_readable()) {
+      if (!replay_pending()) {
+        return;
+      }
+    }
+
     // wait for read?
     journaler->check_isreadable(); 
     if (journaler->get_error()) {
@@ -1420,19 +1481,14 @@ void MDLog::_replay_thread()
       le->_segment->num_events++;
       le->_segment->end = journaler->get_read_pos();
       num_events++;
-
-      {
-        std::lock_guard l(mds->mds_lock);
-        if (mds->is_daemon_stopping()) {
-          return;
-        }
-        logger->inc(l_mdl_replayed);
-        le->replay(mds);
-      }
+      pending.push_back(std::move(le));
     }
 
     logger->set(l_mdl_rdpos, pos);
   }
+  if (!replay_pending()) {
+    return;
+  }
 
   // done!
   if (r == 0) {
@@ -36,6 +36,9 @@ enum {
   l_mdl_rdpos,
   l_mdl_jlat,
   l_mdl_replayed,
+  l_mdl_jhlat,
+  l_mdl_jrlat,
+  l_mdl_evqlat,
   l_mdl_last,
 };
 
@@ -178,10 +181,12 @@ public:
 
 protected:
   struct PendingEvent {
-    PendingEvent(LogEvent *e, MDSContext *c, bool f=false) : le(e), fin(c), flush(f) {}
+    PendingEvent(LogEvent *e, MDSContext *c, bool f=false)
+      : le(e), fin(c), flush(f), queued(ceph::mono_clock::now()) {}
     LogEvent *le;
     MDSContext *fin;
     bool flush;
+    ceph::mono_time queued;
   };
 
   // -- replay --
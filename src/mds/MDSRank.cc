@@ -727,6 +727,9 @@ void MDSRankDispatcher::tick()
 
   check_ops_in_flight();
 
+  // the cache object counts; not worth refreshing on every dispatch
+  update_mlogger();
+
   // Wake up thread in case we use to be laggy and have waiting_for_nolaggy
   // messages to progress.
   progress_thread.signal();
@@ -1074,13 +1077,6 @@ bool MDSRank::_dispatch(const cref_t<Message> &m, bool new_msg)
   }
 
   // hack: thrash exports
-  static utime_t start;
-  utime_t now = ceph_clock_now();
-  if (start == utime_t())
-    start = now;
-  /*double el = now - start;
-  if (el > 30.0 &&
-    el < 60.0)*/
   for (int i=0; i<g_conf()->mds_thrash_exports; i++) {
     set<mds_rank_t> s;
     if (!is_active()) break;
@@ -1146,7 +1142,6 @@ bool MDSRank::_dispatch(const cref_t<Message> &m, bool new_msg)
   }
   */
 
-  update_mlogger();
   return true;
 }
 
@@ -3807,6 +3802,8 @@ const char** MDSRankDispatcher::get_tracked_conf_keys() const
     "mds_forward_all_requests_to_auth",
     "mds_max_purge_ops",
     "mds_max_purge_ops_per_pg",
+    "mds_purge_target_latency",
+    "mds_purge_nearfull_boost",
     "mds_max_snaps_per_dir",
     "mds_op_complaint_time",
     "mds_op_history_duration",
@@ -3825,6 +3822,7 @@ const char** MDSRankDispatcher::get_tracked_conf_keys() const
     "mds_cap_acquisition_throttle_retry_request_time",
     "mds_alternate_name_max",
     "mds_dir_max_entries",
+    "mds_readdir_prefetch_frags",
     "mds_symlink_recovery",
     "mds_extraordinary_events_dump_interval",
     "mds_inject_rename_corrupt_dentry_first",
@@ -735,6 +735,7 @@ void OpenFileTable::_read_omap_values(const std::string& key, unsigned idx,
     dout(10) << __func__ << ": load from '" << oid << ":" << key << "'" << dendl;
     object_locator_t oloc(mds->get_metadata_pool());
     C_IO_OFT_Load *c = new C_IO_OFT_Load(this, idx, first);
+    ++num_pending_load;
     ObjectOperation op;
     if (first)
       op.omap_get_header(&c->header_bl, &c->header_r);
@@ -773,10 +774,18 @@ void OpenFileTable::_load_finish(int op_r, int header_r, int values_r,
       ++omap_num_items[idx];
   };
 
+  ceph_assert(num_pending_load > 0);
+  --num_pending_load;
+  if (load_err < 0) {
+    // another object failed to load; wait for the rest, then give up
+    err = load_err;
+    goto fail;
+  }
+
   if (op_r < 0) {
     derr << __func__ << " got " << cpp_strerror(op_r) << dendl;
     err = op_r;
-    goto out;
+    goto fail;
   }
 
   try {
@@ -836,11 +845,9 @@ void OpenFileTable::_load_finish(int op_r, int header_r, int values_r,
 	if (idx >= loaded_journals.size())
 	  loaded_journals.resize(idx + 1);
 
-	if (journal_state == JOURNAL_FINISH) {
-	  loaded_journals[idx][it.first].swap(it.second);
-	} else { // incomplete journal
-	  loaded_journals[idx][it.first].length();
-	}
+	// keep it even if the headers read so far say the journal is
+	// incomplete; it is only replayed if it is complete per all of them
+	loaded_journals[idx][it.first].swap(it.second);
 	continue;
       }
 
@@ -850,20 +857,17 @@ void OpenFileTable::_load_finish(int op_r, int header_r, int values_r,
     }
   } catch (buffer::error &e) {
     derr << __func__ << ": corrupted header/values: " << e.what() << dendl;
-    goto out;
+    goto fail;
   }
 
-  if (more || idx + 1 < omap_num_objs) {
-    // Issue another read if we're not at the end of the omap
-    std::string last_key;
-    if (more)
-      last_key = values.rbegin()->first;
-    else
-      idx++;
-
-    _read_omap_values(last_key, idx, !more);
+  // Issue another read if we're not at the end of this object's omap, and
+  // start on the objects the header told us about
+  if (more)
+    _read_omap_values(values.rbegin()->first, idx, false);
+  while (num_load_objs < omap_num_objs)
+    _read_omap_values("", num_load_objs++, true);
+  if (num_pending_load > 0)
     return;
-  }
 
   // replay journal
   if (loaded_journals.size() > 0) {
@@ -920,7 +924,7 @@ void OpenFileTable::_load_finish(int op_r, int header_r, int values_r,
 	}
       } catch (buffer::error &e) {
 	derr << __func__ << ": corrupted journal: " << e.what() << dendl;
-	goto out;
+	goto fail;
       }
 
       op_vec.resize(op_vec.size() + 1);
@@ -955,6 +959,12 @@ void OpenFileTable::_load_finish(int op_r, int header_r, int values_r,
   journal_state = JOURNAL_NONE;
   err = 0;
   dout(10) << __func__ << ": load complete" << dendl;
+  goto out;
+
+fail:
+  load_err = err;
+  if (num_pending_load > 0)
+    return;
 out:
 
   if (err < 0)
@@ -973,6 +983,7 @@ void OpenFileTable::load(MDSContext *onload)
     waiting_for_load.push_back(onload);
 
   _read_omap_values("", 0, true);
+  num_load_objs = 1;
 }
 
 void OpenFileTable::_get_ancestors(const Anchor& parent,
@@ -134,6 +134,10 @@ protected:
   std::map<inodeno_t, RecoveredAnchor> loaded_anchor_map;
   MDSContext::vec waiting_for_load;
   bool load_done = false;
+  // the objects are loaded in parallel
+  unsigned num_load_objs = 0;  ///< objects whose reads were started
+  unsigned num_pending_load = 0;
+  int load_err = 0;
 
   enum {
     DIR_INODES = 1,
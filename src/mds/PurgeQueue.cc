@@ -147,6 +147,7 @@ void PurgeQueue::create_logger()
   pcb.add_u64(l_pq_executing, "pq_executing", "Purge queue tasks in flight");
   pcb.add_u64(l_pq_executing_high_water, "pq_executing_high_water", "Maximum number of executing file purges");
   pcb.add_u64(l_pq_item_in_journal, "pq_item_in_journal", "Purge item left in journal");
+  pcb.add_u64(l_pq_ops_limit, "pq_ops_limit", "Current limit on purge ops in flight");
 
   logger.reset(pcb.create_perf_counters());
   g_ceph_context->get_perfcounters_collection()->add(logger.get());
@@ -394,11 +395,13 @@ bool PurgeQueue::_can_consume()
     return false;
   }
 
-  dout(20) << ops_in_flight << "/" << max_purge_ops << " ops, "
-           << in_flight.size() << "/" << g_conf()->mds_max_purge_files
+  const uint64_t ops_limit = _get_ops_limit();
+  const uint64_t files_limit = _get_files_limit();
+  dout(20) << ops_in_flight << "/" << ops_limit << " ops, "
+           << in_flight.size() << "/" << files_limit
            << " files" << dendl;
 
-  if (in_flight.size() == 0 && cct->_conf->mds_max_purge_files > 0) {
+  if (in_flight.size() == 0 && files_limit > 0) {
     // Always permit consumption if nothing is in flight, so that the ops
     // limit can never be so low as to forbid all progress (unless
     // administrator has deliberately paused purging by setting max
@@ -406,21 +409,73 @@ bool PurgeQueue::_can_consume()
     return true;
   }
 
-  if (ops_in_flight >= max_purge_ops) {
+  if (ops_in_flight >= ops_limit) {
     dout(20) << "Throttling on op limit " << ops_in_flight << "/"
-             << max_purge_ops << dendl;
+             << ops_limit << dendl;
     return false;
   }
 
-  if (in_flight.size() >= cct->_conf->mds_max_purge_files) {
+  if (in_flight.size() >= files_limit) {
     dout(20) << "Throttling on item limit " << in_flight.size()
-             << "/" << cct->_conf->mds_max_purge_files << dendl;
+             << "/" << files_limit << dendl;
     return false;
   } else {
     return true;
   }
 }
 
+uint64_t PurgeQueue::_get_ops_limit() const
+{
+  if (draining || adaptive_purge_ops == 0) {
+    return max_purge_ops;
+  }
+  return std::min(adaptive_purge_ops, max_purge_ops);
+}
+
+uint64_t PurgeQueue::_get_files_limit() const
+{
+  uint64_t limit = cct->_conf->mds_max_purge_files;
+  if (data_pool_nearfull) {
+    limit *= g_conf().get_val<double>("mds_purge_nearfull_boost");
+  }
+  return limit;
+}
+
+void PurgeQueue::_update_ops_limit(double latency)
+{
+  const double target = g_conf().get_val<double>("mds_purge_target_latency");
+  if (target <= 0) {
+    adaptive_purge_ops = 0;
+    purge_latency_avg = 0;
+    return;
+  }
+
+  if (purge_latency_avg == 0) {
+    purge_latency_avg = latency;
+  } else {
+    purge_latency_avg = 0.9 * purge_latency_avg + 0.1 * latency;
+  }
+  if (adaptive_purge_ops == 0) {
+    adaptive_purge_ops = max_purge_ops;
+  }
+
+  auto now = ceph::mono_clock::now();
+  if (purge_latency_avg > target) {
+    // Back off multiplicatively, but only once per target interval: the
+    // completions that arrive meanwhile were issued at the old limit.
+    if (now - last_ops_limit_cut > ceph::make_timespan(target)) {
+      adaptive_purge_ops = std::max<uint64_t>(1,
+	adaptive_purge_ops - adaptive_purge_ops / 4);
+      last_ops_limit_cut = now;
+      dout(10) << "purge latency " << purge_latency_avg << "s over target "
+	       << target << "s, op limit now " << adaptive_purge_ops << dendl;
+    }
+  } else if (latency <= target && adaptive_purge_ops < max_purge_ops) {
+    ++adaptive_purge_ops;
+  }
+  logger->set(l_pq_ops_limit, _get_ops_limit());
+}
+
 void PurgeQueue::_go_readonly(int r)
 {
   if (readonly) return;
@@ -562,8 +617,9 @@ void PurgeQueue::_commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_ve
 
   ceph_assert(gather.has_subs());
 
+  auto start = ceph::mono_clock::now();
   gather.set_finisher(new C_OnFinisher(
-	              new LambdaContext([this, expire_to](int r) {
+	              new LambdaContext([this, expire_to, start](int r) {
     std::lock_guard l(lock);
 
     if (r == -CEPHFS_EBLOCKLISTED) {
@@ -572,6 +628,8 @@ void PurgeQueue::_commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_ve
       return;
     }
 
+    _update_ops_limit(
+      std::chrono::duration<double>(ceph::mono_clock::now() - start).count());
     _execute_item_complete(expire_to);
     _consume();
 
@@ -748,11 +806,13 @@ void PurgeQueue::update_op_limit(const MDSMap &mds_map)
   }
 
   uint64_t pg_count = 0;
+  bool nearfull = false;
   objecter->with_osdmap([&](const OSDMap& o) {
     // Number of PGs across all data pools
     const std::vector<int64_t> &data_pools = mds_map.get_data_pools();
     for (const auto dp : data_pools) {
-      if (o.get_pg_pool(dp) == NULL) {
+      const pg_pool_t *pool = o.get_pg_pool(dp);
+      if (pool == NULL) {
         // It is possible that we have an older OSDMap than MDSMap,
         // because we don't start watching every OSDMap until after
         // MDSRank is initialized
@@ -760,6 +820,10 @@ void PurgeQueue::update_op_limit(const MDSMap &mds_map)
         continue;
       }
       pg_count += o.get_pg_num(dp);
+      if (pool->has_flag(pg_pool_t::FLAG_NEARFULL) ||
+	  pool->has_flag(pg_pool_t::FLAG_FULL)) {
+	nearfull = true;
+      }
     }
   });
 
@@ -772,12 +836,31 @@ void PurgeQueue::update_op_limit(const MDSMap &mds_map)
   if (cct->_conf->mds_max_purge_ops) {
     max_purge_ops = std::min(max_purge_ops, cct->_conf->mds_max_purge_ops);
   }
+
+  // Reclaiming space matters more than sparing the OSDs when the data
+  // pools are filling up.
+  if (nearfull != data_pool_nearfull) {
+    dout(4) << "data pools " << (nearfull ? "" : "no longer ")
+	    << "nearfull, " << (nearfull ? "boosting" : "restoring")
+	    << " purge limits" << dendl;
+    data_pool_nearfull = nearfull;
+  }
+  if (data_pool_nearfull) {
+    max_purge_ops *= g_conf().get_val<double>("mds_purge_nearfull_boost");
+  }
+
+  if (g_conf().get_val<double>("mds_purge_target_latency") <= 0) {
+    adaptive_purge_ops = 0;
+  }
+  logger->set(l_pq_ops_limit, _get_ops_limit());
 }
 
 void PurgeQueue::handle_conf_change(const std::set<std::string>& changed, const MDSMap& mds_map)
 {
   if (changed.count("mds_max_purge_ops")
-      || changed.count("mds_max_purge_ops_per_pg")) {
+      || changed.count("mds_max_purge_ops_per_pg")
+      || changed.count("mds_purge_target_latency")
+      || changed.count("mds_purge_nearfull_boost")) {
     update_op_limit(mds_map);
   } else if (changed.count("mds_max_purge_files")) {
     std::lock_guard l(lock);
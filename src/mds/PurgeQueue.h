@@ -16,6 +16,7 @@
 #define PURGE_QUEUE_H_
 
 #include "include/compact_set.h"
+#include "common/ceph_time.h"
 #include "common/Finisher.h"
 #include "mds/MDSMap.h"
 #include "osdc/Journaler.h"
@@ -91,6 +92,7 @@ enum {
   l_pq_executing_high_water,
   l_pq_executed,
   l_pq_item_in_journal,
+  l_pq_ops_limit,
   l_pq_last
 };
 
@@ -183,6 +185,9 @@ private:
   uint32_t _calculate_ops(const PurgeItem &item) const;
 
   bool _can_consume();
+  uint64_t _get_ops_limit() const;
+  uint64_t _get_files_limit() const;
+  void _update_ops_limit(double latency);
 
   // recover the journal write_pos (drop any partial written entry)
   void _recover();
@@ -228,6 +233,15 @@ private:
   // Dynamic op limit per MDS based on PG count
   uint64_t max_purge_ops = 0;
 
+  // Op limit adapted to the observed latency of purge ops, capped by
+  // max_purge_ops; only used when mds_purge_target_latency is set.
+  uint64_t adaptive_purge_ops = 0;
+  double purge_latency_avg = 0;
+  ceph::mono_time last_ops_limit_cut;
+
+  // Is any data pool nearfull or full?  If so, purge more aggressively.
+  bool data_pool_nearfull = false;
+
   // How many bytes were remaining when drain() was first called,
   // used for indicating progress.
   uint64_t drain_initial = 0;
@@ -273,6 +273,7 @@ Server::Server(MDSRank *m, MetricsHandler *metrics_handler) :
   caps_throttle_retry_request_timeout = g_conf().get_val<double>("mds_cap_acquisition_throttle_retry_request_timeout");
   dir_max_entries = g_conf().get_val<uint64_t>("mds_dir_max_entries");
   bal_fragment_size_max = g_conf().get_val<int64_t>("mds_bal_fragment_size_max");
+  readdir_prefetch_frags = g_conf().get_val<uint64_t>("mds_readdir_prefetch_frags");
   supported_features = feature_bitset_t(CEPHFS_FEATURES_MDS_SUPPORTED);
   supported_metric_spec = feature_bitset_t(CEPHFS_METRIC_FEATURES_ALL);
 }
@@ -1351,6 +1352,9 @@ void Server::handle_conf_change(const std::set<std::string>& changed) {
     dout(20) << __func__ << " max fragment size changed to "
             << bal_fragment_size_max << dendl;
   }
+  if (changed.count("mds_readdir_prefetch_frags")) {
+    readdir_prefetch_frags = g_conf().get_val<uint64_t>("mds_readdir_prefetch_frags");
+  }
   if (changed.count("mds_inject_rename_corrupt_dentry_first")) {
     inject_rename_corrupt_dentry_first = g_conf().get_val<double>("mds_inject_rename_corrupt_dentry_first");
   }
@@ -4024,6 +4028,32 @@ CDir* Server::try_open_auth_dirfrag(CInode *diri, frag_t fg, MDRequestRef& mdr)
   return dir;
 }
 
+/*
+ * Start loading the dirfrags that follow fg in readdir order, so that a
+ * client listing a large, fragmented directory does not wait for one
+ * dirfrag fetch after another.
+ */
+void Server::prefetch_readdir_frags(CInode *diri, frag_t fg)
+{
+  for (uint64_t i = 0; i < readdir_prefetch_frags; i++) {
+    if (fg.is_rightmost())
+      return;
+    fg = diri->dirfragtree[fg.next().value()];
+    CDir *dir = diri->get_dirfrag(fg);
+    if (!dir) {
+      if (!diri->is_auth() || diri->is_frozen())
+	return;
+      dir = diri->get_or_open_dirfrag(mdcache, fg);
+    }
+    if (!dir->is_auth())
+      return;
+    if (dir->is_complete() || dir->state_test(CDir::STATE_FETCHING))
+      continue;
+    dout(10) << __func__ << " " << *dir << dendl;
+    dir->fetch(nullptr);
+  }
+}
+
 
 // ===============================================================================
 // STAT
@@ -4905,6 +4935,8 @@ void Server::handle_client_readdir(MDRequestRef& mdr)
   dir->verify_fragstat();
 #endif
 
+  prefetch_readdir_frags(diri, dir->get_frag());
+
   utime_t now = ceph_clock_now();
   mdr->set_mds_stamp(now);
 
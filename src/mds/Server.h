@@ -199,6 +199,7 @@ public:
 	    rdlock_two_paths_xlock_destdn(MDRequestRef& mdr, bool xlock_srcdn);
 
   CDir* try_open_auth_dirfrag(CInode *diri, frag_t fg, MDRequestRef& mdr);
+  void prefetch_readdir_frags(CInode *diri, frag_t fg);
 
   // requests on existing inodes.
   void handle_client_getattr(MDRequestRef& mdr, bool is_lookup);
@@ -551,6 +552,7 @@ private:
   unsigned delegate_inos_pct = 0;
   uint64_t dir_max_entries = 0;
   int64_t bal_fragment_size_max = 0;
+  uint64_t readdir_prefetch_frags = 0;
 
   double inject_rename_corrupt_dentry_first = 0.0;
 
@@ -181,12 +181,61 @@ PyObject *ActivePyModules::get_daemon_status_python(
 
 void ActivePyModules::update_cache_metrics() {
     auto hit_miss_ratio = ttl_cache.get_hit_miss_ratio();
-    perfcounter->set(l_mgr_cache_hit, hit_miss_ratio.first);
-    perfcounter->set(l_mgr_cache_miss, hit_miss_ratio.second);
+    auto versioned_hit_miss_ratio = versioned_cache.get_hit_miss_ratio();
+    perfcounter->set(l_mgr_cache_hit, hit_miss_ratio.first +
+		     versioned_hit_miss_ratio.first);
+    perfcounter->set(l_mgr_cache_miss, hit_miss_ratio.second +
+		     versioned_hit_miss_ratio.second);
+}
+
+bool ActivePyModules::get_cache_version(const std::string &what,
+					std::pair<epoch_t, version_t> *version)
+{
+  // only the results that are a function of the osdmap and/or the pgmap
+  // alone; a zero stands for a map the result does not depend on
+  bool osdmap = what == "df" || what == "osd_pool_stats" ||
+    what == "osd_map" || what == "osd_map_tree" || what == "osd_map_crush" ||
+    what == "osdmap_crush_map_text";
+  bool pgmap = what == "df" || what == "osd_pool_stats" ||
+    what == "pg_summary" || what == "pg_status" || what == "pg_dump" ||
+    what == "pg_stats" || what == "pool_stats" || what == "osd_stats" ||
+    what == "osd_ping_times" || what == "io_rate";
+  if (!osdmap && !pgmap) {
+    return false;
+  }
+  without_gil_t no_gil;
+  version->first = osdmap ? cluster_state.with_osdmap([](const OSDMap &o) {
+    return o.get_epoch();
+  }) : 0;
+  version->second = pgmap ? cluster_state.with_pgmap([](const PGMap &p) {
+    return p.version;
+  }) : 0;
+  return true;
 }
 
 PyObject *ActivePyModules::cacheable_get_python(const std::string &what)
 {
+  if (g_conf().get_val<bool>("mgr_cache_by_version")) {
+    // the version is taken before the result is built, so a map that
+    // changes meanwhile only costs a rebuild on the next call
+    std::pair<epoch_t, version_t> version;
+    if (get_cache_version(what, &version)) {
+      PyObject *obj;
+      try {
+	obj = versioned_cache.get(what, version);
+      } catch (std::out_of_range& e) {
+	obj = get_python(what);
+	if (obj) {
+	  versioned_cache.insert(what, version, obj);
+	}
+      }
+      update_cache_metrics();
+      return obj;
+    }
+  } else if (versioned_cache.size()) {
+    versioned_cache.clear();
+  }
+
   uint64_t ttl_seconds = g_conf().get_val<uint64_t>("mgr_ttl_cache_expire_seconds");
   if(ttl_seconds > 0) {
     ttl_cache.set_ttl(ttl_seconds);
@@ -915,27 +964,37 @@ PyObject* ActivePyModules::with_perf_counters(
   f.open_array_section(path);
   {
     without_gil_t no_gil;
-    std::lock_guard l(lock);
-    auto metadata = daemon_state.get(DaemonKey{svc_name, svc_id});
-    if (metadata) {
-      std::lock_guard l2(metadata->lock);
-      if (metadata->perf_counters.instances.count(path)) {
-        auto counter_instance = metadata->perf_counters.instances.at(path);
-        auto counter_type = metadata->perf_counters.types.at(path);
-        with_gil(no_gil, [&] {
-          fct(counter_instance, counter_type, f);
-        });
+    std::optional<PerfCounterInstance> counter_instance;
+    std::optional<PerfCounterType> counter_type;
+    {
+      std::lock_guard l(lock);
+      auto metadata = daemon_state.get(DaemonKey{svc_name, svc_id});
+      if (metadata) {
+	std::lock_guard l2(metadata->lock);
+	auto& counters = metadata->perf_counters;
+	if (auto i = counters.instances.find(path);
+	    i != counters.instances.end()) {
+	  // snapshot, so that reports for this daemon are not held up
+	  // while we build the python objects
+	  counter_instance.emplace(i->second);
+	  counter_type.emplace(counters.types.at(path));
+	} else {
+	  dout(4) << "Missing counter: '" << path << "' ("
+		  << svc_name << "." << svc_id << ")" << dendl;
+	  dout(20) << "Paths are:" << dendl;
+	  for (const auto &i : counters.instances) {
+	    dout(20) << i.first << dendl;
+	  }
+	}
       } else {
-        dout(4) << "Missing counter: '" << path << "' ("
-		<< svc_name << "." << svc_id << ")" << dendl;
-        dout(20) << "Paths are:" << dendl;
-        for (const auto &i : metadata->perf_counters.instances) {
-          dout(20) << i.first << dendl;
-        }
+	dout(4) << "No daemon state for " << svc_name << "." << svc_id << ")"
+		<< dendl;
       }
-    } else {
-      dout(4) << "No daemon state for " << svc_name << "." << svc_id << ")"
-              << dendl;
+    }
+    if (counter_instance) {
+      with_gil(no_gil, [&] {
+        fct(*counter_instance, *counter_type, f);
+      });
     }
   }
   f.close_section();
@@ -1028,10 +1087,15 @@ PyObject* ActivePyModules::get_perf_schema_python(
       std::lock_guard l(state->lock);
       with_gil(no_gil, [&, key=ceph::to_string(key), state=state] {
         f.open_object_section(key.c_str());
-        for (auto ctr_inst_iter : state->perf_counters.instances) {
+        const auto &types = state->perf_counters.types;
+        for (const auto &ctr_inst_iter : state->perf_counters.instances) {
           const auto &counter_name = ctr_inst_iter.first;
+          auto type_iter = types.find(counter_name);
+          if (type_iter == types.end()) {
+            continue;
+          }
+          const auto &type = type_iter->second;
           f.open_object_section(counter_name.c_str());
-          auto type = state->perf_counters.types[counter_name];
           f.dump_string("description", type.description);
           if (!type.nick.empty()) {
             f.dump_string("nick", type.nick);
@@ -1051,6 +1115,58 @@ PyObject* ActivePyModules::get_perf_schema_python(
   return f.get();
 }
 
+PyObject* ActivePyModules::get_all_perf_counters_python(
+    int prio_limit,
+    const std::set<std::string> &services)
+{
+  without_gil_t no_gil;
+  std::lock_guard l(lock);
+
+  auto f = with_gil(no_gil, [&] {
+    return PyFormatter();
+  });
+  // one pass over the daemons, instead of a schema call per daemon and a
+  // value call per counter from python
+  for (auto& [key, state] : daemon_state.get_all()) {
+    if (!services.count(key.type)) {
+      continue;
+    }
+    std::lock_guard l(state->lock);
+    with_gil(no_gil, [&, key=ceph::to_string(key), state=state] {
+      f.open_object_section(key.c_str());
+      const auto &types = state->perf_counters.types;
+      for (const auto &[counter_name, instance] :
+	     state->perf_counters.instances) {
+	auto type_iter = types.find(counter_name);
+	if (type_iter == types.end() ||
+	    type_iter->second.priority < prio_limit) {
+	  continue;
+	}
+	const auto &type = type_iter->second;
+	f.open_object_section(counter_name.c_str());
+	f.dump_string("description", type.description);
+	if (!type.nick.empty()) {
+	  f.dump_string("nick", type.nick);
+	}
+	f.dump_unsigned("type", type.type);
+	f.dump_unsigned("priority", type.priority);
+	f.dump_unsigned("units", type.unit);
+	if (type.type & PERFCOUNTER_LONGRUNAVG) {
+	  const auto &data = instance.get_data_avg();
+	  f.dump_unsigned("value", data.empty() ? 0 : data.back().s);
+	  f.dump_unsigned("count", data.empty() ? 0 : data.back().c);
+	} else {
+	  const auto &data = instance.get_data();
+	  f.dump_unsigned("value", data.empty() ? 0 : data.back().v);
+	}
+	f.close_section();
+      }
+      f.close_section();
+    });
+  }
+  return f.get();
+}
+
 PyObject* ActivePyModules::get_rocksdb_version()
 {
   std::string version = std::to_string(ROCKSDB_MAJOR) + "." +
@@ -57,6 +57,10 @@ class ActivePyModules
   Client   &client;
   Finisher &finisher;
   TTLCache<std::string, PyObject*> ttl_cache;
+  /// get() results keyed by the (osdmap epoch, pgmap version) they were
+  /// built from; protected by the GIL
+  VersionedCache<std::string, std::pair<epoch_t, version_t>, PyObject*>
+    versioned_cache;
 public:
   Finisher cmd_finisher;
 private:
@@ -101,6 +105,9 @@ public:
   PyObject *get_perf_schema_python(
      const std::string &svc_type,
      const std::string &svc_id);
+  PyObject *get_all_perf_counters_python(
+     int prio_limit,
+     const std::set<std::string> &services);
   PyObject *get_rocksdb_version();
   PyObject *get_context();
   PyObject *get_osdmap();
@@ -230,5 +237,7 @@ public:
 
   bool inject_python_on() const;
   void update_cache_metrics();
+  bool get_cache_version(const std::string &what,
+			 std::pair<epoch_t, version_t> *version);
 };
 
@@ -657,6 +657,27 @@ get_latest_counter(BaseMgrModule *self, PyObject *args)
       svc_name, svc_id, counter_path);
 }
 
+static PyObject*
+get_all_perf_counters(BaseMgrModule *self, PyObject *args)
+{
+  int prio_limit = 0;
+  PyObject *py_services = nullptr;
+  if (!PyArg_ParseTuple(args, "iO!:get_all_perf_counters", &prio_limit,
+			&PyList_Type, &py_services)) {
+    return nullptr;
+  }
+  std::set<std::string> services;
+  for (int i = 0; i < PyList_Size(py_services); ++i) {
+    PyObject *svc = PyList_GET_ITEM(py_services, i);
+    if (!PyUnicode_Check(svc)) {
+      PyErr_SetString(PyExc_TypeError, "services must be a list of str");
+      return nullptr;
+    }
+    services.insert(PyUnicode_AsUTF8(svc));
+  }
+  return self->py_modules->get_all_perf_counters_python(prio_limit, services);
+}
+
 static PyObject*
 get_perf_schema(BaseMgrModule *self, PyObject *args)
 {
@@ -1472,6 +1493,10 @@ PyMethodDef BaseMgrModule_methods[] = {
   {"_ceph_get_perf_schema", (PyCFunction)get_perf_schema, METH_VARARGS,
     "Get the performance counter schema"},
 
+  {"_ceph_get_all_perf_counters", (PyCFunction)get_all_perf_counters,
+    METH_VARARGS,
+    "Get the schema and latest value of every performance counter"},
+
   {"_ceph_get_rocksdb_version", (PyCFunction)ceph_get_rocksdb_version, METH_NOARGS,
     "Get the current RocksDB version number"},
 
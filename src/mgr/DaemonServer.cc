@@ -253,6 +253,19 @@ bool DaemonServer::ms_handle_refused(Connection *con)
   return false;
 }
 
+bool DaemonServer::ms_can_dispatch_sharded(const cref_t<Message>& m) const
+{
+  // the per-daemon reports are the bulk of our traffic, and their handlers
+  // take their own locks (see ms_dispatch2)
+  switch (m->get_type()) {
+  case MSG_PGSTATS:
+  case MSG_MGR_REPORT:
+    return true;
+  default:
+    return false;
+  }
+}
+
 bool DaemonServer::ms_dispatch2(const ref_t<Message>& m)
 {
   // Note that we do *not* take ::lock here, in order to avoid
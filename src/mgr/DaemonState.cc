@@ -13,6 +13,7 @@
 
 #include "DaemonState.h"
 
+#include <atomic>
 #include <experimental/iterator>
 
 #include "MgrSession.h"
@@ -391,32 +392,46 @@ void DaemonPerfCounters::update(const MMgrReport& report)
   for (const auto &t : report.undeclare_types) {
     session->declared_types.erase(t);
   }
+  if (!report.declare_types.empty() || !report.undeclare_types.empty()) {
+    static std::atomic<uint64_t> last_gen = {0};
+    session->declared_types_gen = ++last_gen;
+  }
+
+  if (packed_gen != session->declared_types_gen) {
+    // Always check the instance exists, as we don't prevent yet
+    // multiple sessions from daemons with the same name, and one
+    // session clearing stats created by another on open (which also
+    // drops this cache).
+    packed.clear();
+    packed.reserve(session->declared_types.size());
+    for (const auto &t_path : session->declared_types) {
+      const auto &t = types.at(t_path);
+      auto instances_it = instances.find(t_path);
+      if (instances_it == instances.end()) {
+	instances_it = instances.insert({t_path, t.type}).first;
+      }
+      packed.emplace_back(&instances_it->second, t.type);
+    }
+    packed_gen = session->declared_types_gen;
+  }
 
   const auto now = ceph_clock_now();
 
   // Parse packed data according to declared set of types
   auto p = report.packed.cbegin();
   DECODE_START(1, p);
-  for (const auto &t_path : session->declared_types) {
-    const auto &t = types.at(t_path);
-    auto instances_it = instances.find(t_path);
-    // Always check the instance exists, as we don't prevent yet
-    // multiple sessions from daemons with the same name, and one
-    // session clearing stats created by another on open.
-    if (instances_it == instances.end()) {
-      instances_it = instances.insert({t_path, t.type}).first;
-    }
+  for (auto& [instance, type] : packed) {
     uint64_t val = 0;
     uint64_t avgcount = 0;
     uint64_t avgcount2 = 0;
 
     decode(val, p);
-    if (t.type & PERFCOUNTER_LONGRUNAVG) {
+    if (type & PERFCOUNTER_LONGRUNAVG) {
       decode(avgcount, p);
       decode(avgcount2, p);
-      instances_it->second.push_avg(now, val, avgcount);
+      instance->push_avg(now, val, avgcount);
     } else {
-      instances_it->second.push(now, val);
+      instance->push(now, val);
     }
   }
   DECODE_FINISH(p);
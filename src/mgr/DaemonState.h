@@ -18,6 +18,7 @@
 #include <string>
 #include <memory>
 #include <set>
+#include <vector>
 #include <boost/circular_buffer.hpp>
 
 #include "include/str_map.h"
@@ -112,7 +113,17 @@ class DaemonPerfCounters
   void clear()
   {
     instances.clear();
+    packed.clear();
+    packed_gen = 0;
   }
+
+  private:
+  /// the reporting session's declared types, resolved to their instances
+  /// in the order their values are packed in a report; rebuilt only when
+  /// the declarations change rather than looked up by path every report
+  std::vector<std::pair<PerfCounterInstance*, enum perfcounter_type_d>> packed;
+  /// MgrSession::declared_types_gen that packed was built for
+  uint64_t packed_gen = 0;
 };
 
 // The state that we store about one daemon
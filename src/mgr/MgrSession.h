@@ -23,6 +23,8 @@ struct MgrSession : public RefCountedObject {
   MgrCap caps;
 
   std::set<std::string> declared_types;
+  /// changes, to a value unique across sessions, whenever declared_types does
+  uint64_t declared_types_gen = 0;
 
   const entity_addr_t& get_peer_addr() const {
     return inst.addr;
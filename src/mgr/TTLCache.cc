@@ -98,3 +98,48 @@ template <class Key, class Value>
 void TTLCacheBase<Key, Value>::throw_key_not_found(Key key) {
   cache::throw_key_not_found(key);
 }
+
+template <class Key, class Version, class Value>
+void VersionedCache<Key, Version, Value>::insert(Key key,
+                                                 const Version& version,
+                                                 Value value) {
+  erase(key);
+  bool stored = this->content.size() < this->capacity;
+  cache::insert(key, {value, version});
+  if (stored) {
+    versioned_cache_detail::retain(value);
+  }
+}
+
+template <class Key, class Version, class Value>
+Value VersionedCache<Key, Version, Value>::get(Key key,
+                                               const Version& version) {
+  if (!cache::exists(key)) {
+    cache::throw_key_not_found(key);
+  }
+  if (cache::get(key, false).second != version) {
+    erase(key);
+    cache::throw_key_not_found(key);
+  }
+  Value value = cache::get(key).first;
+  versioned_cache_detail::retain(value);
+  return value;
+}
+
+template <class Key, class Version, class Value>
+void VersionedCache<Key, Version, Value>::erase(Key key) {
+  auto p = this->content.find(key);
+  if (p == this->content.end()) {
+    return;
+  }
+  versioned_cache_detail::release(p->second.first);
+  this->content.erase(p);
+}
+
+template <class Key, class Version, class Value>
+void VersionedCache<Key, Version, Value>::clear() {
+  for (auto& [key, value] : this->content) {
+    versioned_cache_detail::release(value.first);
+  }
+  cache::clear();
+}
@@ -118,5 +118,34 @@ class TTLCache<Key, PyObject*> : public TTLCacheBase<Key, PyObject*> {
   using ttl_base = TTLCacheBase<Key, PyObject*>;
 };
 
+namespace versioned_cache_detail {
+template <class T> void retain(const T&) {}
+template <class T> void release(const T&) {}
+inline void retain(PyObject* o) { Py_INCREF(o); }
+inline void release(PyObject* o) { Py_DECREF(o); }
+}
+
+/*
+ * A cache whose entries stay valid for as long as the state they were
+ * built from, identified by a Version (e.g. a map epoch), is unchanged.
+ * get() with any other version drops the entry.  PyObject* values are
+ * reference counted: the cache holds its own reference, and get() returns
+ * a new one.
+ */
+template <class Key, class Version, class Value>
+class VersionedCache : public Cache<Key, std::pair<Value, Version>> {
+ private:
+  using value_type = std::pair<Value, Version>;
+  using cache = Cache<Key, value_type>;
+
+ public:
+  VersionedCache(uint16_t size = UINT16_MAX) : cache(size) {}
+  ~VersionedCache(){};
+  void insert(Key key, const Version& version, Value value);
+  Value get(Key key, const Version& version);
+  void erase(Key key);
+  void clear();
+};
+
 #include "TTLCache.cc"
 
@@ -908,16 +908,9 @@ void ConfigMonitor::load_changeset(version_t v, ConfigChangeSet *ch)
   }
 }
 
-bool ConfigMonitor::refresh_config(MonSession *s)
+bool ConfigMonitor::refresh_config(MonSession *s, refresh_cache_t *cache)
 {
   const OSDMap& osdmap = mon.osdmon()->osdmap;
-  map<string,string> crush_location;
-  if (s->remote_host.size()) {
-    osdmap.crush->get_full_location(s->remote_host, &crush_location);
-    dout(10) << __func__ << " crush_location for remote_host " << s->remote_host
-	     << " is " << crush_location << dendl;
-  }
-
   string device_class;
   if (s->name.is_osd()) {
     const char *c = osdmap.crush->get_item_class(s->name.num());
@@ -927,13 +920,49 @@ bool ConfigMonitor::refresh_config(MonSession *s)
     }
   }
 
-  dout(20) << __func__ << " " << s->entity_name << " crush " << crush_location
+  // the generated config only depends on these, so sessions that share
+  // them (e.g. many clients with the same name on one host) share it
+  auto key = std::make_tuple(s->entity_name.to_str(), s->remote_host,
+			     device_class);
+  if (cache) {
+    if (auto p = cache->config.find(key); p != cache->config.end()) {
+      dout(20) << __func__ << " " << s->entity_name << " same as earlier "
+	       << "session" << dendl;
+      if (p->second == s->last_config && s->any_config) {
+	return false;
+      }
+      s->last_config = p->second;
+      s->any_config = true;
+      return true;
+    }
+  }
+
+  map<string,string> local_crush_location;
+  map<string,string> *crush_location = &local_crush_location;
+  if (s->remote_host.size()) {
+    bool found = false;
+    if (cache) {
+      auto [p, inserted] = cache->crush_location.try_emplace(s->remote_host);
+      crush_location = &p->second;
+      found = !inserted;
+    }
+    if (!found) {
+      osdmap.crush->get_full_location(s->remote_host, crush_location);
+    }
+    dout(10) << __func__ << " crush_location for remote_host " << s->remote_host
+	     << " is " << *crush_location << dendl;
+  }
+
+  dout(20) << __func__ << " " << s->entity_name << " crush " << *crush_location
 	   << " device_class " << device_class << dendl;
   auto out = config_map.generate_entity_map(
     s->entity_name,
-    crush_location,
+    *crush_location,
     osdmap.crush.get(),
     device_class);
+  if (cache) {
+    cache->config.emplace(std::move(key), out);
+  }
 
   if (out == s->last_config && s->any_config) {
     dout(20) << __func__ << " no change, " << out << dendl;
@@ -947,9 +976,9 @@ bool ConfigMonitor::refresh_config(MonSession *s)
   return true;
 }
 
-bool ConfigMonitor::maybe_send_config(MonSession *s)
+bool ConfigMonitor::maybe_send_config(MonSession *s, refresh_cache_t *cache)
 {
-  bool changed = refresh_config(s);
+  bool changed = refresh_config(s, cache);
   dout(10) << __func__ << " to " << s->name << " "
 	   << (changed ? "(changed)" : "(unchanged)")
 	   << dendl;
@@ -1003,12 +1032,13 @@ void ConfigMonitor::check_all_subs()
     return;
   }
   int updated = 0, total = 0;
+  refresh_cache_t cache;
   auto p = subs->second->begin();
   while (!p.end()) {
     auto sub = *p;
     ++p;
     ++total;
-    if (maybe_send_config(sub->session)) {
+    if (maybe_send_config(sub->session, &cache)) {
       ++updated;
     }
   }
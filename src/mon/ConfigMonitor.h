@@ -49,8 +49,17 @@ public:
   void on_active() override;
   void tick() override;
 
-  bool refresh_config(MonSession *s);
-  bool maybe_send_config(MonSession *s);
+  /// lookups shared by the sessions refreshed in one pass
+  struct refresh_cache_t {
+    /// remote_host -> crush location
+    std::map<std::string, std::map<std::string,std::string>> crush_location;
+    /// (entity name, remote_host, device class) -> generated config
+    std::map<std::tuple<std::string,std::string,std::string>,
+	     std::map<std::string,std::string,std::less<>>> config;
+  };
+
+  bool refresh_config(MonSession *s, refresh_cache_t *cache = nullptr);
+  bool maybe_send_config(MonSession *s, refresh_cache_t *cache = nullptr);
   void send_config(MonSession *s);
   void check_sub(MonSession *s);
   void check_sub(Subscription *sub);
@@ -77,6 +77,7 @@ MonClient::MonClient(CephContext *cct_, boost::asio::io_context& service) :
   had_a_connection(false),
   reopen_interval_multiplier(
     cct_->_conf.get_val<double>("mon_client_hunt_interval_min_multiple")),
+  hunt_seed(ceph::util::generate_random_number<uint64_t>()),
   last_mon_command_tid(0),
   version_req_id(0)
 {}
@@ -831,12 +832,16 @@ void MonClient::_add_conns()
       auto rank_name = monmap.get_name(i);
       weights.push_back(monmap.get_weight(rank_name));
     }
-    random_device_t rd;
+    // the same candidates always come out in the same order for us, so a
+    // reconnect goes back to the mon we prefer if it is still there rather
+    // than piling onto whichever survivor every other client just picked
+    std::sort(begin(ranks), end(ranks));
+    std::mt19937_64 rng{hunt_seed ^ ranks.size()};
     if (std::accumulate(begin(weights), end(weights), 0u) == 0) {
-      std::shuffle(begin(ranks), end(ranks), std::mt19937{rd()});
+      std::shuffle(begin(ranks), end(ranks), rng);
     } else {
       weighted_shuffle(begin(ranks), end(ranks), begin(weights), end(weights),
-		       std::mt19937{rd()});
+		       rng);
     }
   }
   ldout(cct, 10) << __func__ << " ranks=" << ranks << dendl;
@@ -1024,8 +1029,14 @@ void MonClient::schedule_tick()
   auto do_tick = make_lambda_context([this](int) { tick(); });
   if (!is_connected()) {
     // start another round of hunting
+    // jitter the retries so that clients which lost the same mon at the
+    // same moment do not all hit the survivors in lockstep
+    const double jitter =
+      cct->_conf.get_val<double>("mon_client_hunt_interval_jitter");
     const auto hunt_interval = (cct->_conf->mon_client_hunt_interval *
-				reopen_interval_multiplier);
+				reopen_interval_multiplier *
+				ceph::util::generate_random_number<double>(
+				  1.0 - jitter, 1.0 + jitter));
     timer.add_event_after(hunt_interval, do_tick);
   } else {
     // keep in touch
@@ -352,6 +352,9 @@ private:
   utime_t last_rotating_renew_sent;
   bool had_a_connection;
   double reopen_interval_multiplier;
+  /// fixed per client, so that each client prefers the same mons in the
+  /// same order whenever it hunts, and different clients spread out
+  const uint64_t hunt_seed;
 
   Dispatcher *handle_authentication_dispatcher = nullptr;
   bool _opened() const;
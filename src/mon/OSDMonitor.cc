@@ -828,6 +828,7 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
     OSDMap::Incremental inc(inc_bl);
     err = osdmap.apply_incremental(inc);
     ceph_assert(err == 0);
+    mapping.note_incremental(inc);
 
     if (!t)
       t.reset(new MonitorDBStore::Transaction);
@@ -870,6 +871,7 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
 
 	osdmap = OSDMap();
 	osdmap.decode(orig_full_bl);
+	mapping.reset_incremental();
 
 	dout(20) << __func__ << " canonical full osdmap:\n";
 	JSONFormatter jf(true);
@@ -2218,6 +2220,31 @@ void OSDMonitor::share_map_with_random_osd()
     return;
   }
 
+  if (auto fanout = g_conf().get_val<uint64_t>("osd_map_fanout"); fanout) {
+    // seed the roots of the tree the osds push new maps along.  each mon
+    // tells the roots that have a session with it.
+    vector<int> roots;
+    osdmap.get_map_fanout_roots(fanout, &roots);
+    for (int osd : roots) {
+      for (auto p = mon.session_map.by_osd.find(osd);
+	   p != mon.session_map.by_osd.end() && p->first == osd;
+	   ++p) {
+	MonSession *s = p->second;
+	if (osdmap.get_addrs(osd) != s->con->get_peer_addrs()) {
+	  continue;
+	}
+	dout(10) << "committed, telling fanout root " << s->name
+		 << " all about it" << dendl;
+	uint64_t features = s->con_features ? s->con_features :
+	                                      mon.get_quorum_con_features();
+	s->con->send_message(build_incremental(osdmap.get_epoch() - 1,
+					       osdmap.get_epoch(), features));
+	break;
+      }
+    }
+    return;
+  }
+
   MonSession *s = mon.session_map.get_random_osd_session(&osdmap);
   if (!s) {
     dout(10) << __func__ << " no up osd on our session map" << dendl;
@@ -2800,7 +2827,20 @@ bool OSDMonitor::should_propose(double& delay)
     return true;
   }
 
-  return PaxosService::should_propose(delay);
+  if (!PaxosService::should_propose(delay))
+    return false;
+
+  // OSDs tend to fail and boot in groups (a host or a rack at a time);
+  // hold up/down changes briefly so the group lands in one epoch
+  double window = g_conf().get_val<double>("mon_osd_state_batch_window");
+  if (window > delay &&
+      (!pending_inc.new_up_client.empty() ||
+       pending_inc.get_net_marked_down(&osdmap) != 0)) {
+    dout(10) << __func__ << " batching osd state changes for " << window
+	     << "s" << dendl;
+    delay = window;
+  }
+  return true;
 }
 
 
@@ -3089,6 +3129,12 @@ bool OSDMonitor::prepare_mark_me_dead(MonOpRequestRef op)
 }
 
 bool OSDMonitor::can_mark_down(int i)
+{
+  return can_mark_down(
+    i, osdmap.get_num_up_osds() - pending_inc.get_net_marked_down(&osdmap));
+}
+
+bool OSDMonitor::can_mark_down(int i, int up)
 {
   if (osdmap.is_nodown(i)) {
     dout(5) << __func__ << " osd." << i << " is marked as nodown, "
@@ -3101,7 +3147,6 @@ bool OSDMonitor::can_mark_down(int i)
     dout(5) << __func__ << " no osds" << dendl;
     return false;
   }
-  int up = osdmap.get_num_up_osds() - pending_inc.get_net_marked_down(&osdmap);
   float up_ratio = (float)up / (float)num_osds;
   if (up_ratio < g_conf()->mon_osd_min_up_ratio) {
     dout(2) << __func__ << " current up_ratio " << up_ratio << " < min "
@@ -3171,11 +3216,20 @@ bool OSDMonitor::can_mark_in(int i)
 bool OSDMonitor::check_failures(utime_t now)
 {
   bool found_failure = false;
+  // evaluate the whole set of failures against one up count and one
+  // reporter location lookup each, instead of re-deriving them per OSD
+  int up = osdmap.get_num_up_osds() - pending_inc.get_net_marked_down(&osdmap);
+  map<int, string> subtree_cache;
   auto p = failure_info.begin();
   while (p != failure_info.end()) {
     auto& [target_osd, fi] = *p;
-    if (can_mark_down(target_osd) &&
-	check_failure(now, target_osd, fi)) {
+    bool pending = pending_inc.new_state.count(target_osd) &&
+      (pending_inc.new_state[target_osd] & CEPH_OSD_UP);
+    if (can_mark_down(target_osd, up) &&
+	check_failure(now, target_osd, fi, &subtree_cache)) {
+      if (!pending) {
+	--up;
+      }
       found_failure = true;
       ++p;
     } else if (is_failure_stale(now, fi)) {
@@ -3237,7 +3291,8 @@ utime_t OSDMonitor::get_grace_time(utime_t now,
   return grace;
 }
 
-bool OSDMonitor::check_failure(utime_t now, int target_osd, failure_info_t& fi)
+bool OSDMonitor::check_failure(utime_t now, int target_osd, failure_info_t& fi,
+			       map<int, string>* subtree_cache)
 {
   // already pending failure?
   if (pending_inc.new_state.count(target_osd) &&
@@ -3253,12 +3308,24 @@ bool OSDMonitor::check_failure(utime_t now, int target_osd, failure_info_t& fi)
     // get the parent bucket whose type matches with "reporter_subtree_level".
     // fall back to OSD if the level doesn't exist.
     if (osdmap.exists(p->first)) {
+      if (subtree_cache) {
+	if (auto c = subtree_cache->find(p->first); c != subtree_cache->end()) {
+	  reporters_by_subtree.insert(c->second);
+	  ++p;
+	  continue;
+	}
+      }
+      string subtree;
       auto reporter_loc = osdmap.crush->get_full_location(p->first);
       if (auto iter = reporter_loc.find(reporter_subtree_level);
           iter == reporter_loc.end()) {
-        reporters_by_subtree.insert("osd." + to_string(p->first));
+        subtree = "osd." + to_string(p->first);
       } else {
-        reporters_by_subtree.insert(iter->second);
+        subtree = iter->second;
+      }
+      reporters_by_subtree.insert(subtree);
+      if (subtree_cache) {
+	subtree_cache->emplace(p->first, std::move(subtree));
       }
       ++p;
     } else {
@@ -5280,6 +5347,7 @@ bool OSDMonitor::handle_osd_timeouts(const utime_t &now,
 
   int max_osd = osdmap.get_max_osd();
   bool new_down = false;
+  int up = osdmap.get_num_up_osds() - pending_inc.get_net_marked_down(&osdmap);
 
   for (int i=0; i < max_osd; ++i) {
     dout(30) << __func__ << ": checking up on osd " << i << dendl;
@@ -5294,7 +5362,7 @@ bool OSDMonitor::handle_osd_timeouts(const utime_t &now,
       // it wasn't in the map; start the timer.
       last_osd_report[i].first = now;
       last_osd_report[i].second = 0;
-    } else if (can_mark_down(i)) {
+    } else if (can_mark_down(i, up)) {
       utime_t diff = now - t->second.first;
       // we use the max(mon_osd_report_timeout, 2*osd_beacon_report_interval) as timeout
       // to allow for the osd to miss a beacon.
@@ -5305,6 +5373,10 @@ bool OSDMonitor::handle_osd_timeouts(const utime_t &now,
                           << diff << " seconds";
         derr << "no beacon from osd." << i << " since " << t->second.first
              << ", " << diff << " seconds ago.  marking down" << dendl;
+        if (!pending_inc.new_state.count(i) ||
+	    !(pending_inc.new_state[i] & CEPH_OSD_UP)) {
+	  --up;
+	}
         pending_inc.new_state[i] = CEPH_OSD_UP;
         new_down = true;
       }
@@ -6288,7 +6360,7 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
 	    break;
 	  case HIT_SET_FPP:
 	    {
-	      if (p->hit_set_params.get_type() == HitSet::TYPE_BLOOM) {
+	      if (HitSet::is_bloom_type(p->hit_set_params.get_type())) {
 		BloomHitSet::Params *bloomp =
 		  static_cast<BloomHitSet::Params*>(p->hit_set_params.impl.get());
 		f->dump_float("hit_set_fpp", bloomp->get_fpp());
@@ -6435,7 +6507,7 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
 	    break;
 	  case HIT_SET_FPP:
 	    {
-	      if (p->hit_set_params.get_type() == HitSet::TYPE_BLOOM) {
+	      if (HitSet::is_bloom_type(p->hit_set_params.get_type())) {
 		BloomHitSet::Params *bloomp =
 		  static_cast<BloomHitSet::Params*>(p->hit_set_params.impl.get());
 		ss << "hit_set_fpp: " << bloomp->get_fpp() << "\n";
@@ -8643,6 +8715,14 @@ int OSDMonitor::prepare_command_pool_set(const cmdmap_t& cmdmap,
 	BloomHitSet::Params *bsp = new BloomHitSet::Params;
 	bsp->set_fpp(g_conf().get_val<double>("osd_pool_default_hit_set_bloom_fpp"));
 	p.hit_set_params = HitSet::Params(bsp);
+      } else if (val == "blocked_bloom") {
+	if (osdmap.require_osd_release < ceph_release_t::reef) {
+	  ss << "blocked_bloom hit sets require require_osd_release >= reef";
+	  return -EPERM;
+	}
+	auto bsp = new BlockedBloomHitSet::Params;
+	bsp->set_fpp(g_conf().get_val<double>("osd_pool_default_hit_set_bloom_fpp"));
+	p.hit_set_params = HitSet::Params(bsp);
       } else if (val == "explicit_hash")
 	p.hit_set_params = HitSet::Params(new ExplicitHashHitSet::Params);
       else if (val == "explicit_object")
@@ -8678,7 +8758,7 @@ int OSDMonitor::prepare_command_pool_set(const cmdmap_t& cmdmap,
       ss << "hit_set_fpp should be in the range 0..1";
       return -EINVAL;
     }
-    if (p.hit_set_params.get_type() != HitSet::TYPE_BLOOM) {
+    if (!HitSet::is_bloom_type(p.hit_set_params.get_type())) {
       ss << "hit set is not of type Bloom; invalid to set a false positive rate!";
       return -EINVAL;
     }
@@ -13740,6 +13820,16 @@ bool OSDMonitor::prepare_command_impl(MonOpRequestRef op,
       BloomHitSet::Params *bsp = new BloomHitSet::Params;
       bsp->set_fpp(g_conf().get_val<double>("osd_pool_default_hit_set_bloom_fpp"));
       hsp = HitSet::Params(bsp);
+    } else if (cache_hit_set_type == "blocked_bloom") {
+      if (osdmap.require_osd_release < ceph_release_t::reef) {
+	ss << "osd tier cache default hit set type 'blocked_bloom'"
+	   << " requires require_osd_release >= reef";
+	err = -EPERM;
+	goto reply;
+      }
+      auto bsp = new BlockedBloomHitSet::Params;
+      bsp->set_fpp(g_conf().get_val<double>("osd_pool_default_hit_set_bloom_fpp"));
+      hsp = HitSet::Params(bsp);
     } else if (cache_hit_set_type == "explicit_hash") {
       hsp = HitSet::Params(new ExplicitHashHitSet::Params);
     } else if (cache_hit_set_type == "explicit_object") {
@@ -236,7 +236,10 @@ public:
   osdmap_manifest_t osdmap_manifest;
 
   bool check_failures(utime_t now);
-  bool check_failure(utime_t now, int target_osd, failure_info_t& fi);
+  /// @param subtree_cache reporter -> subtree, shared by a pass over
+  ///                      several failures
+  bool check_failure(utime_t now, int target_osd, failure_info_t& fi,
+		     std::map<int, std::string>* subtree_cache = nullptr);
   utime_t get_grace_time(utime_t now, int target_osd, failure_info_t& fi) const;
   bool is_failure_stale(utime_t now, failure_info_t& fi) const;
   void force_failure(int target_osd, int by);
@@ -396,6 +399,8 @@ private:
   version_t get_trim_to() const override;
 
   bool can_mark_down(int o);
+  /// as above, given the number of OSDs up once pending_inc is applied
+  bool can_mark_down(int o, int up);
   bool can_mark_up(int o);
   bool can_mark_out(int o);
   bool can_mark_in(int o);
@@ -1116,6 +1116,16 @@ void PGMap::Incremental::generate_test_instances(list<PGMap::Incremental*>& o)
 
 // --
 
+// true if the parts of a pg_stat_t that stat_pg_add/sub index by OSD
+// (everything they skip when sameosds is set) are unchanged
+static bool same_osds(const pg_stat_t& a, const pg_stat_t& b)
+{
+  return a.up == b.up &&
+    a.acting == b.acting &&
+    a.up_primary == b.up_primary &&
+    a.blocked_by == b.blocked_by;
+}
+
 void PGMap::apply_incremental(CephContext *cct, const Incremental& inc)
 {
   ceph_assert(inc.version == version+1);
@@ -1136,12 +1146,16 @@ void PGMap::apply_incremental(CephContext *cct, const Incremental& inc)
     pool_stat_t &pool_sum_ref = pg_pool_sum[update_pool];
     if (pg_stat_iter == pg_stat.end()) {
       pg_stat.insert(make_pair(update_pg, update_stat));
+      stat_pg_add(update_pg, update_stat);
     } else {
-      stat_pg_sub(update_pg, pg_stat_iter->second);
+      // most updates only refresh counters; skip re-indexing the PG by
+      // OSD when its mapping and blockers did not change
+      bool sameosds = same_osds(pg_stat_iter->second, update_stat);
+      stat_pg_sub(update_pg, pg_stat_iter->second, sameosds);
       pool_sum_ref.sub(pg_stat_iter->second);
       pg_stat_iter->second = update_stat;
+      stat_pg_add(update_pg, update_stat, sameosds);
     }
-    stat_pg_add(update_pg, update_stat);
     pool_sum_ref.add(update_stat);
   }
 
@@ -1212,10 +1226,12 @@ void PGMap::apply_incremental(CephContext *cct, const Incremental& inc)
       stat_osd_sub(t->first, t->second);
       osd_stat.erase(t);
     }
-    for (auto i = pool_statfs.begin();  i != pool_statfs.end(); ++i) {
+    for (auto i = pool_statfs.begin();  i != pool_statfs.end(); ) {
       if (i->first.second == *p) {
 	pg_pool_sum[i->first.first].sub(i->second);
-	pool_statfs.erase(i);
+	i = pool_statfs.erase(i);
+      } else {
+	++i;
       }
     }
   }
@@ -194,6 +194,27 @@ void PaxosService::propose_pending()
   ceph_assert(mon.is_leader());
   ceph_assert(is_active());
 
+  _queue_pending();
+
+  if (g_conf()->paxos_propose_piggyback) {
+    for (auto& svc : mon.paxos_service) {
+      if (svc.get() != this && svc->can_piggyback()) {
+	svc->piggyback_pending();
+      }
+    }
+  }
+  paxos.trigger_propose();
+}
+
+void PaxosService::piggyback_pending()
+{
+  dout(10) << __func__ << dendl;
+  ceph_assert(can_piggyback());
+  _queue_pending();
+}
+
+void PaxosService::_queue_pending()
+{
   if (proposal_timer) {
     dout(10) << " canceling proposal_timer " << proposal_timer << dendl;
     mon.timer.cancel_event(proposal_timer);
@@ -249,7 +270,6 @@ void PaxosService::propose_pending()
     }
   };
   paxos.queue_pending_finisher(new C_Committed(this));
-  paxos.trigger_propose();
 }
 
 bool PaxosService::should_stash_full()
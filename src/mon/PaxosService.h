@@ -229,9 +229,39 @@ public:
    *
    * @note This function depends on the implementation of encode_pending on
    *	   the class that is implementing PaxosService
+   *
+   * @note If paxos_propose_piggyback is set, other services that are only
+   *	   waiting for their proposal timer add their pending values to the
+   *	   same Paxos transaction, so they commit in this round instead of
+   *	   each starting a round of their own.
    */
   void propose_pending();
 
+private:
+  /**
+   * Encode our pending value into the pending Paxos transaction and queue
+   * our commit callback, without triggering a proposal.
+   */
+  void _queue_pending();
+
+public:
+  /**
+   * @returns true if we have a pending value waiting only on our proposal
+   *	      timer, which may be proposed along with another service's.
+   */
+  bool can_piggyback() const {
+    return proposal_timer && !need_immediate_propose && is_writeable() &&
+      mon.is_leader();
+  }
+
+  /**
+   * Add our pending value to the Paxos transaction being proposed by
+   * another service.
+   *
+   * @pre can_piggyback()
+   */
+  void piggyback_pending();
+
   /**
    * Let others request us to propose.
    *
@@ -57,6 +57,8 @@ public:
 
   int rx_buffers_version = 0;
   std::map<ceph_tid_t,std::pair<ceph::buffer::list, int>> rx_buffers;
+  /// tid whose rx buffer the messenger is currently reading into, or 0
+  ceph_tid_t rx_buffer_claimed = 0;
 
   // authentication state
   // FIXME make these private after ms_handle_authorizer is removed
@@ -207,19 +209,35 @@ public:
     return CEPH_CON_MODE_CRC;
   }
 
+  /**
+   * Post a buffer for the data of the reply to @tid.  If the reply
+   * arrives on this connection and its data fits, the messenger reads it
+   * straight into the buffer instead of a freshly allocated one, so that
+   * a caller reading into its own memory does not pay for a copy.
+   *
+   * The caller must keep the memory valid until revoke_rx_buffer().
+   */
   void post_rx_buffer(ceph_tid_t tid, ceph::buffer::list& bl) {
-#if 0
     std::lock_guard l{lock};
     ++rx_buffers_version;
-    rx_buffers[tid] = pair<bufferlist,int>(bl, rx_buffers_version);
-#endif
+    rx_buffers[tid] = std::pair<ceph::buffer::list,int>(bl, rx_buffers_version);
   }
 
+  /**
+   * Withdraw the buffer posted for @tid.  Once this returns the messenger
+   * no longer writes into it: a reply being read into it at the time is
+   * moved to a private buffer first.
+   */
   void revoke_rx_buffer(ceph_tid_t tid) {
-#if 0
-    std::lock_guard l{lock};
-    rx_buffers.erase(tid);
-#endif
+    bool claimed;
+    {
+      std::lock_guard l{lock};
+      rx_buffers.erase(tid);
+      claimed = (rx_buffer_claimed == tid);
+    }
+    if (claimed) {
+      relocate_rx_buffer(tid);
+    }
   }
 
   utime_t get_last_keepalive() const {
@@ -241,6 +259,49 @@ public:
   bool is_blackhole() const;
 
 protected:
+  /**
+   * Take the buffer posted for @tid if it is a single segment of at least
+   * @len bytes; it stays claimed until release_rx_buffer().  Messenger
+   * only.
+   */
+  bool claim_rx_buffer(ceph_tid_t tid, unsigned len, ceph::buffer::ptr *bp) {
+    std::lock_guard l{lock};
+    auto p = rx_buffers.find(tid);
+    if (p == rx_buffers.end()) {
+      return false;
+    }
+    auto& bl = p->second.first;
+    if (bl.get_num_buffers() != 1 || bl.length() < len) {
+      return false;
+    }
+    *bp = ceph::buffer::ptr(bl.front(), 0, len);
+    rx_buffers.erase(p);
+    rx_buffer_claimed = tid;
+    return true;
+  }
+  void release_rx_buffer() {
+    std::lock_guard l{lock};
+    rx_buffer_claimed = 0;
+  }
+  /// true if @tid was still claimed, which it no longer is
+  bool unclaim_rx_buffer(ceph_tid_t tid) {
+    std::lock_guard l{lock};
+    if (rx_buffer_claimed != tid) {
+      return false;
+    }
+    rx_buffer_claimed = 0;
+    return true;
+  }
+  /**
+   * Called by revoke_rx_buffer() without the connection lock while the
+   * messenger may be reading into the claimed buffer for @tid.  It must
+   * pause the reader, and if unclaim_rx_buffer(@tid) succeeds, move what
+   * was read so far and the rest of the read to a private buffer.
+   */
+  virtual void relocate_rx_buffer(ceph_tid_t tid) {
+    unclaim_rx_buffer(tid);
+  }
+
   Connection(CephContext *cct, Messenger *m)
     : RefCountedObjectSafe(cct),
       msgr(m)
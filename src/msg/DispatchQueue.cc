@@ -16,6 +16,8 @@
 #include "DispatchQueue.h"
 #include "Messenger.h"
 #include "common/ceph_context.h"
+#include "common/perf_counters.h"
+#include "common/perf_counters_collection.h"
 
 #define dout_subsys ceph_subsys_ms
 #include "common/debug.h"
@@ -82,6 +84,10 @@ void DispatchQueue::fast_preprocess(const ref_t<Message>& m)
 
 void DispatchQueue::enqueue(const ref_t<Message>& m, int priority, uint64_t id)
 {
+  if (!shards.empty() && msgr->ms_can_dispatch_sharded(m)) {
+    enqueue_sharded(m);
+    return;
+  }
   std::lock_guard l{lock};
   if (stop) {
     return;
@@ -213,6 +219,74 @@ void DispatchQueue::entry()
   }
 }
 
+void DispatchQueue::create_shards(const std::string &name)
+{
+  for (unsigned i = 0; i < cct->_conf->ms_dispatch_shards; i++) {
+    auto shard_name = name + "-" + std::to_string(i);
+    auto& s = shards.emplace_back(
+      std::make_unique<DispatchShard>(this, shard_name));
+    PerfCountersBuilder plb(cct, "msgr_dispatch_shard-" + shard_name,
+			    l_dispatch_shard_first, l_dispatch_shard_last);
+    plb.add_u64_counter(l_dispatch_shard_messages, "messages",
+			"Messages dispatched");
+    plb.add_u64(l_dispatch_shard_queue_len, "queue_len",
+		"Messages waiting for dispatch");
+    plb.add_time_avg(l_dispatch_shard_queue_lat, "queue_lat",
+		     "Time from receipt to dispatch");
+    s->logger = plb.create_perf_counters();
+    cct->get_perfcounters_collection()->add(s->logger);
+  }
+}
+
+void DispatchQueue::enqueue_sharded(const ref_t<Message>& m)
+{
+  // all messages of a connection go to the same shard to keep them ordered
+  auto h = std::hash<Connection*>()(m->get_connection().get());
+  auto& s = *shards[h % shards.size()];
+  std::lock_guard l{s.lock};
+  if (s.stop) {
+    dispatch_throttle_release(m->get_dispatch_throttle_size());
+    return;
+  }
+  ldout(cct,20) << "queue " << m << " to dispatch shard "
+		<< h % shards.size() << dendl;
+  s.q.push_back(m);
+  s.logger->set(l_dispatch_shard_queue_len, s.q.size());
+  if (s.q.size() == 1)
+    s.cond.notify_all();
+}
+
+void DispatchQueue::shard_entry(DispatchShard &s)
+{
+  std::unique_lock l{s.lock};
+  while (true) {
+    while (!s.q.empty()) {
+      auto m = std::move(s.q.front());
+      s.q.pop_front();
+      s.logger->set(l_dispatch_shard_queue_len, s.q.size());
+      bool stopping = s.stop;
+      l.unlock();
+
+      if (stopping) {
+	ldout(cct,10) << " stop flag set, discarding " << m << " " << *m << dendl;
+	dispatch_throttle_release(m->get_dispatch_throttle_size());
+      } else {
+	s.logger->tinc(l_dispatch_shard_queue_lat,
+		       ceph_clock_now() - m->get_recv_stamp());
+	uint64_t msize = pre_dispatch(m);
+	msgr->ms_deliver_dispatch_sharded(m);
+	post_dispatch(m, msize);
+	s.logger->inc(l_dispatch_shard_messages);
+      }
+
+      l.lock();
+    }
+    if (s.stop)
+      break;
+    s.cond.wait(l);
+  }
+}
+
 void DispatchQueue::discard_queue(uint64_t id) {
   std::lock_guard l{lock};
   std::list<QueueItem> removed;
@@ -231,12 +305,20 @@ void DispatchQueue::start()
   ceph_assert(!dispatch_thread.is_started());
   dispatch_thread.create("ms_dispatch");
   local_delivery_thread.create("ms_local");
+  for (auto& s : shards) {
+    s->create("ms_dispatch_sh");
+  }
 }
 
 void DispatchQueue::wait()
 {
   local_delivery_thread.join();
   dispatch_thread.join();
+  for (auto& s : shards) {
+    if (s->is_started()) {
+      s->join();
+    }
+  }
 }
 
 void DispatchQueue::discard_local()
@@ -258,4 +340,21 @@ void DispatchQueue::shutdown()
     stop = true;
     cond.notify_all();
   }
+  for (auto& s : shards) {
+    std::scoped_lock l{s->lock};
+    s->stop = true;
+    s->cond.notify_all();
+  }
+}
+
+DispatchQueue::~DispatchQueue()
+{
+  ceph_assert(mqueue.empty());
+  ceph_assert(marrival.empty());
+  ceph_assert(local_messages.empty());
+  for (auto& s : shards) {
+    ceph_assert(s->q.empty());
+    cct->get_perfcounters_collection()->remove(s->logger);
+    delete s->logger;
+  }
 }
@@ -16,8 +16,11 @@
 #define CEPH_DISPATCHQUEUE_H
 
 #include <atomic>
+#include <deque>
 #include <map>
+#include <memory>
 #include <queue>
+#include <vector>
 #include <boost/intrusive_ptr.hpp>
 #include "include/ceph_assert.h"
 #include "include/common_fwd.h"
@@ -31,6 +34,14 @@
 class Messenger;
 struct Connection;
 
+enum {
+  l_dispatch_shard_first = 94100,
+  l_dispatch_shard_messages,
+  l_dispatch_shard_queue_len,
+  l_dispatch_shard_queue_lat,
+  l_dispatch_shard_last,
+};
+
 /**
  * The DispatchQueue contains all the connections which have Messages
  * they want to be dispatched, carefully organized by Message priority
@@ -117,6 +128,31 @@ class DispatchQueue {
     }
   } local_delivery_thread;
 
+  /**
+   * A DispatchShard delivers, in FIFO order, the messages of the
+   * connections hashed to it which a Dispatcher accepted via
+   * ms_can_dispatch_sharded().
+   */
+  struct DispatchShard : public Thread {
+    DispatchQueue *dq;
+    ceph::mutex lock;
+    ceph::condition_variable cond;
+    std::deque<ceph::ref_t<Message>> q;
+    bool stop = false;
+    PerfCounters *logger = nullptr;
+
+    DispatchShard(DispatchQueue *dq, const std::string &name)
+      : dq(dq), lock(ceph::make_mutex("Messenger::DispatchQueue::shard" + name)) {}
+    void *entry() override {
+      dq->shard_entry(*this);
+      return 0;
+    }
+  };
+  std::vector<std::unique_ptr<DispatchShard>> shards;
+  void create_shards(const std::string &name);
+  void enqueue_sharded(const ceph::ref_t<Message>& m);
+  void shard_entry(DispatchShard &s);
+
   uint64_t pre_dispatch(const ceph::ref_t<Message>& m);
   void post_dispatch(const ceph::ref_t<Message>& m, uint64_t msize);
 
@@ -231,12 +267,10 @@ class DispatchQueue {
       dispatch_throttler(cct, std::string("msgr_dispatch_throttler-") + name,
                          cct->_conf->ms_dispatch_throttle_bytes),
       stop(false)
-    {}
-  ~DispatchQueue() {
-    ceph_assert(mqueue.empty());
-    ceph_assert(marrival.empty());
-    ceph_assert(local_messages.empty());
-  }
+    {
+      create_shards(name);
+    }
+  ~DispatchQueue();
 };
 
 #endif
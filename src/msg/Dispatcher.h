@@ -107,6 +107,23 @@ public:
     return ms_fast_preprocess(m.get());
   }
 
+  /**
+   * This function determines if a message may be dispatched on one of
+   * the sharded dispatch threads (see ms_dispatch_shards) instead of the
+   * single dispatch thread. Sharded messages are delivered via
+   * ms_dispatch2() to this Dispatcher, in receipt order within a single
+   * Connection, but concurrently with messages from other Connections
+   * and with the regular dispatch thread, so the handler must do its own
+   * locking. As with ms_can_fast_dispatch(), the answer should not depend
+   * on system state that may change.
+   *
+   * @param m The message we want to dispatch.
+   * @returns True if the message can be dispatched concurrently.
+   */
+  virtual bool ms_can_dispatch_sharded(const MessageConstRef& m) const {
+    return false;
+  }
+
   /**
    * The Messenger calls this function to deliver a single message.
    *
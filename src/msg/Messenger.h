@@ -701,6 +701,39 @@ public:
       dispatcher->ms_fast_preprocess2(m);
     }
   }
+  /**
+   * Determine whether a message can be dispatched on a dispatch shard.
+   *
+   * @param m The Message we are testing.
+   */
+  bool ms_can_dispatch_sharded(const ceph::cref_t<Message>& m) {
+    for (const auto &dispatcher : dispatchers) {
+      if (dispatcher->ms_can_dispatch_sharded(m))
+	return true;
+    }
+    return false;
+  }
+  /**
+   * Deliver a single Message from a dispatch shard to the Dispatcher
+   * which accepted it for sharded dispatch.
+   *
+   * @param m The Message to deliver.
+   */
+  void ms_deliver_dispatch_sharded(const ceph::ref_t<Message> &m) {
+    m->set_dispatch_stamp(ceph_clock_now());
+    for (const auto &dispatcher : dispatchers) {
+      if (dispatcher->ms_can_dispatch_sharded(m)) {
+	if (!dispatcher->ms_dispatch2(m)) {
+	  lsubdout(cct, ms, 0) << "ms_deliver_dispatch_sharded: unhandled message "
+			       << m << " " << *m << " from "
+			       << m->get_source_inst() << dendl;
+	  ceph_assert(!cct->_conf->ms_die_on_unhandled_msg);
+	}
+	return;
+      }
+    }
+    ceph_abort();
+  }
   /**
    *  Deliver a single Message. Send it to each Dispatcher
    *  in sequence until one of them handles it.
@@ -724,6 +724,13 @@ void AsyncConnection::mark_down()
   protocol->stop();
 }
 
+void AsyncConnection::relocate_rx_buffer(ceph_tid_t tid)
+{
+  // the protocol only reads with the lock held
+  std::lock_guard<std::mutex> l(lock);
+  protocol->relocate_rx_buffer(tid);
+}
+
 void AsyncConnection::handle_write()
 {
   ldout(async_msgr->cct, 10) << __func__ << dendl;
@@ -242,6 +242,9 @@ private:
 
   bool is_msgr2() const override;
 
+protected:
+  void relocate_rx_buffer(ceph_tid_t tid) override;
+
   friend class Protocol;
   friend class ProtocolV1;
   friend class ProtocolV2;
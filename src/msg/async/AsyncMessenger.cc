@@ -145,6 +145,23 @@ int Processor::bind(const entity_addrvec_t &bind_addrs,
     }
   }
 
+  if (conf->ms_local_unix_socket) {
+    // same-host peers may also reach us over host-local sockets; these are
+    // optional, so failing to set one up just leaves them on TCP
+    for (unsigned k = 0; k < bound_addrs->v.size(); ++k) {
+      ServerSocket local_socket;
+      int r;
+      worker->center.submit_to(
+	worker->center.get_id(),
+	[this, k, bound_addrs, &opts, &local_socket, &r]() {
+	  r = worker->listen_local(bound_addrs->v[k], k, opts, &local_socket);
+	}, false);
+      if (r == 0) {
+	listen_sockets.push_back(std::move(local_socket));
+      }
+    }
+  }
+
   ldout(msgr->cct, 10) << __func__ << " bound to " << *bound_addrs << dendl;
   return 0;
 }
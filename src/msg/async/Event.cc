@@ -115,6 +115,7 @@ int EventCenter::init(int nevent, unsigned center_id, const std::string &type)
 
   this->type = type;
   this->center_id = center_id;
+  busy_poll_us = cct->_conf->ms_async_busy_poll_us;
 
   if (type == "dpdk") {
 #ifdef HAVE_DPDK
@@ -413,7 +414,11 @@ int EventCenter::process_events(unsigned timeout_microseconds,  ceph::timespan *
 
   ldout(cct, 30) << __func__ << " wait second " << tv.tv_sec << " usec " << tv.tv_usec << dendl;
   std::vector<FiredFileEvent> fired_events;
-  numevents = driver->event_wait(fired_events, &tv);
+  if (blocking && busy_poll_us && timeout_microseconds) {
+    numevents = busy_wait(fired_events, timeout_microseconds);
+  } else {
+    numevents = driver->event_wait(fired_events, &tv);
+  }
   auto working_start = ceph::mono_clock::now();
   for (int event_id = 0; event_id < numevents; event_id++) {
     int rfired = 0;
@@ -469,6 +474,33 @@ int EventCenter::process_events(unsigned timeout_microseconds,  ceph::timespan *
   return numevents;
 }
 
+// poll for up to busy_poll_us before blocking for the rest of the timeout
+int EventCenter::busy_wait(std::vector<FiredFileEvent> &fired_events,
+			   unsigned timeout_microseconds)
+{
+  unsigned spin_us = std::min(timeout_microseconds, busy_poll_us);
+  auto until = ceph::mono_clock::now() + std::chrono::microseconds(spin_us);
+  struct timeval tv = {0, 0};
+  int numevents = 0;
+  spinning = true;
+  do {
+    numevents = driver->event_wait(fired_events, &tv);
+    if (numevents || external_num_events.load()) {
+      spinning = false;
+      return numevents;
+    }
+  } while (ceph::mono_clock::now() < until);
+  spinning = false;
+  // dispatch_event_external() skipped the wakeup if it saw us spinning
+  if (external_num_events.load()) {
+    return 0;
+  }
+  timeout_microseconds -= spin_us;
+  tv.tv_sec = timeout_microseconds / 1000000;
+  tv.tv_usec = timeout_microseconds % 1000000;
+  return driver->event_wait(fired_events, &tv);
+}
+
 void EventCenter::dispatch_event_external(EventCallbackRef e)
 {
   uint64_t num = 0;
@@ -480,7 +512,7 @@ void EventCenter::dispatch_event_external(EventCallbackRef e)
     external_events.push_back(e);
     num = ++external_num_events;
   }
-  if (num == 1 && !in_thread())
+  if (num == 1 && !in_thread() && !spinning.load())
     wakeup();
 
   ldout(cct, 30) << __func__ << " " << e << " pending " << num << dendl;
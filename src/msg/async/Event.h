@@ -164,6 +164,9 @@ class EventCenter {
   std::mutex external_lock;
   std::atomic_ulong external_num_events;
   std::deque<EventCallbackRef> external_events;
+  /// owner is busy polling and will see new external events without wakeup
+  std::atomic_bool spinning = {false};
+  unsigned busy_poll_us = 0;
   std::vector<FileEvent> file_events;
   EventDriver *driver;
   std::multimap<clock_type::time_point, TimeEvent> time_events;
@@ -181,6 +184,8 @@ class EventCenter {
   AssociatedCenters *global_centers = nullptr;
 
   int process_time_events();
+  int busy_wait(std::vector<FiredFileEvent> &fired_events,
+		unsigned timeout_microseconds);
   FileEvent *_get_file_event(int fd) {
     ceph_assert(fd < nevent);
     return &file_events[fd];
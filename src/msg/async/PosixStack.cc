@@ -21,6 +21,15 @@
 #include <errno.h>
 
 #include <algorithm>
+#include <deque>
+
+#if defined(__linux__)
+#include <sys/un.h>
+#include <linux/errqueue.h>
+#endif
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#define HAVE_MSG_ZEROCOPY
+#endif
 
 #include "PosixStack.h"
 
@@ -37,16 +46,59 @@
 #undef dout_prefix
 #define dout_prefix *_dout << "PosixStack "
 
+#if defined(__linux__)
+/// abstract unix socket address under which @a is also reachable locally
+static socklen_t local_sockaddr(const entity_addr_t &a, sockaddr_un *sun)
+{
+  std::ostringstream ss;
+  ss << "ceph-msgr-" << a.get_sockaddr();
+  std::string name = ss.str();
+  memset(sun, 0, sizeof(*sun));
+  sun->sun_family = AF_UNIX;
+  // sun_path[0] == '\0' makes it abstract: no file, gone with the socket
+  size_t len = std::min(name.size(), sizeof(sun->sun_path) - 1);
+  memcpy(sun->sun_path + 1, name.data(), len);
+  return offsetof(sockaddr_un, sun_path) + 1 + len;
+}
+
+static bool can_use_local(CephContext *cct, const entity_addr_t &a)
+{
+  return cct->_conf->ms_local_unix_socket &&
+    a.is_msgr2() && a.is_ip() && !a.is_blank_ip() && a.get_port();
+}
+#endif
+
 class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   ceph::NetHandler &handler;
   int _fd;
   entity_addr_t sa;
   bool connected;
+  bool local = false;  ///< unix socket to a peer on this host
+
+#ifdef HAVE_MSG_ZEROCOPY
+  /// sends of at least this many bytes use MSG_ZEROCOPY; 0 if off
+  uint64_t zerocopy_threshold;
+  bool zerocopy_enabled = false;  ///< SO_ZEROCOPY is set on the socket
+  /// data handed to the kernel by zerocopy sends, which must stay
+  /// untouched until the kernel reports the send call @last done
+  struct ZeroCopyPending {
+    uint32_t last;
+    ceph::buffer::list bl;
+  };
+  std::deque<ZeroCopyPending> zerocopy_pending;
+  uint32_t zerocopy_next = 0;  ///< id the kernel gives the next zerocopy send
+  uint32_t zerocopy_done = 0;  ///< ids below this are complete
+#endif
 
  public:
   explicit PosixConnectedSocketImpl(ceph::NetHandler &h, const entity_addr_t &sa,
 				    int f, bool connected)
-      : handler(h), _fd(f), sa(sa), connected(connected) {}
+      : handler(h), _fd(f), sa(sa), connected(connected)
+#ifdef HAVE_MSG_ZEROCOPY
+      , zerocopy_threshold(
+	  h.get_cct()->_conf.get_val<Option::size_t>("ms_tcp_zerocopy_threshold"))
+#endif
+  {}
 
   int is_connected() override {
     if (connected)
@@ -64,6 +116,10 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
 
   ssize_t read(char *buf, size_t len) override {
+#ifdef HAVE_MSG_ZEROCOPY
+    // completions raise EPOLLERR, which is reported as readable
+    reap_zerocopy();
+#endif
     #ifdef _WIN32
     ssize_t r = ::recv(_fd, buf, len, 0);
     #else
@@ -77,13 +133,14 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   // return the sent length
   // < 0 means error occurred
   #ifndef _WIN32
-  static ssize_t do_sendmsg(int fd, struct msghdr &msg, unsigned len, bool more)
+  static ssize_t do_sendmsg(int fd, struct msghdr &msg, unsigned len, bool more,
+			    int flags = 0, uint32_t *calls = nullptr)
   {
     size_t sent = 0;
     while (1) {
       MSGR_SIGPIPE_STOPPER;
       ssize_t r;
-      r = ::sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+      r = ::sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0) | flags);
       if (r < 0) {
         int err = ceph_sock_errno();
         if (err == EINTR) {
@@ -91,8 +148,15 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
         } else if (err == EAGAIN) {
           break;
         }
+        if (sent && err == ENOBUFS) {
+          // out of pinned memory for zerocopy; let the caller retry
+          break;
+        }
         return -err;
       }
+      if (calls) {
+        ++*calls;
+      }
 
       sent += r;
       if (len == sent) break;
@@ -113,7 +177,74 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
     return (ssize_t)sent;
   }
 
+#ifdef HAVE_MSG_ZEROCOPY
+  bool want_zerocopy(const ceph::buffer::list &bl) {
+    if (!zerocopy_threshold || bl.length() < zerocopy_threshold) {
+      return false;
+    }
+    if (!zerocopy_enabled) {
+      int one = 1;
+      if (::setsockopt(_fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) < 0) {
+        ldout(handler.get_cct(), 1) << __func__ << " SO_ZEROCOPY not supported: "
+                              << cpp_strerror(ceph_sock_errno()) << dendl;
+        zerocopy_threshold = 0;
+        return false;
+      }
+      zerocopy_enabled = true;
+    }
+    return true;
+  }
+
+  /// release the data of zerocopy sends the kernel is done with
+  void reap_zerocopy() {
+    if (!zerocopy_enabled) {
+      return;
+    }
+    while (!zerocopy_pending.empty()) {
+      char control[128];
+      struct msghdr msg;
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+      if (::recvmsg(_fd, &msg, MSG_ERRQUEUE) < 0) {
+        break;  // nothing more yet
+      }
+      for (auto cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+            !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+          continue;
+        }
+        auto serr = reinterpret_cast<struct sock_extended_err*>(CMSG_DATA(cm));
+        if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+          continue;
+        }
+        if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+          // the kernel had to copy after all (e.g. loopback); zerocopy only
+          // adds overhead on this connection
+          ldout(handler.get_cct(), 10) << __func__ << " kernel copied zerocopy send,"
+                                 << " disabling" << dendl;
+          zerocopy_threshold = 0;
+        }
+        // [ee_info, ee_data] are done; tcp completes sends in order
+        zerocopy_done = serr->ee_data + 1;
+      }
+    }
+    while (!zerocopy_pending.empty() &&
+           (int32_t)(zerocopy_pending.front().last - zerocopy_done) < 0) {
+      zerocopy_pending.pop_front();
+    }
+  }
+#endif
+
   ssize_t send(ceph::buffer::list &bl, bool more) override {
+    int flags = 0;
+#ifdef HAVE_MSG_ZEROCOPY
+    reap_zerocopy();
+    uint32_t zerocopy_calls = 0;
+    if (want_zerocopy(bl)) {
+      flags = MSG_ZEROCOPY;
+    }
+#endif
     size_t sent_bytes = 0;
     auto pb = std::cbegin(bl.buffers());
     uint64_t left_pbrs = bl.get_num_buffers();
@@ -133,7 +264,17 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
 	msglen += pb->length();
 	++pb;
       }
+#ifdef HAVE_MSG_ZEROCOPY
+      ssize_t r = do_sendmsg(_fd, msg, msglen, left_pbrs || more, flags,
+                             &zerocopy_calls);
+      if (r == -ENOBUFS && flags) {
+        // over the socket's optmem limit; copy this time
+        flags = 0;
+        r = do_sendmsg(_fd, msg, msglen, left_pbrs || more);
+      }
+#else
       ssize_t r = do_sendmsg(_fd, msg, msglen, left_pbrs || more);
+#endif
       if (r < 0)
         return r;
 
@@ -144,6 +285,15 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
       // only "r" == 0 continue
     }
 
+#ifdef HAVE_MSG_ZEROCOPY
+    if (zerocopy_calls) {
+      // keep the sent data referenced until the kernel is done with it
+      zerocopy_next += zerocopy_calls;
+      zerocopy_pending.push_back({zerocopy_next - 1, {}});
+      bl.splice(0, sent_bytes, &zerocopy_pending.back().bl);
+      return static_cast<ssize_t>(sent_bytes);
+    }
+#endif
     if (sent_bytes) {
       ceph::buffer::list swapped;
       if (sent_bytes < bl.length()) {
@@ -207,6 +357,9 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
     compat_closesocket(_fd);
   }
   void set_priority(int sd, int prio, int domain) override {
+    if (local) {
+      return;  // no IP_TOS on unix sockets
+    }
     handler.set_priority(sd, prio, domain);
   }
   int fd() const override {
@@ -214,17 +367,25 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
   friend class PosixServerSocketImpl;
   friend class PosixNetworkStack;
+  friend class PosixWorker;
 };
 
 class PosixServerSocketImpl : public ServerSocketImpl {
   ceph::NetHandler &handler;
   int _fd;
+  /// set if this is the host-local socket of listen_addr
+  std::optional<entity_addr_t> local_addr;
 
  public:
   explicit PosixServerSocketImpl(ceph::NetHandler &h, int f,
-				 const entity_addr_t& listen_addr, unsigned slot)
+				 const entity_addr_t& listen_addr, unsigned slot,
+				 bool local = false)
     : ServerSocketImpl(listen_addr.get_type(), slot),
-      handler(h), _fd(f) {}
+      handler(h), _fd(f) {
+    if (local) {
+      local_addr = listen_addr;
+    }
+  }
   int accept(ConnectedSocket *sock, const SocketOptions &opts, entity_addr_t *out, Worker *w) override;
   void abort_accept() override {
     ::close(_fd);
@@ -250,14 +411,26 @@ int PosixServerSocketImpl::accept(ConnectedSocket *sock, const SocketOptions &op
     return -ceph_sock_errno();
   }
 
+  ceph_assert(NULL != out); //out should not be NULL in accept connection
+
+  if (local_addr) {
+    // the peer is on this host, so it comes from our own IP
+    *out = *local_addr;
+    out->set_port(0);
+    out->set_nonce(0);
+    std::unique_ptr<PosixConnectedSocketImpl> csi(
+      new PosixConnectedSocketImpl(handler, *out, sd, true));
+    csi->local = true;
+    *sock = ConnectedSocket(std::move(csi));
+    return 0;
+  }
+
   r = handler.set_socket_options(sd, opt.nodelay, opt.rcbuf_size);
   if (r < 0) {
     ::close(sd);
     return -ceph_sock_errno();
   }
 
-  ceph_assert(NULL != out); //out should not be NULL in accept connection
-
   out->set_type(addr_type);
   out->set_sockaddr((sockaddr*)&ss);
   handler.set_priority(sd, opt.priority, out->get_family());
@@ -316,9 +489,87 @@ int PosixWorker::listen(entity_addr_t &sa,
   return 0;
 }
 
+int PosixWorker::listen_local(const entity_addr_t &sa,
+			      unsigned addr_slot,
+			      const SocketOptions &opt,
+			      ServerSocket *sock)
+{
+#if defined(__linux__)
+  if (!can_use_local(cct, sa)) {
+    return -EOPNOTSUPP;
+  }
+  int listen_sd = net.create_socket(AF_UNIX);
+  if (listen_sd < 0) {
+    return listen_sd;
+  }
+  int r = net.set_nonblock(listen_sd);
+  if (r < 0) {
+    ::close(listen_sd);
+    return r;
+  }
+  sockaddr_un sun;
+  socklen_t len = local_sockaddr(sa, &sun);
+  if (::bind(listen_sd, (sockaddr*)&sun, len) < 0 ||
+      ::listen(listen_sd, cct->_conf->ms_tcp_listen_backlog) < 0) {
+    r = -ceph_sock_errno();
+    ldout(cct, 1) << __func__ << " unable to listen locally for " << sa
+		  << ": " << cpp_strerror(r) << dendl;
+    ::close(listen_sd);
+    return r;
+  }
+  ldout(cct, 10) << __func__ << " " << sa << " on local socket" << dendl;
+  *sock = ServerSocket(
+    std::unique_ptr<PosixServerSocketImpl>(
+      new PosixServerSocketImpl(net, listen_sd, sa, addr_slot, true)));
+  return 0;
+#else
+  return -EOPNOTSUPP;
+#endif
+}
+
+int PosixWorker::connect_local(const entity_addr_t &addr,
+			       const SocketOptions &opts,
+			       ConnectedSocket *socket)
+{
+#if defined(__linux__)
+  int sd = net.create_socket(AF_UNIX);
+  if (sd < 0) {
+    return sd;
+  }
+  if (opts.nonblock && net.set_nonblock(sd) < 0) {
+    ::close(sd);
+    return -EIO;
+  }
+  sockaddr_un sun;
+  socklen_t len = local_sockaddr(addr, &sun);
+  // nobody listening gives ECONNREFUSED right away; a full backlog gives
+  // EAGAIN, in which case TCP is as good
+  if (::connect(sd, (sockaddr*)&sun, len) < 0) {
+    int r = -ceph_sock_errno();
+    ::close(sd);
+    return r;
+  }
+  ldout(cct, 10) << __func__ << " connected to " << addr
+		 << " on local socket" << dendl;
+  std::unique_ptr<PosixConnectedSocketImpl> csi(
+    new PosixConnectedSocketImpl(net, addr, sd, true));
+  csi->local = true;
+  *socket = ConnectedSocket(std::move(csi));
+  return 0;
+#else
+  return -EOPNOTSUPP;
+#endif
+}
+
 int PosixWorker::connect(const entity_addr_t &addr, const SocketOptions &opts, ConnectedSocket *socket) {
   int sd;
 
+#if defined(__linux__)
+  if (can_use_local(cct, addr) && connect_local(addr, opts, socket) == 0) {
+    return 0;
+  }
+#endif
+
   if (opts.nonblock) {
     sd = net.nonblock_connect(addr, opts.connect_bind_addr);
   } else {
@@ -35,6 +35,11 @@ class PosixWorker : public Worker {
 	     const SocketOptions &opt,
 	     ServerSocket *socks) override;
   int connect(const entity_addr_t &addr, const SocketOptions &opts, ConnectedSocket *socket) override;
+  int listen_local(const entity_addr_t &addr, unsigned addr_slot,
+		   const SocketOptions &opts, ServerSocket *sock) override;
+ private:
+  int connect_local(const entity_addr_t &addr, const SocketOptions &opts,
+		    ConnectedSocket *socket);
 };
 
 class PosixNetworkStack : public NetworkStack {
@@ -132,6 +132,10 @@ public:
   virtual void write_event() = 0;
   virtual bool is_queued() = 0;
 
+  // stop reading into the rx buffer claimed for tid, see
+  // Connection::relocate_rx_buffer()
+  virtual void relocate_rx_buffer(ceph_tid_t tid) {}
+
   int get_con_mode() const {
     return auth_meta->con_mode;
   }
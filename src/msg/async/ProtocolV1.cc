@@ -811,32 +811,18 @@ CtPtr ProtocolV1::read_message_data_prepare() {
 
   if (data_len) {
     // get a buffer
-#if 0
-    // rx_buffers is broken by design... see
-    //  http://tracker.ceph.com/issues/22480
-    map<ceph_tid_t, pair<ceph::buffer::list, int> >::iterator p =
-        connection->rx_buffers.find(current_header.tid);
-    if (p != connection->rx_buffers.end()) {
-      ldout(cct, 10) << __func__ << " seleting rx buffer v " << p->second.second
-                     << " at offset " << data_off << " len "
-                     << p->second.first.length() << dendl;
-      data_buf = p->second.first;
-      // make sure it's big enough
-      if (data_buf.length() < data_len)
-        data_buf.push_back(buffer::create(data_len - data_buf.length()));
-      data_blp = data_buf.begin();
+    ceph::buffer::ptr bp;
+    if (connection->claim_rx_buffer(current_header.tid, data_len, &bp)) {
+      ldout(cct, 10) << __func__ << " selecting rx buffer for tid "
+                     << current_header.tid << " len " << data_len << dendl;
+      rx_user_tid = current_header.tid;
+      data_buf.push_back(std::move(bp));
     } else {
       ldout(cct, 20) << __func__ << " allocating new rx buffer at offset "
                      << data_off << dendl;
       alloc_aligned_buffer(data_buf, data_len, data_off);
-      data_blp = data_buf.begin();
     }
-#else
-    ldout(cct, 20) << __func__ << " allocating new rx buffer at offset "
-		   << data_off << dendl;
-    alloc_aligned_buffer(data_buf, data_len, data_off);
     data_blp = data_buf.begin();
-#endif
   }
 
   msg_left = data_len;
@@ -876,9 +862,48 @@ CtPtr ProtocolV1::handle_message_data(char *buffer, int r) {
   return CONTINUE(read_message_data);
 }
 
+void ProtocolV1::release_rx_buffer() {
+  if (rx_user_tid) {
+    connection->release_rx_buffer();
+    rx_user_tid = 0;
+  }
+}
+
+void ProtocolV1::relocate_rx_buffer(ceph_tid_t tid) {
+  if (rx_user_tid != tid || !connection->unclaim_rx_buffer(tid)) {
+    return;
+  }
+  // Revoked while we are reading into it: carry on in our own buffer.
+  // connection->lock is held, so we are between two chunks; data holds
+  // what those before have read and a pending one has state_offset more.
+  unsigned got = data.length();
+  const char *old_buf = data_buf.front().c_str();
+  ceph::buffer::ptr bp(data_buf.length());
+  if (connection->pendingReadLen &&
+      connection->read_buffer == old_buf + got) {
+    bp.copy_in(0, got + connection->state_offset, old_buf);
+    connection->read_buffer = bp.c_str() + got;
+  } else {
+    bp.copy_in(0, got, old_buf);
+  }
+  ldout(cct, 10) << __func__ << " tid " << tid << " revoked after " << got
+                 << " of " << bp.length() << " bytes" << dendl;
+  data_buf.clear();
+  data_buf.push_back(bp);
+  data_blp = data_buf.begin();
+  data_blp += got;
+  data.clear();
+  if (got) {
+    data.append(bp, 0, got);
+  }
+  rx_user_tid = 0;
+}
+
 CtPtr ProtocolV1::read_message_footer() {
   ldout(cct, 20) << __func__ << dendl;
 
+  release_rx_buffer();
+
   state = READ_FOOTER_AND_DISPATCH;
 
   unsigned len;
@@ -1291,6 +1316,7 @@ void ProtocolV1::reset_recv_state()
   // clean read and write callbacks
   connection->pendingReadLen.reset();
   connection->writeCallback.reset();
+  release_rx_buffer();
 
   if (state > THROTTLE_MESSAGE && state <= READ_FOOTER_AND_DISPATCH &&
       connection->policy.throttler_messages) {
@@ -132,6 +132,7 @@ protected:
   ceph::buffer::list data_buf;
   ceph::buffer::list::iterator data_blp;
   ceph::buffer::list front, middle, data;
+  ceph_tid_t rx_user_tid = 0;  // data_buf was posted by the user for this tid
 
   bool replacing;  // when replacing process happened, we will reply connect
                    // side with RETRY tag and accept side will clear replaced
@@ -205,6 +206,7 @@ protected:
 
   void reset_recv_state();
   void reset_security();
+  void release_rx_buffer();
 
   std::ostream& _conn_prefix(std::ostream *_dout);
 
@@ -223,6 +225,7 @@ public:
   virtual void read_event() override;
   virtual void write_event() override;
   virtual bool is_queued() override;
+  virtual void relocate_rx_buffer(ceph_tid_t tid) override;
 
   // Client Protocol
 private:
@@ -266,6 +266,7 @@ void ProtocolV2::reset_recv_state() {
   // clean read and write callbacks
   connection->pendingReadLen.reset();
   connection->writeCallback.reset();
+  release_rx_buffer();
 
   next_tag = static_cast<Tag>(0);
 
@@ -517,7 +518,7 @@ ProtocolV2::out_queue_entry_t ProtocolV2::_get_next_outgoing() {
   return out_entry;
 }
 
-ssize_t ProtocolV2::write_message(Message *m, bool more) {
+ssize_t ProtocolV2::write_message(Message *m, bool more, bool flush) {
   FUNCTRACE(cct);
   ceph_assert(connection->center->in_thread());
   m->set_seq(++out_seq);
@@ -556,6 +557,11 @@ ssize_t ProtocolV2::write_message(Message *m, bool more) {
                  << " src=" << entity_name_t(messenger->get_myname())
                  << " off=" << header2.data_off
                  << dendl;
+  if (!flush) {
+    // frame stays in outgoing_bl until the coalesced send
+    m->put();
+    return 0;
+  }
   ssize_t total_send_size = connection->outgoing_bl.length();
   ssize_t rc = connection->_try_send(more);
   if (rc < 0) {
@@ -655,8 +661,13 @@ void ProtocolV2::write_event() {
 
     auto start = ceph::mono_clock::now();
     bool more;
+    // frames of messages appended to outgoing_bl but not sent yet
+    unsigned coalesced = 0;
+    const uint64_t coalesce_bytes = cct->_conf->ms_async_coalesce_bytes;
+    const auto coalesce_until = start +
+      std::chrono::microseconds(cct->_conf->ms_async_coalesce_max_us);
     do {
-      if (connection->is_queued()) {
+      if (!coalesced && connection->is_queued()) {
 	if (r = connection->_try_send(); r!= 0) {
 	  // either fails to send or not all queued buffer is sent
 	  break;
@@ -687,7 +698,19 @@ void ProtocolV2::write_event() {
 				 out_entry.m->queue_start);
       }
 
-      r = write_message(out_entry.m, more);
+      // hold the frame back while more messages are queued, within the
+      // coalescing byte and time budget
+      bool flush = !more ||
+	connection->outgoing_bl.length() >= coalesce_bytes ||
+	ceph::mono_clock::now() >= coalesce_until;
+      r = write_message(out_entry.m, more, flush);
+      if (!flush) {
+	coalesced++;
+      } else if (coalesced) {
+	connection->logger->inc(l_msgr_send_coalesced_messages, coalesced);
+	connection->logger->inc(l_msgr_send_coalesced_flushes);
+	coalesced = 0;
+      }
 
       connection->write_lock.lock();
       if (r == 0) {
@@ -1031,7 +1054,8 @@ CtPtr ProtocolV2::handle_hello(ceph::bufferlist &payload)
   if (messenger->get_myaddrs().empty() ||
       messenger->get_myaddrs().front().is_blank_ip()) {
     entity_addr_t a;
-    if (cct->_conf->ms_learn_addr_from_peer) {
+    // a host-local socket has no IP to learn from
+    if (cct->_conf->ms_learn_addr_from_peer || ss.ss_family == AF_UNIX) {
       ldout(cct, 1) << __func__ << " peer " << connection->target_addr
 		    << " says I am " << hello.peer_addr() << " (socket says "
 		    << (sockaddr*)&ss << ")" << dendl;
@@ -1187,6 +1211,9 @@ CtPtr ProtocolV2::read_frame_segment() {
   }
 
   rx_buffer_t rx_buffer;
+  if (claim_rx_buffer(seg_idx, onwire_len, &rx_buffer)) {
+    return READ_RXBUF(std::move(rx_buffer), handle_read_frame_segment);
+  }
   uint16_t align = rx_frame_asm.get_segment_align(seg_idx);
   try {
     rx_buffer = ceph::buffer::ptr_node::create(ceph::buffer::create_aligned(
@@ -1212,10 +1239,73 @@ CtPtr ProtocolV2::handle_read_frame_segment(rx_buffer_t &&rx_buffer, int r) {
     return _fault();
   }
 
+  release_rx_buffer();
   rx_segments_data.back().push_back(std::move(rx_buffer));
   return _handle_read_frame_segment();
 }
 
+bool ProtocolV2::claim_rx_buffer(size_t seg_idx, uint32_t onwire_len,
+                                 rx_buffer_t *rx_buffer) {
+  // Only the data of a message, and only once its header is known.  The
+  // header hasn't been crc-checked yet; if it is garbled we may fill the
+  // wrong buffer, but the frame then fails its crc and the op is resent.
+  if (next_tag != Tag::MESSAGE ||
+      seg_idx != SegmentIndex::Msg::DATA ||
+      !rx_frame_asm.is_segment_plain(seg_idx)) {
+    return false;
+  }
+  auto& header_bl = rx_segments_data[SegmentIndex::Msg::HEADER];
+  if (header_bl.length() < sizeof(ceph_msg_header2)) {
+    return false;
+  }
+  auto header = reinterpret_cast<const ceph_msg_header2*>(header_bl.c_str());
+  ceph_tid_t tid = header->tid;
+  ceph::buffer::ptr bp;
+  if (!connection->claim_rx_buffer(tid, onwire_len, &bp)) {
+    return false;
+  }
+  ldout(cct, 20) << __func__ << " reading " << onwire_len
+                 << " bytes into rx buffer for tid " << tid << dendl;
+  *rx_buffer = ceph::buffer::ptr_node::create(std::move(bp));
+  rx_user_node = rx_buffer->get();
+  rx_user_tid = tid;
+  return true;
+}
+
+void ProtocolV2::release_rx_buffer() {
+  if (rx_user_node) {
+    connection->release_rx_buffer();
+    rx_user_node = nullptr;
+    rx_user_tid = 0;
+  }
+}
+
+void ProtocolV2::relocate_rx_buffer(ceph_tid_t tid) {
+  if (!rx_user_node || rx_user_tid != tid ||
+      !connection->unclaim_rx_buffer(tid)) {
+    return;
+  }
+  // Revoked while we are reading into it: carry on in our own buffer.
+  // connection->lock is held, so the read is between two chunks and
+  // state_offset bytes of it have arrived.
+  ldout(cct, 10) << __func__ << " tid " << tid << " revoked after "
+                 << connection->state_offset << " of "
+                 << rx_user_node->length() << " bytes" << dendl;
+  const char *old_buf = rx_user_node->c_str();
+  ceph::buffer::ptr bp(ceph::buffer::create_aligned(
+    rx_user_node->length(),
+    rx_frame_asm.get_segment_align(SegmentIndex::Msg::DATA)));
+  if (connection->pendingReadLen && connection->read_buffer == old_buf) {
+    bp.copy_in(0, connection->state_offset, old_buf);
+    connection->read_buffer = bp.c_str();
+  } else {
+    bp.copy_in(0, bp.length(), old_buf);
+  }
+  static_cast<ceph::buffer::ptr&>(*rx_user_node) = std::move(bp);
+  rx_user_node = nullptr;
+  rx_user_tid = 0;
+}
+
 CtPtr ProtocolV2::_handle_read_frame_segment() {
   if (rx_segments_data.size() == rx_frame_asm.get_num_segments()) {
     // OK, all segments planned to read are read. Can go with epilogue.
@@ -2162,7 +2252,9 @@ CtPtr ProtocolV2::handle_compression_done(ceph::bufferlist &payload) {
   ldout(cct, 10) << __func__ << " CompressionDoneFrame(is_compress=" << response.is_compress()
 		 << ", method=" << response.method() << ")" << dendl;
 
-  comp_meta.con_method = static_cast<Compressor::CompressionAlgorithm>(response.method());
+  comp_meta.con_method = static_cast<Compressor::CompressionAlgorithm>(
+    response.method() & ~CompressorRegistry::METHOD_STREAM);
+  comp_meta.con_stream = response.method() & CompressorRegistry::METHOD_STREAM;
   if (comp_meta.is_compress() != response.is_compress()) {
     comp_meta.con_mode = Compressor::COMP_NONE;
   }
@@ -3004,18 +3096,26 @@ CtPtr ProtocolV2::handle_compression_request(ceph::bufferlist &payload) {
   if (Compressor::CompressionMode mode = messenger->comp_registry.get_mode(
         peer_type, auth_meta->is_mode_secure());
       mode != Compressor::COMP_NONE && request.is_compress()) {
-    comp_meta.con_method = messenger->comp_registry.pick_method(peer_type, request.preferred_methods());
+    const uint32_t method = messenger->comp_registry.pick_method(peer_type, request.preferred_methods());
+    comp_meta.con_method = static_cast<Compressor::CompressionAlgorithm>(
+      method & ~CompressorRegistry::METHOD_STREAM);
+    comp_meta.con_stream = method & CompressorRegistry::METHOD_STREAM;
     ldout(cct, 10) << __func__ << " Compressor(pick_method=" 
                    << Compressor::get_comp_alg_name(comp_meta.get_method())
+                   << (comp_meta.is_stream() ? " stream" : "")
                    << ")" << dendl;
     if (comp_meta.con_method != Compressor::COMP_ALG_NONE) {
       comp_meta.con_mode = mode;
     }
   } else {
     comp_meta.con_method = Compressor::COMP_ALG_NONE;
+    comp_meta.con_stream = false;
   }
   
-  auto response = CompressionDoneFrame::Encode(comp_meta.is_compress(), comp_meta.get_method());
+  auto response = CompressionDoneFrame::Encode(
+    comp_meta.is_compress(),
+    comp_meta.get_method() |
+      (comp_meta.is_stream() ? CompressorRegistry::METHOD_STREAM : 0));
 
   INTERCEPT(20);
   return WRITE(response, "compression done", finish_compression);
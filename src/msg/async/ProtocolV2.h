@@ -108,6 +108,9 @@ private:
   ceph::bufferlist rx_preamble;
   ceph::bufferlist rx_epilogue;
   ceph::msgr::v2::segment_bls_t rx_segments_data;
+  // the segment being read into a buffer posted by the user, if any
+  ceph::buffer::ptr_node *rx_user_node = nullptr;
+  ceph_tid_t rx_user_tid = 0;
   ceph::msgr::v2::Tag next_tag;
   utime_t backoff;  // backoff time
   utime_t recv_stamp;
@@ -145,12 +148,15 @@ private:
   void reset_recv_state();
   void reset_security();
   void reset_throttle();
+  bool claim_rx_buffer(size_t seg_idx, uint32_t onwire_len,
+                       rx_buffer_t *rx_buffer);
+  void release_rx_buffer();
   Ct<ProtocolV2> *_fault();
   void discard_out_queue();
   void reset_session();
   void prepare_send_message(uint64_t features, Message *m);
   out_queue_entry_t _get_next_outgoing();
-  ssize_t write_message(Message *m, bool more);
+  ssize_t write_message(Message *m, bool more, bool flush = true);
   void handle_message_ack(uint64_t seq);
   void reset_compression();
 
@@ -217,6 +223,7 @@ public:
   virtual void read_event() override;
   virtual void write_event() override;
   virtual bool is_queued() override;
+  virtual void relocate_rx_buffer(ceph_tid_t tid) override;
 
 private:
   // Client Protocol
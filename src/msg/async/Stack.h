@@ -211,6 +211,9 @@ enum {
   l_msgr_recv_encrypted_bytes,
   l_msgr_send_encrypted_bytes,
 
+  l_msgr_send_coalesced_messages,
+  l_msgr_send_coalesced_flushes,
+
   l_msgr_last,
 };
 
@@ -257,6 +260,9 @@ class Worker {
     plb.add_u64_counter(l_msgr_recv_encrypted_bytes, "msgr_recv_encrypted_bytes", "Network received encrypted bytes", NULL, 0, unit_t(UNIT_BYTES));
     plb.add_u64_counter(l_msgr_send_encrypted_bytes, "msgr_send_encrypted_bytes", "Network sent encrypted bytes", NULL, 0, unit_t(UNIT_BYTES));
 
+    plb.add_u64_counter(l_msgr_send_coalesced_messages, "msgr_send_coalesced_messages", "Network sent messages written together with a later one");
+    plb.add_u64_counter(l_msgr_send_coalesced_flushes, "msgr_send_coalesced_flushes", "Network sends covering more than one message");
+
     perf_logger = plb.create_perf_counters();
     cct->get_perfcounters_collection()->add(perf_logger);
   }
@@ -271,6 +277,12 @@ class Worker {
                      const SocketOptions &opts, ServerSocket *) = 0;
   virtual int connect(const entity_addr_t &addr,
                       const SocketOptions &opts, ConnectedSocket *socket) = 0;
+  /// in addition to listen() on @addr, accept peers on the same host over
+  /// a host-local transport (see ms_local_unix_socket)
+  virtual int listen_local(const entity_addr_t &addr, unsigned addr_slot,
+                           const SocketOptions &opts, ServerSocket *) {
+    return -EOPNOTSUPP;
+  }
   virtual void destroy() {}
 
   virtual void initialize() {}
@@ -8,6 +8,7 @@ struct CompConnectionMeta {
     TOPNSPC::Compressor::COMP_NONE;  // negotiated mode
   TOPNSPC::Compressor::CompressionAlgorithm con_method =
     TOPNSPC::Compressor::COMP_ALG_NONE; // negotiated method
+  bool con_stream = false; // one compression stream for the whole session
 
   bool is_compress() const {
     return con_mode != TOPNSPC::Compressor::COMP_NONE;
@@ -18,4 +19,7 @@ struct CompConnectionMeta {
   TOPNSPC::Compressor::CompressionMode get_mode() const {
     return con_mode;
   }
+  bool is_stream() const {
+    return con_stream;
+  }
 };
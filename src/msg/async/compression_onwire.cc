@@ -4,6 +4,7 @@
 #include "compression_onwire.h"
 #include "compression_meta.h"
 #include "common/dout.h"
+#include "common/errno.h"
 
 #define dout_subsys ceph_subsys_ms
 
@@ -16,7 +17,18 @@ rxtx_t rxtx_t::create_handler_pair(
 {
   if (comp_meta.is_compress()) {
      CompressorRef compressor = Compressor::create(ctx, comp_meta.get_method());
-    if (compressor) {
+    if (compressor && comp_meta.is_stream()) {
+      auto rx_stream = compressor->create_stream();
+      auto tx_stream = compressor->create_stream();
+      if (rx_stream && tx_stream) {
+	return {std::make_unique<RxHandler>(ctx, compressor,
+					    std::move(rx_stream)),
+		std::make_unique<TxHandler>(ctx, compressor,
+					    comp_meta.get_mode(),
+					    compress_min_size,
+					    std::move(tx_stream))};
+      }
+    } else if (compressor) {
       return {std::make_unique<RxHandler>(ctx, compressor),
 	      std::make_unique<TxHandler>(ctx, compressor,
 					  comp_meta.get_mode(),
@@ -34,6 +46,9 @@ std::optional<ceph::bufferlist> TxHandler::compress(const ceph::bufferlist &inpu
 		     << dendl;
     return {};
   }
+  if (m_stream_broken) {
+    return {};
+  }
 
   m_compress_potential -= input.length();
 
@@ -46,8 +61,20 @@ std::optional<ceph::bufferlist> TxHandler::compress(const ceph::bufferlist &inpu
     return out;
   }
 
-  std::optional<int32_t> compressor_message;
-  if (m_compressor->compress(input, out, compressor_message)) {
+  int r;
+  if (m_stream) {
+    r = m_stream->compress(input, out);
+    if (r) {
+      ldout(m_cct, 1) << __func__ << " stream compression failed: "
+		      << cpp_strerror(r) << ", not compressing anymore"
+		      << dendl;
+      m_stream_broken = true;
+    }
+  } else {
+    std::optional<int32_t> compressor_message;
+    r = m_compressor->compress(input, out, compressor_message);
+  }
+  if (r) {
     return {};
   } else {
     ldout(m_cct, 20) << __func__ << " uncompressed.length()=" << input.length()
@@ -68,8 +95,14 @@ std::optional<ceph::bufferlist> RxHandler::decompress(const ceph::bufferlist &in
     return out;
   }
 
-  std::optional<int32_t> compressor_message;
-  if (m_compressor->decompress(input, out, compressor_message)) {
+  int r;
+  if (m_stream) {
+    r = m_stream->decompress(input, out);
+  } else {
+    std::optional<int32_t> compressor_message;
+    r = m_compressor->decompress(input, out, compressor_message);
+  }
+  if (r) {
     return {};
   } else {
     ldout(m_cct, 20) << __func__ << " compressed.length()=" << input.length()
@@ -5,6 +5,7 @@
 #define CEPH_COMPRESSION_ONWIRE_H
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 
 #include "compressor/Compressor.h"
@@ -18,18 +19,23 @@ namespace ceph::compression::onwire {
 
   class Handler {
   public:
-    Handler(CephContext* const cct, CompressorRef compressor)
-      : m_cct(cct), m_compressor(compressor) {}
+    Handler(CephContext* const cct, CompressorRef compressor,
+	    std::unique_ptr<Compressor::Stream> stream)
+      : m_cct(cct), m_compressor(compressor), m_stream(std::move(stream)) {}
 
   protected:
     CephContext* const m_cct;
     CompressorRef m_compressor;
+    /// set if the session compresses all frames as one stream, so that
+    /// small frames can refer back to the ones sent before them
+    std::unique_ptr<Compressor::Stream> m_stream;
   };
 
   class RxHandler final : private Handler {
   public:
-    RxHandler(CephContext* const cct, CompressorRef compressor)
-      : Handler(cct, compressor) {}
+    RxHandler(CephContext* const cct, CompressorRef compressor,
+	      std::unique_ptr<Compressor::Stream> stream = nullptr)
+      : Handler(cct, compressor, std::move(stream)) {}
     ~RxHandler() {};
 
     /**
@@ -45,8 +51,9 @@ namespace ceph::compression::onwire {
 
   class TxHandler final : private Handler {
   public:
-    TxHandler(CephContext* const cct, CompressorRef compressor, int mode, std::uint64_t min_size)
-      : Handler(cct, compressor),
+    TxHandler(CephContext* const cct, CompressorRef compressor, int mode, std::uint64_t min_size,
+	      std::unique_ptr<Compressor::Stream> stream = nullptr)
+      : Handler(cct, compressor, std::move(stream)),
 	m_min_size(min_size),
 	m_mode(static_cast<Compressor::CompressionMode>(mode))
     {}
@@ -89,6 +96,9 @@ namespace ceph::compression::onwire {
     uint64_t m_init_onwire_size;
     uint64_t m_onwire_size;
     uint64_t m_compress_potential;
+    /// the stream failed part way through a frame and holds history the
+    /// peer will never see; send everything uncompressed from now on
+    bool m_stream_broken = false;
   };
 
   struct rxtx_t {
@@ -18,6 +18,10 @@ static constexpr const std::size_t AESGCM_KEY_LEN{16};
 static constexpr const std::size_t AESGCM_IV_LEN{12};
 static constexpr const std::size_t AESGCM_TAG_LEN{16};
 static constexpr const std::size_t AESGCM_BLOCK_LEN{16};
+// plaintext buffers shorter than this are copied into the output and
+// encrypted in place together with their neighbours, saving an
+// EVP_EncryptUpdate() call (and its partial block handling) per buffer
+static constexpr const std::size_t AESGCM_GATHER_LEN{1024};
 
 struct nonce_t {
   ceph_le32 fixed;
@@ -112,20 +116,40 @@ void AES128GCM_OnWireTxHandler::authenticated_encrypt_update(
               plaintext.length());
   auto filler = buffer.append_hole(plaintext.length());
 
-  for (const auto& plainbuf : plaintext.buffers()) {
+  unsigned char* gather_start = nullptr;
+  int gather_len = 0;
+  auto encrypt = [this](unsigned char* out, const unsigned char* in, int len) {
     int update_len = 0;
-
-    if(1 != EVP_EncryptUpdate(ectx.get(),
-	reinterpret_cast<unsigned char*>(filler.c_str()),
-	&update_len,
-	reinterpret_cast<const unsigned char*>(plainbuf.c_str()),
-	plainbuf.length())) {
+    if(1 != EVP_EncryptUpdate(ectx.get(), out, &update_len, in, len)) {
       throw std::runtime_error("EVP_EncryptUpdate failed");
     }
     ceph_assert_always(update_len >= 0);
-    ceph_assert(static_cast<unsigned>(update_len) == plainbuf.length());
-    filler.advance(update_len);
+    ceph_assert(update_len == len);
+  };
+  auto flush_gather = [&] {
+    if (gather_len) {
+      encrypt(gather_start, gather_start, gather_len);
+      gather_start = nullptr;
+      gather_len = 0;
+    }
+  };
+
+  for (const auto& plainbuf : plaintext.buffers()) {
+    auto out = reinterpret_cast<unsigned char*>(filler.c_str());
+    if (plainbuf.length() < AESGCM_GATHER_LEN) {
+      if (!gather_start) {
+	gather_start = out;
+      }
+      filler.copy_in(plainbuf.length(), plainbuf.c_str());
+      gather_len += plainbuf.length();
+      continue;
+    }
+    flush_gather();
+    encrypt(out, reinterpret_cast<const unsigned char*>(plainbuf.c_str()),
+	    plainbuf.length());
+    filler.advance(plainbuf.length());
   }
+  flush_gather();
 
   ldout(cct, 15) << __func__
 		 << " plaintext.length()=" << plaintext.length()
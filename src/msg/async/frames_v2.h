@@ -304,6 +304,14 @@ public:
                        sizeof(epilogue_crc_rev0_block_t);
   }
 
+  // True if segment seg_idx is on the wire as is, neither encrypted
+  // nor compressed, and the first segment can be looked at before it
+  // is read, so that it may be read straight into a user-provided
+  // buffer.
+  bool is_segment_plain(size_t seg_idx) const {
+    return m_is_rev1 && !m_crypto->rx && !is_compressed() && seg_idx > 0;
+  }
+
   uint64_t get_frame_logical_len() const;
   uint64_t get_frame_onwire_len() const;
 
@@ -25,6 +25,7 @@ namespace ceph {
     CephContext *cct;
    public:
     int create_socket(int domain, bool reuse_addr=false);
+    CephContext *get_cct() const { return cct; }
     explicit NetHandler(CephContext *c): cct(c) {}
     int set_nonblock(int sd);
     int set_socket_options(int sd, bool nodelay, int size);
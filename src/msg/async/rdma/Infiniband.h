@@ -182,6 +182,7 @@ enum {
   l_msgr_rdma_tx_failed,
 
   l_msgr_rdma_tx_chunks,
+  l_msgr_rdma_tx_inline_chunks,
   l_msgr_rdma_tx_bytes,
   l_msgr_rdma_rx_chunks,
   l_msgr_rdma_rx_bytes,
@@ -482,6 +483,10 @@ class Infiniband {
      * with the remote side's PSN, which is set in #plumb(). 
      */
     uint32_t get_initial_psn() const { return initial_psn; };
+    /**
+     * Get the largest send the device takes inline, as granted at creation.
+     */
+    uint32_t get_max_inline_data() const { return max_inline_data; }
     /**
      * Get the local queue pair number for this QueuePair.
      * QPNs are analogous to UDP/TCP port numbers.
@@ -551,6 +556,7 @@ class Infiniband {
     uint32_t     initial_psn;    // initial packet sequence number
     uint32_t     max_send_wr;
     uint32_t     max_recv_wr;
+    uint32_t     max_inline_data = 0;
     uint32_t     q_key;
     bool dead;
     std::vector<Chunk*> recv_queue;
@@ -46,8 +46,24 @@ std::vector<uint32_t> CompressorRegistry::_parse_method_list(const std::string&
   for_each_substr(s, ";,= \t", [&] (auto method) {
     ldout(cct,20) << "adding algorithm method: " << method << dendl;
 
+    const std::string_view suffix = "_stream";
+    bool stream = false;
+    if (method.size() > suffix.size() &&
+	method.substr(method.size() - suffix.size()) == suffix) {
+      method.remove_suffix(suffix.size());
+      stream = true;
+    }
     auto alg_type = Compressor::get_comp_alg_type(method);
-    if (alg_type) {
+    if (alg_type && stream) {
+      // only offer what we can decode ourselves
+      auto compressor = Compressor::create(cct, *alg_type);
+      if (compressor && compressor->create_stream()) {
+	methods.push_back(*alg_type | METHOD_STREAM);
+      } else {
+	ldout(cct,5) << "WARNING: algorithm method " << method
+		     << " has no streaming mode" << dendl;
+      }
+    } else if (alg_type) {
       methods.push_back(*alg_type);
     } else {
       ldout(cct,5) << "WARNING: unknown algorithm method " << method << dendl;
@@ -87,7 +103,7 @@ void CompressorRegistry::_refresh_config()
     << dendl;
 }
 
-Compressor::CompressionAlgorithm
+uint32_t
 CompressorRegistry::pick_method(uint32_t peer_type,
                                 const std::vector<uint32_t>& preferred_methods)
 {
@@ -102,7 +118,7 @@ CompressorRegistry::pick_method(uint32_t peer_type,
                  << " and our " << allowed_methods << dendl;
     return Compressor::COMP_ALG_NONE;
   } else {
-    return static_cast<Compressor::CompressionAlgorithm>(*preferred);
+    return *preferred;
   }
 }
 
@@ -25,8 +25,14 @@ public:
   void handle_conf_change(const ConfigProxy& conf,
                           const std::set<std::string>& changed) override;
 
-  TOPNSPC::Compressor::CompressionAlgorithm pick_method(uint32_t peer_type,
-					       const std::vector<uint32_t>& preferred_methods);
+  /// or'ed into an on-wire method id ("zstd_stream") to keep one
+  /// compression stream per direction for the whole session instead of
+  /// compressing each frame on its own; older peers just skip such ids
+  static constexpr uint32_t METHOD_STREAM = 1u << 8;
+
+  /// returns an on-wire method id, possibly with METHOD_STREAM set
+  uint32_t pick_method(uint32_t peer_type,
+		       const std::vector<uint32_t>& preferred_methods);
 
   TOPNSPC::Compressor::CompressionMode get_mode(uint32_t peer_type, bool is_secure);
 
@@ -14,6 +14,7 @@
 
 #define BOOST_BIND_NO_PLACEHOLDERS
 
+#include <mutex>
 #include <optional>
 #include <string_view>
 
@@ -897,6 +898,82 @@ void RADOS::execute(const Object& o, std::int64_t pool, WriteOp&& _op,
     std::move(c), objver);
 }
 
+struct RADOS::BatchState : std::enable_shared_from_this<BatchState> {
+  RADOS& rados;
+  const IOContext ioc;
+  std::vector<BatchOp> ops;
+  const std::size_t max_in_flight;
+  std::unique_ptr<BatchComp> c;
+
+  std::mutex lock;
+  std::size_t next = 0;
+  std::size_t in_flight = 0;
+  std::size_t done = 0;
+  bs::error_code first_error;
+  std::vector<bs::error_code> results;
+
+  BatchState(RADOS& rados, const IOContext& ioc, std::vector<BatchOp>&& ops,
+	     std::size_t max_in_flight, std::unique_ptr<BatchComp> c)
+    : rados(rados), ioc(ioc), ops(std::move(ops)),
+      max_in_flight(std::max<std::size_t>(max_in_flight, 1)),
+      c(std::move(c)), results(this->ops.size()) {}
+
+  void submit_more(std::unique_lock<std::mutex>& l) {
+    while (next < ops.size() && in_flight < max_in_flight) {
+      auto i = next++;
+      ++in_flight;
+      l.unlock();
+      submit(i);
+      l.lock();
+    }
+  }
+
+  void submit(std::size_t i) {
+    auto& b = ops[i];
+    auto comp = Op::Completion::create(
+      rados.get_executor(),
+      [self = shared_from_this(), i](bs::error_code ec) {
+	self->finish(i, ec);
+      });
+    if (auto op = std::get_if<ReadOp>(&b.op)) {
+      rados.execute(b.oid, ioc, std::move(*op), b.bl, std::move(comp),
+		    nullptr, nullptr);
+    } else {
+      rados.execute(b.oid, ioc, std::move(std::get<WriteOp>(b.op)),
+		    std::move(comp), nullptr, nullptr);
+    }
+  }
+
+  void finish(std::size_t i, bs::error_code ec) {
+    std::unique_lock l(lock);
+    results[i] = ec;
+    if (ec && !first_error) {
+      first_error = ec;
+    }
+    --in_flight;
+    if (++done == ops.size()) {
+      l.unlock();
+      ca::dispatch(std::move(c), first_error, std::move(results));
+      return;
+    }
+    submit_more(l);
+  }
+};
+
+void RADOS::execute_batch(const IOContext& ioc, std::vector<BatchOp>&& ops,
+			  std::size_t max_in_flight,
+			  std::unique_ptr<BatchComp> c) {
+  if (ops.empty()) {
+    ca::post(std::move(c), bs::error_code{},
+	     std::vector<bs::error_code>{});
+    return;
+  }
+  auto b = std::make_shared<BatchState>(*this, ioc, std::move(ops),
+					max_in_flight, std::move(c));
+  std::unique_lock l(b->lock);
+  b->submit_more(l);
+}
+
 boost::uuids::uuid RADOS::get_fsid() const noexcept {
   return impl->monclient.get_fsid().uuid;
 }
@@ -123,6 +123,9 @@ extern int cls_cxx_map_set_vals(cls_method_context_t hctx,
                                 const std::map<std::string, ceph::buffer::list> *map);
 extern int cls_cxx_map_write_header(cls_method_context_t hctx, ceph::buffer::list *inbl);
 extern int cls_cxx_map_remove_key(cls_method_context_t hctx, const std::string &key);
+/* remove all of the given keys with a single omap update */
+extern int cls_cxx_map_remove_keys(cls_method_context_t hctx,
+                                   const std::set<std::string> &keys);
 /* remove keys in the range [key_begin, key_end) */
 extern int cls_cxx_map_remove_range(cls_method_context_t hctx,
                                     const std::string& key_begin,
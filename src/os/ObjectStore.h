@@ -43,6 +43,10 @@ namespace ceph {
   class Formatter;
 }
 
+namespace PriorityCache {
+  struct PriCache;
+}
+
 /*
  * low-level interface to the local OSD file system
  */
@@ -273,6 +277,19 @@ public:
   }
 
   virtual void set_cache_shards(unsigned num) { }
+  /// hint the numa node whose threads will mostly use the given cache shard
+  virtual void set_cache_shard_numa_node(unsigned shard, int node) { }
+  /**
+   * have a cache of the caller sized along with the store's own caches
+   *
+   * @return false if the store does not autotune its cache memory, in
+   *         which case the caller has to bound the cache on its own
+   */
+  virtual bool register_priority_cache(
+    const std::string& name,
+    std::shared_ptr<PriorityCache::PriCache> cache) {
+    return false;
+  }
 
   /**
    * Returns 0 if the hobject is valid, -error otherwise
@@ -478,6 +495,56 @@ public:
      ceph::buffer::list& bl,
      uint32_t op_flags = 0) = 0;
 
+  /**
+   * read_async -- read a byte range of data without waiting for the device
+   *
+   * Same semantics as read(), but returns once the read has been issued.
+   * on_complete is called with what read() would have returned, after bl
+   * has been filled in; it runs in the caller's context if no device I/O
+   * was needed, and on a store thread otherwise.  bl must stay valid
+   * until then.  The default implementation is synchronous.
+   *
+   * @param on_complete called with the number of bytes read or a negative
+   *                    error code
+   */
+  virtual void read_async(
+    CollectionHandle &c,
+    const ghobject_t& oid,
+    uint64_t offset,
+    size_t len,
+    ceph::buffer::list *bl,
+    Context *on_complete,
+    uint32_t op_flags = 0) {
+    on_complete->complete(read(c, oid, offset, len, *bl, op_flags));
+  }
+
+  /**
+   * read_digest -- crc32c a byte range of data without returning it
+   *
+   * Same semantics as read(), but rather than filling in a buffer::list
+   * the data is folded into *crc, which holds the seed on entry, as
+   * buffer::list::crc32c() would.  Stores which keep checksums of their
+   * own can verify the data and derive the digest from those checksums
+   * in one pass.  The default implementation reads and hashes.
+   *
+   * @param crc in: seed, out: crc32c of the data read
+   * @returns number of bytes covered on success, or negative error code
+   */
+  virtual int read_digest(
+    CollectionHandle &c,
+    const ghobject_t& oid,
+    uint64_t offset,
+    size_t len,
+    uint32_t *crc,
+    uint32_t op_flags = 0) {
+    ceph::buffer::list bl;
+    int r = read(c, oid, offset, len, bl, op_flags);
+    if (r > 0) {
+      *crc = bl.crc32c(*crc);
+    }
+    return r;
+  }
+
   /**
    * fiemap -- get extent std::map of data of an object
    *
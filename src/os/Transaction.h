@@ -4,6 +4,9 @@
 #pragma once
 
 #include <map>
+#include <vector>
+
+#include <boost/iterator/indirect_iterator.hpp>
 
 #include "include/Context.h"
 #include "include/int_types.h"
@@ -235,6 +238,11 @@ private:
   std::map<coll_t, uint32_t> coll_index;
   std::map<ghobject_t, uint32_t> object_index;
 
+  // id -> key in the index maps above, so that iterators can hand out the
+  // collections and objects without copying them
+  std::vector<const coll_t*> coll_by_id;
+  std::vector<const ghobject_t*> object_by_id;
+
   uint32_t coll_id = 0;
   uint32_t object_id = 0;
 
@@ -261,6 +269,8 @@ public:
     data(std::move(other.data)),
     coll_index(std::move(other.coll_index)),
     object_index(std::move(other.object_index)),
+    coll_by_id(std::move(other.coll_by_id)),
+    object_by_id(std::move(other.object_by_id)),
     coll_id(other.coll_id),
     object_id(other.object_id),
     data_bl(std::move(other.data_bl)),
@@ -276,6 +286,8 @@ public:
     data = std::move(other.data);
     coll_index = std::move(other.coll_index);
     object_index = std::move(other.object_index);
+    coll_by_id = std::move(other.coll_by_id);
+    object_by_id = std::move(other.object_by_id);
     coll_id = other.coll_id;
     object_id = other.object_id;
     data_bl = std::move(other.data_bl);
@@ -288,8 +300,36 @@ public:
     return *this;
   }
 
-  Transaction(const Transaction& other) = default;
-  Transaction& operator=(const Transaction& other) = default;
+  Transaction(const Transaction& other) :
+    data(other.data),
+    coll_index(other.coll_index),
+    object_index(other.object_index),
+    coll_id(other.coll_id),
+    object_id(other.object_id),
+    data_bl(other.data_bl),
+    op_bl(other.op_bl),
+    on_applied(other.on_applied),
+    on_commit(other.on_commit),
+    on_applied_sync(other.on_applied_sync) {
+    _build_index_ptrs();
+  }
+
+  Transaction& operator=(const Transaction& other) {
+    if (this != &other) {
+      data = other.data;
+      coll_index = other.coll_index;
+      object_index = other.object_index;
+      coll_id = other.coll_id;
+      object_id = other.object_id;
+      data_bl = other.data_bl;
+      op_bl = other.op_bl;
+      on_applied = other.on_applied;
+      on_commit = other.on_commit;
+      on_applied_sync = other.on_applied_sync;
+      _build_index_ptrs();
+    }
+    return *this;
+  }
 
   // expose object_index for FileStore::Op's benefit
   const std::map<ghobject_t, uint32_t>& get_object_index() const {
@@ -390,6 +430,8 @@ public:
 
     std::swap(coll_index, other.coll_index);
     std::swap(object_index, other.object_index);
+    std::swap(coll_by_id, other.coll_by_id);
+    std::swap(object_by_id, other.object_by_id);
     std::swap(coll_id, other.coll_id);
     std::swap(object_id, other.object_id);
     op_bl.swap(other.op_bl);
@@ -646,6 +688,33 @@ public:
    * buffer decoding operation codes and parameters as we go.
    *
    */
+  /// read-only, id-indexed view of a transaction's collections or objects
+  template <typename T>
+  class id_view {
+    const std::vector<const T*>* v;
+  public:
+    using const_iterator = boost::indirect_iterator<
+      typename std::vector<const T*>::const_iterator>;
+
+    explicit id_view(const std::vector<const T*>* v) : v(v) {}
+
+    size_t size() const {
+      return v->size();
+    }
+    bool empty() const {
+      return v->empty();
+    }
+    const T& operator[](size_t i) const {
+      return *(*v)[i];
+    }
+    const_iterator begin() const {
+      return const_iterator(v->begin());
+    }
+    const_iterator end() const {
+      return const_iterator(v->end());
+    }
+  };
+
   class iterator {
     Transaction *t;
 
@@ -655,32 +724,18 @@ public:
     ceph::buffer::list::const_iterator data_bl_p;
 
   public:
-    std::vector<coll_t> colls;
-    std::vector<ghobject_t> objects;
+    id_view<coll_t> colls;
+    id_view<ghobject_t> objects;
 
   private:
     explicit iterator(Transaction *t)
       : t(t),
 	  data_bl_p(t->data_bl.cbegin()),
-        colls(t->coll_index.size()),
-        objects(t->object_index.size()) {
+        colls(&t->coll_by_id),
+        objects(&t->object_by_id) {
 
       ops = t->data.ops;
       op_buffer_p = t->op_bl.c_str();
-
-      std::map<coll_t, uint32_t>::iterator coll_index_p;
-      for (coll_index_p = t->coll_index.begin();
-           coll_index_p != t->coll_index.end();
-           ++coll_index_p) {
-        colls[coll_index_p->second] = coll_index_p->first;
-      }
-
-      std::map<ghobject_t, uint32_t>::iterator object_index_p;
-      for (object_index_p = t->object_index.begin();
-           object_index_p != t->object_index.end();
-           ++object_index_p) {
-        objects[object_index_p->second] = object_index_p->first;
-      }
     }
 
     friend class Transaction;
@@ -744,7 +799,7 @@ public:
 	return t->get_fadvise_flags();
     }
 
-    const std::vector<ghobject_t> &get_objects() const {
+    const id_view<ghobject_t>& get_objects() const {
       return objects;
     }
   };
@@ -775,22 +830,32 @@ private:
     return reinterpret_cast<Op*>(p);
   }
   uint32_t _get_coll_id(const coll_t& coll) {
-    std::map<coll_t, uint32_t>::iterator c = coll_index.find(coll);
-    if (c != coll_index.end())
-      return c->second;
-
-    uint32_t index_id = coll_id++;
-    coll_index[coll] = index_id;
-    return index_id;
+    auto [c, inserted] = coll_index.try_emplace(coll, coll_id);
+    if (inserted) {
+      coll_by_id.push_back(&c->first);
+      ++coll_id;
+    }
+    return c->second;
   }
   uint32_t _get_object_id(const ghobject_t& oid) {
-    std::map<ghobject_t, uint32_t>::iterator o = object_index.find(oid);
-    if (o != object_index.end())
-      return o->second;
-
-    uint32_t index_id = object_id++;
-    object_index[oid] = index_id;
-    return index_id;
+    auto [o, inserted] = object_index.try_emplace(oid, object_id);
+    if (inserted) {
+      object_by_id.push_back(&o->first);
+      ++object_id;
+    }
+    return o->second;
+  }
+  void _build_index_ptrs() {
+    coll_by_id.assign(coll_index.size(), nullptr);
+    for (auto& [c, id] : coll_index) {
+      ceph_assert(id < coll_by_id.size());
+      coll_by_id[id] = &c;
+    }
+    object_by_id.assign(object_index.size(), nullptr);
+    for (auto& [o, id] : object_index) {
+      ceph_assert(id < object_by_id.size());
+      object_by_id[id] = &o;
+    }
   }
 
 public:
@@ -1286,6 +1351,7 @@ public:
     data.decode(bl);
     coll_id = coll_index.size();
     object_id = object_index.size();
+    _build_index_ptrs();
 
     DECODE_FINISH(bl);
   }
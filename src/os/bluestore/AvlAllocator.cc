@@ -212,14 +212,47 @@ void AvlAllocator::_try_remove_from_tree(uint64_t start, uint64_t size,
   }
 }
 
+uint64_t AvlAllocator::_allocate_at(
+  uint64_t offset,
+  uint64_t size,
+  uint64_t unit)
+{
+  ceph_assert(p2phase(offset, unit) == 0);
+  auto rs = range_tree.lower_bound(range_t{offset, offset + 1},
+				   range_tree.key_comp());
+  if (rs == range_tree.end() || rs->start > offset) {
+    return 0;
+  }
+  uint64_t length = p2align(std::min(rs->end - offset, size), unit);
+  if (length) {
+    _remove_from_tree(offset, length);
+  }
+  return length;
+}
+
 int64_t AvlAllocator::_allocate(
   uint64_t want,
   uint64_t unit,
   uint64_t max_alloc_size,
-  int64_t  hint, // unused, for now!
+  int64_t  hint,
   PExtentVector* extents)
 {
   uint64_t allocated = 0;
+  if (hint > 0) {
+    // the caller would like the space to follow its existing data,
+    // grab whatever is free right there before searching elsewhere
+    uint64_t offset = p2roundup<uint64_t>(hint, unit);
+    if (offset < (uint64_t)device_size) {
+      uint64_t length = _allocate_at(offset,
+				     std::min(max_alloc_size, want), unit);
+      if (length) {
+	dout(20) << __func__ << " adjacent to hint 0x" << std::hex << hint
+		 << ": 0x" << offset << "~" << length << std::dec << dendl;
+	extents->emplace_back(offset, length);
+	allocated += length;
+      }
+    }
+  }
   while (allocated < want) {
     uint64_t offset, length;
     int r = _allocate(std::min(max_alloc_size, want - allocated),
@@ -364,7 +397,7 @@ int64_t AvlAllocator::allocate(
   uint64_t want,
   uint64_t unit,
   uint64_t max_alloc_size,
-  int64_t  hint, // unused, for now!
+  int64_t  hint,
   PExtentVector* extents)
 {
   ldout(cct, 10) << __func__ << std::hex
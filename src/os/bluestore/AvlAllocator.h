@@ -107,6 +107,11 @@ private:
     uint64_t unit,
     uint64_t *offset,
     uint64_t *length);
+  // take up to size bytes starting exactly at offset, if that is free
+  uint64_t _allocate_at(
+    uint64_t offset,
+    uint64_t size,
+    uint64_t unit);
 
   using range_tree_t = 
     boost::intrusive::avl_set<
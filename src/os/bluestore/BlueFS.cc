@@ -406,6 +406,16 @@ void BlueFS::_init_logger()
 	    "How many times bluefs read found page with all 0s");
   b.add_u64(l_bluefs_read_zeros_errors, "read_zeros_errors",
 	    "How many times bluefs read found transient page with all 0s");
+  b.add_time_avg(l_bluefs_log_lock_wait_lat, "log_lock_wait_lat",
+		 "Average time blocked on log.lock, contended acquisitions only");
+  b.add_time_avg(l_bluefs_nodes_lock_wait_lat, "nodes_lock_wait_lat",
+		 "Average time blocked on nodes.lock, contended acquisitions only");
+  b.add_time_avg(l_bluefs_dirty_lock_wait_lat, "dirty_lock_wait_lat",
+		 "Average time blocked on dirty.lock, contended acquisitions only");
+  b.add_time_avg(l_bluefs_file_lock_wait_lat, "file_lock_wait_lat",
+		 "Average time blocked on a file lock, contended acquisitions only");
+  b.add_time_avg(l_bluefs_writer_lock_wait_lat, "writer_lock_wait_lat",
+		 "Average time blocked on a file writer lock, contended acquisitions only");
 
   logger = b.create_perf_counters();
   cct->get_perfcounters_collection()->add(logger);
@@ -415,6 +425,19 @@ void BlueFS::_shutdown_logger()
 {
   cct->get_perfcounters_collection()->remove(logger);
   delete logger;
+  logger = nullptr;
+}
+
+ceph::mutex& BlueFS::_lock_wait(ceph::mutex& m, int idx)
+{
+  if (!m.try_lock()) {
+    auto t0 = mono_clock::now();
+    m.lock();
+    if (logger) {
+      logger->tinc(idx, mono_clock::now() - t0);
+    }
+  }
+  return m;
 }
 
 void BlueFS::_update_logger_stats()
@@ -492,6 +515,7 @@ void BlueFS::handle_discard(unsigned id, interval_set<uint64_t>& to_release)
   alloc[id]->release(to_release);
   if (is_shared_alloc(id)) {
     shared_alloc->bluefs_used -= to_release.size();
+    ++shared_alloc->bluefs_releases;
   }
 }
 
@@ -570,7 +594,7 @@ void BlueFS::foreach_block_extents(
   unsigned id,
   std::function<void(uint64_t, uint32_t)> fn)
 {
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   dout(10) << __func__ << " bdev " << id << dendl;
   ceph_assert(id < alloc.size());
   for (auto& p : nodes.file_map) {
@@ -963,6 +987,7 @@ int BlueFS::mount()
            << dendl;
   // update log size
   logger->set(l_bluefs_log_bytes, log.writer->file->fnode.size);
+  _start_log_compact_thread();
   return 0;
 
  out:
@@ -991,6 +1016,7 @@ void BlueFS::umount(bool avoid_compact)
 {
   dout(1) << __func__ << dendl;
 
+  _stop_log_compact_thread();
   sync_metadata(avoid_compact);
   if (cct->_conf->bluefs_check_volume_selector_on_umount) {
     _check_vselector_LNF();
@@ -1813,6 +1839,7 @@ int BlueFS::device_migrate_to_existing(
 	alloc[old_ext.bdev]->release(to_release);
         if (is_shared_alloc(old_ext.bdev)) {
           shared_alloc->bluefs_used -= to_release.size();
+          ++shared_alloc->bluefs_releases;
         }
       }
 
@@ -1953,6 +1980,7 @@ int BlueFS::device_migrate_to_new(
 	alloc[old_ext.bdev]->release(to_release);
         if (is_shared_alloc(old_ext.bdev)) {
           shared_alloc->bluefs_used -= to_release.size();
+          ++shared_alloc->bluefs_releases;
         }
       }
 
@@ -2052,7 +2080,7 @@ void BlueFS::_drop_link_D(FileRef file)
     logger->set(l_bluefs_num_files, nodes.file_map.size());
     file->deleted = true;
 
-    std::lock_guard dl(dirty.lock);
+    lock_wait_guard dl(this, dirty.lock, l_bluefs_dirty_lock_wait_lat);
     for (auto& r : file->fnode.extents) {
       dirty.pending_release[r.bdev].insert(r.offset, r.length);
     }
@@ -2160,6 +2188,100 @@ int64_t BlueFS::_read_random(
   return ret;
 }
 
+int BlueFS::_read_random_vec(
+  FileReader *h,
+  std::vector<read_request_t>& reqs)
+{
+  dout(10) << __func__ << " h " << h << " " << reqs.size() << " reads"
+	   << " from " << lock_fnode_print(h->file) << dendl;
+  if (reqs.size() < 2 ||
+      cct->_conf->bluefs_buffered_io ||
+      cct->_conf->bluefs_check_for_zeros) {
+    // nothing to batch, or reads must go via the page cache or re-read paths
+    for (auto& r : reqs) {
+      r.result = _read_random(h, r.offset, r.len, r.out);
+    }
+    return 0;
+  }
+
+  // one chunk per (request, extent) pair, widened to the device block size
+  struct chunk_t {
+    bufferlist bl;
+    uint64_t skip;
+    uint64_t len;
+    char *out;
+  };
+  std::deque<chunk_t> chunks;
+  std::array<std::unique_ptr<IOContext>, MAX_BDEV> iocs;
+
+  ++h->file->num_reading;
+  for (auto& r : reqs) {
+    uint64_t off = r.offset;
+    uint64_t len = r.len;
+    char *out = r.out;
+    if (!h->ignore_eof &&
+	off + len > h->file->fnode.size) {
+      if (off > h->file->fnode.size)
+	len = 0;
+      else
+	len = h->file->fnode.size - off;
+    }
+    r.result = len;
+    logger->inc(l_bluefs_read_random_count, 1);
+    logger->inc(l_bluefs_read_random_bytes, len);
+    while (len > 0) {
+      uint64_t x_off = 0;
+      auto p = h->file->fnode.seek(off, &x_off);
+      ceph_assert(p != h->file->fnode.extents.end());
+      uint64_t l = std::min(p->length - x_off, len);
+      uint64_t dev_off = p->offset + x_off;
+      uint64_t block_size = bdev[p->bdev]->get_block_size();
+      uint64_t aligned_off = p2align(dev_off, block_size);
+      uint64_t aligned_len = p2roundup(dev_off + l, block_size) - aligned_off;
+      if (!iocs[p->bdev]) {
+	iocs[p->bdev] = std::make_unique<IOContext>(cct, nullptr);
+      }
+      auto& c = chunks.emplace_back(
+	chunk_t{bufferlist(), dev_off - aligned_off, l, out});
+      dout(20) << __func__ << " read 0x" << std::hex << x_off << "~" << l
+	       << " as 0x" << aligned_off << "~" << aligned_len << std::dec
+	       << " of " << *p << dendl;
+      int rr = bdev[p->bdev]->aio_read(aligned_off, aligned_len, &c.bl,
+				       iocs[p->bdev].get());
+      ceph_assert(rr == 0);
+      logger->inc(l_bluefs_read_random_disk_count, 1);
+      logger->inc(l_bluefs_read_random_disk_bytes, l);
+      off += l;
+      len -= l;
+      out += l;
+    }
+  }
+
+  for (unsigned i = 0; i < MAX_BDEV; ++i) {
+    if (iocs[i] && iocs[i]->has_pending_aios()) {
+      bdev[i]->aio_submit(iocs[i].get());
+    }
+  }
+  int ret = 0;
+  for (unsigned i = 0; i < MAX_BDEV; ++i) {
+    if (iocs[i]) {
+      iocs[i]->aio_wait();
+      if (iocs[i]->get_return_value() < 0) {
+	ret = iocs[i]->get_return_value();
+      }
+    }
+  }
+  if (ret == 0) {
+    for (auto& c : chunks) {
+      c.bl.begin(c.skip).copy(c.len, c.out);
+    }
+  } else {
+    derr << __func__ << " read error " << cpp_strerror(ret) << dendl;
+  }
+  --h->file->num_reading;
+  return ret;
+}
+
 int64_t BlueFS::_read(
   FileReader *h,         ///< [in] read from here
   uint64_t off,          ///< [in] offset
@@ -2293,7 +2415,7 @@ int64_t BlueFS::_read(
 
 void BlueFS::invalidate_cache(FileRef f, uint64_t offset, uint64_t length)
 {
-  std::lock_guard l(f->lock);
+  lock_wait_guard l(this, f->lock, l_bluefs_file_lock_wait_lat);
   dout(10) << __func__ << " file " << f->fnode
 	   << " 0x" << std::hex << offset << "~" << length << std::dec
            << dendl;
@@ -2353,7 +2475,7 @@ uint64_t BlueFS::_make_initial_transaction(uint64_t start_seq,
 
 uint64_t BlueFS::_estimate_log_size_N()
 {
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   int avg_dir_size = 40;  // fixme
   int avg_file_size = 12;
   uint64_t size = 4096 * 2;
@@ -2382,7 +2504,7 @@ bool BlueFS::_should_start_compact_log_L_N()
   }
   uint64_t current;
   {
-    std::lock_guard ll(log.lock);
+    lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
     current = log.writer->file->fnode.size;
   }
   uint64_t expected = _estimate_log_size_N();
@@ -2398,22 +2520,22 @@ bool BlueFS::_should_start_compact_log_L_N()
   return true;
 }
 
-void BlueFS::_compact_log_dump_metadata_NF(uint64_t start_seq,
-                                        bluefs_transaction_t *t,
-					int bdev_update_flags,
-                                        uint64_t capture_before_seq)
+// Copies fnodes and names out of the in-memory tree. This is the part of
+// the metadata dump that needs nodes.lock (and, for async compaction, log.lock);
+// encoding the copy is left to _compact_log_encode_metadata().
+void BlueFS::_compact_log_capture_metadata_NF(compact_meta_snapshot_t *snap,
+					      int bdev_update_flags,
+					      uint64_t capture_before_seq)
 {
   dout(20) << __func__ << dendl;
-  t->seq = start_seq;
-  t->uuid = super.uuid;
-
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
 
+  snap->files.reserve(nodes.file_map.size());
   for (auto& [ino, file_ref] : nodes.file_map) {
     if (ino == 1)
       continue;
     ceph_assert(ino > 1);
-    std::lock_guard fl(file_ref->lock);
+    lock_wait_guard fl(this, file_ref->lock, l_bluefs_file_lock_wait_lat);
     if (bdev_update_flags) {
       for(auto& e : file_ref->fnode.extents) {
         auto bdev = e.bdev;
@@ -2444,25 +2566,61 @@ void BlueFS::_compact_log_dump_metadata_NF(uint64_t start_seq,
       dout(20) << __func__ << " op_file_update just modified, dirty_seq="
                << file_ref->dirty_seq << " " << file_ref->fnode << dendl;
     }
-    t->op_file_update(file_ref->fnode);
+    snap->files.emplace_back(file_ref->fnode);
+    // the dump carries the full fnode; later deltas must start from here,
+    // exactly as if op_file_update() had been encoded right now
+    file_ref->fnode.reset_delta();
   }
+  snap->dirs.reserve(nodes.dir_map.size());
   for (auto& [path, dir_ref] : nodes.dir_map) {
+    auto& [dirname, links] = snap->dirs.emplace_back();
+    dirname = path;
+    links.reserve(dir_ref->file_map.size());
+    for (auto& [fname, file_ref] : dir_ref->file_map) {
+      links.emplace_back(fname, file_ref->fnode.ino);
+    }
+  }
+}
+
+void BlueFS::_compact_log_encode_metadata(uint64_t start_seq,
+					  compact_meta_snapshot_t& snap,
+					  bluefs_transaction_t *t)
+{
+  dout(20) << __func__ << " " << snap.files.size() << " files, "
+	   << snap.dirs.size() << " dirs" << dendl;
+  t->seq = start_seq;
+  t->uuid = super.uuid;
+  for (auto& fnode : snap.files) {
+    t->op_file_update(fnode);
+  }
+  for (auto& [path, links] : snap.dirs) {
     dout(20) << __func__ << " op_dir_create " << path << dendl;
     t->op_dir_create(path);
-    for (auto& [fname, file_ref] : dir_ref->file_map) {
+    for (auto& [fname, ino] : links) {
       dout(20) << __func__ << " op_dir_link " << path << "/" << fname
-	       << " to " << file_ref->fnode.ino << dendl;
-      t->op_dir_link(path, fname, file_ref->fnode.ino);
+	       << " to " << ino << dendl;
+      t->op_dir_link(path, fname, ino);
     }
   }
 }
 
+void BlueFS::_compact_log_dump_metadata_NF(uint64_t start_seq,
+                                        bluefs_transaction_t *t,
+					int bdev_update_flags,
+                                        uint64_t capture_before_seq)
+{
+  compact_meta_snapshot_t snap;
+  _compact_log_capture_metadata_NF(&snap, bdev_update_flags,
+				   capture_before_seq);
+  _compact_log_encode_metadata(start_seq, snap, t);
+}
+
 void BlueFS::_compact_log_sync_LNF_LD()
 {
   dout(10) << __func__ << dendl;
   uint8_t prefer_bdev;
   {
-    std::lock_guard ll(log.lock);
+    lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
     prefer_bdev =
       vselector->select_prefer_bdev(log.writer->file->vselector_hint);
   }
@@ -2513,7 +2671,7 @@ void BlueFS::_rewrite_log_and_layout_sync_LNF_LD(bool permit_dev_fallback,
 
   // Part 0.
   // Lock the log totally till the end of the procedure
-  std::lock_guard ll(log.lock);
+  lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
   auto t0 = mono_clock::now();
 
   File *log_file = log.writer->file.get();
@@ -2701,7 +2859,7 @@ void BlueFS::_rewrite_log_and_layout_sync_LNF_LD(bool permit_dev_fallback,
     dout(10) << __func__
              << " release old log extents " << old_log_fnode.extents
              << dendl;
-    std::lock_guard dl(dirty.lock);
+    lock_wait_guard dl(this, dirty.lock, l_bluefs_dirty_lock_wait_lat);
     for (auto& r : old_log_fnode.extents) {
       dirty.pending_release[r.bdev].insert(r.offset, r.length);
     }
@@ -2752,7 +2910,7 @@ void BlueFS::_compact_log_async_LD_LNF_D() //also locks FW for new_writer
     return;
   }
   // lock log's run-time structures for a while
-  log.lock.lock();
+  _lock_wait(log.lock, l_bluefs_log_lock_wait_lat);
   auto t0 = mono_clock::now();
 
   // Part 1.
@@ -2840,15 +2998,22 @@ void BlueFS::_compact_log_async_LD_LNF_D() //also locks FW for new_writer
   //
 
   // 2.1 Build full compacted meta transaction
-  bluefs_transaction_t compacted_meta_t;
-  _compact_log_dump_metadata_NF(starter_seq + 1, &compacted_meta_t, 0, seq_now);
+  //     Only copying the metadata needs the lock; encoding the copy,
+  //     which dominates for large trees, happens after it is released.
+  compact_meta_snapshot_t compacted_meta_snap;
+  _compact_log_capture_metadata_NF(&compacted_meta_snap, 0, seq_now);
 
-  // now state is captured to compacted_meta_t,
+  // now state is captured to compacted_meta_snap,
   // current log can be used to write to,
   //ops in log will be continuation of captured state
   logger->tinc(l_bluefs_compaction_lock_lat, mono_clock::now() - t0);
   log.lock.unlock();
 
+  bluefs_transaction_t compacted_meta_t;
+  _compact_log_encode_metadata(starter_seq + 1, compacted_meta_snap,
+			       &compacted_meta_t);
+  compacted_meta_snap = compact_meta_snapshot_t();
+
   // 2.2 Allocate the space required for the compacted meta transaction
   uint64_t compacted_meta_need = _estimate_transaction_size(&compacted_meta_t);
   dout(20) << __func__ << " compacted_meta_need " << compacted_meta_need
@@ -2945,7 +3110,7 @@ void BlueFS::_compact_log_async_LD_LNF_D() //also locks FW for new_writer
   //
 
   // we need to acquire log's lock back at this point
-  log.lock.lock();
+  _lock_wait(log.lock, l_bluefs_log_lock_wait_lat);
   // Reconstruct actual log object from the new one.
   vselector->sub_usage(log_file->vselector_hint, log_file->fnode);
   log_file->fnode.size =
@@ -2989,7 +3154,7 @@ void BlueFS::_compact_log_async_LD_LNF_D() //also locks FW for new_writer
     dout(10) << __func__
              << " release old log extents " << old_log_fnode.extents
              << dendl;
-    std::lock_guard dl(dirty.lock);
+    lock_wait_guard dl(this, dirty.lock, l_bluefs_dirty_lock_wait_lat);
     for (auto& r : old_log_fnode.extents) {
       dirty.pending_release[r.bdev].insert(r.offset, r.length);
     }
@@ -3131,7 +3296,7 @@ void BlueFS::_flush_and_sync_log_core(int64_t runway)
 // Clears dirty.files up to (including) seq_stable.
 void BlueFS::_clear_dirty_set_stable_D(uint64_t seq)
 {
-  std::lock_guard dl(dirty.lock);
+  lock_wait_guard dl(this, dirty.lock, l_bluefs_dirty_lock_wait_lat);
 
   // clean dirty files
   if (seq > dirty.seq_stable) {
@@ -3178,6 +3343,7 @@ void BlueFS::_release_pending_allocations(vector<interval_set<uint64_t>>& to_rel
       alloc[i]->release(to_release[i]);
       if (is_shared_alloc(i)) {
         shared_alloc->bluefs_used -= to_release[i].size();
+        ++shared_alloc->bluefs_releases;
       }
     }
   }
@@ -3187,8 +3353,8 @@ int BlueFS::_flush_and_sync_log_LD(uint64_t want_seq)
 {
   int64_t available_runway;
   do {
-    log.lock.lock();
-    dirty.lock.lock();
+    _lock_wait(log.lock, l_bluefs_log_lock_wait_lat);
+    _lock_wait(dirty.lock, l_bluefs_dirty_lock_wait_lat);
     if (want_seq && want_seq <= dirty.seq_stable) {
       dout(10) << __func__ << " want_seq " << want_seq << " <= seq_stable "
 	       << dirty.seq_stable << ", done" << dendl;
@@ -3240,7 +3406,7 @@ int BlueFS::_flush_and_sync_log_jump_D(uint64_t jump_to,
   ceph_assert(jump_to);
   // we synchronize writing to log, by lock to log.lock
 
-  dirty.lock.lock();
+  _lock_wait(dirty.lock, l_bluefs_dirty_lock_wait_lat);
   uint64_t seq =_log_advance_seq();
   _consume_dirty(seq);
   vector<interval_set<uint64_t>> to_release(dirty.pending_release.size());
@@ -3311,7 +3477,7 @@ ceph::bufferlist BlueFS::FileWriter::flush_buffer(
 int BlueFS::_signal_dirty_to_log_D(FileWriter *h)
 {
   ceph_assert(ceph_mutex_is_locked(h->lock));
-  std::lock_guard dl(dirty.lock);
+  lock_wait_guard dl(this, dirty.lock, l_bluefs_dirty_lock_wait_lat);
   if (h->file->deleted) {
     dout(10) << __func__ << "  deleted, no-op" << dendl;
     return 0;
@@ -3345,7 +3511,7 @@ int BlueFS::_signal_dirty_to_log_D(FileWriter *h)
 void BlueFS::flush_range(FileWriter *h, uint64_t offset, uint64_t length)/*_WF*/
 {
   _maybe_check_vselector_LNF();
-  std::unique_lock hl(h->lock);
+  std::unique_lock hl(_lock_wait(h->lock, l_bluefs_writer_lock_wait_lat), std::adopt_lock);
   _flush_range_F(h, offset, length);
 }
 
@@ -3374,7 +3540,7 @@ int BlueFS::_flush_range_F(FileWriter *h, uint64_t offset, uint64_t length)
              << std::hex << offset << "~" << length << std::dec
              << dendl;
   }
-  std::lock_guard file_lock(h->file->lock);
+  lock_wait_guard file_lock(this, h->file->lock, l_bluefs_file_lock_wait_lat);
   ceph_assert(offset <= h->file->fnode.size);
 
   uint64_t allocated = h->file->fnode.get_allocated();
@@ -3531,7 +3697,7 @@ void BlueFS::append_try_flush(FileWriter *h, const char* buf, size_t len)/*_WF_L
 {
   bool flushed_sum = false;
   {
-    std::unique_lock hl(h->lock);
+    std::unique_lock hl(_lock_wait(h->lock, l_bluefs_writer_lock_wait_lat), std::adopt_lock);
     size_t max_size = 1ull << 30; // cap to 1GB
     while (len > 0) {
       bool need_flush = true;
@@ -3564,7 +3730,7 @@ void BlueFS::flush(FileWriter *h, bool force)/*_WF_LNF_NF_LD_D*/
   bool flushed = false;
   int r;
   {
-    std::unique_lock hl(h->lock);
+    std::unique_lock hl(_lock_wait(h->lock, l_bluefs_writer_lock_wait_lat), std::adopt_lock);
     r = _flush_F(h, force, &flushed);
     ceph_assert(r == 0);
   }
@@ -3627,7 +3793,7 @@ uint64_t BlueFS::_flush_special(FileWriter *h)
 
 int BlueFS::truncate(FileWriter *h, uint64_t offset)/*_WF_L*/
 {
-  std::lock_guard hl(h->lock);
+  lock_wait_guard hl(this, h->lock, l_bluefs_writer_lock_wait_lat);
   dout(10) << __func__ << " 0x" << std::hex << offset << std::dec
            << " file " << h->file->fnode << dendl;
   if (h->file->deleted) {
@@ -3659,7 +3825,7 @@ int BlueFS::truncate(FileWriter *h, uint64_t offset)/*_WF_L*/
   ceph_assert(h->file->fnode.size >= offset);
   _flush_bdev(h);
 
-  std::lock_guard ll(log.lock);
+  lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
   vselector->sub_usage(h->file->vselector_hint, h->file->fnode.size);
   h->file->fnode.size = offset;
   h->file->is_dirty = true;
@@ -3671,7 +3837,7 @@ int BlueFS::truncate(FileWriter *h, uint64_t offset)/*_WF_L*/
 int BlueFS::fsync(FileWriter *h)/*_WF_WD_WLD_WLNF_WNF*/
 {
   _maybe_check_vselector_LNF();
-  std::unique_lock hl(h->lock);
+  std::unique_lock hl(_lock_wait(h->lock, l_bluefs_writer_lock_wait_lat), std::adopt_lock);
   uint64_t old_dirty_seq = 0;
   {
     dout(10) << __func__ << " " << h << " " << h->file->fnode
@@ -3685,7 +3851,7 @@ int BlueFS::fsync(FileWriter *h)/*_WF_WD_WLD_WLNF_WNF*/
       h->file->is_dirty = false;
     }
     {
-      std::lock_guard dl(dirty.lock);
+      lock_wait_guard dl(this, dirty.lock, l_bluefs_dirty_lock_wait_lat);
       if (dirty.seq_stable < h->file->dirty_seq) {
 	old_dirty_seq = h->file->dirty_seq;
 	dout(20) << __func__ << " file metadata was dirty (" << old_dirty_seq
@@ -3804,6 +3970,9 @@ int BlueFS::_allocate(uint8_t id, uint64_t len,
     if (alloc[id]) {
       if (alloc_len > 0) {
         alloc[id]->release(extents);
+        if (shared) {
+          ++shared_alloc->bluefs_releases;
+        }
       }
       if (!was_cooldown && shared) {
         auto delay_s = cct->_conf->bluefs_failed_shared_alloc_cooldown;
@@ -3880,8 +4049,8 @@ int BlueFS::_allocate(uint8_t id, uint64_t len,
 
 int BlueFS::preallocate(FileRef f, uint64_t off, uint64_t len)/*_LF*/
 {
-  std::lock_guard ll(log.lock);
-  std::lock_guard fl(f->lock);
+  lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
+  lock_wait_guard fl(this, f->lock, l_bluefs_file_lock_wait_lat);
   dout(10) << __func__ << " file " << f->fnode << " 0x"
 	   << std::hex << off << "~" << len << std::dec << dendl;
   if (f->deleted) {
@@ -3911,8 +4080,8 @@ void BlueFS::sync_metadata(bool avoid_compact)/*_LNF_NF_LD_D*/
 {
   bool can_skip_flush;
   {
-    std::lock_guard ll(log.lock);
-    std::lock_guard dl(dirty.lock);
+    lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
+    lock_wait_guard dl(this, dirty.lock, l_bluefs_dirty_lock_wait_lat);
     can_skip_flush = log.t.empty() && dirty.files.empty();
   }
   if (can_skip_flush) {
@@ -3936,6 +4105,14 @@ void BlueFS::_maybe_compact_log_LNF_NF_LD_D()
 {
   if (!cct->_conf->bluefs_replay_recovery_disable_compact &&
       _should_start_compact_log_L_N()) {
+    if (log_compact_thread.is_started() &&
+	!cct->_conf->bluefs_compact_log_sync) {
+      // hand over to the compaction thread, don't stall the caller's fsync
+      std::lock_guard l(log_compact_lock);
+      log_compact_requested = true;
+      log_compact_cond.notify_one();
+      return;
+    }
     auto t0 = mono_clock::now();
     if (cct->_conf->bluefs_compact_log_sync) {
       _compact_log_sync_LNF_LD();
@@ -3946,6 +4123,51 @@ void BlueFS::_maybe_compact_log_LNF_NF_LD_D()
   }
 }
 
+void BlueFS::_log_compact_thread()
+{
+  dout(10) << __func__ << " start" << dendl;
+  std::unique_lock l(log_compact_lock);
+  while (true) {
+    log_compact_cond.wait(l, [this] {
+      return log_compact_requested || log_compact_stop;
+    });
+    if (log_compact_stop) {
+      break;
+    }
+    log_compact_requested = false;
+    l.unlock();
+    auto t0 = mono_clock::now();
+    _compact_log_async_LD_LNF_D();
+    logger->tinc(l_bluefs_compaction_lat, mono_clock::now() - t0);
+    l.lock();
+  }
+  dout(10) << __func__ << " finish" << dendl;
+}
+
+void BlueFS::_start_log_compact_thread()
+{
+  if (!cct->_conf.get_val<bool>("bluefs_compact_log_background")) {
+    return;
+  }
+  ceph_assert(!log_compact_thread.is_started());
+  log_compact_stop = false;
+  log_compact_requested = false;
+  log_compact_thread.create("bluefs_compact");
+}
+
+void BlueFS::_stop_log_compact_thread()
+{
+  if (!log_compact_thread.is_started()) {
+    return;
+  }
+  {
+    std::lock_guard l(log_compact_lock);
+    log_compact_stop = true;
+    log_compact_cond.notify_one();
+  }
+  log_compact_thread.join();
+}
+
 int BlueFS::open_for_write(
   std::string_view dirname,
   std::string_view filename,
@@ -3958,8 +4180,8 @@ int BlueFS::open_for_write(
   bool truncate = false;
   mempool::bluefs::vector<bluefs_extent_t> pending_release_extents;
   {
-  std::lock_guard ll(log.lock);
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   dout(10) << __func__ << " " << dirname << "/" << filename << dendl;
   map<string,DirRef>::iterator p = nodes.dir_map.find(dirname);
   DirRef dir;
@@ -4022,7 +4244,7 @@ int BlueFS::open_for_write(
   if (create)
     log.t.op_dir_link(dirname, filename, file->fnode.ino);
 
-  std::lock_guard dl(dirty.lock);
+  lock_wait_guard dl(this, dirty.lock, l_bluefs_dirty_lock_wait_lat);
   for (auto& p : pending_release_extents) {
     dirty.pending_release[p.bdev].insert(p.offset, p.length);
   }
@@ -4082,7 +4304,7 @@ void BlueFS::_close_writer(FileWriter *h)
 void BlueFS::close_writer(FileWriter *h)
 {
   {
-    std::lock_guard l(h->lock);
+    lock_wait_guard l(this, h->lock, l_bluefs_writer_lock_wait_lat);
     _drain_writer(h);
   }
   delete h;
@@ -4090,13 +4312,13 @@ void BlueFS::close_writer(FileWriter *h)
 
 uint64_t BlueFS::debug_get_dirty_seq(FileWriter *h)
 {
-  std::lock_guard l(h->lock);
+  lock_wait_guard l(this, h->lock, l_bluefs_writer_lock_wait_lat);
   return h->file->dirty_seq;
 }
 
 bool BlueFS::debug_get_is_dev_dirty(FileWriter *h, uint8_t dev)
 {
-  std::lock_guard l(h->lock);
+  lock_wait_guard l(this, h->lock, l_bluefs_writer_lock_wait_lat);
   return h->dirty_devs[dev];
 }
 
@@ -4107,7 +4329,7 @@ int BlueFS::open_for_read(
   bool random)/*_N*/
 {
   _maybe_check_vselector_LNF();
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   dout(10) << __func__ << " " << dirname << "/" << filename
 	   << (random ? " (random)":" (sequential)") << dendl;
   map<string,DirRef>::iterator p = nodes.dir_map.find(dirname);
@@ -4136,8 +4358,8 @@ int BlueFS::rename(
   std::string_view old_dirname, std::string_view old_filename,
   std::string_view new_dirname, std::string_view new_filename)/*_LND*/
 {
-  std::lock_guard ll(log.lock);
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   dout(10) << __func__ << " " << old_dirname << "/" << old_filename
 	   << " -> " << new_dirname << "/" << new_filename << dendl;
   map<string,DirRef>::iterator p = nodes.dir_map.find(old_dirname);
@@ -4184,8 +4406,8 @@ int BlueFS::rename(
 
 int BlueFS::mkdir(std::string_view dirname)/*_LN*/
 {
-  std::lock_guard ll(log.lock);
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   dout(10) << __func__ << " " << dirname << dendl;
   map<string,DirRef>::iterator p = nodes.dir_map.find(dirname);
   if (p != nodes.dir_map.end()) {
@@ -4199,8 +4421,8 @@ int BlueFS::mkdir(std::string_view dirname)/*_LN*/
 
 int BlueFS::rmdir(std::string_view dirname)/*_LN*/
 {
-  std::lock_guard ll(log.lock);
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   dout(10) << __func__ << " " << dirname << dendl;
   auto p = nodes.dir_map.find(dirname);
   if (p == nodes.dir_map.end()) {
@@ -4219,7 +4441,7 @@ int BlueFS::rmdir(std::string_view dirname)/*_LN*/
 
 bool BlueFS::dir_exists(std::string_view dirname)/*_N*/
 {
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   map<string,DirRef>::iterator p = nodes.dir_map.find(dirname);
   bool exists = p != nodes.dir_map.end();
   dout(10) << __func__ << " " << dirname << " = " << (int)exists << dendl;
@@ -4229,7 +4451,7 @@ bool BlueFS::dir_exists(std::string_view dirname)/*_N*/
 int BlueFS::stat(std::string_view dirname, std::string_view filename,
 		 uint64_t *size, utime_t *mtime)/*_N*/
 {
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   dout(10) << __func__ << " " << dirname << "/" << filename << dendl;
   map<string,DirRef>::iterator p = nodes.dir_map.find(dirname);
   if (p == nodes.dir_map.end()) {
@@ -4257,8 +4479,8 @@ int BlueFS::stat(std::string_view dirname, std::string_view filename,
 int BlueFS::lock_file(std::string_view dirname, std::string_view filename,
 		      FileLock **plock)/*_LN*/
 {
-  std::lock_guard ll(log.lock);
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   dout(10) << __func__ << " " << dirname << "/" << filename << dendl;
   map<string,DirRef>::iterator p = nodes.dir_map.find(dirname);
   if (p == nodes.dir_map.end()) {
@@ -4297,7 +4519,7 @@ int BlueFS::lock_file(std::string_view dirname, std::string_view filename,
 
 int BlueFS::unlock_file(FileLock *fl)/*_N*/
 {
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   dout(10) << __func__ << " " << fl << " on " << fl->file->fnode << dendl;
   ceph_assert(fl->file->locked);
   fl->file->locked = false;
@@ -4311,7 +4533,7 @@ int BlueFS::readdir(std::string_view dirname, vector<string> *ls)/*_N*/
   if (!dirname.empty() && dirname.back() == '/') {
     dirname.remove_suffix(1);
   }
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   dout(10) << __func__ << " " << dirname << dendl;
   if (dirname.empty()) {
     // list dirs
@@ -4339,8 +4561,8 @@ int BlueFS::readdir(std::string_view dirname, vector<string> *ls)/*_N*/
 
 int BlueFS::unlink(std::string_view dirname, std::string_view filename)/*_LND*/
 {
-  std::lock_guard ll(log.lock);
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   dout(10) << __func__ << " " << dirname << "/" << filename << dendl;
   map<string,DirRef>::iterator p = nodes.dir_map.find(dirname);
   if (p == nodes.dir_map.end()) {
@@ -4576,8 +4798,8 @@ void BlueFS::_check_vselector_LNF() {
   if (!vs) {
     return;
   }
-  std::lock_guard ll(log.lock);
-  std::lock_guard nl(nodes.lock);
+  lock_wait_guard ll(this, log.lock, l_bluefs_log_lock_wait_lat);
+  lock_wait_guard nl(this, nodes.lock, l_bluefs_nodes_lock_wait_lat);
   // Checking vselector is under log, nodes and file(s) locks,
   // so any modification of vselector must be under at least one of those locks.
   for (auto& f : nodes.file_map) {
@@ -11,6 +11,7 @@
 #include "blk/BlockDevice.h"
 
 #include "common/RefCountedObj.h"
+#include "common/Thread.h"
 #include "common/ceph_context.h"
 #include "global/global_context.h"
 #include "include/common_fwd.h"
@@ -73,6 +74,11 @@ enum {
   l_bluefs_alloc_shared_size_fallbacks,
   l_bluefs_read_zeros_candidate,
   l_bluefs_read_zeros_errors,
+  l_bluefs_log_lock_wait_lat,
+  l_bluefs_nodes_lock_wait_lat,
+  l_bluefs_dirty_lock_wait_lat,
+  l_bluefs_file_lock_wait_lat,
+  l_bluefs_writer_lock_wait_lat,
   l_bluefs_last,
 };
 
@@ -104,6 +110,8 @@ struct bluefs_shared_alloc_context_t {
   uint64_t alloc_unit = 0;
 
   std::atomic<uint64_t> bluefs_used = 0;
+  /// bumped whenever BlueFS gives space back to the shared allocator
+  std::atomic<uint64_t> bluefs_releases = 0;
 
   void set(Allocator* _a, uint64_t _au) {
     a = _a;
@@ -328,6 +336,14 @@ public:
     }
   };
 
+  /// one piece of a read_random_vec() batch
+  struct read_request_t {
+    uint64_t offset = 0;  ///< [in] file offset
+    uint64_t len = 0;     ///< [in] this many bytes
+    char *out = nullptr;  ///< [out] copy it here
+    int64_t result = 0;   ///< [out] bytes read, clipped at eof
+  };
+
   struct FileLock {
     MEMPOOL_CLASS_HELPERS();
 
@@ -381,6 +397,39 @@ private:
   std::atomic<bool> log_is_compacting{false};                    ///< signals that bluefs log is already ongoing compaction
   std::atomic<bool> log_forbidden_to_expand{false};              ///< used to signal that async compaction is in state
                                                                  ///  that prohibits expansion of bluefs log
+
+  /// lock @m, accounting the time spent blocked on it to perf counter @idx
+  ceph::mutex& _lock_wait(ceph::mutex& m, int idx);
+  /// std::lock_guard flavour of _lock_wait()
+  class lock_wait_guard {
+    ceph::mutex& m;
+  public:
+    lock_wait_guard(BlueFS *fs, ceph::mutex& m, int idx)
+      : m(fs->_lock_wait(m, idx)) {}
+    ~lock_wait_guard() {
+      m.unlock();
+    }
+    lock_wait_guard(const lock_wait_guard&) = delete;
+    lock_wait_guard& operator=(const lock_wait_guard&) = delete;
+  };
+
+  // background log compaction, see bluefs_compact_log_background
+  struct LogCompactThread : public Thread {
+    BlueFS *bluefs;
+    explicit LogCompactThread(BlueFS *fs) : bluefs(fs) {}
+    void *entry() override {
+      bluefs->_log_compact_thread();
+      return nullptr;
+    }
+  } log_compact_thread{this};
+  ceph::mutex log_compact_lock = ceph::make_mutex("BlueFS::log_compact_lock");
+  ceph::condition_variable log_compact_cond;
+  bool log_compact_requested = false;
+  bool log_compact_stop = false;
+
+  void _log_compact_thread();
+  void _start_log_compact_thread();
+  void _stop_log_compact_thread();
   /*
    * There are up to 3 block devices:
    *
@@ -478,6 +527,18 @@ private:
     RENAME_SLOW2DB = 4,
     RENAME_DB2SLOW = 8,
   };
+  /// in-memory metadata captured for log compaction
+  struct compact_meta_snapshot_t {
+    std::vector<bluefs_fnode_t> files;
+    std::vector<std::pair<std::string,
+      std::vector<std::pair<std::string, uint64_t>>>> dirs;
+  };
+  void _compact_log_capture_metadata_NF(compact_meta_snapshot_t *snap,
+					int flags,
+					uint64_t capture_before_seq);
+  void _compact_log_encode_metadata(uint64_t start_seq,
+				    compact_meta_snapshot_t& snap,
+				    bluefs_transaction_t *t);
   void _compact_log_dump_metadata_NF(uint64_t start_seq,
                                      bluefs_transaction_t *t,
 				     int flags,
@@ -508,6 +569,9 @@ private:
     size_t len,      ///< [in] this many bytes
     ceph::buffer::list *outbl,   ///< [out] optional: reference the result here
     char *out);      ///< [out] optional: or copy it here
+  int _read_random_vec(
+    FileReader *h,
+    std::vector<read_request_t>& reqs);
   int64_t _read_random(
     FileReader *h,   ///< [in] read from here
     uint64_t offset, ///< [in] offset
@@ -664,6 +728,10 @@ public:
     // atomics and asserts).
     return _read_random(h, offset, len, out);
   }
+  /// read several ranges at once, with a single aio submission per device
+  int read_random_vec(FileReader *h, std::vector<read_request_t>& reqs) {
+    return _read_random_vec(h, reqs);
+  }
   void invalidate_cache(FileRef f, uint64_t offset, uint64_t len);
   int preallocate(FileRef f, uint64_t offset, uint64_t len);
   int truncate(FileWriter *h, uint64_t offset);
@@ -141,6 +141,29 @@ class BlueRocksRandomAccessFile : public rocksdb::RandomAccessFile {
 		    (unsigned long long)h->file->fnode.ino);
   };
 
+  // Read a bunch of blocks as described by reqs. The blocks can
+  // optionally be read in parallel. This is a synchronous call, i.e it
+  // should return after all reads have completed.
+  rocksdb::Status MultiRead(rocksdb::ReadRequest* reqs,
+			    size_t num_reqs) override {
+    std::vector<BlueFS::read_request_t> v(num_reqs);
+    for (size_t i = 0; i < num_reqs; ++i) {
+      v[i].offset = reqs[i].offset;
+      v[i].len = reqs[i].len;
+      v[i].out = reqs[i].scratch;
+    }
+    int r = fs->read_random_vec(h, v);
+    for (size_t i = 0; i < num_reqs; ++i) {
+      if (r < 0) {
+	reqs[i].status = err_to_status(r);
+	continue;
+      }
+      reqs[i].result = rocksdb::Slice(reqs[i].scratch, v[i].result);
+      reqs[i].status = rocksdb::Status::OK();
+    }
+    return r < 0 ? err_to_status(r) : rocksdb::Status::OK();
+  }
+
   // Readahead the file starting from offset by n bytes for caching.
   rocksdb::Status Prefetch(uint64_t offset, size_t n) override {
     fs->read(h, offset, n, nullptr, nullptr);
@@ -36,11 +36,13 @@
 #include "include/stringify.h"
 #include "include/str_map.h"
 #include "include/util.h"
+#include "common/admin_socket.h"
 #include "common/errno.h"
 #include "common/safe_io.h"
 #include "common/PriorityCache.h"
 #include "common/url_escape.h"
 #include "Allocator.h"
+#include "MagazineAllocator.h"
 #include "FreelistManager.h"
 #include "BlueFS.h"
 #include "BlueRocksEnv.h"
@@ -132,6 +134,7 @@ const string PREFIX_DEFERRED = "L";    // id -> deferred_transaction_t
 const string PREFIX_ALLOC = "B";       // u64 offset -> u64 length (freelist)
 const string PREFIX_ALLOC_BITMAP = "b";// (see BitmapFreelistManager)
 const string PREFIX_SHARED_BLOB = "X"; // u64 SB id -> shared_blob_t
+const string PREFIX_ALLOC_JOURNAL = "a"; // u64 seq -> allocated, released
 
 #ifdef HAVE_LIBZBD
 const string PREFIX_ZONED_FM_META = "Z";  // (see ZonedFreelistManager)
@@ -1845,6 +1848,10 @@ void BlueStore::BufferSpace::read(
   uint64_t miss_bytes = want_bytes - hit_bytes;
   cache->logger->inc(l_bluestore_buffer_hit_bytes, hit_bytes);
   cache->logger->inc(l_bluestore_buffer_miss_bytes, miss_bytes);
+  if (int node = cache->numa_node; hit_bytes && node >= 0 &&
+      get_current_numa_node() != node) {
+    cache->logger->inc(l_bluestore_buffer_numa_remote_hit_bytes, hit_bytes);
+  }
 }
 
 void BlueStore::BufferSpace::_finish_write(BufferCacheShard* cache, uint64_t seq)
@@ -1982,6 +1989,10 @@ BlueStore::OnodeRef BlueStore::OnodeSpace::lookup(const ghobject_t& oid)
       o = p->second;
 
       cache->logger->inc(l_bluestore_onode_hits);
+      if (int node = cache->numa_node; node >= 0 &&
+	  get_current_numa_node() != node) {
+	cache->logger->inc(l_bluestore_onode_numa_remote_hits);
+      }
     }
   }
 
@@ -3324,6 +3335,17 @@ void BlueStore::ExtentMap::init_shards(bool loaded, bool dirty)
   }
 }
 
+void BlueStore::ExtentMap::fault_inline()
+{
+  if (!inline_pending) {
+    return;
+  }
+  unsigned n = decode_some(inline_bl);
+  inline_pending = false;
+  dout(20) << __func__ << " decoded " << n << " inline extents ("
+	   << inline_bl.length() << " bytes)" << dendl;
+}
+
 void BlueStore::ExtentMap::fault_range(
   KeyValueDB *db,
   uint32_t offset,
@@ -3331,6 +3353,10 @@ void BlueStore::ExtentMap::fault_range(
 {
   dout(30) << __func__ << " 0x" << std::hex << offset << "~" << length
 	   << std::dec << dendl;
+  if (shards.empty()) {
+    fault_inline();
+    return;
+  }
   auto start = seek_shard(offset);
   auto last = seek_shard(offset + length);
 
@@ -3382,6 +3408,8 @@ void BlueStore::ExtentMap::dirty_range(
 	   << std::dec << dendl;
   if (shards.empty()) {
     dout(20) << __func__ << " mark inline shard dirty" << dendl;
+    // inline_bl is the only copy of a lazily loaded map
+    fault_inline();
     inline_bl.clear();
     return;
   }
@@ -3730,7 +3758,8 @@ void BlueStore::Onode::put()
 void BlueStore::Onode::decode_raw(
   BlueStore::Onode* on,
   const bufferlist& v,
-  BlueStore::ExtentMap::ExtentDecoder& edecoder)
+  BlueStore::ExtentMap::ExtentDecoder& edecoder,
+  bool lazy_inline)
 {
   on->exists = true;
   auto p = v.front().begin_deep();
@@ -3740,7 +3769,12 @@ void BlueStore::Onode::decode_raw(
   edecoder.decode_spanning_blobs(p, on->c);
   if (on->onode.extent_map_shards.empty()) {
     denc(on->extent_map.inline_bl, p);
-    edecoder.decode_some(on->extent_map.inline_bl, on->c);
+    if (lazy_inline) {
+      // keep only the encoded form until fault_range() needs the extents
+      on->extent_map.inline_pending = true;
+    } else {
+      edecoder.decode_some(on->extent_map.inline_bl, on->c);
+    }
   }
 }
 
@@ -3756,7 +3790,8 @@ BlueStore::Onode* BlueStore::Onode::create_decode(
 
   if (v.length()) {
     ExtentMap::ExtentDecoderFull edecoder(on->extent_map);
-    decode_raw(on, v, edecoder);
+    decode_raw(on, v, edecoder,
+      c->store->cct->_conf->bluestore_onode_lazy_inline_extent_map);
 
     for (auto& i : on->onode.attrs) {
       i.second.reassign_to_mempool(mempool::mempool_bluestore_cache_meta);
@@ -4118,6 +4153,46 @@ BlueStore::OnodeRef BlueStore::Collection::get_onode(
   return onode_space.add_onode(oid, o);
 }
 
+void BlueStore::Collection::prefetch_onodes(
+  const Transaction::id_view<ghobject_t>& oids)
+{
+  ceph_assert(ceph_mutex_is_locked(lock));
+
+  spg_t pgid;
+  bool is_pg = cid.is_pg(&pgid);
+  vector<const ghobject_t*> want;
+  vector<string> keys;
+  for (auto& oid : oids) {
+    if (is_pg && !oid.match(cnode.bits, pgid.ps())) {
+      // belongs to some other collection in the transaction
+      continue;
+    }
+    if (onode_space.lookup(oid)) {
+      continue;
+    }
+    want.push_back(&oid);
+    keys.emplace_back();
+    get_object_key(store->cct, oid, &keys.back());
+  }
+  if (keys.size() < 2) {
+    // nothing to batch; get_onode will do the lookup
+    return;
+  }
+  ldout(store->cct, 20) << __func__ << " " << keys.size() << " onodes" << dendl;
+
+  vector<bufferlist> vals;
+  vector<int> rs;
+  store->db->get(PREFIX_OBJ, keys, &vals, &rs);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (rs[i] < 0 || vals[i].length() == 0) {
+      // missing objects are not cached, same as get_onode without create
+      continue;
+    }
+    OnodeRef o(Onode::create_decode(this, *want[i], keys[i], vals[i], true));
+    onode_space.add_onode(*want[i], o);
+  }
+}
+
 void BlueStore::Collection::split_cache(
   Collection *dest)
 {
@@ -4238,6 +4313,9 @@ void *BlueStore::MempoolThread::entry()
     if (binned_kv_onode_cache != nullptr) {
       pcm->insert("kv_onode", binned_kv_onode_cache, true);
     }
+    for (auto& [name, c] : user_caches) {
+      pcm->insert(name, c, true);
+    }
   }
 
   utime_t next_balance = ceph_clock_now();
@@ -4616,6 +4694,9 @@ void BlueStore::handle_discard(interval_set<uint64_t>& to_release)
   dout(10) << __func__ << dendl;
   ceph_assert(alloc);
   alloc->release(to_release);
+  if (alloc_journal_enabled) {
+    _alloc_journal_released(to_release);
+  }
 }
 
 BlueStore::BlueStore(CephContext *cct, const string& path)
@@ -4626,12 +4707,16 @@ BlueStore::BlueStore(CephContext *cct,
   uint64_t _min_alloc_size)
   : ObjectStore(cct, path),
     throttle(cct),
-    finisher(cct, "commit_finisher", "cfin"),
+    finisher(cct, "commit_finisher", "cfin",
+	     cct->_conf.get_val<uint64_t>("bluestore_finisher_threads")),
+    read_finisher(cct, "read_finisher", "rfin"),
     kv_sync_thread(this),
     kv_finalize_thread(this),
 #ifdef HAVE_LIBZBD
     zoned_cleaner_thread(this),
 #endif
+    alloc_ckpt_thread(this),
+    omap_convert_throttle(cct, "bluestore_omap_convert", 0, false),
     min_alloc_size(_min_alloc_size),
     min_alloc_size_order(std::countr_zero(_min_alloc_size)),
     mempool_thread(this)
@@ -4704,6 +4789,7 @@ const char **BlueStore::get_tracked_conf_keys() const
     "bluestore_warn_on_no_per_pool_omap",
     "bluestore_warn_on_no_per_pg_omap",
     "bluestore_max_defer_interval",
+    "bluestore_omap_online_conversion_bytes_per_sec",
     NULL
   };
   return KEYS;
@@ -4768,6 +4854,10 @@ void BlueStore::handle_conf_change(const ConfigProxy& conf,
       _set_max_defer_interval();
     }
   }
+  if (changed.count("bluestore_omap_online_conversion_bytes_per_sec")) {
+    omap_convert_throttle.reset_max(
+      conf->bluestore_omap_online_conversion_bytes_per_sec);
+  }
   if (changed.count("osd_memory_target") ||
       changed.count("osd_memory_base") ||
       changed.count("osd_memory_cache_min") ||
@@ -5034,6 +5124,11 @@ void BlueStore::_init_logger()
 	    "au_b",
 	    PerfCountersBuilder::PRIO_CRITICAL,
 	    unit_t(UNIT_BYTES));
+  b.add_u64(l_bluestore_prefer_deferred_size, "prefer_deferred_size",
+	    "Current size below which writes are deferred",
+	    NULL,
+	    PerfCountersBuilder::PRIO_DEBUGONLY,
+	    unit_t(UNIT_BYTES));
   //****************************************
 
   // Update op processing state latencies
@@ -5195,6 +5290,12 @@ void BlueStore::_init_logger()
   b.add_u64_counter(l_bluestore_write_small_skipped_bytes,
       "write_small_skipped_bytes",
       "Small writes into existing or sparse small blobs skipped due to zero detection (bytes)");
+  b.add_u64_counter(l_bluestore_write_zeroes_offloaded_bytes,
+      "write_zeroes_offloaded_bytes",
+      "Zero-filled writes into new blobs done by the device's write zeroes command (bytes)",
+      NULL,
+      PerfCountersBuilder::PRIO_DEBUGONLY,
+      unit_t(UNIT_BYTES));
   //****************************************
 
   // compressions stats
@@ -5218,6 +5319,21 @@ void BlueStore::_init_logger()
 	    "Sum for beneficial compress ops");
   b.add_u64_counter(l_bluestore_compress_rejected_count, "compress_rejected_count",
 	    "Sum for compress ops rejected due to low net gain of space");
+  b.add_u64_counter(l_bluestore_compress_skipped_entropy,
+		    "compress_skipped_entropy",
+		    "Blobs not compressed because their sampled entropy was high");
+  b.add_u64_counter(l_bluestore_compress_skipped_history,
+		    "compress_skipped_history",
+		    "Blobs not compressed because earlier ones of their object "
+		    "or PG were incompressible");
+  b.add_u64_counter(l_bluestore_compress_predict_hit,
+		    "compress_predict_hit",
+		    "Compressed blobs whose outcome the entropy sampling "
+		    "predicted correctly");
+  b.add_u64_counter(l_bluestore_compress_predict_miss,
+		    "compress_predict_miss",
+		    "Compressed blobs whose outcome the entropy sampling "
+		    "predicted wrongly");
   //****************************************
 
   // onode cache stats
@@ -5232,6 +5348,9 @@ void BlueStore::_init_logger()
   b.add_u64_counter(l_bluestore_onode_misses, "onode_misses",
 		    "Count of onode cache lookup misses",
 		    "o_ms", PerfCountersBuilder::PRIO_USEFUL);
+  b.add_u64_counter(l_bluestore_onode_numa_remote_hits,
+		    "onode_numa_remote_hits",
+		    "Count of onode cache hits from a thread off the shard's numa node");
   b.add_u64_counter(l_bluestore_onode_shard_hits, "onode_shard_hits",
 		    "Count of onode shard cache lookups hits");
   b.add_u64_counter(l_bluestore_onode_shard_misses,
@@ -5262,6 +5381,12 @@ void BlueStore::_init_logger()
 	    NULL,
 	    PerfCountersBuilder::PRIO_DEBUGONLY,
 	    unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluestore_buffer_numa_remote_hit_bytes,
+	    "buffer_numa_remote_hit_bytes",
+	    "Sum for bytes of read hit in the cache from a thread off the shard's numa node",
+	    NULL,
+	    PerfCountersBuilder::PRIO_DEBUGONLY,
+	    unit_t(UNIT_BYTES));
   //****************************************
 
   // internal stats
@@ -5284,6 +5409,13 @@ void BlueStore::_init_logger()
     "amount of omap keys removed via rmkeys");
   b.add_u64_counter(l_bluestore_omap_rmkey_ranges_count, "omap_rmkey_range_count",
     "amount of omap key ranges removed via rmkeys");
+  b.add_u64_counter(l_bluestore_omap_convert_objects, "omap_convert_objects",
+    "objects converted to per-pg omap online");
+  b.add_u64_counter(l_bluestore_omap_convert_bytes, "omap_convert_bytes",
+    "omap bytes rewritten by the online per-pg conversion",
+    NULL, 0, unit_t(UNIT_BYTES));
+  b.add_u64(l_bluestore_omap_convert_pending, "omap_convert_pending",
+    "collections waiting for the online per-pg omap conversion");
   //****************************************
   // other client ops latencies
   //****************************************
@@ -5533,6 +5665,10 @@ void BlueStore::_set_alloc_sizes(void)
     }
   }
 
+  if (logger) {
+    logger->set(l_bluestore_prefer_deferred_size, prefer_deferred_size);
+  }
+
   dout(10) << __func__ << " min_alloc_size 0x" << std::hex << min_alloc_size
 	   << std::dec << " order " << (int)min_alloc_size_order
 	   << " max_alloc_size 0x" << std::hex << max_alloc_size
@@ -5542,6 +5678,82 @@ void BlueStore::_set_alloc_sizes(void)
 	   << dendl;
 }
 
+void BlueStore::_maybe_tune_deferred_size()
+{
+  if (!cct->_conf->bluestore_deferred_adaptive) {
+    return;
+  }
+#ifdef HAVE_LIBZBD
+  if (bdev->is_smr()) {
+    return;
+  }
+#endif
+  auto now = mono_clock::now();
+  if (now - deferred_tuner_last_adjust <
+      make_timespan(cct->_conf->bluestore_deferred_adaptive_interval)) {
+    return;
+  }
+  deferred_tuner_last_adjust = now;
+  uint64_t cur = prefer_deferred_size;
+  uint64_t next = deferred_tuner.adjust(
+    cur,
+    cct->_conf->bluestore_deferred_adaptive_min_size,
+    std::max(cct->_conf->bluestore_deferred_adaptive_min_size,
+	     cct->_conf->bluestore_deferred_adaptive_max_size),
+    cct->_conf->bluestore_deferred_adaptive_min_samples);
+  if (next != cur) {
+    dout(5) << __func__ << " prefer_deferred_size 0x" << std::hex << cur
+	    << " -> 0x" << next << std::dec << dendl;
+    prefer_deferred_size = next;
+    logger->set(l_bluestore_prefer_deferred_size, next);
+  }
+}
+
+class BlueStore::SocketHook : public AdminSocketHook {
+  BlueStore *store;
+  bool registered = false;
+public:
+  explicit SocketHook(BlueStore *store) : store(store) {
+    AdminSocket *admin_socket = store->cct->get_admin_socket();
+    if (admin_socket) {
+      int r = admin_socket->register_command(
+	"bluestore deferred status",
+	this,
+	"show the current deferred write threshold and batch size");
+      // some collision (e.g. several stores in one process), disable
+      registered = r == 0;
+    }
+  }
+  ~SocketHook() {
+    AdminSocket *admin_socket = store->cct->get_admin_socket();
+    if (admin_socket && registered) {
+      admin_socket->unregister_commands(this);
+    }
+  }
+
+  int call(std::string_view command,
+	   const cmdmap_t& cmdmap,
+	   const bufferlist&,
+	   Formatter *f,
+	   std::ostream& ss,
+	   bufferlist& out) override {
+    if (command != "bluestore deferred status") {
+      ss << "Invalid command" << std::endl;
+      return -ENOSYS;
+    }
+    f->open_object_section("deferred_status");
+    f->dump_unsigned("prefer_deferred_size", store->prefer_deferred_size);
+    f->dump_int("deferred_batch_ops", store->deferred_batch_ops);
+    f->dump_int("deferred_queue_size", store->deferred_queue_size);
+    f->dump_bool("adaptive", store->cct->_conf->bluestore_deferred_adaptive);
+    f->open_object_section("tuner");
+    store->deferred_tuner.dump(f);
+    f->close_section();
+    f->close_section();
+    return 0;
+  }
+};
+
 int BlueStore::_open_bdev(bool create)
 {
   ceph_assert(bdev == NULL);
@@ -5787,13 +5999,26 @@ int BlueStore::_create_alloc()
   }
 #endif
 
-  alloc = Allocator::create(
-    cct, allocator_type,
-    bdev->get_size(),
-    alloc_size,
-    zone_size,
-    first_sequential_zone,
-    "block");
+  unsigned cache_shards =
+    cct->_conf.get_val<uint64_t>("bluestore_allocator_cache_shards");
+  if (cache_shards && allocator_type != "zoned") {
+    alloc = MagazineAllocator::create(
+      cct, allocator_type,
+      bdev->get_size(),
+      alloc_size,
+      cache_shards,
+      cct->_conf.get_val<uint64_t>("bluestore_allocator_cache_max_units"),
+      cct->_conf.get_val<uint64_t>("bluestore_allocator_cache_depth"),
+      "block");
+  } else {
+    alloc = Allocator::create(
+      cct, allocator_type,
+      bdev->get_size(),
+      alloc_size,
+      zone_size,
+      first_sequential_zone,
+      "block");
+  }
   if (!alloc) {
     lderr(cct) << __func__ << " failed to create " << allocator_type << " allocator"
 	       << dendl;
@@ -5921,6 +6146,8 @@ int BlueStore::_init_alloc(std::map<uint64_t, uint64_t> *zone_adjustments)
     }
     if (restore_allocator(alloc, &num, &bytes) == 0) {
       dout(5) << __func__ << "::NCB::restore_allocator() completed successfully alloc=" << alloc << dendl;
+    } else if (restore_allocation_checkpoint(alloc, &num, &bytes) == 0) {
+      dout(1) << __func__ << "::NCB::restored allocation from checkpoint and journal" << dendl;
     } else {
       // This must mean that we had an unplanned shutdown and didn't manage to destage the allocator
       dout(0) << __func__ << "::NCB::restore_allocator() failed! Run Full Recovery from ONodes (might take a while) ..." << dendl;
@@ -5973,6 +6200,11 @@ void BlueStore::_post_init_alloc(const std::map<uint64_t, uint64_t>& zone_adjust
     // This means that we should not use the existing file on failure case (unplanned shutdown) and must resort
     //  to recovery from RocksDB::ONodes
     r = invalidate_allocation_file_on_bluefs();
+    if (r >= 0) {
+      // the journal is only kept while mounted with checkpoints enabled,
+      // what follows might not keep it
+      r = reset_allocation_checkpoint();
+    }
   }
   ceph_assert(r >= 0);
 }
@@ -7702,6 +7934,15 @@ void BlueStore::set_cache_shards(unsigned num)
   }
 }
 
+void BlueStore::set_cache_shard_numa_node(unsigned shard, int node)
+{
+  dout(10) << __func__ << " shard " << shard << " node " << node << dendl;
+  ceph_assert(shard < onode_cache_shards.size());
+  ceph_assert(shard < buffer_cache_shards.size());
+  onode_cache_shards[shard]->numa_node = node;
+  buffer_cache_shards[shard]->numa_node = node;
+}
+
 //---------------------------------------------
 bool BlueStore::has_null_manager() const
 {
@@ -7763,6 +8004,10 @@ int BlueStore::_mount()
     return r;
   }
 
+  alloc_journal_enabled = fm->is_null_manager() &&
+    !bdev->is_smr() &&
+    cct->_conf->bluestore_allocation_checkpoint_interval > 0;
+
   _kv_start();
   auto stop_kv = make_scope_guard([&] {
     if (!mounted) {
@@ -7797,6 +8042,16 @@ int BlueStore::_mount()
     }
   }
 
+  if (alloc_journal_enabled) {
+    _alloc_ckpt_start();
+  }
+
+  if (per_pool_omap != OMAP_PER_PG &&
+      cct->_conf->bluestore_omap_online_conversion) {
+    _omap_convert_start();
+  }
+
+  asok_hook = new SocketHook(this);
   mounted = true;
   return 0;
 }
@@ -7804,9 +8059,17 @@ int BlueStore::_mount()
 int BlueStore::umount()
 {
   ceph_assert(_kv_only || mounted);
+  if (alloc_journal_enabled) {
+    // keep journaling until the db is closed, a fast shutdown skips
+    // storing the allocation file
+    _alloc_ckpt_stop();
+  }
+  _omap_convert_stop();
   _osr_drain_all();
 
   mounted = false;
+  delete asok_hook;
+  asok_hook = nullptr;
 
   ceph_assert(alloc);
 
@@ -7827,6 +8090,7 @@ int BlueStore::umount()
     dout(20) << __func__ << " closing" << dendl;
   }
   _close_db_and_around();
+  alloc_journal_enabled = false;
   // disable fsck on fast-shutdown
   if (cct->_conf->bluestore_fsck_on_umount && !m_fast_shutdown) {
     int rc = fsck(cct->_conf->bluestore_fsck_on_umount_deep);
@@ -8777,90 +9041,186 @@ void BlueStore::_fsck_check_object_omap(FSCKDepth depth,
     !o->onode.is_perpg_omap() &&
     !o->onode.is_pgmeta_omap()) {
     dout(10) << "fsck converting " << o->oid << " omap to per-pg" << dendl;
-    bufferlist header;
-    map<string, bufferlist> kv;
-    {
-      KeyValueDB::Transaction txn = db->get_transaction();
-      uint64_t txn_cost = 0;
-      const string& prefix = Onode::calc_omap_prefix(o->onode.flags);
-      uint8_t new_flags = o->onode.flags |
-	bluestore_onode_t::FLAG_PERPOOL_OMAP |
-	bluestore_onode_t::FLAG_PERPG_OMAP;
-      const string& new_omap_prefix = Onode::calc_omap_prefix(new_flags);
-
-      KeyValueDB::Iterator it = db->get_iterator(prefix);
-      string head, tail;
-      o->get_omap_header(&head);
-      o->get_omap_tail(&tail);
-      it->lower_bound(head);
-      // head
-      if (it->valid() && it->key() == head) {
-	dout(30) << __func__ << "  got header" << dendl;
-	header = it->value();
-	if (header.length()) {
-	  string new_head;
-	  Onode::calc_omap_header(new_flags, o.get(), &new_head);
-	  txn->set(new_omap_prefix, new_head, header);
-	  txn_cost += new_head.length() + header.length();
-	}
-	it->next();
-      }
-      // tail
-      {
-	string new_tail;
-	Onode::calc_omap_tail(new_flags, o.get(), &new_tail);
-	bufferlist empty;
-	txn->set(new_omap_prefix, new_tail, empty);
-	txn_cost += new_tail.length() + new_tail.length();
-      }
-      // values
-      string final_key;
-      Onode::calc_omap_key(new_flags, o.get(), string(), &final_key);
-      size_t base_key_len = final_key.size();
-      while (it->valid() && it->key() < tail) {
-	string user_key;
-	o->decode_omap_key(it->key(), &user_key);
-	dout(20) << __func__ << "  got " << pretty_binary_string(it->key())
-	  << " -> " << user_key << dendl;
-
-	final_key.resize(base_key_len);
-	final_key += user_key;
-	auto v = it->value();
-	txn->set(new_omap_prefix, final_key, v);
-	txn_cost += final_key.length() + v.length();
-
-	// submit a portion if cost exceeds 16MB
-	if (txn_cost >= 16 * (1 << 20) ) {
-	  db->submit_transaction_sync(txn);
-	  txn = db->get_transaction();
-	  txn_cost = 0;
-	}
-	it->next();
+    _convert_omap_to_per_pg(o);
+    repairer->inc_repaired();
+    repairer->request_compaction();
+  }
+}
+
+uint64_t BlueStore::_convert_omap_to_per_pg(OnodeRef& o)
+{
+  ceph_assert(o->onode.has_omap());
+  ceph_assert(!o->onode.is_perpg_omap() && !o->onode.is_pgmeta_omap());
+  uint64_t bytes = 0;
+  {
+    KeyValueDB::Transaction txn = db->get_transaction();
+    uint64_t txn_cost = 0;
+    const string& prefix = Onode::calc_omap_prefix(o->onode.flags);
+    uint8_t new_flags = o->onode.flags |
+      bluestore_onode_t::FLAG_PERPOOL_OMAP |
+      bluestore_onode_t::FLAG_PERPG_OMAP;
+    const string& new_omap_prefix = Onode::calc_omap_prefix(new_flags);
+
+    KeyValueDB::Iterator it = db->get_iterator(prefix);
+    string head, tail;
+    o->get_omap_header(&head);
+    o->get_omap_tail(&tail);
+    it->lower_bound(head);
+    // head
+    if (it->valid() && it->key() == head) {
+      dout(30) << __func__ << "  got header" << dendl;
+      bufferlist header = it->value();
+      if (header.length()) {
+	string new_head;
+	Onode::calc_omap_header(new_flags, o.get(), &new_head);
+	txn->set(new_omap_prefix, new_head, header);
+	txn_cost += new_head.length() + header.length();
       }
-      if (txn_cost > 0) {
+      it->next();
+    }
+    // tail
+    {
+      string new_tail;
+      Onode::calc_omap_tail(new_flags, o.get(), &new_tail);
+      bufferlist empty;
+      txn->set(new_omap_prefix, new_tail, empty);
+      txn_cost += new_tail.length() + new_tail.length();
+    }
+    // values
+    string final_key;
+    Onode::calc_omap_key(new_flags, o.get(), string(), &final_key);
+    size_t base_key_len = final_key.size();
+    while (it->valid() && it->key() < tail) {
+      string user_key;
+      o->decode_omap_key(it->key(), &user_key);
+      dout(20) << __func__ << "  got " << pretty_binary_string(it->key())
+	<< " -> " << user_key << dendl;
+
+      final_key.resize(base_key_len);
+      final_key += user_key;
+      auto v = it->value();
+      txn->set(new_omap_prefix, final_key, v);
+      txn_cost += final_key.length() + v.length();
+
+      // submit a portion if cost exceeds 16MB
+      if (txn_cost >= 16 * (1 << 20) ) {
 	db->submit_transaction_sync(txn);
+	txn = db->get_transaction();
+	bytes += txn_cost;
+	txn_cost = 0;
       }
+      it->next();
     }
-    // finalize: remove legacy data
-    {
-      KeyValueDB::Transaction txn = db->get_transaction();
-      // remove old keys
-      const string& old_omap_prefix = o->get_omap_prefix();
-      string old_head, old_tail;
-      o->get_omap_header(&old_head);
-      o->get_omap_tail(&old_tail);
-      txn->rm_range_keys(old_omap_prefix, old_head, old_tail);
-      txn->rmkey(old_omap_prefix, old_tail);
-      // set flag
-      o->onode.set_flag(bluestore_onode_t::FLAG_PERPOOL_OMAP | bluestore_onode_t::FLAG_PERPG_OMAP);
-      _record_onode(o, txn);
+    if (txn_cost > 0) {
       db->submit_transaction_sync(txn);
-      repairer->inc_repaired();
-      repairer->request_compaction();
+      bytes += txn_cost;
     }
   }
+  // finalize: remove legacy data
+  {
+    KeyValueDB::Transaction txn = db->get_transaction();
+    // remove old keys
+    const string& old_omap_prefix = o->get_omap_prefix();
+    string old_head, old_tail;
+    o->get_omap_header(&old_head);
+    o->get_omap_tail(&old_tail);
+    txn->rm_range_keys(old_omap_prefix, old_head, old_tail);
+    txn->rmkey(old_omap_prefix, old_tail);
+    // set flag
+    o->onode.set_flag(bluestore_onode_t::FLAG_PERPOOL_OMAP | bluestore_onode_t::FLAG_PERPG_OMAP);
+    _record_onode(o, txn);
+    db->submit_transaction_sync(txn);
+  }
+  return bytes;
+}
+
+int64_t BlueStore::fsck_deep_read(CollectionRef c, OnodeRef o)
+{
+  std::shared_lock cl(c->lock);
+  int64_t errors = 0;
+  bufferlist bl;
+  uint64_t max_read_block = cct->_conf->bluestore_fsck_read_bytes_cap;
+  uint64_t offset = 0;
+  do {
+    uint64_t l = std::min(uint64_t(o->onode.size - offset), max_read_block);
+    int r = _do_read(c.get(), o, offset, l, bl,
+      CEPH_OSD_OP_FLAG_FADVISE_NOCACHE);
+    if (r < 0) {
+      ++errors;
+      derr << "fsck error: " << o->oid << std::hex
+        << " error during read: "
+        << " " << offset << "~" << l
+        << " " << cpp_strerror(r) << std::dec
+        << dendl;
+      break;
+    }
+    offset += l;
+  } while (offset < o->onode.size);
+  return errors;
 }
 
+/**
+ * DeepFSCKReader
+ *
+ * Reads object data for deep fsck on a few threads while the onode scan
+ * proceeds, so that the device sees several reads at a time. The queue is
+ * bounded to keep the scan from holding too many onodes.
+ */
+class DeepFSCKReader {
+public:
+  DeepFSCKReader(BlueStore* store, size_t n_threads)
+    : store(store), max_queued(n_threads * 4) {
+    for (size_t i = 0; i < n_threads; i++) {
+      threads.push_back(make_named_thread("bstore_fsck_rd", [this] {
+        worker();
+      }));
+    }
+  }
+  void queue(BlueStore::CollectionRef c, BlueStore::OnodeRef o) {
+    std::unique_lock l{lock};
+    cond.wait(l, [this] { return pending.size() < max_queued; });
+    pending.emplace_back(std::move(c), std::move(o));
+    cond.notify_all();
+  }
+  /// wait for the queued reads, returns the number of errors they hit
+  int64_t finish() {
+    {
+      std::lock_guard l{lock};
+      stopping = true;
+      cond.notify_all();
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    return errors;
+  }
+private:
+  void worker() {
+    std::unique_lock l{lock};
+    while (true) {
+      cond.wait(l, [this] { return stopping || !pending.empty(); });
+      if (pending.empty()) {
+        break;
+      }
+      auto [c, o] = std::move(pending.front());
+      pending.pop_front();
+      cond.notify_all();
+      l.unlock();
+      errors += store->fsck_deep_read(std::move(c), std::move(o));
+      l.lock();
+    }
+  }
+
+  BlueStore* store;
+  const size_t max_queued;
+  ceph::mutex lock = ceph::make_mutex("DeepFSCKReader::lock");
+  ceph::condition_variable cond;
+  std::deque<std::pair<BlueStore::CollectionRef, BlueStore::OnodeRef>> pending;
+  bool stopping = false;
+  std::atomic<int64_t> errors = {0};
+  std::vector<std::thread> threads;
+};
+
 void BlueStore::_fsck_check_objects(
   FSCKDepth depth,
   BlueStore::FSCK_ObjectCtx& ctx)
@@ -8898,6 +9258,10 @@ void BlueStore::_fsck_check_objects(
       ceph_assert(sb_info_lock);
       thread_pool.start();
     }
+    std::optional<DeepFSCKReader> deep_reader;
+    if (depth == FSCK_DEEP && cct->_conf->bluestore_fsck_deep_read_threads > 0) {
+      deep_reader.emplace(this, cct->_conf->bluestore_fsck_deep_read_threads);
+    }
 
     // fill global if not overriden below
     CollectionRef c;
@@ -9084,27 +9448,17 @@ void BlueStore::_fsck_check_objects(
           }
         } // if (o->onode.has_omap())
         if (depth == FSCK_DEEP) {
-          bufferlist bl;
-          uint64_t max_read_block = cct->_conf->bluestore_fsck_read_bytes_cap;
-          uint64_t offset = 0;
-          do {
-            uint64_t l = std::min(uint64_t(o->onode.size - offset), max_read_block);
-            int r = _do_read(c.get(), o, offset, l, bl,
-              CEPH_OSD_OP_FLAG_FADVISE_NOCACHE);
-            if (r < 0) {
-              ++errors;
-              derr << "fsck error: " << oid << std::hex
-                << " error during read: "
-                << " " << offset << "~" << l
-                << " " << cpp_strerror(r) << std::dec
-                << dendl;
-              break;
-            }
-            offset += l;
-          } while (offset < o->onode.size);
+          if (deep_reader) {
+            deep_reader->queue(c, o);
+          } else {
+            errors += fsck_deep_read(c, o);
+          }
         } // deep
       } //if (depth != FSCK_SHALLOW)
     } // for (it->lower_bound(string()); it->valid(); it->next())
+    if (deep_reader) {
+      errors += deep_reader->finish();
+    }
     if (depth == FSCK_SHALLOW && thread_count > 0) {
       wq->finalize(thread_pool, ctx);
       if (processed_myself) {
@@ -9678,23 +10032,37 @@ int BlueStore::_fsck_on_open(BlueStore::FSCKDepth depth, bool repair)
 	      expected_statfs->data_compressed_allocated += e->length;
 	    }
 
+	    // let the device copy the extent if it can
+	    bool copied = true;
+	    uint64_t src_off = e->offset;
+	    for (auto& p : exts) {
+	      if (bdev->copy_range(src_off, p.offset, p.length) < 0) {
+		copied = false;
+		break;
+	      }
+	      src_off += p.length;
+	    }
 	    bufferlist bl;
-	    IOContext ioc(cct, NULL, !cct->_conf->bluestore_fail_eio);
-	    r = bdev->read(e->offset, e->length, &bl, &ioc, false);
-	    if (r < 0) {
-	      derr << __func__ << " failed to read from 0x" << std::hex << e->offset
-		    <<"~" << e->length << std::dec << dendl;
-	      ceph_abort_msg("read failed, wtf");
+	    if (!copied) {
+	      IOContext ioc(cct, NULL, !cct->_conf->bluestore_fail_eio);
+	      r = bdev->read(e->offset, e->length, &bl, &ioc, false);
+	      if (r < 0) {
+		derr << __func__ << " failed to read from 0x" << std::hex << e->offset
+		      <<"~" << e->length << std::dec << dendl;
+		ceph_abort_msg("read failed, wtf");
+	      }
 	    }
 	    pext_to_release.push_back(*e);
 	    e = pextents.erase(e);
     	    e = pextents.insert(e, exts.begin(), exts.end());
-	    b->get_blob().map_bl(
-	      b_off_cur, bl,
-	      [&](uint64_t offset, bufferlist& t) {
-		int r = bdev->write(offset, t, false);
-		ceph_assert(r == 0);
-	      });
+	    if (!copied) {
+	      b->get_blob().map_bl(
+		b_off_cur, bl,
+		[&](uint64_t offset, bufferlist& t) {
+		  int r = bdev->write(offset, t, false);
+		  ceph_assert(r == 0);
+		});
+	    }
 	    e += exts.size() - 1;
             for (auto& p : exts) {
 	      fm->allocate(p.offset, p.length, txn);
@@ -10850,6 +11218,159 @@ int BlueStore::read(
   return r;
 }
 
+void BlueStore::read_async(
+  CollectionHandle &c_,
+  const ghobject_t& oid,
+  uint64_t offset,
+  size_t length,
+  bufferlist *bl,
+  Context *on_complete,
+  uint32_t op_flags)
+{
+  Collection *c = static_cast<Collection *>(c_.get());
+  dout(15) << __func__ << " " << c->get_cid() << " " << oid
+	   << " 0x" << std::hex << offset << "~" << length << std::dec
+	   << dendl;
+  if (!c->exists) {
+    on_complete->complete(-ENOENT);
+    return;
+  }
+
+  bl->clear();
+  auto rd = new AsyncRead(cct, c, oid, offset, length, op_flags, bl,
+			  on_complete);
+  int r = 0;
+  {
+    std::shared_lock l(c->lock);
+    rd->o = c->get_onode(oid, false);
+    if (!rd->o || !rd->o->exists) {
+      r = -ENOENT;
+    } else {
+      if (offset == length && offset == 0)
+	rd->length = rd->o->onode.size;
+      rd->have_data = _read_setup(rd->o, rd->offset, rd->length, op_flags,
+				  &rd->buffered, rd->ready_regions,
+				  rd->blobs2read);
+      if (rd->have_data) {
+	r = _prepare_read_ioc(rd->blobs2read, &rd->compressed_blob_bls,
+			      &rd->ioc);
+      }
+    }
+  }
+  if (r < 0 || !rd->ioc.has_pending_aios()) {
+    // all cached (or failed); nothing to wait for
+    _finish_async_read(rd, r);
+    return;
+  }
+  {
+    std::lock_guard l(async_read_lock);
+    ++async_reads_in_flight;
+  }
+  dout(20) << __func__ << " " << oid << " submitting "
+	   << rd->ioc.get_num_ios() << " aios" << dendl;
+  bdev->aio_submit(&rd->ioc);
+}
+
+void BlueStore::AsyncRead::aio_finish(BlueStore *store)
+{
+  // checksums and decompression don't belong on the aio thread
+  store->read_finisher.queue(new LambdaContext([store, this](int) {
+    store->_finish_async_read(this, ioc.get_return_value());
+    std::lock_guard l(store->async_read_lock);
+    if (--store->async_reads_in_flight == 0) {
+      store->async_read_cond.notify_all();
+    }
+  }));
+}
+
+void BlueStore::_finish_async_read(AsyncRead *rd, int r)
+{
+  if (r >= 0 && rd->have_data) {
+    // same locking as a synchronous read while we touch the onode
+    std::shared_lock l(rd->c->lock);
+    bool csum_error = false;
+    r = _generate_read_result_bl(rd->o, rd->offset, rd->length,
+				 rd->ready_regions, rd->compressed_blob_bls,
+				 rd->blobs2read,
+				 rd->buffered && !rd->ioc.skip_cache(),
+				 &csum_error, *rd->bl);
+    if (csum_error) {
+      // retry the way _do_read does, synchronously
+      r = _do_read(rd->c.get(), rd->o, rd->offset, rd->length, *rd->bl,
+		   rd->op_flags, 1);
+    } else if (r >= 0) {
+      r = rd->bl->length();
+    }
+  }
+  if (r == -EIO) {
+    logger->inc(l_bluestore_read_eio);
+  } else if (r >= 0 && _debug_data_eio(rd->oid)) {
+    r = -EIO;
+    derr << __func__ << " " << rd->c->cid << " " << rd->oid
+	 << " INJECT EIO" << dendl;
+  }
+  dout(10) << __func__ << " " << rd->c->cid << " " << rd->oid
+	   << " 0x" << std::hex << rd->offset << "~" << rd->length << std::dec
+	   << " = " << r << dendl;
+  log_latency("read_async",
+    l_bluestore_read_lat,
+    mono_clock::now() - rd->start,
+    cct->_conf->bluestore_log_op_age);
+  Context *fin = rd->on_complete;
+  delete rd;
+  fin->complete(r);
+}
+
+int BlueStore::read_digest(
+  CollectionHandle &c_,
+  const ghobject_t& oid,
+  uint64_t offset,
+  size_t length,
+  uint32_t *crc,
+  uint32_t op_flags)
+{
+  auto start = mono_clock::now();
+  Collection *c = static_cast<Collection *>(c_.get());
+  const coll_t &cid = c->get_cid();
+  dout(15) << __func__ << " " << cid << " " << oid
+	   << " 0x" << std::hex << offset << "~" << length << std::dec
+	   << dendl;
+  if (!c->exists)
+    return -ENOENT;
+
+  int r;
+  {
+    std::shared_lock l(c->lock);
+    OnodeRef o = c->get_onode(oid, false);
+    if (!o || !o->exists) {
+      r = -ENOENT;
+      goto out;
+    }
+
+    if (offset == length && offset == 0)
+      length = o->onode.size;
+
+    r = _do_read_digest(c, o, offset, length, crc, op_flags);
+    if (r == -EIO) {
+      logger->inc(l_bluestore_read_eio);
+    }
+  }
+
+ out:
+  if (r >= 0 && _debug_data_eio(oid)) {
+    r = -EIO;
+    derr << __func__ << " " << c->cid << " " << oid << " INJECT EIO" << dendl;
+  }
+  dout(10) << __func__ << " " << cid << " " << oid
+	   << " 0x" << std::hex << offset << "~" << length << std::dec
+	   << " = " << r << dendl;
+  log_latency(__func__,
+    l_bluestore_read_lat,
+    mono_clock::now() - start,
+    cct->_conf->bluestore_log_op_age);
+  return r;
+}
+
 void BlueStore::_read_cache(
   OnodeRef& o,
   uint64_t offset,
@@ -11109,39 +11630,32 @@ int BlueStore::_generate_read_result_bl(
   return 0;
 }
 
-int BlueStore::_do_read(
-  Collection *c,
+bool BlueStore::_read_setup(
   OnodeRef& o,
   uint64_t offset,
-  size_t length,
-  bufferlist& bl,
+  size_t& length,
   uint32_t op_flags,
-  uint64_t retry_count)
-{
-  FUNCTRACE(cct);
-  int r = 0;
+  bool* buffered,
+  ready_regions_t& ready_regions,
+  blobs2read_t& blobs2read)
+{
   int read_cache_policy = 0; // do not bypass clean or dirty cache
 
-  dout(20) << __func__ << " 0x" << std::hex << offset << "~" << length
-           << " size 0x" << o->onode.size << " (" << std::dec
-           << o->onode.size << ")" << dendl;
-  bl.clear();
-
   if (offset >= o->onode.size) {
-    return r;
+    return false;
   }
 
   // generally, don't buffer anything, unless the client explicitly requests
   // it.
-  bool buffered = false;
+  *buffered = false;
   if (op_flags & CEPH_OSD_OP_FLAG_FADVISE_WILLNEED) {
     dout(20) << __func__ << " will do buffered read" << dendl;
-    buffered = true;
+    *buffered = true;
   } else if (cct->_conf->bluestore_default_buffered_read &&
 	     (op_flags & (CEPH_OSD_OP_FLAG_FADVISE_DONTNEED |
 			  CEPH_OSD_OP_FLAG_FADVISE_NOCACHE)) == 0) {
     dout(20) << __func__ << " defaulting to buffered read" << dendl;
-    buffered = true;
+    *buffered = true;
   }
 
   if (offset + length > o->onode.size) {
@@ -11164,13 +11678,37 @@ int BlueStore::_do_read(
   }
 
   // build blob-wise list to of stuff read (that isn't cached)
-  ready_regions_t ready_regions;
-  blobs2read_t blobs2read;
   _read_cache(o, offset, length, read_cache_policy, ready_regions, blobs2read);
+  return true;
+}
+
+int BlueStore::_do_read(
+  Collection *c,
+  OnodeRef& o,
+  uint64_t offset,
+  size_t length,
+  bufferlist& bl,
+  uint32_t op_flags,
+  uint64_t retry_count)
+{
+  FUNCTRACE(cct);
+  int r = 0;
+
+  dout(20) << __func__ << " 0x" << std::hex << offset << "~" << length
+           << " size 0x" << o->onode.size << " (" << std::dec
+           << o->onode.size << ")" << dendl;
+  bl.clear();
 
+  bool buffered;
+  ready_regions_t ready_regions;
+  blobs2read_t blobs2read;
+  if (!_read_setup(o, offset, length, op_flags, &buffered,
+		   ready_regions, blobs2read)) {
+    return r;
+  }
 
   // read raw blob data.
-  start = mono_clock::now(); // for the sake of simplicity
+  auto start = mono_clock::now(); // for the sake of simplicity
                              // measure the whole block below.
                              // The error isn't that much...
   vector<bufferlist> compressed_blob_bls;
@@ -11227,6 +11765,148 @@ int BlueStore::_do_read(
   return r;
 }
 
+/// crc32c of A|B given crc32c(A) and the -1 seeded crc32c of B
+static uint32_t crc32c_append(uint32_t crc, uint32_t crc_b, uint64_t len_b)
+{
+  return crc_b ^ ceph_crc32c(crc, nullptr, len_b) ^
+    ceph_crc32c(-1, nullptr, len_b);
+}
+
+int BlueStore::_do_read_digest(
+  Collection *c,
+  OnodeRef& o,
+  uint64_t offset,
+  size_t length,
+  uint32_t *crc,
+  uint32_t op_flags,
+  uint64_t retry_count)
+{
+  dout(20) << __func__ << " 0x" << std::hex << offset << "~" << length
+           << " size 0x" << o->onode.size << " (" << std::dec
+           << o->onode.size << ")" << dendl;
+
+  bool buffered;
+  ready_regions_t ready_regions;
+  blobs2read_t blobs2read;
+  if (!_read_setup(o, offset, length, op_flags, &buffered,
+		   ready_regions, blobs2read)) {
+    return 0;
+  }
+
+  auto start = mono_clock::now();
+  vector<bufferlist> compressed_blob_bls;
+  IOContext ioc(cct, NULL, !cct->_conf->bluestore_fail_eio);
+  int r = _prepare_read_ioc(blobs2read, &compressed_blob_bls, &ioc);
+  if (r < 0)
+    return r;
+  if (ioc.has_pending_aios()) {
+    bdev->aio_submit(&ioc);
+    ioc.aio_wait();
+    r = ioc.get_return_value();
+    if (r < 0) {
+      ceph_assert(r == -EIO); // no other errors allowed
+      return -EIO;
+    }
+  }
+  log_latency(__func__,
+    l_bluestore_read_wait_aio_lat,
+    mono_clock::now() - start,
+    cct->_conf->bluestore_log_op_age);
+
+  // the -1 seeded crc32c of each logical region; regions of uncompressed
+  // crc32c blobs which cover whole csum chunks get theirs from the blob
+  // checksums just verified rather than by hashing the data again
+  std::map<uint64_t, std::pair<uint64_t, uint32_t>> digests;
+  for (auto& [logical_offset, bl] : ready_regions) {
+    digests[logical_offset] = {bl.length(), bl.crc32c(-1)};
+  }
+  auto p = compressed_blob_bls.begin();
+  for (auto& [bptr, r2r] : blobs2read) {
+    const bluestore_blob_t& blob = bptr->get_blob();
+    if (blob.is_compressed()) {
+      ceph_assert(p != compressed_blob_bls.end());
+      bufferlist& compressed_bl = *p++;
+      if (_verify_csum(o, &blob, 0, compressed_bl,
+		       r2r.front().regs.front().logical_offset) < 0) {
+	goto csum_error;
+      }
+      bufferlist raw_bl;
+      r = _decompress(compressed_bl, &raw_bl);
+      if (r < 0)
+	return r;
+      if (buffered) {
+	bptr->shared_blob->bc.did_read(bptr->shared_blob->get_cache(), 0,
+				       raw_bl);
+      }
+      for (auto& req : r2r) {
+	for (auto& reg : req.regs) {
+	  bufferlist t;
+	  t.substr_of(raw_bl, reg.blob_xoffset, reg.length);
+	  digests[reg.logical_offset] = {reg.length, t.crc32c(-1)};
+	}
+      }
+      continue;
+    }
+    uint64_t chunk = blob.get_csum_chunk_size();
+    bool use_csum = blob.has_csum() &&
+      blob.csum_type == Checksummer::CSUM_CRC32C;
+    for (auto& req : r2r) {
+      if (_verify_csum(o, &blob, req.r_off, req.bl,
+		       req.regs.front().logical_offset) < 0) {
+	goto csum_error;
+      }
+      if (buffered) {
+	bptr->shared_blob->bc.did_read(bptr->shared_blob->get_cache(),
+				       req.r_off, req.bl);
+      }
+      for (const auto& reg : req.regs) {
+	uint32_t d = -1;
+	if (use_csum && reg.front % chunk == 0 && reg.length % chunk == 0) {
+	  for (uint64_t i = 0; i < reg.length; i += chunk) {
+	    d = crc32c_append(
+	      d, blob.get_csum_item((req.r_off + reg.front + i) / chunk), chunk);
+	  }
+	} else {
+	  bufferlist t;
+	  t.substr_of(req.bl, reg.front, reg.length);
+	  d = t.crc32c(-1);
+	}
+	digests[reg.logical_offset] = {reg.length, d};
+      }
+    }
+  }
+
+  {
+    // fold the regions, and zeros for the holes between them, into *crc
+    uint32_t d = *crc;
+    uint64_t pos = offset;
+    for (auto& [logical_offset, v] : digests) {
+      ceph_assert(logical_offset >= pos);
+      if (logical_offset > pos) {
+	d = ceph_crc32c(d, nullptr, logical_offset - pos);
+      }
+      d = crc32c_append(d, v.second, v.first);
+      pos = logical_offset + v.first;
+    }
+    ceph_assert(pos <= offset + length);
+    if (pos < offset + length) {
+      d = ceph_crc32c(d, nullptr, offset + length - pos);
+    }
+    *crc = d;
+  }
+  if (retry_count) {
+    logger->inc(l_bluestore_reads_with_retries);
+  }
+  return length;
+
+ csum_error:
+  // see _do_read()
+  if (retry_count >= cct->_conf->bluestore_retry_disk_reads) {
+    return -EIO;
+  }
+  return _do_read_digest(c, o, offset, length, crc, op_flags, retry_count + 1);
+}
+
 int BlueStore::_verify_csum(OnodeRef& o,
 			    const bluestore_blob_t* blob, uint64_t blob_xoffset,
 			    const bufferlist& bl,
@@ -11828,12 +12508,14 @@ int BlueStore::_collection_list(
     << " and " << coll_range_start
     << " to " << coll_range_end
     << " start " << start << dendl;
+  // listings (scrub, backfill, pg split) walk the whole collection once;
+  // keep them from pushing the working set out of the block cache
   if (legacy) {
     it = std::make_unique<SimpleCollectionListIterator>(
-      cct, db->get_iterator(PREFIX_OBJ));
+      cct, db->get_iterator(PREFIX_OBJ, KeyValueDB::ITERATOR_NOCACHE));
   } else {
     it = std::make_unique<SortedCollectionListIterator>(
-      db->get_iterator(PREFIX_OBJ));
+      db->get_iterator(PREFIX_OBJ, KeyValueDB::ITERATOR_NOCACHE));
   }
   if (start == ghobject_t() ||
     start.hobj == hobject_t() ||
@@ -12103,14 +12785,22 @@ int BlueStore::omap_get_values(
     const string& prefix = o->get_omap_prefix();
     o->get_omap_key(string(), &final_key);
     size_t base_key_len = final_key.size();
-    for (set<string>::const_iterator p = keys.begin(); p != keys.end(); ++p) {
+    vector<string> final_keys;
+    final_keys.reserve(keys.size());
+    for (auto& k : keys) {
       final_key.resize(base_key_len); // keep prefix
-      final_key += *p;
-      bufferlist val;
-      if (db->get(prefix, final_key, &val) >= 0) {
-	dout(30) << __func__ << "  got " << pretty_binary_string(final_key)
+      final_key += k;
+      final_keys.push_back(final_key);
+    }
+    vector<bufferlist> vals;
+    vector<int> rs;
+    db->get(prefix, final_keys, &vals, &rs);
+    size_t n = 0;
+    for (auto p = keys.begin(); p != keys.end(); ++p, ++n) {
+      if (rs[n] >= 0) {
+	dout(30) << __func__ << "  got " << pretty_binary_string(final_keys[n])
 		 << " -> " << *p << dendl;
-	out->insert(make_pair(*p, val));
+	out->insert(make_pair(*p, std::move(vals[n])));
       }
     }
   }
@@ -12841,6 +13531,8 @@ void BlueStore::_txc_finalize_kv(TransContext *txc, KeyValueDB::Transaction t)
 	       << "~" << p.get_len() << std::dec << dendl;
       fm->release(p.get_start(), p.get_len(), t);
     }
+  } else if (alloc_journal_enabled) {
+    _alloc_journal_finalize(txc, t);
   }
 
 #ifdef HAVE_LIBZBD
@@ -12920,16 +13612,30 @@ void BlueStore::_txc_committed_kv(TransContext *txc)
 {
   dout(20) << __func__ << " txc " << txc << dendl;
   throttle.complete_kv(*txc);
+  if (txc->alloc_journal_seq) {
+    _alloc_journal_committed(txc);
+  }
   {
     std::lock_guard l(txc->osr->qlock);
     txc->set_state(TransContext::STATE_KV_DONE);
     if (txc->ch->commit_queue) {
       txc->ch->commit_queue->queue(txc->oncommits);
     } else {
-      finisher.queue(txc->oncommits);
+      finisher.queue(reinterpret_cast<uint64_t>(txc->osr.get()),
+		     txc->oncommits);
     }
   }
   throttle.log_state_latency(*txc, logger, l_bluestore_state_kv_committing_lat);
+  if (cct->_conf->bluestore_deferred_adaptive &&
+      txc->had_ios != (txc->deferred_txn != nullptr)) {
+    // purely direct or purely deferred; mixed txcs tell nothing
+    deferred_tuner.note(
+      prefer_deferred_size,
+      txc->bytes,
+      txc->deferred_txn != nullptr,
+      std::chrono::duration_cast<std::chrono::microseconds>(
+	mono_clock::now() - txc->start).count());
+  }
   log_latency_fn(
     __func__,
     l_bluestore_commit_lat,
@@ -13040,6 +13746,9 @@ void BlueStore::_txc_release_alloc(TransContext *txc)
       dout(10) << __func__ << "(sync) " << txc << " " << std::hex
                << txc->released << std::dec << dendl;
       alloc->release(txc->released);
+      if (alloc_journal_enabled) {
+	_alloc_journal_released(txc->released);
+      }
   }
 
 out:
@@ -13171,6 +13880,10 @@ void BlueStore::_osr_drain_all()
     std::lock_guard l(kv_finalize_lock);
     kv_finalize_cond.notify_one();
   }
+  for (auto& shard : kv_finalize_shards) {
+    std::lock_guard l(shard->lock);
+    shard->cond.notify_one();
+  }
   for (auto osr : s) {
     dout(20) << __func__ << " drain " << osr << dendl;
     osr->drain();
@@ -13203,8 +13916,15 @@ void BlueStore::_kv_start()
   dout(10) << __func__ << dendl;
 
   finisher.start();
+  read_finisher.start();
   kv_sync_thread.create("bstore_kv_sync");
   kv_finalize_thread.create("bstore_kv_final");
+  ceph_assert(kv_finalize_shards.empty());
+  auto num_finalize = cct->_conf.get_val<uint64_t>("bluestore_kv_finalize_threads");
+  for (uint64_t i = 1; i < num_finalize; ++i) {
+    kv_finalize_shards.emplace_back(std::make_unique<KVFinalizeShard>(this));
+    kv_finalize_shards.back()->create("bstore_kv_final");
+  }
 }
 
 void BlueStore::_kv_stop()
@@ -13228,6 +13948,24 @@ void BlueStore::_kv_stop()
   }
   kv_sync_thread.join();
   kv_finalize_thread.join();
+  // kv_sync_thread is gone, so nothing can be dispatched to the shards anymore
+  for (auto& shard : kv_finalize_shards) {
+    {
+      std::unique_lock l{shard->lock};
+      while (!shard->started) {
+	shard->cond.wait(l);
+      }
+      shard->stop = true;
+      shard->cond.notify_all();
+    }
+    shard->join();
+  }
+  if (!kv_finalize_shards.empty()) {
+    // shards may have queued collections after the last reap by
+    // kv_finalize_thread
+    kv_finalize_shards.clear();
+    _reap_collections();
+  }
   ceph_assert(removed_collections.empty());
   {
     std::lock_guard l(kv_lock);
@@ -13238,6 +13976,12 @@ void BlueStore::_kv_stop()
     kv_finalize_stop = false;
   }
   dout(10) << __func__ << " stopping finishers" << dendl;
+  {
+    std::unique_lock l(async_read_lock);
+    async_read_cond.wait(l, [this] { return async_reads_in_flight == 0; });
+  }
+  read_finisher.wait_for_empty();
+  read_finisher.stop();
   finisher.wait_for_empty();
   finisher.stop();
   dout(10) << __func__ << " stopped" << dendl;
@@ -13445,6 +14189,7 @@ void BlueStore::_kv_sync_thread()
       }
 #endif
 
+      _kv_finalize_dispatch(kv_committing);
       {
 	std::unique_lock m{kv_finalize_lock};
 	if (kv_committing_to_finalize.empty()) {
@@ -13568,6 +14313,8 @@ void BlueStore::_kv_finalize_thread()
 	}
       }
 
+      _maybe_tune_deferred_size();
+
       // this is as good a place as any ...
       _reap_collections();
 
@@ -13586,6 +14333,79 @@ void BlueStore::_kv_finalize_thread()
   kv_finalize_started = false;
 }
 
+void BlueStore::_kv_finalize_dispatch(deque<TransContext*>& kv_committing)
+{
+  if (kv_finalize_shards.empty()) {
+    return;
+  }
+  // keep all txcs of a sequencer on the same thread so that they are
+  // finalized in order; whatever hashes to shard 0 stays in kv_committing
+  const size_t num_shards = kv_finalize_shards.size() + 1;
+  std::vector<deque<TransContext*>> per_shard(num_shards);
+  for (auto txc : kv_committing) {
+    per_shard[txc->osr->get_sequencer_id() % num_shards].push_back(txc);
+  }
+  kv_committing.swap(per_shard[0]);
+  for (size_t i = 1; i < num_shards; ++i) {
+    if (per_shard[i].empty()) {
+      continue;
+    }
+    auto& shard = kv_finalize_shards[i - 1];
+    std::lock_guard l(shard->lock);
+    shard->committing_to_finalize.insert(
+      shard->committing_to_finalize.end(),
+      per_shard[i].begin(),
+      per_shard[i].end());
+    if (!shard->in_progress) {
+      shard->in_progress = true;
+      shard->cond.notify_one();
+    }
+  }
+}
+
+void BlueStore::_kv_finalize_shard_thread(KVFinalizeShard *shard)
+{
+  deque<TransContext*> kv_committed;
+  dout(10) << __func__ << " start" << dendl;
+  std::unique_lock l(shard->lock);
+  ceph_assert(!shard->started);
+  shard->started = true;
+  shard->cond.notify_all();
+  while (true) {
+    ceph_assert(kv_committed.empty());
+    if (shard->committing_to_finalize.empty()) {
+      if (shard->stop)
+	break;
+      dout(20) << __func__ << " sleep" << dendl;
+      shard->in_progress = false;
+      shard->cond.wait(l);
+      dout(20) << __func__ << " wake" << dendl;
+    } else {
+      kv_committed.swap(shard->committing_to_finalize);
+      l.unlock();
+      dout(20) << __func__ << " kv_committed " << kv_committed << dendl;
+
+      auto start = mono_clock::now();
+
+      while (!kv_committed.empty()) {
+	TransContext *txc = kv_committed.front();
+	ceph_assert(txc->get_state() == TransContext::STATE_KV_SUBMITTED);
+	_txc_state_proc(txc);
+	kv_committed.pop_front();
+      }
+
+      log_latency("kv_final",
+	l_bluestore_kv_final_lat,
+	mono_clock::now() - start,
+	cct->_conf->bluestore_log_op_age);
+
+      l.lock();
+    }
+  }
+  dout(10) << __func__ << " finish" << dendl;
+  shard->started = false;
+}
+
 #ifdef HAVE_LIBZBD
 void BlueStore::_zoned_cleaner_start()
 {
@@ -14164,6 +14984,12 @@ int BlueStore::queue_transactions(
   if (bdev->is_smr()) {
     atomic_alloc_and_submit_lock.lock();
   }
+  // keep allocation checkpoints from seeing space we allocated but did
+  // not journal yet
+  std::shared_lock<ceph::shared_mutex> ckpt_l(alloc_ckpt_rwlock, std::defer_lock);
+  if (alloc_journal_enabled) {
+    ckpt_l.lock();
+  }
 
   // prepare
   TransContext *txc = _txc_create(static_cast<Collection*>(ch.get()), osr,
@@ -14188,6 +15014,9 @@ int BlueStore::queue_transactions(
   }
 
   _txc_finalize_kv(txc, txc->t);
+  if (ckpt_l.owns_lock()) {
+    ckpt_l.unlock();
+  }
 
 #ifdef WITH_BLKIN
   if (txc->trace) {
@@ -14242,7 +15071,7 @@ int BlueStore::queue_transactions(
     if (c->commit_queue) {
       c->commit_queue->queue(on_applied);
     } else {
-      finisher.queue(on_applied);
+      finisher.queue(reinterpret_cast<uint64_t>(osr), on_applied);
     }
   }
 
@@ -14277,13 +15106,21 @@ void BlueStore::_txc_add_transaction(TransContext *txc, Transaction *t)
 
   vector<CollectionRef> cvec(i.colls.size());
   unsigned j = 0;
-  for (vector<coll_t>::iterator p = i.colls.begin(); p != i.colls.end();
+  for (auto p = i.colls.begin(); p != i.colls.end();
        ++p, ++j) {
     cvec[j] = _get_collection(*p);
   }
   
   vector<OnodeRef> ovec(i.objects.size());
 
+  if (cct->_conf->bluestore_onode_prefetch &&
+      cvec.size() == 1 && cvec[0] && i.objects.size() > 1) {
+    // load all onodes the transaction touches with one batched lookup
+    // instead of a point lookup per object
+    std::shared_lock l(cvec[0]->lock);
+    cvec[0]->prefetch_onodes(i.objects);
+  }
+
   for (int pos = 0; i.have_op(); ++pos) {
     Transaction::Op *op = i.decode_op();
     int r = 0;
@@ -15473,6 +16310,33 @@ void BlueStore::_do_write_big(
   }
 }
 
+uint64_t BlueStore::_get_alloc_hint(OnodeRef& o, uint64_t offset)
+{
+  if (offset == 0) {
+    return 0;
+  }
+  auto& em = o->extent_map;
+  uint64_t prev = offset - 1;
+  if (!em.shards.empty()) {
+    // don't fault in a shard just for a placement hint
+    int s = em.seek_shard(prev);
+    if (s < 0 || !em.shards[s].loaded) {
+      return 0;
+    }
+  }
+  auto ep = em.seek_lextent(prev);
+  if (ep == em.extent_map.end() || ep->logical_offset > prev) {
+    return 0;
+  }
+  const bluestore_blob_t& blob = ep->blob->get_blob();
+  uint64_t x_off = ep->blob_offset + (prev - ep->logical_offset);
+  if (blob.is_compressed() || blob.is_shared() ||
+      !blob.is_allocated(p2align(x_off, min_alloc_size), min_alloc_size)) {
+    return 0;
+  }
+  return p2roundup(blob.calc_offset(x_off, nullptr) + 1, min_alloc_size);
+}
+
 int BlueStore::_do_alloc_write(
   TransContext *txc,
   CollectionRef coll,
@@ -15553,18 +16417,62 @@ int BlueStore::_do_alloc_write(
   // and the condition is : (data_size < deferred).
 
   auto max_bsize = std::max(wctx->target_blob_size, min_alloc_size);
-  for (auto& wi : wctx->writes) {
-    if (c && wi.blob_length > min_alloc_size) {
-      auto start = mono_clock::now();
 
-      // compress
+  // compress all blobs in one batch so that an offload device can work on
+  // them in parallel
+  std::vector<Compressor::BatchItem> batch;
+  // for each item of batch: predicted to be incompressible, only compressed
+  // to check that
+  std::vector<bool> verify;
+  double entropy_threshold = cct->_conf->bluestore_compression_entropy_threshold;
+  if (c) {
+    unsigned history_threshold =
+      cct->_conf->bluestore_compression_history_threshold;
+    for (auto& wi : wctx->writes) {
+      if (wi.blob_length <= min_alloc_size) {
+	continue;
+      }
       ceph_assert(wi.b_off == 0);
       ceph_assert(wi.blob_length == wi.bl.length());
-
+      // evaluate both so that each counts its skips
+      bool o_try = o->compression_history.should_try(history_threshold);
+      bool c_try = coll->compression_history.should_try(history_threshold);
+      if (!o_try || !c_try) {
+	logger->inc(l_bluestore_compress_skipped_history);
+	continue;
+      }
+      bool predicted_incompressible = entropy_threshold > 0 &&
+	Compressor::estimate_entropy(wi.bl) > entropy_threshold;
+      if (predicted_incompressible && ++comp_entropy_skips % 64) {
+	dout(20) << __func__ << std::hex << "  0x" << wi.blob_length
+		 << " looks incompressible, leaving uncompressed"
+		 << std::dec << dendl;
+	logger->inc(l_bluestore_compress_skipped_entropy);
+	o->compression_history.note(false);
+	coll->compression_history.note(false);
+	continue;
+      }
+      batch.emplace_back().in = &wi.bl;
+      verify.push_back(predicted_incompressible);
+    }
+    if (!batch.empty()) {
+      auto start = mono_clock::now();
+      c->compress_batch(batch);
+      log_latency("compress@_do_alloc_write",
+	l_bluestore_compress_lat,
+	mono_clock::now() - start,
+	cct->_conf->bluestore_log_op_age);
+    }
+  }
+  auto bi = batch.begin();
+  for (auto& wi : wctx->writes) {
+    if (bi != batch.end() && bi->in == &wi.bl) {
       // FIXME: memory alignment here is bad
-      bufferlist t;
-      std::optional<int32_t> compressor_message;
-      int r = c->compress(wi.bl, t, compressor_message);
+      bufferlist& t = bi->out;
+      std::optional<int32_t> compressor_message = bi->compressor_message;
+      int r = bi->r;
+      bool verifying = verify[bi - batch.begin()];
+      ++bi;
       uint64_t want_len_raw = wi.blob_length * crr;
       uint64_t want_len = p2roundup(want_len_raw, min_alloc_size);
       bool rejected = false;
@@ -15628,10 +16536,13 @@ int BlueStore::_do_alloc_write(
 	need += wi.blob_length;
 	data_size += wi.bl.length();
       }
-      log_latency("compress@_do_alloc_write",
-	l_bluestore_compress_lat,
-        mono_clock::now() - start,
-	cct->_conf->bluestore_log_op_age );
+      o->compression_history.note(wi.compressed);
+      coll->compression_history.note(wi.compressed);
+      if (entropy_threshold > 0) {
+	logger->inc(wi.compressed != verifying ?
+		    l_bluestore_compress_predict_hit :
+		    l_bluestore_compress_predict_miss);
+      }
     } else {
       need += wi.blob_length;
       data_size += wi.bl.length();
@@ -15640,9 +16551,13 @@ int BlueStore::_do_alloc_write(
   PExtentVector prealloc;
   prealloc.reserve(2 * wctx->writes.size());
   int64_t prealloc_left = 0;
+  int64_t hint = 0;
+  if (cct->_conf->bluestore_alloc_hint_adjacent && !wctx->writes.empty()) {
+    hint = _get_alloc_hint(o, wctx->writes.front().logical_offset);
+  }
   prealloc_left = alloc->allocate(
     need, min_alloc_size, need,
-    0, &prealloc);
+    hint, &prealloc);
   if (prealloc_left < 0 || prealloc_left < (int64_t)need) {
     derr << __func__ << " failed to allocate 0x" << std::hex << need
          << " allocated 0x " << (prealloc_left < 0 ? 0 : prealloc_left)
@@ -15790,9 +16705,18 @@ int BlueStore::_do_alloc_write(
         ceph_assert(r == 0);
 	op->data = *l;
       } else {
+	// unless zero block detection turned it into a hole, there is no
+	// point in sending a buffer of zeros over the bus
+	bool zeroes = cct->_conf->bluestore_write_zeroes_offload &&
+	  bdev->is_write_zeroes_supported() && !bdev->is_smr() &&
+	  l->is_zero();
 	wi.b->get_blob().map_bl(
 	  b_off, *l,
 	  [&](uint64_t offset, bufferlist& t) {
+	    if (zeroes && bdev->write_zeroes(offset, t.length()) == 0) {
+	      logger->inc(l_bluestore_write_zeroes_offloaded_bytes, t.length());
+	      return;
+	    }
 	    bdev->aio_write(offset, t, &txc->ioc, false);
 	  });
 	logger->inc(l_bluestore_write_new);
@@ -16642,7 +17566,7 @@ int BlueStore::_omap_setkeys(TransContext *txc,
     if (o->oid.is_pgmeta()) {
       o->onode.set_omap_flags_pgmeta();
     } else {
-      o->onode.set_omap_flags(per_pool_omap == OMAP_BULK);
+      o->onode.set_omap_flags(_use_legacy_omap());
     }
     txc->write_onode(o);
 
@@ -16687,7 +17611,7 @@ int BlueStore::_omap_setheader(TransContext *txc,
     if (o->oid.is_pgmeta()) {
       o->onode.set_omap_flags_pgmeta();
     } else {
-      o->onode.set_omap_flags(per_pool_omap == OMAP_BULK);
+      o->onode.set_omap_flags(_use_legacy_omap());
     }
     txc->write_onode(o);
 
@@ -16842,7 +17766,9 @@ int BlueStore::_clone(TransContext *txc,
     if (newo->oid.is_pgmeta()) {
       newo->onode.set_omap_flags_pgmeta();
     } else {
-      newo->onode.set_omap_flags(per_pool_omap == OMAP_BULK);
+      // while converting keep the source layout, rewrite_omap_key needs it
+      newo->onode.set_omap_flags(omap_convert_active ?
+	!oldo->onode.is_perpg_omap() : _use_legacy_omap());
     }
     // check if prefix for omap key is exactly the same size for both objects
     // otherwise rewrite_omap_key will corrupt data
@@ -18230,6 +19156,7 @@ bool RocksDBBlueFSVolumeSelector::compare(BlueFSVolumeSelector* other) {
 
 static const std::string allocator_dir    = "ALLOCATOR_NCB_DIR";
 static const std::string allocator_file   = "ALLOCATOR_NCB_FILE";
+static const std::string allocator_ckpt_key = "alloc_checkpoint"; // in PREFIX_SUPER
 static uint32_t    s_format_version = 0x01; // support future changes to allocator-map file
 static uint32_t    s_serial         = 0x01;
 
@@ -18424,6 +19351,30 @@ struct allocator_image_trailer {
 };
 WRITE_CLASS_DENC(allocator_image_trailer)
 
+// an online checkpoint: the image to load and the journal to replay on top
+struct allocator_checkpoint_t {
+  uint32_t serial = 0;          // of the image, selects the file
+  uint64_t replay_from = 0;     // first PREFIX_ALLOC_JOURNAL record to replay
+  uint64_t bdev_size = 0;
+  uint64_t min_alloc_size = 0;
+
+  DENC(allocator_checkpoint_t, v, p) {
+    DENC_START(1, 1, p);
+    denc(v.serial, p);
+    denc(v.replay_from, p);
+    denc(v.bdev_size, p);
+    denc(v.min_alloc_size, p);
+    DENC_FINISH(p);
+  }
+};
+WRITE_CLASS_DENC(allocator_checkpoint_t)
+
+// checkpoints alternate between two files so the one in use is never overwritten
+static std::string allocator_ckpt_file(uint32_t serial)
+{
+  return allocator_file + ((serial & 1) ? "_CKPT_1" : "_CKPT_0");
+}
+
 
 //-------------------------------------------------------------------------------------
 // invalidate old allocation file if exists so will go directly to recovery after failure
@@ -18536,51 +19487,16 @@ static uint32_t flush_extent_buffer_with_crc(BlueFS::FileWriter *p_handle, const
 }
 
 const unsigned MAX_EXTENTS_IN_BUFFER = 4 * 1024; // 4K extents = 64KB of data
-// write the allocator to a flat bluefs file - 4K extents at a time
 //-----------------------------------------------------------------------------------
-int BlueStore::store_allocator(Allocator* src_allocator)
+// write the extents of @allocator to @p_handle as an allocator image (header, extents, trailer)
+int BlueStore::write_allocator_image(BlueFS::FileWriter *p_handle, Allocator* allocator, uint32_t serial)
 {
-  // when storing allocations to file we must be sure there is no background compactions
-  // the easiest way to achieve it is to make sure db is closed
-  ceph_assert(db == nullptr);
-  utime_t  start_time = ceph_clock_now();
   int ret = 0;
-
-  // create dir if doesn't exist already
-  if (!bluefs->dir_exists(allocator_dir) ) {
-    ret = bluefs->mkdir(allocator_dir);
-    if (ret != 0) {
-      derr << "Failed mkdir with error-code " << ret << dendl;
-      return -1;
-    }
-  }
-  bluefs->compact_log();
-  // reuse previous file-allocation if exists
-  ret = bluefs->stat(allocator_dir, allocator_file, nullptr, nullptr);
-  bool overwrite_file = (ret == 0);
-  BlueFS::FileWriter *p_handle = nullptr;
-  ret = bluefs->open_for_write(allocator_dir, allocator_file, &p_handle, overwrite_file);
-  if (ret != 0) {
-    derr <<  __func__ << "Failed open_for_write with error-code " << ret << dendl;
-    return -1;
-  }
-
-  uint64_t file_size = p_handle->file->fnode.size;
-  uint64_t allocated = p_handle->file->fnode.get_allocated();
-  dout(10) << "file_size=" << file_size << ", allocated=" << allocated << dendl;
-
-  bluefs->sync_metadata(false);
-  unique_ptr<Allocator> allocator(clone_allocator_without_bluefs(src_allocator));
-  if (!allocator) {
-    bluefs->close_writer(p_handle);
-    return -1;
-  }
-
   // store all extents (except for the bluefs extents we removed) in a single flat file
   utime_t                 timestamp = ceph_clock_now();
   uint32_t                crc       = -1;
   {
-    allocator_image_header  header(timestamp, s_format_version, s_serial);
+    allocator_image_header  header(timestamp, s_format_version, serial);
     bufferlist              header_bl;
     encode(header, header_bl);
     crc = header_bl.crc32c(crc);
@@ -18617,7 +19533,6 @@ int BlueStore::store_allocator(Allocator* src_allocator)
     derr << "Illegal extent, fail store operation" << dendl;
     derr << "invalidate using bluefs->truncate(p_handle, 0)" << dendl;
     bluefs->truncate(p_handle, 0);
-    bluefs->close_writer(p_handle);
     return -1;
   }
 
@@ -18627,7 +19542,7 @@ int BlueStore::store_allocator(Allocator* src_allocator)
   }
 
   {
-    allocator_image_trailer trailer(timestamp, s_format_version, s_serial, extent_count, allocation_size);
+    allocator_image_trailer trailer(timestamp, s_format_version, serial, extent_count, allocation_size);
     bufferlist trailer_bl;
     encode(trailer, trailer_bl);
     uint32_t crc = -1;
@@ -18640,8 +19555,57 @@ int BlueStore::store_allocator(Allocator* src_allocator)
   bluefs->truncate(p_handle, p_handle->pos);
   bluefs->fsync(p_handle);
 
+  dout(5) <<"WRITE-extent_count=" << extent_count << ", allocation_size=" << allocation_size << ", serial=" << serial << dendl;
+  return 0;
+}
+
+// write the allocator to a flat bluefs file - 4K extents at a time
+//-----------------------------------------------------------------------------------
+int BlueStore::store_allocator(Allocator* src_allocator)
+{
+  // when storing allocations to file we must be sure there is no background compactions
+  // the easiest way to achieve it is to make sure db is closed
+  ceph_assert(db == nullptr);
+  utime_t  start_time = ceph_clock_now();
+  int ret = 0;
+
+  // create dir if doesn't exist already
+  if (!bluefs->dir_exists(allocator_dir) ) {
+    ret = bluefs->mkdir(allocator_dir);
+    if (ret != 0) {
+      derr << "Failed mkdir with error-code " << ret << dendl;
+      return -1;
+    }
+  }
+  bluefs->compact_log();
+  // reuse previous file-allocation if exists
+  ret = bluefs->stat(allocator_dir, allocator_file, nullptr, nullptr);
+  bool overwrite_file = (ret == 0);
+  BlueFS::FileWriter *p_handle = nullptr;
+  ret = bluefs->open_for_write(allocator_dir, allocator_file, &p_handle, overwrite_file);
+  if (ret != 0) {
+    derr <<  __func__ << "Failed open_for_write with error-code " << ret << dendl;
+    return -1;
+  }
+
+  uint64_t file_size = p_handle->file->fnode.size;
+  uint64_t allocated = p_handle->file->fnode.get_allocated();
+  dout(10) << "file_size=" << file_size << ", allocated=" << allocated << dendl;
+
+  bluefs->sync_metadata(false);
+  unique_ptr<Allocator> allocator(clone_allocator_without_bluefs(src_allocator));
+  if (!allocator) {
+    bluefs->close_writer(p_handle);
+    return -1;
+  }
+
+  ret = write_allocator_image(p_handle, allocator.get(), s_serial);
+  if (ret != 0) {
+    bluefs->close_writer(p_handle);
+    return -1;
+  }
+
   utime_t duration = ceph_clock_now() - start_time;
-  dout(5) <<"WRITE-extent_count=" << extent_count << ", allocation_size=" << allocation_size << ", serial=" << s_serial << dendl;
   dout(5) <<"p_handle->pos=" << p_handle->pos << " WRITE-duration=" << duration << " seconds" << dendl;
 
   bluefs->close_writer(p_handle);
@@ -18695,9 +19659,11 @@ int calc_allocator_image_trailer_size()
 }
 
 //-----------------------------------------------------------------------------------
-int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes)
+int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes,
+				   const std::string& file, uint32_t *p_serial)
 {
-  if (cct->_conf->bluestore_debug_inject_allocation_from_file_failure > 0) {
+  // injection stands for a missing allocation file, checkpoints are kept
+  if (!p_serial && cct->_conf->bluestore_debug_inject_allocation_from_file_failure > 0) {
      boost::mt11213b rng(time(NULL));
     boost::uniform_real<> ur(0, 1);
     if (ur(rng) < cct->_conf->bluestore_debug_inject_allocation_from_file_failure) {
@@ -18707,7 +19673,7 @@ int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t
   }
   utime_t start_time = ceph_clock_now();
   BlueFS::FileReader *p_temp_handle = nullptr;
-  int ret = bluefs->open_for_read(allocator_dir, allocator_file, &p_temp_handle, false);
+  int ret = bluefs->open_for_read(allocator_dir, file, &p_temp_handle, false);
   if (ret != 0) {
     dout(1) << "Failed open_for_read with error-code " << ret << dendl;
     return -1;
@@ -18754,8 +19720,12 @@ int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t
       return -1;
     }
 
-    // increment version for next store
-    s_serial = header.serial + 1;
+    if (p_serial) {
+      *p_serial = header.serial;
+    } else {
+      // increment version for next store
+      s_serial = header.serial + 1;
+    }
   }
 
   // then read the payload (extents list) using a recycled buffer
@@ -18856,7 +19826,7 @@ int BlueStore::restore_allocator(Allocator* dest_allocator, uint64_t *num, uint6
 {
   utime_t    start = ceph_clock_now();
   auto temp_allocator = unique_ptr<Allocator>(create_bitmap_allocator(bdev->get_size()));
-  int ret = __restore_allocator(temp_allocator.get(), num, bytes);
+  int ret = __restore_allocator(temp_allocator.get(), num, bytes, allocator_file);
   if (ret != 0) {
     return ret;
   }
@@ -19173,6 +20143,532 @@ int BlueStore::read_allocation_from_drive_on_startup()
   return ret;
 }
 
+//---------------------------------------------------------
+// Online checkpoints
+//
+// While mounted with bluestore_allocation_checkpoint_interval set, every
+// txc which allocates or releases space records both sets in its own kv
+// transaction under PREFIX_ALLOC_JOURNAL, keyed by a sequence assigned
+// in _txc_finalize_kv.  A checkpoint stores an allocator image (same
+// format as the allocation file) and the first journal record which has
+// to be replayed on top of it; older records are trimmed.  Replaying a
+// record marks its allocated extents used, then its released ones free,
+// so records may be applied to an image which already reflects them.
+//
+// The image must equal the committed state for every extent no record
+// from replay_from on touches.  The allocator differs from that in three
+// ways, all corrected before the image is written:
+//  - space allocated by txcs not committed yet: added as free; replay
+//    marks it used again if the txc commits (replay_from <= its seq)
+//  - committed releases not yet given to the allocator (they wait for
+//    deferred writes and discards): added as free
+//  - BlueFS extents: added as free, as in the allocation file; BlueFS
+//    takes out its own extents when it mounts
+// Txcs allocate before they get a sequence, so queue_transactions holds
+// alloc_ckpt_rwlock shared from allocation to journaling and the
+// checkpoint takes it exclusively while it copies the allocator.
+//---------------------------------------------------------
+void BlueStore::_alloc_journal_finalize(TransContext *txc, KeyValueDB::Transaction t)
+{
+  if (txc->allocated.empty() && txc->released.empty()) {
+    return;
+  }
+  bufferlist bl;
+  encode(txc->allocated, bl);
+  encode(txc->released, bl);
+  {
+    std::lock_guard l(alloc_journal_lock);
+    txc->alloc_journal_seq = ++alloc_journal_seq;
+    alloc_journal_inflight[txc->alloc_journal_seq] = txc;
+  }
+  string key;
+  _key_encode_u64(txc->alloc_journal_seq, &key);
+  t->set(PREFIX_ALLOC_JOURNAL, key, bl);
+}
+
+void BlueStore::_alloc_journal_committed(TransContext *txc)
+{
+  std::lock_guard l(alloc_journal_lock);
+  alloc_journal_inflight.erase(txc->alloc_journal_seq);
+  alloc_journal_releasing.union_of(txc->released);
+}
+
+void BlueStore::_alloc_journal_released(const interval_set<uint64_t>& released)
+{
+  std::lock_guard l(alloc_journal_lock);
+  interval_set<uint64_t> done;
+  done.intersection_of(alloc_journal_releasing, released);
+  alloc_journal_releasing.subtract(done);
+}
+
+int BlueStore::_alloc_checkpoint()
+{
+  utime_t start_time = ceph_clock_now();
+  unique_ptr<Allocator> image;
+  uint64_t replay_from = 0;
+  for (unsigned attempt = 0; attempt < 3 && !image; ++attempt) {
+    std::unique_lock wl(alloc_ckpt_rwlock);
+    interval_set<uint64_t> extra_free;
+    {
+      std::lock_guard l(alloc_journal_lock);
+      replay_from = alloc_journal_inflight.empty() ?
+	alloc_journal_seq + 1 : alloc_journal_inflight.begin()->first;
+      for (auto& [seq, txc] : alloc_journal_inflight) {
+	extra_free.union_of(txc->allocated);
+      }
+      extra_free.union_of(alloc_journal_releasing);
+    }
+    uint64_t bluefs_releases = shared_alloc.bluefs_releases;
+    image.reset(clone_allocator_without_bluefs(alloc));
+    if (!image) {
+      return -ENOMEM;
+    }
+    if (shared_alloc.bluefs_releases != bluefs_releases) {
+      // space BlueFS gave back during the copy may be neither free in the
+      // copy nor a BlueFS extent any more
+      dout(5) << "bluefs released space during copy, retrying" << dendl;
+      image.reset();
+      continue;
+    }
+    for (auto p = extra_free.begin(); p != extra_free.end(); ++p) {
+      image->init_add_free(p.get_start(), p.get_len());
+    }
+  }
+  if (!image) {
+    dout(1) << "bluefs kept releasing space, checkpoint skipped" << dendl;
+    return -EAGAIN;
+  }
+  utime_t copy_duration = ceph_clock_now() - start_time;
+
+  if (!bluefs->dir_exists(allocator_dir)) {
+    int ret = bluefs->mkdir(allocator_dir);
+    if (ret != 0) {
+      derr << "Failed mkdir with error-code " << ret << dendl;
+      return ret;
+    }
+  }
+  uint32_t serial = alloc_ckpt_serial + 1;
+  const std::string file = allocator_ckpt_file(serial);
+  bool overwrite_file = (bluefs->stat(allocator_dir, file, nullptr, nullptr) == 0);
+  BlueFS::FileWriter *p_handle = nullptr;
+  int ret = bluefs->open_for_write(allocator_dir, file, &p_handle, overwrite_file);
+  if (ret != 0) {
+    derr << "Failed open_for_write with error-code " << ret << dendl;
+    return ret;
+  }
+  ret = write_allocator_image(p_handle, image.get(), serial);
+  bluefs->close_writer(p_handle);
+  image.reset();
+  if (ret != 0) {
+    return -EIO;
+  }
+
+  // switch to the new image and drop the journal it covers at once
+  allocator_checkpoint_t ckpt;
+  ckpt.serial = serial;
+  ckpt.replay_from = replay_from;
+  ckpt.bdev_size = bdev->get_size();
+  ckpt.min_alloc_size = min_alloc_size;
+  bufferlist bl;
+  encode(ckpt, bl);
+  KeyValueDB::Transaction t = db->get_transaction();
+  t->set(PREFIX_SUPER, allocator_ckpt_key, bl);
+  if (replay_from > alloc_ckpt_replay_from) {
+    string from, to;
+    _key_encode_u64(alloc_ckpt_replay_from, &from);
+    _key_encode_u64(replay_from, &to);
+    t->rm_range_keys(PREFIX_ALLOC_JOURNAL, from, to);
+  }
+  ret = db->submit_transaction_sync(t);
+  if (ret < 0) {
+    derr << "failed to commit checkpoint: " << cpp_strerror(ret) << dendl;
+    return ret;
+  }
+  alloc_ckpt_serial = serial;
+  alloc_ckpt_replay_from = replay_from;
+  dout(5) << "checkpoint serial=" << serial << ", replay_from=" << replay_from
+	  << ", copy-duration=" << copy_duration
+	  << ", duration=" << (ceph_clock_now() - start_time) << dendl;
+  return 0;
+}
+
+void BlueStore::_alloc_ckpt_start()
+{
+  dout(10) << dendl;
+  alloc_ckpt_thread.create("bstore_allocckpt");
+}
+
+void BlueStore::_alloc_ckpt_stop()
+{
+  dout(10) << dendl;
+  {
+    std::unique_lock l{alloc_ckpt_lock};
+    while (!alloc_ckpt_started) {
+      alloc_ckpt_cond.wait(l);
+    }
+    alloc_ckpt_stop = true;
+    alloc_ckpt_cond.notify_all();
+  }
+  alloc_ckpt_thread.join();
+  {
+    std::lock_guard l{alloc_ckpt_lock};
+    alloc_ckpt_stop = false;
+  }
+  dout(10) << "done" << dendl;
+}
+
+void BlueStore::_alloc_ckpt_thread()
+{
+  dout(10) << "start" << dendl;
+  std::unique_lock l{alloc_ckpt_lock};
+  ceph_assert(!alloc_ckpt_started);
+  alloc_ckpt_started = true;
+  alloc_ckpt_cond.notify_all();
+  // the first checkpoint right away, the mount just dropped the last one
+  while (!alloc_ckpt_stop) {
+    l.unlock();
+    int r = _alloc_checkpoint();
+    if (r < 0) {
+      derr << "allocation checkpoint failed: " << cpp_strerror(r) << dendl;
+    }
+    l.lock();
+    if (alloc_ckpt_stop) {
+      break;
+    }
+    auto period = ceph::make_timespan(
+      cct->_conf->bluestore_allocation_checkpoint_interval);
+    alloc_ckpt_cond.wait_for(l, period);
+  }
+  dout(10) << "finish" << dendl;
+  alloc_ckpt_started = false;
+}
+
+// ---------------
+// online omap conversion
+
+void BlueStore::_omap_convert_start()
+{
+  ceph_assert(omap_convert_threads.empty());
+  {
+    std::shared_lock l(coll_lock);
+    for (auto& [cid, c] : coll_map) {
+      omap_convert_queue.push_back(c);
+    }
+  }
+  unsigned n = cct->_conf->bluestore_omap_online_conversion_threads;
+  dout(1) << __func__ << " converting legacy omap in "
+	  << omap_convert_queue.size() << " collections with "
+	  << n << " threads" << dendl;
+  logger->set(l_bluestore_omap_convert_pending, omap_convert_queue.size());
+  omap_convert_throttle.reset_max(
+    cct->_conf->bluestore_omap_online_conversion_bytes_per_sec);
+  omap_convert_refill = mono_clock::now() + std::chrono::seconds(1);
+  omap_convert_stop = false;
+  omap_convert_failed = false;
+  omap_convert_pass_objects = 0;
+  // from now on new omap is written per-pg, so that once all existing
+  // objects are converted no legacy omap is left behind
+  omap_convert_active = true;
+  for (unsigned i = 0; i < n; ++i) {
+    auto t = std::make_unique<OmapConvertThread>(this);
+    t->create("bstore_omapconv");
+    omap_convert_threads.push_back(std::move(t));
+  }
+}
+
+void BlueStore::_omap_convert_stop()
+{
+  if (omap_convert_threads.empty()) {
+    return;
+  }
+  dout(10) << __func__ << dendl;
+  {
+    std::lock_guard l(omap_convert_lock);
+    omap_convert_stop = true;
+    omap_convert_cond.notify_all();
+  }
+  for (auto& t : omap_convert_threads) {
+    t->join();
+  }
+  omap_convert_threads.clear();
+  omap_convert_queue.clear();
+  omap_convert_active = false;
+  dout(10) << __func__ << " done" << dendl;
+}
+
+void BlueStore::_omap_convert_thread()
+{
+  dout(10) << __func__ << " start" << dendl;
+  std::unique_lock l(omap_convert_lock);
+  while (!omap_convert_stop) {
+    if (omap_convert_queue.empty()) {
+      if (omap_convert_busy) {
+	// others may still find something; wait for the pass to end
+	omap_convert_cond.wait(l);
+	continue;
+      }
+      if (omap_convert_failed) {
+	derr << __func__ << " conversion incomplete, will retry at next mount"
+	     << dendl;
+	break;
+      }
+      if (omap_convert_pass_objects == 0) {
+	l.unlock();
+	_omap_convert_finish();
+	l.lock();
+	omap_convert_stop = true;
+	omap_convert_cond.notify_all();
+	break;
+      }
+      // clones of not yet converted objects may have been created in
+      // collections done already; make another pass
+      dout(10) << __func__ << " converted " << omap_convert_pass_objects
+	       << " objects, verifying" << dendl;
+      omap_convert_pass_objects = 0;
+      {
+	std::shared_lock cl(coll_lock);
+	for (auto& [cid, c] : coll_map) {
+	  omap_convert_queue.push_back(c);
+	}
+      }
+      logger->set(l_bluestore_omap_convert_pending, omap_convert_queue.size());
+      continue;
+    }
+    CollectionRef c = omap_convert_queue.front();
+    omap_convert_queue.pop_front();
+    logger->set(l_bluestore_omap_convert_pending, omap_convert_queue.size());
+    ++omap_convert_busy;
+    l.unlock();
+    int r = _omap_convert_collection(c);
+    l.lock();
+    --omap_convert_busy;
+    if (r < 0) {
+      omap_convert_failed = true;
+    } else {
+      omap_convert_pass_objects += r;
+    }
+    omap_convert_cond.notify_all();
+  }
+  dout(10) << __func__ << " finish" << dendl;
+}
+
+int BlueStore::_omap_convert_collection(CollectionRef& c)
+{
+  dout(10) << __func__ << " " << c->cid << dendl;
+  int converted = 0;
+  ghobject_t next;
+  while (true) {
+    vector<ghobject_t> ls;
+    {
+      std::shared_lock l(c->lock);
+      int r = _collection_list(c.get(), next, ghobject_t::get_max(), 1024,
+			       false, &ls, &next);
+      if (r == -ENOENT) {
+	// removed meanwhile
+	break;
+      }
+      if (r < 0) {
+	derr << __func__ << " " << c->cid << " listing failed: "
+	     << cpp_strerror(r) << dendl;
+	return r;
+      }
+    }
+    for (auto& oid : ls) {
+      if (oid.is_pgmeta()) {
+	continue;
+      }
+      int r = -EBUSY;
+      uint64_t bytes = 0;
+      for (unsigned retry = 0; r == -EBUSY && retry < 10; ++retry) {
+	c->flush();
+	std::unique_lock l(c->lock);
+	if (!c->exists) {
+	  return converted;
+	}
+	OnodeRef o = c->get_onode(oid, false);
+	if (!o || !o->exists ||
+	    !o->onode.has_omap() ||
+	    o->onode.is_perpg_omap() ||
+	    o->onode.is_pgmeta_omap()) {
+	  r = 0;
+	  break;
+	}
+	// new ops on the collection are blocked by the lock, but queued ones
+	// may have written legacy keys the kv store has not seen yet.  such a
+	// txc may itself wait for the lock, so back off instead of waiting.
+	if (!c->osr->is_all_kv_submitted()) {
+	  continue;
+	}
+	dout(20) << __func__ << " converting " << oid << dendl;
+	bytes = _convert_omap_to_per_pg(o);
+	r = 1;
+      }
+      if (r == -EBUSY) {
+	// busy; count it so that another pass picks it up
+	dout(10) << __func__ << " " << oid << " busy, skipping" << dendl;
+	++converted;
+	continue;
+      }
+      if (r == 0) {
+	continue;
+      }
+      ++converted;
+      logger->inc(l_bluestore_omap_convert_objects);
+      logger->inc(l_bluestore_omap_convert_bytes, bytes);
+      _omap_convert_throttle(bytes);
+      std::lock_guard l(omap_convert_lock);
+      if (omap_convert_stop) {
+	return -ECANCELED;
+      }
+    }
+    if (next.is_max()) {
+      break;
+    }
+  }
+  dout(10) << __func__ << " " << c->cid << " converted " << converted
+	   << " objects" << dendl;
+  return converted;
+}
+
+void BlueStore::_omap_convert_throttle(uint64_t bytes)
+{
+  omap_convert_throttle.take(bytes);
+  std::unique_lock l(omap_convert_lock);
+  while (!omap_convert_stop) {
+    auto now = mono_clock::now();
+    if (now >= omap_convert_refill) {
+      omap_convert_throttle.reset();
+      omap_convert_refill = now + std::chrono::seconds(1);
+    }
+    auto max = omap_convert_throttle.get_max();
+    if (max == 0 || omap_convert_throttle.get_current() < max) {
+      break;
+    }
+    omap_convert_cond.wait_until(l, omap_convert_refill);
+  }
+}
+
+void BlueStore::_omap_convert_finish()
+{
+  dout(1) << __func__ << " all omap is per-pg now" << dendl;
+  KeyValueDB::Transaction t = db->get_transaction();
+  bufferlist bl;
+  bl.append(stringify(OMAP_PER_PG));
+  t->set(PREFIX_SUPER, "per_pool_omap", bl);
+  int r = db->submit_transaction_sync(t);
+  if (r < 0) {
+    derr << __func__ << " failed to mark per-pg omap: " << cpp_strerror(r)
+	 << dendl;
+    return;
+  }
+  per_pool_omap = OMAP_PER_PG;
+  _check_no_per_pg_or_pool_omap_alert();
+}
+
+//---------------------------------------------------------
+int BlueStore::restore_allocation_checkpoint(Allocator* dest_allocator, uint64_t *num, uint64_t *bytes)
+{
+  utime_t start = ceph_clock_now();
+  bufferlist bl;
+  int ret = db->get(PREFIX_SUPER, allocator_ckpt_key, &bl);
+  if (ret < 0) {
+    dout(1) << "no allocation checkpoint" << dendl;
+    return -ENOENT;
+  }
+  allocator_checkpoint_t ckpt;
+  try {
+    auto p = bl.cbegin();
+    decode(ckpt, p);
+  } catch (ceph::buffer::error& e) {
+    derr << "failed to decode allocation checkpoint" << dendl;
+    return -EIO;
+  }
+  if (ckpt.bdev_size != bdev->get_size() || ckpt.min_alloc_size != min_alloc_size) {
+    dout(1) << "stale allocation checkpoint, bdev_size=" << ckpt.bdev_size
+	    << ", min_alloc_size=" << ckpt.min_alloc_size << dendl;
+    return -ESTALE;
+  }
+
+  auto temp_allocator = unique_ptr<Allocator>(create_bitmap_allocator(bdev->get_size()));
+  if (!temp_allocator) {
+    return -ENOMEM;
+  }
+  uint32_t serial = 0;
+  ret = __restore_allocator(temp_allocator.get(), num, bytes,
+			    allocator_ckpt_file(ckpt.serial), &serial);
+  if (ret != 0) {
+    return ret;
+  }
+  if (serial != ckpt.serial) {
+    derr << "checkpoint image serial=" << serial << " != " << ckpt.serial << dendl;
+    return -ESTALE;
+  }
+
+  SimpleBitmap sbmap(cct, (bdev->get_size() / min_alloc_size));
+  sbmap.set(0, sbmap.get_size());
+  temp_allocator->foreach([&](uint64_t offset, uint64_t length) {
+    sbmap.clr(offset >> min_alloc_size_order, length >> min_alloc_size_order);
+  });
+  temp_allocator.reset();
+
+  uint64_t record_count = 0;
+  auto it = db->get_iterator(PREFIX_ALLOC_JOURNAL, KeyValueDB::ITERATOR_NOCACHE);
+  string key;
+  _key_encode_u64(ckpt.replay_from, &key);
+  for (it->lower_bound(key); it->valid(); it->next()) {
+    interval_set<uint64_t> allocated, released;
+    bufferlist v = it->value();
+    try {
+      auto p = v.cbegin();
+      decode(allocated, p);
+      decode(released, p);
+    } catch (ceph::buffer::error& e) {
+      derr << "failed to decode journal record " << pretty_binary_string(it->key()) << dendl;
+      return -EIO;
+    }
+    for (auto q = allocated.begin(); q != allocated.end(); ++q) {
+      set_allocation_in_simple_bmap(&sbmap, q.get_start(), q.get_len());
+    }
+    for (auto q = released.begin(); q != released.end(); ++q) {
+      ceph_assert((q.get_start() & min_alloc_size_mask) == 0);
+      ceph_assert((q.get_len() & min_alloc_size_mask) == 0);
+      sbmap.clr(q.get_start() >> min_alloc_size_order, q.get_len() >> min_alloc_size_order);
+    }
+    ++record_count;
+  }
+
+  copy_simple_bitmap_to_allocator(&sbmap, dest_allocator, min_alloc_size);
+  *bytes = dest_allocator->get_free();
+  // don't overwrite the image we came from with the next checkpoint
+  alloc_ckpt_serial = ckpt.serial;
+
+  utime_t duration = ceph_clock_now() - start;
+  dout(1) << "restored checkpoint serial=" << ckpt.serial << " and replayed "
+	  << record_count << " journal records in " << duration << " seconds" << dendl;
+  return 0;
+}
+
+//---------------------------------------------------------
+int BlueStore::reset_allocation_checkpoint()
+{
+  KeyValueDB::Transaction t = db->get_transaction();
+  t->rmkey(PREFIX_SUPER, allocator_ckpt_key);
+  t->rmkeys_by_prefix(PREFIX_ALLOC_JOURNAL);
+  int ret = db->submit_transaction_sync(t);
+  if (ret < 0) {
+    derr << "failed to drop allocation checkpoint: " << cpp_strerror(ret) << dendl;
+    return ret;
+  }
+  {
+    std::lock_guard l(alloc_journal_lock);
+    alloc_journal_seq = 0;
+    alloc_journal_inflight.clear();
+    alloc_journal_releasing.clear();
+  }
+  alloc_ckpt_replay_from = 0;
+  return 0;
+}
+
 
 
 
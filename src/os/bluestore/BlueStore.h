@@ -50,6 +50,7 @@
 #include "os/ObjectStore.h"
 
 #include "bluestore_types.h"
+#include "DeferredSizeTuner.h"
 #include "BlueFS.h"
 #include "common/EventTrace.h"
 
@@ -78,6 +79,7 @@ enum {
   l_bluestore_stored,
   l_bluestore_fragmentation,
   l_bluestore_alloc_unit,
+  l_bluestore_prefer_deferred_size,
   //****************************************
 
   // Update op processing state latencies
@@ -148,6 +150,7 @@ enum {
   l_bluestore_write_big_skipped_bytes,
   l_bluestore_write_small_skipped,
   l_bluestore_write_small_skipped_bytes,
+  l_bluestore_write_zeroes_offloaded_bytes,
   //****************************************
 
   // compressions stats
@@ -159,6 +162,10 @@ enum {
   l_bluestore_decompress_lat,
   l_bluestore_compress_success_count,
   l_bluestore_compress_rejected_count,
+  l_bluestore_compress_skipped_entropy,
+  l_bluestore_compress_skipped_history,
+  l_bluestore_compress_predict_hit,
+  l_bluestore_compress_predict_miss,
   //****************************************
 
   // onode cache stats
@@ -167,6 +174,7 @@ enum {
   l_bluestore_pinned_onodes,
   l_bluestore_onode_hits,
   l_bluestore_onode_misses,
+  l_bluestore_onode_numa_remote_hits,
   l_bluestore_onode_shard_hits,
   l_bluestore_onode_shard_misses,
   l_bluestore_extents,
@@ -179,6 +187,7 @@ enum {
   l_bluestore_buffer_bytes,
   l_bluestore_buffer_hit_bytes,
   l_bluestore_buffer_miss_bytes,
+  l_bluestore_buffer_numa_remote_hit_bytes,
   //****************************************
 
   // internal stats
@@ -194,6 +203,9 @@ enum {
   l_bluestore_omap_iterator_count,
   l_bluestore_omap_rmkeys_count,
   l_bluestore_omap_rmkey_ranges_count,
+  l_bluestore_omap_convert_objects,
+  l_bluestore_omap_convert_bytes,
+  l_bluestore_omap_convert_pending,
   //****************************************
 
   // other client ops latencies
@@ -877,6 +889,7 @@ public:
     mempool::bluestore_cache_meta::vector<Shard> shards;    ///< shards
 
     ceph::buffer::list inline_bl;    ///< cached encoded map, if unsharded; empty=>dirty
+    bool inline_pending = false;     ///< inline_bl not decoded into extent_map yet
 
     uint32_t needs_reshard_begin = 0;
     uint32_t needs_reshard_end = 0;
@@ -912,6 +925,7 @@ public:
       extent_map.clear_and_dispose(DeleteDisposer());
       shards.clear();
       inline_bl.clear();
+      inline_pending = false;
       clear_needs_reshard();
     }
 
@@ -984,6 +998,9 @@ public:
     /// initialize Shards from the onode
     void init_shards(bool loaded, bool dirty);
 
+    /// decode a lazily loaded unsharded map from inline_bl
+    void fault_inline();
+
     /// return index of shard containing offset
     /// or -1 if not found
     int seek_shard(uint32_t offset) {
@@ -1178,6 +1195,35 @@ public:
   struct OnodeSpace;
   struct OnodeCacheShard;
   /// an in-memory object
+  /// recent compression outcomes for the writes of an object or collection
+  struct CompressionHistory {
+    /// after this many skipped blobs one is compressed again anyway
+    static constexpr uint16_t PROBE_INTERVAL = 16;
+
+    uint16_t rejected = 0;  ///< consecutive blobs not worth compressing
+    uint16_t skipped = 0;   ///< blobs skipped since then
+
+    /// false once @threshold blobs in a row were rejected, but for a probe
+    bool should_try(unsigned threshold) {
+      if (!threshold || rejected < threshold) {
+	return true;
+      }
+      if (++skipped < PROBE_INTERVAL) {
+	return false;
+      }
+      skipped = 0;
+      return true;
+    }
+    void note(bool kept) {
+      if (kept) {
+	rejected = 0;
+      } else if (rejected < UINT16_MAX) {
+	++rejected;
+      }
+      skipped = 0;
+    }
+  };
+
   struct Onode {
     MEMPOOL_CLASS_HELPERS();
 
@@ -1206,6 +1252,7 @@ public:
     ceph::mutex flush_lock = ceph::make_mutex("BlueStore::Onode::flush_lock");
     ceph::condition_variable flush_cond;   ///< wait here for uncommitted txns
     std::shared_ptr<int64_t> cache_age_bin;  ///< cache age bin
+    CompressionHistory compression_history;  ///< in memory only
 
     Onode(Collection *c, const ghobject_t& o,
 	  const mempool::bluestore_cache_meta::string& k)
@@ -1251,7 +1298,8 @@ public:
     static void decode_raw(
       BlueStore::Onode* on,
       const bufferlist& v,
-      ExtentMap::ExtentDecoder& dencoder);
+      ExtentMap::ExtentDecoder& dencoder,
+      bool lazy_inline = false);
 
     static Onode* create_decode(
       CollectionRef c,
@@ -1330,6 +1378,8 @@ private:
     std::atomic<uint64_t> max = {0};
     std::atomic<uint64_t> num = {0};
     boost::circular_buffer<std::shared_ptr<int64_t>> age_bins;
+    /// numa node of the threads expected to use this shard, -1 if unknown
+    std::atomic<int> numa_node = {-1};
 
     CacheShard(CephContext* cct) : cct(cct), logger(nullptr), age_bins(1) {
       shift_bins();
@@ -1519,10 +1569,15 @@ private:
     pool_opts_t pool_opts;
     ContextQueue *commit_queue;
 
+    /// the objects of a PG tend to hold the same kind of data
+    CompressionHistory compression_history;
+
     OnodeCacheShard* get_onode_cache() const {
       return onode_space.cache;
     }
     OnodeRef get_onode(const ghobject_t& oid, bool create, bool is_createop=false);
+    /// load and cache the existing onodes among @oids in one batched lookup
+    void prefetch_onodes(const Transaction::id_view<ghobject_t>& oids);
 
     // the terminology is confusing here, sorry!
     //
@@ -1797,6 +1852,7 @@ private:
     bool had_ios = false;  ///< true if we submitted IOs before our kv txn
 
     uint64_t seq = 0;
+    uint64_t alloc_journal_seq = 0;  ///< allocation journal record, if any
     ceph::mono_clock::time_point start;
     ceph::mono_clock::time_point last_stamp;
 
@@ -2078,6 +2134,11 @@ private:
       return false;
     }
 
+    bool is_all_kv_submitted() {
+      std::lock_guard l(qlock);
+      return q.empty() || _is_all_kv_submitted();
+    }
+
     void flush() {
       std::unique_lock l(qlock);
       while (true) {
@@ -2164,6 +2225,24 @@ private:
       return NULL;
     }
   };
+  /// an additional kv_finalize thread completing committed txcs of the
+  /// OpSequencers hashed to it.  shard 0 is kv_finalize_thread, which also
+  /// keeps deferred cleanup and the other housekeeping.
+  struct KVFinalizeShard : public Thread {
+    BlueStore *store;
+    ceph::mutex lock = ceph::make_mutex("BlueStore::KVFinalizeShard::lock");
+    ceph::condition_variable cond;
+    std::deque<TransContext*> committing_to_finalize; ///< pending finalization
+    bool started = false;
+    bool stop = false;
+    bool in_progress = false;
+
+    explicit KVFinalizeShard(BlueStore *s) : store(s) {}
+    void *entry() override {
+      store->_kv_finalize_shard_thread(this);
+      return NULL;
+    }
+  };
 
 #ifdef HAVE_LIBZBD
   struct ZonedCleanerThread : public Thread {
@@ -2175,6 +2254,24 @@ private:
     }
   };
 #endif
+
+  struct AllocCheckpointThread : public Thread {
+    BlueStore *store;
+    explicit AllocCheckpointThread(BlueStore *s) : store(s) {}
+    void *entry() override {
+      store->_alloc_ckpt_thread();
+      return nullptr;
+    }
+  };
+
+  struct OmapConvertThread : public Thread {
+    BlueStore *store;
+    explicit OmapConvertThread(BlueStore *s) : store(s) {}
+    void *entry() override {
+      store->_omap_convert_thread();
+      return nullptr;
+    }
+  };
   
   struct BigDeferredWriteContext {
     uint64_t off = 0;     // original logical offset
@@ -2248,7 +2345,11 @@ private:
   deferred_osr_queue_t deferred_queue; ///< osr's with deferred io pending
   std::atomic_int deferred_queue_size = {0};         ///< num txc's queued across all osrs
   std::atomic_int deferred_aggressive = {0}; ///< aggressive wakeup of kv thread
-  Finisher  finisher;
+  FinisherPool finisher;  ///< completes callbacks, ordered per OpSequencer
+  Finisher  read_finisher;   ///< completes read_async() after aio
+  ceph::mutex async_read_lock = ceph::make_mutex("BlueStore::async_read_lock");
+  ceph::condition_variable async_read_cond;
+  uint64_t async_reads_in_flight = 0;  ///< protected by async_read_lock
   utime_t  deferred_last_submitted = utime_t();
 
   KVSyncThread kv_sync_thread;
@@ -2271,6 +2372,7 @@ private:
   std::deque<TransContext*> kv_committing_to_finalize;   ///< pending finalization
   std::deque<DeferredBatch*> deferred_stable_to_finalize; ///< pending finalization
   bool kv_finalize_in_progress = false;
+  std::vector<std::unique_ptr<KVFinalizeShard>> kv_finalize_shards;
 
 #ifdef HAVE_LIBZBD
   ZonedCleanerThread zoned_cleaner_thread;
@@ -2281,6 +2383,45 @@ private:
   std::deque<uint64_t> zoned_cleaner_queue;
 #endif
 
+  // online checkpoints of the allocation map (null freelist manager only).
+  // every txc changing allocations journals them under PREFIX_ALLOC_JOURNAL;
+  // after a crash the last checkpoint plus the journal since then is loaded
+  // instead of recovering from all onodes.
+  AllocCheckpointThread alloc_ckpt_thread;
+  ceph::mutex alloc_ckpt_lock = ceph::make_mutex("BlueStore::alloc_ckpt_lock");
+  ceph::condition_variable alloc_ckpt_cond;
+  bool alloc_ckpt_started = false;
+  bool alloc_ckpt_stop = false;
+  uint32_t alloc_ckpt_serial = 0;      ///< serial of the last checkpoint
+  uint64_t alloc_ckpt_replay_from = 0; ///< journal needed by the last checkpoint
+  /// held shared from allocation to _txc_finalize_kv, exclusive to checkpoint
+  ceph::shared_mutex alloc_ckpt_rwlock =
+    ceph::make_shared_mutex("BlueStore::alloc_ckpt_rwlock");
+  bool alloc_journal_enabled = false;
+  ceph::mutex alloc_journal_lock =
+    ceph::make_mutex("BlueStore::alloc_journal_lock");
+  uint64_t alloc_journal_seq = 0;      ///< last journal record written
+  /// journaled txcs which have not committed yet
+  std::map<uint64_t, TransContext*> alloc_journal_inflight;
+  /// committed releases which have not reached the allocator yet
+  interval_set<uint64_t> alloc_journal_releasing;
+
+  // background conversion of legacy omap to per-pg omap.  collections are
+  // handed out to the threads from omap_convert_queue; once a pass over all
+  // of them converts nothing the store is marked OMAP_PER_PG.
+  std::vector<std::unique_ptr<OmapConvertThread>> omap_convert_threads;
+  ceph::mutex omap_convert_lock = ceph::make_mutex("BlueStore::omap_convert_lock");
+  ceph::condition_variable omap_convert_cond;
+  bool omap_convert_stop = false;
+  std::deque<CollectionRef> omap_convert_queue;
+  unsigned omap_convert_busy = 0;           ///< threads converting a collection
+  uint64_t omap_convert_pass_objects = 0;   ///< converted during this pass
+  bool omap_convert_failed = false;
+  /// new omap is written per-pg while a conversion is running
+  std::atomic<bool> omap_convert_active = {false};
+  Throttle omap_convert_throttle;           ///< bytes in the current second
+  ceph::mono_clock::time_point omap_convert_refill;
+
   PerfCounters *logger = nullptr;
 
   std::list<CollectionRef> removed_collections;
@@ -2323,6 +2464,11 @@ private:
 
   ///< size threshold for forced deferred writes
   std::atomic<uint64_t> prefer_deferred_size = {0};
+  DeferredSizeTuner deferred_tuner;  ///< adapts prefer_deferred_size at runtime
+  ceph::mono_clock::time_point deferred_tuner_last_adjust;
+
+  class SocketHook;
+  SocketHook* asok_hook = nullptr;
 
   ///< approx cost per io, in bytes
   std::atomic<uint64_t> throttle_cost_per_io = {0};
@@ -2332,6 +2478,8 @@ private:
   CompressorRef compressor;
   std::atomic<uint64_t> comp_min_blob_size = {0};
   std::atomic<uint64_t> comp_max_blob_size = {0};
+  /// blobs not compressed because of their sampled entropy
+  std::atomic<uint64_t> comp_entropy_skips = {0};
 
   std::atomic<uint64_t> max_blob_size = {0};  ///< maximum blob size
 
@@ -2377,6 +2525,8 @@ private:
     std::shared_ptr<PriorityCache::PriCache> binned_kv_cache = nullptr;
     std::shared_ptr<PriorityCache::PriCache> binned_kv_onode_cache = nullptr;
     std::shared_ptr<PriorityCache::Manager> pcm = nullptr;
+    /// caches of the store's user, see register_priority_cache()
+    std::map<std::string, std::shared_ptr<PriorityCache::PriCache>> user_caches;
 
     struct MempoolCache : public PriorityCache::PriCache {
       BlueStore *store;
@@ -2593,6 +2743,14 @@ private:
       lock.unlock();
       join();
     }
+    void add_user_cache(const std::string& name,
+			std::shared_ptr<PriorityCache::PriCache> c) {
+      std::lock_guard l{lock};
+      user_caches[name] = c;
+      if (pcm != nullptr) {
+	pcm->insert(name, c, true);
+      }
+    }
 
   private:
     void _update_cache_settings();
@@ -2618,6 +2776,7 @@ private:
   int _write_fsid();
   void _close_fsid();
   void _set_alloc_sizes();
+  void _maybe_tune_deferred_size();
   void _set_blob_size();
   void _set_finisher_num();
   void _set_per_pool_omap();
@@ -2742,6 +2901,8 @@ private:
   void _kv_stop();
   void _kv_sync_thread();
   void _kv_finalize_thread();
+  void _kv_finalize_shard_thread(KVFinalizeShard *shard);
+  void _kv_finalize_dispatch(std::deque<TransContext*>& kv_committing);
 
 #ifdef HAVE_LIBZBD
   void _zoned_cleaner_start();
@@ -2753,6 +2914,26 @@ private:
   void _clean_some(ghobject_t oid, uint32_t zone_num);
 #endif
 
+  void _alloc_journal_finalize(TransContext *txc, KeyValueDB::Transaction t);
+  void _alloc_journal_committed(TransContext *txc);
+  void _alloc_journal_released(const interval_set<uint64_t>& released);
+  int _alloc_checkpoint();
+  void _alloc_ckpt_start();
+  void _alloc_ckpt_stop();
+  void _alloc_ckpt_thread();
+
+  bool _use_legacy_omap() const {
+    return per_pool_omap == OMAP_BULK && !omap_convert_active;
+  }
+  uint64_t _convert_omap_to_per_pg(OnodeRef& o);
+  void _omap_convert_start();
+  void _omap_convert_stop();
+  void _omap_convert_thread();
+  /// returns the number of objects converted or left over for another pass
+  int _omap_convert_collection(CollectionRef& c);
+  void _omap_convert_throttle(uint64_t bytes);
+  void _omap_convert_finish();
+
   bluestore_deferred_op_t *_get_deferred_op(TransContext *txc, uint64_t len);
   void _deferred_queue(TransContext *txc);
 public:
@@ -2928,6 +3109,13 @@ public:
   }
 
   void set_cache_shards(unsigned num) override;
+  void set_cache_shard_numa_node(unsigned shard, int node) override;
+  bool register_priority_cache(
+    const std::string& name,
+    std::shared_ptr<PriorityCache::PriCache> cache) override {
+    mempool_thread.add_user_cache(name, cache);
+    return cache_autotune;
+  }
   void dump_cache_stats(ceph::Formatter *f) override {
     int onode_count = 0, buffers_bytes = 0;
     for (auto i: onode_cache_shards) {
@@ -3009,6 +3197,23 @@ public:
     ceph::buffer::list& bl,
     uint32_t op_flags = 0) override;
 
+  void read_async(
+    CollectionHandle &c,
+    const ghobject_t& oid,
+    uint64_t offset,
+    size_t len,
+    ceph::buffer::list *bl,
+    Context *on_complete,
+    uint32_t op_flags = 0) override;
+
+  int read_digest(
+    CollectionHandle &c,
+    const ghobject_t& oid,
+    uint64_t offset,
+    size_t len,
+    uint32_t *crc,
+    uint32_t op_flags = 0) override;
+
 private:
 
   // --------------------------------------------------------
@@ -3072,6 +3277,17 @@ private:
     std::vector<ceph::buffer::list>* compressed_blob_bls,
     IOContext* ioc);
 
+  /// clamp the range to the object, fault in its extents and split it
+  /// into cached data and blob reads; false if there is nothing to read
+  bool _read_setup(
+    OnodeRef& o,
+    uint64_t offset,
+    size_t& length,
+    uint32_t op_flags,
+    bool* buffered,
+    ready_regions_t& ready_regions,
+    blobs2read_t& blobs2read);
+
   int _generate_read_result_bl(
     OnodeRef& o,
     uint64_t offset,
@@ -3092,6 +3308,15 @@ private:
     uint32_t op_flags = 0,
     uint64_t retry_count = 0);
 
+  int _do_read_digest(
+    Collection *c,
+    OnodeRef& o,
+    uint64_t offset,
+    size_t len,
+    uint32_t *crc,
+    uint32_t op_flags = 0,
+    uint64_t retry_count = 0);
+
   int _do_readv(
     Collection *c,
     OnodeRef& o,
@@ -3100,6 +3325,36 @@ private:
     uint32_t op_flags = 0,
     uint64_t retry_count = 0);
 
+  /// state of a read_async() while its aios are in flight
+  struct AsyncRead : public AioContext {
+    CollectionRef c;
+    ghobject_t oid;
+    OnodeRef o;
+    uint64_t offset;
+    size_t length;
+    uint32_t op_flags;
+    bool buffered = false;
+    bool have_data = false;
+    ceph::buffer::list *bl;
+    Context *on_complete;
+    mono_clock::time_point start;
+    ready_regions_t ready_regions;
+    blobs2read_t blobs2read;
+    std::vector<ceph::buffer::list> compressed_blob_bls;
+    IOContext ioc;
+
+    AsyncRead(CephContext *cct, Collection *c, const ghobject_t& oid,
+	      uint64_t offset, size_t length, uint32_t op_flags,
+	      ceph::buffer::list *bl, Context *on_complete)
+      : c(c), oid(oid), offset(offset), length(length), op_flags(op_flags),
+	bl(bl), on_complete(on_complete), start(mono_clock::now()),
+	ioc(cct, this, !cct->_conf->bluestore_fail_eio) {}
+
+    void aio_finish(BlueStore *store) override;
+  };
+  /// generate the result of @rd, free it and call its completion
+  void _finish_async_read(AsyncRead *rd, int r);
+
   int _fiemap(CollectionHandle &c_, const ghobject_t& oid,
 	      uint64_t offset, size_t len, interval_set<uint64_t>& destset);
 public:
@@ -3495,6 +3750,8 @@ private:
     CollectionRef c,
     OnodeRef& o,
     WriteContext *wctx);
+  /// physical offset following the data the object has before @offset
+  uint64_t _get_alloc_hint(OnodeRef& o, uint64_t offset);
   void _wctx_finish(
     TransContext *txc,
     CollectionRef& c,
@@ -3726,6 +3983,8 @@ public:
     mempool::bluestore_fsck::list<std::string>* expecting_shards,
     std::map<BlobRef, bluestore_blob_t::unused_t>* referenced,
     const BlueStore::FSCK_ObjectCtx& ctx);
+  /// read all of an object's data, returns the number of errors hit
+  int64_t fsck_deep_read(CollectionRef c, OnodeRef o);
 #ifdef CEPH_BLUESTORE_TOOL_RESTORE_ALLOCATION
   int  push_allocation_to_rocksdb();
   int  read_allocation_from_drive_for_bluestore_tool();
@@ -3817,10 +4076,14 @@ private:
 				      uint64_t  *p_extent_count, const void *v_header, BlueFS::FileReader *p_handle, uint64_t offset);
 
   int  copy_allocator(Allocator* src_alloc, Allocator *dest_alloc, uint64_t* p_num_entries);
+  int  write_allocator_image(BlueFS::FileWriter *p_handle, Allocator* allocator, uint32_t serial);
   int  store_allocator(Allocator* allocator);
   int  invalidate_allocation_file_on_bluefs();
-  int  __restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes);
+  int  __restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes,
+			   const std::string& file, uint32_t *p_serial = nullptr);
   int  restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes);
+  int  restore_allocation_checkpoint(Allocator* allocator, uint64_t *num, uint64_t *bytes);
+  int  reset_allocation_checkpoint();
   int  read_allocation_from_drive_on_startup();
   int  reconstruct_allocations(SimpleBitmap *smbmp, read_alloc_stats_t &stats);
   int  read_allocation_from_onodes(SimpleBitmap *smbmp, read_alloc_stats_t& stats);
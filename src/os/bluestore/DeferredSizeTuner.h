@@ -0,0 +1,136 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+#include "include/ceph_assert.h"
+#include "common/Formatter.h"
+
+/**
+ * DeferredSizeTuner
+ *
+ * Learns where bluestore_prefer_deferred_size should sit for the device at
+ * hand.  Writes somewhat below the threshold go through the deferred (WAL)
+ * path, writes somewhat above it are written directly; both could have
+ * taken the other path, so comparing their tail commit latency tells which
+ * way to move the threshold.  Samples are collected lock-free into log2
+ * latency histograms and consumed by adjust(), which moves the threshold
+ * by a factor of two per call.
+ */
+class DeferredSizeTuner {
+public:
+  static constexpr size_t NUM_BUCKETS = 32;  ///< log2(usec) buckets
+  static constexpr double HYSTERESIS = 0.1;  ///< required relative difference
+
+  struct Window {
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets = {};
+
+    void add(uint64_t usec) {
+      size_t b = std::min<size_t>(std::bit_width(usec), NUM_BUCKETS - 1);
+      buckets[b].fetch_add(1, std::memory_order_relaxed);
+    }
+    /// move the samples out, leaving the window empty
+    std::array<uint64_t, NUM_BUCKETS> drain() {
+      std::array<uint64_t, NUM_BUCKETS> r;
+      for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+	r[i] = buckets[i].exchange(0, std::memory_order_relaxed);
+      }
+      return r;
+    }
+  };
+
+  /// upper latency bound (usec) of the bucket holding the given quantile
+  static uint64_t quantile(const std::array<uint64_t, NUM_BUCKETS>& h,
+			   uint64_t count, double q) {
+    uint64_t want = count * q, seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+      seen += h[i];
+      if (seen > want) {
+	return (1ull << i) - 1;
+      }
+    }
+    return (1ull << (NUM_BUCKETS - 1)) - 1;
+  }
+
+  /// account for a committed transaction of @bytes written under @threshold
+  void note(uint64_t threshold, uint64_t bytes, bool deferred, uint64_t usec) {
+    // only writes which might as well have taken the other path count
+    if (bytes == 0 || bytes < threshold / 2 || bytes > threshold * 2) {
+      return;
+    }
+    (deferred ? deferred_window : direct_window).add(usec);
+  }
+
+  /**
+   * consume the collected samples and return the threshold to use next,
+   * clamped to [min_size, max_size].  the threshold is left alone until
+   * both paths have seen at least @min_samples writes.
+   */
+  uint64_t adjust(uint64_t threshold, uint64_t min_size, uint64_t max_size,
+		  uint64_t min_samples, double q = 0.99) {
+    ceph_assert(min_size > 0 && min_size <= max_size);
+    uint64_t next = std::clamp(threshold, min_size, max_size);
+    if (next != threshold) {
+      // bounds changed or first run; drop samples taken under the old value
+      direct_window.drain();
+      deferred_window.drain();
+      return next;
+    }
+    auto direct = direct_window.drain();
+    auto deferred = deferred_window.drain();
+    uint64_t ndirect = 0, ndeferred = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+      ndirect += direct[i];
+      ndeferred += deferred[i];
+    }
+    if (ndirect < min_samples || ndeferred < min_samples) {
+      // accumulate further; put the samples back
+      for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+	direct_window.buckets[i].fetch_add(direct[i], std::memory_order_relaxed);
+	deferred_window.buckets[i].fetch_add(deferred[i], std::memory_order_relaxed);
+      }
+      return threshold;
+    }
+    last_direct_lat = quantile(direct, ndirect, q);
+    last_deferred_lat = quantile(deferred, ndeferred, q);
+    if (last_direct_lat > last_deferred_lat * (1.0 + HYSTERESIS)) {
+      // direct writes just above the threshold lag behind: defer more
+      next = std::min(threshold * 2, max_size);
+    } else if (last_deferred_lat > last_direct_lat * (1.0 + HYSTERESIS)) {
+      // the WAL is the bottleneck: write more directly
+      next = std::max(threshold / 2, min_size);
+    }
+    ++rounds;
+    if (next != threshold) {
+      ++changes;
+    }
+    return next;
+  }
+
+  void dump(ceph::Formatter *f) const {
+    f->dump_unsigned("rounds", rounds);
+    f->dump_unsigned("changes", changes);
+    f->dump_unsigned("last_direct_lat_usec", last_direct_lat);
+    f->dump_unsigned("last_deferred_lat_usec", last_deferred_lat);
+  }
+
+private:
+  Window direct_window, deferred_window;
+  uint64_t last_direct_lat = 0, last_deferred_lat = 0;
+  uint64_t rounds = 0, changes = 0;
+};
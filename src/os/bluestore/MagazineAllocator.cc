@@ -0,0 +1,251 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "MagazineAllocator.h"
+
+#include <sched.h>
+
+#include "common/debug.h"
+
+#define dout_context cct
+#define dout_subsys ceph_subsys_bluestore
+#undef  dout_prefix
+#define dout_prefix *_dout << "MagazineAllocator "
+
+MagazineAllocator* MagazineAllocator::create(
+  CephContext* cct,
+  std::string_view backend_type,
+  int64_t size,
+  int64_t block_size,
+  unsigned shards,
+  unsigned max_units,
+  unsigned depth,
+  std::string_view name)
+{
+  // construct the front end first so that it owns the admin socket
+  // commands for this name; the backend's registration then collides
+  // and is disabled, and dumps include the cached extents
+  auto a = new MagazineAllocator(cct, size, block_size, shards, max_units,
+				 depth, name);
+  a->backend.reset(Allocator::create(cct, backend_type, size, block_size,
+				     0, 0, a->get_name()));
+  if (!a->backend) {
+    delete a;
+    return nullptr;
+  }
+  return a;
+}
+
+MagazineAllocator::MagazineAllocator(
+  CephContext* cct,
+  int64_t size,
+  int64_t block_size,
+  unsigned shards,
+  unsigned max_units,
+  unsigned depth,
+  std::string_view name)
+  : Allocator(name, size, block_size),
+    cct(cct),
+    max_units(std::max(max_units, 1u)),
+    depth(std::max(depth, 1u)),
+    shards(std::max(shards, 1u))
+{
+  for (auto& s : this->shards) {
+    s.mags.resize(this->max_units);
+  }
+  ldout(cct, 10) << __func__ << " shards " << this->shards.size()
+		 << " max_units " << this->max_units
+		 << " depth " << this->depth << dendl;
+}
+
+MagazineAllocator::~MagazineAllocator()
+{
+}
+
+MagazineAllocator::Shard& MagazineAllocator::_get_shard()
+{
+  int cpu = sched_getcpu();
+  if (cpu < 0) {
+    cpu = 0;
+  }
+  return shards[cpu % shards.size()];
+}
+
+void MagazineAllocator::_put(Shard& s, uint64_t offset, uint64_t length,
+			     interval_set<uint64_t>* spill)
+{
+  uint64_t units = length / block_size;
+  if (length % block_size != 0 || units == 0 || units > max_units) {
+    spill->insert(offset, length);
+    return;
+  }
+  auto& mag = s.mags[units - 1];
+  if (mag.size() >= depth) {
+    // full; hand the older half back to the backend in one go
+    size_t n = std::max<size_t>(depth / 2, 1);
+    for (size_t i = 0; i < n; ++i) {
+      spill->insert(mag[i], length);
+    }
+    mag.erase(mag.begin(), mag.begin() + n);
+    cached_bytes -= n * length;
+  }
+  mag.push_back(offset);
+  cached_bytes += length;
+}
+
+int64_t MagazineAllocator::allocate(
+  uint64_t want_size,
+  uint64_t unit,
+  uint64_t max_alloc_size,
+  int64_t hint,
+  PExtentVector *extents)
+{
+  uint64_t units = want_size / block_size;
+  if (hint != 0 ||
+      unit != (uint64_t)block_size ||
+      want_size % block_size != 0 ||
+      units == 0 || units > max_units ||
+      (max_alloc_size && max_alloc_size < want_size)) {
+    return backend->allocate(want_size, unit, max_alloc_size, hint, extents);
+  }
+
+  auto& s = _get_shard();
+  {
+    std::lock_guard l(s.lock);
+    auto& mag = s.mags[units - 1];
+    if (!mag.empty()) {
+      extents->emplace_back(mag.back(), want_size);
+      mag.pop_back();
+      cached_bytes -= want_size;
+      return want_size;
+    }
+  }
+
+  // miss; refill with a batch of same-sized extents, keep what we don't use
+  PExtentVector batch;
+  int64_t got = backend->allocate(want_size * (depth / 2 + 1), unit,
+				  want_size, 0, &batch);
+  uint64_t need = want_size;
+  if (got > 0) {
+    interval_set<uint64_t> spill;
+    {
+      std::lock_guard l(s.lock);
+      for (auto& e : batch) {
+	uint64_t offset = e.offset;
+	uint64_t length = e.length;
+	if (need) {
+	  uint64_t l = std::min(length, need);
+	  extents->emplace_back(offset, l);
+	  need -= l;
+	  offset += l;
+	  length -= l;
+	}
+	if (length) {
+	  _put(s, offset, length, &spill);
+	}
+      }
+    }
+    if (!spill.empty()) {
+      backend->release(spill);
+    }
+  }
+  if (need) {
+    // the backend is short of space; other shards may be holding some
+    flush();
+    int64_t r = backend->allocate(need, unit, max_alloc_size, hint, extents);
+    if (r > 0) {
+      need -= r;
+    }
+  }
+  if (need == want_size) {
+    return -ENOSPC;
+  }
+  return want_size - need;
+}
+
+void MagazineAllocator::release(const interval_set<uint64_t>& release_set)
+{
+  interval_set<uint64_t> spill;
+  auto& s = _get_shard();
+  {
+    std::lock_guard l(s.lock);
+    for (auto p = release_set.begin(); p != release_set.end(); ++p) {
+      _put(s, p.get_start(), p.get_len(), &spill);
+    }
+  }
+  if (!spill.empty()) {
+    backend->release(spill);
+  }
+}
+
+void MagazineAllocator::flush()
+{
+  interval_set<uint64_t> spill;
+  for (auto& s : shards) {
+    std::lock_guard l(s.lock);
+    for (size_t i = 0; i < s.mags.size(); ++i) {
+      uint64_t length = (i + 1) * block_size;
+      for (auto offset : s.mags[i]) {
+	spill.insert(offset, length);
+      }
+      cached_bytes -= s.mags[i].size() * length;
+      s.mags[i].clear();
+    }
+  }
+  if (!spill.empty()) {
+    backend->release(spill);
+  }
+}
+
+void MagazineAllocator::dump()
+{
+  ldout(cct, 0) << __func__ << " cached 0x" << std::hex << get_cached()
+		<< std::dec << " in " << shards.size() << " shards" << dendl;
+  backend->dump();
+}
+
+void MagazineAllocator::foreach(
+  std::function<void(uint64_t offset, uint64_t length)> notify)
+{
+  std::vector<std::pair<uint64_t, uint64_t>> cached;
+  for (auto& s : shards) {
+    std::lock_guard l(s.lock);
+    for (size_t i = 0; i < s.mags.size(); ++i) {
+      for (auto offset : s.mags[i]) {
+	cached.emplace_back(offset, (i + 1) * block_size);
+      }
+    }
+  }
+  for (auto& [offset, length] : cached) {
+    notify(offset, length);
+  }
+  backend->foreach(notify);
+}
+
+void MagazineAllocator::init_add_free(uint64_t offset, uint64_t length)
+{
+  backend->init_add_free(offset, length);
+}
+
+void MagazineAllocator::init_rm_free(uint64_t offset, uint64_t length)
+{
+  // the range may be cached
+  flush();
+  backend->init_rm_free(offset, length);
+}
+
+uint64_t MagazineAllocator::get_free()
+{
+  return backend->get_free() + get_cached();
+}
+
+double MagazineAllocator::get_fragmentation()
+{
+  return backend->get_fragmentation();
+}
+
+void MagazineAllocator::shutdown()
+{
+  flush();
+  backend->shutdown();
+}
@@ -0,0 +1,110 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "Allocator.h"
+#include "include/spinlock.h"
+
+/**
+ * MagazineAllocator
+ *
+ * Front end for another allocator which keeps small per-CPU caches
+ * ("magazines") of recently released extents, one per extent size up to
+ * max_units * block_size.  Allocations of exactly such a size are served
+ * from the local magazine without touching the backend and its mutex;
+ * misses refill the magazine with a batch from the backend, and a full
+ * magazine returns half of its contents to the backend in one release.
+ *
+ * Cached extents are free space: they are counted by get_free() and
+ * reported by foreach().  Hints and unit != block_size requests bypass
+ * the cache.
+ */
+class MagazineAllocator : public Allocator {
+public:
+  /// returns nullptr if the backend type is unknown
+  static MagazineAllocator* create(
+    CephContext* cct,
+    std::string_view backend_type,
+    int64_t size,
+    int64_t block_size,
+    unsigned shards,
+    unsigned max_units,
+    unsigned depth,
+    std::string_view name = "");
+  ~MagazineAllocator() override;
+
+  const char* get_type() const override {
+    return backend->get_type();
+  }
+
+  int64_t allocate(
+    uint64_t want_size,
+    uint64_t unit,
+    uint64_t max_alloc_size,
+    int64_t hint,
+    PExtentVector *extents) override;
+  void release(const interval_set<uint64_t>& release_set) override;
+  using Allocator::release;
+
+  void dump() override;
+  void foreach(
+    std::function<void(uint64_t offset, uint64_t length)> notify) override;
+
+  void init_add_free(uint64_t offset, uint64_t length) override;
+  void init_rm_free(uint64_t offset, uint64_t length) override;
+
+  uint64_t get_free() override;
+  double get_fragmentation() override;
+  void shutdown() override;
+
+  Allocator* get_backend() {
+    return backend.get();
+  }
+  uint64_t get_cached() const {
+    return cached_bytes.load(std::memory_order_relaxed);
+  }
+  /// return all cached extents to the backend
+  void flush();
+
+private:
+  MagazineAllocator(
+    CephContext* cct,
+    int64_t size,
+    int64_t block_size,
+    unsigned shards,
+    unsigned max_units,
+    unsigned depth,
+    std::string_view name);
+
+  struct alignas(64) Shard {
+    ceph::spinlock lock;
+    /// mags[i] holds offsets of free extents of (i + 1) * block_size bytes
+    std::vector<std::vector<uint64_t>> mags;
+  };
+
+  CephContext* cct;
+  std::unique_ptr<Allocator> backend;
+  const unsigned max_units;
+  const unsigned depth;
+  std::vector<Shard> shards;
+  std::atomic<uint64_t> cached_bytes = {0};
+
+  Shard& _get_shard();
+  /// cache [offset, offset+length) in @s if there is room, else add to @spill
+  void _put(Shard& s, uint64_t offset, uint64_t length,
+	    interval_set<uint64_t>* spill);
+};
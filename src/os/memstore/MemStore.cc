@@ -1109,11 +1109,10 @@ int MemStore::_remove(const coll_t& cid, const ghobject_t& oid)
     return -ENOENT;
   std::lock_guard l{c->lock};
 
-  auto i = c->object_hash.find(oid);
-  if (i == c->object_hash.end())
+  ObjectRef o = c->object_hash.erase(oid);
+  if (!o)
     return -ENOENT;
-  used_bytes -= i->second->get_size();
-  c->object_hash.erase(i);
+  used_bytes -= o->get_size();
   c->object_map.erase(oid);
 
   return 0;
@@ -1370,11 +1369,11 @@ int MemStore::_collection_add(const coll_t& cid, const coll_t& ocid, const ghobj
 
   if (c->object_hash.count(oid))
     return -EEXIST;
-  if (oc->object_hash.count(oid) == 0)
+  ObjectRef o = oc->object_hash.find(oid);
+  if (!o)
     return -ENOENT;
-  ObjectRef o = oc->object_hash[oid];
   c->object_map[oid] = o;
-  c->object_hash[oid] = o;
+  c->object_hash.set(oid, o);
   return 0;
 }
 
@@ -1396,15 +1395,13 @@ int MemStore::_collection_move_rename(const coll_t& oldcid, const ghobject_t& ol
   std::lock_guard l{c->lock};
   if (c->object_hash.count(oid))
     return -EEXIST;
-  if (oc->object_hash.count(oldoid) == 0)
+  ObjectRef o = oc->object_hash.find(oldoid);
+  if (!o)
     return -ENOENT;
-  {
-    ObjectRef o = oc->object_hash[oldoid];
-    c->object_map[oid] = o;
-    c->object_hash[oid] = o;
-    oc->object_map.erase(oldoid);
-    oc->object_hash.erase(oldoid);
-  }
+  c->object_map[oid] = o;
+  c->object_hash.set(oid, o);
+  oc->object_map.erase(oldoid);
+  oc->object_hash.erase(oldoid);
   return 0;
 }
 
@@ -1428,7 +1425,7 @@ int MemStore::_split_collection(const coll_t& cid, uint32_t bits, uint32_t match
     if (p->first.match(bits, match)) {
       dout(20) << " moving " << p->first << dendl;
       dc->object_map.insert(std::make_pair(p->first, p->second));
-      dc->object_hash.insert(std::make_pair(p->first, p->second));
+      dc->object_hash.insert(p->first, p->second);
       sc->object_hash.erase(p->first);
       sc->object_map.erase(p++);
     } else {
@@ -1460,7 +1457,7 @@ int MemStore::_merge_collection(const coll_t& cid, uint32_t bits, coll_t dest)
     while (p != sc->object_map.end()) {
       dout(20) << " moving " << p->first << dendl;
       dc->object_map.insert(std::make_pair(p->first, p->second));
-      dc->object_hash.insert(std::make_pair(p->first, p->second));
+      dc->object_hash.insert(p->first, p->second);
       sc->object_hash.erase(p->first);
       sc->object_map.erase(p++);
     }
@@ -1615,7 +1612,8 @@ struct MemStore::PageSetObject : public Object {
 
 private:
   FRIEND_MAKE_REF(PageSetObject);
-  explicit PageSetObject(size_t page_size) : data(page_size), data_len(0) {}
+  PageSetObject(size_t page_size, HugePageAllocator *allocator)
+    : data(page_size, allocator), data_len(0) {}
 };
 
 #if defined(__GLIBCXX__)
@@ -1819,6 +1817,7 @@ int MemStore::PageSetObject::truncate(uint64_t size)
 
 MemStore::ObjectRef MemStore::Collection::create_object() const {
   if (use_page_set)
-    return ceph::make_ref<PageSetObject>(cct->_conf->memstore_page_size);
+    return ceph::make_ref<PageSetObject>(cct->_conf->memstore_page_size,
+					 page_allocator);
   return make_ref<BufferlistObject>();
 }
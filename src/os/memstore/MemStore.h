@@ -16,6 +16,7 @@
 #ifndef CEPH_MEMSTORE_H
 #define CEPH_MEMSTORE_H
 
+#include <array>
 #include <atomic>
 #include <mutex>
 #include <boost/intrusive_ptr.hpp>
@@ -88,15 +89,63 @@ public:
   };
   using ObjectRef = Object::Ref;
 
+  /// object lookup table, split into independently locked shards so that
+  /// concurrent ops on one collection don't all contend for a single lock
+  class ObjectHash {
+    static constexpr unsigned NUM_SHARDS = 16;
+    struct alignas(64) Shard {
+      ceph::shared_mutex lock{
+	ceph::make_shared_mutex("MemStore::ObjectHash::lock", true, false)};
+      ceph::unordered_map<ghobject_t, ObjectRef> objects;
+    };
+    std::array<Shard, NUM_SHARDS> shards;
+
+    Shard& shard_of(const ghobject_t& oid) {
+      return shards[std::hash<ghobject_t>()(oid) % NUM_SHARDS];
+    }
+  public:
+    ObjectRef find(const ghobject_t& oid) {
+      auto& s = shard_of(oid);
+      std::shared_lock l{s.lock};
+      auto p = s.objects.find(oid);
+      return p == s.objects.end() ? ObjectRef() : p->second;
+    }
+    bool count(const ghobject_t& oid) {
+      return (bool)find(oid);
+    }
+    /// add @o unless @oid is present; return the object now mapped
+    ObjectRef insert(const ghobject_t& oid, ObjectRef o) {
+      auto& s = shard_of(oid);
+      std::lock_guard l{s.lock};
+      return s.objects.emplace(oid, std::move(o)).first->second;
+    }
+    void set(const ghobject_t& oid, ObjectRef o) {
+      auto& s = shard_of(oid);
+      std::lock_guard l{s.lock};
+      s.objects[oid] = std::move(o);
+    }
+    ObjectRef erase(const ghobject_t& oid) {
+      auto& s = shard_of(oid);
+      std::lock_guard l{s.lock};
+      auto p = s.objects.find(oid);
+      if (p == s.objects.end())
+	return ObjectRef();
+      ObjectRef o = std::move(p->second);
+      s.objects.erase(p);
+      return o;
+    }
+  };
+
   struct PageSetObject;
   struct Collection : public CollectionImpl {
     int bits = 0;
     CephContext *cct;
     bool use_page_set;
-    ceph::unordered_map<ghobject_t, ObjectRef> object_hash;  ///< for lookup
+    HugePageAllocator *page_allocator = nullptr;
+    ObjectHash object_hash;                            ///< for lookup
     std::map<ghobject_t, ObjectRef> object_map;        ///< for iteration
     std::map<std::string,ceph::buffer::ptr> xattr;
-    /// for object_{map,hash}
+    /// for object_map, and for changes to object_hash to stay in sync with it
     ceph::shared_mutex lock{
       ceph::make_shared_mutex("MemStore::Collection::lock", true, false)};
 
@@ -111,22 +160,20 @@ public:
     // NOTE: The lock only needs to protect the object_map/hash, not the
     // contents of individual objects.  The osd is already sequencing
     // reads and writes, so we will never see them concurrently at this
-    // level.
+    // level.  Lookups only take the lock of their object_hash shard.
 
-    ObjectRef get_object(ghobject_t oid) {
-      std::shared_lock l{lock};
-      auto o = object_hash.find(oid);
-      if (o == object_hash.end())
-	return ObjectRef();
-      return o->second;
+    ObjectRef get_object(const ghobject_t& oid) {
+      return object_hash.find(oid);
     }
 
-    ObjectRef get_or_create_object(ghobject_t oid) {
+    ObjectRef get_or_create_object(const ghobject_t& oid) {
+      if (auto o = object_hash.find(oid); o) {
+	return o;
+      }
       std::lock_guard l{lock};
-      auto result = object_hash.emplace(oid, ObjectRef());
-      if (result.second)
-        object_map[oid] = result.first->second = create_object();
-      return result.first->second;
+      auto o = object_hash.insert(oid, create_object());
+      object_map.emplace(oid, o);
+      return o;
     }
 
     void encode(ceph::buffer::list& bl) const {
@@ -153,7 +200,7 @@ public:
 	auto o = create_object();
 	o->decode(p);
 	object_map.insert(std::make_pair(k, o));
-	object_hash.insert(std::make_pair(k, o));
+	object_hash.insert(k, o);
       }
       DECODE_FINISH(p);
     }
@@ -178,7 +225,11 @@ public:
     explicit Collection(CephContext *cct, coll_t c)
       : CollectionImpl(cct, c),
 	cct(cct),
-	use_page_set(cct->_conf->memstore_page_set) {}
+	use_page_set(cct->_conf->memstore_page_set) {
+      if (use_page_set && cct->_conf->memstore_page_set_hugepages) {
+	page_allocator = &HugePageAllocator::get(cct->_conf->memstore_page_size);
+      }
+    }
   };
   typedef Collection::Ref CollectionRef;
 
@@ -16,19 +16,105 @@
 #define CEPH_PAGESET_H
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cassert>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <thread>
 #include <vector>
+#include <sys/mman.h>
 #include <boost/intrusive/avl_set.hpp>
 #include <boost/intrusive_ptr.hpp>
 
 #include "include/encoding.h"
 
+// Hands out page data buffers carved from 2MB huge pages, so that a large
+// in-memory store is not limited by TLB misses.  Regions come from
+// MAP_HUGETLB if the system has huge pages reserved, and are otherwise
+// aligned and advised for transparent huge pages.  Freed buffers are kept
+// on per-shard free lists for reuse; regions are never returned to the
+// system.
+class HugePageAllocator {
+ public:
+  static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+
+  // one allocator per page size, shared by all users of that size
+  static HugePageAllocator& get(size_t page_size) {
+    static std::mutex lock;
+    static std::map<size_t, std::unique_ptr<HugePageAllocator>> allocators;
+    std::lock_guard<std::mutex> l(lock);
+    auto& a = allocators[page_size];
+    if (!a)
+      a.reset(new HugePageAllocator(page_size));
+    return *a;
+  }
+
+  char *allocate() {
+    auto& mine = my_shard();
+    for (unsigned i = 0; i < NUM_SHARDS; i++) {
+      auto& s = shards[(&mine - shards.data() + i) % NUM_SHARDS];
+      std::lock_guard<std::mutex> l(s.lock);
+      if (!s.free.empty()) {
+        char *p = s.free.back();
+        s.free.pop_back();
+        return p;
+      }
+    }
+    // all empty; map a new region, keep the first buffer and put the
+    // rest on our free list
+    char *region = map_region();
+    std::lock_guard<std::mutex> l(mine.lock);
+    for (size_t off = region_size - page_size; off > 0; off -= page_size)
+      mine.free.push_back(region + off);
+    return region;
+  }
+  size_t get_page_size() const { return page_size; }
+
+  void release(char *p) {
+    auto& s = my_shard();
+    std::lock_guard<std::mutex> l(s.lock);
+    s.free.push_back(p);
+  }
+
+ private:
+  static constexpr unsigned NUM_SHARDS = 16;
+  struct alignas(64) Shard {
+    std::mutex lock;
+    std::vector<char*> free;
+  };
+  const size_t page_size;
+  const size_t region_size;
+  std::array<Shard, NUM_SHARDS> shards;
+
+  explicit HugePageAllocator(size_t page_size)
+    : page_size(page_size),
+      region_size(std::max(page_size, HUGE_PAGE_SIZE)) {}
+
+  Shard& my_shard() {
+    return shards[std::hash<std::thread::id>()(std::this_thread::get_id()) %
+                  NUM_SHARDS];
+  }
+  char *map_region() {
+    void *p = ::mmap(nullptr, region_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED)
+      return static_cast<char*>(p);
+    if (::posix_memalign(&p, HUGE_PAGE_SIZE, region_size) != 0)
+      throw std::bad_alloc();
+    ::madvise(p, region_size, MADV_HUGEPAGE);
+    return static_cast<char*>(p);
+  }
+};
+
 struct Page {
   char *const data;
   boost::intrusive::avl_set_member_hook<> hook;
   uint64_t offset;
+  // where data came from, or nullptr if it shares this Page's allocation
+  HugePageAllocator *const allocator;
 
   // avoid RefCountedObject because it has a virtual destructor
   std::atomic<uint16_t> nrefs;
@@ -62,7 +148,12 @@ struct Page {
     decode(offset, p);
   }
 
-  static Ref create(size_t page_size, uint64_t offset = 0) {
+  static Ref create(size_t page_size, uint64_t offset = 0,
+                    HugePageAllocator *allocator = nullptr) {
+    if (allocator) {
+      auto buffer = new char[sizeof(Page)];
+      return new (buffer) Page(allocator->allocate(), offset, allocator);
+    }
     // ensure proper alignment of the Page
     const auto align = alignof(Page);
     page_size = (page_size + align - 1) & ~(align - 1);
@@ -77,10 +168,17 @@ struct Page {
   const Page& operator=(const Page&) = delete;
 
  private: // private constructor, use create() instead
-  Page(char *data, uint64_t offset) : data(data), offset(offset), nrefs(1) {}
+  Page(char *data, uint64_t offset, HugePageAllocator *allocator = nullptr)
+    : data(data), offset(offset), allocator(allocator), nrefs(1) {}
 
   static void operator delete(void *p) {
-    delete[] reinterpret_cast<Page*>(p)->data;
+    auto page = reinterpret_cast<Page*>(p);
+    if (page->allocator) {
+      page->allocator->release(page->data);
+      delete[] reinterpret_cast<char*>(p);
+    } else {
+      delete[] page->data;
+    }
   }
 };
 
@@ -102,6 +200,7 @@ class PageSet {
 
   page_set pages;
   uint64_t page_size;
+  HugePageAllocator *allocator;
 
   typedef std::mutex lock_type;
   lock_type mutex;
@@ -129,9 +228,11 @@ class PageSet {
   }
 
  public:
-  explicit PageSet(size_t page_size) : page_size(page_size) {}
+  explicit PageSet(size_t page_size, HugePageAllocator *allocator = nullptr)
+    : page_size(page_size), allocator(allocator) {}
   PageSet(PageSet &&rhs)
-    : pages(std::move(rhs.pages)), page_size(rhs.page_size) {}
+    : pages(std::move(rhs.pages)), page_size(rhs.page_size),
+      allocator(rhs.allocator) {}
   ~PageSet() {
     free_pages(pages.begin(), pages.end());
   }
@@ -161,7 +262,7 @@ class PageSet {
       typename page_set::insert_commit_data commit;
       auto insert = pages.insert_check(cur, page_offset, page_cmp(), commit);
       if (insert.second) {
-        auto page = Page::create(page_size, page_offset);
+        auto page = Page::create(page_size, page_offset, allocator);
         cur = pages.insert_commit(*page, commit);
 
         // assume that the caller will write to the range [offset,length),
@@ -218,11 +319,13 @@ class PageSet {
     using ceph::decode;
     ceph_assert(empty());
     decode(page_size, p);
+    if (allocator && allocator->get_page_size() != page_size)
+      allocator = nullptr;  // saved with a different page size
     unsigned count;
     decode(count, p);
     auto cur = pages.end();
     for (unsigned i = 0; i < count; i++) {
-      auto page = Page::create(page_size);
+      auto page = Page::create(page_size, 0, allocator);
       page->decode(p, page_size);
       cur = pages.insert_before(cur, *page);
     }
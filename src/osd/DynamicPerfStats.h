@@ -4,7 +4,8 @@
 #ifndef DYNAMIC_PERF_STATS_H
 #define DYNAMIC_PERF_STATS_H
 
-#include "include/random.h"
+#include <algorithm>
+
 #include "messages/MOSDOp.h"
 #include "mgr/OSDPerfMetricTypes.h"
 #include "osd/OSD.h"
@@ -15,7 +16,9 @@ public:
   DynamicPerfStats() {
   }
 
-  DynamicPerfStats(const std::list<OSDPerfMetricQuery> &queries) {
+  DynamicPerfStats(const std::list<OSDPerfMetricQuery> &queries,
+                   size_t max_keys = 0)
+    : max_keys(max_keys) {
     for (auto &query : queries) {
       data[query];
     }
@@ -38,9 +41,15 @@ public:
         ceph_assert(key_it.second.size() >= data[query][key].size());
         query.update_counters(update_counter_fnc, &data[query][key]);
       }
+      trim(&data[query]);
     }
   }
 
+  /// keep only about the max_keys heaviest keys per query, 0 for all
+  void set_max_keys(size_t n) {
+    max_keys = n;
+  }
+
   void set_queries(const std::list<OSDPerfMetricQuery> &queries) {
     std::map<OSDPerfMetricQuery,
              std::map<OSDPerfMetricKey, PerformanceCounters>> new_data;
@@ -164,6 +173,7 @@ public:
       OSDPerfMetricKey key;
       if (query.get_key(get_subkey_fnc, &key)) {
         query.update_counters(update_counter_fnc, &it.second[key]);
+        trim(&it.second);
       }
     }
   }
@@ -207,31 +217,23 @@ public:
           continue;
         }
 
-        // Weighted Random Sampling (Algorithm A-Chao):
-        // Select the first [0, max_count) samples, randomly replace
-        // with samples from [max_count, end) using weighted
-        // probability, and return [0, max_count) as the result.
-
+        // Report the heaviest max_count keys by this counter.
         ceph_assert(limit.max_count < counters.size());
         typedef std::map<OSDPerfMetricKey, PerformanceCounters>::iterator
             Iterator;
         std::vector<Iterator> counter_iterators;
-        counter_iterators.reserve(limit.max_count);
-
-        Iterator it_counters = counters.begin();
-        uint64_t wsum = 0;
-        for (size_t i = 0; i < limit.max_count; i++) {
-          wsum += it_counters->second[index].first;
-          counter_iterators.push_back(it_counters++);
-        }
-        for (; it_counters != counters.end(); it_counters++) {
-          wsum += it_counters->second[index].first;
-          if (ceph::util::generate_random_number(0, wsum) <=
-              it_counters->second[index].first) {
-            auto i = ceph::util::generate_random_number(0, limit.max_count - 1);
-            counter_iterators[i] = it_counters;
-          }
+        counter_iterators.reserve(counters.size());
+        for (auto i = counters.begin(); i != counters.end(); ++i) {
+          counter_iterators.push_back(i);
         }
+        std::nth_element(counter_iterators.begin(),
+                         counter_iterators.begin() + limit.max_count,
+                         counter_iterators.end(),
+                         [index](const Iterator &a, const Iterator &b) {
+                           return a->second[index].first >
+                             b->second[index].first;
+                         });
+        counter_iterators.resize(limit.max_count);
 
         for (auto it_counters : counter_iterators) {
           auto &bl =
@@ -245,6 +247,35 @@ public:
   }
 
 private:
+  /*
+   * Bound the keys tracked for a query.  Once there are twice max_keys of
+   * them, drop all but the max_keys heaviest by the query's first counter;
+   * a key that matters keeps accumulating and survives, while the long
+   * tail of keys seen a few times does not pile up.
+   */
+  void trim(std::map<OSDPerfMetricKey, PerformanceCounters> *counters) {
+    if (max_keys == 0 || counters->size() <= 2 * max_keys) {
+      return;
+    }
+    typedef std::map<OSDPerfMetricKey, PerformanceCounters>::iterator
+        Iterator;
+    std::vector<Iterator> its;
+    its.reserve(counters->size());
+    for (auto i = counters->begin(); i != counters->end(); ++i) {
+      its.push_back(i);
+    }
+    auto weight = [](const Iterator &i) {
+      return i->second.empty() ? 0 : i->second[0].first;
+    };
+    std::nth_element(its.begin(), its.begin() + max_keys, its.end(),
+                     [&weight](const Iterator &a, const Iterator &b) {
+                       return weight(a) > weight(b);
+                     });
+    for (auto i = its.begin() + max_keys; i != its.end(); ++i) {
+      counters->erase(*i);
+    }
+  }
+
   static bool is_limited(const OSDPerfMetricLimits &limits,
                          size_t counters_size) {
     if (limits.empty()) {
@@ -262,6 +293,7 @@ private:
 
   std::map<OSDPerfMetricQuery,
            std::map<OSDPerfMetricKey, PerformanceCounters>> data;
+  size_t max_keys = 0;
 };
 
 #endif // DYNAMIC_PERF_STATS_H
@@ -108,10 +108,16 @@ static ostream &operator<<(
 
 ostream &operator<<(ostream &lhs, const ECBackend::read_request_t &rhs)
 {
-  return lhs << "read_request_t(to_read=[" << rhs.to_read << "]"
+  lhs << "read_request_t(to_read=[" << rhs.to_read << "]"
 	     << ", need=" << rhs.need
 	     << ", want_attrs=" << rhs.want_attrs
-	     << ")";
+	     << (rhs.direct ? ", direct" : "");
+  if (!rhs.chains.empty()) {
+    lhs << ", chains=" << rhs.chains
+	<< ", repair_shard=" << rhs.repair_shard
+	<< ", repair_helpers=" << rhs.repair_helpers;
+  }
+  return lhs << ")";
 }
 
 ostream &operator<<(ostream &lhs, const ECBackend::read_result_t &rhs)
@@ -123,6 +129,9 @@ ostream &operator<<(ostream &lhs, const ECBackend::read_result_t &rhs)
   } else {
     lhs << ", noattrs";
   }
+  if (!rhs.partial.empty()) {
+    lhs << ", partial=" << rhs.partial;
+  }
   return lhs << ", returned=" << rhs.returned << ")";
 }
 
@@ -175,8 +184,19 @@ ostream &operator<<(ostream &lhs, const ECBackend::Op &rhs)
       << " pending_apply=" << rhs.pending_apply
       << " pending_commit=" << rhs.pending_commit
       << " plan.to_read=" << rhs.plan.to_read
-      << " plan.will_write=" << rhs.plan.will_write
-      << ")";
+      << " plan.will_write=" << rhs.plan.will_write;
+  if (!rhs.plan.parity_delta.empty()) {
+    lhs << " plan.parity_delta=[";
+    for (auto p = rhs.plan.parity_delta.begin();
+	 p != rhs.plan.parity_delta.end();
+	 ++p) {
+      if (p != rhs.plan.parity_delta.begin())
+	lhs << ",";
+      lhs << p->first << ":" << p->second.stripes << "/" << p->second.shards;
+    }
+    lhs << "] delta_reads_pending=" << rhs.delta_reads_pending;
+  }
+  lhs << ")";
   return lhs;
 }
 
@@ -193,6 +213,8 @@ ostream &operator<<(ostream &lhs, const ECBackend::RecoveryOp &rhs)
 	     << " state=" << ECBackend::RecoveryOp::tostr(rhs.state)
 	     << " waiting_on_pushes=" << rhs.waiting_on_pushes
 	     << " extent_requested=" << rhs.extent_requested
+	     << " repair_bytes=" << rhs.repair_bytes_read
+	     << "/" << rhs.repair_bytes_full
 	     << ")";
 }
 
@@ -207,6 +229,8 @@ void ECBackend::RecoveryOp::dump(Formatter *f) const
   f->dump_stream("state") << tostr(state);
   f->dump_stream("waiting_on_pushes") << waiting_on_pushes;
   f->dump_stream("extent_requested") << extent_requested;
+  f->dump_unsigned("repair_bytes_read", repair_bytes_read);
+  f->dump_unsigned("repair_bytes_full", repair_bytes_full);
 }
 
 ECBackend::ECBackend(
@@ -265,6 +289,7 @@ struct OnRecoveryReadComplete :
       hoid,
       res.returned.back(),
       res.attrs,
+      res.partial,
       in.first);
   }
 };
@@ -278,12 +303,15 @@ struct RecoveryMessages {
     const hobject_t &hoid, uint64_t off, uint64_t len,
     set<int> &&_want_to_read,
     const map<pg_shard_t, vector<pair<int, int>>> &need,
-    bool attrs) {
+    bool attrs,
+    map<pg_shard_t, vector<pg_shard_t>> &&chains = {},
+    set<int> &&helpers = {}) {
     list<boost::tuple<uint64_t, uint64_t, uint32_t> > to_read;
     to_read.push_back(boost::make_tuple(off, len, 0));
     ceph_assert(!reads.count(hoid));
+    int lost = chains.empty() ? -1 : *_want_to_read.begin();
     want_to_read.insert(make_pair(hoid, std::move(_want_to_read)));
-    reads.insert(
+    auto &req = reads.insert(
       make_pair(
 	hoid,
 	ECBackend::read_request_t(
@@ -292,7 +320,12 @@ struct RecoveryMessages {
 	  attrs,
 	  new OnRecoveryReadComplete(
 	    ec,
-	    hoid))));
+	    hoid)))).first->second;
+    if (!chains.empty()) {
+      req.chains = std::move(chains);
+      req.repair_shard = lost;
+      req.repair_helpers = std::move(helpers);
+    }
   }
 
   map<pg_shard_t, vector<PushOp> > pushes;
@@ -313,10 +346,13 @@ void ECBackend::handle_recovery_push(
   }
 
   bool oneshot = op.before_progress.first && op.after_progress.data_complete;
+  // a partial push patches the stripes we lack into our older version
+  bool partial = !op.recovery_info.copy_subset.empty();
+  ghobject_t obj(op.soid, ghobject_t::NO_GEN,
+		 get_parent()->whoami_shard().shard);
   ghobject_t tobj;
   if (oneshot) {
-    tobj = ghobject_t(op.soid, ghobject_t::NO_GEN,
-		      get_parent()->whoami_shard().shard);
+    tobj = obj;
   } else {
     tobj = ghobject_t(get_parent()->get_temp_recovery_object(op.soid,
 							     op.version),
@@ -330,8 +366,17 @@ void ECBackend::handle_recovery_push(
   }
 
   if (op.before_progress.first) {
-    m->t.remove(coll, tobj);
-    m->t.touch(coll, tobj);
+    if (partial) {
+      if (!oneshot) {
+	m->t.remove(coll, tobj);
+	m->t.clone(coll, obj, tobj);
+      }
+      // replaced with the new attrs below
+      m->t.rmattrs(coll, tobj);
+    } else {
+      m->t.remove(coll, tobj);
+      m->t.touch(coll, tobj);
+    }
   }
 
   if (!op.data_included.empty()) {
@@ -349,7 +394,16 @@ void ECBackend::handle_recovery_push(
     ceph_assert(op.data.length() == 0);
   }
 
-  if (get_parent()->pg_is_remote_backfilling()) {
+  if (partial && op.after_progress.data_complete) {
+    // drop whatever the object was truncated by since
+    m->t.truncate(
+      coll,
+      tobj,
+      sinfo.aligned_logical_offset_to_chunk_offset(
+	sinfo.logical_to_next_stripe_offset(op.recovery_info.size)));
+  }
+
+  if (get_parent()->pg_is_remote_backfilling() && !partial) {
     get_parent()->pg_add_local_num_bytes(op.data.length());
     get_parent()->pg_add_num_bytes(op.data.length() * get_ec_data_chunk_count());
     dout(10) << __func__ << " " << op.soid
@@ -370,12 +424,8 @@ void ECBackend::handle_recovery_push(
     dout(10) << __func__ << ": Removing oid "
 	     << tobj.hobj << " from the temp collection" << dendl;
     clear_temp_obj(tobj.hobj);
-    m->t.remove(coll, ghobject_t(
-	op.soid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard));
-    m->t.collection_move_rename(
-      coll, tobj,
-      coll, ghobject_t(
-	op.soid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard));
+    m->t.remove(coll, obj);
+    m->t.collection_move_rename(coll, tobj, coll, obj);
   }
   if (op.after_progress.data_complete) {
     if ((get_parent()->pgb_is_primary())) {
@@ -399,7 +449,7 @@ void ECBackend::handle_recovery_push(
 	ObjectContextRef(),
 	false,
 	&m->t);
-      if (get_parent()->pg_is_remote_backfilling()) {
+      if (get_parent()->pg_is_remote_backfilling() && !partial) {
         struct stat st;
         int r = store->stat(ch, ghobject_t(op.soid, ghobject_t::NO_GEN,
                             get_parent()->whoami_shard().shard), &st);
@@ -436,6 +486,7 @@ void ECBackend::handle_recovery_read_complete(
   const hobject_t &hoid,
   boost::tuple<uint64_t, uint64_t, map<pg_shard_t, bufferlist> > &to_read,
   std::optional<map<string, bufferlist, less<>> > attrs,
+  const map<pg_shard_t, set<int>> &partial,
   RecoveryMessages *m)
 {
   dout(10) << __func__ << ": returned " << hoid << " "
@@ -454,12 +505,58 @@ void ECBackend::handle_recovery_read_complete(
     target[*i] = &(op.returned_data[*i]);
   }
   map<int, bufferlist> from;
-  for(map<pg_shard_t, bufferlist>::iterator i = to_read.get<2>().begin();
-      i != to_read.get<2>().end();
-      ++i) {
-    from[i->first.shard] = std::move(i->second);
-  }
-  dout(10) << __func__ << ": " << from << dendl;
+  uint64_t read_bytes = 0;
+  if (partial.empty()) {
+    for(map<pg_shard_t, bufferlist>::iterator i = to_read.get<2>().begin();
+	i != to_read.get<2>().end();
+	++i) {
+      from[i->first.shard] = std::move(i->second);
+    }
+    dout(10) << __func__ << ": " << from << dendl;
+    for (auto &&i : from) {
+      read_bytes += i.second.length();
+    }
+  } else {
+    // the heads of the chains returned their chain's share of the lost
+    // chunk, add the share of the shards read directly
+    ceph_assert(op.missing_on_shards.size() == 1);
+    int lost = *op.missing_on_shards.begin();
+    set<int> helpers;
+    map<int, bufferlist> direct;
+    list<bufferlist> shares;
+    for (auto &&[shard, bl] : to_read.get<2>()) {
+      read_bytes += bl.length();
+      auto p = partial.find(shard);
+      if (p == partial.end()) {
+	helpers.insert(shard.shard);
+	direct[shard.shard] = std::move(bl);
+      } else {
+	helpers.insert(p->second.begin(), p->second.end());
+	shares.push_back(std::move(bl));
+      }
+    }
+    dout(10) << __func__ << ": shares of " << partial
+	     << " and direct " << direct << dendl;
+    bufferlist repaired;
+    if (!direct.empty()) {
+      int r = ec_impl->partial_decode(lost, helpers, direct, &repaired);
+      ceph_assert(r == 0);
+    } else {
+      repaired = std::move(shares.front());
+      shares.pop_front();
+    }
+    for (auto &&bl : shares) {
+      int r = ec_impl->combine_partial_decode(bl, &repaired);
+      ceph_assert(r == 0);
+    }
+    from[lost] = std::move(repaired);
+  }
+  uint64_t full_bytes = ec_impl->get_data_chunk_count() *
+    sinfo.logical_to_next_chunk_offset(to_read.get<1>());
+  op.repair_bytes_read += read_bytes;
+  op.repair_bytes_full += full_bytes;
+  get_parent()->get_logger()->inc(l_osd_ec_repair_rbytes, read_bytes);
+  get_parent()->get_logger()->inc(l_osd_ec_repair_full_rbytes, full_bytes);
   int r;
   r = ECUtil::decode(sinfo, ec_impl, from, target);
   ceph_assert(r == 0);
@@ -600,8 +697,24 @@ void ECBackend::continue_recovery_op(
       op.state = RecoveryOp::READING;
       ceph_assert(!op.recovery_progress.data_complete);
       set<int> want(op.missing_on_shards.begin(), op.missing_on_shards.end());
+
+      if (op.recovery_progress.first) {
+	get_partial_recovery_extents(op);
+      }
       uint64_t from = op.recovery_progress.data_recovered_to;
       uint64_t amount = get_recovery_chunk_size();
+      if (op.is_partial()) {
+	// skip ahead to the next stripes the missing shards lack
+	for (auto p = op.recovery_info.copy_subset.begin();
+	     p != op.recovery_info.copy_subset.end();
+	     ++p) {
+	  if (p.get_start() + p.get_len() > from) {
+	    from = std::max(from, p.get_start());
+	    amount = std::min(amount, p.get_start() + p.get_len() - from);
+	    break;
+	  }
+	}
+      }
 
       if (op.recovery_progress.first && op.obc) {
 	/* We've got the attrs and the hinfo, might as well use them */
@@ -632,14 +745,19 @@ void ECBackend::continue_recovery_op(
 	recovery_ops.erase(op.hoid);
 	return;
       }
+      map<pg_shard_t, vector<pg_shard_t>> chains;
+      set<int> helpers;
+      plan_chained_repair(want, &to_read, &chains, &helpers);
       m->read(
 	this,
 	op.hoid,
-	op.recovery_progress.data_recovered_to,
+	from,
 	amount,
 	std::move(want),
 	to_read,
-	op.recovery_progress.first && !op.obc);
+	op.recovery_progress.first && !op.obc,
+	std::move(chains),
+	std::move(helpers));
       op.extent_requested = make_pair(
 	from,
 	amount);
@@ -652,9 +770,20 @@ void ECBackend::continue_recovery_op(
       ceph_assert(op.returned_data.size());
       op.state = RecoveryOp::WRITING;
       ObjectRecoveryProgress after_progress = op.recovery_progress;
-      after_progress.data_recovered_to += op.extent_requested.second;
+      const uint64_t from = op.extent_requested.first;
+      const uint64_t to = std::min(
+	from + op.extent_requested.second,
+	sinfo.logical_to_next_stripe_offset(op.obc->obs.oi.size));
+      after_progress.data_recovered_to = to;
       after_progress.first = false;
-      if (after_progress.data_recovered_to >= op.obc->obs.oi.size) {
+      if (op.is_partial() &&
+	  op.recovery_info.copy_subset.range_end() <= to) {
+	after_progress.data_recovered_to =
+	  sinfo.logical_to_next_stripe_offset(
+	    op.obc->obs.oi.size);
+	after_progress.data_complete = true;
+      } else if (!op.is_partial() &&
+		 after_progress.data_recovered_to >= op.obc->obs.oi.size) {
 	after_progress.data_recovered_to =
 	  sinfo.logical_to_next_stripe_offset(
 	    op.obc->obs.oi.size);
@@ -675,14 +804,11 @@ void ECBackend::continue_recovery_op(
 		 << ", size=" << op.obc->obs.oi.size << dendl;
 	ceph_assert(
 	  pop.data.length() ==
-	  sinfo.aligned_logical_offset_to_chunk_offset(
-	    after_progress.data_recovered_to -
-	    op.recovery_progress.data_recovered_to)
+	  sinfo.aligned_logical_offset_to_chunk_offset(to - from)
 	  );
 	if (pop.data.length())
 	  pop.data_included.insert(
-	    sinfo.aligned_logical_offset_to_chunk_offset(
-	      op.recovery_progress.data_recovered_to),
+	    sinfo.aligned_logical_offset_to_chunk_offset(from),
 	    pop.data.length()
 	    );
 	if (op.recovery_progress.first) {
@@ -745,6 +871,44 @@ void ECBackend::continue_recovery_op(
   }
 }
 
+void ECBackend::get_partial_recovery_extents(RecoveryOp &op)
+{
+  op.recovery_info.copy_subset.clear();
+  if (!cct->_conf->osd_ec_partial_recovery ||
+      !get_parent()->get_pool().allows_ecoverwrites() ||
+      get_osdmap()->require_osd_release < ceph_release_t::reef ||
+      !op.obc) {
+    return;
+  }
+  // every missing shard must hold an older version of the object to
+  // patch; the stripes written since are those to recover
+  interval_set<uint64_t> dirty;
+  for (auto &shard : op.missing_on) {
+    auto &missing = get_parent()->get_shard_missing(shard).get_items();
+    auto p = missing.find(op.hoid);
+    if (p == missing.end() ||
+	!p->second.clean_regions.object_is_exist()) {
+      return;
+    }
+    dirty.union_of(p->second.clean_regions.get_dirty_regions());
+  }
+  const uint64_t size = sinfo.logical_to_next_stripe_offset(
+    op.obc->obs.oi.size);
+  for (auto p = dirty.begin(); p != dirty.end() && p.get_start() < size; ++p) {
+    uint64_t start = sinfo.logical_to_prev_stripe_offset(p.get_start());
+    uint64_t end = sinfo.logical_to_next_stripe_offset(
+      std::min(p.get_start() + p.get_len(), size));
+    op.recovery_info.copy_subset.union_insert(start, end - start);
+  }
+  if (op.recovery_info.copy_subset.size() >= size) {
+    // nothing to gain
+    op.recovery_info.copy_subset.clear();
+  }
+  dout(10) << __func__ << ": " << op.hoid << " recovering "
+	   << op.recovery_info.copy_subset << " of 0x" << std::hex << size
+	   << std::dec << dendl;
+}
+
 void ECBackend::run_recovery_op(
   RecoveryHandle *_h,
   int priority)
@@ -845,8 +1009,17 @@ bool ECBackend::_handle_message(
     reply->min_epoch = get_parent()->get_interval_start_epoch();
     handle_sub_read(op->op.from, op->op, &(reply->op), _op->pg_trace);
     reply->trace = _op->pg_trace;
-    get_parent()->send_message_osd_cluster(
-      reply, _op->get_req()->get_connection());
+    if (!op->op.chain.empty()) {
+      forward_chained_read(op->op, std::move(reply->op), priority);
+      reply->put();
+    } else if (!op->op.partial_repair.empty()) {
+      // last of a chain, reply on behalf of its head
+      get_parent()->send_message_osd_cluster(
+	op->op.from.osd, reply, get_osdmap_epoch());
+    } else {
+      get_parent()->send_message_osd_cluster(
+	reply, _op->get_req()->get_connection());
+    }
     return true;
   }
   case MSG_OSD_EC_READ_REPLY: {
@@ -1046,24 +1219,29 @@ void ECBackend::handle_sub_read(
 	  bl, j->get<2>()); // Allow EIO return
       } else {
         dout(25) << __func__ << " case2: going to do fragmented read." << dendl;
-        int subchunk_size =
-          sinfo.get_chunk_size() / ec_impl->get_sub_chunk_count();
-        bool error = false;
-        for (int m = 0; m < (int)j->get<1>() && !error;
-             m += sinfo.get_chunk_size()) {
-          for (auto &&k:op.subchunks.find(i->first)->second) {
-            bufferlist bl0;
-            r = store->read(
-                ch,
-                ghobject_t(i->first, ghobject_t::NO_GEN, shard),
-                j->get<0>() + m + (k.first)*subchunk_size,
-                (k.second)*subchunk_size,
-                bl0, j->get<2>());
-            if (r < 0) {
-              error = true;
-              break;
+        // gather the sub-chunks of every chunk in the extent with a single
+        // vectored read; the store may not read past the end of the object
+        ghobject_t oid(i->first, ghobject_t::NO_GEN, shard);
+        struct stat st;
+        r = store->stat(ch, oid, &st);
+        if (r >= 0) {
+          uint64_t subchunk_size =
+            sinfo.get_chunk_size() / ec_impl->get_sub_chunk_count();
+          uint64_t end = std::min<uint64_t>(j->get<0>() + j->get<1>(),
+                                            st.st_size);
+          interval_set<uint64_t> extents;
+          for (uint64_t m = j->get<0>(); m < end; m += sinfo.get_chunk_size()) {
+            for (auto &&k:op.subchunks.find(i->first)->second) {
+              uint64_t off = m + k.first * subchunk_size;
+              uint64_t len = std::min<uint64_t>(k.second * subchunk_size,
+                                                end - std::min(off, end));
+              if (len) {
+                extents.insert(off, len);
+              }
             }
-            bl.claim_append(bl0);
+          }
+          if (!extents.empty()) {
+            r = store->readv(ch, oid, extents, bl, j->get<2>());
           }
         }
       }
@@ -1153,6 +1331,97 @@ error:
   }
   reply->from = get_parent()->whoami_shard();
   reply->tid = op.tid;
+  if (!op.partial_repair.empty()) {
+    fold_chained_read(op, reply);
+  }
+}
+
+void ECBackend::fold_chained_read(
+  const ECSubRead &op,
+  ECSubReadReply *reply)
+{
+  int shard = get_parent()->whoami_shard().shard.id;
+  for (auto &&[hoid, repair] : op.partial_repair) {
+    auto e = op.chained.errors.find(hoid);
+    if (e != op.chained.errors.end()) {
+      reply->buffers_read.erase(hoid);
+      reply->errors[hoid] = e->second;
+      continue;
+    }
+    auto mine = reply->buffers_read.find(hoid);
+    if (mine == reply->buffers_read.end()) {
+      continue;
+    }
+    auto prev = op.chained.buffers_read.find(hoid);
+    int r = 0;
+    auto p = prev != op.chained.buffers_read.end() ?
+      prev->second.begin() : mine->second.end();
+    for (auto &&[off, bl] : mine->second) {
+      bufferlist share;
+      r = ec_impl->partial_decode(repair.first, repair.second,
+				  {{shard, bl}}, &share);
+      if (r == 0 && prev != op.chained.buffers_read.end()) {
+	if (p == prev->second.end() || p->first != off) {
+	  r = -EIO;
+	} else {
+	  r = ec_impl->combine_partial_decode(p->second, &share);
+	  ++p;
+	}
+      }
+      if (r < 0) {
+	break;
+      }
+      bl = std::move(share);
+    }
+    if (r < 0) {
+      dout(5) << __func__ << ": Error " << r << " folding " << hoid
+	      << " into the chain of " << op.chained.from << dendl;
+      reply->buffers_read.erase(hoid);
+      reply->errors[hoid] = r;
+    }
+  }
+  // pass on whatever the head read for objects not repaired by the chain
+  for (auto &&i : op.chained.buffers_read) {
+    if (!op.partial_repair.count(i.first)) {
+      reply->buffers_read.insert(i);
+    }
+  }
+  for (auto &&i : op.chained.attrs_read) {
+    reply->attrs_read.insert(i);
+  }
+  for (auto &&i : op.chained.errors) {
+    reply->errors.insert(i);
+  }
+  reply->from = op.chained.from;
+}
+
+void ECBackend::forward_chained_read(
+  const ECSubRead &op,
+  ECSubReadReply &&gathered,
+  int priority)
+{
+  pg_shard_t next = op.chain.front();
+  dout(10) << __func__ << ": tid " << op.tid << " of " << gathered.from
+	   << " to " << next << dendl;
+  MOSDECSubOpRead *msg = new MOSDECSubOpRead;
+  msg->set_priority(priority);
+  msg->pgid = spg_t(get_parent()->whoami_spg_t().pgid, next.shard);
+  msg->map_epoch = get_osdmap_epoch();
+  msg->min_epoch = get_parent()->get_interval_start_epoch();
+  msg->op.from = op.from;
+  msg->op.tid = op.tid;
+  for (auto &&i : op.partial_repair) {
+    // objects the chain failed to read are only passed on
+    if (!gathered.errors.count(i.first)) {
+      msg->op.to_read[i.first] = op.to_read.at(i.first);
+      msg->op.subchunks[i.first] = op.subchunks.at(i.first);
+    }
+  }
+  msg->op.partial_repair = op.partial_repair;
+  msg->op.chain.assign(op.chain.begin() + 1, op.chain.end());
+  msg->op.chained = std::move(gathered);
+  get_parent()->send_message_osd_cluster(
+    next.osd, msg, get_osdmap_epoch());
 }
 
 void ECBackend::handle_sub_write_reply(
@@ -1203,6 +1472,11 @@ void ECBackend::handle_sub_read_reply(
     return;
   }
   ReadOp &rop = iter->second;
+  if (!rop.in_progress.count(from)) {
+    // a shard of its chain went down, @see filter_read_op
+    dout(20) << __func__ << ": dropped chained " << op << dendl;
+    return;
+  }
   for (auto i = op.buffers_read.begin();
        i != op.buffers_read.end();
        ++i) {
@@ -1224,11 +1498,19 @@ void ECBackend::handle_sub_read_reply(
       ceph_assert(req_iter != rop.to_read.find(i->first)->second.to_read.end());
       ceph_assert(riter != rop.complete[i->first].returned.end());
       pair<uint64_t, uint64_t> adjusted =
-	sinfo.aligned_offset_len_to_chunk(
-	  make_pair(req_iter->get<0>(), req_iter->get<1>()));
+	rop.to_read.find(i->first)->second.shard_extent(sinfo, *req_iter);
       ceph_assert(adjusted.first == j->first);
       riter->get<2>()[from] = std::move(j->second);
     }
+    auto &req = rop.to_read.find(i->first)->second;
+    auto c = req.chains.find(from);
+    if (c != req.chains.end()) {
+      auto &folded = rop.complete[i->first].partial[from];
+      folded.insert(from.shard);
+      for (auto &&hop : c->second) {
+	folded.insert(hop.shard);
+      }
+    }
   }
   for (auto i = op.attrs_read.begin();
        i != op.attrs_read.end();
@@ -1257,8 +1539,12 @@ void ECBackend::handle_sub_read_reply(
   ceph_assert(siter != shard_to_read_map.end());
   ceph_assert(siter->second.count(op.tid));
   siter->second.erase(op.tid);
+  for (auto &&[hop, head] : rop.chain_heads) {
+    if (head == from) {
+      shard_to_read_map[hop].erase(op.tid);
+    }
+  }
 
-  ceph_assert(rop.in_progress.count(from));
   rop.in_progress.erase(from);
   unsigned is_complete = 0;
   bool need_resend = false;
@@ -1276,6 +1562,11 @@ void ECBackend::handle_sub_read_reply(
         ++j) {
         have.insert(j->first.shard);
         dout(20) << __func__ << " have shard=" << j->first.shard << dendl;
+        auto p = iter->second.partial.find(j->first);
+        if (p != iter->second.partial.end()) {
+          // the share of the chain stands in for its shards
+          have.insert(p->second.begin(), p->second.end());
+        }
       }
       map<int, vector<pair<int, int>>> dummy_minimum;
       int err;
@@ -1357,6 +1648,9 @@ void ECBackend::complete_read_op(ReadOp &rop, RecoveryMessages *m)
     iter++) {
     shard_to_read_map[*iter].erase(rop.tid);
   }
+  for (auto &&i : rop.chain_heads) {
+    shard_to_read_map[i.first].erase(rop.tid);
+  }
   rop.in_progress.clear();
   tid_to_read_map.erase(rop.tid);
 }
@@ -1386,6 +1680,14 @@ void ECBackend::filter_read_op(
     if (osdmap->is_down(i->first.osd)) {
       to_cancel.insert(i->second.begin(), i->second.end());
       op.in_progress.erase(i->first);
+      auto h = op.chain_heads.find(i->first);
+      if (h != op.chain_heads.end() && op.in_progress.count(h->second)) {
+	// the head of the chain replies through us, it won't anymore
+	auto &head_objs = op.source_to_obj[h->second];
+	to_cancel.insert(head_objs.begin(), head_objs.end());
+	op.in_progress.erase(h->second);
+	shard_to_read_map[h->second].erase(op.tid);
+      }
       continue;
     }
   }
@@ -1490,6 +1792,7 @@ void ECBackend::on_change()
     cache.release_write_pin(op.second.pin);
   }
   tid_to_op_map.clear();
+  cache.clear();
 
   for (map<ceph_tid_t, ReadOp>::iterator i = tid_to_read_map.begin();
        i != tid_to_read_map.end();
@@ -1686,13 +1989,67 @@ int ECBackend::get_min_avail_to_read_shards(
   return 0;
 }
 
+bool ECBackend::plan_chained_repair(
+  const set<int> &want,
+  map<pg_shard_t, vector<pair<int, int>>> *to_read,
+  map<pg_shard_t, vector<pg_shard_t>> *chains,
+  set<int> *helpers)
+{
+  if (!cct->_conf->osd_ec_chained_repair ||
+      get_osdmap()->require_osd_release < ceph_release_t::reef ||
+      want.size() != 1 ||
+      ec_impl->get_sub_chunk_count() != 1 ||
+      !ec_impl->supports_partial_decode()) {
+    return false;
+  }
+  const auto &crush = get_osdmap()->crush;
+  int type = crush->get_type_id(
+    cct->_conf->osd_ec_chained_repair_failure_domain);
+  if (type < 0) {
+    dout(10) << __func__ << ": no crush type "
+	     << cct->_conf->osd_ec_chained_repair_failure_domain << dendl;
+    return false;
+  }
+  map<int, vector<pg_shard_t>> by_domain;
+  for (auto &&i : *to_read) {
+    int parent = crush->get_parent_of_type(i.first.osd, type);
+    if (parent < 0) {
+      by_domain[parent].push_back(i.first);
+    }
+  }
+  set<int> plan;
+  for (auto &&i : *to_read) {
+    plan.insert(i.first.shard);
+  }
+  bool chained = false;
+  for (auto &&[domain, shards] : by_domain) {
+    if (shards.size() < 2) {
+      continue;
+    }
+    pg_shard_t head = shards.front();
+    vector<pg_shard_t> hops(shards.begin() + 1, shards.end());
+    for (auto &&hop : hops) {
+      to_read->erase(hop);
+    }
+    dout(10) << __func__ << ": shard " << *want.begin() << " from "
+	     << head << " chained through " << hops << dendl;
+    (*chains)[head] = std::move(hops);
+    chained = true;
+  }
+  if (chained) {
+    *helpers = std::move(plan);
+  }
+  return chained;
+}
+
 int ECBackend::get_remaining_shards(
   const hobject_t &hoid,
   const set<int> &avail,
   const set<int> &want,
   const read_result_t &result,
   map<pg_shard_t, vector<pair<int, int>>> *to_read,
-  bool for_recovery)
+  bool for_recovery,
+  bool reread)
 {
   ceph_assert(to_read);
 
@@ -1713,6 +2070,18 @@ int ECBackend::get_remaining_shards(
     return -EIO;
   }
 
+  if (reread) {
+    // the shards read so far may only hold the sub-chunks the previous plan
+    // asked for, or a chain's share of the decode, neither of which need
+    // match the new plan: read everything it needs, see
+    // send_all_remaining_reads
+    for (auto &&p : need) {
+      ceph_assert(shards.count(shard_id_t(p.first)));
+      to_read->insert(make_pair(shards[shard_id_t(p.first)], p.second));
+    }
+    return 0;
+  }
+
   set<int> shards_left;
   for (auto p : need) {
     if (avail.find(p.first) == avail.end()) {
@@ -1768,6 +2137,29 @@ void ECBackend::do_read_op(ReadOp &op)
   dout(10) << __func__ << ": starting read " << op << dendl;
 
   map<pg_shard_t, ECSubRead> messages;
+  map<pg_shard_t, vector<pg_shard_t>> chain_of;
+  for (auto &&[hoid, req] : op.to_read) {
+    for (auto c = req.chains.begin(); c != req.chains.end(); ) {
+      if (!req.need.count(c->first)) {
+	++c;
+	continue;
+      }
+      auto [p, inserted] = chain_of.insert(*c);
+      if (inserted || p->second == c->second) {
+	++c;
+	continue;
+      }
+      // a head forwards a single chain per message, read the objects of
+      // any other chain through it directly
+      dout(10) << __func__ << ": " << hoid << " chain " << c->second
+	       << " of " << c->first << " conflicts, reading directly"
+	       << dendl;
+      for (auto &&hop : c->second) {
+	req.need[hop].push_back(make_pair(0, ec_impl->get_sub_chunk_count()));
+      }
+      c = req.chains.erase(c);
+    }
+  }
   for (map<hobject_t, read_request_t>::iterator i = op.to_read.begin();
        i != op.to_read.end();
        ++i) {
@@ -1783,13 +2175,25 @@ void ECBackend::do_read_op(ReadOp &op)
       messages[j->first].subchunks[i->first] = j->second;
       op.obj_to_source[i->first].insert(j->first);
       op.source_to_obj[j->first].insert(i->first);
+      auto c = i->second.chains.find(j->first);
+      if (c != i->second.chains.end()) {
+	auto &msg = messages[j->first];
+	msg.partial_repair[i->first] = make_pair(
+	  i->second.repair_shard, i->second.repair_helpers);
+	msg.chain = c->second;
+	for (auto &&hop : c->second) {
+	  op.obj_to_source[i->first].insert(hop);
+	  op.source_to_obj[hop].insert(i->first);
+	  op.chain_heads[hop] = j->first;
+	}
+      }
     }
     for (list<boost::tuple<uint64_t, uint64_t, uint32_t> >::const_iterator j =
 	   i->second.to_read.begin();
 	 j != i->second.to_read.end();
 	 ++j) {
       pair<uint64_t, uint64_t> chunk_off_len =
-	sinfo.aligned_offset_len_to_chunk(make_pair(j->get<0>(), j->get<1>()));
+	i->second.shard_extent(sinfo, *j);
       for (auto k = i->second.need.begin();
 	   k != i->second.need.end();
 	   ++k) {
@@ -1810,6 +2214,9 @@ void ECBackend::do_read_op(ReadOp &op)
        ++i) {
     op.in_progress.insert(i->first);
     shard_to_read_map[i->first].insert(op.tid);
+    for (auto &&hop : i->second.chain) {
+      shard_to_read_map[hop].insert(op.tid);
+    }
     i->second.tid = tid;
     MOSDECSubOpRead *msg = new MOSDECSubOpRead;
     msg->set_priority(priority);
@@ -1821,6 +2228,10 @@ void ECBackend::do_read_op(ReadOp &op)
     msg->op = i->second;
     msg->op.from = get_parent()->whoami_shard();
     msg->op.tid = tid;
+    if (!msg->op.partial_repair.empty()) {
+      msg->op.chained.from = i->first;
+      msg->op.chained.tid = tid;
+    }
     if (op.trace) {
       // initialize a child span for this shard
       msg->trace.init("ec sub read", nullptr, &op.trace);
@@ -1915,12 +2326,184 @@ void ECBackend::start_rmw(Op *op, PGTransactionUPtr &&t)
     },
     get_parent()->get_dpp());
 
+  if (cct->_conf->osd_ec_parity_delta_writes &&
+      ec_impl->supports_parity_delta() &&
+      !op->plan.to_read.empty()) {
+    ECTransaction::plan_parity_delta(
+      op->plan,
+      sinfo,
+      ec_impl,
+      get_parent()->get_dpp());
+  }
+
   dout(10) << __func__ << ": " << *op << dendl;
 
   waiting_state.push_back(*op);
   check_ops();
 }
 
+bool ECBackend::can_use_parity_delta(
+  const Op &op,
+  const hobject_t &hoid,
+  const set<int> &shards)
+{
+  // the old coding chunks are read from disk, so an earlier write to
+  // the object must not be in flight
+  for (auto &&i : waiting_reads) {
+    if (&i != &op && i.plan.will_write.count(hoid)) {
+      dout(20) << __func__ << ": " << hoid << " has a write waiting on reads"
+	       << dendl;
+      return false;
+    }
+  }
+  for (auto &&i : waiting_commit) {
+    if (i.plan.will_write.count(hoid)) {
+      dout(20) << __func__ << ": " << hoid << " has a write in progress"
+	       << dendl;
+      return false;
+    }
+  }
+  set<int> have;
+  map<shard_id_t, pg_shard_t> avail;
+  set<pg_shard_t> error_shards;
+  get_all_avail_shards(hoid, error_shards, have, avail, false);
+  if (!std::includes(have.begin(), have.end(), shards.begin(), shards.end())) {
+    dout(20) << __func__ << ": " << hoid << " is degraded, have " << have
+	     << " need " << shards << dendl;
+    return false;
+  }
+  return true;
+}
+
+void ECBackend::start_parity_delta_reads(Op *op)
+{
+  map<hobject_t, set<int>> want_to_read;
+  map<hobject_t, read_request_t> for_read_op;
+  for (auto &&[hoid, pd] : op->plan.parity_delta) {
+    map<pg_shard_t, vector<pair<int, int>>> shards;
+    int r = get_min_avail_to_read_shards(
+      hoid,
+      pd.shards,
+      false,
+      false,
+      &shards);
+    ceph_assert(r == 0);
+
+    list<boost::tuple<uint64_t, uint64_t, uint32_t> > to_read;
+    for (auto &&extent : pd.stripes) {
+      to_read.emplace_back(extent.first, extent.second, 0);
+    }
+    auto c = make_gen_lambda_context<
+      pair<RecoveryMessages*, read_result_t& > &>(
+	[this, op, hoid=hoid, to_read](
+	  pair<RecoveryMessages*, read_result_t& > &in) {
+	  finish_parity_delta_read(op, hoid, to_read, in.second);
+	});
+    for_read_op.insert(
+      make_pair(
+	hoid,
+	read_request_t(
+	  to_read,
+	  shards,
+	  false,
+	  c.release())));
+    want_to_read.insert(make_pair(hoid, pd.shards));
+    ++op->delta_reads_pending;
+  }
+  start_read_op(
+    CEPH_MSG_PRIO_DEFAULT,
+    want_to_read,
+    for_read_op,
+    OpRequestRef(),
+    false, false);
+}
+
+void ECBackend::finish_parity_delta_read(
+  Op *op,
+  const hobject_t &hoid,
+  const list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read,
+  read_result_t &res)
+{
+  ceph_assert(op->delta_reads_pending > 0);
+  auto pditer = op->plan.parity_delta.find(hoid);
+  ceph_assert(pditer != op->plan.parity_delta.end());
+  const set<int> &want = pditer->second.shards;
+
+  int r = res.r;
+  map<int, extent_map> result;
+  if (r == 0) {
+    ceph_assert(res.returned.size() == to_read.size());
+  }
+  for (auto &&read : to_read) {
+    if (r < 0)
+      break;
+    auto &returned = res.returned.front();
+    ceph_assert(returned.get<0>() == read.get<0>());
+    ceph_assert(returned.get<1>() == read.get<1>());
+    uint64_t chunk_off = sinfo.aligned_logical_offset_to_chunk_offset(
+      read.get<0>());
+    uint64_t chunk_len = sinfo.aligned_logical_offset_to_chunk_offset(
+      read.get<1>());
+    map<int, bufferlist> to_decode;
+    for (auto &&j : returned.get<2>()) {
+      to_decode[j.first.shard] = std::move(j.second);
+    }
+    map<int, bufferlist> decoded;
+    bool have_all = true;
+    for (auto i : want) {
+      if (!to_decode.count(i)) {
+	have_all = false;
+	break;
+      }
+    }
+    if (have_all) {
+      for (auto i : want) {
+	decoded[i] = std::move(to_decode[i]);
+      }
+    } else {
+      // some shards failed and were reconstructed from the others
+      map<int, bufferlist*> out;
+      for (auto i : want) {
+	out[i] = &decoded[i];
+      }
+      r = ECUtil::decode(sinfo, ec_impl, to_decode, out);
+    }
+    for (auto &&[shard, bl] : decoded) {
+      if (r == 0 && bl.length() != chunk_len) {
+	r = -EIO;
+      }
+      if (r == 0) {
+	result[shard].insert(chunk_off, chunk_len, std::move(bl));
+      }
+    }
+    res.returned.pop_front();
+  }
+
+  if (r < 0) {
+    // fall back to reading and re-encoding the whole stripes
+    dout(0) << __func__ << ": " << hoid << " parity delta read failed r="
+	    << r << ", reading " << pditer->second.stripes << dendl;
+    map<hobject_t, extent_set> stripes;
+    stripes[hoid] = pditer->second.stripes;
+    op->plan.parity_delta.erase(pditer);
+    objects_read_async_no_cache(
+      stripes,
+      [this, op](map<hobject_t,pair<int, extent_map> > &&results) {
+	for (auto &&i: results) {
+	  op->delta_fallback_result.emplace(i.first, i.second.second);
+	}
+	ceph_assert(op->delta_reads_pending > 0);
+	--op->delta_reads_pending;
+	check_ops();
+      });
+    return;
+  }
+
+  op->delta_read_result[hoid] = std::move(result);
+  --op->delta_reads_pending;
+  check_ops();
+}
+
 bool ECBackend::try_state_to_reads()
 {
   if (waiting_state.empty())
@@ -1947,6 +2530,28 @@ bool ECBackend::try_state_to_reads()
   waiting_state.pop_front();
   waiting_reads.push_back(*op);
 
+  for (auto p = op->plan.parity_delta.begin();
+       p != op->plan.parity_delta.end(); ) {
+    if (can_use_parity_delta(*op, p->first, p->second.shards)) {
+      ECTransaction::use_parity_delta(op->plan, p->first);
+      ++p;
+    } else {
+      p = op->plan.parity_delta.erase(p);
+    }
+  }
+
+  if (op->plan.t) {
+    // cached extents only follow writes going through the cache
+    for (auto &&[oid, oop]: op->plan.t->op_map) {
+      if (!op->using_cache ||
+	  !oop.is_none() ||
+	  oop.deletes_first() ||
+	  oop.truncate) {
+	cache.invalidate(oid);
+      }
+    }
+  }
+
   if (op->using_cache) {
     cache.open_write_pin(op->pin);
 
@@ -1991,6 +2596,9 @@ bool ECBackend::try_state_to_reads()
 	check_ops();
       });
   }
+  if (!op->plan.parity_delta.empty()) {
+    start_parity_delta_reads(op);
+  }
 
   return true;
 }
@@ -2024,6 +2632,9 @@ bool ECBackend::try_reads_to_commit()
   } else {
     ceph_assert(op->pending_read.empty());
   }
+  for (auto &&hpair: op->delta_fallback_result) {
+    op->remote_read_result[hpair.first].insert(hpair.second);
+  }
 
   map<shard_id_t, ObjectStore::Transaction> trans;
   for (set<pg_shard_t>::const_iterator i =
@@ -2043,6 +2654,7 @@ bool ECBackend::try_reads_to_commit()
       get_parent()->get_info().pgid.pgid,
       sinfo,
       op->remote_read_result,
+      op->delta_read_result,
       op->log_entries,
       &written,
       &trans,
@@ -2066,6 +2678,17 @@ bool ECBackend::try_reads_to_commit()
     }
   }
 
+  for (auto &&hpair: op->delta_fallback_result) {
+    // whole stripes were re-encoded, but only the parity delta writes
+    // were reserved in the cache
+    auto &w = written[hpair.first];
+    extent_map trimmed;
+    for (auto &&extent: op->plan.will_write[hpair.first]) {
+      trimmed.insert(w.intersect(extent.first, extent.second));
+    }
+    w = std::move(trimmed);
+  }
+
   map<hobject_t,extent_set> written_set;
   for (auto &&i: written) {
     written_set[i.first] = i.second.get_interval_set();
@@ -2081,6 +2704,8 @@ bool ECBackend::try_reads_to_commit()
   }
   op->remote_read.clear();
   op->remote_read_result.clear();
+  op->delta_read_result.clear();
+  op->delta_fallback_result.clear();
 
   ObjectStore::Transaction empty;
   bool should_write_local = false;
@@ -2194,7 +2819,10 @@ bool ECBackend::try_finish_rmw()
   }
 
   if (op->using_cache) {
-    cache.release_write_pin(op->pin);
+    // keep the written extents unless a write bypassing the cache is
+    // in the pipeline
+    cache.release_write_pin(op->pin, pipeline_state.caching_enabled());
+    cache.trim(cct->_conf->osd_ec_extent_cache_size);
   }
   tid_to_op_map.erase(op->tid);
 
@@ -2350,15 +2978,37 @@ struct CallClientContexts :
   ECBackend *ec;
   ECBackend::ClientAsyncReadStatus *status;
   list<boost::tuple<uint64_t, uint64_t, uint32_t> > to_read;
+  bool direct;
   CallClientContexts(
     hobject_t hoid,
     ECBackend *ec,
     ECBackend::ClientAsyncReadStatus *status,
-    const list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read)
-    : hoid(hoid), ec(ec), status(status), to_read(to_read) {}
+    const list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read,
+    bool direct = false)
+    : hoid(hoid), ec(ec), status(status), to_read(to_read), direct(direct) {}
   void finish(pair<RecoveryMessages *, ECBackend::read_result_t &> &in) override {
     ECBackend::read_result_t &res = in.second;
     extent_map result;
+    if (direct) {
+      if (res.r != 0 || !res.errors.empty()) {
+	ldpp_dout(ec->get_parent()->get_dpp(), 10)
+	  << "CallClientContexts: direct read of " << hoid
+	  << " failed with " << res.r << ", reconstructing" << dendl;
+	ec->objects_read_and_reconstruct_one(hoid, to_read, status, false);
+	return;
+      }
+      ceph_assert(res.returned.size() == to_read.size());
+      for (auto &&read: to_read) {
+	auto &returned = res.returned.front().get<2>();
+	ceph_assert(returned.size() == 1);
+	bufferlist &bl = returned.begin()->second;
+	if (bl.length()) {
+	  result.insert(read.get<0>(), bl.length(), std::move(bl));
+	}
+	res.returned.pop_front();
+      }
+      goto out;
+    }
     if (res.r != 0)
       goto out;
     ceph_assert(res.returned.size() == to_read.size());
@@ -2422,6 +3072,33 @@ void ECBackend::objects_read_and_reconstruct(
     
   map<hobject_t, read_request_t> for_read_op;
   for (auto &&to_read: reads) {
+    pg_shard_t from;
+    list<boost::tuple<uint64_t, uint64_t, uint32_t> > shard_extents;
+    if (!fast_read &&
+	cct->_conf->osd_ec_direct_shard_reads &&
+	get_direct_read(to_read.first, to_read.second, &from, &shard_extents)) {
+      map<pg_shard_t, vector<pair<int, int>>> shards;
+      shards[from].push_back(make_pair(0, ec_impl->get_sub_chunk_count()));
+      CallClientContexts *c = new CallClientContexts(
+	to_read.first,
+	this,
+	&(in_progress_client_reads.back()),
+	to_read.second,
+	true);
+      for_read_op.insert(
+	make_pair(
+	  to_read.first,
+	  read_request_t(
+	    shard_extents,
+	    shards,
+	    false,
+	    c,
+	    true)));
+      obj_want_to_read.insert(
+	make_pair(to_read.first, set<int>{from.shard.id}));
+      continue;
+    }
+
     map<pg_shard_t, vector<pair<int, int>>> shards;
     int r = get_min_avail_to_read_shards(
       to_read.first,
@@ -2457,20 +3134,119 @@ void ECBackend::objects_read_and_reconstruct(
 }
 
 
+bool ECBackend::get_direct_read(
+  const hobject_t &hoid,
+  const list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read,
+  pg_shard_t *from,
+  list<boost::tuple<uint64_t, uint64_t, uint32_t> > *shard_extents)
+{
+  int position = -1;
+  for (auto &&read: to_read) {
+    uint64_t off = read.get<0>();
+    uint64_t len = read.get<1>();
+    if (!sinfo.logical_extent_in_one_chunk(off, len)) {
+      return false;
+    }
+    int p = sinfo.logical_offset_to_chunk_position(off);
+    if (position >= 0 && p != position) {
+      return false;
+    }
+    position = p;
+    shard_extents->emplace_back(
+      sinfo.logical_offset_to_shard_offset(off), len, read.get<2>());
+  }
+  if (position < 0) {
+    return false;
+  }
+  const vector<int> &chunk_mapping = ec_impl->get_chunk_mapping();
+  int shard = (int)chunk_mapping.size() > position ?
+    chunk_mapping[position] : position;
+
+  set<int> have;
+  map<shard_id_t, pg_shard_t> shards;
+  set<pg_shard_t> error_shards;
+  get_all_avail_shards(hoid, error_shards, have, shards, false);
+  auto i = shards.find(shard_id_t(shard));
+  if (i == shards.end()) {
+    shard_extents->clear();
+    return false;
+  }
+  *from = i->second;
+  dout(20) << __func__ << ": " << hoid << " " << to_read
+	   << " from " << *from << " at " << *shard_extents << dendl;
+  return true;
+}
+
+void ECBackend::objects_read_and_reconstruct_one(
+  const hobject_t &hoid,
+  const list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read,
+  ClientAsyncReadStatus *status,
+  bool fast_read)
+{
+  set<int> want_to_read;
+  get_want_to_read_shards(&want_to_read);
+  map<pg_shard_t, vector<pair<int, int>>> shards;
+  int r = get_min_avail_to_read_shards(
+    hoid,
+    want_to_read,
+    false,
+    fast_read,
+    &shards);
+  if (r < 0) {
+    status->complete_object(hoid, r, extent_map());
+    kick_reads();
+    return;
+  }
+
+  map<hobject_t, set<int>> obj_want_to_read;
+  obj_want_to_read.insert(make_pair(hoid, want_to_read));
+  map<hobject_t, read_request_t> for_read_op;
+  for_read_op.insert(
+    make_pair(
+      hoid,
+      read_request_t(
+	to_read,
+	shards,
+	false,
+	new CallClientContexts(hoid, this, status, to_read))));
+  start_read_op(
+    CEPH_MSG_PRIO_DEFAULT,
+    obj_want_to_read,
+    for_read_op,
+    OpRequestRef(),
+    fast_read, false);
+}
+
 int ECBackend::send_all_remaining_reads(
   const hobject_t &hoid,
   ReadOp &rop)
 {
+  if (rop.to_read.find(hoid)->second.direct) {
+    // the caller reconstructs the extents with a regular read
+    dout(10) << __func__ << " direct read of " << hoid << " failed" << dendl;
+    return -EIO;
+  }
   set<int> already_read;
   const set<pg_shard_t>& ots = rop.obj_to_source[hoid];
   for (set<pg_shard_t>::iterator i = ots.begin(); i != ots.end(); ++i)
     already_read.insert(i->shard);
   dout(10) << __func__ << " have/error shards=" << already_read << dendl;
   map<pg_shard_t, vector<pair<int, int>>> shards;
+  bool reread = ec_impl->get_sub_chunk_count() > 1 ||
+    !rop.to_read.find(hoid)->second.chains.empty();
   int r = get_remaining_shards(hoid, already_read, rop.want_to_read[hoid],
-			       rop.complete[hoid], &shards, rop.for_recovery);
+			       rop.complete[hoid], &shards, rop.for_recovery,
+			       reread);
   if (r)
     return r;
+  if (reread) {
+    // everything is read again, possibly with different sub-chunks, and
+    // directly from each shard
+    for (auto &&i : rop.complete[hoid].returned) {
+      i.get<2>().clear();
+    }
+    rop.complete[hoid].partial.clear();
+  }
 
   list<boost::tuple<uint64_t, uint64_t, uint32_t> > offsets =
     rop.to_read.find(hoid)->second.to_read;
@@ -2558,13 +3334,14 @@ int ECBackend::be_deep_scrub(
   if (stride % sinfo.get_chunk_size())
     stride += sinfo.get_chunk_size() - (stride % sinfo.get_chunk_size());
 
-  bufferlist bl;
-  r = store->read(
+  const ghobject_t oid(
+    poid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard);
+  uint32_t crc = pos.data_hash.digest();
+  r = store->read_digest(
     ch,
-    ghobject_t(
-      poid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard),
+    oid,
     pos.data_pos,
-    stride, bl,
+    stride, &crc,
     fadvise_flags);
   if (r < 0) {
     dout(20) << __func__ << "  " << poid << " got "
@@ -2572,7 +3349,7 @@ int ECBackend::be_deep_scrub(
     o.read_error = true;
     return 0;
   }
-  if (bl.length() % sinfo.get_chunk_size()) {
+  if (r % sinfo.get_chunk_size()) {
     dout(20) << __func__ << "  " << poid << " got "
 	     << r << " on read, not chunk size " << sinfo.get_chunk_size() << " aligned"
 	     << dendl;
@@ -2580,10 +3357,11 @@ int ECBackend::be_deep_scrub(
     return 0;
   }
   if (r > 0) {
-    pos.data_hash << bl;
+    pos.data_hash = bufferhash(crc);
   }
   pos.data_pos += r;
   if (r == (int)stride) {
+    be_deep_scrub_read_ahead(oid, pos.data_pos, stride);
     return -EINPROGRESS;
   }
 
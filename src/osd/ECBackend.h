@@ -193,6 +193,19 @@ public:
       std::map<hobject_t,std::pair<int, extent_map> > &&, Func>(
 	  std::forward<Func>(on_complete)));
   }
+  /// read the logical extents of hoid from the single data shard
+  /// holding them, if it is available
+  bool get_direct_read(
+    const hobject_t &hoid,
+    const std::list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read,
+    pg_shard_t *from,
+    std::list<boost::tuple<uint64_t, uint64_t, uint32_t> > *shard_extents);
+  /// reconstruct the logical extents of hoid for a client read
+  void objects_read_and_reconstruct_one(
+    const hobject_t &hoid,
+    const std::list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read,
+    ClientAsyncReadStatus *status,
+    bool fast_read);
   void kick_reads() {
     while (in_progress_client_reads.size() &&
 	   in_progress_client_reads.front().is_complete()) {
@@ -283,6 +296,16 @@ private:
     // valid in state READING
     std::pair<uint64_t, uint64_t> extent_requested;
 
+    /// shard bytes read to rebuild the object so far
+    uint64_t repair_bytes_read = 0;
+    /// what reading whole chunks from k shards would have taken instead
+    uint64_t repair_bytes_full = 0;
+
+    /// recover only the stripes in recovery_info.copy_subset
+    bool is_partial() const {
+      return !recovery_info.copy_subset.empty();
+    }
+
     void dump(ceph::Formatter *f) const;
 
     RecoveryOp() : state(IDLE) {}
@@ -293,12 +316,15 @@ private:
   void continue_recovery_op(
     RecoveryOp &op,
     RecoveryMessages *m);
+  /// limit op to the stripes the missing shards lack, if possible
+  void get_partial_recovery_extents(RecoveryOp &op);
   void dispatch_recovery_messages(RecoveryMessages &m, int priority);
   friend struct OnRecoveryReadComplete;
   void handle_recovery_read_complete(
     const hobject_t &hoid,
     boost::tuple<uint64_t, uint64_t, std::map<pg_shard_t, ceph::buffer::list> > &to_read,
     std::optional<std::map<std::string, ceph::buffer::list, std::less<>> > attrs,
+    const std::map<pg_shard_t, std::set<int>> &partial,
     RecoveryMessages *m);
   void handle_recovery_push(
     const PushOp &op,
@@ -344,6 +370,9 @@ public:
     std::list<
       boost::tuple<
 	uint64_t, uint64_t, std::map<pg_shard_t, ceph::buffer::list> > > returned;
+    /// chain heads whose buffers are partial decodes, and the shards
+    /// folded into them, see plan_chained_repair
+    std::map<pg_shard_t, std::set<int>> partial;
     read_result_t() : r(0) {}
   };
   struct read_request_t {
@@ -351,13 +380,32 @@ public:
     std::map<pg_shard_t, std::vector<std::pair<int, int>>> need;
     bool want_attrs;
     GenContext<std::pair<RecoveryMessages *, read_result_t& > &> *cb;
+    /// to_read holds extents of the single shard in need rather than
+    /// stripe aligned logical extents; nothing is reconstructed on error
+    bool direct;
+    /// the shards in need listed here forward the read to the shards of
+    /// the chain and return their share of the decode of repair_shard from
+    /// repair_helpers, see plan_chained_repair
+    std::map<pg_shard_t, std::vector<pg_shard_t>> chains;
+    int repair_shard = -1;
+    std::set<int> repair_helpers;
     read_request_t(
       const std::list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read,
       const std::map<pg_shard_t, std::vector<std::pair<int, int>>> &need,
       bool want_attrs,
-      GenContext<std::pair<RecoveryMessages *, read_result_t& > &> *cb)
+      GenContext<std::pair<RecoveryMessages *, read_result_t& > &> *cb,
+      bool direct = false)
       : to_read(to_read), need(need), want_attrs(want_attrs),
-	cb(cb) {}
+	cb(cb), direct(direct) {}
+    std::pair<uint64_t, uint64_t> shard_extent(
+      const ECUtil::stripe_info_t &sinfo,
+      const boost::tuple<uint64_t, uint64_t, uint32_t> &extent) const {
+      if (direct) {
+	return std::make_pair(extent.get<0>(), extent.get<1>());
+      }
+      return sinfo.aligned_offset_len_to_chunk(
+	std::make_pair(extent.get<0>(), extent.get<1>()));
+    }
   };
   friend ostream &operator<<(ostream &lhs, const read_request_t &rhs);
 
@@ -381,6 +429,8 @@ public:
 
     std::map<hobject_t, std::set<pg_shard_t>> obj_to_source;
     std::map<pg_shard_t, std::set<hobject_t> > source_to_obj;
+    /// shards read through a chain, and the head replying for them
+    std::map<pg_shard_t, pg_shard_t> chain_heads;
 
     void dump(ceph::Formatter *f) const;
 
@@ -428,6 +478,28 @@ public:
     bool do_redundant_reads, bool for_recovery);
 
   void do_read_op(ReadOp &rop);
+  /**
+   * Chained repair
+   *
+   * When a single shard is recovered with a code that can decode piecewise,
+   * the helpers found in the same failure domain are chained: the head
+   * reads its chunk, turns it into its share of the lost chunk and forwards
+   * the read to the next shard of the chain, which adds its own share, and
+   * so on. The last shard replies to the primary on behalf of the head, so
+   * that a single chunk crosses the failure domain boundary.
+   */
+  /// @return true if chains were formed from the shards in to_read
+  bool plan_chained_repair(
+    const std::set<int> &want,
+    std::map<pg_shard_t, std::vector<std::pair<int, int>>> *to_read,
+    std::map<pg_shard_t, std::vector<pg_shard_t>> *chains,
+    std::set<int> *helpers);
+  /// fold what we read into the shares gathered by the chain so far
+  void fold_chained_read(const ECSubRead &op, ECSubReadReply *reply);
+  void forward_chained_read(
+    const ECSubRead &op,
+    ECSubReadReply &&gathered,
+    int priority);
   int send_all_remaining_reads(
     const hobject_t &hoid,
     ReadOp &rop);
@@ -481,8 +553,14 @@ public:
     std::map<hobject_t,extent_set> pending_read; // subset already being read
     std::map<hobject_t,extent_set> remote_read;  // subset we must read
     std::map<hobject_t,extent_map> remote_read_result;
+    /// shard extents of the plan.parity_delta objects, keyed by shard
+    std::map<hobject_t,std::map<int,extent_map>> delta_read_result;
+    /// full stripes read after a failed parity delta read
+    std::map<hobject_t,extent_map> delta_fallback_result;
+    unsigned delta_reads_pending = 0;
     bool read_in_progress() const {
-      return !remote_read.empty() && remote_read_result.empty();
+      return (!remote_read.empty() && remote_read_result.empty()) ||
+	delta_reads_pending > 0;
     }
 
     /// In progress write state.
@@ -561,6 +639,17 @@ public:
   eversion_t completed_to;
   eversion_t committed_to;
   void start_rmw(Op *op, PGTransactionUPtr &&t);
+  /// true if the coding chunks of hoid can be updated with parity deltas
+  bool can_use_parity_delta(
+    const Op &op,
+    const hobject_t &hoid,
+    const std::set<int> &shards);
+  void start_parity_delta_reads(Op *op);
+  void finish_parity_delta_read(
+    Op *op,
+    const hobject_t &hoid,
+    const std::list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read,
+    read_result_t &res);
   bool try_state_to_reads();
   bool try_reads_to_commit();
   bool try_finish_rmw();
@@ -657,7 +746,8 @@ public:
     const std::set<int> &want,
     const read_result_t &result,
     std::map<pg_shard_t, std::vector<std::pair<int, int>>> *to_read,
-    bool for_recovery);
+    bool for_recovery,
+    bool reread);
 
   int objects_get_attrs(
     const hobject_t &hoid,
@@ -192,18 +192,21 @@ void ECSubRead::encode(bufferlist &bl, uint64_t features) const
     return;
   }
 
-  ENCODE_START(3, 2, bl);
+  ENCODE_START(4, 2, bl);
   encode(from, bl);
   encode(tid, bl);
   encode(to_read, bl);
   encode(attrs_to_read, bl);
   encode(subchunks, bl);
+  encode(partial_repair, bl);
+  encode(chain, bl);
+  encode(chained, bl);
   ENCODE_FINISH(bl);
 }
 
 void ECSubRead::decode(bufferlist::const_iterator &bl)
 {
-  DECODE_START(3, bl);
+  DECODE_START(4, bl);
   decode(from, bl);
   decode(tid, bl);
   if (struct_v == 1) {
@@ -227,6 +230,11 @@ void ECSubRead::decode(bufferlist::const_iterator &bl)
       subchunks[i.first].push_back(make_pair(0, 1));
     }
   }
+  if (struct_v >= 4) {
+    decode(partial_repair, bl);
+    decode(chain, bl);
+    decode(chained, bl);
+  }
   DECODE_FINISH(bl);
 }
 
@@ -237,7 +245,13 @@ std::ostream &operator<<(
     << "ECSubRead(tid=" << rhs.tid
     << ", to_read=" << rhs.to_read
     << ", subchunks=" << rhs.subchunks
-    << ", attrs_to_read=" << rhs.attrs_to_read << ")";
+    << ", attrs_to_read=" << rhs.attrs_to_read;
+  if (!rhs.partial_repair.empty()) {
+    lhs << ", partial_repair=" << rhs.partial_repair
+	<< ", chain=" << rhs.chain
+	<< ", chained=" << rhs.chained;
+  }
+  return lhs << ")";
 }
 
 void ECSubRead::dump(Formatter *f) const
@@ -268,6 +282,24 @@ void ECSubRead::dump(Formatter *f) const
     f->close_section();
   }
   f->close_section();
+
+  f->open_array_section("partial_repair");
+  for (auto i = partial_repair.cbegin(); i != partial_repair.cend(); ++i) {
+    f->open_object_section("object");
+    f->dump_stream("oid") << i->first;
+    f->dump_int("shard", i->second.first);
+    f->dump_stream("helpers") << i->second.second;
+    f->close_section();
+  }
+  f->close_section();
+  f->open_array_section("chain");
+  for (auto i = chain.cbegin(); i != chain.cend(); ++i) {
+    f->dump_stream("shard") << *i;
+  }
+  f->close_section();
+  f->open_object_section("chained");
+  chained.dump(f);
+  f->close_section();
 }
 
 void ECSubRead::generate_test_instances(list<ECSubRead*>& o)
@@ -288,6 +320,16 @@ void ECSubRead::generate_test_instances(list<ECSubRead*>& o)
   o.back()->to_read[hoid2].push_back(boost::make_tuple(400, 600, 0));
   o.back()->to_read[hoid2].push_back(boost::make_tuple(2000, 600, 0));
   o.back()->attrs_to_read.insert(hoid2);
+  o.push_back(new ECSubRead());
+  o.back()->from = pg_shard_t(2, shard_id_t(0));
+  o.back()->tid = 301;
+  o.back()->to_read[hoid1].push_back(boost::make_tuple(0, 4096, 0));
+  o.back()->partial_repair[hoid1] = make_pair(1, set<int>{2, 3, 4});
+  o.back()->chain.push_back(pg_shard_t(4, shard_id_t(4)));
+  o.back()->chained.from = pg_shard_t(3, shard_id_t(3));
+  o.back()->chained.tid = 301;
+  o.back()->chained.buffers_read[hoid1].push_back(
+    make_pair(0, bufferlist()));
 }
 
 void ECSubReadReply::encode(bufferlist &bl) const
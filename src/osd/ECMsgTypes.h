@@ -102,19 +102,6 @@ struct ECSubWriteReply {
 };
 WRITE_CLASS_ENCODER(ECSubWriteReply)
 
-struct ECSubRead {
-  pg_shard_t from;
-  ceph_tid_t tid;
-  std::map<hobject_t, std::list<boost::tuple<uint64_t, uint64_t, uint32_t> >> to_read;
-  std::set<hobject_t> attrs_to_read;
-  std::map<hobject_t, std::vector<std::pair<int, int>>> subchunks;
-  void encode(ceph::buffer::list &bl, uint64_t features) const;
-  void decode(ceph::buffer::list::const_iterator &bl);
-  void dump(ceph::Formatter *f) const;
-  static void generate_test_instances(std::list<ECSubRead*>& o);
-};
-WRITE_CLASS_ENCODER_FEATURES(ECSubRead)
-
 struct ECSubReadReply {
   pg_shard_t from;
   ceph_tid_t tid;
@@ -128,6 +115,28 @@ struct ECSubReadReply {
 };
 WRITE_CLASS_ENCODER(ECSubReadReply)
 
+struct ECSubRead {
+  pg_shard_t from;
+  ceph_tid_t tid;
+  std::map<hobject_t, std::list<boost::tuple<uint64_t, uint64_t, uint32_t> >> to_read;
+  std::set<hobject_t> attrs_to_read;
+  std::map<hobject_t, std::vector<std::pair<int, int>>> subchunks;
+  /// objects whose chunks are folded into the partial decode of a lost
+  /// shard instead of being returned: the lost shard and the helpers of
+  /// the decode, see ErasureCodeInterface::partial_decode
+  std::map<hobject_t, std::pair<int, std::set<int>>> partial_repair;
+  /// the shards to forward the read to in turn; the last one replies to
+  /// from on behalf of the first
+  std::vector<pg_shard_t> chain;
+  /// what the shards before this one in the chain have gathered
+  ECSubReadReply chained;
+  void encode(ceph::buffer::list &bl, uint64_t features) const;
+  void decode(ceph::buffer::list::const_iterator &bl);
+  void dump(ceph::Formatter *f) const;
+  static void generate_test_instances(std::list<ECSubRead*>& o);
+};
+WRITE_CLASS_ENCODER_FEATURES(ECSubRead)
+
 std::ostream &operator<<(
   std::ostream &lhs, const ECSubWrite &rhs);
 std::ostream &operator<<(
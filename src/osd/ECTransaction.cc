@@ -93,6 +93,195 @@ void encode_and_write(
   }
 }
 
+/// copy a chunk out of the shard extents returned by the delta reads
+static ceph::bufferptr get_old_chunk(
+  const map<int, extent_map> &old_chunks,
+  int shard,
+  uint64_t chunk_off,
+  uint64_t chunk_size) {
+  auto siter = old_chunks.find(shard);
+  ceph_assert(siter != old_chunks.end());
+  auto range = siter->second.get_containing_range(chunk_off, chunk_size);
+  ceph_assert(range.first != range.second);
+  ceph_assert(range.first.get_off() <= chunk_off);
+  ceph_assert(chunk_off + chunk_size <=
+	      range.first.get_off() + range.first.get_len());
+  ceph::bufferptr ptr = ceph::buffer::create_page_aligned(chunk_size);
+  range.first.get_val().begin(chunk_off - range.first.get_off()).copy(
+    chunk_size, ptr.c_str());
+  return ptr;
+}
+
+void encode_delta_and_write(
+  pg_t pgid,
+  const hobject_t &oid,
+  const ECUtil::stripe_info_t &sinfo,
+  ErasureCodeInterfaceRef &ecimpl,
+  uint64_t offset,
+  const extent_map &to_write,
+  const map<int, extent_map> &old_chunks,
+  uint32_t flags,
+  extent_map &written,
+  map<shard_id_t, ObjectStore::Transaction> *transactions,
+  DoutPrefixProvider *dpp) {
+  ceph_assert(sinfo.logical_offset_is_stripe_aligned(offset));
+  const uint64_t chunk_size = sinfo.get_chunk_size();
+  const uint64_t chunk_off =
+    sinfo.aligned_logical_offset_to_chunk_offset(offset);
+  const unsigned k = ecimpl->get_data_chunk_count();
+  const vector<int> &chunk_mapping = ecimpl->get_chunk_mapping();
+  auto shard_of = [&](unsigned i) {
+    return chunk_mapping.size() > i ? chunk_mapping[i] : (int)i;
+  };
+
+  map<int, ceph::bufferptr> new_chunks;
+  map<int, ceph::bufferptr> deltas;
+  for (unsigned i = 0; i < k; ++i) {
+    uint64_t chunk_start = offset + i * chunk_size;
+    auto update = to_write.intersect(chunk_start, chunk_size);
+    if (update.empty()) {
+      continue;
+    }
+    int shard = shard_of(i);
+    ceph::bufferptr old_data = get_old_chunk(
+      old_chunks, shard, chunk_off, chunk_size);
+    ceph::bufferptr new_data = ceph::buffer::copy(
+      old_data.c_str(), chunk_size);
+    for (auto &&extent : update) {
+      extent.get_val().begin().copy(
+	extent.get_len(),
+	new_data.c_str() + (extent.get_off() - chunk_start));
+    }
+    int r = ecimpl->encode_delta(old_data, new_data, &deltas[shard]);
+    ceph_assert(r == 0);
+    bufferlist bl;
+    bl.append(new_data);
+    written.insert(chunk_start, chunk_size, bl);
+    new_chunks[shard] = std::move(new_data);
+  }
+  ceph_assert(!deltas.empty());
+
+  for (unsigned i = k; i < ecimpl->get_chunk_count(); ++i) {
+    int shard = shard_of(i);
+    new_chunks[shard] = get_old_chunk(
+      old_chunks, shard, chunk_off, chunk_size);
+  }
+  map<int, ceph::bufferptr> coding;
+  for (unsigned i = k; i < ecimpl->get_chunk_count(); ++i) {
+    int shard = shard_of(i);
+    coding[shard] = new_chunks[shard];
+  }
+  int r = ecimpl->apply_delta(deltas, coding);
+  ceph_assert(r == 0);
+
+  ldpp_dout(dpp, 20) << __func__ << ": " << oid
+		     << " stripe " << offset
+		     << " shards " << new_chunks.size()
+		     << dendl;
+
+  for (auto &&[shard, ptr] : new_chunks) {
+    auto st = transactions->find(shard_id_t(shard));
+    if (st == transactions->end()) {
+      continue;
+    }
+    bufferlist bl;
+    bl.append(ptr);
+    st->second.write(
+      coll_t(spg_t(pgid, st->first)),
+      ghobject_t(oid, ghobject_t::NO_GEN, st->first),
+      chunk_off,
+      chunk_size,
+      bl,
+      flags);
+  }
+}
+
+void ECTransaction::plan_parity_delta(
+  WritePlan &plan,
+  const ECUtil::stripe_info_t &sinfo,
+  ErasureCodeInterfaceRef &ecimpl,
+  DoutPrefixProvider *dpp)
+{
+  ceph_assert(plan.t);
+  const unsigned k = ecimpl->get_data_chunk_count();
+  const unsigned m = ecimpl->get_coding_chunk_count();
+  const uint64_t chunk_size = sinfo.get_chunk_size();
+  const uint64_t stripe_width = sinfo.get_stripe_width();
+  const vector<int> &chunk_mapping = ecimpl->get_chunk_mapping();
+  auto shard_of = [&](unsigned i) {
+    return chunk_mapping.size() > i ? chunk_mapping[i] : (int)i;
+  };
+
+  for (auto &&[oid, stripes] : plan.to_read) {
+    auto opiter = plan.t->op_map.find(oid);
+    if (opiter == plan.t->op_map.end()) {
+      continue;
+    }
+    auto &op = opiter->second;
+    if (!op.is_none() || op.deletes_first() || op.truncate ||
+	op.has_source()) {
+      continue;
+    }
+
+    WritePlan::ParityDelta pd;
+    set<unsigned> positions;
+    for (auto &&extent : op.buffer_updates) {
+      for (auto &&stripe : stripes) {
+	uint64_t start = std::max(extent.get_off(), stripe.first);
+	uint64_t end = std::min(extent.get_off() + extent.get_len(),
+				stripe.first + stripe.second);
+	if (start >= end) {
+	  continue;
+	}
+	start -= start % chunk_size;
+	end = round_up_to(end, chunk_size);
+	pd.writes.union_insert(start, end - start);
+	for (uint64_t c = start; c < end; c += chunk_size) {
+	  positions.insert((c % stripe_width) / chunk_size);
+	}
+      }
+    }
+    // reading and writing the modified data chunks and all the coding
+    // chunks must cost less than reading the data chunks and writing
+    // all the chunks
+    if (positions.empty() || 2 * positions.size() + m >= 2 * k) {
+      ldpp_dout(dpp, 20) << __func__ << ": " << oid << " modifies "
+			 << positions.size() << " of " << k
+			 << " data chunks, not using parity delta" << dendl;
+      continue;
+    }
+    pd.stripes = stripes;
+    for (auto i : positions) {
+      pd.shards.insert(shard_of(i));
+    }
+    for (unsigned i = k; i < k + m; ++i) {
+      pd.shards.insert(shard_of(i));
+    }
+    ldpp_dout(dpp, 20) << __func__ << ": " << oid
+		       << " stripes " << pd.stripes
+		       << " writes " << pd.writes
+		       << " shards " << pd.shards
+		       << dendl;
+    plan.parity_delta.emplace(oid, std::move(pd));
+  }
+}
+
+void ECTransaction::use_parity_delta(
+  WritePlan &plan,
+  const hobject_t &oid)
+{
+  auto &pd = plan.parity_delta.at(oid);
+  auto to_read = plan.to_read.find(oid);
+  ceph_assert(to_read != plan.to_read.end());
+  to_read->second.subtract(pd.stripes);
+  if (to_read->second.empty()) {
+    plan.to_read.erase(to_read);
+  }
+  auto &will_write = plan.will_write.at(oid);
+  will_write.subtract(pd.stripes);
+  will_write.union_of(pd.writes);
+}
+
 bool ECTransaction::requires_overwrite(
   uint64_t prev_size,
   const PGTransaction::ObjectOperation &op) {
@@ -112,6 +301,7 @@ void ECTransaction::generate_transactions(
   pg_t pgid,
   const ECUtil::stripe_info_t &sinfo,
   const map<hobject_t,extent_map> &partial_extents,
+  const map<hobject_t,map<int,extent_map>> &partial_shards,
   vector<pg_log_entry_t> &entries,
   map<hobject_t,extent_map> *written_map,
   map<shard_id_t, ObjectStore::Transaction> *transactions,
@@ -555,6 +745,49 @@ void ECTransaction::generate_transactions(
       for (unsigned i = 0; i < ecimpl->get_chunk_count(); ++i) {
 	want.insert(i);
       }
+
+      // stripes updated with parity deltas are not in partial_extents,
+      // to_write only holds the modified part of them
+      extent_map to_write_delta;
+      auto pditer = plan.parity_delta.find(oid);
+      if (pditer != plan.parity_delta.end()) {
+	for (auto &&stripe : pditer->second.stripes) {
+	  ceph_assert(stripe.first + stripe.second <= append_after);
+	  to_write_delta.insert(to_write.intersect(stripe.first, stripe.second));
+	  to_write.erase(stripe.first, stripe.second);
+	}
+	ldpp_dout(dpp, 20) << "generate_transactions: to_write_delta: "
+			   << to_write_delta
+			   << dendl;
+      }
+
+      auto save_rollback_extent = [&](uint64_t off, uint64_t len) {
+	uint64_t restore_from = sinfo.aligned_logical_offset_to_chunk_offset(
+	  off);
+	uint64_t restore_len = sinfo.aligned_logical_offset_to_chunk_offset(
+	  len);
+	ldpp_dout(dpp, 20) << "generate_transactions: overwriting "
+			   << restore_from << "~" << restore_len
+			   << dendl;
+	if (rollback_extents.empty()) {
+	  for (auto &&st : *transactions) {
+	    st.second.touch(
+	      coll_t(spg_t(pgid, st.first)),
+	      ghobject_t(oid, entry->version.version, st.first));
+	  }
+	}
+	rollback_extents.emplace_back(make_pair(restore_from, restore_len));
+	for (auto &&st : *transactions) {
+	  st.second.clone_range(
+	    coll_t(spg_t(pgid, st.first)),
+	    ghobject_t(oid, ghobject_t::NO_GEN, st.first),
+	    ghobject_t(oid, entry->version.version, st.first),
+	    restore_from,
+	    restore_len,
+	    restore_from);
+	}
+      };
+
       auto to_overwrite = to_write.intersect(0, append_after);
       ldpp_dout(dpp, 20) << "generate_transactions: to_overwrite: "
 			 << to_overwrite
@@ -564,30 +797,7 @@ void ECTransaction::generate_transactions(
 	ceph_assert(sinfo.logical_offset_is_stripe_aligned(extent.get_off()));
 	ceph_assert(sinfo.logical_offset_is_stripe_aligned(extent.get_len()));
 	if (entry) {
-	  uint64_t restore_from = sinfo.aligned_logical_offset_to_chunk_offset(
-	    extent.get_off());
-	  uint64_t restore_len = sinfo.aligned_logical_offset_to_chunk_offset(
-	    extent.get_len());
-	  ldpp_dout(dpp, 20) << "generate_transactions: overwriting "
-			     << restore_from << "~" << restore_len
-			     << dendl;
-	  if (rollback_extents.empty()) {
-	    for (auto &&st : *transactions) {
-	      st.second.touch(
-		coll_t(spg_t(pgid, st.first)),
-		ghobject_t(oid, entry->version.version, st.first));
-	    }
-	  }
-	  rollback_extents.emplace_back(make_pair(restore_from, restore_len));
-	  for (auto &&st : *transactions) {
-	    st.second.clone_range(
-	      coll_t(spg_t(pgid, st.first)),
-	      ghobject_t(oid, ghobject_t::NO_GEN, st.first),
-	      ghobject_t(oid, entry->version.version, st.first),
-	      restore_from,
-	      restore_len,
-	      restore_from);
-	  }
+	  save_rollback_extent(extent.get_off(), extent.get_len());
 	}
 	encode_and_write(
 	  pgid,
@@ -604,6 +814,33 @@ void ECTransaction::generate_transactions(
 	  dpp);
       }
 
+      if (!to_write_delta.empty()) {
+	auto psiter = partial_shards.find(oid);
+	ceph_assert(psiter != partial_shards.end());
+	const uint64_t stripe_width = sinfo.get_stripe_width();
+	for (auto &&stripes : pditer->second.stripes) {
+	  for (uint64_t off = stripes.first;
+	       off < stripes.first + stripes.second;
+	       off += stripe_width) {
+	    if (entry) {
+	      save_rollback_extent(off, stripe_width);
+	    }
+	    encode_delta_and_write(
+	      pgid,
+	      oid,
+	      sinfo,
+	      ecimpl,
+	      off,
+	      to_write_delta.intersect(off, stripe_width),
+	      psiter->second,
+	      fadvise_flags,
+	      written,
+	      transactions,
+	      dpp);
+	  }
+	}
+      }
+
       auto to_append = to_write.intersect(
 	append_after,
 	std::numeric_limits<uint64_t>::max() - append_after);
@@ -30,6 +30,14 @@ namespace ECTransaction {
     std::map<hobject_t,extent_set> will_write; // superset of to_read
 
     std::map<hobject_t,ECUtil::HashInfoRef> hash_infos;
+
+    /// partial stripes whose coding chunks are updated with parity deltas
+    struct ParityDelta {
+      extent_set stripes; // subset of to_read
+      extent_set writes;  // logical extents of the data chunks rewritten
+      std::set<int> shards; // shards read and rewritten
+    };
+    std::map<hobject_t,ParityDelta> parity_delta;
   };
 
   bool requires_overwrite(
@@ -182,12 +190,32 @@ namespace ECTransaction {
     return plan;
   }
 
+  /**
+   * Find the partial stripes of plan.to_read for which updating the
+   * coding chunks with the delta of the modified data chunks is cheaper
+   * than reading and re-encoding the stripe, and fill plan.parity_delta.
+   * plan.to_read and plan.will_write are left alone, see
+   * use_parity_delta().
+   */
+  void plan_parity_delta(
+    WritePlan &plan,
+    const ECUtil::stripe_info_t &sinfo,
+    ceph::ErasureCodeInterfaceRef &ecimpl,
+    DoutPrefixProvider *dpp);
+
+  /// commit to the parity delta plan of oid: the delta stripes are
+  /// read with the shard reads of plan.parity_delta[oid] instead
+  void use_parity_delta(
+    WritePlan &plan,
+    const hobject_t &oid);
+
   void generate_transactions(
     WritePlan &plan,
     ceph::ErasureCodeInterfaceRef &ecimpl,
     pg_t pgid,
     const ECUtil::stripe_info_t &sinfo,
     const std::map<hobject_t,extent_map> &partial_extents,
+    const std::map<hobject_t,std::map<int,extent_map>> &partial_shards,
     std::vector<pg_log_entry_t> &entries,
     std::map<hobject_t,extent_map> *written,
     std::map<shard_id_t, ObjectStore::Transaction> *transactions,
@@ -9,6 +9,26 @@ using ceph::bufferlist;
 using ceph::ErasureCodeInterfaceRef;
 using ceph::Formatter;
 
+namespace {
+// the shard holding data chunk i of a stripe, see ErasureCode::chunk_index
+int data_chunk_index(const ErasureCodeInterfaceRef &ec_impl, unsigned i)
+{
+  const vector<int> &mapping = ec_impl->get_chunk_mapping();
+  return mapping.size() > i ? mapping[i] : (int)i;
+}
+
+// Linear codes (those supporting parity deltas) encode and decode each
+// byte offset of a chunk independently, so N stripes can be handed to the
+// plugin in a single call, as one stripe whose chunks are N times larger.
+// This saves the per-call overhead and lets the SIMD kernels run on long
+// buffers.
+bool can_batch_stripes(const ErasureCodeInterfaceRef &ec_impl)
+{
+  return ec_impl->supports_parity_delta() &&
+    ec_impl->get_sub_chunk_count() == 1;
+}
+}
+
 int ECUtil::decode(
   const stripe_info_t &sinfo,
   ErasureCodeInterfaceRef &ec_impl,
@@ -31,6 +51,27 @@ int ECUtil::decode(
   if (total_data_size == 0)
     return 0;
 
+  if (total_data_size > sinfo.get_chunk_size() && can_batch_stripes(ec_impl)) {
+    unsigned k = ec_impl->get_data_chunk_count();
+    set<int> want;
+    for (unsigned i = 0; i < k; i++) {
+      want.insert(data_chunk_index(ec_impl, i));
+    }
+    map<int, bufferlist> decoded;
+    int r = ec_impl->decode(want, to_decode, &decoded, total_data_size);
+    ceph_assert(r == 0);
+    for (uint64_t off = 0; off < total_data_size; off += sinfo.get_chunk_size()) {
+      for (unsigned i = 0; i < k; i++) {
+	bufferlist &shard = decoded[data_chunk_index(ec_impl, i)];
+	ceph_assert(shard.length() == total_data_size);
+	bufferlist bl;
+	bl.substr_of(shard, off, sinfo.get_chunk_size());
+	out->claim_append(bl);
+      }
+    }
+    return 0;
+  }
+
   for (uint64_t i = 0; i < total_data_size; i += sinfo.get_chunk_size()) {
     map<int, bufferlist> chunks;
     for (map<int, bufferlist>::iterator j = to_decode.begin();
@@ -96,23 +137,35 @@ int ECUtil::decode(
     }
   }
 
-  for (int i = 0; i < chunks_count; i++) {
-    map<int, bufferlist> chunks;
-    for (auto j = to_decode.begin();
-	 j != to_decode.end();
-	 ++j) {
-      chunks[j->first].substr_of(j->second, 
-                                 i*repair_data_per_chunk, 
-                                 repair_data_per_chunk);
-    }
+  if (chunks_count > 1 && can_batch_stripes(ec_impl)) {
+    ceph_assert(repair_data_per_chunk == (int)sinfo.get_chunk_size());
     map<int, bufferlist> out_bls;
-    r = ec_impl->decode(need, chunks, &out_bls, sinfo.get_chunk_size());
+    r = ec_impl->decode(need, to_decode, &out_bls,
+			chunks_count * sinfo.get_chunk_size());
     ceph_assert(r == 0);
     for (auto j = out.begin(); j != out.end(); ++j) {
       ceph_assert(out_bls.count(j->first));
-      ceph_assert(out_bls[j->first].length() == sinfo.get_chunk_size());
       j->second->claim_append(out_bls[j->first]);
     }
+  } else {
+    for (int i = 0; i < chunks_count; i++) {
+      map<int, bufferlist> chunks;
+      for (auto j = to_decode.begin();
+	   j != to_decode.end();
+	   ++j) {
+        chunks[j->first].substr_of(j->second, 
+                                   i*repair_data_per_chunk, 
+                                   repair_data_per_chunk);
+      }
+      map<int, bufferlist> out_bls;
+      r = ec_impl->decode(need, chunks, &out_bls, sinfo.get_chunk_size());
+      ceph_assert(r == 0);
+      for (auto j = out.begin(); j != out.end(); ++j) {
+        ceph_assert(out_bls.count(j->first));
+        ceph_assert(out_bls[j->first].length() == sinfo.get_chunk_size());
+        j->second->claim_append(out_bls[j->first]);
+      }
+    }
   }
   for (auto &&i : out) {
     ceph_assert(i.second->length() == chunks_count * sinfo.get_chunk_size());
@@ -136,17 +189,47 @@ int ECUtil::encode(
   if (logical_size == 0)
     return 0;
 
-  for (uint64_t i = 0; i < logical_size; i += sinfo.get_stripe_width()) {
+  uint64_t stripes = logical_size / sinfo.get_stripe_width();
+  if (stripes > 1 && can_batch_stripes(ec_impl)) {
+    // gather each data chunk of all the stripes into one buffer per shard
+    unsigned k = ec_impl->get_data_chunk_count();
+    unsigned n = ec_impl->get_chunk_count();
+    uint64_t chunk_size = sinfo.get_chunk_size();
     map<int, bufferlist> encoded;
-    bufferlist buf;
-    buf.substr_of(in, i, sinfo.get_stripe_width());
-    int r = ec_impl->encode(want, buf, &encoded);
+    vector<char*> data(k);
+    for (unsigned i = 0; i < n; i++) {
+      bufferptr ptr(buffer::create_page_aligned(chunk_size * stripes));
+      if (i < k) {
+	data[i] = ptr.c_str();
+      }
+      encoded[data_chunk_index(ec_impl, i)].push_back(std::move(ptr));
+    }
+    auto p = in.cbegin();
+    for (uint64_t s = 0; s < stripes; s++) {
+      for (unsigned i = 0; i < k; i++) {
+	p.copy(chunk_size, data[i] + s * chunk_size);
+      }
+    }
+    int r = ec_impl->encode_chunks(want, &encoded);
     ceph_assert(r == 0);
-    for (map<int, bufferlist>::iterator i = encoded.begin();
-	 i != encoded.end();
-	 ++i) {
-      ceph_assert(i->second.length() == sinfo.get_chunk_size());
-      (*out)[i->first].claim_append(i->second);
+    for (auto &&i : encoded) {
+      if (want.count(i.first)) {
+	(*out)[i.first].claim_append(i.second);
+      }
+    }
+  } else {
+    for (uint64_t i = 0; i < logical_size; i += sinfo.get_stripe_width()) {
+      map<int, bufferlist> encoded;
+      bufferlist buf;
+      buf.substr_of(in, i, sinfo.get_stripe_width());
+      int r = ec_impl->encode(want, buf, &encoded);
+      ceph_assert(r == 0);
+      for (map<int, bufferlist>::iterator i = encoded.begin();
+	   i != encoded.end();
+	   ++i) {
+	ceph_assert(i->second.length() == sinfo.get_chunk_size());
+	(*out)[i->first].claim_append(i->second);
+      }
     }
   }
 
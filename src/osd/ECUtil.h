@@ -77,6 +77,18 @@ public:
       (in.first - off) + in.second);
     return std::make_pair(off, len);
   }
+  /// data chunk position (before chunk mapping) holding a logical offset
+  unsigned logical_offset_to_chunk_position(uint64_t offset) const {
+    return (offset % stripe_width) / chunk_size;
+  }
+  /// offset within its shard of the byte at a logical offset
+  uint64_t logical_offset_to_shard_offset(uint64_t offset) const {
+    return (offset / stripe_width) * chunk_size + offset % chunk_size;
+  }
+  /// true if a non empty logical extent lies within a single data chunk
+  bool logical_extent_in_one_chunk(uint64_t offset, uint64_t len) const {
+    return len > 0 && offset / chunk_size == (offset + len - 1) / chunk_size;
+  }
 };
 
 int decode(
@@ -24,6 +24,7 @@ void ExtentCache::extent::_link_pin_state(pin_state &pin_state)
   ceph_assert(!parent_pin_state);
   parent_pin_state = &pin_state;
   pin_state.pin_list.push_back(*this);
+  pin_state.bytes += length;
 }
 
 void ExtentCache::extent::_unlink_pin_state()
@@ -32,6 +33,8 @@ void ExtentCache::extent::_unlink_pin_state()
   ceph_assert(parent_pin_state);
   auto liter = pin_state::list::s_iterator_to(*this);
   parent_pin_state->pin_list.erase(liter);
+  ceph_assert(parent_pin_state->bytes >= length);
+  parent_pin_state->bytes -= length;
   parent_pin_state = nullptr;
 }
 
@@ -220,9 +223,38 @@ void ExtentCache::present_rmw_update(
   }
 }
 
+void ExtentCache::invalidate(const hobject_t &oid)
+{
+  auto eset = get_if_exists(oid);
+  if (!eset) {
+    return;
+  }
+  for (auto iter = eset->extent_set.begin();
+       iter != eset->extent_set.end(); ) {
+    extent *ext = &*iter;
+    ++iter;
+    ceph_assert(ext->parent_pin_state);
+    if (ext->parent_pin_state->is_cache()) {
+      std::unique_ptr<extent> owned(ext);
+      ext->unlink();
+    } else {
+      ext->retain = false;
+    }
+  }
+  remove_and_destroy_if_empty(*eset);
+}
+
+void ExtentCache::trim(uint64_t max_bytes)
+{
+  while (cache_pin.bytes > max_bytes) {
+    ceph_assert(!cache_pin.pin_list.empty());
+    destroy_extent(&cache_pin.pin_list.front());
+  }
+}
+
 ostream &ExtentCache::print(ostream &out) const
 {
-  out << "ExtentCache(" << std::endl;
+  out << "ExtentCache(cached " << cache_pin.bytes << std::endl;
   for (auto esiter = per_object_caches.begin();
        esiter != per_object_caches.end();
        ++esiter) {
@@ -231,9 +263,13 @@ ostream &ExtentCache::print(ostream &out) const
 	 exiter != esiter->extent_set.end();
 	 ++exiter) {
       out << "    Extent(" << exiter->offset
-	  << "~" << exiter->get_length()
-	  << ":" << exiter->pin_tid()
-	  << ")" << std::endl;
+	  << "~" << exiter->get_length();
+      if (exiter->parent_pin_state->is_cache()) {
+	out << ":cached";
+      } else {
+	out << ":" << exiter->pin_tid();
+      }
+      out << ")" << std::endl;
     }
   }
   return out << ")" << std::endl;
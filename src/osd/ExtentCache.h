@@ -92,6 +92,21 @@
    All of the above suggests that there are 3 things users can
    ask of the cache corresponding to the 3 Write pipelines
    states.
+
+   Once the last write pinning an extent completes, the extent may be
+   retained instead of being dropped:
+
+   3) Cached:
+      - This extent has the data of the object as of the last completed
+        write, no write is in progress on it
+      - It is owned by the cache pin, kept in LRU order and dropped by
+        trim() or invalidate() (e.g. when the object is removed or
+        written outside of the cache)
+      - reserve_extents_for_rmw treats it like a Write Pinned extent
+        and moves it to the new write pin
+
+   The caller is responsible for not retaining extents which might be
+   stale, and for calling clear() on interval change.
  */
 
 /// If someone wants these types, but not ExtentCache, move to another file
@@ -131,6 +146,8 @@ private:
     uint64_t offset;
     uint64_t length;
     std::optional<ceph::buffer::list> bl;
+    /// false once the object was invalidated while this extent was pinned
+    bool retain = true;
 
     uint64_t get_length() const {
       return length;
@@ -262,6 +279,7 @@ private:
 	      head = new extent(
 		ext->offset, offset - ext->offset);
 	    }
+	    head->retain = ext->retain;
 	    head->link(*this, *ps);
 	  }
 	  if ((ext->offset + ext->length > offset + length) &&
@@ -279,6 +297,7 @@ private:
 	    } else {
 	      tail = new extent(offset + length, nlen);
 	    }
+	    tail->retain = ext->retain;
 	    tail->link(*this, *ps);
 	  }
 	  if (action.action == update_action::UPDATE_PIN) {
@@ -350,9 +369,12 @@ private:
     enum pin_type_t {
       NONE,
       WRITE,
+      CACHE,
     };
     pin_type_t pin_type = NONE;
     bool is_write() const { return pin_type == WRITE; }
+    bool is_cache() const { return pin_type == CACHE; }
+    uint64_t bytes = 0; ///< total length of the extents in pin_list
 
     pin_state(const pin_state &other) = delete;
     pin_state &operator=(const pin_state &other) = delete;
@@ -367,6 +389,7 @@ private:
     list pin_list;
     ~pin_state() {
       ceph_assert(pin_list.empty());
+      ceph_assert(bytes == 0);
       ceph_assert(tid == 0);
       ceph_assert(pin_type == NONE);
     }
@@ -378,20 +401,40 @@ private:
     }
   };
 
-  void release_pin(pin_state &p) {
+  /// owns the extents no write is in progress on, oldest first
+  pin_state cache_pin;
+
+  void destroy_extent(extent *ext) {
+    std::unique_ptr<extent> extent(ext); // we now own this
+    ceph_assert(extent->parent_extent_set);
+    auto &eset = *(extent->parent_extent_set);
+    extent->unlink();
+    remove_and_destroy_if_empty(eset);
+  }
+
+  void release_pin(pin_state &p, bool retain) {
     for (auto iter = p.pin_list.begin(); iter != p.pin_list.end(); ) {
-      std::unique_ptr<extent> extent(&*iter); // we now own this
+      extent *ext = &*iter;
       iter++; // unlink will invalidate
-      ceph_assert(extent->parent_extent_set);
-      auto &eset = *(extent->parent_extent_set);
-      extent->unlink();
-      remove_and_destroy_if_empty(eset);
+      if (retain && ext->bl && ext->retain) {
+	ext->move(cache_pin);
+      } else {
+	destroy_extent(ext);
+      }
     }
     p.tid = 0;
     p.pin_type = pin_state::NONE;
   }
 
 public:
+  ExtentCache() {
+    cache_pin.pin_type = pin_state::CACHE;
+  }
+  ~ExtentCache() {
+    clear();
+    cache_pin.pin_type = pin_state::NONE;
+  }
+
   class write_pin : private pin_state {
     friend class ExtentCache;
   private:
@@ -475,10 +518,36 @@ public:
 
   /**
    * Release all buffers pinned by pin
+   *
+   * Transition table:
+   * - Write Pinned pin.reqid -> Cached if retain, else Empty
+   * - Write Pending pin.reqid -> Empty
+   *
+   * @param pin [in,out] pin to release
+   * @param retain [in] keep the written extents as cached
    */
   void release_write_pin(
-    write_pin &pin) {
-    release_pin(pin);
+    write_pin &pin,
+    bool retain = false) {
+    release_pin(pin, retain);
+  }
+
+  /**
+   * Drop the cached extents of oid, and do not retain the extents of
+   * oid currently pinned by writes when they are released
+   */
+  void invalidate(const hobject_t &oid);
+
+  /// drop the least recently used cached extents above max_bytes
+  void trim(uint64_t max_bytes);
+
+  /// drop all cached extents
+  void clear() {
+    trim(0);
+  }
+
+  uint64_t get_cached_bytes() const {
+    return cache_pin.bytes;
   }
 
   std::ostream &print(std::ostream &out) const;
@@ -12,6 +12,8 @@
  *
  */
 
+#include <cmath>
+
 #include "HitSet.h"
 #include "common/Formatter.h"
 
@@ -33,6 +35,11 @@ HitSet::HitSet(const HitSet::Params& params)
     }
     break;
 
+  case TYPE_BLOCKED_BLOOM:
+    impl.reset(new BlockedBloomHitSet(
+      static_cast<BlockedBloomHitSet::Params*>(params.impl.get())));
+    break;
+
   case TYPE_EXPLICIT_HASH:
     impl.reset(new ExplicitHashHitSet(static_cast<ExplicitHashHitSet::Params*>(params.impl.get())));
     break;
@@ -75,6 +82,9 @@ void HitSet::decode(ceph::buffer::list::const_iterator& bl)
   case TYPE_BLOOM:
     impl.reset(new BloomHitSet);
     break;
+  case TYPE_BLOCKED_BLOOM:
+    impl.reset(new BlockedBloomHitSet);
+    break;
   case TYPE_NONE:
     impl.reset(NULL);
     break;
@@ -101,6 +111,10 @@ void HitSet::generate_test_instances(list<HitSet*>& o)
   o.back()->insert(hobject_t());
   o.back()->insert(hobject_t("asdf", "", CEPH_NOSNAP, 123, 1, ""));
   o.back()->insert(hobject_t("qwer", "", CEPH_NOSNAP, 456, 1, ""));
+  o.push_back(new HitSet(new BlockedBloomHitSet(10, .1, 1)));
+  o.back()->insert(hobject_t());
+  o.back()->insert(hobject_t("asdf", "", CEPH_NOSNAP, 123, 1, ""));
+  o.back()->insert(hobject_t("qwer", "", CEPH_NOSNAP, 456, 1, ""));
   o.push_back(new HitSet(new ExplicitHashHitSet));
   o.back()->insert(hobject_t());
   o.back()->insert(hobject_t("asdf", "", CEPH_NOSNAP, 123, 1, ""));
@@ -162,6 +176,9 @@ bool HitSet::Params::create_impl(impl_type_t type)
   case TYPE_BLOOM:
     impl.reset(new BloomHitSet::Params);
     break;
+  case TYPE_BLOCKED_BLOOM:
+    impl.reset(new BlockedBloomHitSet::Params);
+    break;
   case TYPE_NONE:
     impl.reset(NULL);
     break;
@@ -203,6 +220,8 @@ void HitSet::Params::generate_test_instances(list<HitSet::Params*>& o)
   o.push_back(new Params);
   o.push_back(new Params(new BloomHitSet::Params));
   loop_hitset_params(BloomHitSet);
+  o.push_back(new Params(new BlockedBloomHitSet::Params));
+  loop_hitset_params(BlockedBloomHitSet);
   o.push_back(new Params(new ExplicitHashHitSet::Params));
   loop_hitset_params(ExplicitHashHitSet);
   o.push_back(new Params(new ExplicitObjectHitSet::Params));
@@ -254,3 +273,62 @@ void BloomHitSet::dump(Formatter *f) const {
   bloom.dump(f);
   f->close_section();
 }
+
+// -- BlockedBloomHitSet --
+
+BlockedBloomHitSet::BlockedBloomHitSet(uint64_t inserts, double fpp,
+				       uint32_t seed)
+  : target_size(inserts), seed(seed)
+{
+  // each word of a block is a one-hash bloom filter over the objects
+  // mapped to the block, so we need (1 - e^(-n / 64b))^8 <= fpp
+  if (fpp <= 0.0 || fpp >= 1.0) {
+    fpp = .01;
+  }
+  double per_block = -64.0 * std::log(1.0 - std::pow(fpp, 1.0 / WORDS_PER_BLOCK));
+  uint64_t blocks = std::max<uint64_t>(1, std::ceil(inserts / per_block));
+  bits.resize(blocks * WORDS_PER_BLOCK);
+}
+
+const uint64_t *BlockedBloomHitSet::get_block(
+  const hobject_t& o,
+  uint64_t (&mask)[WORDS_PER_BLOCK]) const
+{
+  static constexpr uint32_t salt[WORDS_PER_BLOCK] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+  };
+  // spread the 32 bit object hash over 64 bits (splitmix64 finalizer)
+  uint64_t h = ((uint64_t)seed << 32) | o.get_hash();
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+  h ^= h >> 31;
+  uint64_t block = ((h >> 32) * num_blocks()) >> 32;
+  uint32_t l = h;
+  for (unsigned i = 0; i < WORDS_PER_BLOCK; ++i) {
+    mask[i] = 1ull << ((uint32_t)(l * salt[i]) >> 26);
+  }
+  return &bits[block * WORDS_PER_BLOCK];
+}
+
+unsigned BlockedBloomHitSet::approx_unique_insert_count() const
+{
+  // every insert sets one bit in each of the words of one block
+  uint64_t set = 0;
+  for (auto w : bits) {
+    set += __builtin_popcountll(w);
+  }
+  double fill = (double)set / (bits.size() * 64);
+  if (fill >= 1.0) {
+    return count;
+  }
+  double est = -64.0 * num_blocks() * std::log(1.0 - fill);
+  return std::min<uint64_t>(count, std::llround(est));
+}
+
+void BlockedBloomHitSet::dump(Formatter *f) const {
+  f->dump_unsigned("target_size", target_size);
+  f->dump_unsigned("seed", seed);
+  f->dump_unsigned("insert_count", count);
+  f->dump_unsigned("blocks", num_blocks());
+}
@@ -38,7 +38,8 @@ public:
     TYPE_NONE = 0,
     TYPE_EXPLICIT_HASH = 1,
     TYPE_EXPLICIT_OBJECT = 2,
-    TYPE_BLOOM = 3
+    TYPE_BLOOM = 3,
+    TYPE_BLOCKED_BLOOM = 4
   } impl_type_t;
 
   static std::string_view get_type_name(impl_type_t t) {
@@ -47,9 +48,14 @@ public:
     case TYPE_EXPLICIT_HASH: return "explicit_hash";
     case TYPE_EXPLICIT_OBJECT: return "explicit_object";
     case TYPE_BLOOM: return "bloom";
+    case TYPE_BLOCKED_BLOOM: return "blocked_bloom";
     default: return "???";
     }
   }
+  /// whether the Params of type t are (or derive from) BloomHitSet::Params
+  static bool is_bloom_type(impl_type_t t) {
+    return t == TYPE_BLOOM || t == TYPE_BLOCKED_BLOOM;
+  }
   std::string_view get_type_name() const {
     if (impl)
       return get_type_name(impl->get_type());
@@ -452,4 +458,115 @@ public:
 };
 WRITE_CLASS_ENCODER(BloomHitSet)
 
+/**
+ * a blocked bloom filter
+ *
+ * Each object maps to one 64 byte (cache line sized) block of eight words
+ * and sets one bit in each of them, so an insert or lookup touches a
+ * single cache line and the probe is a fixed-width and/compare which the
+ * compiler vectorizes.  It takes the bloom parameters and is sized for
+ * target_size objects at the given false positive probability up front.
+ */
+class BlockedBloomHitSet : public HitSet::Impl {
+public:
+  static constexpr unsigned WORDS_PER_BLOCK = 8;
+
+private:
+  uint64_t target_size = 0;
+  uint32_t seed = 0;
+  uint64_t count = 0;
+  std::vector<uint64_t> bits;  ///< WORDS_PER_BLOCK words per block
+
+  uint64_t num_blocks() const {
+    return bits.size() / WORDS_PER_BLOCK;
+  }
+  /// the block for o and the bit to test or set in each of its words
+  const uint64_t *get_block(const hobject_t& o,
+			    uint64_t (&mask)[WORDS_PER_BLOCK]) const;
+
+public:
+  HitSet::impl_type_t get_type() const override {
+    return HitSet::TYPE_BLOCKED_BLOOM;
+  }
+
+  class Params : public BloomHitSet::Params {
+  public:
+    using BloomHitSet::Params::Params;
+
+    HitSet::impl_type_t get_type() const override {
+      return HitSet::TYPE_BLOCKED_BLOOM;
+    }
+    HitSet::Impl *get_new_impl() const override {
+      return new BlockedBloomHitSet;
+    }
+    static void generate_test_instances(std::list<Params*>& o) {
+      o.push_back(new Params);
+      o.push_back(new Params(.05, 300, 99));
+    }
+  };
+
+  BlockedBloomHitSet() : bits(WORDS_PER_BLOCK) {}
+  BlockedBloomHitSet(uint64_t inserts, double fpp, uint32_t seed);
+  explicit BlockedBloomHitSet(const BlockedBloomHitSet::Params *p)
+    : BlockedBloomHitSet(p->target_size, p->get_fpp(), p->seed) {}
+
+  HitSet::Impl *clone() const override {
+    return new BlockedBloomHitSet(*this);
+  }
+
+  bool is_full() const override {
+    return count >= target_size;
+  }
+  void insert(const hobject_t& o) override {
+    uint64_t mask[WORDS_PER_BLOCK];
+    uint64_t *block = const_cast<uint64_t*>(get_block(o, mask));
+    for (unsigned i = 0; i < WORDS_PER_BLOCK; ++i) {
+      block[i] |= mask[i];
+    }
+    ++count;
+  }
+  bool contains(const hobject_t& o) const override {
+    uint64_t mask[WORDS_PER_BLOCK];
+    const uint64_t *block = get_block(o, mask);
+    uint64_t missing = 0;
+    for (unsigned i = 0; i < WORDS_PER_BLOCK; ++i) {
+      missing |= mask[i] & ~block[i];
+    }
+    return missing == 0;
+  }
+  unsigned insert_count() const override {
+    return count;
+  }
+  unsigned approx_unique_insert_count() const override;
+
+  void encode(ceph::buffer::list &bl) const override {
+    ENCODE_START(1, 1, bl);
+    encode(target_size, bl);
+    encode(seed, bl);
+    encode(count, bl);
+    encode(bits, bl);
+    ENCODE_FINISH(bl);
+  }
+  void decode(ceph::buffer::list::const_iterator& bl) override {
+    DECODE_START(1, bl);
+    decode(target_size, bl);
+    decode(seed, bl);
+    decode(count, bl);
+    decode(bits, bl);
+    DECODE_FINISH(bl);
+    if (bits.empty() || bits.size() % WORDS_PER_BLOCK) {
+      throw ceph::buffer::malformed_input("bad blocked bloom hitset size");
+    }
+  }
+  void dump(ceph::Formatter *f) const override;
+  static void generate_test_instances(std::list<BlockedBloomHitSet*>& o) {
+    o.push_back(new BlockedBloomHitSet(1, .1, 0));
+    o.push_back(new BlockedBloomHitSet(10, .1, 1));
+    o.back()->insert(hobject_t());
+    o.back()->insert(hobject_t("asdf", "", CEPH_NOSNAP, 123, 1, ""));
+    o.back()->insert(hobject_t("qwer", "", CEPH_NOSNAP, 456, 1, ""));
+  }
+};
+WRITE_CLASS_ENCODER(BlockedBloomHitSet)
+
 #endif
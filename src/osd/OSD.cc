@@ -19,6 +19,7 @@
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <thread>
 
 #include <unistd.h>
 #include <sys/stat.h>
@@ -257,6 +258,7 @@ OSDService::OSDService(OSD *osd, ceph::async::io_context_pool& poolctx) :
   monc(osd->monc),
   osd_max_object_size(cct->_conf, "osd_max_object_size"),
   osd_skip_data_digest(cct->_conf, "osd_skip_data_digest"),
+  read_cache(std::make_shared<ReadCache>()),
   publish_lock{ceph::make_mutex("OSDService::publish_lock")},
   pre_publish_lock{ceph::make_mutex("OSDService::pre_publish_lock")},
   m_scrub_queue{cct, *this},
@@ -297,6 +299,7 @@ OSDService::OSDService(OSD *osd, ceph::async::io_context_pool& poolctx) :
   boot_epoch(0), up_epoch(0), bind_epoch(0)
 {
   objecter->init();
+  read_cache->set_max_bytes(cct->_conf->osd_read_cache_size);
 
   for (int i = 0; i < m_objecter_finishers; i++) {
     ostringstream str;
@@ -1502,6 +1505,10 @@ bool OSDService::_get_map_bl(epoch_t e, bufferlist& bl)
     return true;
   }
   logger->inc(l_osd_map_bl_cache_miss);
+  if (shared_map_store && shared_map_store->read(e, &bl)) {
+    map_bl_cache.add(e, bl);
+    return true;
+  }
   found = store->read(meta_ch,
 		      OSD::get_osdmap_pobject_name(e), 0, 0, bl,
 		      CEPH_OSD_OP_FLAG_FADVISE_WILLNEED) >= 0;
@@ -1542,6 +1549,17 @@ void OSDService::_add_map_bl(epoch_t e, bufferlist& bl)
   if (bl.get_num_buffers() > 1) {
     bl.rebuild();
   }
+  if (shared_map_store) {
+    // publish the map, and cache the shared copy rather than our own
+    bufferlist mapped;
+    if (shared_map_store->write(e, bl) == 0 &&
+	shared_map_store->read(e, &mapped) &&
+	mapped.contents_equal(bl)) {
+      bl = std::move(mapped);
+      map_bl_cache.add(e, bl);
+      return;
+    }
+  }
   bl.try_assign_to_mempool(mempool::mempool_osd_mapbl);
   map_bl_cache.add(e, bl);
 }
@@ -1633,6 +1651,7 @@ void OSDService::reply_op_error(OpRequestRef op, int err, eversion_t v,
   reply->set_reply_versions(v, uv);
   reply->set_op_returns(op_returns);
   m->get_connection()->send_message(reply);
+  tracing::osd::maybe_trace_finished_op(cct, *op, err);
 }
 
 void OSDService::handle_misdirected_op(PG *pg, OpRequestRef op)
@@ -2384,6 +2403,7 @@ OSD::OSD(CephContext *cct_,
                                            cct->_conf->osd_op_history_duration);
   op_tracker.set_history_slow_op_size_and_threshold(cct->_conf->osd_op_history_slow_op_size,
                                                     cct->_conf->osd_op_history_slow_op_threshold);
+  op_tracker.set_sample_rate(cct->_conf->osd_op_tracker_sample_rate);
   ObjectCleanRegions::set_max_num_intervals(cct->_conf->osd_object_clean_region_max_num_intervals);
 #ifdef WITH_BLKIN
   std::stringstream ss;
@@ -2522,10 +2542,58 @@ int OSD::set_numa_affinity()
     }
   } else {
     dout(1) << __func__ << " not setting numa affinity" << dendl;
+    set_shard_numa_affinity();
   }
   return 0;
 }
 
+void OSD::set_shard_numa_affinity()
+{
+  if (!cct->_conf.get_val<bool>("osd_numa_shard_affinity")) {
+    return;
+  }
+  vector<std::pair<size_t, cpu_set_t>> node_cpus;
+  while (true) {
+    size_t cpu_set_size = 0;
+    cpu_set_t cpu_set;
+    if (get_numa_node_cpu_set(node_cpus.size(), &cpu_set_size, &cpu_set) < 0) {
+      break;
+    }
+    node_cpus.emplace_back(cpu_set_size, cpu_set);
+  }
+  if (node_cpus.size() < 2) {
+    dout(1) << __func__ << " found " << node_cpus.size()
+	    << " numa nodes, not spreading shards" << dendl;
+    return;
+  }
+  // op shard i serves pgs with ps % num_shards == i, so each of its
+  // cache shards follows it as long as the cache shard count is a multiple
+  size_t num_cache_shards = get_num_cache_shards();
+  bool pin_caches = num_cache_shards % num_shards == 0;
+  if (!pin_caches) {
+    dout(1) << __func__ << " " << num_cache_shards
+	    << " cache shards are not a multiple of " << num_shards
+	    << " op shards, not assigning cache numa nodes" << dendl;
+  }
+  for (auto& sdata : shards) {
+    int node = sdata->shard_id % node_cpus.size();
+    sdata->numa_cpu_set_size = node_cpus[node].first;
+    sdata->numa_cpu_set = node_cpus[node].second;
+    sdata->numa_node = node;
+    dout(1) << __func__ << " shard " << sdata->shard_id << " numa node "
+	    << node << " cpus "
+	    << cpu_set_to_str_list(sdata->numa_cpu_set_size,
+				   &sdata->numa_cpu_set)
+	    << dendl;
+  }
+  if (pin_caches) {
+    for (size_t i = 0; i < num_cache_shards; ++i) {
+      store->set_cache_shard_numa_node(
+	i, shards[i % num_shards]->numa_node);
+    }
+  }
+}
+
 // asok
 
 class OSDSocketHook : public AdminSocketHook {
@@ -3569,12 +3637,63 @@ float OSD::get_osd_delete_sleep()
 
 int OSD::get_recovery_max_active()
 {
+  int max;
   if (cct->_conf->osd_recovery_max_active)
-    return cct->_conf->osd_recovery_max_active;
-  if (store_is_rotational)
-    return cct->_conf->osd_recovery_max_active_hdd;
+    max = cct->_conf->osd_recovery_max_active;
+  else if (store_is_rotational)
+    max = cct->_conf->osd_recovery_max_active_hdd;
   else
-    return cct->_conf->osd_recovery_max_active_ssd;
+    max = cct->_conf->osd_recovery_max_active_ssd;
+  if (service.recovery_memory) {
+    max = std::max<int>(1, max * service.recovery_memory->get_scale());
+  }
+  return max;
+}
+
+void OSD::register_memory_consumers()
+{
+  using PriorityCache::Consumer;
+  // the log entries of all PGs; trimmed to fewer entries per PG when told to
+  // shrink, but never below osd_min_pg_log_entries
+  auto pglog = std::make_shared<Consumer>(
+    "osd_pglog", PriorityCache::Priority::PRI2,
+    [this] {
+      auto target = cct->_conf->osd_target_pg_log_entries_per_osd;
+      auto floor = (double)cct->_conf->osd_min_pg_log_entries * get_num_pgs();
+      service.pglog_memory->set_min_scale(target ? floor / target : 1.0);
+      return mempool::osd_pglog::allocated_bytes();
+    });
+  // decoded and encoded past maps
+  auto osdmap = std::make_shared<Consumer>(
+    "osd_osdmap", PriorityCache::Priority::PRI2,
+    [this] {
+      auto size = std::max<int64_t>(cct->_conf->osd_map_cache_size, 1);
+      auto floor = cct->_conf->osd_pg_epoch_persisted_max_stale + 2;
+      service.osdmap_memory->set_min_scale((double)floor / size);
+      return mempool::osdmap::allocated_bytes() +
+	mempool::osd_mapbl::allocated_bytes();
+    },
+    [this](double scale) {
+      service.set_map_cache_size(service.get_map_cache_size());
+    });
+  // objects being pushed or pulled, at most one chunk each
+  auto recovery = std::make_shared<Consumer>(
+    "osd_recovery", PriorityCache::Priority::PRI3,
+    [this] {
+      return service.get_recovery_ops_active() *
+	cct->_conf->osd_recovery_max_chunk;
+    });
+  service.pglog_memory = pglog;
+  service.osdmap_memory = osdmap;
+  service.recovery_memory = recovery;
+  if (!store->register_priority_cache("osd_pglog", pglog) ||
+      !store->register_priority_cache("osd_osdmap", osdmap) ||
+      !store->register_priority_cache("osd_recovery", recovery)) {
+    dout(2) << __func__ << " store does not autotune its memory" << dendl;
+    return;
+  }
+  dout(2) << __func__ << " pg log, osdmap cache and recovery are sized by"
+	  << " the store's cache autotuning" << dendl;
 }
 
 float OSD::get_osd_snap_trim_sleep()
@@ -3631,6 +3750,12 @@ int OSD::init()
   journal_is_rotational = store->is_journal_rotational();
   dout(2) << "journal looks like " << (journal_is_rotational ? "hdd" : "ssd")
           << dendl;
+  if (store->register_priority_cache("osd_read", service.read_cache)) {
+    dout(2) << "read cache is sized by the store's cache autotuning" << dendl;
+  }
+  if (cct->_conf.get_val<bool>("osd_memory_autotune_consumers")) {
+    register_memory_consumers();
+  }
 
   enable_disable_fuse(false);
 
@@ -3685,6 +3810,18 @@ int OSD::init()
     goto out;
   }
 
+  if (!cct->_conf->osd_map_shared_cache_path.empty()) {
+    service.shared_map_store = std::make_unique<OSDMapSharedStore>(
+      cct, cct->_conf->osd_map_shared_cache_path, superblock.cluster_fsid);
+    int sr = service.shared_map_store->init();
+    if (sr < 0) {
+      derr << "OSD::init() : unable to use osd_map_shared_cache_path "
+	   << cct->_conf->osd_map_shared_cache_path << ": "
+	   << cpp_strerror(sr) << dendl;
+      service.shared_map_store.reset();
+    }
+  }
+
   if (osd_compat.compare(superblock.compat_features) < 0) {
     derr << "The disk uses features unsupported by the executable." << dendl;
     derr << " ondisk features " << superblock.compat_features << dendl;
@@ -5088,7 +5225,9 @@ void OSD::load_pgs()
     derr << "failed to list pgs: " << cpp_strerror(-r) << dendl;
   }
 
-  int num = 0;
+  // pgs are instantiated here, and their state is read below, possibly
+  // from several threads since that's where the time goes
+  vector<pair<PGRef, coll_t>> loading;
   for (vector<coll_t>::iterator it = ls.begin();
        it != ls.end();
        ++it) {
@@ -5141,20 +5280,52 @@ void OSD::load_pgs()
       recursive_remove_collection(cct, store.get(), pgid, *it);
       continue;
     }
+    loading.emplace_back(pg, *it);
+  }
 
-    // there can be no waiters here, so we don't call _wake_pg_slot
-
+  // read pg state, log
+  auto read_state = [this](PG *pg) {
     pg->lock();
     pg->ch = store->open_collection(pg->coll);
-
-    // read pg state, log
     pg->read_state(store.get());
+    pg->unlock();
+  };
+  unsigned num_threads = std::min<size_t>(
+    std::max<int64_t>(cct->_conf->osd_load_pgs_threads, 1), loading.size());
+  if (num_threads <= 1) {
+    for (auto& [pg, coll] : loading) {
+      read_state(pg.get());
+    }
+  } else {
+    dout(10) << __func__ << " reading state of " << loading.size()
+	     << " pgs with " << num_threads << " threads" << dendl;
+    std::atomic<size_t> next = {0};
+    vector<std::thread> threads;
+    for (unsigned i = 0; i < num_threads; ++i) {
+      threads.emplace_back([&] {
+	ceph_pthread_setname(pthread_self(), "load_pgs");
+	for (size_t j = next++; j < loading.size(); j = next++) {
+	  read_state(loading[j].first.get());
+	}
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+  int num = 0;
+  for (auto& [pg, coll] : loading) {
+    spg_t pgid = pg->get_pgid();
+
+    // there can be no waiters here, so we don't call _wake_pg_slot
 
+    pg->lock();
     if (pg->dne())  {
-      dout(10) << "load_pgs " << *it << " deleting dne" << dendl;
+      dout(10) << "load_pgs " << coll << " deleting dne" << dendl;
       pg->ch = nullptr;
       pg->unlock();
-      recursive_remove_collection(cct, store.get(), pgid, *it);
+      recursive_remove_collection(cct, store.get(), pgid, coll);
       continue;
     }
     {
@@ -5463,20 +5634,6 @@ void OSD::maybe_update_heartbeat_peers()
 
   dout(10) << "maybe_update_heartbeat_peers updating" << dendl;
 
-
-  // build heartbeat from set
-  if (is_active()) {
-    vector<PGRef> pgs;
-    _get_pgs(&pgs);
-    for (auto& pg : pgs) {
-      pg->with_heartbeat_peers([&](int peer) {
-	  if (get_osdmap()->is_up(peer)) {
-	    _add_heartbeat_peer(peer);
-	  }
-	});
-    }
-  }
-
   // include next and previous up osds to ensure we have a fully-connected set
   set<int> want, extras;
   const int next = get_osdmap()->get_next_up_osd_after(whoami);
@@ -5494,6 +5651,29 @@ void OSD::maybe_update_heartbeat_peers()
   get_osdmap()->get_random_up_osds_by_subtree(
     whoami, subtree, limit, want, &want);
 
+  // build heartbeat from set
+  if (is_active()) {
+    set<int> pg_peers;
+    vector<PGRef> pgs;
+    _get_pgs(&pgs);
+    for (auto& pg : pgs) {
+      pg->with_heartbeat_peers([&](int peer) {
+	  if (get_osdmap()->is_up(peer) && !want.count(peer)) {
+	    pg_peers.insert(peer);
+	  }
+	});
+    }
+    int64_t max_peers = cct->_conf->osd_heartbeat_max_peers;
+    if (max_peers > 0) {
+      max_peers = std::max(max_peers, cct->_conf->osd_heartbeat_min_peers);
+      _pick_heartbeat_pg_peers(
+	std::max<int64_t>(max_peers - (int64_t)want.size(), 0), &pg_peers);
+    }
+    for (int peer : pg_peers) {
+      _add_heartbeat_peer(peer);
+    }
+  }
+
   for (set<int>::iterator p = want.begin(); p != want.end(); ++p) {
     dout(10) << " adding neighbor peer osd." << *p << dendl;
     extras.insert(*p);
@@ -5551,6 +5731,29 @@ void OSD::maybe_update_heartbeat_peers()
   }
 }
 
+void OSD::_pick_heartbeat_pg_peers(unsigned max, set<int> *pg_peers)
+{
+  if (pg_peers->size() <= max) {
+    return;
+  }
+  // keep the peers we already ping, so that the same ones are picked on
+  // every update instead of reconnecting to a new random set
+  vector<int> current, others;
+  for (int peer : *pg_peers) {
+    (heartbeat_peers.count(peer) ? current : others).push_back(peer);
+  }
+  std::mt19937 rng{std::random_device{}()};
+  std::shuffle(current.begin(), current.end(), rng);
+  std::shuffle(others.begin(), others.end(), rng);
+  pg_peers->clear();
+  for (auto v : {&current, &others}) {
+    for (auto p = v->begin(); p != v->end() && pg_peers->size() < max; ++p) {
+      pg_peers->insert(*p);
+    }
+  }
+  dout(10) << __func__ << " capped pg peers to " << *pg_peers << dendl;
+}
+
 void OSD::reset_heartbeat_peers(bool all)
 {
   ceph_assert(ceph_mutex_is_locked(osd_lock));
@@ -5583,6 +5786,8 @@ void OSD::handle_osd_ping(MOSDPing *m)
   }
 
   int from = m->get_source().num();
+  logger->inc(l_osd_hb_rx_bytes, m->get_payload().length() +
+	      m->get_middle().length() + m->get_data().length());
 
   heartbeat_lock.lock();
   if (is_stopping()) {
@@ -5996,6 +6201,7 @@ void OSD::heartbeat()
 {
   ceph_assert(ceph_mutex_is_locked_by_me(heartbeat_lock));
   dout(30) << "heartbeat" << dendl;
+  auto start = ceph::mono_clock::now();
 
   auto load_for_logger = service.get_scrub_services().update_load_average();
   if (load_for_logger) {
@@ -6069,9 +6275,11 @@ void OSD::heartbeat()
 		     service.get_up_epoch(),
 		     cct->_conf->osd_heartbeat_min_size,
 		     delta_ub));
+    logger->inc(l_osd_hb_pings, i->second.con_front ? 2 : 1);
   }
 
   logger->set(l_osd_hb_to, heartbeat_peers.size());
+  logger->tinc(l_osd_hb_lat, ceph::mono_clock::now() - start);
 
   // hmm.. am i all alone?
   dout(30) << "heartbeat lonely?" << dendl;
@@ -7041,6 +7249,9 @@ void OSD::send_failures()
   std::lock_guard l(heartbeat_lock);
   utime_t now = ceph_clock_now();
   const auto osdmap = get_osdmap();
+  if (_hold_failure_reports(now)) {
+    return;
+  }
   while (!failure_queue.empty()) {
     int osd = failure_queue.begin()->first;
     if (!failure_pending.count(osd)) {
@@ -7054,11 +7265,40 @@ void OSD::send_failures()
 	  osdmap->get_epoch()));
       failure_pending[osd] = make_pair(failure_queue.begin()->second,
 				       osdmap->get_addrs(osd));
+      logger->inc(l_osd_hb_failures_sent);
     }
     failure_queue.erase(osd);
   }
 }
 
+bool OSD::_hold_failure_reports(utime_t now)
+{
+  ceph_assert(ceph_mutex_is_locked(heartbeat_lock));
+  double ratio = cct->_conf->osd_heartbeat_failure_hold_ratio;
+  size_t failed = failure_queue.size() + failure_pending.size();
+  if (ratio <= 0 ||
+      failure_queue.empty() ||
+      heartbeat_peers.size() < (size_t)cct->_conf->osd_heartbeat_min_peers ||
+      failed <= ratio * heartbeat_peers.size()) {
+    failure_hold_start = utime_t();
+    return false;
+  }
+  // most of our peers look dead at once: more likely we are the ones cut
+  // off, and the mon hears about it from our peers anyway.  don't flood it
+  // with reports about everybody else unless this persists.
+  if (failure_hold_start == utime_t()) {
+    failure_hold_start = now;
+    derr << __func__ << " " << failed << " of " << heartbeat_peers.size()
+	 << " heartbeat peers failed, holding failure reports for up to "
+	 << cct->_conf->osd_heartbeat_grace << " seconds" << dendl;
+    logger->inc(l_osd_hb_failures_held);
+  }
+  if (now - failure_hold_start < cct->_conf->osd_heartbeat_grace) {
+    return true;
+  }
+  return false;
+}
+
 void OSD::send_still_alive(epoch_t epoch, int osd, const entity_addrvec_t &addrs)
 {
   MOSDFailure *m = new MOSDFailure(monc->get_fsid(), osd, addrs, 0, epoch,
@@ -7324,6 +7564,28 @@ void OSDService::maybe_share_map(
   send_incremental_map(send_from, con, osdmap);
 }
 
+void OSDService::share_map_fanout(const OSDMapRef& osdmap, epoch_t since)
+{
+  auto fanout = cct->_conf.get_val<uint64_t>("osd_map_fanout");
+  if (!fanout) {
+    return;
+  }
+  std::vector<int> children;
+  osdmap->get_map_fanout_children(whoami, fanout, &children);
+  for (int peer : children) {
+    dout(10) << __func__ << " " << since << " -> " << osdmap->get_epoch()
+	     << " to osd." << peer << dendl;
+    ConnectionRef con = osd->cluster_messenger->connect_to_osd(
+      osdmap->get_cluster_addrs(peer), false, true);
+    if (con->get_priv()) {
+      // don't resend what the session says they already have
+      maybe_share_map(con.get(), osdmap, since);
+    } else {
+      send_incremental_map(since, con.get(), osdmap);
+    }
+  }
+}
+
 void OSD::dispatch_session_waiting(const ceph::ref_t<Session>& session, OSDMapRef osdmap)
 {
   ceph_assert(ceph_mutex_is_locked(session->session_dispatch_lock));
@@ -7416,7 +7678,11 @@ void OSD::ms_fast_dispatch(Message *m)
     tracepoint(osd, ms_fast_dispatch, reqid.name._type,
         reqid.name._num, reqid.tid, reqid.inc);
   }
-  op->osd_parent_span = tracing::osd::tracer.start_trace("op-request-created");
+  // with tail sampling, only ops that turn out slow or failed get traced,
+  // once they are done
+  op->osd_parent_span = tracing::osd::tracer.start_trace(
+    "op-request-created",
+    tracing::osd::tracer.is_enabled() && !cct->_conf->osd_tracing_tail_sampling);
 
   if (m->trace)
     op->osd_trace.init("osd op", &trace_endpoint, &m->trace);
@@ -7919,6 +8185,10 @@ void OSD::trim_maps(epoch_t oldest, int nreceived, bool skip_maps)
     int tr = store->queue_transaction(service.meta_ch, std::move(t), nullptr);
     ceph_assert(tr == 0);
   }
+  if (service.shared_map_store) {
+    // maps still mapped by other daemons stay valid until they drop them
+    service.shared_map_store->trim(superblock.oldest_map);
+  }
   // we should not remove the cached maps
   ceph_assert(min <= service.map_cache.cached_key_lower_bound());
 }
@@ -8155,6 +8425,16 @@ void OSD::handle_osd_map(MOSDMap *m)
   // even if this map isn't from a mon, we may have satisfied our subscription
   monc->sub_got("osdmap", last);
 
+  if (cct->_conf->osd_map_catchup_prefetch &&
+      m->get_source().is_mon() &&
+      m->newest_map > last + cct->_conf->osd_map_message_max) {
+    // far behind: ask for the next batch now, so that it is on its way
+    // while this one is committed and consumed, instead of afterwards
+    dout(10) << __func__ << " newest map is " << m->newest_map
+	     << ", prefetching from " << last + 1 << dendl;
+    osdmap_subscribe(last + 1, false);
+  }
+
   if (!m->maps.empty() && requested_full_first) {
     dout(10) << __func__ << " still missing full maps " << requested_full_first
 	     << ".." << requested_full_last << dendl;
@@ -8492,6 +8772,10 @@ void OSD::_committed_osd_maps(epoch_t first, epoch_t last, MOSDMap *m)
 
   if (is_active()) {
     activate_map();
+    if (!m->newest_map || m->newest_map <= last) {
+      // we are current; pass the new epochs down the tree
+      service.share_map_fanout(osdmap, first - 1);
+    }
   }
 
   if (do_shutdown) {
@@ -9386,10 +9670,23 @@ bool OSDService::_recover_now(uint64_t *available_pushes)
   return true;
 }
 
+unsigned OSDService::get_map_cache_size() const
+{
+  unsigned size = cct->_conf->osd_map_cache_size;
+  if (osdmap_memory) {
+    size = std::max<unsigned>(size * osdmap_memory->get_scale(),
+			      cct->_conf->osd_pg_epoch_persisted_max_stale + 2);
+  }
+  return std::min<unsigned>(size, cct->_conf->osd_map_cache_size);
+}
+
 unsigned OSDService::get_target_pg_log_entries() const
 {
   auto num_pgs = osd->get_num_pgs();
-  auto target = cct->_conf->osd_target_pg_log_entries_per_osd;
+  uint64_t target = cct->_conf->osd_target_pg_log_entries_per_osd;
+  if (pglog_memory) {
+    target *= pglog_memory->get_scale();
+  }
   if (num_pgs > 0 && target > 0) {
     // target an even spread of our budgeted log entries across all
     // PGs.  note that while we only get to control the entry count
@@ -9721,6 +10018,8 @@ const char** OSD::get_tracked_conf_keys() const
     "osd_op_history_slow_op_size",
     "osd_op_history_slow_op_threshold",
     "osd_enable_op_tracker",
+    "osd_op_tracker_sample_rate",
+    "osd_read_cache_size",
     "osd_map_cache_size",
     "osd_pg_epoch_max_lag_factor",
     "osd_pg_epoch_persisted_max_stale",
@@ -9825,10 +10124,14 @@ void OSD::handle_conf_change(const ConfigProxy& conf,
   if (changed.count("osd_enable_op_tracker")) {
       op_tracker.set_tracking(cct->_conf->osd_enable_op_tracker);
   }
+  if (changed.count("osd_op_tracker_sample_rate")) {
+    op_tracker.set_sample_rate(cct->_conf->osd_op_tracker_sample_rate);
+  }
+  if (changed.count("osd_read_cache_size")) {
+    service.read_cache->set_max_bytes(cct->_conf->osd_read_cache_size);
+  }
   if (changed.count("osd_map_cache_size")) {
-    service.map_cache.set_size(cct->_conf->osd_map_cache_size);
-    service.map_bl_cache.set_size(cct->_conf->osd_map_cache_size);
-    service.map_bl_inc_cache.set_size(cct->_conf->osd_map_cache_size);
+    service.set_map_cache_size(service.get_map_cache_size());
   }
   if (changed.count("clog_to_monitors") ||
       changed.count("clog_to_syslog") ||
@@ -10277,13 +10580,14 @@ MetricPayload OSD::get_perf_reports() {
 
   std::vector<PGRef> pgs;
   _get_pgs(&pgs);
-  DynamicPerfStats dps;
+  auto max_keys = cct->_conf.get_val<uint64_t>("osd_perf_query_max_keys");
+  DynamicPerfStats dps(m_perf_queries, max_keys);
   for (auto& pg : pgs) {
     // m_perf_queries can be modified only in set_perf_queries by mgr client
     // request, and it is protected by by mgr client's lock, which is held
     // when set_perf_queries/get_perf_reports are called, so we may not hold
     // m_perf_queries_lock here.
-    DynamicPerfStats pg_dps(m_perf_queries);
+    DynamicPerfStats pg_dps(m_perf_queries, max_keys);
     pg->lock();
     pg->get_dynamic_perf_stats(&pg_dps);
     pg->unlock();
@@ -10766,20 +11070,73 @@ void OSD::ShardedOpWQ::_add_slot_waiter(
 #undef dout_prefix
 #define dout_prefix *_dout << "osd." << osd->whoami << " op_wq(" << shard_index << ") "
 
+OSDShard *OSD::ShardedOpWQ::_steal_shard(uint32_t shard_index)
+{
+  // only look at shards we can lock right away; a shard whose threads
+  // are waiting for a future (mclock) item has nothing ready to give
+  for (uint32_t i = 1; i < osd->num_shards; ++i) {
+    OSDShard *victim = osd->shards[(shard_index + i) % osd->num_shards];
+    if (!victim->shard_lock.try_lock()) {
+      continue;
+    }
+    if (!victim->scheduler->empty() && victim->waiting_threads == 0) {
+      return victim;
+    }
+    victim->shard_lock.unlock();
+  }
+  return nullptr;
+}
+
 void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
 {
   uint32_t shard_index = thread_index % osd->num_shards;
-  auto& sdata = osd->shards[shard_index];
+  OSDShard *sdata = osd->shards[shard_index];
   ceph_assert(sdata);
 
+  // follow the shard's numa node so that the pgs' cached onodes and
+  // buffers get allocated from, and hit in, node-local memory
+  static thread_local int pinned_numa_node = -1;
+  if (int node = sdata->numa_node; node >= 0 && node != pinned_numa_node) {
+    if (sched_setaffinity(0, sdata->numa_cpu_set_size,
+			  &sdata->numa_cpu_set) == 0) {
+      dout(10) << __func__ << " thread " << thread_index
+	       << " pinned to numa node " << node << dendl;
+    } else {
+      derr << __func__ << " thread " << thread_index
+	   << " failed to pin to numa node " << node << ": "
+	   << cpp_strerror(errno) << dendl;
+    }
+    pinned_numa_node = node;
+  }
+
   // If all threads of shards do oncommits, there is a out-of-order
   // problem.  So we choose the thread which has the smallest
   // thread_index(thread_index < num_shards) of shard to do oncommit
   // callback.
   bool is_smallest_thread_index = thread_index < osd->num_shards;
 
+  // With work stealing, a thread whose shard is idle serves the next item
+  // of a busy shard as if it were one of that shard's own threads: the
+  // item still goes through the owning shard's pg slot and the pg lock,
+  // so per-pg ordering is unaffected.  Oncommits stay with the owner.
+  bool stealing = osd->cct->_conf->osd_op_queue_work_stealing &&
+    osd->num_shards > 1;
+  bool stolen = false;
+
   // peek at spg_t
   sdata->shard_lock.lock();
+  if (stealing && sdata->scheduler->empty() &&
+      (!is_smallest_thread_index || sdata->context_queue.empty())) {
+    if (OSDShard *victim = _steal_shard(shard_index); victim) {
+      sdata->shard_lock.unlock();
+      sdata = victim;
+      stolen = true;
+      is_smallest_thread_index = false;
+      osd->logger->inc(l_osd_op_wq_steal);
+      dout(20) << __func__ << " thread " << thread_index
+	       << " stealing from shard " << sdata->shard_id << dendl;
+    }
+  }
   if (sdata->scheduler->empty() &&
       (!is_smallest_thread_index || sdata->context_queue.empty())) {
     std::unique_lock wait_lock{sdata->sdata_wait_lock};
@@ -10790,7 +11147,15 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
       dout(20) << __func__ << " empty q, waiting" << dendl;
       osd->cct->get_heartbeat_map()->clear_timeout(hb);
       sdata->shard_lock.unlock();
-      sdata->sdata_cond.wait(wait_lock);
+      if (stealing) {
+	// wake up now and then to look for work on the other shards
+	sdata->sdata_cond.wait_for(
+	  wait_lock,
+	  ceph::make_timespan(
+	    osd->cct->_conf->osd_op_queue_work_stealing_interval));
+      } else {
+	sdata->sdata_cond.wait(wait_lock);
+      }
       wait_lock.unlock();
       sdata->shard_lock.lock();
       if (sdata->scheduler->empty() &&
@@ -10843,6 +11208,12 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
     // If the work item is scheduled in the future, wait until
     // the time returned in the dequeue response before retrying.
     if (auto when_ready = std::get_if<double>(&work_item)) {
+      if (stolen) {
+	// nothing ready after all; leave the waiting to the owner's threads
+	sdata->shard_lock.unlock();
+	osd->logger->inc(l_osd_op_wq_steal_miss);
+	return;
+      }
       if (is_smallest_thread_index) {
         sdata->shard_lock.unlock();
         handle_oncommits(oncommits);
@@ -10964,6 +11335,29 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   auto qi = std::move(slot->to_process.front());
   slot->to_process.pop_front();
   dout(20) << __func__ << " " << qi << " pg " << pg << dendl;
+
+  // take the requests queued right behind it which can share its
+  // ObjectStore transaction; the threads which dequeued them find
+  // nothing queued once they get the pg lock
+  std::vector<OpRequestRef> batch;
+  if (pg && osd->cct->_conf->osd_op_batch_max > 1) {
+    std::set<hobject_t> names;
+    if (auto op = qi.maybe_get_op(); op && pg->can_batch_op(*op, &names)) {
+      batch.push_back(*op);
+      while (batch.size() < osd->cct->_conf->osd_op_batch_max &&
+	     !slot->to_process.empty()) {
+	auto next = slot->to_process.front().maybe_get_op();
+	if (!next || !pg->can_batch_op(*next, &names)) {
+	  break;
+	}
+	batch.push_back(*next);
+	slot->to_process.pop_front();
+      }
+      if (batch.size() == 1) {
+	batch.clear();
+      }
+    }
+  }
   set<pair<spg_t,epoch_t>> new_children;
   OSDMapRef osdmap;
 
@@ -11088,7 +11482,19 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   delete f;
   *_dout << dendl;
 
-  qi.run(osd, sdata, pg, tp_handle);
+  if (batch.empty()) {
+    qi.run(osd, sdata, pg, tp_handle);
+  } else {
+    dout(20) << __func__ << " " << token << " running " << batch.size()
+	     << " requests in one transaction" << dendl;
+    pg->start_txn_batch();
+    for (auto& op : batch) {
+      osd->dequeue_op(pg, op, tp_handle);
+    }
+    pg->flush_txn_batch();
+    pg->unlock();
+    osd->logger->inc(l_osd_op_batched, batch.size());
+  }
 
   {
 #ifdef WITH_LTTNG
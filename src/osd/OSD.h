@@ -36,6 +36,8 @@
 #include "include/common_fwd.h"
 
 #include "OpRequest.h"
+#include "OSDMapSharedStore.h"
+#include "ReadCache.h"
 #include "Session.h"
 
 #include "osd/scheduler/OpScheduler.h"
@@ -116,6 +118,13 @@ public:
   md_config_cacher_t<Option::size_t> osd_max_object_size;
   md_config_cacher_t<bool> osd_skip_data_digest;
 
+  /// results of small reads, shared by all PGs
+  std::shared_ptr<ReadCache> read_cache;
+  /// non-cache memory users sized by the store's cache autotuning, if any
+  std::shared_ptr<PriorityCache::Consumer> pglog_memory;
+  std::shared_ptr<PriorityCache::Consumer> osdmap_memory;
+  std::shared_ptr<PriorityCache::Consumer> recovery_memory;
+
   void enqueue_back(OpSchedulerItem&& qi);
   void enqueue_front(OpSchedulerItem&& qi);
 
@@ -209,6 +218,9 @@ public:
 		       const OSDMapRef& osdmap,
 		       epoch_t peer_epoch_lb=0);
 
+  /// push maps after @p since to our children in the osd_map_fanout tree
+  void share_map_fanout(const OSDMapRef& osdmap, epoch_t since);
+
   void send_map(class MOSDMap *m, Connection *con);
   void send_incremental_map(epoch_t since, Connection *con,
 			    const OSDMapRef& osdmap);
@@ -630,6 +642,10 @@ public:
     std::lock_guard l(recovery_lock);
     return recovery_paused;
   }
+  uint64_t get_recovery_ops_active() {
+    std::lock_guard l(recovery_lock);
+    return recovery_ops_active;
+  }
   void unpause_recovery() {
     std::lock_guard l(recovery_lock);
     recovery_paused = false;
@@ -682,10 +698,19 @@ public:
 			    ceph::signedspan delay = ceph::signedspan::zero());
 
   // osd map cache (past osd maps)
+  /// osd_map_cache_size, scaled down under memory pressure
+  unsigned get_map_cache_size() const;
+  void set_map_cache_size(unsigned size) {
+    map_cache.set_size(size);
+    map_bl_cache.set_size(size);
+    map_bl_inc_cache.set_size(size);
+  }
   ceph::mutex map_cache_lock = ceph::make_mutex("OSDService::map_cache_lock");
   SharedLRU<epoch_t, const OSDMap> map_cache;
   SimpleLRU<epoch_t, ceph::buffer::list> map_bl_cache;
   SimpleLRU<epoch_t, ceph::buffer::list> map_bl_inc_cache;
+  /// full maps shared with the other daemons of the host, if enabled
+  std::unique_ptr<OSDMapSharedStore> shared_map_store;
 
   OSDMapRef try_get_map(epoch_t e);
   OSDMapRef get_map(epoch_t e) {
@@ -976,6 +1001,12 @@ struct OSDShard {
 
   std::string shard_name;
 
+  /// numa node this shard's threads are pinned to (-1 for none); see
+  /// OSD::set_numa_affinity().  cpu set is written before the node.
+  std::atomic<int> numa_node = {-1};
+  size_t numa_cpu_set_size = 0;
+  cpu_set_t numa_cpu_set;
+
   std::string sdata_wait_lock_name;
   ceph::mutex sdata_wait_lock;
   ceph::condition_variable sdata_cond;
@@ -1466,6 +1497,8 @@ private:
   void _remove_heartbeat_peer(int p);
   bool heartbeat_reset(Connection *con);
   void maybe_update_heartbeat_peers();
+  /// trim @pg_peers down to @max, preferring peers we already ping
+  void _pick_heartbeat_pg_peers(unsigned max, std::set<int> *pg_peers);
   void reset_heartbeat_peers(bool all);
   bool heartbeat_peers_need_update() {
     return heartbeat_need_update.load();
@@ -1590,6 +1623,9 @@ protected:
     /// try to do some work
     void _process(uint32_t thread_index, ceph::heartbeat_handle_d *hb) override;
 
+    /// find another shard with queued work; returns it with shard_lock held
+    OSDShard *_steal_shard(uint32_t shard_index);
+
     void stop_for_fast_shutdown();
 
     /// enqueue a new item
@@ -1836,9 +1872,12 @@ protected:
   // -- failures --
   std::map<int,utime_t> failure_queue;
   std::map<int,std::pair<utime_t,entity_addrvec_t> > failure_pending;
+  utime_t failure_hold_start;  ///< since when reports are held back
 
   void requeue_failures();
   void send_failures();
+  /// true if too many peers failed at once to trust our own view
+  bool _hold_failure_reports(utime_t now);
   void send_still_alive(epoch_t epoch, int osd, const entity_addrvec_t &addrs);
   void cancel_pending_failures();
 
@@ -2009,6 +2048,9 @@ private:
   float get_osd_snap_trim_sleep();
 
   int get_recovery_max_active();
+  /// register pg logs, osdmap caches and recovery with the store's cache
+  /// autotuning, see osd_memory_autotune_consumers
+  void register_memory_consumers();
   void maybe_override_max_osd_capacity_for_qos();
   void maybe_override_sleep_options_for_qos();
   bool maybe_override_options_for_qos(
@@ -2042,6 +2084,7 @@ public:
 
   int enable_disable_fuse(bool stop);
   int set_numa_affinity();
+  void set_shard_numa_affinity();
 
   void suicide(int exitcode);
   int shutdown();
@@ -1644,6 +1644,36 @@ void OSDMap::get_up_osds(set<int32_t>& ls) const
   }
 }
 
+void OSDMap::get_map_fanout_roots(unsigned fanout, vector<int>* roots) const
+{
+  roots->clear();
+  for (int i = 0; i < max_osd && roots->size() < fanout; i++) {
+    if (is_up(i))
+      roots->push_back(i);
+  }
+}
+
+void OSDMap::get_map_fanout_children(int osd, unsigned fanout,
+				     vector<int>* children) const
+{
+  children->clear();
+  if (!fanout || !is_up(osd))
+    return;
+  unsigned index = 0;  // among up osds
+  for (int i = 0; i < osd; i++) {
+    if (is_up(i))
+      index++;
+  }
+  uint64_t first = (uint64_t)fanout * (index + 1);
+  uint64_t last = first + fanout;
+  for (int i = osd + 1; i < max_osd && index + 1 < last; i++) {
+    if (!is_up(i))
+      continue;
+    if (++index >= first)
+      children->push_back(i);
+  }
+}
+
 void OSDMap::get_out_existing_osds(set<int32_t>& ls) const
 {
   for (int i = 0; i < max_osd; i++) {
@@ -2136,7 +2166,7 @@ bool OSDMap::check_pg_upmaps(
     auto j = pg_upmap_items.find(pg);
     if (j != pg_upmap_items.end()) {
       mempool::osdmap::vector<pair<int,int>> newmap;
-      for (auto& p : j->second) {
+      for (auto p : j->second) {
 	auto osd_from = p.first;
 	auto osd_to = p.second;
         if (std::find(raw.begin(), raw.end(), osd_from) == raw.end()) {
@@ -2436,7 +2466,7 @@ int OSDMap::apply_incremental(const Incremental &inc)
     pg_upmap.erase(pg);
   }
   for (auto& p : inc.new_pg_upmap_items) {
-    pg_upmap_items[p.first] = p.second;
+    pg_upmap_items.set(p.first, p.second);
   }
   for (auto& pg : inc.old_pg_upmap_items) {
     pg_upmap_items.erase(pg);
@@ -2686,7 +2716,7 @@ void OSDMap::_apply_upmap(const pg_pool_t& pi, pg_t raw_pg, vector<int> *raw) co
   if (q != pg_upmap_items.end()) {
     // NOTE: this approach does not allow a bidirectional swap,
     // e.g., [[1,2],[2,1]] applied to [0,1,2] -> [0,2,1].
-    for (auto& [osd_from, osd_to] : q->second) {
+    for (auto [osd_from, osd_to] : q->second) {
       // A capcaity change upmap (repace osd in the pg with osd not in the pg)
       // make sure the replacement value doesn't already appear
       bool exists = false;
@@ -2938,6 +2968,48 @@ void OSDMap::_pg_to_up_acting_osds(
     *acting_primary = _acting_primary;
 }
 
+void OSDMap::pool_pgs_to_up_acting_osds(
+  int64_t pool, unsigned ps_begin, unsigned ps_end,
+  const std::function<void(pg_t pgid,
+			   vector<int>& up, int up_primary,
+			   vector<int>& acting, int acting_primary)>& f) const
+{
+  const pg_pool_t *pi = get_pg_pool(pool);
+  ceph_assert(pi);
+  ceph_assert(ps_begin <= ps_end);
+  vector<int> pps;
+  pps.reserve(ps_end - ps_begin);
+  for (unsigned ps = ps_begin; ps < ps_end; ++ps) {
+    pps.push_back(pi->raw_pg_to_pps(pg_t(ps, pool)));
+  }
+  vector<vector<int>> raws;
+  int ruleno = pi->get_crush_rule();
+  if (ruleno >= 0) {
+    crush->do_rule_batch(ruleno, pps, &raws, pi->get_size(), osd_weight, pool);
+  } else {
+    raws.resize(pps.size());
+  }
+  for (unsigned i = 0; i < pps.size(); ++i) {
+    pg_t pg(ps_begin + i, pool);
+    auto& raw = raws[i];
+    _remove_nonexistent_osds(*pi, raw);
+    vector<int> up, acting;
+    int up_primary, acting_primary;
+    _get_temp_osds(*pi, pg, &acting, &acting_primary);
+    _apply_upmap(*pi, pg, &raw);
+    _raw_to_up_osds(*pi, raw, &up);
+    up_primary = _pick_primary(up);
+    _apply_primary_affinity(pps[i], *pi, &up, &up_primary);
+    if (acting.empty()) {
+      acting = up;
+      if (acting_primary == -1) {
+	acting_primary = up_primary;
+      }
+    }
+    f(pg, up, up_primary, acting, acting_primary);
+  }
+}
+
 int OSDMap::calc_pg_role_broken(int osd, const vector<int>& acting, int nrep)
 {
   // This implementation is broken for EC PGs since the osd may appear
@@ -3920,7 +3992,7 @@ void OSDMap::dump(Formatter *f, CephContext *cct) const
     f->open_object_section("mapping");
     f->dump_stream("pgid") << pgid;
     f->open_array_section("mappings");
-    for (auto& [from, to] : mappings) {
+    for (auto [from, to] : mappings) {
       f->open_object_section("mapping");
       f->dump_int("from", from);
       f->dump_int("to", to);
@@ -5714,7 +5786,7 @@ int OSDMap::pack_upmap_results(
     ldout(cct, 10) << " upmap pg " << pg
                    << " new pg_upmap_items " << um_items
                    << dendl;
-    tmp_osd_map.pg_upmap_items[pg] = um_items;
+    tmp_osd_map.pg_upmap_items.set(pg, um_items);
     pending_inc->new_pg_upmap_items[pg] = um_items;
     ++num_changed;
   }
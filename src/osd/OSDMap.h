@@ -29,6 +29,7 @@
 #include <set>
 #include <map>
 #include <memory>
+#include <functional>
 
 #include <boost/smart_ptr/local_shared_ptr.hpp>
 #include "include/btree_map.h"
@@ -345,6 +346,192 @@ struct PGTempMap {
 };
 WRITE_CLASS_ENCODER(PGTempMap)
 
+/**
+ * PGUpmapItemsMap
+ *
+ * pg_upmap_items, kept like PGTempMap in its encoded form: decoding
+ * indexes the items of each pg in the encoded buffer instead of building
+ * a vector per pg, which matters with hundreds of thousands of entries.
+ * Lookups and iteration return a view of the encoded items.
+ */
+struct PGUpmapItemsMap {
+  typedef mempool::osdmap::vector<std::pair<int32_t,int32_t>> items_t;
+
+  /// the encoded items of a pg: a count followed by (from, to) pairs
+  class items_view {
+    const ceph_le32 *p;
+  public:
+    class iterator {
+      const ceph_le32 *p;
+    public:
+      explicit iterator(const ceph_le32 *p) : p(p) {}
+      std::pair<int32_t,int32_t> operator*() const {
+	return std::make_pair((int32_t)p[0], (int32_t)p[1]);
+      }
+      friend bool operator==(const iterator& l, const iterator& r) {
+	return l.p == r.p;
+      }
+      friend bool operator!=(const iterator& l, const iterator& r) {
+	return l.p != r.p;
+      }
+      iterator& operator++() {
+	p += 2;
+	return *this;
+      }
+    };
+
+    items_view() : p(nullptr) {}
+    explicit items_view(const ceph_le32 *p) : p(p) {}
+    size_t size() const {
+      return *p;
+    }
+    bool empty() const {
+      return size() == 0;
+    }
+    iterator begin() const {
+      return iterator(p + 1);
+    }
+    iterator end() const {
+      return iterator(p + 1 + 2 * size());
+    }
+    items_t to_vector() const {
+      items_t v;
+      v.reserve(size());
+      for (auto i : *this) {
+	v.push_back(i);
+      }
+      return v;
+    }
+    operator items_t() const {
+      return to_vector();
+    }
+    friend std::ostream& operator<<(std::ostream& out, const items_view& v) {
+      return out << v.to_vector();
+    }
+  };
+
+  ceph::buffer::list data;
+  typedef btree::btree_map<pg_t,const ceph_le32*> map_t;
+  map_t map;
+
+  void encode(ceph::buffer::list& bl) const {
+    using ceph::encode;
+    uint32_t n = map.size();
+    encode(n, bl);
+    for (auto &p : map) {
+      encode(p.first, bl);
+      bl.append((const char*)p.second, (1 + 2 * *p.second) * sizeof(ceph_le32));
+    }
+  }
+  void decode(ceph::buffer::list::const_iterator& p) {
+    using ceph::decode;
+    data.clear();
+    map.clear();
+    uint32_t n;
+    decode(n, p);
+    if (!n)
+      return;
+    auto pstart = p;
+    size_t start_off = pstart.get_off();
+    std::vector<std::pair<pg_t,size_t>> offsets(n);
+    for (unsigned i = 0; i < n; ++i) {
+      decode(offsets[i].first, p);
+      offsets[i].second = p.get_off() - start_off;
+      uint32_t vn;
+      decode(vn, p);
+      p += vn * 2 * sizeof(int32_t);
+    }
+    pstart.copy(p.get_off() - start_off, data);
+    if (data.get_num_buffers() > 1) {
+      data.rebuild();
+    }
+    const char *start = data.c_str();
+    for (auto& i : offsets) {
+      map.insert(map.end(),
+		 std::make_pair(i.first, (const ceph_le32*)(start + i.second)));
+    }
+  }
+
+  class iterator {
+    map_t::const_iterator it;
+    map_t::const_iterator end;
+    std::pair<pg_t,items_view> current;
+    void init_current() {
+      if (it != end) {
+	current = std::make_pair(it->first, items_view(it->second));
+      }
+    }
+  public:
+    iterator(map_t::const_iterator p,
+	     map_t::const_iterator e)
+      : it(p), end(e) {
+      init_current();
+    }
+    const std::pair<pg_t,items_view>& operator*() const {
+      return current;
+    }
+    const std::pair<pg_t,items_view>* operator->() const {
+      return &current;
+    }
+    friend bool operator==(const iterator& l, const iterator& r) {
+      return l.it == r.it;
+    }
+    friend bool operator!=(const iterator& l, const iterator& r) {
+      return l.it != r.it;
+    }
+    iterator& operator++() {
+      ++it;
+      init_current();
+      return *this;
+    }
+  };
+  iterator begin() const {
+    return iterator(map.begin(), map.end());
+  }
+  iterator end() const {
+    return iterator(map.end(), map.end());
+  }
+  iterator find(pg_t pgid) const {
+    return iterator(map.find(pgid), map.end());
+  }
+  size_t size() const {
+    return map.size();
+  }
+  bool empty() const {
+    return map.empty();
+  }
+  size_t count(pg_t pgid) const {
+    return map.count(pgid);
+  }
+  void erase(pg_t pgid) {
+    map.erase(pgid);
+  }
+  void clear() {
+    map.clear();
+    data.clear();
+  }
+  void set(pg_t pgid, const items_t& v) {
+    using ceph::encode;
+    // a buffer of its own, so that entries already indexed never move
+    ceph::buffer::list bl;
+    encode(v, bl);
+    ceph::buffer::ptr bp = ceph::buffer::create(bl.length());
+    bl.begin().copy(bl.length(), bp.c_str());
+    map[pgid] = (const ceph_le32*)bp.c_str();
+    data.append(std::move(bp));
+  }
+  friend std::ostream& operator<<(std::ostream& out,
+				  const PGUpmapItemsMap& m) {
+    out << "{";
+    for (auto it = m.begin(); it != m.end(); ++it) {
+      if (it != m.begin()) out << ",";
+      out << it->first << "=" << it->second;
+    }
+    return out << "}";
+  }
+};
+WRITE_CLASS_ENCODER(PGUpmapItemsMap)
+
 /** OSDMap
  */
 class OSDMap {
@@ -584,7 +771,7 @@ private:
 
   // remap (post-CRUSH, pre-up)
   mempool::osdmap::map<pg_t,mempool::osdmap::vector<int32_t>> pg_upmap; ///< remap pg
-  mempool::osdmap::map<pg_t,mempool::osdmap::vector<std::pair<int32_t,int32_t>>> pg_upmap_items; ///< remap osds in up set
+  PGUpmapItemsMap pg_upmap_items; ///< remap osds in up set
   mempool::osdmap::map<pg_t, int32_t> pg_upmap_primaries; ///< remap primary of a pg
 
   mempool::osdmap::map<int64_t,pg_pool_t> pools;
@@ -667,6 +854,7 @@ private:
   uint32_t crush_version = 1;
 
   friend class OSDMonitor;
+  friend class OSDMapMapping;
 
  public:
   OSDMap() : epoch(0), 
@@ -782,6 +970,15 @@ public:
   void get_all_osds(std::set<int32_t>& ls) const;
   void get_up_osds(std::set<int32_t>& ls) const;
   void get_out_existing_osds(std::set<int32_t>& ls) const;
+  /**
+   * The tree over up OSDs, in id order, along which new maps are pushed
+   * when osd_map_fanout is set: the first @p fanout up OSDs are the roots,
+   * and the children of the i'th are up OSDs fanout*(i+1) through
+   * fanout*(i+2)-1.
+   */
+  void get_map_fanout_roots(unsigned fanout, std::vector<int>* roots) const;
+  void get_map_fanout_children(int osd, unsigned fanout,
+			       std::vector<int>* children) const;
   unsigned get_num_pg_temp() const {
     return pg_temp->size();
   }
@@ -1290,6 +1487,16 @@ public:
     int up_primary, acting_primary;
     pg_to_up_acting_osds(pg, &up, &up_primary, &acting, &acting_primary);
   }
+  /**
+   * map the pgs [ps_begin, ps_end) of a pool as pg_to_up_acting_osds()
+   * would, running CRUSH over the whole range as one batch.
+   */
+  void pool_pgs_to_up_acting_osds(
+    int64_t pool, unsigned ps_begin, unsigned ps_end,
+    const std::function<void(pg_t pgid,
+			     std::vector<int>& up, int up_primary,
+			     std::vector<int>& acting, int acting_primary)>& f)
+    const;
   bool pg_is_ec(pg_t pg) const {
     auto i = pools.find(pg.pool());
     ceph_assert(i != pools.end());
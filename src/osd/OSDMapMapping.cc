@@ -59,6 +59,182 @@ void OSDMapMapping::update(const OSDMap& osdmap, pg_t pgid)
   _update_range(osdmap, pgid.pool(), pgid.ps(), pgid.ps() + 1);
 }
 
+void OSDMapMapping::note_incremental(const OSDMap::Incremental& inc)
+{
+  if (changes.last && inc.epoch != changes.last + 1) {
+    changes.all = true;
+  }
+  if (!changes.first) {
+    changes.first = inc.epoch;
+  }
+  changes.last = inc.epoch;
+  if (changes.all) {
+    return;
+  }
+  if (inc.fullmap.length() ||
+      inc.crush.length() ||
+      inc.new_max_osd >= 0) {
+    changes.all = true;
+    return;
+  }
+  for (auto& p : inc.new_pools) {
+    changes.pools.insert(p.first);
+  }
+  for (auto& p : inc.new_up_client) {
+    changes.osds.insert(p.first);
+  }
+  for (auto& p : inc.new_state) {
+    changes.osds.insert(p.first);
+  }
+  for (auto& p : inc.new_weight) {
+    changes.osds.insert(p.first);
+  }
+  for (auto& p : inc.new_primary_affinity) {
+    changes.osds.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_temp) {
+    changes.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_primary_temp) {
+    changes.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_upmap) {
+    changes.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_upmap_items) {
+    changes.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_upmap_primary) {
+    changes.pgs.insert(p.first);
+  }
+  changes.pgs.insert(inc.old_pg_upmap.begin(), inc.old_pg_upmap.end());
+  changes.pgs.insert(inc.old_pg_upmap_items.begin(),
+		     inc.old_pg_upmap_items.end());
+  changes.pgs.insert(inc.old_pg_upmap_primary.begin(),
+		     inc.old_pg_upmap_primary.end());
+}
+
+bool OSDMapMapping::_start_incremental(
+  const OSDMap& osdmap,
+  vector<pg_t> *pgs)
+{
+  if (epoch == 0 ||
+      changes.all ||
+      changes.first == 0 ||
+      changes.first > epoch + 1 ||
+      changes.last != osdmap.get_epoch()) {
+    return false;
+  }
+
+  // pools that _init_mappings will (re)create; remember them in case
+  // this update is aborted
+  for (auto& [id, pool] : osdmap.get_pools()) {
+    auto q = pools.find(id);
+    if (q == pools.end() ||
+	q->second.pg_num != pool.get_pg_num() ||
+	q->second.size != pool.get_size()) {
+      changes.pools.insert(id);
+    }
+  }
+  _init_mappings(osdmap);
+
+  std::set<int64_t> dirty_pools = changes.pools;
+  std::set<pg_t> dirty_pgs = changes.pgs;
+  if (!changes.osds.empty()) {
+    // pools whose crush rule can choose a changed osd
+    std::map<int, bool> rule_affected;
+    for (auto& [id, pool] : osdmap.get_pools()) {
+      int rule = pool.get_crush_rule();
+      auto r = rule_affected.find(rule);
+      if (r == rule_affected.end()) {
+	std::map<int, float> weights;
+	bool affected = true;
+	if (osdmap.crush->get_rule_weight_osd_map(rule, &weights) >= 0) {
+	  affected = std::any_of(
+	    changes.osds.begin(), changes.osds.end(),
+	    [&](int32_t osd) { return weights.count(osd) > 0; });
+	}
+	r = rule_affected.emplace(rule, affected).first;
+      }
+      if (r->second) {
+	dirty_pools.insert(id);
+      }
+    }
+    // explicit mappings may name osds outside of the rule
+    auto affected = [&](int32_t osd) {
+      return changes.osds.count(osd) > 0;
+    };
+    for (auto& [pgid, osds] : *osdmap.pg_temp) {
+      if (std::any_of(osds.begin(), osds.end(), affected)) {
+	dirty_pgs.insert(pgid);
+      }
+    }
+    for (auto& [pgid, osd] : *osdmap.primary_temp) {
+      if (affected(osd)) {
+	dirty_pgs.insert(pgid);
+      }
+    }
+    for (auto& [pgid, osds] : osdmap.pg_upmap) {
+      if (std::any_of(osds.begin(), osds.end(), affected)) {
+	dirty_pgs.insert(pgid);
+      }
+    }
+    for (auto& [pgid, items] : osdmap.pg_upmap_items) {
+      for (auto [from, to] : items) {
+	if (affected(from) || affected(to)) {
+	  dirty_pgs.insert(pgid);
+	  break;
+	}
+      }
+    }
+    for (auto& [pgid, osd] : osdmap.pg_upmap_primaries) {
+      if (affected(osd)) {
+	dirty_pgs.insert(pgid);
+      }
+    }
+  }
+
+  for (auto& pgid : dirty_pgs) {
+    auto q = pools.find(pgid.pool());
+    if (q != pools.end() &&
+	pgid.ps() < q->second.pg_num &&
+	!dirty_pools.count(pgid.pool())) {
+      pgs->push_back(pgid);
+    }
+  }
+  for (auto id : dirty_pools) {
+    auto q = pools.find(id);
+    if (q == pools.end()) {
+      continue;  // deleted
+    }
+    for (unsigned ps = 0; ps < q->second.pg_num; ++ps) {
+      pgs->push_back(pg_t(ps, id));
+    }
+  }
+  return true;
+}
+
+std::unique_ptr<OSDMapMapping::MappingJob> OSDMapMapping::start_update(
+  const OSDMap& map,
+  ParallelPGMapper& mapper,
+  unsigned pgs_per_item)
+{
+  std::unique_ptr<MappingJob> job(new MappingJob(&map, this));
+  vector<pg_t> pgs;
+  if (!_start_incremental(map, &pgs)) {
+    // until this completes, rows may be stale or blank
+    changes.all = true;
+    _start(map);
+    mapper.queue(job.get(), pgs_per_item, {});
+  } else if (pgs.empty()) {
+    job->finish = ceph_clock_now();
+    _finish(map);
+  } else {
+    mapper.queue(job.get(), pgs_per_item, pgs);
+  }
+  return job;
+}
+
 void OSDMapMapping::_build_rmap(const OSDMap& osdmap)
 {
   acting_rmap.resize(osdmap.get_max_osd());
@@ -90,6 +266,9 @@ void OSDMapMapping::_finish(const OSDMap& osdmap)
 {
   _build_rmap(osdmap);
   epoch = osdmap.get_epoch();
+  if (changes.last <= epoch) {
+    changes.clear();
+  }
 }
 
 void OSDMapMapping::_dump()
@@ -114,15 +293,12 @@ void OSDMapMapping::_update_range(
   ceph_assert(i != pools.end());
   ceph_assert(pg_begin <= pg_end);
   ceph_assert(pg_end <= i->second.pg_num);
-  for (unsigned ps = pg_begin; ps < pg_end; ++ps) {
-    std::vector<int> up, acting;
-    int up_primary, acting_primary;
-    osdmap.pg_to_up_acting_osds(
-      pg_t(ps, pool),
-      &up, &up_primary, &acting, &acting_primary);
-    i->second.set(ps, std::move(up), up_primary,
-		  std::move(acting), acting_primary);
-  }
+  osdmap.pool_pgs_to_up_acting_osds(
+    pool, pg_begin, pg_end,
+    [&](pg_t pgid, vector<int>& up, int up_primary,
+	vector<int>& acting, int acting_primary) {
+      i->second.set(pgid.ps(), up, up_primary, acting, acting_primary);
+    });
 }
 
 // ---------------------------
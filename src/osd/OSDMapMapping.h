@@ -7,13 +7,13 @@
 
 #include <vector>
 #include <map>
+#include <set>
 
 #include "osd/osd_types.h"
+#include "osd/OSDMap.h"
 #include "common/WorkQueue.h"
 #include "common/Cond.h"
 
-class OSDMap;
-
 /// work queue to perform work on batches of pgids on multiple CPUs
 class ParallelPGMapper {
 public:
@@ -256,7 +256,22 @@ private:
   epoch_t epoch = 0;
   uint64_t num_pgs = 0;
 
+  /// what the incrementals noted since the mapping was built may remap
+  struct Changes {
+    epoch_t first = 0, last = 0;  ///< epochs of the noted incrementals
+    bool all = false;             ///< anything may have changed
+    std::set<int64_t> pools;
+    std::set<int32_t> osds;       ///< weight, state or primary affinity
+    std::set<pg_t> pgs;           ///< pg_temp, primary_temp or upmap
+
+    void clear() {
+      *this = Changes();
+    }
+  } changes;
+
   void _init_mappings(const OSDMap& osdmap);
+  /// prepare to remap only what the noted incrementals may have changed
+  bool _start_incremental(const OSDMap& osdmap, std::vector<pg_t> *pgs);
   void _update_range(
     const OSDMap& map,
     int64_t pool,
@@ -276,10 +291,12 @@ private:
   struct MappingJob : public ParallelPGMapper::Job {
     OSDMapMapping *mapping;
     MappingJob(const OSDMap *osdmap, OSDMapMapping *m)
-      : Job(osdmap), mapping(m) {
-      mapping->_start(*osdmap);
+      : Job(osdmap), mapping(m) {}
+    void process(const std::vector<pg_t>& pgs) override {
+      for (auto& pgid : pgs) {
+	mapping->update(*osdmap, pgid);
+      }
     }
-    void process(const std::vector<pg_t>& pgs) override {}
     void process(int64_t pool, unsigned ps_begin, unsigned ps_end) override {
       mapping->_update_range(*osdmap, pool, ps_begin, ps_end);
     }
@@ -332,14 +349,23 @@ public:
 
   void update(const OSDMap& map, pg_t pgid);
 
+  /**
+   * Record an incremental applied to the map this mapping will be
+   * updated for next, so that start_update() recomputes only the PGs
+   * it may have remapped.  Must not be called while a job is running.
+   */
+  void note_incremental(const OSDMap::Incremental& inc);
+  /// the next update recomputes every PG
+  void reset_incremental() {
+    changes.all = true;
+  }
+
+  /// remap the PGs which may have changed since the mapping was built,
+  /// or all of them if there is no record of what changed
   std::unique_ptr<MappingJob> start_update(
     const OSDMap& map,
     ParallelPGMapper& mapper,
-    unsigned pgs_per_item) {
-    std::unique_ptr<MappingJob> job(new MappingJob(&map, this));
-    mapper.queue(job.get(), pgs_per_item, {});
-    return job;
-  }
+    unsigned pgs_per_item);
 
   epoch_t get_epoch() const {
     return epoch;
@@ -0,0 +1,144 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "OSDMapSharedStore.h"
+#include "common/debug.h"
+#include "common/deleter.h"
+#include "common/errno.h"
+#include "common/strtol.h"
+#include "include/compat.h"
+#include "include/crc32c.h"
+#include "include/stringify.h"
+
+#define dout_context cct
+#define dout_subsys ceph_subsys_osd
+#undef dout_prefix
+#define dout_prefix *_dout << "osdmap_shared_store(" << dir << ") "
+
+OSDMapSharedStore::OSDMapSharedStore(CephContext *cct,
+				     const std::string& path,
+				     const uuid_d& fsid)
+  : cct(cct),
+    dir(path + "/" + stringify(fsid))
+{
+}
+
+int OSDMapSharedStore::init()
+{
+  for (auto& d : {dir.substr(0, dir.rfind('/')), dir}) {
+    if (::mkdir(d.c_str(), 0755) < 0 && errno != EEXIST) {
+      int r = -errno;
+      derr << __func__ << " mkdir " << d << ": " << cpp_strerror(r) << dendl;
+      return r;
+    }
+  }
+  return 0;
+}
+
+std::string OSDMapSharedStore::get_path(epoch_t e) const
+{
+  return dir + "/osdmap." + stringify(e);
+}
+
+bool OSDMapSharedStore::read(epoch_t e, ceph::buffer::list *bl)
+{
+  std::string path = get_path(e);
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(trailer_t)) {
+    VOID_TEMP_FAILURE_RETRY(::close(fd));
+    return false;
+  }
+  size_t size = st.st_size;
+  void *p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  VOID_TEMP_FAILURE_RETRY(::close(fd));
+  if (p == MAP_FAILED) {
+    dout(5) << __func__ << " mmap " << path << ": " << cpp_strerror(errno)
+	    << dendl;
+    return false;
+  }
+  trailer_t t;
+  memcpy(&t, (char *)p + size - sizeof(t), sizeof(t));
+  if (t.magic != MAGIC || t.epoch != e ||
+      t.length != size - sizeof(t) ||
+      ceph_crc32c(-1, (const unsigned char *)p, t.length) != t.crc) {
+    derr << __func__ << " " << path << " is corrupt, ignoring it" << dendl;
+    ::munmap(p, size);
+    return false;
+  }
+  bl->clear();
+  bl->push_back(ceph::buffer::claim_buffer(
+    t.length, (char *)p,
+    make_deleter([p, size] { ::munmap(p, size); })));
+  dout(20) << __func__ << " " << e << " " << t.length << " bytes" << dendl;
+  return true;
+}
+
+int OSDMapSharedStore::write(epoch_t e, const ceph::buffer::list& bl)
+{
+  std::string path = get_path(e);
+  struct stat st;
+  if (::stat(path.c_str(), &st) == 0) {
+    return 0;
+  }
+  trailer_t t;
+  t.magic = MAGIC;
+  t.epoch = e;
+  t.length = bl.length();
+  t.crc = bl.crc32c(-1);
+  t.reserved = 0;
+  ceph::buffer::list out = bl;
+  out.append((const char *)&t, sizeof(t));
+
+  std::string tmp = path + ".tmp." + stringify(getpid());
+  int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    int r = -errno;
+    dout(5) << __func__ << " open " << tmp << ": " << cpp_strerror(r) << dendl;
+    return r;
+  }
+  int r = out.write_fd(fd);
+  VOID_TEMP_FAILURE_RETRY(::close(fd));
+  if (r == 0 && ::rename(tmp.c_str(), path.c_str()) < 0) {
+    r = -errno;
+  }
+  if (r < 0) {
+    dout(5) << __func__ << " " << path << ": " << cpp_strerror(r) << dendl;
+    ::unlink(tmp.c_str());
+    return r;
+  }
+  dout(20) << __func__ << " " << e << " " << bl.length() << " bytes" << dendl;
+  return 0;
+}
+
+void OSDMapSharedStore::trim(epoch_t e)
+{
+  DIR *d = ::opendir(dir.c_str());
+  if (!d) {
+    return;
+  }
+  const std::string prefix = "osdmap.";
+  while (struct dirent *de = ::readdir(d)) {
+    std::string name = de->d_name;
+    if (name.compare(0, prefix.size(), prefix) != 0 ||
+	name.find(".tmp.") != std::string::npos) {
+      continue;
+    }
+    std::string err;
+    epoch_t epoch = strict_strtoll(name.c_str() + prefix.size(), 10, &err);
+    if (err.empty() && epoch < e) {
+      dout(20) << __func__ << " removing " << name << dendl;
+      ::unlink((dir + "/" + name).c_str());
+    }
+  }
+  ::closedir(d);
+}
@@ -0,0 +1,67 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#ifndef CEPH_OSD_OSDMAPSHAREDSTORE_H
+#define CEPH_OSD_OSDMAPSHAREDSTORE_H
+
+#include <string>
+
+#include "include/buffer.h"
+#include "include/types.h"
+#include "include/uuid.h"
+
+class CephContext;
+
+/**
+ * OSDMapSharedStore
+ *
+ * Encoded full OSDMaps in a directory shared by the daemons of a host,
+ * usually on tmpfs.  Daemons map the files read-only, so that the maps
+ * they cache reference the same pages rather than a private copy each.
+ *
+ * Each file is written once, under a temporary name renamed into place,
+ * and checked against its crc whenever it is mapped.  The store is only
+ * a cache in front of each daemon's own copy of the maps: any error
+ * just makes the caller fall back to that.
+ */
+class OSDMapSharedStore {
+public:
+  OSDMapSharedStore(CephContext *cct, const std::string& path,
+		    const uuid_d& fsid);
+
+  /// create the directory of the cluster, @return negative errno on error
+  int init();
+
+  /// @return true and @bl referencing the mapped map if epoch @e is stored
+  bool read(epoch_t e, ceph::buffer::list *bl);
+  /// store the map of epoch @e, unless some daemon already did
+  int write(epoch_t e, const ceph::buffer::list& bl);
+  /// remove the maps of epochs before @e
+  void trim(epoch_t e);
+
+private:
+  struct trailer_t {
+    uint64_t magic;
+    uint32_t epoch;
+    uint32_t length;
+    uint32_t crc;
+    uint32_t reserved;
+  } __attribute__ ((packed));
+  static constexpr uint64_t MAGIC = 0x70616d64736f6863ull;  // "chosdmap"
+
+  CephContext *cct;
+  const std::string dir;
+
+  std::string get_path(epoch_t e) const;
+};
+
+#endif
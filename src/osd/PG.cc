@@ -746,6 +746,8 @@ void PG::clear_recovery_state()
   backfill_info.clear();
   peer_backfill_info.clear();
   waiting_on_backfill.clear();
+  peer_backfill_prefetch.clear();
+  waiting_on_backfill_prefetch.clear();
   _clear_recovery_state();  // pg impl specific hook
 }
 
@@ -1938,6 +1940,8 @@ void PG::on_backfill_reserved()
 
 void PG::on_backfill_canceled()
 {
+  peer_backfill_prefetch.clear();
+  waiting_on_backfill_prefetch.clear();
   if (!waiting_on_backfill.empty()) {
     waiting_on_backfill.clear();
     finish_recovery_op(hobject_t::get_max());
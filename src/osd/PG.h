@@ -764,6 +764,12 @@ public:
     OpRequestRef& op,
     ThreadPool::TPHandle &handle
   ) = 0;
+  /// can op run back to back with the ops on the objects in @names
+  virtual bool can_batch_op(OpRequestRef& op, std::set<hobject_t> *names) = 0;
+  /// queue the transactions of the requests run until flush_txn_batch()
+  /// together, as one ObjectStore transaction
+  virtual void start_txn_batch() = 0;
+  virtual void flush_txn_batch() = 0;
   virtual void clear_cache() = 0;
   virtual int get_cache_obj_count() = 0;
 
@@ -923,6 +929,9 @@ protected:
 protected:
   BackfillInterval backfill_info;
   std::map<pg_shard_t, BackfillInterval> peer_backfill_info;
+  /// next intervals of the peers, scanned ahead while the current is pushed
+  std::map<pg_shard_t, BackfillInterval> peer_backfill_prefetch;
+  std::set<pg_shard_t> waiting_on_backfill_prefetch;
   bool backfill_reserving;
 
   // The primary's num_bytes and local num_bytes for this pg, only valid
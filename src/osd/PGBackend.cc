@@ -606,6 +606,22 @@ PGBackend *PGBackend::build_pg_backend(
   }
 }
 
+void PGBackend::be_deep_scrub_read_ahead(
+  const ghobject_t &oid,
+  uint64_t off,
+  uint64_t len)
+{
+  if (!cct->_conf->osd_deep_scrub_read_ahead) {
+    return;
+  }
+  dout(20) << __func__ << " " << oid << " " << off << "~" << len << dendl;
+  auto bl = new bufferlist;
+  store->read_async(
+    ch, oid, off, len, bl,
+    new LambdaContext([bl](int r) { delete bl; }),
+    CEPH_OSD_OP_FLAG_FADVISE_SEQUENTIAL | CEPH_OSD_OP_FLAG_FADVISE_WILLNEED);
+}
+
 int PGBackend::be_scan_list(
   ScrubMap &map,
   ScrubMapBuilder &pos)
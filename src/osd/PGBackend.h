@@ -594,6 +594,12 @@ typedef std::shared_ptr<const OSDMap> OSDMapRef;
      ScrubMapBuilder &pos,
      ScrubMap::object &o) = 0;
 
+   /// start reading the next deep scrub stride into the store's cache
+   void be_deep_scrub_read_ahead(
+     const ghobject_t &oid,
+     uint64_t off,
+     uint64_t len);
+
    static PGBackend *build_pg_backend(
      const pg_pool_t &pool,
      const std::map<std::string,std::string>& profile,
@@ -146,10 +146,37 @@ public:
    * plus some methods to manipulate it all.
    */
   struct IndexedLog : public pg_log_t {
-    mutable ceph::unordered_map<hobject_t,pg_log_entry_t*> objects;  // ptrs into log.  be careful!
-    mutable ceph::unordered_map<osd_reqid_t,pg_log_entry_t*> caller_ops;
-    mutable ceph::unordered_multimap<osd_reqid_t,pg_log_entry_t*> extra_caller_ops;
-    mutable ceph::unordered_map<osd_reqid_t,pg_log_dup_t*> dup_index;
+    /**
+     * The indexes are keyed by a pointer to the hobject_t or reqid stored
+     * in the entry they refer to, rather than by a copy of it, so that they
+     * do not double the memory taken by the object names and reqids in the
+     * log.  Lookups still take the key by value.  The key must always point
+     * into the entry the index maps it to; use update_index() to (re)map.
+     */
+    template <typename K>
+    struct index_key_hash {
+      using is_transparent = void;
+      size_t operator()(const K* k) const { return std::hash<K>()(*k); }
+      size_t operator()(const K& k) const { return std::hash<K>()(k); }
+    };
+    template <typename K>
+    struct index_key_equal {
+      using is_transparent = void;
+      bool operator()(const K* l, const K* r) const { return *l == *r; }
+      bool operator()(const K& l, const K* r) const { return l == *r; }
+      bool operator()(const K* l, const K& r) const { return *l == r; }
+    };
+    template <typename K, typename V>
+    using index_t = ceph::unordered_map<
+      const K*, V*, index_key_hash<K>, index_key_equal<K>>;
+    template <typename K, typename V>
+    using multi_index_t = ceph::unordered_multimap<
+      const K*, V*, index_key_hash<K>, index_key_equal<K>>;
+
+    mutable index_t<hobject_t,pg_log_entry_t> objects;  // ptrs into log.  be careful!
+    mutable index_t<osd_reqid_t,pg_log_entry_t> caller_ops;
+    mutable multi_index_t<osd_reqid_t,pg_log_entry_t> extra_caller_ops;
+    mutable index_t<osd_reqid_t,pg_log_dup_t> dup_index;
 
     // recovery pointers
     std::list<pg_log_entry_t>::iterator complete_to; // not inclusive of referenced item
@@ -459,7 +486,7 @@ public:
       if (to_index & PGLOG_INDEXED_DUPS) {
 	dup_index.clear();
 	for (auto& i : dups) {
-	  dup_index[i.reqid] = const_cast<pg_log_dup_t*>(&i);
+	  update_index(dup_index, i.reqid, const_cast<pg_log_dup_t*>(&i));
 	}
       }
 
@@ -472,13 +499,14 @@ public:
 	for (auto i = log.begin(); i != log.end(); ++i) {
 	  if (to_index & PGLOG_INDEXED_OBJECTS) {
 	    if (i->object_is_indexed()) {
-	      objects[i->soid] = const_cast<pg_log_entry_t*>(&(*i));
+	      update_index(objects, i->soid, const_cast<pg_log_entry_t*>(&(*i)));
 	    }
 	  }
 
 	  if (to_index & PGLOG_INDEXED_CALLER_OPS) {
 	    if (i->reqid_is_indexed()) {
-	      caller_ops[i->reqid] = const_cast<pg_log_entry_t*>(&(*i));
+	      update_index(caller_ops, i->reqid,
+			   const_cast<pg_log_entry_t*>(&(*i)));
 	    }
 	  }
 
@@ -486,8 +514,8 @@ public:
 	    for (auto j = i->extra_reqids.begin();
 		 j != i->extra_reqids.end();
 		 ++j) {
-	      extra_caller_ops.insert(
-		std::make_pair(j->first, const_cast<pg_log_entry_t*>(&(*i))));
+	      extra_caller_ops.emplace(
+		&j->first, const_cast<pg_log_entry_t*>(&(*i)));
 	    }
 	  }
 	}
@@ -496,6 +524,18 @@ public:
       indexed_data |= to_index;
     }
 
+    /// map key to v, re-keying an existing mapping to point into v
+    template <typename K, typename V>
+    static void update_index(index_t<K,V>& idx, const K& key, V* v) {
+      auto [it, inserted] = idx.try_emplace(&key, v);
+      if (!inserted) {
+	auto nh = idx.extract(it);
+	nh.key() = &key;
+	nh.mapped() = v;
+	idx.insert(std::move(nh));
+      }
+    }
+
     void index_objects() const {
       index(PGLOG_INDEXED_OBJECTS);
     }
@@ -514,21 +554,22 @@ public:
 
     void index(pg_log_entry_t& e) {
       if ((indexed_data & PGLOG_INDEXED_OBJECTS) && e.object_is_indexed()) {
-        if (objects.count(e.soid) == 0 ||
-            objects[e.soid]->version < e.version)
-          objects[e.soid] = &e;
+        auto it = objects.find(e.soid);
+        if (it == objects.end() ||
+            it->second->version < e.version)
+          update_index(objects, e.soid, &e);
       }
       if (indexed_data & PGLOG_INDEXED_CALLER_OPS) {
 	// divergent merge_log indexes new before unindexing old
         if (e.reqid_is_indexed()) {
-	  caller_ops[e.reqid] = &e;
+	  update_index(caller_ops, e.reqid, &e);
         }
       }
       if (indexed_data & PGLOG_INDEXED_EXTRA_CALLER_OPS) {
         for (auto j = e.extra_reqids.begin();
 	     j != e.extra_reqids.end();
 	     ++j) {
-	  extra_caller_ops.insert(std::make_pair(j->first, &e));
+	  extra_caller_ops.emplace(&j->first, &e);
         }
       }
     }
@@ -561,7 +602,7 @@ public:
              j != e.extra_reqids.end();
              ++j) {
           for (auto k = extra_caller_ops.find(j->first);
-               k != extra_caller_ops.end() && k->first == j->first;
+               k != extra_caller_ops.end() && *k->first == j->first;
                ++k) {
             if (k->second == &e) {
               extra_caller_ops.erase(k);
@@ -574,7 +615,7 @@ public:
 
     void index(pg_log_dup_t& e) {
       if (indexed_data & PGLOG_INDEXED_DUPS) {
-	dup_index[e.reqid] = &e;
+	update_index(dup_index, e.reqid, &e);
       }
     }
 
@@ -608,20 +649,22 @@ public:
       head = e.version;
 
       // to our index
-      if ((indexed_data & PGLOG_INDEXED_OBJECTS) && e.object_is_indexed()) {
-        objects[e.soid] = &(log.back());
+      // (keyed by the copy in the log, not by e)
+      auto& le = log.back();
+      if ((indexed_data & PGLOG_INDEXED_OBJECTS) && le.object_is_indexed()) {
+        update_index(objects, le.soid, &le);
       }
       if (indexed_data & PGLOG_INDEXED_CALLER_OPS) {
-        if (e.reqid_is_indexed()) {
-	  caller_ops[e.reqid] = &(log.back());
+        if (le.reqid_is_indexed()) {
+	  update_index(caller_ops, le.reqid, &le);
         }
       }
 
       if (indexed_data & PGLOG_INDEXED_EXTRA_CALLER_OPS) {
-        for (auto j = e.extra_reqids.begin();
-	     j != e.extra_reqids.end();
+        for (auto j = le.extra_reqids.begin();
+	     j != le.extra_reqids.end();
 	     ++j) {
-	  extra_caller_ops.insert(std::make_pair(j->first, &(log.back())));
+	  extra_caller_ops.emplace(&j->first, &le);
         }
       }
 
@@ -6694,6 +6694,9 @@ boost::statechart::result PeeringState::ToDelete::react(
 void PeeringState::WaitDeleteReserved::exit()
 {
   context< PeeringMachine >().log_exit(state_name, enter_time);
+  DECLARE_LOCALS;
+  utime_t dur = ceph_clock_now() - enter_time;
+  pl->get_peering_perf().tinc(rs_waitdeletereserved_latency, dur);
 }
 
 /*----Deleting-----*/
@@ -1802,6 +1802,57 @@ void PrimaryLogPG::handle_backoff(OpRequestRef& op)
   session->ack_backoff(cct, m->pgid, m->id, begin, end);
 }
 
+bool PrimaryLogPG::can_batch_op(
+  OpRequestRef& op,
+  std::set<hobject_t> *names)
+{
+  switch (op->get_req()->get_type()) {
+  case MSG_OSD_REPOP:
+    // replicas only apply the transactions, in order
+    return true;
+  case CEPH_MSG_OSD_OP:
+    break;
+  default:
+    return false;
+  }
+  if (pool.info.is_tier() || pool.info.has_tiers()) {
+    return false;
+  }
+  // as in do_op(); the object name is part of the final decode
+  MOSDOp *m = static_cast<MOSDOp*>(op->get_nonconst_req());
+  if (m->finish_decode()) {
+    op->reset_desc();
+    m->clear_payload();
+  }
+  for (auto& o : m->ops) {
+    switch (o.op.op) {
+    case CEPH_OSD_OP_COPY_FROM:
+    case CEPH_OSD_OP_COPY_FROM2:
+    case CEPH_OSD_OP_SET_REDIRECT:
+    case CEPH_OSD_OP_SET_CHUNK:
+    case CEPH_OSD_OP_TIER_PROMOTE:
+    case CEPH_OSD_OP_TIER_FLUSH:
+    case CEPH_OSD_OP_TIER_EVICT:
+      // these read other objects
+      return false;
+    }
+  }
+  // an op may read what an earlier one wrote to the same object, which
+  // it only finds in the store once that transaction has been queued
+  return names->insert(m->get_hobj().get_head()).second;
+}
+
+void PrimaryLogPG::flush_txn_batch()
+{
+  ceph_assert(txn_batch);
+  auto tls = std::move(*txn_batch);
+  txn_batch.reset();
+  if (!tls.empty()) {
+    dout(20) << __func__ << " " << tls.size() << " transactions" << dendl;
+    osd->store->queue_transactions(ch, tls);
+  }
+}
+
 void PrimaryLogPG::do_request(
   OpRequestRef& op,
   ThreadPool::TPHandle &handle)
@@ -2501,6 +2552,10 @@ void PrimaryLogPG::do_op(OpRequestRef& op)
 
   op->mark_started();
 
+  if (maybe_reply_from_read_cache(ctx)) {
+    return;
+  }
+
   execute_ctx(ctx);
   utime_t prepare_latency = ceph_clock_now();
   prepare_latency -= op->get_dequeued_time();
@@ -2626,6 +2681,7 @@ void PrimaryLogPG::record_write_error(OpRequestRef op, const hobject_t &soid,
 {
   dout(20) << __func__ << " r=" << r << dendl;
   ceph_assert(op->may_write());
+  tracing::osd::maybe_trace_finished_op(cct, *op, r);
   const osd_reqid_t &reqid = op->get_req<MOSDOp>()->get_reqid();
   mempool::osd_pglog::list<pg_log_entry_t> entries;
   entries.push_back(pg_log_entry_t(pg_log_entry_t::ERROR, soid,
@@ -4273,6 +4329,11 @@ void PrimaryLogPG::execute_ctx(OpContext *ctx)
 
   ceph_assert(op->may_write() || op->may_cache());
 
+  if (osd->read_cache->enabled()) {
+    // cached results are of an older version now
+    osd->read_cache->invalidate(soid);
+  }
+
   // trim log?
   recovery_state.update_trim_to();
 
@@ -4425,12 +4486,15 @@ void PrimaryLogPG::log_op_stats(const OpRequest& op,
   if (m_dynamic_perf_stats.is_enabled()) {
     m_dynamic_perf_stats.add(osd, info, op, inb, outb, latency);
   }
+  tracing::osd::maybe_trace_finished_op(cct, op, 0);
 }
 
 void PrimaryLogPG::set_dynamic_perf_stats_queries(
     const std::list<OSDPerfMetricQuery> &queries)
 {
   m_dynamic_perf_stats.set_queries(queries);
+  m_dynamic_perf_stats.set_max_keys(
+    cct->_conf.get_val<uint64_t>("osd_perf_query_max_keys"));
 }
 
 void PrimaryLogPG::get_dynamic_perf_stats(DynamicPerfStats *stats)
@@ -4489,6 +4553,29 @@ void PrimaryLogPG::do_scan(
       // Check that from is in backfill_targets vector
       ceph_assert(is_backfill_target(from));
 
+      if (waiting_on_backfill_prefetch.erase(from)) {
+	// scanned ahead; recover_backfill picks it up once it gets there
+	BackfillInterval& bi = peer_backfill_prefetch[from];
+	bi.begin = m->begin;
+	bi.end = m->end;
+	auto p = m->get_data().cbegin();
+	bi.clear_objects();
+	decode_noclear(bi.objects, p);
+	dout(10) << __func__ << " prefetched bi.begin=" << bi.begin
+		 << " bi.end=" << bi.end
+		 << " bi.objects.size()=" << bi.objects.size() << dendl;
+	if (waiting_on_backfill.count(from)) {
+	  // recover_backfill got there first and is waiting for it
+	  peer_backfill_info[from] = std::move(bi);
+	  peer_backfill_prefetch.erase(from);
+	  waiting_on_backfill.erase(from);
+	  if (waiting_on_backfill.empty()) {
+	    finish_recovery_op(hobject_t::get_max());
+	  }
+	}
+	break;
+      }
+
       BackfillInterval& bi = peer_backfill_info[from];
       bi.begin = m->begin;
       bi.end = m->end;
@@ -9085,6 +9172,20 @@ void PrimaryLogPG::complete_read_ctx(int result, OpContext *ctx)
   }
   ctx->reply->get_header().data_off = (ctx->data_off ? *ctx->data_off : 0);
 
+  if (result >= 0 && ctx->read_cache_key) {
+    auto& osd_op = (*ctx->ops)[0];
+    if (osd_op.rval == 0 &&
+	osd_op.outdata.length() <= cct->_conf->osd_read_cache_max_object_size) {
+      ReadCache::Result r;
+      r.op = osd_op.op;
+      r.rval = osd_op.rval;
+      r.data_off = ctx->data_off;
+      r.outdata = osd_op.outdata;
+      osd->read_cache->insert(ctx->obc->obs.oi.soid, ctx->obc->obs.oi.version,
+			      *ctx->read_cache_key, std::move(r));
+    }
+  }
+
   MOSDOpReply *reply = ctx->reply;
   ctx->reply = nullptr;
 
@@ -9105,6 +9206,9 @@ void PrimaryLogPG::complete_read_ctx(int result, OpContext *ctx)
     // on ENOENT, set a floor for what the next user version will be.
     reply->set_enoent_reply_versions(info.last_update, info.last_user_version);
   }
+  if (result < 0) {
+    tracing::osd::maybe_trace_finished_op(cct, *ctx->op, result);
+  }
 
   reply->set_result(result);
   reply->add_flags(CEPH_OSD_FLAG_ACK | CEPH_OSD_FLAG_ONDISK);
@@ -9112,6 +9216,78 @@ void PrimaryLogPG::complete_read_ctx(int result, OpContext *ctx)
   close_op_ctx(ctx);
 }
 
+bool PrimaryLogPG::get_read_cache_key(OpContext *ctx, std::string *key)
+{
+  auto m = ctx->op->get_req<MOSDOp>();
+  const auto& oi = ctx->obc->obs.oi;
+  if (!osd->read_cache->enabled() ||
+      pool.info.is_erasure() ||
+      ctx->op->may_write() ||
+      ctx->op->may_cache() ||
+      m->ops.size() != 1 ||
+      m->get_snapid() != CEPH_NOSNAP ||
+      !ctx->obc->obs.exists) {
+    return false;
+  }
+  const auto& osd_op = m->ops[0];
+  bufferlist bl;
+  encode(osd_op.op.op, bl);
+  switch (osd_op.op.op) {
+  case CEPH_OSD_OP_READ:
+    if (osd_op.op.extent.truncate_seq ||
+	oi.size > cct->_conf->osd_read_cache_max_object_size) {
+      return false;
+    }
+    encode(osd_op.op.extent.offset, bl);
+    encode(osd_op.op.extent.length, bl);
+    break;
+  case CEPH_OSD_OP_OMAPGETHEADER:
+  case CEPH_OSD_OP_OMAPGETKEYS:
+  case CEPH_OSD_OP_OMAPGETVALS:
+  case CEPH_OSD_OP_OMAPGETVALSBYKEYS:
+    // the query is all in indata
+    bl.append(osd_op.indata);
+    break;
+  default:
+    return false;
+  }
+  *key = bl.to_str();
+  return true;
+}
+
+bool PrimaryLogPG::maybe_reply_from_read_cache(OpContext *ctx)
+{
+  std::string key;
+  if (!get_read_cache_key(ctx, &key)) {
+    return false;
+  }
+  ReadCache::Result r;
+  const auto& oi = ctx->obc->obs.oi;
+  if (!osd->read_cache->lookup(oi.soid, oi.version, key, &r)) {
+    osd->logger->inc(l_osd_read_cache_miss);
+    ctx->read_cache_key = std::move(key);
+    return false;
+  }
+  dout(20) << __func__ << " " << oi.soid << " " << *ctx->ops
+	   << " hit at " << oi.version << dendl;
+  osd->logger->inc(l_osd_read_cache_hit);
+  ctx->op->mark_event("read_cache_hit");
+
+  auto& osd_op = (*ctx->ops)[0];
+  osd_op.op = r.op;
+  osd_op.rval = r.rval;
+  osd_op.outdata = std::move(r.outdata);
+  ctx->data_off = r.data_off;
+  ctx->delta_stats.num_rd++;
+  ctx->delta_stats.num_rd_kb += shift_round_up(osd_op.outdata.length(), 10);
+  unstable_stats.add(ctx->delta_stats);
+
+  ctx->reply = new MOSDOpReply(ctx->op->get_req<MOSDOp>(), 0,
+			       get_osdmap_epoch(), 0, false);
+  complete_read_ctx(0, ctx);
+  return true;
+}
+
 // ========================================================================
 // copyfrom
 
@@ -11630,8 +11806,7 @@ void PrimaryLogPG::submit_log_entries(
       };
       t.register_on_commit(
 	new OnComplete{this, rep_tid, get_osdmap_epoch()});
-      int r = osd->store->queue_transaction(ch, std::move(t), NULL);
-      ceph_assert(r == 0);
+      queue_transaction(std::move(t), OpRequestRef());
       op_applied(info.last_update);
     });
 
@@ -12431,8 +12606,7 @@ void PrimaryLogPG::remove_missing_object(const hobject_t &soid,
 	 on_complete->complete(-EAGAIN);
        }
      }));
-  int r = osd->store->queue_transaction(ch, std::move(t), nullptr);
-  ceph_assert(r == 0);
+  queue_transaction(std::move(t), OpRequestRef());
 }
 
 void PrimaryLogPG::finish_degraded_object(const hobject_t oid)
@@ -13831,6 +14005,8 @@ uint64_t PrimaryLogPG::recover_backfill(
 
     backfills_in_flight.clear();
     pending_backfill_updates.clear();
+    peer_backfill_prefetch.clear();
+    waiting_on_backfill_prefetch.clear();
   }
 
   for (set<pg_shard_t>::const_iterator i = get_backfill_targets().begin();
@@ -13885,6 +14061,22 @@ uint64_t PrimaryLogPG::recover_backfill(
       dout(20) << " peer shard " << bt << " backfill " << pbi << dendl;
       if (pbi.begin <= backfill_info.begin &&
 	  !pbi.extends_to_end() && pbi.empty()) {
+	auto pf = peer_backfill_prefetch.find(bt);
+	if (pf != peer_backfill_prefetch.end() && pf->second.begin == pbi.end) {
+	  dout(10) << " using prefetched interval of peer osd." << bt
+		   << " from " << pbi.end << dendl;
+	  pbi = std::move(pf->second);
+	  peer_backfill_prefetch.erase(pf);
+	  continue;
+	}
+	ceph_assert(waiting_on_backfill.find(bt) == waiting_on_backfill.end());
+	waiting_on_backfill.insert(bt);
+	sent_scan = true;
+	if (waiting_on_backfill_prefetch.count(bt)) {
+	  dout(10) << " waiting for prefetch scan of peer osd." << bt
+		   << " from " << pbi.end << dendl;
+	  continue;
+	}
 	dout(10) << " scanning peer osd." << bt << " from " << pbi.end << dendl;
 	epoch_t e = get_osdmap_epoch();
 	MOSDPGScan *m = new MOSDPGScan(
@@ -13898,9 +14090,25 @@ uint64_t PrimaryLogPG::recover_backfill(
 	  m->set_priority(recovery_state.get_recovery_op_priority());
 	}
 	osd->send_message_osd_cluster(bt.osd, m, get_osdmap_epoch());
-	ceph_assert(waiting_on_backfill.find(bt) == waiting_on_backfill.end());
-	waiting_on_backfill.insert(bt);
-        sent_scan = true;
+      } else if (cct->_conf->osd_backfill_scan_prefetch &&
+		 !pbi.extends_to_end() && !pbi.empty() &&
+		 !waiting_on_backfill.count(bt) &&
+		 !waiting_on_backfill_prefetch.count(bt) &&
+		 !peer_backfill_prefetch.count(bt)) {
+	// scan the peer's next interval while this one is being pushed;
+	// it lies beyond last_backfill_started, so the peer's content
+	// there cannot change meanwhile
+	dout(10) << " prefetching peer osd." << bt << " from " << pbi.end
+		 << dendl;
+	MOSDPGScan *m = new MOSDPGScan(
+	  MOSDPGScan::OP_SCAN_GET_DIGEST, pg_whoami, get_osdmap_epoch(),
+	  get_last_peering_reset(), spg_t(info.pgid.pgid, bt.shard),
+	  pbi.end, hobject_t());
+	if (cct->_conf->osd_op_queue == "mclock_scheduler") {
+	  m->set_priority(recovery_state.get_recovery_op_priority());
+	}
+	osd->send_message_osd_cluster(bt.osd, m, get_osdmap_epoch());
+	waiting_on_backfill_prefetch.insert(bt);
       }
     }
 
@@ -14472,7 +14680,7 @@ void PrimaryLogPG::hit_set_create()
   HitSet::Params params(pool.info.hit_set_params);
 
   dout(20) << __func__ << " " << params << dendl;
-  if (pool.info.hit_set_params.get_type() == HitSet::TYPE_BLOOM) {
+  if (HitSet::is_bloom_type(pool.info.hit_set_params.get_type())) {
     BloomHitSet::Params *p =
       static_cast<BloomHitSet::Params*>(params.impl.get());
 
@@ -15671,6 +15879,7 @@ boost::statechart::result PrimaryLogPG::AwaitAsyncWork::react(const DoSnapWork&)
     ldout(pg->cct, 10) << "got ENOENT" << dendl;
 
     pg->snap_trimq.erase(snap_to_trim);
+    pg->osd->logger->inc(l_osd_snap_trim_snaps);
 
     if (pg->snap_trimq_repeat.count(snap_to_trim)) {
       ldout(pg->cct, 10) << " removing from snap_trimq_repeat" << dendl;
@@ -15742,6 +15951,7 @@ boost::statechart::result PrimaryLogPG::AwaitAsyncWork::react(const DoSnapWork&)
 
     pg->simple_opc_submit(std::move(ctx));
   }
+  pg->osd->logger->inc(l_osd_snap_trim_objects, in_flight.size());
 
   return transit< WaitRepops >();
 }
@@ -358,10 +358,20 @@ public:
   }
   void queue_transaction(ObjectStore::Transaction&& t,
 			 OpRequestRef op) override {
+    if (txn_batch) {
+      txn_batch->push_back(std::move(t));
+      return;
+    }
     osd->store->queue_transaction(ch, std::move(t), op);
   }
   void queue_transactions(std::vector<ObjectStore::Transaction>& tls,
 			  OpRequestRef op) override {
+    if (txn_batch) {
+      for (auto& t : tls) {
+	txn_batch->push_back(std::move(t));
+      }
+      return;
+    }
     osd->store->queue_transactions(ch, tls, op, NULL);
   }
   epoch_t get_interval_start_epoch() const override {
@@ -677,6 +687,9 @@ public:
     // FIXME: we may want to kill this msgr hint off at some point!
     std::optional<int> data_off = std::nullopt;
 
+    /// set if the result of this read is to be added to the read cache
+    std::optional<std::string> read_cache_key;
+
     MOSDOpReply *reply;
 
     PrimaryLogPG *pg;
@@ -995,6 +1008,9 @@ protected:
   /// true if we can send an ondisk/commit for v
   bool already_complete(eversion_t v);
 
+  /// transactions held back by start_txn_batch()
+  std::optional<std::vector<ObjectStore::Transaction>> txn_batch;
+
   // projected object info
   SharedLRU<hobject_t, ObjectContext> object_contexts;
   // std::map from oid.snapdir() to SnapSetContext *
@@ -1247,6 +1263,9 @@ protected:
   int prepare_transaction(OpContext *ctx);
   std::list<std::pair<OpRequestRef, OpContext*> > in_progress_async_reads;
   void complete_read_ctx(int result, OpContext *ctx);
+  /// identifies the result of a read which may be cached, see ReadCache
+  bool get_read_cache_key(OpContext *ctx, std::string *key);
+  bool maybe_reply_from_read_cache(OpContext *ctx);
 
   // pg on-disk content
   void check_local() override;
@@ -1493,6 +1512,12 @@ public:
   void do_request(
     OpRequestRef& op,
     ThreadPool::TPHandle &handle) override;
+  bool can_batch_op(OpRequestRef& op, std::set<hobject_t> *names) override;
+  void start_txn_batch() override {
+    ceph_assert(!txn_batch);
+    txn_batch.emplace();
+  }
+  void flush_txn_batch() override;
   void do_op(OpRequestRef& op);
   void record_write_error(OpRequestRef op, const hobject_t &soid,
 			  MOSDOpReply *orig_reply, int r,
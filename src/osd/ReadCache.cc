@@ -0,0 +1,156 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "ReadCache.h"
+
+ReadCache::ReadCache(unsigned num_shards)
+  : shards(std::max(num_shards, 1u))
+{
+}
+
+void ReadCache::set_max_bytes(uint64_t b)
+{
+  max_bytes = b;
+  if (!autotuned || get_capacity() > b) {
+    capacity = b;
+  }
+  trim();
+}
+
+bool ReadCache::lookup(const hobject_t& soid, const eversion_t& version,
+		       const std::string& key, Result *r)
+{
+  auto& s = get_shard(soid);
+  std::lock_guard l(s.lock);
+  auto p = s.objects.find(soid);
+  if (p == s.objects.end()) {
+    return false;
+  }
+  auto o = p->second;
+  if (o->version != version) {
+    // written since; nothing cached for it is valid anymore
+    _erase(s, o);
+    return false;
+  }
+  auto q = o->results.find(key);
+  if (q == o->results.end()) {
+    return false;
+  }
+  *r = q->second;
+  s.lru.splice(s.lru.begin(), s.lru, o);
+  return true;
+}
+
+void ReadCache::insert(const hobject_t& soid, const eversion_t& version,
+		       const std::string& key, Result&& r)
+{
+  uint64_t shard_capacity = get_capacity() / shards.size();
+  uint64_t b = result_bytes(key, r);
+  if (b > shard_capacity) {
+    return;
+  }
+  auto& s = get_shard(soid);
+  std::lock_guard l(s.lock);
+  auto p = s.objects.find(soid);
+  if (p != s.objects.end() && p->second->version != version) {
+    _erase(s, p->second);
+    p = s.objects.end();
+  }
+  if (p == s.objects.end()) {
+    s.lru.emplace_front();
+    s.lru.front().soid = soid;
+    s.lru.front().version = version;
+    p = s.objects.emplace(soid, s.lru.begin()).first;
+  } else {
+    s.lru.splice(s.lru.begin(), s.lru, p->second);
+  }
+  auto o = p->second;
+  auto [q, inserted] = o->results.try_emplace(key, std::move(r));
+  if (!inserted) {
+    return;
+  }
+  o->bytes += b;
+  s.bytes += b;
+  bytes += b;
+  _trim(s, shard_capacity);
+}
+
+void ReadCache::invalidate(const hobject_t& soid)
+{
+  auto& s = get_shard(soid);
+  std::lock_guard l(s.lock);
+  auto p = s.objects.find(soid);
+  if (p != s.objects.end()) {
+    _erase(s, p->second);
+  }
+}
+
+void ReadCache::clear()
+{
+  for (auto& s : shards) {
+    std::lock_guard l(s.lock);
+    _trim(s, 0);
+  }
+}
+
+void ReadCache::_erase(Shard& s, std::list<Object>::iterator p)
+{
+  s.bytes -= p->bytes;
+  bytes -= p->bytes;
+  s.objects.erase(p->soid);
+  s.lru.erase(p);
+}
+
+void ReadCache::_trim(Shard& s, uint64_t target)
+{
+  while (s.bytes > target && !s.lru.empty()) {
+    _erase(s, std::prev(s.lru.end()));
+  }
+}
+
+void ReadCache::trim()
+{
+  uint64_t shard_capacity = get_capacity() / shards.size();
+  for (auto& s : shards) {
+    std::lock_guard l(s.lock);
+    _trim(s, shard_capacity);
+  }
+}
+
+int64_t ReadCache::request_cache_bytes(PriorityCache::Priority pri,
+				       uint64_t total_cache) const
+{
+  int64_t assigned = get_cache_bytes(pri);
+  int64_t request = 0;
+  switch (pri) {
+  case PriorityCache::Priority::PRI1:
+    // keep what is cached now
+    request = get_bytes();
+    break;
+  case PriorityCache::Priority::PRI10:
+    // and room to grow, if there is memory nobody else wants
+    request = get_max_bytes() - std::min(get_bytes(), get_max_bytes());
+    break;
+  default:
+    break;
+  }
+  return request > assigned ? request - assigned : 0;
+}
+
+int64_t ReadCache::get_cache_bytes() const
+{
+  int64_t total = 0;
+  for (int i = 0; i < PriorityCache::Priority::LAST + 1; i++) {
+    total += cache_bytes[i];
+  }
+  return total;
+}
+
+int64_t ReadCache::commit_cache_size(uint64_t total_cache)
+{
+  committed_bytes = PriorityCache::get_chunk(get_cache_bytes(), total_cache);
+  autotuned = true;
+  capacity = std::min<uint64_t>(committed_bytes, get_max_bytes());
+  trim();
+  return committed_bytes;
+}
@@ -0,0 +1,151 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#ifndef CEPH_OSD_READCACHE_H
+#define CEPH_OSD_READCACHE_H
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/ceph_mutex.h"
+#include "common/hobject.h"
+#include "common/PriorityCache.h"
+#include "include/buffer.h"
+#include "include/rados.h"
+#include "osd/osd_types.h"
+
+/**
+ * ReadCache
+ *
+ * Results of small read-only ops (plain reads and omap queries), keyed by
+ * object, object version and the op's request parameters, so that hot
+ * objects can be served by the PG without running the op against the
+ * object store.  A write to an object changes its version and thereby
+ * obsoletes everything cached for it; invalidate() just frees the memory
+ * early.
+ *
+ * The cache is sharded by object and bounded by set_max_bytes().  When
+ * registered with a PriorityCache::Manager it asks for its current size
+ * at a high priority and for room to grow at the lowest one, and shrinks
+ * to whatever it is assigned.
+ */
+class ReadCache : public PriorityCache::PriCache {
+public:
+  struct Result {
+    ceph_osd_op op;  ///< the op as updated by the read, e.g. extent.length
+    int32_t rval = 0;
+    std::optional<int> data_off;
+    ceph::buffer::list outdata;
+  };
+
+  explicit ReadCache(unsigned num_shards = 16);
+
+  void set_max_bytes(uint64_t bytes);
+  uint64_t get_max_bytes() const {
+    return max_bytes.load(std::memory_order_relaxed);
+  }
+  bool enabled() const {
+    return get_max_bytes() > 0;
+  }
+  /// bytes we may currently use, as assigned by the cache manager
+  uint64_t get_capacity() const {
+    return capacity.load(std::memory_order_relaxed);
+  }
+  uint64_t get_bytes() const {
+    return bytes.load(std::memory_order_relaxed);
+  }
+
+  /// true and @r filled in on hit
+  bool lookup(const hobject_t& soid, const eversion_t& version,
+	      const std::string& key, Result *r);
+  void insert(const hobject_t& soid, const eversion_t& version,
+	      const std::string& key, Result&& r);
+  void invalidate(const hobject_t& soid);
+  void clear();
+
+  // PriorityCache::PriCache
+  int64_t request_cache_bytes(PriorityCache::Priority pri,
+			      uint64_t total_cache) const override;
+  int64_t get_cache_bytes(PriorityCache::Priority pri) const override {
+    return cache_bytes[pri];
+  }
+  int64_t get_cache_bytes() const override;
+  void set_cache_bytes(PriorityCache::Priority pri, int64_t b) override {
+    cache_bytes[pri] = b;
+  }
+  void add_cache_bytes(PriorityCache::Priority pri, int64_t b) override {
+    cache_bytes[pri] += b;
+  }
+  int64_t commit_cache_size(uint64_t total_cache) override;
+  int64_t get_committed_size() const override {
+    return committed_bytes;
+  }
+  double get_cache_ratio() const override {
+    return cache_ratio;
+  }
+  void set_cache_ratio(double ratio) override {
+    cache_ratio = ratio;
+  }
+  std::string get_cache_name() const override {
+    return "OSD Read Cache";
+  }
+  // no age binning; the cache is LRU within its assigned size
+  void shift_bins() override {}
+  void import_bins(const std::vector<uint64_t> &bins) override {}
+  void set_bins(PriorityCache::Priority pri, uint64_t end_bin) override {}
+  uint64_t get_bins(PriorityCache::Priority pri) const override {
+    return 0;
+  }
+
+private:
+  /// all cached results of one version of an object
+  struct Object {
+    hobject_t soid;
+    eversion_t version;
+    std::map<std::string, Result> results;
+    uint64_t bytes = 0;
+  };
+  struct Shard {
+    ceph::mutex lock = ceph::make_mutex("ReadCache::Shard::lock");
+    std::list<Object> lru;  ///< most recently used first
+    std::unordered_map<hobject_t, std::list<Object>::iterator> objects;
+    uint64_t bytes = 0;
+  };
+
+  std::vector<Shard> shards;
+  std::atomic<uint64_t> max_bytes = {0};
+  std::atomic<uint64_t> capacity = {0};
+  std::atomic<uint64_t> bytes = {0};
+  std::atomic<bool> autotuned = {false};
+
+  // state of the cache manager, which calls us from a single thread
+  int64_t cache_bytes[PriorityCache::Priority::LAST + 1] = {0};
+  int64_t committed_bytes = 0;
+  double cache_ratio = 0;
+
+  Shard& get_shard(const hobject_t& soid) {
+    return shards[std::hash<hobject_t>()(soid) % shards.size()];
+  }
+  static uint64_t result_bytes(const std::string& key, const Result& r) {
+    return key.size() + r.outdata.length() + sizeof(Result);
+  }
+  void _erase(Shard& s, std::list<Object>::iterator p);
+  void _trim(Shard& s, uint64_t target);
+  void trim();
+};
+
+#endif
@@ -639,8 +639,11 @@ int ReplicatedBackend::be_deep_scrub(
   dout(10) << __func__ << " " << poid << " pos " << pos << dendl;
   int r;
   uint32_t fadvise_flags = CEPH_OSD_OP_FLAG_FADVISE_SEQUENTIAL |
-                           CEPH_OSD_OP_FLAG_FADVISE_DONTNEED |
-                           CEPH_OSD_OP_FLAG_BYPASS_CLEAN_CACHE;
+                           CEPH_OSD_OP_FLAG_FADVISE_DONTNEED;
+  if (!cct->_conf->osd_deep_scrub_read_ahead) {
+    // there is nothing of ours in the cache to use
+    fadvise_flags |= CEPH_OSD_OP_FLAG_BYPASS_CLEAN_CACHE;
+  }
 
   utime_t sleeptime;
   sleeptime.set_from_double(cct->_conf->osd_debug_deep_scrub_sleep);
@@ -656,14 +659,16 @@ int ReplicatedBackend::be_deep_scrub(
     }
 
     const uint64_t stride = cct->_conf->osd_deep_scrub_stride;
+    const ghobject_t oid(
+      poid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard);
 
-    bufferlist bl;
-    r = store->read(
+    // the store verifies and hashes the data in one go
+    uint32_t crc = pos.data_hash.digest();
+    r = store->read_digest(
       ch,
-      ghobject_t(
-	poid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard),
+      oid,
       pos.data_pos,
-      stride, bl,
+      stride, &crc,
       fadvise_flags);
     if (r < 0) {
       dout(20) << __func__ << "  " << poid << " got "
@@ -672,10 +677,11 @@ int ReplicatedBackend::be_deep_scrub(
       return 0;
     }
     if (r > 0) {
-      pos.data_hash << bl;
+      pos.data_hash = bufferhash(crc);
     }
     pos.data_pos += r;
     if (static_cast<uint64_t>(r) == stride) {
+      be_deep_scrub_read_ahead(oid, pos.data_pos, stride);
       dout(20) << __func__ << "  " << poid << " more data, digest so far 0x"
 	       << std::hex << pos.data_hash.digest() << std::dec << dendl;
       return -EINPROGRESS;
@@ -1189,6 +1195,7 @@ void ReplicatedBackend::repop_commit(RepModifyRef rm)
     rm->ackerosd, reply, get_osdmap_epoch());
 
   log_subop_stats(get_parent()->get_logger(), rm->op, l_osd_sop_w);
+  tracing::osd::maybe_trace_finished_op(cct, *rm->op, 0);
 }
 
 
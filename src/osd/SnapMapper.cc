@@ -551,6 +551,12 @@ int SnapMapper::get_next_objects_to_trim(
   // if max would be 0, we return ENOENT and the caller would mistakenly
   // trim the snaptrim queue
   ceph_assert(max > 0);
+
+  if (snap != trim_snap) {
+    trim_snap = snap;
+    trim_key.clear();
+  }
+  bool from_start = trim_key.empty();
   int r = 0;
 
   /// \todo cache the prefixes-set in update_bits()
@@ -559,6 +565,13 @@ int SnapMapper::get_next_objects_to_trim(
        ++i) {
     string prefix(get_prefix(pool, snap) + *i);
     string pos = prefix;
+    if (!trim_key.empty()) {
+      if (trim_key.compare(0, prefix.size(), prefix) != 0) {
+	continue; // done with this prefix in an earlier call
+      }
+      pos = trim_key;
+      trim_key.clear();
+    }
     while (out->size() < max) {
       pair<string, ceph::buffer::list> next;
       r = backend.get_next(pos, &next);
@@ -583,8 +596,18 @@ int SnapMapper::get_next_objects_to_trim(
       out->push_back(next_decoded.second);
       pos = next.first;
     }
+    if (out->size() >= max) {
+      trim_key = pos;
+    }
   }
   if (out->size() == 0) {
+    if (!from_start) {
+      // make sure nothing was left behind before the position we resumed at
+      dout(20) << __func__ << " rescanning " << snap << " from the start"
+	       << dendl;
+      trim_key.clear();
+      return get_next_objects_to_trim(snap, max, out);
+    }
     return -ENOENT;
   } else {
     return 0;
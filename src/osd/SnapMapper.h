@@ -293,6 +293,9 @@ private:
   uint32_t mask_bits;
   const uint32_t match;
   std::string last_key_checked;
+  /// get_next_objects_to_trim() position: snap, and last mapping returned
+  snapid_t trim_snap = CEPH_NOSNAP;
+  std::string trim_key;
   const int64_t pool;
   const shard_id_t shard;
   const std::string shard_prefix;
@@ -314,6 +317,7 @@ private:
   void update_bits(
     uint32_t new_bits  ///< [in] new split bits
     ) {
+    reset_trim_position();
     mask_bits = new_bits;
     std::set<std::string> _prefixes = hobject_t::get_prefixes(
       mask_bits,
@@ -340,13 +344,27 @@ private:
     MapCacher::Transaction<std::string, ceph::buffer::list> *t ///< [out] transaction
     );
 
-  /// Returns first object with snap as a snap
+  /**
+   * Returns the next objects with snap as a snap
+   *
+   * Successive calls for the same snap resume after the last object
+   * returned, instead of iterating again over the (deleted) mappings of
+   * the objects trimmed so far.  Before reporting -ENOENT the mappings
+   * are scanned once more from the start, so objects which were returned
+   * but not trimmed are returned again.
+   */
   int get_next_objects_to_trim(
     snapid_t snap,              ///< [in] snap to check
     unsigned max,               ///< [in] max to get
     std::vector<hobject_t> *out      ///< [out] next objects to trim (must be empty)
     );  ///< @return error, -ENOENT if no more objects
 
+  /// Make the next get_next_objects_to_trim() start from the beginning
+  void reset_trim_position() {
+    trim_snap = CEPH_NOSNAP;
+    trim_key.clear();
+  }
+
   /// Remove mapping for oid
   int remove_oid(
     const hobject_t &oid,    ///< [in] oid to remove
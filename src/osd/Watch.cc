@@ -114,16 +114,30 @@ void Notify::do_timeout()
   timed_out = true;         // we will send the client an error code
   maybe_complete_notify();
   ceph_assert(complete);
-  set<WatchRef> _watchers;
+  vector<WatchRef> _watchers;
   _watchers.swap(watchers);
+  pending.clear();
+  num_pending = 0;
   lock.unlock();
 
-  for (auto i = _watchers.begin(); i != _watchers.end(); ++i) {
-    boost::intrusive_ptr<PrimaryLogPG> pg((*i)->get_pg());
-    pg->lock();
-    if (!(*i)->is_discarded()) {
-      (*i)->cancel_notify(self.lock());
+  // the watchers of an object share its pg; take its lock once
+  boost::intrusive_ptr<PrimaryLogPG> pg;
+  for (auto& watch : _watchers) {
+    if (!watch) {
+      continue;
+    }
+    if (watch->get_pg() != pg) {
+      if (pg) {
+	pg->unlock();
+      }
+      pg = watch->get_pg();
+      pg->lock();
+    }
+    if (!watch->is_discarded()) {
+      watch->cancel_notify(self.lock());
     }
+  }
+  if (pg) {
     pg->unlock();
   }
 }
@@ -153,52 +167,61 @@ void Notify::unregister_cb()
   }
 }
 
-void Notify::start_watcher(WatchRef watch)
+unsigned Notify::start_watcher(WatchRef watch)
 {
   std::lock_guard l(lock);
   dout(10) << "start_watcher" << dendl;
-  watchers.insert(watch);
+  watchers.push_back(std::move(watch));
+  pending.push_back(true);
+  ++num_pending;
+  return watchers.size() - 1;
 }
 
-void Notify::complete_watcher(WatchRef watch, bufferlist& reply_bl)
+void Notify::complete_watcher(unsigned slot, bufferlist& reply_bl)
 {
   std::lock_guard l(lock);
   dout(10) << "complete_watcher" << dendl;
   if (is_discarded())
     return;
-  ceph_assert(watchers.count(watch));
-  watchers.erase(watch);
-  notify_replies.insert(make_pair(make_pair(watch->get_watcher_gid(),
-					    watch->get_cookie()),
+  ceph_assert(slot < pending.size() && pending[slot]);
+  pending[slot] = false;
+  --num_pending;
+  notify_replies.insert(make_pair(make_pair(watchers[slot]->get_watcher_gid(),
+					    watchers[slot]->get_cookie()),
 				  reply_bl));
+  watchers[slot].reset();
   maybe_complete_notify();
 }
 
-void Notify::complete_watcher_remove(WatchRef watch)
+void Notify::complete_watcher_remove(unsigned slot)
 {
   std::lock_guard l(lock);
   dout(10) << __func__ << dendl;
   if (is_discarded())
     return;
-  ceph_assert(watchers.count(watch));
-  watchers.erase(watch);
+  ceph_assert(slot < pending.size() && pending[slot]);
+  pending[slot] = false;
+  --num_pending;
+  watchers[slot].reset();
   maybe_complete_notify();
 }
 
 void Notify::maybe_complete_notify()
 {
   dout(10) << "maybe_complete_notify -- "
-	   << watchers.size()
+	   << num_pending
 	   << " in progress watchers " << dendl;
-  if (watchers.empty() || timed_out) {
+  if (num_pending == 0 || timed_out) {
     // prepare reply
     bufferlist bl;
     encode(notify_replies, bl);
     vector<pair<uint64_t,uint64_t>> missed;
-    missed.reserve(watchers.size());
-    for (auto& watcher : watchers) {
-      missed.emplace_back(watcher->get_watcher_gid(),
-                          watcher->get_cookie());
+    missed.reserve(num_pending);
+    for (unsigned slot = 0; slot < pending.size(); ++slot) {
+      if (pending[slot]) {
+	missed.emplace_back(watchers[slot]->get_watcher_gid(),
+			    watchers[slot]->get_cookie());
+      }
     }
     encode(missed, bl);
 
@@ -226,6 +249,8 @@ void Notify::discard()
   discarded = true;
   unregister_cb();
   watchers.clear();
+  pending.clear();
+  num_pending = 0;
 }
 
 void Notify::init()
@@ -386,7 +411,7 @@ void Watch::connect(ConnectionRef con, bool _will_ping)
     for (auto i = in_progress_notifies.begin();
 	 i != in_progress_notifies.end();
 	 ++i) {
-      send_notify(i->second);
+      send_notify(i->second.first);
     }
   }
   if (will_ping) {
@@ -418,7 +443,7 @@ void Watch::discard()
   for (auto i = in_progress_notifies.begin();
        i != in_progress_notifies.end();
        ++i) {
-    i->second->discard();
+    i->second.first->discard();
   }
   discard_state();
 }
@@ -458,7 +483,7 @@ void Watch::remove(bool send_disconnect)
   for (auto i = in_progress_notifies.begin();
        i != in_progress_notifies.end();
        ++i) {
-    i->second->complete_watcher_remove(self.lock());
+    i->second.first->complete_watcher_remove(i->second.second);
   }
   discard_state();
 }
@@ -479,8 +504,8 @@ void Watch::start_notify(NotifyRef notif)
     }
   }
   dout(10) << "start_notify " << notif->notify_id << dendl;
-  in_progress_notifies[notif->notify_id] = notif;
-  notif->start_watcher(self.lock());
+  unsigned slot = notif->start_watcher(self.lock());
+  in_progress_notifies[notif->notify_id] = make_pair(notif, slot);
   if (is_connected())
     send_notify(notif);
 }
@@ -509,7 +534,7 @@ void Watch::notify_ack(uint64_t notify_id, bufferlist& reply_bl)
   dout(10) << "notify_ack" << dendl;
   auto i = in_progress_notifies.find(notify_id);
   if (i != in_progress_notifies.end()) {
-    i->second->complete_watcher(self.lock(), reply_bl);
+    i->second.first->complete_watcher(i->second.second, reply_bl);
     in_progress_notifies.erase(i);
   }
 }
@@ -15,6 +15,7 @@
 #define CEPH_WATCH_H
 
 #include <set>
+#include <vector>
 #include "msg/Connection.h"
 #include "include/Context.h"
 
@@ -54,7 +55,12 @@ class Notify {
   bool complete;
   bool discarded;
   bool timed_out;  ///< true if the notify timed out
-  std::set<WatchRef> watchers;
+  /// watchers notified, indexed by the slot start_watcher() gave them;
+  /// reset once they ack or go away
+  std::vector<WatchRef> watchers;
+  /// completion bitmap: slots still expected to ack
+  std::vector<bool> pending;
+  unsigned num_pending = 0;
 
   ceph::buffer::list payload;
   uint32_t timeout;
@@ -99,7 +105,7 @@ public:
 
   std::ostream& gen_dbg_prefix(std::ostream& out) {
     return out << "Notify(" << std::make_pair(cookie, notify_id) << " "
-        << " watchers=" << watchers.size()
+        << " watchers=" << num_pending
         << ") ";
   }
   void set_self(NotifyRef _self) {
@@ -119,18 +125,18 @@ public:
   void init();
 
   /// Called once per watcher prior to init()
-  void start_watcher(
+  unsigned start_watcher(
     WatchRef watcher ///< [in] watcher to complete
-    );
+    ); ///< @return slot of the watcher
 
   /// Called once per NotifyAck
   void complete_watcher(
-    WatchRef watcher, ///< [in] watcher to complete
+    unsigned slot, ///< [in] slot of the watcher to complete
     ceph::buffer::list& reply_bl ///< [in] reply buffer from the notified watcher
     );
   /// Called when a watcher unregisters or times out
   void complete_watcher_remove(
-    WatchRef watcher ///< [in] watcher to complete
+    unsigned slot ///< [in] slot of the watcher to complete
     );
 
   /// Called when the notify is canceled due to a new peering interval
@@ -155,7 +161,8 @@ class Watch {
   boost::intrusive_ptr<PrimaryLogPG> pg;
   std::shared_ptr<ObjectContext> obc;
 
-  std::map<uint64_t, NotifyRef> in_progress_notifies;
+  /// notify_id -> notify, and our slot in it
+  std::map<uint64_t, std::pair<NotifyRef, unsigned>> in_progress_notifies;
 
   // Could have watch_info_t here, but this file includes osd_types.h
   uint32_t timeout; ///< timeout in seconds
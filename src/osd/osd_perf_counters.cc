@@ -168,6 +168,14 @@ PerfCounters *build_osd_logger(CephContext *cct) {
    l_osd_rbytes, "recovery_bytes",
    "recovery bytes",
    "rbt", PerfCountersBuilder::PRIO_INTERESTING);
+  osd_plb.add_u64_counter(
+    l_osd_ec_repair_rbytes, "ec_repair_read_bytes",
+    "Shard bytes read to recover erasure coded objects",
+    NULL, 0, unit_t(UNIT_BYTES));
+  osd_plb.add_u64_counter(
+    l_osd_ec_repair_full_rbytes, "ec_repair_full_read_bytes",
+    "Shard bytes whole chunk reads would have taken for the same recovery",
+    NULL, 0, unit_t(UNIT_BYTES));
 
   osd_plb.add_time_avg(
     l_osd_recovery_push_queue_lat,
@@ -229,6 +237,20 @@ PerfCounters *build_osd_logger(CephContext *cct) {
     PerfCountersBuilder::PRIO_USEFUL);
   osd_plb.add_u64(
     l_osd_hb_to, "heartbeat_to_peers", "Heartbeat (ping) peers we send to");
+  osd_plb.add_u64_counter(
+    l_osd_hb_pings, "heartbeat_pings", "Heartbeat pings sent");
+  osd_plb.add_u64_counter(
+    l_osd_hb_rx_bytes, "heartbeat_rx_bytes",
+    "Heartbeat bytes received (pings and replies)", NULL, 0,
+    unit_t(UNIT_BYTES));
+  osd_plb.add_time_avg(
+    l_osd_hb_lat, "heartbeat_lat", "Time to send a round of heartbeats");
+  osd_plb.add_u64_counter(
+    l_osd_hb_failures_sent, "heartbeat_failures_reported",
+    "Peers reported to the monitor as failed");
+  osd_plb.add_u64_counter(
+    l_osd_hb_failures_held, "heartbeat_failures_held",
+    "Times failure reports were held back because most peers looked failed");
   osd_plb.add_u64_counter(l_osd_map, "map_messages", "OSD map messages");
   osd_plb.add_u64_counter(l_osd_mape, "map_message_epochs", "OSD map epochs");
   osd_plb.add_u64_counter(
@@ -319,6 +341,33 @@ PerfCounters *build_osd_logger(CephContext *cct) {
   osd_plb.add_u64_counter(
     l_osd_pg_biginfo, "osd_pg_biginfo", "PG updated its biginfo attr");
 
+  osd_plb.add_u64_counter(
+    l_osd_op_wq_steal, "op_wq_steal",
+    "Times an idle shard thread went to serve another shard");
+  osd_plb.add_u64_counter(
+    l_osd_op_wq_steal_miss, "op_wq_steal_miss",
+    "Steals which found no op ready to run");
+  osd_plb.add_u64_counter(
+    l_osd_op_batched, "op_batched",
+    "Requests run back to back sharing one store transaction");
+
+  osd_plb.add_u64_counter(
+    l_osd_read_cache_hit, "read_cache_hit",
+    "Reads answered from the OSD read cache");
+  osd_plb.add_u64_counter(
+    l_osd_read_cache_miss, "read_cache_miss",
+    "Cacheable reads not found in the OSD read cache");
+
+  osd_plb.add_u64_counter(
+    l_osd_snap_trim_objects, "snap_trim_objects",
+    "Clones trimmed from their snaps");
+  osd_plb.add_u64_counter(
+    l_osd_snap_trim_snaps, "snap_trim_snaps",
+    "Snaps entirely trimmed from a PG");
+  osd_plb.add_u64_counter(
+    l_osd_op_remote_submit, "op_remote_submit",
+    "Ops handed over to the reactor owning their PG (crimson)");
+
   return osd_plb.create_perf_counters();
 }
  
@@ -357,6 +406,7 @@ PerfCounters *build_recoverystate_perf(CephContext *cct) {
   rs_perf.add_time_avg(rs_getmissing_latency, "getmissing_latency", "Getmissing recovery state latency");
   rs_perf.add_time_avg(rs_waitupthru_latency, "waitupthru_latency", "Waitupthru recovery state latency");
   rs_perf.add_time_avg(rs_notrecovering_latency, "notrecovering_latency", "Notrecovering recovery state latency");
+  rs_perf.add_time_avg(rs_waitdeletereserved_latency, "waitdeletereserved_latency", "Wait delete reserved recovery state latency");
 
   return rs_perf.create_perf_counters();
 }
@@ -60,6 +60,8 @@ enum {
 
   l_osd_rop,
   l_osd_rbytes,
+  l_osd_ec_repair_rbytes,
+  l_osd_ec_repair_full_rbytes,
 
   l_osd_recovery_push_queue_lat,
   l_osd_recovery_push_reply_queue_lat,
@@ -82,6 +84,11 @@ enum {
   l_osd_pg_stray,
   l_osd_pg_removing,
   l_osd_hb_to,
+  l_osd_hb_pings,
+  l_osd_hb_rx_bytes,
+  l_osd_hb_lat,
+  l_osd_hb_failures_sent,
+  l_osd_hb_failures_held,
   l_osd_map,
   l_osd_mape,
   l_osd_mape_dup,
@@ -131,6 +138,19 @@ enum {
   l_osd_pg_fastinfo,
   l_osd_pg_biginfo,
 
+  l_osd_op_wq_steal,
+  l_osd_op_wq_steal_miss,
+
+  l_osd_op_batched,
+
+  l_osd_read_cache_hit,
+  l_osd_read_cache_miss,
+
+  l_osd_snap_trim_objects,
+  l_osd_snap_trim_snaps,
+
+  l_osd_op_remote_submit,
+
   l_osd_last,
 };
 
@@ -170,6 +190,7 @@ enum {
   rs_getmissing_latency,
   rs_waitupthru_latency,
   rs_notrecovering_latency,
+  rs_waitdeletereserved_latency,
   rs_last,
 };
 
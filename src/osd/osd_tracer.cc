@@ -2,11 +2,52 @@
 // vim: ts=8 sw=2 smarttab
 
 #include "osd_tracer.h"
+#include "common/ceph_context.h"
+#include "include/stringify.h"
+#include "osd/OpRequest.h"
 
 namespace tracing {
 namespace osd {
 
 tracing::Tracer tracer;
 
+// the primary and the replicas see the same reqid for a client op
+static trace_id_t reqid_to_trace_id(const osd_reqid_t& reqid)
+{
+  trace_id_t trace_id;
+  uint64_t hi = reqid.name.num() ^ (uint64_t(reqid.name.type()) << 56);
+  uint64_t lo = reqid.tid;
+  for (int i = 0; i < 8; ++i) {
+    trace_id[i] = hi >> (56 - 8 * i);
+    trace_id[8 + i] = lo >> (56 - 8 * i);
+  }
+  return trace_id;
+}
+
+void maybe_trace_finished_op(CephContext *cct, const OpRequest& op, int result)
+{
+  if (!cct->_conf->osd_tracing_tail_sampling || !tracer.is_enabled()) {
+    return;
+  }
+  utime_t now = ceph_clock_now();
+  double latency = now - op.get_initiated();
+  if (result >= 0 && latency < cct->_conf->osd_tracing_tail_threshold) {
+    return;
+  }
+  auto reqid = op.get_reqid();
+  auto span = tracer.add_span(op.get_req()->get_type_name(),
+                              reqid_to_trace_id(reqid),
+                              op.get_initiated().to_real_time());
+  auto reqid_str = stringify(reqid);
+  span->SetAttribute("reqid", reqid_str.c_str());
+  span->SetAttribute("op", op.get_desc());
+  span->SetAttribute("result", static_cast<int64_t>(result));
+  span->SetAttribute("latency", latency);
+  op.visit_events([&span](const utime_t& stamp, std::string_view event) {
+    tracer.add_event(span, event, stamp.to_real_time());
+  });
+  tracer.end_span(span, now.to_real_time());
+}
+
 } // namespace osd
 } // namespace tracing
@@ -3,11 +3,18 @@
 #pragma once
 
 #include "common/tracer.h"
+#include "include/common_fwd.h"
+
+class OpRequest;
 
 namespace tracing {
 namespace osd {
 
 extern tracing::Tracer tracer;
 
+// with osd_tracing_tail_sampling, export a span for the finished `op` if it
+// was slow or failed with `result`
+void maybe_trace_finished_op(CephContext *cct, const OpRequest& op, int result);
+
 } // namespace osd
 } // namespace tracing
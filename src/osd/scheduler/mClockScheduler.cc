@@ -18,6 +18,8 @@
 
 #include "osd/scheduler/mClockScheduler.h"
 #include "common/dout.h"
+#include "common/strtol.h"
+#include "include/str_list.h"
 
 namespace dmc = crimson::dmclock;
 using namespace std::placeholders;
@@ -129,11 +131,43 @@ void mClockScheduler::ClientRegistry::update_from_config(
       get_res(res),
       wgt,
       get_lim(lim));
+
+  // Set per-pool client infos, skipping malformed entries
+  std::lock_guard l(pool_lock);
+  pool_qos.clear();
+  for (auto& entry : get_str_vec(
+	 conf.get_val<std::string>("osd_mclock_scheduler_pool_client_qos"),
+	 ", \t")) {
+    auto fields = get_str_vec(entry, ":");
+    if (fields.size() != 4) {
+      continue;
+    }
+    std::string err;
+    int64_t pool = strict_strtoll(fields[0], 10, &err);
+    double pool_res = strict_strtod(fields[1], &err);
+    int64_t pool_wgt = strict_strtoll(fields[2], 10, &err);
+    double pool_lim = strict_strtod(fields[3], &err);
+    if (!err.empty() || pool < 0 ||
+	pool_res < 0 || pool_res > 1.0 ||
+	pool_wgt < 1 ||
+	pool_lim < 0 || pool_lim > 1.0) {
+      continue;
+    }
+    auto i = pool_client_infos.try_emplace(pool, 1, 1, 1).first;
+    i->second.update(get_res(pool_res), pool_wgt, get_lim(pool_lim));
+    pool_qos.insert(pool);
+  }
 }
 
 const dmc::ClientInfo *mClockScheduler::ClientRegistry::get_external_client(
   const client_profile_id_t &client) const
 {
+  if (client.profile_id) {
+    std::lock_guard l(pool_lock);
+    auto p = pool_client_infos.find(client.profile_id - 1);
+    if (p != pool_client_infos.end())
+      return &(p->second);
+  }
   auto ret = external_client_infos.find(client);
   if (ret == external_client_infos.end())
     return &default_external_client_info;
@@ -502,6 +536,7 @@ const char** mClockScheduler::get_tracked_conf_keys() const
     "osd_mclock_max_sequential_bandwidth_hdd",
     "osd_mclock_max_sequential_bandwidth_ssd",
     "osd_mclock_profile",
+    "osd_mclock_scheduler_pool_client_qos",
     NULL
   };
   return KEYS;
@@ -528,6 +563,10 @@ void mClockScheduler::handle_conf_change(
     client_registry.update_from_config(
       conf, osd_bandwidth_capacity_per_shard);
   }
+  if (changed.count("osd_mclock_scheduler_pool_client_qos")) {
+    client_registry.update_from_config(
+      conf, osd_bandwidth_capacity_per_shard);
+  }
 
   auto get_changed_key = [&changed]() -> std::optional<std::string> {
     static const std::vector<std::string> qos_params = {
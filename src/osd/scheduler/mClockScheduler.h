@@ -18,6 +18,7 @@
 #include <functional>
 #include <ostream>
 #include <map>
+#include <set>
 #include <vector>
 
 #include "boost/variant.hpp"
@@ -137,6 +138,18 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
     crimson::dmclock::ClientInfo default_external_client_info = {1, 1, 1};
     std::map<client_profile_id_t,
 	     crimson::dmclock::ClientInfo> external_client_infos;
+
+    /**
+     * Client infos for the clients of each pool configured in
+     * osd_mclock_scheduler_pool_client_qos.  Entries are never removed:
+     * mclock holds on to them while a client of the pool is tracked.
+     * pool_qos is the set of pools currently configured.
+     */
+    mutable ceph::mutex pool_lock =
+      ceph::make_mutex("mClockScheduler::ClientRegistry::pool_lock");
+    std::map<int64_t, crimson::dmclock::ClientInfo> pool_client_infos;
+    std::set<int64_t> pool_qos;
+
     const crimson::dmclock::ClientInfo *get_external_client(
       const client_profile_id_t &client) const;
   public:
@@ -152,6 +165,10 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
       double capacity_per_shard);
     const crimson::dmclock::ClientInfo *get_info(
       const scheduler_id_t &id) const;
+    bool has_pool_qos(int64_t pool) const {
+      std::lock_guard l(pool_lock);
+      return pool_qos.count(pool);
+    }
   } client_registry;
 
   using mclock_queue_t = crimson::dmclock::PullPriorityQueue<
@@ -174,12 +191,20 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
   SubQueue high_priority;
   priority_t immediate_class_priority = std::numeric_limits<priority_t>::max();
 
-  static scheduler_id_t get_scheduler_id(const OpSchedulerItem &item) {
+  /// client ops of a pool with its own QoS use profile pool id + 1
+  scheduler_id_t get_scheduler_id(const OpSchedulerItem &item) const {
+    profile_id_t profile_id = 0;
+    if (item.get_scheduler_class() == op_scheduler_class::client) {
+      int64_t pool = item.get_ordering_token().pool();
+      if (pool >= 0 && client_registry.has_pool_qos(pool)) {
+	profile_id = pool + 1;
+      }
+    }
     return scheduler_id_t{
       item.get_scheduler_class(),
 	client_profile_id_t{
 	item.get_owner(),
-	  0
+	  profile_id
 	  }
     };
   }
@@ -437,10 +437,11 @@ public:
   Journaler *ls;
   Header h;
   C_OnFinisher *oncommit;
-  C_WriteHead(Journaler *l, Header& h_, C_OnFinisher *c) : ls(l), h(h_),
-							   oncommit(c) {}
+  ceph::real_time stamp;
+  C_WriteHead(Journaler *l, Header& h_, C_OnFinisher *c,
+	      ceph::real_time st) : ls(l), h(h_), oncommit(c), stamp(st) {}
   void finish(int r) override {
-    ls->_finish_write_head(r, h, oncommit);
+    ls->_finish_write_head(r, h, oncommit, stamp);
   }
 };
 
@@ -455,6 +456,17 @@ void Journaler::_write_head(Context *oncommit)
 {
   ceph_assert(!readonly);
   ceph_assert(state == STATE_ACTIVE);
+  if (write_head_inflight) {
+    // the head we write once the current one commits will include
+    // everything up to then; don't queue up one write per caller.
+    ldout(cct, 10) << "write_head already in flight, coalescing" << dendl;
+    write_head_pending = true;
+    if (oncommit) {
+      waitfor_write_head.push_back(oncommit);
+    }
+    return;
+  }
+  write_head_inflight = true;
   last_written.trimmed_pos = trimmed_pos;
   last_written.expire_pos = expire_pos;
   last_written.unused_field = expire_pos;
@@ -477,28 +489,47 @@ void Journaler::_write_head(Context *oncommit)
   objecter->write_full(oid, oloc, snapc, bl, ceph::real_clock::now(), 0,
 		       wrap_finisher(new C_WriteHead(
 					     this, last_written,
-					     wrap_finisher(oncommit))),
+					     wrap_finisher(oncommit),
+					     last_wrote_head)),
 		       0, 0, write_iohint);
 }
 
 void Journaler::_finish_write_head(int r, Header &wrote,
-				   C_OnFinisher *oncommit)
+				   C_OnFinisher *oncommit,
+				   ceph::real_time stamp)
 {
   lock_guard l(lock);
 
+  write_head_inflight = false;
   if (r < 0) {
     lderr(cct) << "_finish_write_head got " << cpp_strerror(r) << dendl;
+    write_head_pending = false;
+    finish_contexts(cct, waitfor_write_head, r);
     handle_write_error(r);
     return;
   }
   ceph_assert(!readonly);
   ldout(cct, 10) << "_finish_write_head " << wrote << dendl;
+  if (logger && logger_key_write_head_lat >= 0) {
+    logger->tinc(logger_key_write_head_lat, ceph::real_clock::now() - stamp);
+  }
   last_committed = wrote;
   if (oncommit) {
     oncommit->complete(r);
   }
 
   _trim();  // trim?
+
+  if (write_head_pending && state == STATE_ACTIVE) {
+    write_head_pending = false;
+    Context *c = nullptr;
+    if (!waitfor_write_head.empty()) {
+      auto cs = new C_Contexts(cct);
+      cs->contexts.swap(waitfor_write_head);
+      c = cs;
+    }
+    _write_head(c);
+  }
 }
 
 
@@ -895,11 +926,13 @@ class Journaler::C_Read : public Context {
   Journaler *ls;
   uint64_t offset;
   uint64_t length;
+  ceph::real_time stamp;
 public:
   bufferlist bl;
-  C_Read(Journaler *j, uint64_t o, uint64_t l) : ls(j), offset(o), length(l) {}
+  C_Read(Journaler *j, uint64_t o, uint64_t l)
+    : ls(j), offset(o), length(l), stamp(ceph::real_clock::now()) {}
   void finish(int r) override {
-    ls->_finish_read(r, offset, length, bl);
+    ls->_finish_read(r, offset, length, bl, stamp);
   }
 };
 
@@ -916,10 +949,14 @@ public:
 };
 
 void Journaler::_finish_read(int r, uint64_t offset, uint64_t length,
-			     bufferlist& bl)
+			     bufferlist& bl, ceph::real_time stamp)
 {
   lock_guard l(lock);
 
+  if (logger && logger_key_read_lat >= 0) {
+    logger->tinc(logger_key_read_lat, ceph::real_clock::now() - stamp);
+  }
+
   if (r < 0) {
     ldout(cct, 0) << "_finish_read got error " << r << dendl;
     error = r;
@@ -1613,6 +1650,9 @@ void Journaler::shutdown()
     finish_contexts(cct, i->second, -EAGAIN);
   }
   waitfor_safe.clear();
+
+  write_head_pending = false;
+  finish_contexts(cct, waitfor_write_head, -EAGAIN);
 }
 
 void Journaler::check_isreadable()
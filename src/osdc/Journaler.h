@@ -231,6 +231,8 @@ private:
 
   PerfCounters *logger;
   int logger_key_lat;
+  int logger_key_write_head_lat = -1;
+  int logger_key_read_lat = -1;
 
   class C_DelayFlush;
   C_DelayFlush *delay_flush_event;
@@ -263,7 +265,13 @@ private:
 
   // header
   ceph::real_time last_wrote_head;
-  void _finish_write_head(int r, Header &wrote, C_OnFinisher *oncommit);
+  // at most one head write in flight; later requests are folded into
+  // a single follow-up write
+  bool write_head_inflight = false;
+  bool write_head_pending = false;
+  std::list<Context*> waitfor_write_head;
+  void _finish_write_head(int r, Header &wrote, C_OnFinisher *oncommit,
+			  ceph::real_time stamp);
   class C_WriteHead;
   friend class C_WriteHead;
 
@@ -341,7 +349,8 @@ private:
   bool called_write_error;
 
   // read completion callback
-  void _finish_read(int r, uint64_t offset, uint64_t length, bufferlist &bl);
+  void _finish_read(int r, uint64_t offset, uint64_t length, bufferlist &bl,
+		    ceph::real_time stamp);
   void _finish_retry_read(int r);
   void _assimilate_prefetch();
   void _issue_read(uint64_t len); // read some more
@@ -509,6 +518,11 @@ public:
   void set_write_iohint(uint32_t iohint_flags) {
     write_iohint = iohint_flags;
   }
+  /// per-stage latency counters in logger; -1 disables
+  void set_latency_keys(int write_head_key, int read_key) {
+    logger_key_write_head_lat = write_head_key;
+    logger_key_read_lat = read_key;
+  }
   /**
    * Cause any ongoing waits to error out with -EAGAIN, set error
    * to -EAGAIN.
@@ -179,6 +179,10 @@ enum {
   l_osdc_osdop_omap_rd,
   l_osdc_osdop_omap_del,
 
+  l_osdc_op_rwlock_wait,
+  l_osdc_op_session_lock_wait,
+  l_osdc_op_hedged,
+
   l_osdc_last,
 };
 
@@ -219,6 +223,8 @@ const char** Objecter::get_tracked_conf_keys() const
     "crush_location",
     "rados_mon_op_timeout",
     "rados_osd_op_timeout",
+    "objecter_balance_reads_by_latency",
+    "objecter_read_hedge_min_delay",
     NULL
   };
   return config_keys;
@@ -237,6 +243,14 @@ void Objecter::handle_conf_change(const ConfigProxy& conf,
   if (changed.count("rados_osd_op_timeout")) {
     osd_timeout = conf.get_val<std::chrono::seconds>("rados_osd_op_timeout");
   }
+  if (changed.count("objecter_balance_reads_by_latency")) {
+    balance_reads_by_latency =
+      conf.get_val<bool>("objecter_balance_reads_by_latency");
+  }
+  if (changed.count("objecter_read_hedge_min_delay")) {
+    read_hedge_min_delay =
+      conf.get_val<std::chrono::milliseconds>("objecter_read_hedge_min_delay");
+  }
 }
 
 void Objecter::update_crush_location()
@@ -377,6 +391,13 @@ void Objecter::init()
     pcb.add_u64_counter(l_osdc_osdop_omap_del, "omap_del",
 			"OSD OMAP delete operations");
 
+    pcb.add_time_avg(l_osdc_op_rwlock_wait, "op_rwlock_wait",
+		     "Time ops and replies blocked on the objecter lock");
+    pcb.add_time_avg(l_osdc_op_session_lock_wait, "op_session_lock_wait",
+		     "Time ops and replies blocked on an OSD session lock");
+    pcb.add_u64_counter(l_osdc_op_hedged, "op_hedged",
+			"Slow reads resent to another replica");
+
     logger = pcb.create_perf_counters();
     cct->get_perfcounters_collection()->add(logger);
   }
@@ -1566,6 +1587,7 @@ void Objecter::_check_op_pool_dne(Op *op, std::unique_lock<std::shared_mutex> *s
       ldout(cct, 10) << "check_op_pool_dne tid " << op->tid
 		     << " concluding pool " << op->target.base_pgid.pool()
 		     << " dne" << dendl;
+      _revoke_rx_buffer(op);
       if (op->has_completion()) {
 	num_in_flight--;
 	op->complete(osdc_errc::pool_dne, -ENOENT);
@@ -1601,6 +1623,7 @@ void Objecter::_check_op_pool_eio(Op *op, std::unique_lock<std::shared_mutex> *s
   ldout(cct, 10) << "check_op_pool_eio tid " << op->tid
 		 << " concluding pool " << op->target.base_pgid.pool()
 		 << " has eio" << dendl;
+  _revoke_rx_buffer(op);
   if (op->has_completion()) {
     num_in_flight--;
     op->complete(osdc_errc::pool_eio, -EIO);
@@ -2268,7 +2291,8 @@ void Objecter::resend_mon_ops()
 
 void Objecter::op_submit(Op *op, ceph_tid_t *ptid, int *ctx_budget)
 {
-  shunique_lock rl(rwlock, ceph::acquire_shared);
+  shunique_lock rl(rwlock, defer_lock);
+  _lock_shared_timed(rl);
   ceph_tid_t tid = 0;
   if (!ptid)
     ptid = &tid;
@@ -2452,7 +2476,8 @@ void Objecter::_op_submit(Op *op, shunique_lock<ceph::shared_mutex>& sul, ceph_t
     _maybe_request_map();
   }
 
-  unique_lock sl(s->lock);
+  unique_lock sl(s->lock, defer_lock);
+  _lock_session_timed(sl);
   if (op->tid == 0)
     op->tid = ++last_tid;
 
@@ -2484,6 +2509,26 @@ void Objecter::_op_submit(Op *op, shunique_lock<ceph::shared_mutex>& sul, ceph_t
   ldout(cct, 5) << num_in_flight << " in flight" << dendl;
 }
 
+void Objecter::_lock_shared_timed(shunique_lock<ceph::shared_mutex>& sul)
+{
+  if (sul.try_lock_shared()) {
+    return;
+  }
+  auto start = ceph::mono_clock::now();
+  sul.lock_shared();
+  logger->tinc(l_osdc_op_rwlock_wait, ceph::mono_clock::now() - start);
+}
+
+void Objecter::_lock_session_timed(unique_lock<std::shared_mutex>& sl)
+{
+  if (sl.try_lock()) {
+    return;
+  }
+  auto start = ceph::mono_clock::now();
+  sl.lock();
+  logger->tinc(l_osdc_op_session_lock_wait, ceph::mono_clock::now() - start);
+}
+
 int Objecter::op_cancel(OSDSession *s, ceph_tid_t tid, int r)
 {
   ceph_assert(initialized);
@@ -2497,17 +2542,10 @@ int Objecter::op_cancel(OSDSession *s, ceph_tid_t tid, int r)
     return -ENOENT;
   }
 
-#if 0
-  if (s->con) {
-    ldout(cct, 20) << " revoking rx ceph::buffer for " << tid
-		   << " on " << s->con << dendl;
-    s->con->revoke_rx_buffer(tid);
-  }
-#endif
-
   ldout(cct, 10) << __func__ << " tid " << tid << " in session " << s->osd
 		 << dendl;
   Op *op = p->second;
+  _revoke_rx_buffer(op);
   if (op->has_completion()) {
     num_in_flight--;
     op->complete(osdcode(r), r);
@@ -2960,8 +2998,34 @@ int Objecter::_calc_target(op_target_t *t, Connection *con, bool any_change)
         !is_write && pi->is_replicated() && t->acting.size() > 1) {
       int osd;
       ceph_assert(is_read && t->acting[0] == acting_primary);
-      if (t->flags & CEPH_OSD_FLAG_BALANCE_READS) {
+      if (t->hedge_from >= 0) {
+	// resending a read that was slow on hedge_from; take the
+	// fastest of the others
+	int best = -1;
+	for (unsigned i = 0; i < t->acting.size(); ++i) {
+	  if (t->acting[i] != t->hedge_from &&
+	      (best < 0 ||
+	       _get_read_srtt(t->acting[i]) < _get_read_srtt(t->acting[best]))) {
+	    best = i;
+	  }
+	}
+	ceph_assert(best >= 0);
+	if (best)
+	  t->used_replica = true;
+	osd = t->acting[best];
+	ldout(cct, 10) << " chose osd." << osd << " of " << t->acting
+		       << " instead of slow osd." << t->hedge_from << dendl;
+      } else if (t->flags & CEPH_OSD_FLAG_BALANCE_READS) {
 	int p = rand() % t->acting.size();
+	if (balance_reads_by_latency) {
+	  // the faster of two random replicas; unlike always taking the
+	  // fastest this doesn't herd every client onto one osd
+	  int q = rand() % (t->acting.size() - 1);
+	  if (q >= p)
+	    ++q;
+	  if (_get_read_srtt(t->acting[q]) < _get_read_srtt(t->acting[p]))
+	    p = q;
+	}
 	if (p)
 	  t->used_replica = true;
 	osd = t->acting[p];
@@ -3160,6 +3224,17 @@ void Objecter::_cancel_linger_op(Op *op)
   _finish_op(op, 0);
 }
 
+void Objecter::_revoke_rx_buffer(Op *op)
+{
+  // op->session->lock is locked unique or op->session is null
+  if (op->con) {
+    ldout(cct, 20) << " revoking rx ceph::buffer for " << op->tid << " on "
+		   << op->con << dendl;
+    op->con->revoke_rx_buffer(op->tid);
+    op->con = nullptr;
+  }
+}
+
 void Objecter::_finish_op(Op *op, int r)
 {
   ldout(cct, 15) << __func__ << " " << op->tid << dendl;
@@ -3173,14 +3248,20 @@ void Objecter::_finish_op(Op *op, int r)
 
   if (op->ontimeout && r != -ETIMEDOUT)
     timer.cancel_event(op->ontimeout);
+  if (op->onhedge)
+    timer.cancel_event(op->onhedge);
 
+  _revoke_rx_buffer(op);
   if (op->session) {
     _session_op_remove(op->session, op);
   }
 
   logger->dec(l_osdc_op_active);
 
-  ceph_assert(check_latest_map_ops.find(op->tid) == check_latest_map_ops.end());
+  // only homeless ops wait for a map check, and replies, which may get
+  // here without rwlock, never complete those
+  ceph_assert((op->session && !op->session->is_homeless()) ||
+	      check_latest_map_ops.find(op->tid) == check_latest_map_ops.end());
 
   inflight_ops--;
 
@@ -3289,32 +3370,108 @@ void Objecter::_send_op(Op *op)
   ConnectionRef con = op->session->con;
   ceph_assert(con);
 
-#if 0
-  // preallocated rx ceph::buffer?
-  if (op->con) {
-    ldout(cct, 20) << " revoking rx ceph::buffer for " << op->tid << " on "
-		   << op->con << dendl;
-    op->con->revoke_rx_buffer(op->tid);
-  }
+  // preallocated rx ceph::buffer?  A revoke no longer returns while the
+  // messenger is still writing into it, so this is safe with timeouts
+  // and cancellation too (#9582, #22480).
+  _revoke_rx_buffer(op);
   if (op->outbl &&
-      op->ontimeout == 0 &&  // only post rx_buffer if no timeout; see #9582
-      op->outbl->length()) {
+      op->outbl->length() &&
+      cct->_conf->objecter_rx_user_buffers) {
     op->outbl->invalidate_crc();  // messenger writes through c_str()
     ldout(cct, 20) << " posting rx ceph::buffer for " << op->tid << " on " << con
 		   << dendl;
     op->con = con;
     op->con->post_rx_buffer(op->tid, *op->outbl);
   }
-#endif
 
   op->incarnation = op->session->incarnation;
 
   if (op->trace.valid()) {
     m->trace.init("op msg", nullptr, &op->trace);
   }
+  op->sent = ceph::mono_clock::now();
+  _schedule_read_hedge(op);
   op->session->con->send_message(m);
 }
 
+uint64_t Objecter::_get_read_srtt(int osd) const
+{
+  // rwlock is locked
+  auto p = osd_sessions.find(osd);
+  if (p == osd_sessions.end()) {
+    return 0;
+  }
+  return p->second->read_srtt.load(std::memory_order_relaxed);
+}
+
+void Objecter::_schedule_read_hedge(Op *op)
+{
+  // rwlock is locked
+  // op->session->lock is locked
+  if (op->onhedge) {
+    timer.cancel_event(op->onhedge);
+    op->onhedge = 0;
+  }
+  if (read_hedge_min_delay <= timespan(0) ||
+      op->target.hedge_from >= 0 ||
+      !(op->target.flags & (CEPH_OSD_FLAG_BALANCE_READS |
+			    CEPH_OSD_FLAG_LOCALIZE_READS)) ||
+      (op->target.flags & CEPH_OSD_FLAG_WRITE) ||
+      op->target.acting.size() < 2) {
+    return;
+  }
+  const pg_pool_t *pi = osdmap->get_pg_pool(op->target.target_oloc.pool);
+  if (!pi || !pi->is_replicated()) {
+    return;
+  }
+  auto delay = std::max(read_hedge_min_delay, op->session->read_deadline());
+  auto tid = op->tid;
+  int osd = op->session->osd;
+  int attempts = op->attempts;
+  op->onhedge = timer.add_event(delay,
+				[this, tid, osd, attempts]() {
+				  hedge_read(tid, osd, attempts); });
+}
+
+void Objecter::hedge_read(ceph_tid_t tid, int osd, int attempts)
+{
+  shunique_lock sul(rwlock, ceph::acquire_shared);
+  if (!initialized) {
+    return;
+  }
+  auto p = osd_sessions.find(osd);
+  if (p == osd_sessions.end()) {
+    return;
+  }
+  OSDSession *s = p->second;
+  unique_lock sl(s->lock);
+  auto i = s->ops.find(tid);
+  if (i == s->ops.end() || i->second->attempts != attempts) {
+    return;
+  }
+  Op *op = i->second;
+  op->onhedge = 0;
+  auto elapsed = ceph::mono_clock::now() - op->sent;
+  ldout(cct, 5) << __func__ << " tid " << tid << " pending on osd." << osd
+		<< " for " << elapsed << ", resending" << dendl;
+  logger->inc(l_osdc_op_hedged);
+  // the osd is at least this slow now
+  s->note_read_latency(elapsed);
+
+  // _op_submit accounts for the op again
+  inflight_ops--;
+  logger->dec(l_osdc_op_active);
+  if (op->has_completion()) {
+    num_in_flight--;
+  }
+  _session_op_remove(s, op);
+  sl.unlock();
+
+  op->target.hedge_from = osd;
+  op->target.pgid = pg_t();
+  _op_submit(op, sul, NULL);
+}
+
 int Objecter::calc_op_budget(const bc::small_vector_base<OSDOp>& ops)
 {
   int op_budget = 0;
@@ -3373,7 +3530,9 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
   // get pio
   ceph_tid_t tid = m->get_tid();
 
-  shunique_lock sul(rwlock, ceph::acquire_shared);
+  // Completing an op only needs its session's lock; rwlock is taken
+  // (before the session lock, as everywhere) only to resend it.
+  shunique_lock sul(rwlock, defer_lock);
   if (!initialized) {
     m->put();
     return;
@@ -3382,13 +3541,21 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
   ConnectionRef con = m->get_connection();
   auto priv = con->get_priv();
   auto s = static_cast<OSDSession*>(priv.get());
-  if (!s || s->con != con) {
+  if (!s) {
     ldout(cct, 7) << __func__ << " no session on con " << con << dendl;
     m->put();
     return;
   }
 
-  unique_lock sl(s->lock);
+ relock:
+  unique_lock sl(s->lock, defer_lock);
+  _lock_session_timed(sl);
+  if (s->con != con) {
+    ldout(cct, 7) << __func__ << " no session on con " << con << dendl;
+    sl.unlock();
+    m->put();
+    return;
+  }
 
   map<ceph_tid_t, Op *>::iterator iter = s->ops.find(tid);
   if (iter == s->ops.end()) {
@@ -3409,21 +3576,6 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
 		<< " attempt " << m->get_retry_attempt()
 		<< dendl;
   Op *op = iter->second;
-  op->trace.event("osd op reply");
-
-  if (retry_writes_after_first_reply && op->attempts == 1 &&
-      (op->target.flags & CEPH_OSD_FLAG_WRITE)) {
-    ldout(cct, 7) << "retrying write after first reply: " << tid << dendl;
-    if (op->has_completion()) {
-      num_in_flight--;
-    }
-    _session_op_remove(s, op);
-    sl.unlock();
-
-    _op_submit(op, sul, NULL);
-    m->put();
-    return;
-  }
 
   if (m->get_retry_attempt() >= 0) {
     if (m->get_retry_attempt() != (op->attempts - 1)) {
@@ -3442,9 +3594,39 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
     // have, but that is better than doing callbacks out of order.
   }
 
-  decltype(op->onfinish) onfinish;
-
   int rc = m->get_result();
+  bool resend =
+    (retry_writes_after_first_reply && op->attempts == 1 &&
+     (op->target.flags & CEPH_OSD_FLAG_WRITE)) ||
+    m->is_redirect_reply() ||
+    rc == -EAGAIN;
+  if (resend && !sul.owns_lock_shared()) {
+    sl.unlock();
+    _lock_shared_timed(sul);
+    if (!initialized) {
+      m->put();
+      return;
+    }
+    // the op may have been completed, moved or resent meanwhile
+    goto relock;
+  }
+  op->trace.event("osd op reply");
+
+  if (retry_writes_after_first_reply && op->attempts == 1 &&
+      (op->target.flags & CEPH_OSD_FLAG_WRITE)) {
+    ldout(cct, 7) << "retrying write after first reply: " << tid << dendl;
+    if (op->has_completion()) {
+      num_in_flight--;
+    }
+    _session_op_remove(s, op);
+    sl.unlock();
+
+    _op_submit(op, sul, NULL);
+    m->put();
+    return;
+  }
+
+  decltype(op->onfinish) onfinish;
 
   if (m->is_redirect_reply()) {
     ldout(cct, 5) << " got redirect reply; redirecting" << dendl;
@@ -3482,7 +3664,14 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
     return;
   }
 
-  sul.unlock();
+  if (sul) {
+    sul.unlock();
+  }
+
+  if ((op->target.flags & (CEPH_OSD_FLAG_READ | CEPH_OSD_FLAG_WRITE)) ==
+      CEPH_OSD_FLAG_READ) {
+    s->note_read_latency(ceph::mono_clock::now() - op->sent);
+  }
 
   if (op->objver)
     *op->objver = m->get_user_version();
@@ -3493,12 +3682,15 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
 
   // got data?
   if (op->outbl) {
-#if 0
-    if (op->con)
-      op->con->revoke_rx_buffer(op->tid);
-#endif
+    _revoke_rx_buffer(op);
     auto& bl = m->get_data();
-    if (op->outbl->length() == bl.length() &&
+    if (bl.length() && op->outbl->get_num_buffers() == 1 &&
+	bl.is_provided_buffer(op->outbl->front().c_str())) {
+      // the messenger read it into the buffer we posted
+      ldout(cct, 20) << __func__ << " got " << bl.length()
+		     << " bytes in place" << dendl;
+      m->claim_data(*op->outbl);
+    } else if (op->outbl->length() == bl.length() &&
 	bl.get_num_buffers() <= 1) {
       // this is here to keep previous users to *relied* on getting data
       // read into existing buffers happy.  Notably,
@@ -5009,6 +5201,10 @@ Objecter::Objecter(CephContext *cct,
 {
   mon_timeout = cct->_conf.get_val<std::chrono::seconds>("rados_mon_op_timeout");
   osd_timeout = cct->_conf.get_val<std::chrono::seconds>("rados_osd_op_timeout");
+  balance_reads_by_latency =
+    cct->_conf.get_val<bool>("objecter_balance_reads_by_latency");
+  read_hedge_min_delay =
+    cct->_conf.get_val<std::chrono::milliseconds>("objecter_read_hedge_min_delay");
 }
 
 Objecter::~Objecter()
@@ -1798,6 +1798,7 @@ public:
     int32_t peering_crush_mandatory_member = CRUSH_ITEM_NONE;
 
     bool used_replica = false;
+    int hedge_from = -1; ///< osd a slow read was resent away from, or -1
     bool paused = false;
 
     int osd = -1;      ///< the final target osd, or -1
@@ -1931,6 +1932,7 @@ public:
     std::variant<std::unique_ptr<OpComp>, fu2::unique_function<OpSig>,
 		 Context*> onfinish;
     uint64_t ontimeout = 0;
+    uint64_t onhedge = 0;
 
     ceph_tid_t tid = 0;
     int attempts = 0;
@@ -1939,6 +1941,7 @@ public:
     epoch_t *reply_epoch = nullptr;
 
     ceph::coarse_mono_time stamp;
+    ceph::mono_time sent;  ///< precise stamp, for read latencies
 
     epoch_t map_dne_bound = 0;
 
@@ -2396,6 +2399,29 @@ public:
     int incarnation;
     ConnectionRef con;
     int num_locks;
+
+    /// smoothed latency of pure reads and its mean deviation, in ns, as
+    /// TCP does for its rtt; updated under lock, read without it
+    std::atomic<uint64_t> read_srtt{0};
+    std::atomic<uint64_t> read_rttvar{0};
+    void note_read_latency(ceph::timespan t) {
+      uint64_t l = t.count() > 0 ? t.count() : 1;
+      uint64_t srtt = read_srtt.load(std::memory_order_relaxed);
+      if (srtt == 0) {
+	read_rttvar.store(l / 2, std::memory_order_relaxed);
+	read_srtt.store(l, std::memory_order_relaxed);
+	return;
+      }
+      uint64_t dev = srtt > l ? srtt - l : l - srtt;
+      read_rttvar.store((3 * read_rttvar.load(std::memory_order_relaxed) + dev) / 4,
+			std::memory_order_relaxed);
+      read_srtt.store((7 * srtt + l) / 8, std::memory_order_relaxed);
+    }
+    /// how long a read may take before it looks slow, roughly a p99
+    ceph::timespan read_deadline() const {
+      return ceph::timespan(read_srtt.load(std::memory_order_relaxed) +
+			    4 * read_rttvar.load(std::memory_order_relaxed));
+    }
     std::unique_ptr<std::mutex[]> completion_locks;
 
     OSDSession(CephContext *cct, int o) :
@@ -2453,11 +2479,22 @@ public:
 
   ceph::timespan mon_timeout;
   ceph::timespan osd_timeout;
+  bool balance_reads_by_latency;
+  ceph::timespan read_hedge_min_delay;
+
+  /// smoothed read latency of @osd in ns, or 0 if we have no session/data
+  uint64_t _get_read_srtt(int osd) const;
+  /// arm the resend of a balanced read that turns out slow
+  void _schedule_read_hedge(Op *op);
+  /// resend read @tid, if its @attempts are still pending on @osd, to
+  /// another replica
+  void hedge_read(ceph_tid_t tid, int osd, int attempts);
 
   MOSDOp *_prepare_osd_op(Op *op);
   void _send_op(Op *op);
   void _send_op_account(Op *op);
   void _cancel_linger_op(Op *op);
+  void _revoke_rx_buffer(Op *op);
   void _finish_op(Op *op, int r);
   static bool is_pg_changed(
     int oldprimary,
@@ -2717,6 +2754,10 @@ private:
 			      ceph::shunique_lock<ceph::shared_mutex>& lc,
 			      ceph_tid_t *ptid,
 			      int *ctx_budget = NULL);
+  /// take rwlock shared, counting any time spent blocked in op_rwlock_wait
+  void _lock_shared_timed(ceph::shunique_lock<ceph::shared_mutex>& sul);
+  /// lock a session, counting any time spent blocked in op_session_lock_wait
+  void _lock_session_timed(std::unique_lock<std::shared_mutex>& sl);
   // public interface
 public:
   void op_submit(Op *op, ceph_tid_t *ptid = NULL, int *ctx_budget = NULL);
@@ -29,6 +29,8 @@ from ceph_argparse import parse_json_funcsigs, validate_command
 COUNTER = 0x8
 LONG_RUNNING_AVG = 0x4
 READ_CHUNK_SIZE = 4096
+# sent instead of the reply length by a daemon streaming its reply
+STREAM_MARKER = 0xffffffff
 
 
 def admin_socket(asok_path: str,
@@ -53,14 +55,26 @@ def admin_socket(asok_path: str,
             l, = struct.unpack(">I", len_str)
             sock_ret = b''
 
-            got = 0
-            while got < l:
-                # recv() receives signed int, i.e max 2GB
-                # workaround by capping READ_CHUNK_SIZE per call.
-                want = min(l - got, READ_CHUNK_SIZE)
-                bit = sock.recv(want)
-                sock_ret += bit
-                got += len(bit)
+            def recv_exact(n: int) -> bytes:
+                ret = b''
+                while len(ret) < n:
+                    # recv() receives signed int, i.e max 2GB
+                    # workaround by capping READ_CHUNK_SIZE per call.
+                    bit = sock.recv(min(n - len(ret), READ_CHUNK_SIZE))
+                    if not bit:
+                        raise RuntimeError("short read from admin socket")
+                    ret += bit
+                return ret
+
+            if l == STREAM_MARKER:
+                # streamed reply: chunks up to an empty one
+                while True:
+                    l, = struct.unpack(">I", recv_exact(4))
+                    if l == 0:
+                        break
+                    sock_ret += recv_exact(l)
+            else:
+                sock_ret = recv_exact(l)
 
         except Exception as sock_e:
             raise RuntimeError('exception: ' + str(sock_e))
@@ -636,6 +636,15 @@ void *SQLiteDB::openDB(const DoutPrefixProvider *dpp)
 
   exec(dpp, "PRAGMA foreign_keys=ON", NULL);
 
+  // in WAL mode readers don't block the writer and a commit appends to
+  // the log instead of rewriting the rollback journal
+  {
+    const auto journal_mode = cct->_conf.get_val<std::string>("dbstore_journal_mode");
+    const auto synchronous = cct->_conf.get_val<std::string>("dbstore_synchronous");
+    exec(dpp, ("PRAGMA journal_mode=" + journal_mode).c_str(), NULL);
+    exec(dpp, ("PRAGMA synchronous=" + synchronous).c_str(), NULL);
+  }
+
 out:
   return db;
 }
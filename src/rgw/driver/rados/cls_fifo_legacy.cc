@@ -14,6 +14,7 @@
  */
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstdint>
 #include <numeric>
 #include <optional>
@@ -25,6 +26,7 @@
 
 #include "include/buffer.h"
 
+#include "common/async/completion.h"
 #include "common/async/yield_context.h"
 #include "common/random_string.h"
 
@@ -1309,7 +1311,95 @@ std::pair<std::uint32_t, std::uint32_t> FIFO::get_part_layout_info() const {
   return {part_header_size, part_entry_overhead};
 }
 
+/// A group of single-entry pushes, sent with one push by whichever of
+/// its callers gets to go first.  The others block or, with a yield
+/// context, suspend until it is done.
+struct PushBatch {
+  using Signature = void(boost::system::error_code);
+  using Completion = ceph::async::Completion<Signature>;
+
+  std::vector<cb::list> entries;
+  int r = 0;
+  bool done = false;
+  std::condition_variable cond;
+  std::vector<std::unique_ptr<Completion>> completions;
+
+  template <typename CompletionToken>
+  auto async_wait(std::unique_lock<std::mutex>& l,
+		  boost::asio::io_context& ctx, CompletionToken&& token) {
+    boost::asio::async_completion<CompletionToken, Signature> init(token);
+    completions.push_back(Completion::create(ctx.get_executor(),
+					     std::move(init.completion_handler)));
+    l.unlock();
+    return init.result.get();
+  }
+
+  /// wait for the batch to be done or to need a new leader;
+  /// called and returns with l held
+  void wait(std::unique_lock<std::mutex>& l, optional_yield y) {
+    if (y) {
+      boost::system::error_code ec;
+      async_wait(l, y.get_io_context(), y.get_yield_context()[ec]);
+      l.lock();
+    } else {
+      cond.wait(l);
+    }
+  }
+
+  void wake() {
+    for (auto& c : completions) {
+      Completion::post(std::move(c), boost::system::error_code{});
+    }
+    completions.clear();
+    cond.notify_all();
+  }
+};
+
+int FIFO::push_grouped(const DoutPrefixProvider *dpp, const cb::list& bl,
+		       optional_yield y)
+{
+  std::unique_lock l(m);
+  if (bl.length() > info.params.max_entry_size) {
+    // don't fail everyone else's entries along with it
+    ldpp_dout(dpp, -1) << __PRETTY_FUNCTION__ << ":" << __LINE__
+		       << " entry bigger than max_entry_size" << dendl;
+    return -E2BIG;
+  }
+  if (!push_batch) {
+    push_batch = std::make_shared<PushBatch>();
+  }
+  auto b = push_batch;
+  b->entries.push_back(bl);
+  while (!b->done) {
+    if (!pushing) {
+      // b is still the open batch: close it and send it
+      pushing = true;
+      push_batch.reset();
+      l.unlock();
+      ldpp_dout(dpp, 20) << __PRETTY_FUNCTION__ << ":" << __LINE__
+			 << " pushing group of " << b->entries.size()
+			 << dendl;
+      auto r = push(dpp, b->entries, y);
+      l.lock();
+      pushing = false;
+      b->r = r;
+      b->done = true;
+      b->wake();
+      if (push_batch) {
+	// let one of the next group's callers take over
+	push_batch->wake();
+      }
+      break;
+    }
+    b->wait(l, y);
+  }
+  return b->r;
+}
+
 int FIFO::push(const DoutPrefixProvider *dpp, const cb::list& bl, optional_yield y) {
+  if (cct->_conf.get_val<bool>("rgw_fifo_group_push")) {
+    return push_grouped(dpp, bl, y);
+  }
   return push(dpp, std::vector{ bl }, y);
 }
 
@@ -96,6 +96,8 @@ using part_info = fifo::part_header;
 /// Please see the librados documentation for information on
 /// AioCompletion and IoCtx.
 
+struct PushBatch;
+
 class FIFO {
   friend struct Reader;
   friend struct Updater;
@@ -115,6 +117,11 @@ class FIFO {
 
   fifo::info info;
 
+  /// Single-entry pushes that arrive while another is in flight are
+  /// gathered here and pushed together by one of their callers.
+  std::shared_ptr<PushBatch> push_batch;
+  bool pushing = false;
+
   std::uint32_t part_header_size = 0xdeadbeef;
   std::uint32_t part_entry_overhead = 0xdeadbeef;
 
@@ -148,6 +155,8 @@ class FIFO {
   void _prepare_new_head(const DoutPrefixProvider *dpp, std::int64_t new_head_part_num, std::uint64_t tid, lr::AioCompletion* c);
   int push_entries(const DoutPrefixProvider *dpp, const std::deque<cb::list>& data_bufs,
 		   std::uint64_t tid, optional_yield y);
+  int push_grouped(const DoutPrefixProvider *dpp, const cb::list& bl,
+		   optional_yield y);
   void push_entries(const std::deque<cb::list>& data_bufs,
 		    std::uint64_t tid, lr::AioCompletion* c);
   int trim_part(const DoutPrefixProvider *dpp, int64_t part_num, uint64_t ofs,
@@ -91,6 +91,10 @@ void D3nDataCache::init(CephContext *_cct) {
                               "' : " << e.what() << dendl;
   }
 
+  admission_threshold = std::max<uint64_t>(cct->_conf->rgw_d3n_l1_admission_threshold, 1);
+  max_miss_entries = 2 * std::max<uint64_t>(cct->_conf->rgw_d3n_l1_datacache_size /
+                                            std::max<uint64_t>(cct->_conf->rgw_obj_stripe_size, 1), 1);
+
   auto conf_eviction_policy = cct->_conf.get_val<std::string>("rgw_d3n_l1_eviction_policy");
   ceph_assert(conf_eviction_policy == "lru" || conf_eviction_policy == "random");
   if (conf_eviction_policy == "lru")
@@ -229,8 +233,15 @@ void D3nDataCache::put(bufferlist& bl, unsigned int len, std::string& oid)
       ldout(cct, 10) << "D3nDataCache: NOTE: data put in cache already issued, no rewrite" << dendl;
       return;
     }
+    if (!admit(oid)) {
+      ldout(cct, 20) << "D3nDataCache: " << __func__ << "(): not admitted yet, oid=" << oid << dendl;
+      return;
+    }
     d3n_outstanding_write_list.insert(oid);
   }
+  if (perfcounter) {
+    perfcounter->inc(l_rgw_d3n_cache_admit);
+  }
   {
     const std::lock_guard l(d3n_eviction_lock);
     _free_data_cache_size = free_data_cache_size;
@@ -269,6 +280,30 @@ void D3nDataCache::put(bufferlist& bl, unsigned int len, std::string& oid)
   outstanding_write_size += len;
 }
 
+bool D3nDataCache::admit(const std::string& oid)
+{
+  if (admission_threshold <= 1) {
+    return true;
+  }
+  auto iter = d3n_miss_map.find(oid);
+  if (iter == d3n_miss_map.end()) {
+    d3n_miss_lru.push_front(oid);
+    d3n_miss_map.emplace(oid, std::make_pair(1, d3n_miss_lru.begin()));
+    while (d3n_miss_map.size() > max_miss_entries) {
+      d3n_miss_map.erase(d3n_miss_lru.back());
+      d3n_miss_lru.pop_back();
+    }
+    return false;
+  }
+  if (++iter->second.first < admission_threshold) {
+    d3n_miss_lru.splice(d3n_miss_lru.begin(), d3n_miss_lru, iter->second.second);
+    return false;
+  }
+  d3n_miss_lru.erase(iter->second.second);
+  d3n_miss_map.erase(iter);
+  return true;
+}
+
 bool D3nDataCache::get(const string& oid, const off_t len)
 {
   const std::lock_guard l(d3n_cache_lock);
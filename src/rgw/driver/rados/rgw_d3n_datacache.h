@@ -13,6 +13,7 @@
 #include "include/Context.h"
 #include "include/lru.h"
 #include "rgw_d3n_cacherequest.h"
+#include "rgw_perf_counters.h"
 
 
 /*D3nDataCache*/
@@ -82,8 +83,17 @@ private:
   struct D3nChunkDataInfo* head;
   struct D3nChunkDataInfo* tail;
 
+  // chunks that missed but were not admitted yet, with their miss count,
+  // most recent first; protected by d3n_cache_lock
+  uint64_t admission_threshold = 1;
+  size_t max_miss_entries = 0;
+  std::list<std::string> d3n_miss_lru;
+  std::unordered_map<std::string,
+                     std::pair<uint64_t, std::list<std::string>::iterator>> d3n_miss_map;
+
 private:
   void add_io();
+  bool admit(const std::string& oid);
 
 public:
   D3nDataCache();
@@ -238,6 +248,10 @@ int D3nRGWDataCache<T>::get_obj_iterate_cb(const DoutPrefixProvider *dpp, const
     }
 
     if (d->rgwrados->d3n_data_cache->get(oid, len)) {
+      if (perfcounter) {
+        perfcounter->inc(l_rgw_d3n_cache_hit);
+        perfcounter->inc(l_rgw_d3n_cache_hit_b, len);
+      }
       // Read From Cache
       ldpp_dout(dpp, 20) << "D3nDataCache: " << __func__ << "(): READ FROM CACHE: oid=" << read_obj.oid << ", obj-ofs=" << obj_ofs << ", read_ofs=" << read_ofs << ", len=" << len << dendl;
       auto completed = d->aio->get(ref.obj, rgw::Aio::d3n_cache_op(dpp, d->yield, read_ofs, len, d->rgwrados->d3n_data_cache->cache_location), cost, id);
@@ -247,6 +261,10 @@ int D3nRGWDataCache<T>::get_obj_iterate_cb(const DoutPrefixProvider *dpp, const
       }
       return r;
     } else {
+      if (perfcounter) {
+        perfcounter->inc(l_rgw_d3n_cache_miss);
+        perfcounter->inc(l_rgw_d3n_cache_miss_b, len);
+      }
       // Write To Cache
       ldpp_dout(dpp, 20) << "D3nDataCache: " << __func__ << "(): WRITE TO CACHE: oid=" << read_obj.oid << ", obj-ofs=" << obj_ofs << ", read_ofs=" << read_ofs << " len=" << len << dendl;
       auto completed = d->aio->get(ref.obj, rgw::Aio::librados_op(ref.pool.ioctx(), std::move(op), d->yield), cost, id);
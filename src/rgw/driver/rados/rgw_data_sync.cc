@@ -4025,6 +4025,34 @@ public:
   }
 };
 
+/* lists the next batch of a full sync while the current one is being
+ * synced; the listing status is returned through *pret rather than the
+ * stack, so that the caller's drain doesn't mistake it for an object
+ * sync failure */
+class RGWPrefetchRemoteBucketCR : public RGWCoroutine {
+  RGWDataSyncCtx *sc;
+  const rgw_bucket_shard& bs;
+  rgw_obj_key marker_position;
+  bucket_list_result *result;
+  int *pret;
+
+public:
+  RGWPrefetchRemoteBucketCR(RGWDataSyncCtx *_sc, const rgw_bucket_shard& bs,
+                            const rgw_obj_key& _marker_position,
+                            bucket_list_result *_result, int *_pret)
+    : RGWCoroutine(_sc->cct), sc(_sc), bs(bs),
+      marker_position(_marker_position), result(_result), pret(_pret) {}
+
+  int operate(const DoutPrefixProvider *dpp) override {
+    reenter(this) {
+      yield call(new RGWListRemoteBucketCR(sc, bs, marker_position, result));
+      *pret = retcode;
+      return set_cr_done();
+    }
+    return 0;
+  }
+};
+
 struct next_bilog_result {
   uint64_t generation = 0;
   int num_shards = 0;
@@ -4466,6 +4494,13 @@ class RGWBucketFullSyncCR : public RGWCoroutine {
   rgw_obj_key list_marker;
   bucket_list_entry *entry{nullptr};
 
+  /* listing of the batch after list_result, started at prefetch_marker */
+  boost::intrusive_ptr<RGWCoroutine> prefetch_cr;
+  rgw_obj_key prefetch_marker;
+  bucket_list_result prefetch_result;
+  int prefetch_ret{0};
+  int drain_left{0};
+
   int total_entries{0};
 
   int sync_result{0};
@@ -4571,7 +4606,30 @@ int RGWBucketFullSyncCR::operate(const DoutPrefixProvider *dpp)
         break;
       }
 
-      yield call(new RGWListRemoteBucketCR(sc, bs, list_marker, &list_result));
+      if (prefetch_cr) {
+        /* wait for the listing started with the previous batch */
+        while (!prefetch_cr->is_done()) {
+          drain_left = num_spawned() - 1;
+          drain_with_cb(drain_left,
+                        [&](uint64_t stack_id, int ret) {
+                if (ret < 0) {
+                  tn->log(10, "a sync operation returned error");
+                  sync_result = ret;
+                }
+                return 0;
+              });
+        }
+        prefetch_cr.reset();
+        if (prefetch_marker == list_marker) {
+          list_result = std::move(prefetch_result);
+          retcode = prefetch_ret;
+        } else {
+          /* the marker moved on to another prefix, list again */
+          yield call(new RGWListRemoteBucketCR(sc, bs, list_marker, &list_result));
+        }
+      } else {
+        yield call(new RGWListRemoteBucketCR(sc, bs, list_marker, &list_result));
+      }
       if (retcode < 0 && retcode != -ENOENT) {
         set_status("failed bucket listing, going down");
         drain_all();
@@ -4581,6 +4639,16 @@ int RGWBucketFullSyncCR::operate(const DoutPrefixProvider *dpp)
       if (list_result.entries.size() > 0) {
         tn->set_flag(RGW_SNS_FLAG_ACTIVE); /* actually have entries to sync */
       }
+      if (list_result.is_truncated && !list_result.entries.empty()) {
+        /* list the next batch while this one is synced */
+        prefetch_marker = list_result.entries.back().key;
+        prefetch_result = bucket_list_result();
+        prefetch_ret = 0;
+        prefetch_cr = new RGWPrefetchRemoteBucketCR(sc, bs, prefetch_marker,
+                                                    &prefetch_result,
+                                                    &prefetch_ret);
+        spawn(prefetch_cr.get(), false);
+      }
       entries_iter = list_result.entries.begin();
       for (; entries_iter != list_result.entries.end(); ++entries_iter) {
         if (lease_cr && !lease_cr->is_locked()) {
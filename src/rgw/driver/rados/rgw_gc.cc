@@ -580,7 +580,7 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
   bool truncated = false;
   IoCtx *ctx = new IoCtx;
   do {
-    int max = 100;
+    int max = cct->_conf->rgw_gc_max_list_chunk;
     std::list<cls_rgw_gc_obj_info> entries;
 
     int ret = 0;
@@ -628,6 +628,15 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
 
     marker = next_marker;
 
+    if (perfcounter && expired_only && !entries.empty()) {
+      /* entries are listed oldest first, report how long the first one has
+       * been waiting since it became eligible */
+      const auto age = ceph::real_clock::now() - entries.front().time;
+      perfcounter->set(l_rgw_gc_backlog_age,
+                       std::max<int64_t>(
+                         std::chrono::duration_cast<std::chrono::seconds>(age).count(), 0));
+    }
+
     string last_pool;
     std::list<cls_rgw_gc_obj_info>::iterator iter;
     for (iter = entries.begin(); iter != entries.end(); ++iter) {
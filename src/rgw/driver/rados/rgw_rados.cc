@@ -5,6 +5,7 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <deque>
 #include <sstream>
 
 #include <boost/algorithm/string.hpp>
@@ -751,12 +752,36 @@ struct complete_op_data {
   }
 };
 
+// completions queued behind a batch in flight to the same bucket index
+// shard; shared with the batches' callbacks, which may run after the
+// manager has been stopped
+struct complete_batch_queues {
+  struct shard_queue {
+    RGWSI_RADOS::Obj bucket_obj;
+    bool in_flight{false};
+    std::deque<complete_op_data*> pending;
+  };
+
+  ceph::mutex lock = ceph::make_mutex("complete_batch_queues");
+  bool stopped{false};
+  std::map<rgw_raw_obj, shard_queue> shards;
+};
+
+struct complete_batch_data {
+  std::shared_ptr<complete_batch_queues> queues;
+  RGWIndexCompletionManager *manager{nullptr};
+  rgw_raw_obj shard_obj;
+  std::vector<complete_op_data*> entries;
+};
+
 class RGWIndexCompletionManager {
   RGWRados* const store;
   const uint32_t num_shards;
   ceph::containers::tiny_vector<ceph::mutex> locks;
   std::vector<set<complete_op_data*>> completions;
   std::vector<complete_op_data*> retry_completions;
+  std::shared_ptr<complete_batch_queues> batch_queues =
+    std::make_shared<complete_batch_queues>();
 
   std::condition_variable cond;
   std::mutex retry_completions_lock;
@@ -771,7 +796,11 @@ class RGWIndexCompletionManager {
   void process();
   
   void add_completion(complete_op_data *completion);
-  
+
+  // batch_queues->lock held
+  int send_batch(const rgw_raw_obj& shard_obj,
+                 complete_batch_queues::shard_queue& q);
+
   void stop() {
     if (retry_thread.joinable()) {
       _stop = true;
@@ -779,6 +808,21 @@ class RGWIndexCompletionManager {
       retry_thread.join();
     }
 
+    {
+      // batches still in flight free their completions when they return;
+      // the ones that were never sent are ours to free
+      std::lock_guard bl{batch_queues->lock};
+      batch_queues->stopped = true;
+      for (auto& [shard_obj, q] : batch_queues->shards) {
+        for (auto c : q.pending) {
+          std::lock_guard l{locks[c->manager_shard_id]};
+          completions[c->manager_shard_id].erase(c);
+          delete c;
+        }
+      }
+      batch_queues->shards.clear();
+    }
+
     for (uint32_t i = 0; i < num_shards; ++i) {
       std::lock_guard l{locks[i]};
       for (auto c : completions[i]) {
@@ -818,9 +862,20 @@ public:
                          list<cls_rgw_obj_key> *remove_objs, bool log_op,
                          uint16_t bilog_op,
                          rgw_zone_set *zones_trace,
+                         bool batched,
                          complete_op_data **result);
 
-  bool handle_completion(completion_t cb, complete_op_data *arg);
+  bool handle_completion(int r, complete_op_data *arg);
+
+  uint32_t get_batch_size() const {
+    return store->ctx()->_conf->rgw_bucket_index_complete_batch_size;
+  }
+  // send @entry to the index shard now, or with the next batch if one
+  // is already in flight to it
+  int queue_completion(const RGWSI_RADOS::Obj& bucket_obj,
+                       complete_op_data *entry);
+  // batch_queues->lock held
+  void handle_batch_completion(complete_batch_data *batch, int r);
 
   CephContext* ctx() {
     return store->ctx();
@@ -836,13 +891,30 @@ static void obj_complete_cb(completion_t cb, void *arg)
     delete completion;
     return;
   }
-  bool need_delete = completion->manager->handle_completion(cb, completion);
+  bool need_delete = completion->manager->handle_completion(
+    rados_aio_get_return_value(cb), completion);
   completion->lock.unlock();
   if (need_delete) {
     delete completion;
   }
 }
 
+static void obj_batch_complete_cb(completion_t cb, void *arg)
+{
+  std::unique_ptr<complete_batch_data> batch{
+    reinterpret_cast<complete_batch_data*>(arg)};
+  auto queues = batch->queues;
+  std::lock_guard l{queues->lock};
+  if (queues->stopped) {
+    for (auto c : batch->entries) {
+      delete c;
+    }
+    return;
+  }
+  batch->manager->handle_batch_completion(batch.get(),
+                                          rados_aio_get_return_value(cb));
+}
+
 void RGWIndexCompletionManager::process()
 {
   DoutPrefix dpp(store->ctx(), dout_subsys, "rgw index completion thread: ");
@@ -914,6 +986,7 @@ void RGWIndexCompletionManager::create_completion(const rgw_obj& obj,
                                                   list<cls_rgw_obj_key> *remove_objs, bool log_op,
                                                   uint16_t bilog_op,
                                                   rgw_zone_set *zones_trace,
+                                                  bool batched,
                                                   complete_op_data **result)
 {
   complete_op_data *entry = new complete_op_data;
@@ -945,7 +1018,9 @@ void RGWIndexCompletionManager::create_completion(const rgw_obj& obj,
 
   *result = entry;
 
-  entry->rados_completion = librados::Rados::aio_create_completion(entry, obj_complete_cb);
+  if (!batched) {
+    entry->rados_completion = librados::Rados::aio_create_completion(entry, obj_complete_cb);
+  }
 
   std::lock_guard l{locks[shard_id]};
   const auto ok = completions[shard_id].insert(entry).second;
@@ -960,7 +1035,7 @@ void RGWIndexCompletionManager::add_completion(complete_op_data *completion) {
   cond.notify_all();
 }
 
-bool RGWIndexCompletionManager::handle_completion(completion_t cb, complete_op_data *arg)
+bool RGWIndexCompletionManager::handle_completion(int r, complete_op_data *arg)
 {
   int shard_id = arg->manager_shard_id;
   {
@@ -977,7 +1052,6 @@ bool RGWIndexCompletionManager::handle_completion(completion_t cb, complete_op_d
     comps.erase(iter);
   }
 
-  int r = rados_aio_get_return_value(cb);
   if (r != -ERR_BUSY_RESHARDING) {
     ldout(arg->manager->ctx(), 20) << __func__ << "(): completion " << 
       (r == 0 ? "ok" : "failed with " + to_string(r)) << 
@@ -989,6 +1063,121 @@ bool RGWIndexCompletionManager::handle_completion(completion_t cb, complete_op_d
   return false;
 }
 
+int RGWIndexCompletionManager::queue_completion(const RGWSI_RADOS::Obj& bucket_obj,
+                                                complete_op_data *entry)
+{
+  std::lock_guard l{batch_queues->lock};
+  const auto& shard_obj = bucket_obj.get_raw_obj();
+  auto& q = batch_queues->shards[shard_obj];
+  q.pending.push_back(entry);
+  if (q.in_flight) {
+    return 0;
+  }
+  q.bucket_obj = bucket_obj;
+  return send_batch(shard_obj, q);
+}
+
+int RGWIndexCompletionManager::send_batch(const rgw_raw_obj& shard_obj,
+                                          complete_batch_queues::shard_queue& q)
+{
+  auto batch = std::make_unique<complete_batch_data>();
+  batch->queues = batch_queues;
+  batch->manager = this;
+  batch->shard_obj = shard_obj;
+
+  // reads within the batch don't see the index entries it has already
+  // written, so completions touching the same object go in separate
+  // batches
+  std::set<std::string> names;
+  const uint32_t max_batch = std::max(get_batch_size(), 1u);
+  while (!q.pending.empty() && batch->entries.size() < max_batch) {
+    auto c = q.pending.front();
+    std::vector<std::string> c_names{c->key.name};
+    for (const auto& k : c->remove_objs) {
+      c_names.push_back(k.name);
+    }
+    if (!batch->entries.empty() &&
+        std::any_of(c_names.begin(), c_names.end(),
+                    [&](const std::string& n) { return names.count(n) > 0; })) {
+      break;
+    }
+    names.insert(c_names.begin(), c_names.end());
+    batch->entries.push_back(c);
+    q.pending.pop_front();
+  }
+
+  librados::ObjectWriteOperation o;
+  o.assert_exists(); // bucket index shard must exist
+  cls_rgw_guard_bucket_resharding(o, -ERR_BUSY_RESHARDING);
+  if (batch->entries.size() == 1) {
+    auto c = batch->entries.front();
+    cls_rgw_bucket_complete_op(o, c->op, c->tag, c->ver, c->key, c->dir_meta,
+                               &c->remove_objs, c->log_op, c->bilog_op,
+                               &c->zones_trace);
+  } else {
+    std::vector<rgw_cls_obj_complete_op> ops;
+    ops.reserve(batch->entries.size());
+    for (auto c : batch->entries) {
+      auto& call = ops.emplace_back();
+      call.op = c->op;
+      call.tag = c->tag;
+      call.key = c->key;
+      call.ver = c->ver;
+      call.meta = c->dir_meta;
+      call.log_op = c->log_op;
+      call.bilog_flags = c->bilog_op;
+      call.remove_objs = c->remove_objs;
+      call.zones_trace = c->zones_trace;
+    }
+    cls_rgw_bucket_complete_ops(o, ops);
+  }
+  ldout(ctx(), 20) << __func__ << "(): sending " << batch->entries.size()
+                   << " completion(s) to " << shard_obj << dendl;
+
+  auto entries = batch->entries;
+  librados::AioCompletion *completion =
+    librados::Rados::aio_create_completion(batch.get(), obj_batch_complete_cb);
+  int ret = q.bucket_obj.aio_operate(completion, &o);
+  completion->release();
+  if (ret < 0) {
+    for (auto c : entries) {
+      if (handle_completion(ret, c)) {
+        delete c;
+      }
+    }
+    return ret;
+  }
+  batch.release(); // owned by obj_batch_complete_cb()
+  q.in_flight = true;
+  return 0;
+}
+
+void RGWIndexCompletionManager::handle_batch_completion(complete_batch_data *batch,
+                                                        int r)
+{
+  for (auto c : batch->entries) {
+    if (handle_completion(r, c)) {
+      delete c;
+    }
+  }
+
+  auto iter = batch_queues->shards.find(batch->shard_obj);
+  if (iter == batch_queues->shards.end()) {
+    return;
+  }
+  auto& q = iter->second;
+  q.in_flight = false;
+  while (!q.pending.empty() && !q.in_flight) {
+    if (send_batch(batch->shard_obj, q) < 0) {
+      ldout(ctx(), 0) << "ERROR: " << __func__ << "(): failed to send "
+                      "bucket index completions to " << batch->shard_obj << dendl;
+    }
+  }
+  if (!q.in_flight) {
+    batch_queues->shards.erase(iter);
+  }
+}
+
 void RGWRados::finalize()
 {
   /* Before joining any sync threads, drain outstanding requests &
@@ -1090,7 +1279,7 @@ int RGWRados::init_rados()
 
   auto crs = std::unique_ptr<RGWCoroutinesManagerRegistry>{
     new RGWCoroutinesManagerRegistry(cct)};
-  ret = crs->hook_to_admin_command("cr dump");
+  ret = crs->hook_to_admin_command("cr dump", "cr profile");
   if (ret < 0) {
     return ret;
   }
@@ -6561,7 +6750,9 @@ int get_obj_data::flush(rgw::AioResultList&& results) {
 
     bl_list.push_back(bl);
     offset += bl.length();
+    const auto start = ceph::mono_clock::now();
     int r = client_cb->handle_data(bl, 0, bl.length());
+    client_wait += ceph::mono_clock::now() - start;
     if (r < 0) {
       return r;
     }
@@ -6581,6 +6772,63 @@ int get_obj_data::flush(rgw::AioResultList&& results) {
   return 0;
 }
 
+// window growth in use by all object reads, bounded by
+// rgw_get_obj_window_budget
+static std::atomic<uint64_t> get_obj_window_reserved = 0;
+
+static uint64_t reserve_get_obj_window(uint64_t want, uint64_t budget)
+{
+  uint64_t cur = get_obj_window_reserved.load();
+  uint64_t got;
+  do {
+    got = std::min(want, budget - std::min(cur, budget));
+    if (got == 0) {
+      return 0;
+    }
+  } while (!get_obj_window_reserved.compare_exchange_weak(cur, cur + got));
+  return got;
+}
+
+void get_obj_data::adapt_window(uint64_t bytes)
+{
+  if (max_window <= base_window) {
+    return;
+  }
+  // judge once per window's worth of reads
+  period_bytes += bytes;
+  if (period_bytes < window) {
+    return;
+  }
+  const uint64_t old_window = window;
+  if (rados_wait > client_wait && window < max_window) {
+    const uint64_t budget =
+      rgwrados->ctx()->_conf->rgw_get_obj_window_budget;
+    const uint64_t got = reserve_get_obj_window(
+      std::min(window, max_window - window), budget);
+    window += got;
+    reserved_window += got;
+  } else if (client_wait > 2 * rados_wait && window > base_window) {
+    const uint64_t give = std::min(window - base_window, window / 2);
+    window -= give;
+    reserved_window -= give;
+    get_obj_window_reserved -= give;
+  }
+  if (window != old_window) {
+    ldout(rgwrados->ctx(), 20) << "get_obj_data: read window " << old_window
+        << " -> " << window << ", waited on rados " << rados_wait
+        << ", on client " << client_wait << dendl;
+    aio->resize(window);
+  }
+  period_bytes = 0;
+  rados_wait = client_wait = ceph::timespan::zero();
+}
+
+void get_obj_data::release_window()
+{
+  get_obj_window_reserved -= reserved_window;
+  reserved_window = 0;
+}
+
 static int _get_obj_iterate_cb(const DoutPrefixProvider *dpp,
                                const rgw_raw_obj& read_obj, off_t obj_ofs,
                                off_t read_ofs, off_t len, bool is_head_obj,
@@ -6637,7 +6885,10 @@ int RGWRados::get_obj_iterate_cb(const DoutPrefixProvider *dpp,
   const uint64_t id = obj_ofs; // use logical object offset for sorting replies
 
   auto& ref = obj.get_ref();
+  const auto start = ceph::mono_clock::now();
   auto completed = d->aio->get(ref.obj, rgw::Aio::librados_op(ref.pool.ioctx(), std::move(op), d->yield), cost, id);
+  d->rados_wait += ceph::mono_clock::now() - start;
+  d->adapt_window(cost);
 
   return d->flush(std::move(completed));
 }
@@ -6652,6 +6903,7 @@ int RGWRados::Object::Read::iterate(const DoutPrefixProvider *dpp, int64_t ofs,
 
   auto aio = rgw::make_throttle(window_size, y);
   get_obj_data data(store, cb, &*aio, ofs, y);
+  data.init_window(window_size, cct->_conf->rgw_get_obj_max_window_size);
 
   int r = store->iterate_obj(dpp, source->get_ctx(), source->get_bucket_info(), state.obj,
                              ofs, end, chunk_size, _get_obj_iterate_cb, &data, y);
@@ -8541,9 +8793,6 @@ int RGWRados::cls_obj_complete_op(BucketShard& bs, const rgw_obj& obj, RGWModify
     ", remove_objs=" << (remove_objs ? *remove_objs : std::list<rgw_obj_index_key>()) << dendl_bitx;
   ldout_bitx_c(bitx, cct, 25) << "BACKTRACE: " << __func__ << ": " << ClibBackTrace(0) << dendl_bitx;
 
-  ObjectWriteOperation o;
-  o.assert_exists(); // bucket index shard must exist
-
   rgw_bucket_dir_entry_meta dir_meta;
   dir_meta = ent.meta;
   dir_meta.category = category;
@@ -8558,12 +8807,24 @@ int RGWRados::cls_obj_complete_op(BucketShard& bs, const rgw_obj& obj, RGWModify
   ver.pool = pool;
   ver.epoch = epoch;
   cls_rgw_obj_key key(ent.key.name, ent.key.instance);
+  complete_op_data *arg;
+  if (index_completion_manager->get_batch_size() > 1) {
+    index_completion_manager->create_completion(obj, op, tag, ver, key, dir_meta, remove_objs,
+                                                svc.zone->need_to_log_data(), bilog_flags, &zones_trace,
+                                                true, &arg);
+    int ret = index_completion_manager->queue_completion(bs.bucket_obj, arg);
+    ldout_bitx_c(bitx, cct, 10) << "EXITING " << __func__ << ": ret=" << ret << dendl_bitx;
+    return ret;
+  }
+
+  ObjectWriteOperation o;
+  o.assert_exists(); // bucket index shard must exist
   cls_rgw_guard_bucket_resharding(o, -ERR_BUSY_RESHARDING);
   cls_rgw_bucket_complete_op(o, op, tag, ver, key, dir_meta, remove_objs,
                              svc.zone->need_to_log_data(), bilog_flags, &zones_trace);
-  complete_op_data *arg;
   index_completion_manager->create_completion(obj, op, tag, ver, key, dir_meta, remove_objs,
-                                              svc.zone->need_to_log_data(), bilog_flags, &zones_trace, &arg);
+                                              svc.zone->need_to_log_data(), bilog_flags, &zones_trace,
+                                              false, &arg);
   librados::AioCompletion *completion = arg->rados_completion;
   int ret = bs.bucket_obj.aio_operate(arg->rados_completion, &o);
   completion->release(); /* can't reference arg here, as it might have already been released */
@@ -8765,19 +9026,29 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     const std::string& oid_name;
     RGWRados::ent_map_t::iterator cursor;
     RGWRados::ent_map_t::iterator end;
+    uint32_t fetch_size;
 
     // manages an iterator through a shard and provides other
     // accessors
     ShardTracker(size_t _shard_idx,
 		 rgw_cls_list_ret& _result,
-		 const std::string& _oid_name):
+		 const std::string& _oid_name,
+		 uint32_t _fetch_size):
       shard_idx(_shard_idx),
       result(_result),
       oid_name(_oid_name),
       cursor(_result.dir.m.begin()),
-      end(_result.dir.m.end())
+      end(_result.dir.m.end()),
+      fetch_size(_fetch_size)
     {}
 
+    // replace the consumed results with the next batch from the shard
+    void reset(rgw_cls_list_ret&& next) {
+      result = std::move(next);
+      cursor = result.dir.m.begin();
+      end = result.dir.m.end();
+    }
+
     inline const std::string& entry_name() const {
       return cursor->first;
     }
@@ -8808,11 +9079,36 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     return;
   };
 
+  // when a shard that has more entries runs dry while merging, it is
+  // contributing to the listing, so read another (larger) batch from
+  // just that shard rather than ending the listing early; with a
+  // delimiter the marker semantics around common prefixes are left to
+  // the caller, which re-lists with a larger expansion_factor instead
+  auto refill_shard = [&](ShardTracker& t,
+			  const cls_rgw_obj_key& marker) -> int {
+    t.fetch_size = std::min(num_entries, t.fetch_size * 2);
+    std::map<int, std::string> oids{{int(t.shard_idx), t.oid_name}};
+    std::map<int, rgw_cls_list_ret> results;
+    int ret = CLSRGWIssueBucketList(ioctx, marker, prefix, delimiter,
+				    t.fetch_size, list_versions, oids,
+				    results, 1)();
+    if (ret < 0) {
+      return ret;
+    }
+    ldpp_dout(dpp, 20) << __func__ << ": read " <<
+      results[t.shard_idx].dir.m.size() << " more entries from shard " <<
+      t.shard_idx << " after \"" << marker << "\"" << dendl;
+    *cls_filtered = *cls_filtered && results[t.shard_idx].cls_filtered;
+    t.reset(std::move(results[t.shard_idx]));
+    return 0;
+  };
+
   // one tracker per shard requested (may not be all shards)
   std::vector<ShardTracker> results_trackers;
   results_trackers.reserve(shard_list_results.size());
   for (auto& r : shard_list_results) {
-    results_trackers.emplace_back(r.first, r.second, shard_oids[r.first]);
+    results_trackers.emplace_back(r.first, r.second, shard_oids[r.first],
+				  num_entries_per_shard);
 
     // if any *one* shard's result is trucated, the entire result is
     // truncated
@@ -8839,8 +9135,9 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     ++tracker_idx;
   }
 
-  rgw_bucket_dir_entry*
-    last_entry_visited = nullptr; // to set last_entry (marker)
+  // to set last_entry (marker); a copy since shard results may be
+  // replaced by refill_shard()
+  std::optional<cls_rgw_obj_key> last_entry_visited;
   std::map<std::string, bufferlist> updates;
   uint32_t count = 0;
   while (count < num_entries && !candidates.empty()) {
@@ -8893,7 +9190,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
 	dirent_key << dendl;
 
       auto [it, inserted] = m.insert_or_assign(name, std::move(dirent));
-      last_entry_visited = &it->second;
+      last_entry_visited = it->second.key;
       if (inserted) {
 	++count;
       } else {
@@ -8904,7 +9201,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     } else {
       ldpp_dout(dpp, 10) << __func__ << ": skipping " <<
 	dirent.key.name << "[" << dirent.key.instance << "]" << dendl;
-      last_entry_visited = &tracker.dir_entry();
+      last_entry_visited = tracker.dir_entry().key;
     }
 
     // refresh the candidates map
@@ -8918,6 +9215,17 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     for (auto idx : vidx) {
       auto& tracker_match = results_trackers.at(idx);
       tracker_match.advance();
+      if (tracker_match.at_end() && tracker_match.is_truncated() &&
+	  delimiter.empty() && count < num_entries) {
+	r = refill_shard(tracker_match, dirent_key);
+	if (r < 0) {
+	  ldpp_dout(dpp, 0) << __func__ <<
+	    ": failed to read more entries from shard " <<
+	    tracker_match.shard_idx << " of " << bucket_info.bucket <<
+	    ": r=" << r << dendl;
+	  return r;
+	}
+      }
       next_candidate(cct, tracker_match, candidates, idx);
       if (tracker_match.at_end() && tracker_match.is_truncated()) {
         need_to_stop = true;
@@ -8973,8 +9281,8 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
       count << ", which is truncated" << dendl;
   }
 
-  if (last_entry_visited != nullptr && last_entry) {
-    *last_entry = last_entry_visited->key;
+  if (last_entry_visited && last_entry) {
+    *last_entry = *last_entry_visited;
     ldpp_dout(dpp, 20) << __func__ <<
       ": returning, last_entry=" << *last_entry << dendl;
   } else {
@@ -1613,15 +1613,36 @@ struct get_obj_data {
   rgw::AioResultList completed; // completed read results, sorted by offset
   optional_yield yield;
 
+  // the read window grows while we wait on rados longer than on the
+  // client, and shrinks back when the client is the bottleneck; growth
+  // beyond base_window is reserved from rgw_get_obj_window_budget
+  uint64_t base_window = 0;
+  uint64_t window = 0;
+  uint64_t max_window = 0;
+  uint64_t reserved_window = 0;
+  uint64_t period_bytes = 0;
+  ceph::timespan rados_wait = ceph::timespan::zero();
+  ceph::timespan client_wait = ceph::timespan::zero();
+
   get_obj_data(RGWRados* rgwrados, RGWGetDataCB* cb, rgw::Aio* aio,
                uint64_t offset, optional_yield yield)
                : rgwrados(rgwrados), client_cb(cb), aio(aio), offset(offset), yield(yield) {}
   ~get_obj_data() {
+    release_window();
     if (rgwrados->get_use_datacache()) {
       const std::lock_guard l(d3n_get_data.d3n_lock);
     }
   }
 
+  void init_window(uint64_t base, uint64_t max) {
+    base_window = window = base;
+    max_window = std::max(base, max);
+  }
+  // called with each read issued, after the time spent waiting for room
+  // in the window was added to rados_wait
+  void adapt_window(uint64_t bytes);
+  void release_window();
+
   D3nGetObjData d3n_get_data;
   std::atomic_bool d3n_bypass_cache_write{false};
 
@@ -1,8 +1,11 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 // vim: ts=8 sw=2 smarttab ft=cpp
 
+#include <algorithm>
+#include <condition_variable>
 #include <limits>
 #include <sstream>
+#include <thread>
 
 #include "rgw_zone.h"
 #include "driver/rados/rgw_bucket.h"
@@ -21,6 +24,8 @@
 #include "services/svc_tier_rados.h"
 #include "services/svc_bilog_rados.h"
 
+#include "rgw_perf_counters.h"
+
 #define dout_context g_ceph_context
 #define dout_subsys ceph_subsys_rgw
 
@@ -792,6 +797,130 @@ int RGWBucketReshardLock::renew(const Clock::time_point& now) {
 }
 
 
+int RGWBucketReshard::renew_locks(const Clock::time_point& now,
+                                  const DoutPrefixProvider *dpp)
+{
+  if (!reshard_lock.should_renew(now)) {
+    return 0;
+  }
+  // assume outer locks have timespans at least the size of ours, so
+  // can call inside conditional
+  if (outer_reshard_lock) {
+    int ret = outer_reshard_lock->renew(now);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  int ret = reshard_lock.renew(now);
+  if (ret < 0) {
+    ldpp_dout(dpp, -1) << "Error renewing bucket lock: " << ret << dendl;
+    return ret;
+  }
+  return 0;
+}
+
+int RGWBucketReshard::reshard_shard(uint32_t shard,
+                                    BucketReshardManager& target_shards_mgr,
+                                    int max_entries,
+                                    bool renew,
+                                    ostream *out,
+                                    Formatter *formatter,
+                                    std::atomic<uint64_t>& total_entries,
+                                    const std::atomic<bool>* stop,
+                                    const DoutPrefixProvider *dpp,
+                                    optional_yield y)
+{
+  list<rgw_cls_bi_entry> entries;
+  bool is_truncated = true;
+  string marker;
+  const std::string null_object_filter; // empty string since we're not filtering by object
+  while (is_truncated) {
+    if (stop && *stop) {
+      return -ECANCELED;
+    }
+    entries.clear();
+    int ret = store->getRados()->bi_list(dpp, bucket_info, shard, null_object_filter, marker, max_entries, &entries, &is_truncated, y);
+    if (ret == -ENOENT) {
+      ldpp_dout(dpp, 1) << "WARNING: " << __func__ << " failed to find shard "
+          << shard << ", skipping" << dendl;
+      // break out of the is_truncated loop and move on to the next shard
+      break;
+    } else if (ret < 0) {
+      derr << "ERROR: bi_list(): " << cpp_strerror(-ret) << dendl;
+      return ret;
+    }
+
+    uint64_t copied = 0;
+    for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
+      rgw_cls_bi_entry& entry = *iter;
+      if (formatter) {
+        formatter->open_object_section("entry");
+
+        encode_json("shard_id", shard, formatter);
+        encode_json("num_entry", total_entries.load(), formatter);
+        encode_json("entry", entry, formatter);
+      }
+
+      marker = entry.idx;
+
+      int target_shard_id;
+      cls_rgw_obj_key cls_key;
+      RGWObjCategory category;
+      rgw_bucket_category_stats stats;
+      bool account = entry.get_info(&cls_key, &category, &stats);
+      rgw_obj_key key(cls_key);
+      if (entry.type == BIIndexType::OLH && key.empty()) {
+        // bogus entry created by https://tracker.ceph.com/issues/46456
+        // to fix, skip so it doesn't get include in the new bucket instance
+        ldpp_dout(dpp, 10) << "Dropping entry with empty name, idx=" << marker << dendl;
+        if (formatter) {
+          formatter->close_section();
+        }
+        continue;
+      }
+      uint64_t num = ++total_entries;
+      ++copied;
+      rgw_obj obj(bucket_info.bucket, key);
+      RGWMPObj mp;
+      if (key.ns == RGW_OBJ_NS_MULTIPART && mp.from_meta(key.name)) {
+        // place the multipart .meta object on the same shard as its head object
+        obj.index_hash_source = mp.get_key();
+      }
+      ret = store->getRados()->get_target_shard_id(bucket_info.layout.target_index->layout.normal,
+                                                   obj.get_hash_object(), &target_shard_id);
+      if (ret < 0) {
+        ldpp_dout(dpp, -1) << "ERROR: get_target_shard_id() returned ret=" << ret << dendl;
+        return ret;
+      }
+
+      int shard_index = (target_shard_id > 0 ? target_shard_id : 0);
+
+      ret = target_shards_mgr.add_entry(shard_index, entry, account,
+                                        category, stats);
+      if (ret < 0) {
+        return ret;
+      }
+
+      if (renew) {
+        ret = renew_locks(Clock::now(), dpp);
+        if (ret < 0) {
+          return ret;
+        }
+      }
+      if (formatter) {
+        formatter->close_section();
+        formatter->flush(*out);
+      } else if (out && !(num % 1000)) {
+        (*out) << " " << num;
+      }
+    } // entries loop
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_reshard_entries, copied);
+    }
+  }
+  return 0;
+}
+
 int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& current,
                                  const rgw::bucket_index_layout_generation& target,
                                  int max_entries,
@@ -805,16 +934,20 @@ int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& curr
     (*out) << "bucket name: " << bucket_info.bucket.name << std::endl;
   }
 
-  /* update bucket info -- in progress*/
-  list<rgw_cls_bi_entry> entries;
-
   if (max_entries < 0) {
     ldpp_dout(dpp, 0) << __func__ <<
       ": can't reshard, negative max_entries" << dendl;
     return -EINVAL;
   }
 
-  BucketReshardManager target_shards_mgr(dpp, store, bucket_info, target);
+  if (perfcounter) {
+    perfcounter->inc(l_rgw_reshard_active);
+  }
+  auto active = make_scope_guard([] {
+    if (perfcounter) {
+      perfcounter->dec(l_rgw_reshard_active);
+    }
+  });
 
   bool verbose_json_out = verbose && (formatter != nullptr) && (out != nullptr);
 
@@ -822,115 +955,109 @@ int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& curr
     formatter->open_array_section("entries");
   }
 
-  uint64_t total_entries = 0;
+  std::atomic<uint64_t> total_entries = 0;
 
   if (!verbose_json_out && out) {
     (*out) << "total entries:";
   }
 
   const uint32_t num_source_shards = rgw::num_shards(current.layout.normal);
-  string marker;
-  for (uint32_t i = 0; i < num_source_shards; ++i) {
-    bool is_truncated = true;
-    marker.clear();
-    const std::string null_object_filter; // empty string since we're not filtering by object
-    while (is_truncated) {
-      entries.clear();
-      int ret = store->getRados()->bi_list(dpp, bucket_info, i, null_object_filter, marker, max_entries, &entries, &is_truncated, y);
-      if (ret == -ENOENT) {
-        ldpp_dout(dpp, 1) << "WARNING: " << __func__ << " failed to find shard "
-            << i << ", skipping" << dendl;
-        // break out of the is_truncated loop and move on to the next shard
-        break;
-      } else if (ret < 0) {
-        derr << "ERROR: bi_list(): " << cpp_strerror(-ret) << dendl;
+  // verbose output lists the entries in index order, one shard at a time
+  const uint32_t concurrency = verbose_json_out ? 1 :
+    std::clamp<uint32_t>(
+      store->ctx()->_conf.get_val<uint64_t>("rgw_reshard_shard_concurrency"),
+      1, std::max(num_source_shards, 1u));
+
+  int ret = 0;
+  if (concurrency == 1) {
+    BucketReshardManager target_shards_mgr(dpp, store, bucket_info, target);
+    for (uint32_t i = 0; i < num_source_shards; ++i) {
+      ret = reshard_shard(i, target_shards_mgr, max_entries, true, out,
+                          verbose_json_out ? formatter : nullptr,
+                          total_entries, nullptr, dpp, y);
+      if (ret < 0) {
         return ret;
       }
+    }
+    if (target_shards_mgr.finish() < 0) {
+      ret = -EIO;
+    }
+  } else {
+    // each worker copies whole source shards through its own target shard
+    // writers; the stats updates they send are increments, so it doesn't
+    // matter which worker accounts for an entry. this thread keeps the
+    // locks alive meanwhile
+    std::atomic<uint32_t> next_shard = 0;
+    std::atomic<bool> stop = false;
+    std::mutex lock;
+    std::condition_variable cond;
+    uint32_t running = concurrency;
+    int worker_ret = 0;
+
+    std::vector<std::thread> workers;
+    workers.reserve(concurrency);
+    for (uint32_t w = 0; w < concurrency; ++w) {
+      workers.emplace_back([&] {
+        BucketReshardManager target_shards_mgr(dpp, store, bucket_info, target);
+        int r = 0;
+        for (uint32_t i = next_shard++; i < num_source_shards && !stop;
+             i = next_shard++) {
+          r = reshard_shard(i, target_shards_mgr, max_entries, false, nullptr,
+                            nullptr, total_entries, &stop, dpp, null_yield);
+          if (r < 0) {
+            break;
+          }
+        }
+        if (target_shards_mgr.finish() < 0 && r >= 0) {
+          r = -EIO;
+        }
+        std::lock_guard l{lock};
+        // the first failure is the one to report; the others are
+        // likely -ECANCELED from being stopped
+        if (r < 0 && worker_ret == 0) {
+          worker_ret = r;
+          stop = true;
+        }
+        --running;
+        cond.notify_all();
+      });
+    }
 
-      for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
-	rgw_cls_bi_entry& entry = *iter;
-	if (verbose_json_out) {
-	  formatter->open_object_section("entry");
-
-	  encode_json("shard_id", i, formatter);
-	  encode_json("num_entry", total_entries, formatter);
-	  encode_json("entry", entry, formatter);
-	}
-	total_entries++;
-
-	marker = entry.idx;
-
-	int target_shard_id;
-	cls_rgw_obj_key cls_key;
-	RGWObjCategory category;
-	rgw_bucket_category_stats stats;
-	bool account = entry.get_info(&cls_key, &category, &stats);
-	rgw_obj_key key(cls_key);
-	if (entry.type == BIIndexType::OLH && key.empty()) {
-	  // bogus entry created by https://tracker.ceph.com/issues/46456
-	  // to fix, skip so it doesn't get include in the new bucket instance
-	  total_entries--;
-	  ldpp_dout(dpp, 10) << "Dropping entry with empty name, idx=" << marker << dendl;
-	  continue;
-	}
-	rgw_obj obj(bucket_info.bucket, key);
-	RGWMPObj mp;
-	if (key.ns == RGW_OBJ_NS_MULTIPART && mp.from_meta(key.name)) {
-	  // place the multipart .meta object on the same shard as its head object
-	  obj.index_hash_source = mp.get_key();
-	}
-	ret = store->getRados()->get_target_shard_id(bucket_info.layout.target_index->layout.normal,
-						     obj.get_hash_object(), &target_shard_id);
-	if (ret < 0) {
-	  ldpp_dout(dpp, -1) << "ERROR: get_target_shard_id() returned ret=" << ret << dendl;
-	  return ret;
-	}
-
-	int shard_index = (target_shard_id > 0 ? target_shard_id : 0);
-
-	ret = target_shards_mgr.add_entry(shard_index, entry, account,
-					  category, stats);
-	if (ret < 0) {
-	  return ret;
-	}
-
-	Clock::time_point now = Clock::now();
-	if (reshard_lock.should_renew(now)) {
-	  // assume outer locks have timespans at least the size of ours, so
-	  // can call inside conditional
-	  if (outer_reshard_lock) {
-	    ret = outer_reshard_lock->renew(now);
-	    if (ret < 0) {
-	      return ret;
-	    }
-	  }
-	  ret = reshard_lock.renew(now);
-	  if (ret < 0) {
-	    ldpp_dout(dpp, -1) << "Error renewing bucket lock: " << ret << dendl;
-	    return ret;
-	  }
-	}
-	if (verbose_json_out) {
-	  formatter->close_section();
-	  formatter->flush(*out);
-	} else if (out && !(total_entries % 1000)) {
-	  (*out) << " " << total_entries;
-	}
-      } // entries loop
+    {
+      std::unique_lock l{lock};
+      while (running > 0) {
+        cond.wait_for(l, std::chrono::seconds(1));
+        if (stop) {
+          continue;
+        }
+        l.unlock();
+        int r = renew_locks(Clock::now(), dpp);
+        if (out) {
+          (*out) << " " << total_entries.load();
+        }
+        l.lock();
+        if (r < 0 && worker_ret == 0) {
+          worker_ret = r;
+          stop = true;
+        }
+      }
     }
+    for (auto& t : workers) {
+      t.join();
+    }
+    ret = worker_ret;
   }
 
   if (verbose_json_out) {
     formatter->close_section();
     formatter->flush(*out);
   } else if (out) {
-    (*out) << " " << total_entries << std::endl;
+    (*out) << " " << total_entries.load() << std::endl;
   }
 
-  int ret = target_shards_mgr.finish();
   if (ret < 0) {
     ldpp_dout(dpp, -1) << "ERROR: failed to reshard" << dendl;
-    return -EIO;
+    return ret;
   }
   return 0;
 } // RGWBucketReshard::do_reshard
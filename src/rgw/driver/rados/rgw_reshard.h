@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <initializer_list>
 #include <functional>
@@ -24,6 +25,7 @@
 
 
 class RGWReshard;
+class BucketReshardManager;
 namespace rgw { namespace sal {
   class RadosStore;
 } }
@@ -82,6 +84,19 @@ class RGWBucketReshard {
   // allocated in at once
   static const std::initializer_list<uint16_t> reshard_primes;
 
+  int renew_locks(const Clock::time_point& now,
+                  const DoutPrefixProvider *dpp);
+  // copies the entries of one source index shard to the target layout;
+  // returns -ECANCELED once *stop is set
+  int reshard_shard(uint32_t shard,
+                    BucketReshardManager& target_shards_mgr,
+                    int max_entries,
+                    bool renew,
+                    std::ostream *out,
+                    Formatter *formatter,
+                    std::atomic<uint64_t>& total_entries,
+                    const std::atomic<bool>* stop,
+                    const DoutPrefixProvider *dpp, optional_yield y);
   int do_reshard(const rgw::bucket_index_layout_generation& current,
                  const rgw::bucket_index_layout_generation& target,
                  int max_entries,
@@ -2392,12 +2392,11 @@ int RadosObject::swift_versioning_copy(const DoutPrefixProvider* dpp, optional_y
                                         y);
 }
 
-int RadosMultipartUpload::cleanup_part_history(const DoutPrefixProvider* dpp,
-                                               optional_yield y,
-                                               RadosMultipartPart *part,
-                                               list<rgw_obj_index_key>& remove_objs)
+void RadosMultipartUpload::cleanup_part_history(const DoutPrefixProvider* dpp,
+                                                RadosMultipartPart *part,
+                                                list<rgw_obj_index_key>& remove_objs,
+                                                cls_rgw_obj_chain& chain)
 {
-  cls_rgw_obj_chain chain;
   for (auto& ppfx : part->get_past_prefixes()) {
     rgw_obj past_obj;
     past_obj.init_ns(bucket->get_key(), ppfx + "." + std::to_string(part->info.num), mp_ns);
@@ -2415,6 +2414,12 @@ int RadosMultipartUpload::cleanup_part_history(const DoutPrefixProvider* dpp,
       chain.push_obj(raw_part_obj.pool.to_str(), part_key, raw_part_obj.loc);
     }
   }
+}
+
+int RadosMultipartUpload::remove_chain(const DoutPrefixProvider* dpp,
+                                       optional_yield y,
+                                       cls_rgw_obj_chain& chain)
+{
   if (store->getRados()->get_gc() == nullptr) {
     // Delete objects inline if gc hasn't been initialised (in case when bypass gc is specified)
     store->getRados()->delete_objs_inline(dpp, chain, mp_obj.get_upload_id());
@@ -2478,27 +2483,16 @@ int RadosMultipartUpload::abort(const DoutPrefixProvider *dpp, CephContext *cct,
           head->get_key().get_index_key(&key);
           remove_objs.push_back(key);
 
-          cleanup_part_history(dpp, null_yield, obj_part, remove_objs);
+          cleanup_part_history(dpp, obj_part, remove_objs, chain);
         }
       }
       parts_accounted_size += obj_part->info.accounted_size;
     }
   } while (truncated);
 
-  if (store->getRados()->get_gc() == nullptr) {
-    //Delete objects inline if gc hasn't been initialised (in case when bypass gc is specified)
-    store->getRados()->delete_objs_inline(dpp, chain, mp_obj.get_upload_id());
-  } else {
-    /* use upload id as tag and do it synchronously */
-    auto [ret, leftover_chain] = store->getRados()->send_chain_to_gc(chain, mp_obj.get_upload_id(), y);
-    if (ret < 0 && leftover_chain) {
-      ldpp_dout(dpp, 5) << __func__ << ": gc->send_chain() returned " << ret << dendl;
-      if (ret == -ENOENT) {
-        return -ERR_NO_SUCH_UPLOAD;
-      }
-      //Delete objects inline if send chain to gc fails
-      store->getRados()->delete_objs_inline(dpp, *leftover_chain, mp_obj.get_upload_id());
-    }
+  ret = remove_chain(dpp, y, chain);
+  if (ret < 0) {
+    return ret;
   }
 
   std::unique_ptr<rgw::sal::Object::DeleteOp> del_op = meta_obj->get_delete_op();
@@ -2702,6 +2696,8 @@ int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
   uint64_t min_part_size = cct->_conf->rgw_multipart_min_part_size;
   auto etags_iter = part_etags.begin();
   rgw::sal::Attrs attrs = target_obj->get_attrs();
+  // tails of re-uploaded parts, removed together once all parts are checked
+  cls_rgw_obj_chain past_chain;
 
   do {
     ret = list_parts(dpp, cct, max_parts, marker, &marker, &truncated, y);
@@ -2804,12 +2800,14 @@ int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
 
       remove_objs.push_back(remove_key);
 
-      cleanup_part_history(dpp, y, part, remove_objs);
+      cleanup_part_history(dpp, part, remove_objs, past_chain);
 
       ofs += obj_part.size;
       accounted_size += obj_part.accounted_size;
     }
   } while (truncated);
+
+  remove_chain(dpp, y, past_chain);
   hash.Final((unsigned char *)final_etag);
 
   buf_to_hex((unsigned char *)final_etag, sizeof(final_etag), final_etag_str);
@@ -681,10 +681,12 @@ public:
 			  uint64_t part_num,
 			  const std::string& part_num_str) override;
 protected:
-  int cleanup_part_history(const DoutPrefixProvider* dpp,
-                           optional_yield y,
-                           RadosMultipartPart* part,
-                           std::list<rgw_obj_index_key>& remove_objs);
+  void cleanup_part_history(const DoutPrefixProvider* dpp,
+                            RadosMultipartPart* part,
+                            std::list<rgw_obj_index_key>& remove_objs,
+                            cls_rgw_obj_chain& chain);
+  int remove_chain(const DoutPrefixProvider* dpp, optional_yield y,
+                   cls_rgw_obj_chain& chain);
 };
 
 class MPRadosSerializer : public StoreMPSerializer {
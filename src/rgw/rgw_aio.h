@@ -91,6 +91,10 @@ class Aio {
   // wait for all outstanding completions and return their results
   virtual AioResultList drain() = 0;
 
+  // change the total cost allowed in flight; ops already in flight are
+  // not affected
+  virtual void resize(uint64_t window) {}
+
   static OpFunc librados_op(librados::IoCtx ctx,
                             librados::ObjectReadOperation&& op,
                             optional_yield y);
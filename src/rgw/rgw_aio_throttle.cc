@@ -62,6 +62,12 @@ AioResultList BlockingAioThrottle::get(rgw_raw_obj obj,
   return std::move(completed);
 }
 
+void BlockingAioThrottle::resize(uint64_t w)
+{
+  std::scoped_lock lock{mutex};
+  window = w;
+}
+
 void BlockingAioThrottle::put(AioResult& r)
 {
   auto& p = static_cast<Pending&>(r);
@@ -169,6 +175,12 @@ void YieldingAioThrottle::put(AioResult& r)
   }
 }
 
+void YieldingAioThrottle::resize(uint64_t w)
+{
+  // called from the coroutine that calls get(), so there is no waiter
+  window = w;
+}
+
 AioResultList YieldingAioThrottle::poll()
 {
   return std::move(completed);
@@ -25,7 +25,7 @@ namespace rgw {
 
 class Throttle {
  protected:
-  const uint64_t window;
+  uint64_t window;
   uint64_t pending_size = 0;
 
   AioResultList pending;
@@ -75,6 +75,8 @@ class BlockingAioThrottle final : public Aio, private Throttle {
   AioResultList wait() override final;
 
   AioResultList drain() override final;
+
+  void resize(uint64_t window) override final;
 };
 
 // a throttle that yields the coroutine instead of blocking. all public
@@ -111,6 +113,8 @@ class YieldingAioThrottle final : public Aio, private Throttle {
   AioResultList wait() override final;
 
   AioResultList drain() override final;
+
+  void resize(uint64_t window) override final;
 };
 
 // return a smart pointer to Aio
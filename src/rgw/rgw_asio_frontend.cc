@@ -396,6 +396,11 @@ class AsioFrontend {
   RGWProcessEnv& env;
   RGWFrontendConfig* conf;
   boost::asio::io_context context;
+  // with io_contexts=N, each additional io_context gets its own share of
+  // the threads and its own SO_REUSEPORT acceptor for every endpoint, so
+  // a connection is accepted and served by a single group of threads.
+  // the scheduler and pause_mutex stay on the first context
+  std::vector<std::unique_ptr<boost::asio::io_context>> extra_contexts;
   std::string uri_prefix;
   ceph::timespan request_timeout = std::chrono::milliseconds(REQUEST_TIMEOUT);
   size_t header_limit = 16384;
@@ -412,6 +417,7 @@ class AsioFrontend {
   std::unique_ptr<rgw::dmclock::Scheduler> scheduler;
 
   struct Listener {
+    boost::asio::io_context& context;
     tcp::endpoint endpoint;
     tcp::acceptor acceptor;
     tcp_socket socket;
@@ -419,20 +425,24 @@ class AsioFrontend {
     bool use_nodelay = false;
 
     explicit Listener(boost::asio::io_context& context)
-      : acceptor(context), socket(context) {}
+      : context(context), acceptor(context), socket(context) {}
   };
   std::vector<Listener> listeners;
 
   ConnectionList connections;
 
-  // work guard to keep run() threads busy while listeners are paused
+  // work guards to keep run() threads busy while listeners are paused
   using Executor = boost::asio::io_context::executor_type;
-  std::optional<boost::asio::executor_work_guard<Executor>> work;
+  std::vector<boost::asio::executor_work_guard<Executor>> work;
 
   std::vector<std::thread> threads;
   std::atomic<bool> going_down{false};
 
   CephContext* ctx() const { return env.driver->ctx(); }
+  size_t num_contexts() const { return extra_contexts.size() + 1; }
+  boost::asio::io_context& get_context(size_t i) {
+    return i == 0 ? context : *extra_contexts[i - 1];
+  }
   std::optional<dmc::ClientCounters> client_counters;
   std::unique_ptr<dmc::ClientConfig> client_config;
   void accept(Listener& listener, boost::system::error_code ec);
@@ -630,7 +640,37 @@ int AsioFrontend::init()
       l.use_nodelay = (nodelay->second == "1");
     }
   }
-  
+
+  // parse io_contexts, and give each additional context a copy of every
+  // listener; every thread needs a context to run, so there can't be
+  // more contexts than threads
+  if (auto i = config.find("io_contexts"); i != config.end()) {
+    auto n = ceph::parse<uint64_t>(i->second);
+    const uint64_t max_contexts = std::max<int64_t>(
+        ctx()->_conf->rgw_thread_pool_size, 1);
+    if (!n || *n == 0) {
+      lderr(ctx()) << "WARNING: invalid value for io_contexts: "
+          << i->second << ", using a single io_context" << dendl;
+    } else {
+      if (*n > max_contexts) {
+        lderr(ctx()) << "WARNING: io_contexts " << i->second
+            << " capped at rgw_thread_pool_size " << max_contexts << dendl;
+        n = max_contexts;
+      }
+      const size_t num_listeners = listeners.size();
+      for (uint64_t c = 1; c < *n; c++) {
+        auto& extra = extra_contexts.emplace_back(
+            std::make_unique<boost::asio::io_context>());
+        for (size_t j = 0; j < num_listeners; j++) {
+          auto& l = listeners.emplace_back(*extra);
+          l.endpoint = listeners[j].endpoint;
+          l.use_ssl = listeners[j].use_ssl;
+          l.use_nodelay = listeners[j].use_nodelay;
+        }
+      }
+    }
+  }
+
 
   bool socket_bound = false;
   // start listeners
@@ -657,6 +697,18 @@ int AsioFrontend::init()
     }
 
     l.acceptor.set_option(tcp::acceptor::reuse_address(true));
+    if (num_contexts() > 1) {
+      // let the kernel spread incoming connections over the acceptors
+      // that each context has for this endpoint
+      using reuse_port = boost::asio::detail::socket_option::boolean<
+          SOL_SOCKET, SO_REUSEPORT>;
+      l.acceptor.set_option(reuse_port(true), ec);
+      if (ec) {
+        lderr(ctx()) << "failed to set SO_REUSEPORT socket option: "
+                     << ec.message() << dendl;
+        return -ec.value();
+      }
+    }
     l.acceptor.bind(l.endpoint, ec);
     if (ec) {
       lderr(ctx()) << "failed to bind address " << l.endpoint
@@ -1015,8 +1067,8 @@ void AsioFrontend::accept(Listener& l, boost::system::error_code ec)
   // spawn a coroutine to handle the connection
 #ifdef WITH_RADOSGW_BEAST_OPENSSL
   if (l.use_ssl) {
-    spawn::spawn(context,
-      [this, s=std::move(stream)] (yield_context yield) mutable {
+    spawn::spawn(l.context,
+      [this, &context=l.context, s=std::move(stream)] (yield_context yield) mutable {
         auto conn = boost::intrusive_ptr{new Connection(std::move(s))};
         auto c = connections.add(*conn);
         // wrap the tcp stream in an ssl stream
@@ -1046,8 +1098,8 @@ void AsioFrontend::accept(Listener& l, boost::system::error_code ec)
 #else
   {
 #endif // WITH_RADOSGW_BEAST_OPENSSL
-    spawn::spawn(context,
-      [this, s=std::move(stream)] (yield_context yield) mutable {
+    spawn::spawn(l.context,
+      [this, &context=l.context, s=std::move(stream)] (yield_context yield) mutable {
         auto conn = boost::intrusive_ptr{new Connection(std::move(s))};
         auto c = connections.add(*conn);
         auto timeout = timeout_timer{context.get_executor(), request_timeout, conn};
@@ -1066,19 +1118,23 @@ int AsioFrontend::run()
   const int thread_count = cct->_conf->rgw_thread_pool_size;
   threads.reserve(thread_count);
 
-  ldout(cct, 4) << "frontend spawning " << thread_count << " threads" << dendl;
+  ldout(cct, 4) << "frontend spawning " << thread_count << " threads for "
+      << num_contexts() << " io_context(s)" << dendl;
 
   // the worker threads call io_context::run(), which will return when there's
   // no work left. hold a work guard to keep these threads going until join()
-  work.emplace(boost::asio::make_work_guard(context));
+  for (size_t i = 0; i < num_contexts(); i++) {
+    work.push_back(boost::asio::make_work_guard(get_context(i)));
+  }
 
   for (int i = 0; i < thread_count; i++) {
-    threads.emplace_back([this]() noexcept {
+    auto& c = get_context(i % num_contexts());
+    threads.emplace_back([&c]() noexcept {
       // request warnings on synchronous librados calls in this thread
       is_asio_thread = true;
       // Have uncaught exceptions kill the process and give a
       // stacktrace, not be swallowed.
-      context.run();
+      c.run();
     });
   }
   return 0;
@@ -1105,7 +1161,7 @@ void AsioFrontend::join()
   if (!going_down) {
     stop();
   }
-  work.reset();
+  work.clear();
 
   ldout(ctx(), 4) << "frontend joining threads..." << dendl;
   for (auto& thread : threads) {
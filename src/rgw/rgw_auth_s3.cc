@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "common/armor.h"
+#include "common/lru_map.h"
 #include "common/utf8.h"
 #include "rgw_rest_s3.h"
 #include "rgw_auth_s3.h"
@@ -908,6 +909,23 @@ get_v4_signing_key(CephContext* const cct,
                    const std::string_view& secret_access_key,
                    const DoutPrefixProvider *dpp)
 {
+  /* the key only depends on the secret and the credential scope, which
+   * changes daily; remember it rather than redoing four HMAC rounds for
+   * each request */
+  static lru_map<std::string, sha256_digest_t> signing_keys(
+    cct->_conf->rgw_s3_signing_key_cache_size);
+  const bool use_cache = cct->_conf->rgw_s3_signing_key_cache_size > 0;
+  std::string cache_key;
+  if (use_cache) {
+    cache_key.reserve(credential_scope.size() + 1 + secret_access_key.size());
+    cache_key.append(credential_scope).append(1, '\0').append(secret_access_key);
+    sha256_digest_t signing_key;
+    if (signing_keys.find(cache_key, signing_key)) {
+      ldpp_dout(dpp, 20) << "using cached signing_k" << dendl;
+      return signing_key;
+    }
+  }
+
   std::string_view date, region, service;
   std::tie(date, region, service) = parse_cred_scope(credential_scope);
 
@@ -917,14 +935,17 @@ get_v4_signing_key(CephContext* const cct,
   const auto service_k = calc_hmac_sha256(region_k, service);
 
   /* aws4_request */
-  const auto signing_key = calc_hmac_sha256(service_k,
-                                            std::string_view("aws4_request"));
+  auto signing_key = calc_hmac_sha256(service_k,
+                                      std::string_view("aws4_request"));
 
   ldpp_dout(dpp, 10) << "date_k    = " << date_k << dendl;
   ldpp_dout(dpp, 10) << "region_k  = " << region_k << dendl;
   ldpp_dout(dpp, 10) << "service_k = " << service_k << dendl;
   ldpp_dout(dpp, 10) << "signing_k = " << signing_key << dendl;
 
+  if (use_cache) {
+    signing_keys.add(cache_key, signing_key);
+  }
   return signing_key;
 }
 
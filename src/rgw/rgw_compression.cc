@@ -43,45 +43,77 @@ int rgw_compression_info_from_attrset(const map<string, bufferlist>& attrs,
 
 int RGWPutObj_Compress::process(bufferlist&& in, uint64_t logical_offset)
 {
+  if (in.length() > 0) {
+    if (logical_offset > 0 && !compressed && pending.empty()) {
+      // the first part was stored uncompressed, so are all the others
+      return Pipe::process(std::move(in), logical_offset);
+    }
+    ldout(cct, 10) << "Compression for rgw is enabled, compress part " << in.length() << dendl;
+    auto& p = pending.emplace_back();
+    p.in = std::move(in);
+    p.logical_offset = logical_offset;
+    // with a window of one, compress in the caller when the result is needed
+    const auto policy = window > 1 ? std::launch::async : std::launch::deferred;
+    p.result = std::async(policy, [this, &in = p.in] {
+        compress_result res;
+        res.r = compressor->compress(in, res.out, res.message);
+        return res;
+      });
+    if (pending.size() < window) {
+      return 0;
+    }
+    return complete_front();
+  }
+
+  // flush the parts still being compressed
+  while (!pending.empty()) {
+    int r = complete_front();
+    if (r < 0) {
+      return r;
+    }
+  }
+  size_t bs = blocks.size();
+  compressed_ofs = bs > 0 ? blocks[bs-1].len + blocks[bs-1].new_ofs : logical_offset;
+
+  return Pipe::process({}, compressed_ofs);
+}
+
+int RGWPutObj_Compress::complete_front()
+{
+  auto res = pending.front().result.get();
+  bufferlist in = std::move(pending.front().in);
+  const uint64_t logical_offset = pending.front().logical_offset;
+  pending.pop_front();
+
   bufferlist out;
   compressed_ofs = logical_offset;
 
-  if (in.length() > 0) {
-    // compression stuff
-    if ((logical_offset > 0 && compressed) || // if previous part was compressed
-        (logical_offset == 0)) {              // or it's the first part
-      ldout(cct, 10) << "Compression for rgw is enabled, compress part " << in.length() << dendl;
-      int cr = compressor->compress(in, out, compressor_message);
-      if (cr < 0) {
-        if (logical_offset > 0) {
-          lderr(cct) << "Compression failed with exit code " << cr
-              << " for next part, compression process failed" << dendl;
-          return -EIO;
-        }
-        compressed = false;
-        ldout(cct, 5) << "Compression failed with exit code " << cr
-            << " for first part, storing uncompressed" << dendl;
-        out = std::move(in);
-      } else {
-        compressed = true;
-    
-        compression_block newbl;
-        size_t bs = blocks.size();
-        newbl.old_ofs = logical_offset;
-        newbl.new_ofs = bs > 0 ? blocks[bs-1].len + blocks[bs-1].new_ofs : 0;
-        newbl.len = out.length();
-        blocks.push_back(newbl);
-
-	compressed_ofs = newbl.new_ofs;
-      }
-    } else {
-      compressed = false;
-      out = std::move(in);
+  if (logical_offset > 0 && !compressed) {
+    // compressed while the first part was, but that one didn't compress
+    out = std::move(in);
+  } else if (res.r < 0) {
+    if (logical_offset > 0) {
+      lderr(cct) << "Compression failed with exit code " << res.r
+          << " for next part, compression process failed" << dendl;
+      return -EIO;
     }
-    // end of compression stuff
+    compressed = false;
+    ldout(cct, 5) << "Compression failed with exit code " << res.r
+        << " for first part, storing uncompressed" << dendl;
+    out = std::move(in);
   } else {
+    compressed = true;
+    compressor_message = res.message;
+
+    compression_block newbl;
     size_t bs = blocks.size();
-    compressed_ofs = bs > 0 ? blocks[bs-1].len + blocks[bs-1].new_ofs : logical_offset;
+    newbl.old_ofs = logical_offset;
+    newbl.new_ofs = bs > 0 ? blocks[bs-1].len + blocks[bs-1].new_ofs : 0;
+    newbl.len = res.out.length();
+    blocks.push_back(newbl);
+
+    compressed_ofs = newbl.new_ofs;
+    out = std::move(res.out);
   }
 
   return Pipe::process(std::move(out), compressed_ofs);
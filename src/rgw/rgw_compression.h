@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <deque>
+#include <future>
 #include <vector>
 
 #include "compressor/Compressor.h"
@@ -47,10 +49,32 @@ class RGWPutObj_Compress : public rgw::putobj::Pipe
   std::optional<int32_t> compressor_message;
   std::vector<compression_block> blocks;
   uint64_t compressed_ofs{0};
+
+  struct compress_result {
+    int r = 0;
+    bufferlist out;
+    std::optional<int32_t> message;
+  };
+  // a part being compressed; the input is kept in case it has to be
+  // stored uncompressed after all
+  struct pending_part {
+    bufferlist in;
+    uint64_t logical_offset = 0;
+    std::future<compress_result> result;
+  };
+  // parts are compressed in parallel, up to `window` of them, and are
+  // passed on in order. deque so that the references held by running
+  // compressions stay valid
+  std::deque<pending_part> pending;
+  size_t window;
+
+  int complete_front();
 public:
   RGWPutObj_Compress(CephContext* cct_, CompressorRef compressor,
                      rgw::sal::DataProcessor *next)
-    : Pipe(next), cct(cct_), compressor(compressor) {}
+    : Pipe(next), cct(cct_), compressor(compressor),
+      window(std::max<uint64_t>(
+          cct->_conf.get_val<uint64_t>("rgw_compression_window"), 1)) {}
   virtual ~RGWPutObj_Compress() override {};
 
   int process(bufferlist&& data, uint64_t logical_offset) override;
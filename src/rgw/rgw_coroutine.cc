@@ -5,6 +5,8 @@
 #include "common/ceph_json.h"
 #include "rgw_coroutine.h"
 
+#include <boost/core/demangle.hpp>
+
 // re-include our assert to clobber the system one; fix dout:
 #include "include/ceph_assert.h"
 
@@ -635,6 +637,7 @@ int RGWCoroutinesManager::run(const DoutPrefixProvider *dpp, list<RGWCoroutinesS
   env.run_context = run_context;
   env.manager = this;
   env.scheduled_stacks = &scheduled_stacks;
+  uint64_t profile_count = 0;
 
   for (list<RGWCoroutinesStack *>::iterator iter = scheduled_stacks.begin(); iter != scheduled_stacks.end() && !going_down;) {
     RGWCompletionManager::io_completion io;
@@ -648,11 +651,27 @@ int RGWCoroutinesManager::run(const DoutPrefixProvider *dpp, list<RGWCoroutinesS
     }
     env.stack = stack;
 
-    lock.unlock();
+    {
+      const uint64_t sample_rate = cct->_conf->rgw_coroutine_profile_sample_rate;
+      const bool sampled = sample_rate > 0 && (++profile_count % sample_rate) == 0;
+      const char *cr_type = nullptr;
+      ceph::mono_time start;
+      if (sampled) {
+        cr_type = (stack->pos != stack->ops.end() ?
+                   typeid(**stack->pos).name() : "");
+        start = ceph::mono_clock::now();
+      }
 
-    ret = stack->operate(dpp, &env);
+      lock.unlock();
 
-    lock.lock();
+      ret = stack->operate(dpp, &env);
+
+      lock.lock();
+
+      if (sampled) {
+        account_sample(cr_type, ceph::mono_clock::now() - start, stack);
+      }
+    }
 
     stack->set_is_scheduled(false);
     if (ret < 0) {
@@ -825,6 +844,52 @@ void RGWCoroutinesManager::dump(Formatter *f) const {
   f->close_section();
 }
 
+void RGWCoroutinesManager::account_sample(const char *cr_type,
+                                          ceph::timespan run_time,
+                                          RGWCoroutinesStack *stack)
+{
+  auto& p = profile[cr_type];
+  p.samples++;
+  p.run_time += run_time;
+  p.max_run_time = std::max(p.max_run_time, run_time);
+  if (stack->is_done()) {
+    p.done++;
+  } else if (stack->is_io_blocked()) {
+    p.wait_io++;
+  } else if (stack->waiting_for_child()) {
+    p.wait_child++;
+  } else if (stack->is_blocked_by_stack()) {
+    p.wait_stack++;
+  } else if (stack->is_sleeping()) {
+    p.wait_sleep++;
+  } else {
+    p.runnable++;
+  }
+}
+
+void RGWCoroutinesManager::dump_profile(Formatter *f) const {
+  std::shared_lock rl{lock};
+
+  f->open_array_section("coroutines");
+  for (auto& [type, p] : profile) {
+    f->open_object_section("coroutine");
+    ::encode_json("type", boost::core::demangle(type.c_str()), f);
+    ::encode_json("samples", p.samples, f);
+    f->dump_float("run_time", std::chrono::duration<double>(p.run_time).count());
+    f->dump_float("max_run_time", std::chrono::duration<double>(p.max_run_time).count());
+    f->open_object_section("after_run");
+    ::encode_json("wait_io", p.wait_io, f);
+    ::encode_json("wait_child", p.wait_child, f);
+    ::encode_json("wait_stack", p.wait_stack, f);
+    ::encode_json("wait_sleep", p.wait_sleep, f);
+    ::encode_json("done", p.done, f);
+    ::encode_json("runnable", p.runnable, f);
+    f->close_section();
+    f->close_section();
+  }
+  f->close_section();
+}
+
 RGWCoroutinesStack *RGWCoroutinesManager::allocate_stack() {
   return new RGWCoroutinesStack(cct, this);
 }
@@ -865,19 +930,29 @@ RGWCoroutinesManagerRegistry::~RGWCoroutinesManagerRegistry()
   }
 }
 
-int RGWCoroutinesManagerRegistry::hook_to_admin_command(const string& command)
+int RGWCoroutinesManagerRegistry::hook_to_admin_command(const string& command,
+                                                         const string& profile_command)
 {
   AdminSocket *admin_socket = cct->get_admin_socket();
   if (!admin_command.empty()) {
     admin_socket->unregister_commands(this);
   }
   admin_command = command;
+  admin_profile_command = profile_command;
   int r = admin_socket->register_command(admin_command, this,
 				     "dump current coroutines stack state");
   if (r < 0) {
     lderr(cct) << "ERROR: fail to register admin socket command (r=" << r << ")" << dendl;
     return r;
   }
+  if (!admin_profile_command.empty()) {
+    r = admin_socket->register_command(admin_profile_command, this,
+                                       "dump sampled coroutine run times and waits by type");
+    if (r < 0) {
+      lderr(cct) << "ERROR: fail to register admin socket command (r=" << r << ")" << dendl;
+      return r;
+    }
+  }
   return 0;
 }
 
@@ -888,6 +963,12 @@ int RGWCoroutinesManagerRegistry::call(std::string_view command,
 				       std::ostream& ss,
 				       bufferlist& out) {
   std::shared_lock rl{lock};
+  if (!admin_profile_command.empty() && command == admin_profile_command) {
+    f->open_object_section("cr_profile");
+    dump_profile(f);
+    f->close_section();
+    return 0;
+  }
   ::encode_json("cr_managers", *this, f);
   return 0;
 }
@@ -900,6 +981,17 @@ void RGWCoroutinesManagerRegistry::dump(Formatter *f) const {
   f->close_section();
 }
 
+void RGWCoroutinesManagerRegistry::dump_profile(Formatter *f) const {
+  f->open_array_section("coroutine_managers");
+  for (auto m : managers) {
+    f->open_object_section("entry");
+    ::encode_json("id", m->get_id(), f);
+    m->dump_profile(f);
+    f->close_section();
+  }
+  f->close_section();
+}
+
 void RGWCoroutine::call(RGWCoroutine *op)
 {
   if (op) {
@@ -595,6 +595,7 @@ class RGWCoroutinesManagerRegistry : public RefCountedObject, public AdminSocket
     ceph::make_shared_mutex("RGWCoroutinesRegistry::lock");
 
   std::string admin_command;
+  std::string admin_profile_command;
 
 public:
   explicit RGWCoroutinesManagerRegistry(CephContext *_cct) : cct(_cct) {}
@@ -603,7 +604,8 @@ public:
   void add(RGWCoroutinesManager *mgr);
   void remove(RGWCoroutinesManager *mgr);
 
-  int hook_to_admin_command(const std::string& command);
+  int hook_to_admin_command(const std::string& command,
+                            const std::string& profile_command = "");
   int call(std::string_view command, const cmdmap_t& cmdmap,
 	   const bufferlist&,
 	   Formatter *f,
@@ -611,6 +613,7 @@ public:
 	   bufferlist& out) override;
 
   void dump(Formatter *f) const;
+  void dump_profile(Formatter *f) const;
 };
 
 class RGWCoroutinesManager {
@@ -628,6 +631,25 @@ class RGWCoroutinesManager {
 
   RGWIOIDProvider io_id_provider;
 
+  /* sampled coroutine runs by coroutine type, see
+   * rgw_coroutine_profile_sample_rate; protected by lock */
+  struct cr_profile {
+    uint64_t samples = 0;
+    ceph::timespan run_time = ceph::timespan::zero();
+    ceph::timespan max_run_time = ceph::timespan::zero();
+    /* what the coroutine's stack waited on after the sampled run */
+    uint64_t wait_io = 0;
+    uint64_t wait_child = 0;
+    uint64_t wait_stack = 0;
+    uint64_t wait_sleep = 0;
+    uint64_t done = 0;
+    uint64_t runnable = 0;
+  };
+  std::map<std::string, cr_profile> profile;
+
+  void account_sample(const char *cr_type, ceph::timespan run_time,
+                      RGWCoroutinesStack *stack);
+
   void handle_unblocked_stack(std::set<RGWCoroutinesStack *>& context_stacks, std::list<RGWCoroutinesStack *>& scheduled_stacks,
                               RGWCompletionManager::io_completion& io, int *waiting_count, int *interval_wait_count);
 protected:
@@ -677,6 +699,7 @@ public:
 
   virtual std::string get_id();
   void dump(Formatter *f) const;
+  void dump_profile(Formatter *f) const;
 
   RGWIOIDProvider& get_io_id_provider() {
     return io_id_provider;
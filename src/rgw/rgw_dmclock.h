@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <limits>
+
 #include "dmclock/src/dmclock_server.h"
 
 namespace rgw::dmclock {
@@ -38,6 +41,18 @@ enum class scheduler_t {
                         dmclock
 };
 
+/// cost of a request that transfers the given number of bytes: one unit
+/// per request, plus one per rgw_dmclock_data_cost_unit bytes
+inline Cost get_data_cost(CephContext* const cct, int64_t bytes)
+{
+  const uint64_t unit = cct->_conf.get_val<Option::size_t>("rgw_dmclock_data_cost_unit");
+  if (unit == 0 || bytes <= 0) {
+    return 1;
+  }
+  const uint64_t units = static_cast<uint64_t>(bytes) / unit;
+  return 1 + std::min<uint64_t>(units, std::numeric_limits<Cost>::max() - 1);
+}
+
 inline scheduler_t get_scheduler_t(CephContext* const cct)
 {
   const auto scheduler_type = cct->_conf.get_val<std::string>("rgw_scheduler_type");
@@ -14,6 +14,7 @@
 #include <mutex>
 #include <map>
 #include <algorithm>
+#include <numeric>
 
 #include "arrow/type.h"
 #include "arrow/buffer.h"
@@ -257,6 +258,30 @@ public:
   }
 }; // class OwnedBuffer
 
+// A Buffer that holds on to the bufferlist it was read into, so the
+// data read from RADOS is handed to arrow without another copy
+class BufferlistBuffer : public arw::Buffer {
+
+  bufferlist bl;
+
+  BufferlistBuffer(const uint8_t* _data, int64_t _size, bufferlist&& _bl) :
+    Buffer(_data, _size),
+    bl(std::move(_bl))
+    { }
+
+public:
+
+  // moving a bufferlist keeps its buffers, so the contiguous data
+  // pointer taken here stays valid
+  static std::shared_ptr<BufferlistBuffer> make(bufferlist&& bl) {
+    const int64_t size = bl.length();
+    const uint8_t* data =
+      reinterpret_cast<const uint8_t*>(size > 0 ? bl.c_str() : nullptr);
+    return std::shared_ptr<BufferlistBuffer>(
+      new BufferlistBuffer(data, size, std::move(bl)));
+  }
+}; // class BufferlistBuffer
+
 #if 0 // remove classes used for testing and incrementally building
 
 // make local to DoGet eventually
@@ -557,9 +582,8 @@ public:
     return is_closed;
   }
 
-  arw::Result<int64_t> Read(int64_t nbytes, void* out) override {
-    INFO << "entered: asking for " << nbytes << " bytes" << dendl;
-
+  // read up to nbytes at the current position into bl
+  arw::Result<int64_t> Read(int64_t nbytes, bufferlist& bl) {
     if (position < 0) {
       ERROR << "error, position indicated error" << dendl;
       return arw::Status::IOError("object read op is in bad state");
@@ -568,8 +592,6 @@ public:
     // note: read function reads through end_position inclusive
     int64_t end_position = position + nbytes - 1;
 
-    bufferlist bl;
-
     const int64_t bytes_read =
       op->read(position, end_position, bl, null_yield, &dp);
     if (bytes_read < 0) {
@@ -582,10 +604,6 @@ public:
 	bytes_read);
     }
 
-    // TODO: see if there's a way to get rid of this copy, perhaps
-    // updating rgw::sal::read_op
-    bl.cbegin().copy(bytes_read, reinterpret_cast<char*>(out));
-
     position += bytes_read;
 
     if (nbytes != bytes_read) {
@@ -596,21 +614,30 @@ public:
     return bytes_read;
   }
 
-  arw::Result<std::shared_ptr<arw::Buffer>> Read(int64_t nbytes) override {
+  arw::Result<int64_t> Read(int64_t nbytes, void* out) override {
     INFO << "entered: asking for " << nbytes << " bytes" << dendl;
 
-    std::shared_ptr<OwnedBuffer> buffer;
-    ARROW_ASSIGN_OR_RAISE(buffer, OwnedBuffer::make(nbytes));
+    bufferlist bl;
+    ARROW_ASSIGN_OR_RAISE(const int64_t bytes_read, Read(nbytes, bl));
+    bl.cbegin().copy(bytes_read, reinterpret_cast<char*>(out));
+    return bytes_read;
+  }
 
-    ARROW_ASSIGN_OR_RAISE(const int64_t bytes_read,
-			  Read(nbytes, buffer->writeable_data()));
-    buffer->set_size(bytes_read);
+  arw::Result<std::shared_ptr<arw::Buffer>> Read(int64_t nbytes) override {
+    INFO << "entered: asking for " << nbytes << " bytes" << dendl;
 
-    return buffer;
+    // hand the bufferlist itself to arrow; it is only copied if the
+    // read came back in more than one segment
+    bufferlist bl;
+    ARROW_ASSIGN_OR_RAISE(const int64_t bytes_read, Read(nbytes, bl));
+    if (bl.length() > static_cast<unsigned>(bytes_read)) {
+      bl.splice(bytes_read, bl.length() - bytes_read);
+    }
+    return BufferlistBuffer::make(std::move(bl));
   }
 
   bool supports_zero_copy() const override {
-    return false;
+    return true;
   }
 
   // implement Seekable
@@ -665,6 +692,43 @@ public:
   }
 }; // class RandomAccessObject
 
+// Reads the record batches of a parquet object one row group at a
+// time; keeps the file reader alive for as long as the stream is
+class ObjectBatchReader : public arw::RecordBatchReader {
+
+  std::unique_ptr<parquet::arrow::FileReader> file_reader;
+  std::unique_ptr<arw::RecordBatchReader> batch_reader;
+
+  ObjectBatchReader(std::unique_ptr<parquet::arrow::FileReader>&& _file_reader,
+		    std::unique_ptr<arw::RecordBatchReader>&& _batch_reader) :
+    file_reader(std::move(_file_reader)),
+    batch_reader(std::move(_batch_reader))
+    { }
+
+public:
+
+  static arw::Status make(std::unique_ptr<parquet::arrow::FileReader>&& file_reader,
+			  std::shared_ptr<arw::RecordBatchReader>* out) {
+    std::vector<int> row_groups(file_reader->num_row_groups());
+    std::iota(row_groups.begin(), row_groups.end(), 0);
+
+    std::unique_ptr<arw::RecordBatchReader> batch_reader;
+    ARROW_RETURN_NOT_OK(file_reader->GetRecordBatchReader(row_groups,
+							  &batch_reader));
+    out->reset(new ObjectBatchReader(std::move(file_reader),
+				     std::move(batch_reader)));
+    return arw::Status::OK();
+  }
+
+  std::shared_ptr<arw::Schema> schema() const override {
+    return batch_reader->schema();
+  }
+
+  arw::Status ReadNext(std::shared_ptr<arw::RecordBatch>* batch) override {
+    return batch_reader->ReadNext(batch);
+  }
+}; // class ObjectBatchReader
+
 arw::Status FlightServer::DoGet(const flt::ServerCallContext &context,
 				const flt::Ticket &request,
 				std::unique_ptr<flt::FlightDataStream> *stream) {
@@ -705,18 +769,13 @@ arw::Status FlightServer::DoGet(const flt::ServerCallContext &context,
 					       arw::default_memory_pool(),
 					       &reader));
 
-  std::shared_ptr<arrow::Table> table;
-  ARROW_RETURN_NOT_OK(reader->ReadTable(&table));
-
-  std::vector<std::shared_ptr<arw::RecordBatch>> batches;
-  arw::TableBatchReader batch_reader(*table);
-  ARROW_RETURN_NOT_OK(batch_reader.ReadAll(&batches));
-
-  ARROW_ASSIGN_OR_RAISE(auto owning_reader,
-			arw::RecordBatchReader::Make(
-			  std::move(batches), table->schema()));
+  // stream the row groups as they are read rather than materializing
+  // the whole table before sending the first batch
+  std::shared_ptr<arw::RecordBatchReader> batch_reader;
+  ARROW_RETURN_NOT_OK(ObjectBatchReader::make(std::move(reader),
+					      &batch_reader));
   *stream = std::unique_ptr<flt::FlightDataStream>(
-    new flt::RecordBatchStream(owning_reader));
+    new flt::RecordBatchStream(batch_reader));
 
   return arw::Status::OK();
 } // flightServer::DoGet
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <tuple>
 #include <functional>
+#include <future>
 
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string.hpp>
@@ -370,6 +371,25 @@ class LCObjsLister {
   rgw_bucket_dir_entry pre_obj;
   int64_t delay_ms;
 
+  /* the page after list_results, listed while the current page is
+   * being processed */
+  rgw::sal::Bucket::ListParams prefetch_params;
+  rgw::sal::Bucket::ListResults prefetch_results;
+  std::future<int> prefetch;
+
+  void start_prefetch(const DoutPrefixProvider *dpp) {
+    if (!list_results.is_truncated || list_results.objs.empty()) {
+      return;
+    }
+    prefetch_params = list_params;
+    prefetch_params.marker = list_results.objs.back().key;
+    prefetch_results = rgw::sal::Bucket::ListResults();
+    prefetch = std::async(std::launch::async, [this, dpp] {
+      return bucket->list(dpp, prefetch_params, 1000, prefetch_results,
+                          null_yield);
+    });
+  }
+
 public:
   LCObjsLister(rgw::sal::Driver* _driver, rgw::sal::Bucket* _bucket) :
       driver(_driver), bucket(_bucket) {
@@ -383,17 +403,34 @@ public:
     list_params.prefix = prefix;
   }
 
+  ~LCObjsLister() {
+    if (prefetch.valid()) {
+      prefetch.wait();
+    }
+  }
+
   int init(const DoutPrefixProvider *dpp) {
     return fetch(dpp);
   }
 
   int fetch(const DoutPrefixProvider *dpp) {
-    int ret = bucket->list(dpp, list_params, 1000, list_results, null_yield);
+    int ret;
+    if (prefetch.valid() && prefetch_params.marker == list_params.marker) {
+      ret = prefetch.get();
+      list_results = std::move(prefetch_results);
+    } else {
+      if (prefetch.valid()) {
+        prefetch.wait();
+        prefetch = std::future<int>();
+      }
+      ret = bucket->list(dpp, list_params, 1000, list_results, null_yield);
+    }
     if (ret < 0) {
       return ret;
     }
 
     obj_iter = list_results.objs.begin();
+    start_prefetch(dpp);
 
     return 0;
   }
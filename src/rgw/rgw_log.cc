@@ -112,6 +112,18 @@ class UsageLogger : public DoutPrefixProvider {
     }
   };
 
+  class C_UsageLogFlush : public Context {
+    UsageLogger *logger;
+  public:
+    explicit C_UsageLogFlush(UsageLogger *_l) : logger(_l) {}
+    void finish(int r) override {
+      logger->flush_scheduled = false;
+      logger->flush();
+    }
+  };
+  // set while a C_UsageLogFlush is queued on the timer
+  std::atomic<bool> flush_scheduled = false;
+
   void set_timer() {
     timer.add_event_after(cct->_conf->rgw_usage_log_tick_interval, new C_UsageLogTimeout(this));
   }
@@ -150,9 +162,11 @@ public:
       num_entries++;
     bool need_flush = (num_entries > cct->_conf->rgw_usage_log_flush_threshold);
     lock.unlock();
-    if (need_flush) {
+    // flush from the timer thread rather than writing to rados in the
+    // request that happened to cross the threshold
+    if (need_flush && !flush_scheduled.exchange(true)) {
       std::lock_guard l{timer_lock};
-      flush();
+      timer.add_event_after(0, new C_UsageLogFlush(this));
     }
   }
 
@@ -471,15 +485,7 @@ unsigned OpsLogFile::get_subsys() const {
   return dout_subsys;
 }
 
-JsonOpsLogSink::JsonOpsLogSink() {
-  formatter = new JSONFormatter;
-}
-
-JsonOpsLogSink::~JsonOpsLogSink() {
-  delete formatter;
-}
-
-void JsonOpsLogSink::formatter_to_bl(bufferlist& bl)
+void JsonOpsLogSink::formatter_to_bl(ceph::Formatter *formatter, bufferlist& bl)
 {
   stringstream ss;
   formatter->flush(ss);
@@ -491,10 +497,10 @@ int JsonOpsLogSink::log(req_state* s, struct rgw_log_entry& entry)
 {
   bufferlist bl;
 
-  lock.lock();
-  rgw_format_ops_log_entry(entry, formatter);
-  formatter_to_bl(bl);
-  lock.unlock();
+  // a formatter per thread, so that requests don't serialize on one
+  static thread_local JSONFormatter formatter;
+  rgw_format_ops_log_entry(entry, &formatter);
+  formatter_to_bl(&formatter, bl);
 
   return log_json(s, bl);
 }
@@ -221,15 +221,10 @@ public:
 };
 
 class JsonOpsLogSink : public OpsLogSink {
-  ceph::Formatter *formatter;
-  ceph::mutex lock = ceph::make_mutex("JsonOpsLogSink");
-
-  void formatter_to_bl(bufferlist& bl);
+  void formatter_to_bl(ceph::Formatter *formatter, bufferlist& bl);
 protected:
   virtual int log_json(req_state* s, bufferlist& bl) = 0;
 public:
-  JsonOpsLogSink();
-  ~JsonOpsLogSink() override;
   int log(req_state* s, struct rgw_log_entry& entry) override;
 };
 
@@ -1302,6 +1302,9 @@ public:
   RGWOpType get_type() override { return RGW_OP_PUT_OBJ; }
   uint32_t op_mask() override { return RGW_OP_TYPE_WRITE; }
   dmc::client_id dmclock_client() override { return dmc::client_id::data; }
+  dmc::Cost dmclock_cost() override {
+    return dmc::get_data_cost(s->cct, s->content_length);
+  }
 };
 
 class RGWPostObj : public RGWOp {
@@ -1356,6 +1359,9 @@ public:
   RGWOpType get_type() override { return RGW_OP_POST_OBJ; }
   uint32_t op_mask() override { return RGW_OP_TYPE_WRITE; }
   dmc::client_id dmclock_client() override { return dmc::client_id::data; }
+  dmc::Cost dmclock_cost() override {
+    return dmc::get_data_cost(s->cct, s->content_length);
+  }
 };
 
 class RGWPutMetadataAccount : public RGWOp {
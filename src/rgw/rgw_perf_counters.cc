@@ -35,6 +35,8 @@ int rgw_perf_start(CephContext *cct)
   plb.add_u64_counter(l_rgw_keystone_token_cache_miss, "keystone_token_cache_miss", "Keystone token cache miss");
 
   plb.add_u64_counter(l_rgw_gc_retire, "gc_retire_object", "GC object retires");
+  plb.add_u64(l_rgw_gc_backlog_age, "gc_backlog_age",
+              "Seconds the oldest entry of the last GC batch waited past its expiration");
 
   plb.add_u64_counter(l_rgw_lc_expire_current, "lc_expire_current",
 		      "Lifecycle current expiration");
@@ -63,6 +65,15 @@ int rgw_perf_start(CephContext *cct)
   plb.add_u64_counter(l_rgw_lua_script_ok, "lua_script_ok", "Successfull executions of lua scripts");
   plb.add_u64_counter(l_rgw_lua_script_fail, "lua_script_fail", "Failed executions of lua scripts");
   plb.add_u64(l_rgw_lua_current_vms, "lua_current_vms", "Number of Lua VMs currently being executed");
+
+  plb.add_u64(l_rgw_reshard_active, "reshard_active", "Buckets having their index entries copied by resharding");
+  plb.add_u64_counter(l_rgw_reshard_entries, "reshard_entries", "Bucket index entries copied by resharding");
+
+  plb.add_u64_counter(l_rgw_d3n_cache_hit, "d3n_cache_hit", "D3N data cache hits");
+  plb.add_u64_counter(l_rgw_d3n_cache_hit_b, "d3n_cache_hit_b", "Size of D3N data cache hits");
+  plb.add_u64_counter(l_rgw_d3n_cache_miss, "d3n_cache_miss", "D3N data cache misses");
+  plb.add_u64_counter(l_rgw_d3n_cache_miss_b, "d3n_cache_miss_b", "Size of D3N data cache misses");
+  plb.add_u64_counter(l_rgw_d3n_cache_admit, "d3n_cache_admit", "Chunks written to the D3N data cache");
   
   perfcounter = plb.create_perf_counters();
   cct->get_perfcounters_collection()->add(perfcounter);
@@ -33,6 +33,7 @@ enum {
   l_rgw_keystone_token_cache_miss,
 
   l_rgw_gc_retire,
+  l_rgw_gc_backlog_age,
 
   l_rgw_lc_expire_current,
   l_rgw_lc_expire_noncurrent,
@@ -55,6 +56,15 @@ enum {
   l_rgw_lua_script_ok,
   l_rgw_lua_script_fail,
 
+  l_rgw_reshard_active,
+  l_rgw_reshard_entries,
+
+  l_rgw_d3n_cache_hit,
+  l_rgw_d3n_cache_hit_b,
+  l_rgw_d3n_cache_miss,
+  l_rgw_d3n_cache_miss_b,
+  l_rgw_d3n_cache_admit,
+
   l_rgw_last,
 };
 
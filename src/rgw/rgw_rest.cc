@@ -761,9 +761,7 @@ void dump_range(req_state* const s,
 }
 
 
-int dump_body(req_state* const s,
-              const char* const buf,
-              const size_t len)
+static void ratelimit_body(req_state* const s, const size_t len)
 {
   bool healthchk = false;
   // we dont want to limit health checks
@@ -775,6 +773,13 @@ int dump_body(req_state* const s,
     if(!rgw::sal::Bucket::empty(s->bucket.get()))
       s->ratelimit_data->decrease_bytes(method, s->ratelimit_bucket_marker, len, &s->bucket_ratelimit);
   }
+}
+
+int dump_body(req_state* const s,
+              const char* const buf,
+              const size_t len)
+{
+  ratelimit_body(s, len);
   try {
     return RESTFUL_IO(s)->send_body(buf, len);
   } catch (rgw::io::Exception& e) {
@@ -787,6 +792,58 @@ int dump_body(req_state* const s, /* const */ ceph::buffer::list& bl)
   return dump_body(s, bl.c_str(), bl.length());
 }
 
+int dump_body(req_state* const s, /* const */ ceph::buffer::list& bl,
+              size_t ofs, size_t len)
+{
+  // sending each buffer of a large range in place saves c_str() copying
+  // them all into one; small pieces are cheaper to copy than to send with
+  // one write each
+  static constexpr size_t min_piece = 64 * 1024;
+  unsigned pieces = 0;
+  bool small = false;
+  {
+    size_t o = ofs, l = len;
+    for (const auto& bp : bl.buffers()) {
+      if (l == 0) {
+        break;
+      }
+      if (o >= bp.length()) {
+        o -= bp.length();
+        continue;
+      }
+      const size_t n = std::min<size_t>(bp.length() - o, l);
+      ++pieces;
+      small = small || (n < min_piece && n < l);
+      o = 0;
+      l -= n;
+    }
+  }
+  if (pieces <= 1 || small) {
+    return dump_body(s, bl.c_str() + ofs, len);
+  }
+
+  ratelimit_body(s, len);
+  try {
+    size_t sent = 0;
+    for (const auto& bp : bl.buffers()) {
+      if (len == 0) {
+        break;
+      }
+      if (ofs >= bp.length()) {
+        ofs -= bp.length();
+        continue;
+      }
+      const size_t n = std::min<size_t>(bp.length() - ofs, len);
+      sent += RESTFUL_IO(s)->send_body(bp.c_str() + ofs, n);
+      ofs = 0;
+      len -= n;
+    }
+    return sent;
+  } catch (rgw::io::Exception& e) {
+    return -e.code().value();
+  }
+}
+
 int dump_body(req_state* const s, const std::string& str)
 {
   return dump_body(s, str.c_str(), str.length());
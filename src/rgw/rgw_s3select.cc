@@ -270,6 +270,7 @@ RGWSelectObj_ObjStore_S3::RGWSelectObj_ObjStore_S3():
   m_object_size_for_processing(0),
   m_parquet_type(false),
   m_json_type(false),
+  m_readahead_ofs(0),
   chunk_number(0),
   m_requested_range(0),
   m_scan_offset(1024),
@@ -683,6 +684,30 @@ int RGWSelectObj_ObjStore_S3::range_request(int64_t ofs, int64_t len, void* buff
 {
   //purpose: implementation for arrow::ReadAt, this may take several async calls.
   //send_response_date(call_back) accumulate buffer, upon completion control is back to ReadAt.
+  if (buff && m_parquet_type) {
+    if (ofs >= m_readahead_ofs &&
+        ofs + len <= m_readahead_ofs + static_cast<int64_t>(m_readahead_buffer.size())) {
+      ldout(s->cct, 10) << "S3select: serving request-offset :" << ofs << " request-length :" << len << " from read-ahead buffer" << dendl;
+      memcpy(buff, m_readahead_buffer.data() + (ofs - m_readahead_ofs), len);
+      return len;
+    }
+    //the parquet reader issues many small reads (footer, metadata, column chunks), each one a full GET.
+    //extend small reads, and keep the result for the reads that follow.
+    const int64_t readahead = s->cct->_conf.get_val<Option::size_t>("rgw_s3select_parquet_readahead");
+    const int64_t obj_size = static_cast<int64_t>(get_obj_size());
+    if (len < readahead && ofs + len < obj_size) {
+      int64_t fetch_len = std::min(readahead, obj_size - ofs);
+      m_readahead_buffer.clear();
+      range_request(ofs, fetch_len, nullptr, y);
+      if (requested_buffer.size() < static_cast<size_t>(len)) {
+        return -EIO;
+      }
+      m_readahead_buffer.swap(requested_buffer);
+      m_readahead_ofs = ofs;
+      memcpy(buff, m_readahead_buffer.data(), len);
+      return len;
+    }
+  }
   range_req_str = "bytes=" + std::to_string(ofs) + "-" + std::to_string(ofs+len-1);
   range_str = range_req_str.c_str();
   range_parsed = false;
@@ -748,18 +773,15 @@ void RGWSelectObj_ObjStore_S3::execute(optional_yield y)
 int RGWSelectObj_ObjStore_S3::parquet_processing(bufferlist& bl, off_t ofs, off_t len)
 {
     fp_chunked_transfer_encoding();
-    size_t append_in_callback = 0;
-    int part_no = 1;
-    //concat the requested buffer
-    for (auto& it : bl.buffers()) {
-      if (it.length() == 0) {
-        ldout(s->cct, 10) << "S3select: get zero-buffer while appending request-buffer " << dendl;
-      }
-      append_in_callback += it.length();
-      ldout(s->cct, 10) << "S3select: part " << part_no++ << " it.length() = " << it.length() << dendl;
-      requested_buffer.append(&(it)[0]+ofs, len);
+    if (len == 0) {
+      ldout(s->cct, 10) << "S3select: get zero-buffer while appending request-buffer " << dendl;
+    }
+    //concat the requested buffer, <ofs,len> is relative to the whole bufferlist
+    if (requested_buffer.empty()) {
+      requested_buffer.reserve(m_request_range);
     }
-    ldout(s->cct, 10) << "S3select:append_in_callback = " << append_in_callback << dendl;
+    bl.begin(ofs).copy(len, requested_buffer);
+    ldout(s->cct, 10) << "S3select:append_in_callback = " << len << dendl;
     if (requested_buffer.size() < m_request_range) {
       ldout(s->cct, 10) << "S3select: need another round buffe-size: " << requested_buffer.size() << " request range length:" << m_request_range << dendl;
       return 0;
@@ -204,6 +204,9 @@ private:
   //a request for range may statisfy by several calls to send_response_date;
   size_t m_request_range;
   std::string requested_buffer;
+  //parquet reads are extended to rgw_s3select_parquet_readahead, the last one is kept here
+  std::string m_readahead_buffer;
+  int64_t m_readahead_ofs;
   std::string range_req_str;
   std::function<int(std::string&)> fp_result_header_format;
   std::function<int(std::string&)> fp_s3select_result_format;
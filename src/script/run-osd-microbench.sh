@@ -0,0 +1,258 @@
+#!/usr/bin/env bash
+
+usage() {
+    prog_name=$1
+    shift
+    cat <<EOF
+usage:
+  $prog_name [options] [workload...]
+
+Drive small-op workloads against a single ceph-osd backed by memstore, with
+the client talking to it over localhost, and report ops/s, OSD CPU time and
+cycles per op, and the OSD's own op latency counters.  workload is any of
+"write", "seq" and "rand", default to all of them in that order.
+
+options:
+  -b,--block-size     size of each op in bytes, default to 4096
+  -d,--duration       seconds to run each workload, default to 30
+  -t,--concurrency    number of ops in flight, default to 16
+  -a,--archive-dir    directory in which the results are stored, default to $PWD/osd-microbench
+  --build-dir         directory where CMakeCache.txt is located, default to $PWD
+  --source-dir        the path to the top level of Ceph source tree, default to $PWD/..
+  --lock-profile      also record which call paths block in futex(2), i.e. on
+                      contended mutexes and condition variables
+  --use-existing      do not setup/teardown a vstart cluster for testing
+  -h,--help           print this help message
+
+example:
+  $prog_name -b 4096 -d 60 write rand
+EOF
+}
+
+prog_name=$(basename $0)
+archive_dir=$PWD/osd-microbench
+build_dir=$PWD
+source_dir=$(dirname $PWD)
+block_size=4096
+duration=30
+concurrency=16
+lock_profile=false
+use_existing=false
+pool=microbench
+opts=$(getopt --options "a:b:d:t:h" --longoptions "archive-dir:,block-size:,duration:,concurrency:,build-dir:,source-dir:,lock-profile,use-existing,help" --name $prog_name -- "$@")
+eval set -- "$opts"
+
+while true; do
+    case "$1" in
+        -a|--archive-dir)
+            archive_dir=$2
+            shift 2
+            ;;
+        -b|--block-size)
+            block_size=$2
+            shift 2
+            ;;
+        -d|--duration)
+            duration=$2
+            shift 2
+            ;;
+        -t|--concurrency)
+            concurrency=$2
+            shift 2
+            ;;
+        --build-dir)
+            build_dir=$2
+            shift 2
+            ;;
+        --source-dir)
+            source_dir=$2
+            shift 2
+            ;;
+        --lock-profile)
+            lock_profile=true
+            shift
+            ;;
+        --use-existing)
+            use_existing=true
+            shift
+            ;;
+        -h|--help)
+            usage $prog_name
+            exit 0
+            ;;
+        --)
+            shift
+            break
+            ;;
+        *)
+            echo "unexpected argument $1" 1>&2
+            exit 1
+            ;;
+    esac
+done
+
+if test $# -gt 0; then
+    workloads="$@"
+else
+    workloads="write seq rand"
+fi
+for workload in $workloads; do
+    case $workload in
+        write|seq|rand)
+            ;;
+        *)
+            echo "$prog_name: unknown workload $workload" 1>&2
+            usage $prog_name
+            exit 1
+            ;;
+    esac
+done
+
+# store absolute paths before changing cwd
+source_dir=$(readlink -f $source_dir)
+build_dir=$(readlink -f $build_dir)
+mkdir -p $archive_dir || exit
+archive_dir=$(readlink -f $archive_dir)
+
+ceph="$build_dir/bin/ceph -c $build_dir/ceph.conf"
+rados="$build_dir/bin/rados -c $build_dir/ceph.conf"
+
+if ! $use_existing; then
+    cd $build_dir || exit
+    # a single OSD keeps replication out of the picture, so what is measured
+    # is the messenger, the op queue and PrimaryLogPG on top of memstore
+    MDS=0 MGR=1 OSD=1 MON=1 $source_dir/src/vstart.sh -n -X -l \
+       --without-dashboard --memstore \
+       -o "memstore_device_bytes=8589934592" \
+       -o "osd_pool_default_size=1" \
+       -o "osd_pool_default_min_size=1"
+    cd - > /dev/null || exit
+fi
+
+osd_pid=$(cat $build_dir/out/osd.0.pid 2>/dev/null || pgrep -o -x ceph-osd)
+if test -z "$osd_pid"; then
+    echo "$prog_name: cannot find the ceph-osd process" 1>&2
+    exit 1
+fi
+
+if command -v perf > /dev/null; then
+    have_perf=true
+    # i need to read the performance events,
+    # see https://www.kernel.org/doc/Documentation/sysctl/kernel.txt
+    if /sbin/capsh --supports=cap_sys_admin; then
+        perf_event_paranoid=$(/sbin/sysctl --values kernel.perf_event_paranoid)
+        if test $perf_event_paranoid -gt 0; then
+            sudo /sbin/sysctl -q -w kernel.perf_event_paranoid=0
+        fi
+    else
+        echo "without cap_sys_admin, $(whoami) cannot read the perf events"
+    fi
+else
+    have_perf=false
+    echo "perf not found, cycles per op will not be reported"
+fi
+
+$ceph osd pool create $pool 32 32 --autoscale-mode=off || exit
+$ceph osd pool set $pool size 1 --yes-i-really-mean-it || exit
+$ceph osd pool application enable $pool rados > /dev/null 2>&1
+
+# all pgs of the pool need to be active+clean before we start measuring
+for i in $(seq 60); do
+    not_clean=$($ceph pg ls-by-pool $pool -f json 2>/dev/null | python3 -c '
+import json, sys
+pgs = json.load(sys.stdin)["pg_stats"]
+print(len([pg for pg in pgs if pg["state"] != "active+clean"]))' 2>/dev/null)
+    test "$not_clean" = 0 && break
+    sleep 1
+done
+if test "$not_clean" != 0; then
+    echo "$prog_name: pool $pool did not become clean" 1>&2
+    exit 1
+fi
+
+# utime + stime of the osd, in clock ticks
+osd_cpu_ticks() {
+    awk '{print $14 + $15}' /proc/$osd_pid/stat
+}
+
+for workload in $workloads; do
+    echo "running $workload: ${block_size}B ops, $concurrency in flight, ${duration}s"
+    out=$archive_dir/$workload
+    $ceph daemon osd.0 perf reset all > /dev/null
+    if $have_perf; then
+        perf stat -x, -e cycles,instructions,context-switches \
+             -p $osd_pid -o $out.perf-stat &
+        perf_stat_pid=$!
+        if $lock_profile; then
+            perf record -q -g -e syscalls:sys_enter_futex \
+                 -p $osd_pid -o $out.futex.data &
+            perf_record_pid=$!
+        fi
+    fi
+    cpu_start=$(osd_cpu_ticks)
+    if test $workload = write; then
+        $rados -p $pool bench $duration write -b $block_size -t $concurrency \
+            --no-cleanup > $out.bench
+    else
+        $rados -p $pool bench $duration $workload -t $concurrency > $out.bench
+    fi
+    cpu_end=$(osd_cpu_ticks)
+    if $have_perf; then
+        kill -INT $perf_stat_pid
+        wait $perf_stat_pid
+        if $lock_profile; then
+            kill -INT $perf_record_pid
+            wait $perf_record_pid
+            perf report -i $out.futex.data --stdio --no-children \
+                 --sort sym > $out.futex.txt 2>/dev/null
+        fi
+    fi
+    $ceph daemon osd.0 perf dump osd > $out.perf-dump
+
+    ops=$(awk -F: '/^Total (writes|reads) made/ {print $2 + 0}' $out.bench)
+    iops=$(awk -F: '/^Average IOPS/ {print $2 + 0}' $out.bench)
+    lat=$(awk -F: '/^Average Latency/ {print $2 + 0}' $out.bench)
+    if test -z "$ops" || test "$ops" -eq 0; then
+        echo "$workload: no ops completed, see $out.bench" 1>&2
+        continue
+    fi
+    echo "  client:  $iops ops/s, average latency ${lat}s, $ops ops"
+    awk -v ticks=$((cpu_end - cpu_start)) -v hz=$(getconf CLK_TCK) -v ops=$ops \
+        'BEGIN {printf "  osd cpu: %.1f us/op\n", ticks / hz * 1e6 / ops}'
+    if $have_perf; then
+        awk -F, -v ops=$ops '
+$3 == "cycles" { cycles = $1 }
+$3 == "instructions" { insns = $1 }
+$3 == "context-switches" { cs = $1 }
+END {
+  if (cycles > 0)
+    printf "  osd:     %.0f cycles/op, %.2f IPC, %.2f context switches/op\n",
+      cycles / ops, insns / cycles, cs / ops
+}' $out.perf-stat
+    fi
+    python3 - $out.perf-dump <<EOF
+import json, sys
+osd = json.load(open(sys.argv[1]))["osd"]
+for name in ["op_latency", "op_process_latency", "op_prepare_latency",
+             "op_before_queue_op_lat", "op_before_dequeue_op_lat"]:
+    if name in osd and osd[name]["avgcount"]:
+        print("  %-24s %.1f us" % (name + ":", osd[name]["avgtime"] * 1e6))
+EOF
+    if $lock_profile && test -s $out.futex.txt; then
+        echo "  futex(2) call paths: $out.futex.txt"
+    fi
+done
+
+$rados -p $pool cleanup > /dev/null
+
+if test -n "$perf_event_paranoid"; then
+    # restore the setting
+    sudo /sbin/sysctl -q -w kernel.perf_event_paranoid=$perf_event_paranoid
+fi
+
+if ! $use_existing; then
+    cd $build_dir || exit
+    $source_dir/src/stop.sh
+else
+    $ceph osd pool rm $pool $pool --yes-i-really-really-mean-it
+fi
@@ -22,6 +22,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <string>
+#include <thread>
 #include <sys/un.h>
 
 using namespace std;
@@ -286,6 +287,89 @@ TEST(AdminSocketClient, Ping) {
   }
 }
 
+class GateHook : public AdminSocketHook {
+public:
+  ceph::mutex _lock = ceph::make_mutex("GateHook::_lock");
+  ceph::condition_variable _cond;
+  bool entered = false;
+  bool open = false;
+
+  int call(std::string_view command, const cmdmap_t& cmdmap,
+	   const bufferlist&,
+	   Formatter *f,
+	   std::ostream& ss,
+	   bufferlist& result) override {
+    std::unique_lock l{_lock};
+    entered = true;
+    _cond.notify_all();
+    _cond.wait(l, [this] { return open; });
+    result.append("opened");
+    return 0;
+  }
+};
+
+TEST(AdminSocket, ConcurrentCommands) {
+  std::unique_ptr<AdminSocket> asokc = std::make_unique<AdminSocket>(g_ceph_context);
+  std::unique_ptr<GateHook> gate = std::make_unique<GateHook>();
+  AdminSocketTest asoct(asokc.get());
+  string path = get_rand_socket_path();
+  ASSERT_TRUE(asoct.init(path));
+  ASSERT_EQ(0, asoct.m_asokc->register_command("gate", gate.get(), ""));
+  AdminSocketClient client(path);
+  string gate_result;
+  std::thread t([&client, &gate_result] {
+    client.do_request("{\"prefix\":\"gate\"}", &gate_result);
+  });
+  {
+    std::unique_lock l{gate->_lock};
+    gate->_cond.wait(l, [&gate] { return gate->entered; });
+  }
+  // a blocked command does not hold up the others
+  bool ok;
+  ASSERT_EQ("", client.ping(&ok));
+  ASSERT_TRUE(ok);
+  {
+    std::lock_guard l{gate->_lock};
+    gate->open = true;
+    gate->_cond.notify_all();
+  }
+  t.join();
+  ASSERT_EQ("opened", gate_result);
+  ASSERT_TRUE(asoct.shutdown());
+}
+
+class LargeOutputHook : public AdminSocketHook {
+  int call(std::string_view command, const cmdmap_t& cmdmap,
+	   const bufferlist&,
+	   Formatter *f,
+	   std::ostream& ss,
+	   bufferlist& result) override {
+    f->open_array_section("entries");
+    for (int i = 0; i < 100000; i++) {
+      f->dump_int("entry", i);
+    }
+    f->close_section();
+    return 0;
+  }
+};
+
+TEST(AdminSocket, StreamOutput) {
+  std::unique_ptr<AdminSocket> asokc = std::make_unique<AdminSocket>(g_ceph_context);
+  std::unique_ptr<AdminSocketHook> large = std::make_unique<LargeOutputHook>();
+  AdminSocketTest asoct(asokc.get());
+  string path = get_rand_socket_path();
+  ASSERT_TRUE(asoct.init(path));
+  ASSERT_EQ(0, asoct.m_asokc->register_command("large", large.get(), ""));
+  AdminSocketClient client(path);
+  string whole, streamed;
+  ASSERT_EQ("", client.do_request("{\"prefix\":\"large\"}", &whole));
+  ASSERT_EQ("", client.do_request("{\"prefix\":\"large\",\"stream\":true}",
+				  &streamed));
+  ASSERT_LT(64u << 10, whole.size());
+  ASSERT_EQ(whole, streamed);
+  ASSERT_TRUE(asoct.shutdown());
+}
+
 TEST(AdminSocket, bind_and_listen) {
   string path = get_rand_socket_path();
   std::unique_ptr<AdminSocket> asokc = std::make_unique<AdminSocket>(g_ceph_context);
@@ -22,6 +22,7 @@
 #include <limits.h>
 #include <errno.h>
 #include <sys/uio.h>
+#include <thread>
 
 #include "include/buffer.h"
 #include "include/buffer_raw.h"
@@ -1337,6 +1338,58 @@ TEST(BufferList, BenchAlloc) {
   bench_bufferlist_alloc(4, 100000, 16);
 }
 
+TEST(BufferList, Recycle) {
+  // nodes and pages freed by one bufferlist are reused by the next
+  for (int i = 0; i < 1000; i++) {
+    bufferlist bl;
+    for (int j = 0; j < 100; j++) {
+      bl.append(std::string(j + 1, 'a' + (i + j) % 26));
+    }
+    bufferlist other;
+    other.append(bl);
+    other.append("end", 3);
+    std::string expected;
+    for (int j = 0; j < 100; j++) {
+      expected += std::string(j + 1, 'a' + (i + j) % 26);
+    }
+    ASSERT_EQ(expected, bl.to_str());
+    ASSERT_EQ(expected + "end", other.to_str());
+  }
+
+  // freed on another thread than the one that allocated them
+  std::vector<bufferlist> bls(100);
+  for (auto& bl : bls) {
+    bl.append("x");
+    bl.append(buffer::create(10));
+  }
+  std::thread t([&bls] {
+    bls.clear();
+    bufferlist bl;
+    bl.append("y");
+    ASSERT_EQ("y", bl.to_str());
+  });
+  t.join();
+}
+
+void bench_bufferlist_encode(int num)
+{
+  utime_t start = ceph_clock_now();
+  for (int i = 0; i < num; ++i) {
+    bufferlist bl;
+    encode(uint64_t(i), bl);
+    encode(std::string("rbd_data.1234.0000000000000001"), bl);
+    encode(uint32_t(i), bl);
+    bufferlist payload;
+    payload.append(bl);
+  }
+  utime_t end = ceph_clock_now();
+  cout << num << " small encodes in " << (end - start) << std::endl;
+}
+
+TEST(BufferList, BenchEncode) {
+  bench_bufferlist_encode(1000000);
+}
+
 /*
  * append_bench tests now have multiple variants:
  *
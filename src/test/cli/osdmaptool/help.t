@@ -39,4 +39,9 @@
      --read <file>           calculate pg upmap entries to balance pg primaries
      --read-pool <poolname>  specify which pool the read balancer should adjust
      --vstart                prefix upmap and read output with './bin/'
+     --simulate [--pool <poolid>] [--fail-osds <osdid>[,<osdid>,<...>]] [--fail-each] [--candidate <file>]
+                             compare placement, data movement and balance of the map
+                             with each OSD failure set and candidate map, in parallel
+     --sim-threads <count>   threads mapping pgs for --simulate [default: all cpus]
+     --sim-format <format>   output format of --simulate [default: json-pretty]
   [1]
@@ -669,6 +669,28 @@ TEST_F(CmpOmap, cmp_rm_keys_at_max_keys)
   EXPECT_EQ(cmp_rm_keys(op, Mode::U64, Op::EQ, std::move(comparisons)), 0);
 }
 
+TEST_F(CmpOmap, cmp_rm_keys_many)
+{
+  const std::string oid = __PRETTY_FUNCTION__;
+  std::map<std::string, bufferlist> vals;
+  ComparisonMap comparisons;
+  for (uint32_t i = 0; i < max_keys; i++) {
+    vals.emplace(std::to_string(i), u64_buffer(i));
+    // remove the even keys
+    comparisons.emplace(std::to_string(i), u64_buffer(i - i % 2));
+  }
+  ASSERT_EQ(ioctx.omap_set(oid, vals), 0);
+  ASSERT_EQ(do_cmp_rm_keys(oid, Mode::U64, Op::EQ, std::move(comparisons)), 0);
+  {
+    std::map<std::string, bufferlist> vals;
+    ASSERT_EQ(get_vals(oid, &vals), 0);
+    ASSERT_EQ(vals.size(), max_keys / 2);
+    for (uint32_t i = 0; i < max_keys; i++) {
+      EXPECT_EQ(vals.count(std::to_string(i)), i % 2);
+    }
+  }
+}
+
 TEST_F(CmpOmap, cmp_rm_keys_over_max_keys)
 {
   ComparisonMap comparisons;
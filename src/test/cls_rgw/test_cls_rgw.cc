@@ -1253,6 +1253,61 @@ TEST_F(cls_rgw, bi_log_trim)
   }
 }
 
+TEST_F(cls_rgw, index_complete_ops)
+{
+  string bucket_oid = str_int("bucket", 9);
+
+  ObjectWriteOperation op;
+  cls_rgw_bucket_init_index(op);
+  ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+
+  uint64_t obj_size = 1024;
+  std::vector<rgw_cls_obj_complete_op> completes;
+  for (int i = 0; i < NUM_OBJS; i++) {
+    cls_rgw_obj_key obj = str_int("obj", i);
+    string tag = str_int("tag", i);
+    string loc = str_int("loc", i);
+
+    index_prepare(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, obj, loc);
+
+    auto& c = completes.emplace_back();
+    c.op = CLS_RGW_OP_ADD;
+    c.key = obj;
+    c.tag = tag;
+    c.ver.pool = ioctx.get_id();
+    c.ver.epoch = 1;
+    c.meta.category = RGWObjCategory::None;
+    c.meta.size = c.meta.accounted_size = obj_size;
+    c.log_op = true;
+  }
+  // a completion without a pending op is skipped, not fatal to the batch
+  {
+    auto& c = completes.emplace_back();
+    c.op = CLS_RGW_OP_ADD;
+    c.key = str_int("obj", NUM_OBJS);
+    c.tag = "no-such-tag";
+    c.log_op = true;
+  }
+
+  ObjectWriteOperation cop;
+  cls_rgw_bucket_complete_ops(cop, completes);
+  ASSERT_EQ(0, ioctx.operate(bucket_oid, &cop));
+
+  test_stats(ioctx, bucket_oid, RGWObjCategory::None, NUM_OBJS,
+	     obj_size * NUM_OBJS);
+
+  // every completion got its own bilog entry
+  cls_rgw_bi_log_list_ret bilog;
+  ASSERT_EQ(0, bilog_list(ioctx, bucket_oid, &bilog));
+  std::set<std::string> ids;
+  for (const auto& e : bilog.entries) {
+    if (e.state == CLS_RGW_STATE_COMPLETE) {
+      ids.insert(e.id);
+    }
+  }
+  EXPECT_EQ((size_t)NUM_OBJS, ids.size());
+}
+
 TEST_F(cls_rgw, index_racing_removes)
 {
   string bucket_oid = str_int("bucket", 8);
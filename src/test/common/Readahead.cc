@@ -130,3 +130,49 @@ TEST(Readahead, alignment) {
   ASSERT_RA(1400, 300, r.update(1290, 10, Readahead::NO_LIMIT)); // internal readahead size 320
   ASSERT_RA(0, 0, r.update(1300, 10, Readahead::NO_LIMIT));
 }
+
+// Reads a stream in 100 byte chunks, each taking as long as rate() says
+// for the current maximum window, and returns the maximum it settles at.
+static uint64_t adapt(Readahead& r, std::function<double(uint64_t)> rate) {
+  auto now = ceph::mono_clock::zero() + 1s;
+  for (uint64_t pos = 0; pos < 100000; pos += 100) {
+    r.update(pos, 100, Readahead::NO_LIMIT, now);
+    now += ceph::make_timespan(100 / rate(r.get_cur_max_readahead_size()));
+  }
+  return r.get_cur_max_readahead_size();
+}
+
+TEST(Readahead, adaptive_max_size) {
+  {
+    // not enabled
+    Readahead r;
+    r.set_trigger_requests(1);
+    r.set_max_readahead_size(100);
+    ASSERT_EQ(100u, adapt(r, [](uint64_t max) { return max; }));
+  }
+  {
+    // a bigger window doesn't help
+    Readahead r;
+    r.set_trigger_requests(1);
+    r.set_max_readahead_size(100);
+    r.set_adaptive_max_readahead_size(1600);
+    ASSERT_EQ(100u, adapt(r, [](uint64_t max) { return 1000; }));
+  }
+  {
+    // it helps up to 400 bytes
+    Readahead r;
+    r.set_trigger_requests(1);
+    r.set_max_readahead_size(100);
+    r.set_adaptive_max_readahead_size(1600);
+    ASSERT_EQ(400u, adapt(r, [](uint64_t max) {
+      return std::min<uint64_t>(max, 400) * 10; }));
+  }
+  {
+    // it always helps, up to the limit
+    Readahead r;
+    r.set_trigger_requests(1);
+    r.set_max_readahead_size(100);
+    r.set_adaptive_max_readahead_size(1600);
+    ASSERT_EQ(1600u, adapt(r, [](uint64_t max) { return max * 10; }));
+  }
+}
@@ -27,6 +27,7 @@
 #include <mutex>
 #include <random>
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "common/Thread.h"
@@ -212,6 +213,40 @@ TEST_F(ThrottleTest, wait) {
   } while(!waited);
 }
 
+TEST_F(ThrottleTest, contention) {
+  // threads * per_get > max puts the throttle under pressure, otherwise
+  // everyone should stay on the fast path
+  for (int64_t max : {1000, 16}) {
+    const unsigned threads = 8;
+    const int64_t per_get = 4;
+    const unsigned ops = 100000;
+    Throttle throttle(g_ceph_context, "throttle", max);
+    std::atomic<bool> exceeded = false;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+      workers.emplace_back([&] {
+	for (unsigned i = 0; i < ops; i++) {
+	  throttle.get(per_get);
+	  if (throttle.get_current() > max) {
+	    exceeded = true;
+	  }
+	  throttle.put(per_get);
+	}
+      });
+    }
+    for (auto& w : workers) {
+      w.join();
+    }
+    std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    cout << "max " << max << ": " << threads << " threads, "
+	 << (threads * ops / elapsed.count()) << " get+put/s" << std::endl;
+    ASSERT_FALSE(exceeded);
+    ASSERT_EQ(0, throttle.get_current());
+  }
+}
+
 std::pair<double, std::chrono::duration<double> > test_backoff(
   double low_threshhold,
   double high_threshhold,
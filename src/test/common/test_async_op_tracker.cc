@@ -0,0 +1,59 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "common/AsyncOpTracker.h"
+#include "common/Cond.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+TEST(AsyncOpTracker, wait_idle)
+{
+  AsyncOpTracker tracker;
+  ASSERT_TRUE(tracker.empty());
+  C_SaferCond ctx;
+  tracker.wait_for_ops(&ctx);
+  ASSERT_EQ(0, ctx.wait());
+}
+
+TEST(AsyncOpTracker, wait_pending)
+{
+  AsyncOpTracker tracker;
+  tracker.start_op();
+  tracker.start_op();
+  ASSERT_FALSE(tracker.empty());
+
+  bool done = false;
+  tracker.wait_for_ops(new LambdaContext([&done](int r) { done = true; }));
+  tracker.finish_op();
+  ASSERT_FALSE(done);
+  tracker.finish_op();
+  ASSERT_TRUE(done);
+  ASSERT_TRUE(tracker.empty());
+}
+
+TEST(AsyncOpTracker, concurrent)
+{
+  AsyncOpTracker tracker;
+  tracker.start_op();
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&tracker] {
+      for (int j = 0; j < 10000; ++j) {
+	tracker.start_op();
+	tracker.finish_op();
+      }
+    });
+  }
+  std::atomic<bool> done = false;
+  tracker.wait_for_ops(new LambdaContext([&done](int r) { done = true; }));
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_FALSE(done);
+  tracker.finish_op();
+  ASSERT_TRUE(done);
+}
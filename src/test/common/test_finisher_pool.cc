@@ -0,0 +1,81 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "common/Finisher.h"
+#include "global/global_context.h"
+
+TEST(FinisherPool, KeyOrder)
+{
+  constexpr unsigned keys = 8;
+  constexpr unsigned per_key = 2000;
+  FinisherPool pool(g_ceph_context, "test_key_order", "fn_test", 4);
+  pool.start();
+
+  std::vector<unsigned> next(keys, 0);
+  std::atomic<unsigned> misordered = {0};
+  std::atomic<unsigned> running[keys] = {};
+  std::vector<std::thread> producers;
+  for (unsigned k = 0; k < keys; ++k) {
+    producers.emplace_back([&, k] {
+      for (unsigned i = 0; i < per_key; ++i) {
+	pool.queue(k + 1, new LambdaContext([&, k, i](int r) {
+	  if (running[k]++ != 0 || next[k] != i) {
+	    ++misordered;
+	  }
+	  next[k] = i + 1;
+	  --running[k];
+	}));
+      }
+    });
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  pool.wait_for_empty();
+  pool.stop();
+  ASSERT_EQ(0u, misordered);
+  for (unsigned k = 0; k < keys; ++k) {
+    ASSERT_EQ(per_key, next[k]);
+  }
+}
+
+TEST(FinisherPool, Unkeyed)
+{
+  FinisherPool pool(g_ceph_context, "test_unkeyed", "fn_test", 4);
+  pool.start();
+  std::atomic<unsigned> done = {0};
+  std::list<Context*> ls;
+  for (unsigned i = 0; i < 1000; ++i) {
+    ls.push_back(new LambdaContext([&](int r) { ++done; }));
+  }
+  pool.queue(ls);
+  ASSERT_TRUE(ls.empty());
+  pool.queue(new LambdaContext([&](int r) { done += r; }), 5);
+  pool.wait_for_empty();
+  ASSERT_EQ(1005u, done);
+  pool.stop();
+}
+
+TEST(FinisherPool, SingleThreadFIFO)
+{
+  FinisherPool pool(g_ceph_context, "test_fifo", "fn_test", 1);
+  pool.start();
+  std::vector<int> order;
+  for (int i = 0; i < 100; ++i) {
+    pool.queue(i % 3, new LambdaContext([&, i](int r) {
+      order.push_back(i);
+    }));
+  }
+  pool.wait_for_empty();
+  pool.stop();
+  ASSERT_EQ(100u, order.size());
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(i, order[i]);
+  }
+}
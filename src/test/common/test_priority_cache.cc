@@ -0,0 +1,61 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <gtest/gtest.h>
+#include "common/PriorityCache.h"
+
+using PriorityCache::Consumer;
+using PriorityCache::Priority;
+
+static void assign(Consumer& c, int64_t pri0, int64_t pri2)
+{
+  for (int i = 0; i <= Priority::LAST; i++) {
+    c.set_cache_bytes(static_cast<Priority>(i), 0);
+  }
+  c.set_cache_bytes(Priority::PRI0, pri0);
+  c.set_cache_bytes(Priority::PRI2, pri2);
+  c.commit_cache_size(1 << 30);
+}
+
+TEST(PriorityCacheConsumer, Scale)
+{
+  uint64_t usage = 0;
+  std::vector<double> scales;
+  Consumer c("test", Priority::PRI2, [&] { return usage; },
+	     [&](double s) { scales.push_back(s); });
+  c.set_min_scale(0.25);
+  ASSERT_EQ(1.0, c.get_scale());
+
+  // nothing in use, nothing wanted
+  assign(c, 0, 0);
+  ASSERT_EQ(0, c.request_cache_bytes(Priority::PRI0, 1 << 30));
+  ASSERT_EQ(0, c.request_cache_bytes(Priority::PRI2, 1 << 30));
+  ASSERT_EQ(1.0, c.get_scale());
+
+  // the floor is asked for at PRI0, the rest at the consumer's priority
+  usage = 1000;
+  assign(c, 0, 0);
+  ASSERT_EQ(250, c.request_cache_bytes(Priority::PRI0, 1 << 30));
+  ASSERT_EQ(750, c.request_cache_bytes(Priority::PRI2, 1 << 30));
+  ASSERT_EQ(0, c.request_cache_bytes(Priority::PRI1, 1 << 30));
+
+  // given half of what it wants, it runs at half scale
+  assign(c, 250, 250);
+  ASSERT_EQ(0.5, c.get_scale());
+  ASSERT_EQ(1u, scales.size());
+
+  // at half scale it uses half as much, which still means 1000 at full scale
+  usage = 500;
+  assign(c, 250, 250);
+  ASSERT_EQ(0, c.request_cache_bytes(Priority::PRI0, 1 << 30));
+  ASSERT_EQ(500, c.request_cache_bytes(Priority::PRI2, 1 << 30));
+  ASSERT_EQ(0.5, c.get_scale());
+
+  // never below the minimum, never above 1
+  assign(c, 0, 0);
+  ASSERT_EQ(0.25, c.get_scale());
+  usage = 250;
+  assign(c, 1 << 20, 0);
+  ASSERT_EQ(1.0, c.get_scale());
+  ASSERT_EQ(3u, scales.size());
+}
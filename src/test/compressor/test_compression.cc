@@ -90,6 +90,52 @@ TEST_P(CompressorTest, small_round_trip)
        << " with " << GetParam() << std::endl;
 }
 
+TEST_P(CompressorTest, stream_round_trip)
+{
+  auto tx = compressor->create_stream();
+  auto rx = compressor->create_stream();
+  if (!tx) {
+    GTEST_SKIP() << GetParam() << " has no streaming mode";
+  }
+  ASSERT_TRUE(rx);
+  size_t first = 0, last = 0;
+  for (int i = 0; i < 10; i++) {
+    bufferlist orig;
+    orig.append("This is a short string.  There are many strings like it but this one is mine.");
+    orig.append(std::to_string(i));
+    bufferlist compressed;
+    ASSERT_EQ(0, tx->compress(orig, compressed));
+    bufferlist decompressed;
+    ASSERT_EQ(0, rx->decompress(compressed, decompressed));
+    ASSERT_TRUE(decompressed.contents_equal(orig));
+    (i ? last : first) = compressed.length();
+  }
+  // later buffers refer back to the earlier ones
+  ASSERT_LT(last, first);
+}
+
+TEST_P(CompressorTest, batch_round_trip)
+{
+  std::vector<bufferlist> origs(8);
+  std::vector<Compressor::BatchItem> batch(origs.size());
+  for (size_t i = 0; i < origs.size(); i++) {
+    for (int j = 0; j < 1000; j++) {
+      origs[i].append("This is a short string.  There are many strings like it but this one is mine.");
+      origs[i].append(std::to_string(i * j));
+    }
+    batch[i].in = &origs[i];
+  }
+  compressor->compress_batch(batch);
+  for (size_t i = 0; i < origs.size(); i++) {
+    ASSERT_EQ(0, batch[i].r);
+    ASSERT_LT(batch[i].out.length(), origs[i].length());
+    bufferlist decompressed;
+    ASSERT_EQ(0, compressor->decompress(batch[i].out, decompressed,
+					batch[i].compressor_message));
+    ASSERT_TRUE(decompressed.contents_equal(origs[i]));
+  }
+}
+
 TEST_P(CompressorTest, big_round_trip_repeated)
 {
   unsigned len = 1048576 * 4;
@@ -453,6 +499,31 @@ TEST(CompressionPlugin, all)
   }
 }
 
+TEST(Compressor, estimate_entropy)
+{
+  bufferlist zeros;
+  zeros.append_zero(65536);
+  EXPECT_EQ(0.0, Compressor::estimate_entropy(zeros));
+
+  bufferlist text;
+  while (text.length() < 65536) {
+    text.append("This is a short string.  There are many strings like it but this one is mine.");
+  }
+  EXPECT_LT(Compressor::estimate_entropy(text), 5.0);
+
+  // random data, spread over several buffers
+  bufferlist random;
+  for (int i = 0; i < 16; i++) {
+    bufferptr p(4096);
+    for (unsigned j = 0; j < p.length(); j++) {
+      p.c_str()[j] = rand();
+    }
+    random.append(p);
+  }
+  EXPECT_GT(Compressor::estimate_entropy(random), 7.5);
+  EXPECT_EQ(0.0, Compressor::estimate_entropy(bufferlist()));
+}
+
 #if defined(__x86_64__) || defined(__aarch64__)
 
 TEST(ZlibCompressor, isal_compress_zlib_decompress_random)
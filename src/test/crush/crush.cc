@@ -176,6 +176,33 @@ TEST_F(CRUSHTest, indep_out_alt) {
   }
 }
 
+TEST_F(CRUSHTest, do_rule_batch) {
+  std::unique_ptr<CrushWrapper> c(build_indep_map(cct, 3, 3, 3));
+  vector<__u32> weight(c->get_max_devices(), 0x10000);
+  // with some osds out, so that retries are exercised
+  for (int i = 0; i < 3*3*3; i += 4)
+    weight[i] = 0;
+
+  vector<int> xs;
+  for (int x = 0; x < 1000; ++x) {
+    xs.push_back(x * 7919);
+  }
+  for (int nr : {1, 3, 5}) {
+    vector<vector<int>> outs;
+    c->do_rule_batch(0, xs, &outs, nr, weight, 0);
+    ASSERT_EQ(xs.size(), outs.size());
+    for (size_t i = 0; i < xs.size(); ++i) {
+      vector<int> out;
+      c->do_rule(0, xs[i], out, nr, weight, 0);
+      ASSERT_EQ(out, outs[i]);
+    }
+  }
+
+  vector<vector<int>> outs;
+  c->do_rule_batch(0, vector<int>(), &outs, 3, weight, 0);
+  ASSERT_TRUE(outs.empty());
+}
+
 TEST_F(CRUSHTest, indep_out_contig) {
   std::unique_ptr<CrushWrapper> c(build_indep_map(cct, 3, 3, 3));
   vector<__u32> weight(c->get_max_devices(), 0x10000);
@@ -658,3 +685,61 @@ TEST_F(CRUSHTest, straw2_reweight) {
     cout << "     vs " << estddev << std::endl;
   }
 }
+
+TEST_F(CRUSHTest, straw2_compiled) {
+  // the precomputed divisors must not change any mapping, even once the
+  // weights changed behind their back
+  std::unique_ptr<CrushWrapper> c(new CrushWrapper);
+  const int ROOT_TYPE = 1;
+  c->set_type_name(ROOT_TYPE, "root");
+  const int OSD_TYPE = 0;
+  c->set_type_name(OSD_TYPE, "osd");
+
+  const int n = 13;
+  int items[n];
+  int weights[n];
+  for (int i = 0; i < n; ++i) {
+    items[i] = i;
+    weights[i] = 1 + (i * 7919 * 613) % 0x1fffff;
+  }
+  weights[0] = 1;
+  weights[1] = 0x10000;
+  weights[2] = 0;
+  weights[3] = 0x7fffffff;
+  c->set_max_devices(n);
+
+  int root;
+  crush_bucket *b = crush_make_bucket(c->get_crush_map(),
+				      CRUSH_BUCKET_STRAW2, CRUSH_HASH_RJENKINS1,
+				      ROOT_TYPE, n, items, weights);
+  crush_add_bucket(c->get_crush_map(), 0, b, &root);
+  c->set_item_name(root, "root");
+  int rule = c->add_simple_rule("rule", "root", "osd", "",
+				"firstn", pg_pool_t::TYPE_REPLICATED);
+  c->finalize();
+  ASSERT_TRUE(c->get_crush_map()->compiled);
+
+  vector<unsigned> reweight(n, 0x10000);
+  vector<vector<int>> compiled(10000);
+  for (int x = 0; x < 10000; ++x) {
+    c->do_rule(rule, x, compiled[x], 3, reweight, 0);
+  }
+  crush_destroy_compiled(c->get_crush_map());
+  for (int x = 0; x < 10000; ++x) {
+    vector<int> out;
+    c->do_rule(rule, x, out, 3, reweight, 0);
+    ASSERT_EQ(compiled[x], out);
+  }
+
+  c->compile();
+  c->adjust_item_weight(cct, 5, 0x23456);
+  for (int x = 0; x < 10000; ++x) {
+    c->do_rule(rule, x, compiled[x], 3, reweight, 0);
+  }
+  crush_destroy_compiled(c->get_crush_map());
+  for (int x = 0; x < 10000; ++x) {
+    vector<int> out;
+    c->do_rule(rule, x, out, 3, reweight, 0);
+    ASSERT_EQ(compiled[x], out);
+  }
+}
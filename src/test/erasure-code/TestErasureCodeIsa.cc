@@ -189,6 +189,109 @@ TEST_F(IsaErasureCodeTest, encode_decode)
   encode_decode(4096 + 1);
 }
 
+TEST_F(IsaErasureCodeTest, parity_delta)
+{
+  const char *techniques[] = { "reed_sol_van", "cauchy" };
+  for (auto technique : techniques) {
+    for (int m = 1; m <= 2; m++) {
+      ErasureCodeIsaDefault Isa(tcache,
+				strcmp(technique, "cauchy") == 0 ?
+				ErasureCodeIsaDefault::kCauchy :
+				ErasureCodeIsaDefault::kVandermonde);
+      ErasureCodeProfile profile;
+      profile["k"] = "4";
+      profile["m"] = stringify(m);
+      profile["technique"] = technique;
+      Isa.init(profile, &cerr);
+      EXPECT_TRUE(Isa.supports_parity_delta());
+
+      string payload(8192, 'X');
+      for (unsigned i = 0; i < payload.length(); i++)
+	payload[i] = 'A' + i % 26;
+      bufferlist in;
+      in.append(payload.c_str(), payload.length());
+      set<int> want_to_encode;
+      for (int i = 0; i < 4 + m; i++)
+	want_to_encode.insert(i);
+      map<int, bufferlist> encoded;
+      EXPECT_EQ(0, Isa.encode(want_to_encode, in, &encoded));
+      unsigned length = encoded[0].length();
+
+      // modify the data of chunks 0 and 2
+      for (unsigned i = 5; i < 50; i++) {
+	payload[i] = '0' + i % 10;
+	payload[2 * length + i] = '0' + i % 10;
+      }
+      bufferlist new_in;
+      new_in.append(payload.c_str(), payload.length());
+      map<int, bufferlist> new_encoded;
+      EXPECT_EQ(0, Isa.encode(want_to_encode, new_in, &new_encoded));
+
+      map<int, bufferptr> deltas;
+      for (int i : { 0, 2 }) {
+	EXPECT_EQ(0, Isa.encode_delta(
+		    buffer::copy(encoded[i].c_str(), length),
+		    buffer::copy(new_encoded[i].c_str(), length),
+		    &deltas[i]));
+      }
+      map<int, bufferptr> coding;
+      for (int i = 4; i < 4 + m; i++)
+	coding[i] = buffer::copy(encoded[i].c_str(), length);
+      EXPECT_EQ(0, Isa.apply_delta(deltas, coding));
+      for (int i = 4; i < 4 + m; i++)
+	EXPECT_EQ(0, memcmp(coding[i].c_str(), new_encoded[i].c_str(), length));
+    }
+  }
+}
+
+TEST_F(IsaErasureCodeTest, multi_stripe)
+{
+  // ECUtil encodes and decodes several stripes in one call by
+  // concatenating the chunks of each shard
+  ErasureCodeIsaDefault Isa(tcache);
+  ErasureCodeProfile profile;
+  profile["k"] = "4";
+  profile["m"] = "2";
+  Isa.init(profile, &cerr);
+  const unsigned stripes = 3;
+  const unsigned stripe_width = 4 * 4096;
+  set<int> want_to_encode;
+  for (int i = 0; i < 6; i++)
+    want_to_encode.insert(i);
+
+  map<int, bufferlist> per_stripe;
+  for (unsigned s = 0; s < stripes; s++) {
+    string payload(stripe_width, 'X');
+    for (unsigned i = 0; i < payload.length(); i++)
+      payload[i] = 'A' + (i * 7 + s) % 26;
+    bufferlist in;
+    in.append(payload.c_str(), payload.length());
+    map<int, bufferlist> encoded;
+    EXPECT_EQ(0, Isa.encode(want_to_encode, in, &encoded));
+    for (auto &i : encoded)
+      per_stripe[i.first].append(i.second);
+  }
+
+  map<int, bufferlist> batched;
+  for (int i = 0; i < 6; i++) {
+    bufferptr ptr(buffer::create_page_aligned(stripes * 4096));
+    if (i < 4)
+      memcpy(ptr.c_str(), per_stripe[i].c_str(), ptr.length());
+    batched[i].push_back(std::move(ptr));
+  }
+  EXPECT_EQ(0, Isa.encode_chunks(want_to_encode, &batched));
+  for (int i = 4; i < 6; i++)
+    EXPECT_TRUE(per_stripe[i].contents_equal(batched[i]));
+
+  map<int, bufferlist> chunks = per_stripe;
+  chunks.erase(1);
+  chunks.erase(4);
+  map<int, bufferlist> decoded;
+  EXPECT_EQ(0, Isa._decode(want_to_encode, chunks, &decoded));
+  EXPECT_TRUE(per_stripe[1].contents_equal(decoded[1]));
+  EXPECT_TRUE(per_stripe[4].contents_equal(decoded[4]));
+}
+
 TEST_F(IsaErasureCodeTest, minimum_to_decode)
 {
   ErasureCodeIsaDefault Isa(tcache);
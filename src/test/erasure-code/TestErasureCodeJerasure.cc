@@ -130,6 +130,50 @@ TYPED_TEST(ErasureCodeTest, encode_decode)
   }
 }
 
+TYPED_TEST(ErasureCodeTest, parity_delta)
+{
+  TypeParam jerasure;
+  ErasureCodeProfile profile;
+  profile["k"] = "2";
+  profile["m"] = "2";
+  profile["packetsize"] = "8";
+  jerasure.init(profile, &cerr);
+  EXPECT_TRUE(jerasure.supports_parity_delta());
+
+  string payload(LARGE_ENOUGH, 'X');
+  for (unsigned i = 0; i < payload.length(); i++)
+    payload[i] = 'A' + i % 26;
+  bufferlist in;
+  in.append(payload.c_str(), payload.length());
+  set<int> want_to_encode = { 0, 1, 2, 3 };
+  map<int, bufferlist> encoded;
+  EXPECT_EQ(0, jerasure.encode(want_to_encode, in, &encoded));
+  unsigned length = encoded[0].length();
+
+  // modify the data of chunk 1 only
+  for (unsigned i = length + 10; i < 2 * length && i < length + 100; i++)
+    payload[i] = '0' + i % 10;
+  bufferlist new_in;
+  new_in.append(payload.c_str(), payload.length());
+  map<int, bufferlist> new_encoded;
+  EXPECT_EQ(0, jerasure.encode(want_to_encode, new_in, &new_encoded));
+
+  bufferptr delta;
+  EXPECT_EQ(0, jerasure.encode_delta(
+	      buffer::copy(encoded[1].c_str(), length),
+	      buffer::copy(new_encoded[1].c_str(), length),
+	      &delta));
+  EXPECT_EQ(length, delta.length());
+  map<int, bufferptr> deltas = { { 1, delta } };
+  map<int, bufferptr> coding = {
+    { 2, buffer::copy(encoded[2].c_str(), length) },
+    { 3, buffer::copy(encoded[3].c_str(), length) },
+  };
+  EXPECT_EQ(0, jerasure.apply_delta(deltas, coding));
+  EXPECT_EQ(0, memcmp(coding[2].c_str(), new_encoded[2].c_str(), length));
+  EXPECT_EQ(0, memcmp(coding[3].c_str(), new_encoded[3].c_str(), length));
+}
+
 TYPED_TEST(ErasureCodeTest, minimum_to_decode)
 {
   TypeParam jerasure;
@@ -734,6 +734,58 @@ TEST(ErasureCodeLrc, encode_decode)
   }
 }
 
+TEST(ErasureCodeLrc, partial_decode)
+{
+  ErasureCodeLrc lrc(g_conf().get_val<std::string>("erasure_code_dir"));
+  ErasureCodeProfile profile;
+  profile["mapping"] =
+    "__DD__DD";
+  const char *description_string =
+    "[ "
+    "  [ \"_cDD_cDD\", \"\" ]," // global layer
+    "  [ \"c_DD____\", \"\" ]," // first local layer
+    "  [ \"____cDDD\", \"\" ]," // second local layer
+    "]";
+  profile["layers"] = description_string;
+  EXPECT_EQ(0, lrc.init(profile, &cerr));
+  EXPECT_TRUE(lrc.supports_partial_decode());
+  unsigned int chunk_size = g_conf().get_val<Option::size_t>("osd_pool_erasure_code_stripe_unit");
+  set<int> want_to_encode;
+  map<int, bufferlist> encoded;
+  for (unsigned int i = 0; i < lrc.get_chunk_count(); ++i) {
+    want_to_encode.insert(i);
+    encoded[i].push_back(buffer::create_page_aligned(chunk_size));
+  }
+  const vector<int> &mapping = lrc.get_chunk_mapping();
+  char c = 'A';
+  for (unsigned int i = 0; i < lrc.get_data_chunk_count(); i++) {
+    int j = mapping[i];
+    string s(chunk_size, c);
+    encoded[j].clear();
+    encoded[j].append(s);
+    c++;
+  }
+  EXPECT_EQ(0, lrc.encode_chunks(want_to_encode, &encoded));
+
+  // chunk 2 is decoded from chunks of both local groups by the global
+  // layer: combine the share of each group as if it was computed in the
+  // group
+  set<int> helpers = { 1, 3, 5, 6, 7 };
+  map<int, bufferlist> first = { { 1, encoded[1] }, { 3, encoded[3] } };
+  map<int, bufferlist> second = {
+    { 5, encoded[5] }, { 6, encoded[6] }, { 7, encoded[7] } };
+  bufferlist partial, other;
+  EXPECT_EQ(0, lrc.partial_decode(2, helpers, first, &partial));
+  EXPECT_EQ(0, lrc.partial_decode(2, helpers, second, &other));
+  EXPECT_EQ(0, lrc.combine_partial_decode(other, &partial));
+  EXPECT_EQ(string(chunk_size, 'A'), string(partial.c_str(), chunk_size));
+
+  // chunks outside of the helpers and decoding a helper are refused
+  map<int, bufferlist> stray = { { 0, encoded[0] } };
+  EXPECT_EQ(-EINVAL, lrc.partial_decode(2, helpers, stray, &other));
+  EXPECT_EQ(-EINVAL, lrc.partial_decode(1, helpers, first, &other));
+}
+
 TEST(ErasureCodeLrc, encode_decode_2)
 {
   ErasureCodeLrc lrc(g_conf().get_val<std::string>("erasure_code_dir"));
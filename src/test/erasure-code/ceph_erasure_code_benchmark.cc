@@ -15,6 +15,9 @@
  *
  */
 
+#include <atomic>
+#include <thread>
+
 #include <boost/scoped_ptr.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/program_options/option.hpp>
@@ -71,6 +74,10 @@ int ErasureCodeBench::setup(int argc, char** argv) {
      " the first chunk, then the second etc.)")
     ("parameter,P", po::value<vector<string> >(),
      "add a parameter to the erasure code profile")
+    ("threads,t", po::value<int>()->default_value(1),
+     "number of threads running the workload, each for --iterations runs")
+    ("per-core", "report the throughput in GB/s per thread instead of the "
+     "elapsed time and the KB processed")
     ;
 
   po::variables_map vm;
@@ -123,6 +130,12 @@ int ErasureCodeBench::setup(int argc, char** argv) {
   plugin = vm["plugin"].as<string>();
   workload = vm["workload"].as<string>();
   erasures = vm["erasures"].as<int>();
+  threads = vm["threads"].as<int>();
+  if (threads < 1) {
+    cout << "--threads is " << threads << ". But it needs to be > 0." << endl;
+    return -EINVAL;
+  }
+  per_core = vm.count("per-core") > 0;
   if (vm.count("erasures-generation") > 0 &&
       vm["erasures-generation"].as<string>() == "exhaustive")
     exhaustive_erasures = true;
@@ -162,6 +175,37 @@ int ErasureCodeBench::run() {
     return decode();
 }
 
+int ErasureCodeBench::timed(std::function<int()> once)
+{
+  std::atomic<int> code = 0;
+  std::vector<std::thread> workers;
+  utime_t begin_time = ceph_clock_now();
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&] {
+      for (int i = 0; i < max_iterations && code == 0; i++) {
+	int r = once();
+	if (r)
+	  code = r;
+      }
+    });
+  }
+  for (auto &w : workers)
+    w.join();
+  utime_t end_time = ceph_clock_now();
+  if (code)
+    return code;
+  double elapsed = end_time - begin_time;
+  if (per_core) {
+    double bytes = (double)max_iterations * in_size;
+    cout << (elapsed > 0 ? bytes / elapsed / 1e9 : 0) << " GB/s per core, "
+	 << threads << " threads" << endl;
+  } else {
+    cout << (end_time - begin_time) << "\t"
+	 << (threads * max_iterations * (in_size / 1024)) << endl;
+  }
+  return 0;
+}
+
 int ErasureCodeBench::encode()
 {
   ErasureCodePluginRegistry &instance = ErasureCodePluginRegistry::instance();
@@ -182,16 +226,10 @@ int ErasureCodeBench::encode()
   for (int i = 0; i < k + m; i++) {
     want_to_encode.insert(i);
   }
-  utime_t begin_time = ceph_clock_now();
-  for (int i = 0; i < max_iterations; i++) {
+  return timed([&] {
     std::map<int,bufferlist> encoded;
-    code = erasure_code->encode(want_to_encode, in, &encoded);
-    if (code)
-      return code;
-  }
-  utime_t end_time = ceph_clock_now();
-  cout << (end_time - begin_time) << "\t" << (max_iterations * (in_size / 1024)) << endl;
-  return 0;
+    return erasure_code->encode(want_to_encode, in, &encoded);
+  });
 }
 
 static void display_chunks(const map<int,bufferlist> &chunks,
@@ -294,17 +332,12 @@ int ErasureCodeBench::decode()
     display_chunks(encoded, erasure_code->get_chunk_count());
   }
 
-  utime_t begin_time = ceph_clock_now();
-  for (int i = 0; i < max_iterations; i++) {
+  return timed([&] {
     if (exhaustive_erasures) {
-      code = decode_erasures(encoded, encoded, 0, erasures, erasure_code);
-      if (code)
-	return code;
+      return decode_erasures(encoded, encoded, 0, erasures, erasure_code);
     } else if (erased.size() > 0) {
       map<int,bufferlist> decoded;
-      code = erasure_code->decode(want_to_read, encoded, &decoded, 0);
-      if (code)
-	return code;
+      return erasure_code->decode(want_to_read, encoded, &decoded, 0);
     } else {
       map<int,bufferlist> chunks = encoded;
       for (int j = 0; j < erasures; j++) {
@@ -315,14 +348,9 @@ int ErasureCodeBench::decode()
 	chunks.erase(erasure);
       }
       map<int,bufferlist> decoded;
-      code = erasure_code->decode(want_to_read, chunks, &decoded, 0);
-      if (code)
-	return code;
+      return erasure_code->decode(want_to_read, chunks, &decoded, 0);
     }
-  }
-  utime_t end_time = ceph_clock_now();
-  cout << (end_time - begin_time) << "\t" << (max_iterations * (in_size / 1024)) << endl;
-  return 0;
+  });
 }
 
 int main(int argc, char** argv) {
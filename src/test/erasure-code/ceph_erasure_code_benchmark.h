@@ -18,6 +18,7 @@
 #ifndef CEPH_ERASURE_CODE_BENCHMARK_H
 #define CEPH_ERASURE_CODE_BENCHMARK_H
 
+#include <functional>
 #include <string>
 #include <map>
 #include <vector>
@@ -34,6 +35,8 @@ class ErasureCodeBench {
   int in_size;
   int max_iterations;
   int erasures;
+  int threads;
+  bool per_core;
   int k;
   int m;
 
@@ -55,6 +58,8 @@ public:
 		      unsigned i,
 		      unsigned want_erasures,
 		      ErasureCodeInterfaceRef erasure_code);
+  /// run @once --iterations times in each of --threads threads, report
+  int timed(std::function<int()> once);
   int decode();
   int encode();
 };
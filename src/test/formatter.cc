@@ -15,6 +15,7 @@
 #include "gtest/gtest.h"
 #include "common/Formatter.h"
 #include "common/HTMLFormatter.h"
+#include "include/buffer.h"
 
 #include <sstream>
 #include <string>
@@ -69,6 +70,43 @@ TEST(JsonFormatter, Empty) {
   ASSERT_EQ(oss.str(), "");
 }
 
+TEST(JsonFormatter, Escape) {
+  ostringstream oss;
+  JSONFormatter fmt(false);
+  fmt.open_object_section("foo");
+  fmt.dump_string("quote", "a\"b\\c");
+  fmt.dump_string("ctrl", "tab\tnl\ncr\r\x01\x7f");
+  // an escape past the first word
+  fmt.dump_string("long", "0123456789abcdef\"0123456789");
+  fmt.dump_string("utf8", "caf\xc3\xa9 and more text");
+  fmt.close_section();
+  fmt.flush(oss);
+  ASSERT_EQ(oss.str(), "{\"quote\":\"a\\\"b\\\\c\",\
+\"ctrl\":\"tab\\tnl\\ncr\\u000d\\u0001\\u007f\",\
+\"long\":\"0123456789abcdef\\\"0123456789\",\
+\"utf8\":\"caf\xc3\xa9 and more text\"}");
+}
+
+TEST(JsonFormatter, FlushBufferlist) {
+  JSONFormatter fmt(true);
+  bufferlist bl;
+  for (int i = 0; i < 2; i++) {
+    // flushing keeps the formatter usable for the next document
+    fmt.open_object_section("foo");
+    fmt.dump_int("a", i);
+    fmt.dump_stream("b") << "x" << i;
+    fmt.open_array_section("c");
+    fmt.dump_unsigned("", 1);
+    fmt.close_section();
+    fmt.close_section();
+    fmt.flush(bl);
+  }
+  ASSERT_EQ(bl.to_str(), "{\n    \"a\": 0,\n    \"b\": \"x0\",\n\
+    \"c\": [\n        1\n    ]\n}\n\
+{\n    \"a\": 1,\n    \"b\": \"x1\",\n    \"c\": [\n        1\n    ]\n}\n");
+  ASSERT_EQ(0, fmt.get_len());
+}
+
 TEST(XmlFormatter, Simple1) {
   ostringstream oss;
   XMLFormatter fmt(false);
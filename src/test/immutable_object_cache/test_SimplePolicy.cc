@@ -233,3 +233,18 @@ TEST_F(TestSimplePolicy, test_evict_list_10) {
     m_promoted_lru.erase(m_promoted_lru.begin());
   }
 }
+
+TEST_F(TestSimplePolicy, test_promote_threshold) {
+  SimplePolicy policy(g_ceph_context, m_cache_size, 128, 0.9, 3);
+  ASSERT_EQ(OBJ_CACHE_SKIP, policy.lookup_object("threshold_file"));
+  ASSERT_EQ(OBJ_CACHE_NONE, policy.get_status("threshold_file"));
+  ASSERT_EQ(OBJ_CACHE_SKIP, policy.lookup_object("threshold_file"));
+  ASSERT_EQ(0u, policy.get_promoting_entry_num());
+  // third lookup starts the promotion
+  ASSERT_EQ(OBJ_CACHE_NONE, policy.lookup_object("threshold_file"));
+  ASSERT_EQ(OBJ_CACHE_SKIP, policy.get_status("threshold_file"));
+  ASSERT_EQ(1u, policy.get_promoting_entry_num());
+  policy.update_status("threshold_file", OBJ_CACHE_PROMOTED, 1);
+  ASSERT_EQ(OBJ_CACHE_PROMOTED, policy.lookup_object("threshold_file"));
+  policy.evict_entry("threshold_file");
+}
@@ -224,7 +224,7 @@ TEST_F(TestMockObjectMap, DetainedUpdate) {
                 1, 3, 1, {}, false, &finish_update_2);
   Context *finish_update_3 = nullptr;
   expect_update(mock_image_ctx, mock_update_request, CEPH_NOSNAP,
-                2, 3, 1, {}, false, &finish_update_3);
+                2, 3, 3, {}, false, &finish_update_3);
   Context *finish_update_4 = nullptr;
   expect_update(mock_image_ctx, mock_update_request, CEPH_NOSNAP,
                 0, 2, 1, {}, false, &finish_update_4);
@@ -251,7 +251,7 @@ TEST_F(TestMockObjectMap, DetainedUpdate) {
                                &update_ctx1);
     mock_object_map->aio_update(CEPH_NOSNAP, 1, 3, 1, {}, {}, false,
                                &update_ctx2);
-    mock_object_map->aio_update(CEPH_NOSNAP, 2, 3, 1, {}, {}, false,
+    mock_object_map->aio_update(CEPH_NOSNAP, 2, 3, 3, {}, {}, false,
                                &update_ctx3);
     mock_object_map->aio_update(CEPH_NOSNAP, 0, 2, 1, {}, {}, false,
                                &update_ctx4);
@@ -281,5 +281,71 @@ TEST_F(TestMockObjectMap, DetainedUpdate) {
   ASSERT_EQ(0, close_ctx.wait());
 }
 
+TEST_F(TestMockObjectMap, CoalescedDetainedUpdate) {
+  REQUIRE_FEATURE(RBD_FEATURE_OBJECT_MAP);
+
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+
+  InSequence seq;
+  ceph::BitVector<2u> object_map;
+  object_map.resize(4);
+  MockRefreshRequest mock_refresh_request;
+  expect_refresh(mock_image_ctx, mock_refresh_request, object_map, 0);
+
+  MockUpdateRequest mock_update_request;
+  Context *finish_update_1;
+  expect_update(mock_image_ctx, mock_update_request, CEPH_NOSNAP,
+                0, 4, 1, {}, false, &finish_update_1);
+  Context *finish_update_2 = nullptr;
+  expect_update(mock_image_ctx, mock_update_request, CEPH_NOSNAP,
+                1, 4, 1, {}, false, &finish_update_2);
+
+  MockUnlockRequest mock_unlock_request;
+  expect_unlock(mock_image_ctx, mock_unlock_request, 0);
+
+  MockObjectMap *mock_object_map = new MockObjectMap(mock_image_ctx, CEPH_NOSNAP);
+  BOOST_SCOPE_EXIT(&mock_object_map) {
+    mock_object_map->put();
+  } BOOST_SCOPE_EXIT_END
+
+  C_SaferCond open_ctx;
+  mock_object_map->open(&open_ctx);
+  ASSERT_EQ(0, open_ctx.wait());
+
+  C_SaferCond update_ctx1;
+  C_SaferCond update_ctx2;
+  C_SaferCond update_ctx3;
+  C_SaferCond update_ctx4;
+  {
+    std::shared_lock image_locker{mock_image_ctx.image_lock};
+    mock_object_map->aio_update(CEPH_NOSNAP, 0, 4, 1, {}, {}, false,
+                               &update_ctx1);
+    mock_object_map->aio_update(CEPH_NOSNAP, 1, 2, 1, {}, {}, false,
+                               &update_ctx2);
+    mock_object_map->aio_update(CEPH_NOSNAP, 2, 3, 1, {}, {}, false,
+                               &update_ctx3);
+    mock_object_map->aio_update(CEPH_NOSNAP, 3, 4, 1, {}, {}, false,
+                               &update_ctx4);
+  }
+
+  // updates 2, 3 and 4 are blocked on update 1 and then sent as one
+  ASSERT_EQ(nullptr, finish_update_2);
+  finish_update_1->complete(0);
+  ASSERT_EQ(0, update_ctx1.wait());
+
+  ASSERT_NE(nullptr, finish_update_2);
+  finish_update_2->complete(0);
+  ASSERT_EQ(0, update_ctx2.wait());
+  ASSERT_EQ(0, update_ctx3.wait());
+  ASSERT_EQ(0, update_ctx4.wait());
+
+  C_SaferCond close_ctx;
+  mock_object_map->close(&close_ctx);
+  ASSERT_EQ(0, close_ctx.wait());
+}
+
 } // namespace librbd
 
@@ -68,3 +68,34 @@ TEST(TTLCache, HitRatio) {
 	ASSERT_EQ(std::get<1>(hit_miss_ratio), 3);
 	ASSERT_EQ(std::get<0>(hit_miss_ratio), 2);
 }
+
+TEST(VersionedCache, Get) {
+	VersionedCache<string, int, int> c;
+	c.insert("foo", 1, 10);
+	ASSERT_EQ(c.get("foo", 1), 10);
+	ASSERT_EQ(c.get("foo", 1), 10);
+	c.insert("foo", 2, 20);
+	ASSERT_EQ(c.get("foo", 2), 20);
+	ASSERT_EQ(c.size(), 1);
+	std::pair<uint64_t, uint64_t> hit_miss_ratio = c.get_hit_miss_ratio();
+	ASSERT_EQ(std::get<0>(hit_miss_ratio), 3);
+	ASSERT_EQ(std::get<1>(hit_miss_ratio), 2);
+}
+
+TEST(VersionedCache, Stale) {
+	VersionedCache<string, std::pair<int, int>, int> c;
+	c.insert("foo", {1, 1}, 10);
+	try {
+		c.get("foo", {1, 2});
+		FAIL();
+	} catch (std::out_of_range& e) {
+		SUCCEED();
+	}
+	// a stale entry is dropped, whatever version is asked for next
+	ASSERT_FALSE(c.exists("foo"));
+	c.insert("foo", {1, 2}, 20);
+	ASSERT_EQ(c.get("foo", {1, 2}), 20);
+	c.erase("foo");
+	c.erase("foo");
+	ASSERT_FALSE(c.size());
+}
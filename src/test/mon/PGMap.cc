@@ -167,3 +167,66 @@ TEST(pgmap, dump_object_stat_sum_2)
   ASSERT_EQ(percentify(0), tbl.get(0, col++));
   ASSERT_EQ(stringify(byte_u_t(avail/pool.size)), tbl.get(0, col++));
 }
+
+// the aggregates maintained by apply_incremental() must match what
+// calc_stats() computes from scratch
+TEST(pgmap, apply_incremental_matches_calc_stats)
+{
+  PGMap pg_map;
+  auto make_stat = [](int osd, uint64_t state, uint64_t bytes) {
+    pg_stat_t s;
+    s.state = state;
+    s.up = s.acting = {osd, osd + 1, osd + 2};
+    s.up_primary = s.acting_primary = osd;
+    s.stats.sum.num_bytes = bytes;
+    s.stats.sum.num_objects = bytes / 4096;
+    return s;
+  };
+  for (unsigned round = 0; round < 4; ++round) {
+    PGMap::Incremental inc;
+    inc.version = pg_map.version + 1;
+    inc.stamp = utime_t(round + 1, 0);
+    for (unsigned ps = 0; ps < 32; ++ps) {
+      pg_t pgid(ps, 1 + ps % 2);
+      uint64_t state = PG_STATE_ACTIVE | PG_STATE_CLEAN;
+      int osd = ps % 4;
+      if (round == 2 && ps % 3 == 0) {
+	// remap some PGs, and block others
+	osd = (osd + 1) % 4;
+	state = PG_STATE_ACTIVE | PG_STATE_REMAPPED;
+      }
+      auto s = make_stat(osd, state, (round + 1) * (ps + 1) * 4096);
+      if (round == 3 && ps % 5 == 0) {
+	s.blocked_by = {osd + 3};
+      }
+      inc.pg_stat_updates[pgid] = s;
+    }
+    if (round == 3) {
+      inc.pg_remove.insert(pg_t(0, 1));
+    }
+    pg_map.apply_incremental(nullptr, inc);
+  }
+
+  bufferlist bl;
+  pg_map.encode(bl, CEPH_FEATURES_ALL);
+  PGMap full;
+  auto p = bl.cbegin();
+  full.decode(p);  // calls calc_stats()
+
+  ASSERT_EQ(full.num_pg, pg_map.num_pg);
+  ASSERT_EQ(full.num_pg_active, pg_map.num_pg_active);
+  ASSERT_EQ(full.num_pg_by_pool, pg_map.num_pg_by_pool);
+  ASSERT_EQ(full.num_pg_by_state, pg_map.num_pg_by_state);
+  ASSERT_EQ(full.pg_by_osd, pg_map.pg_by_osd);
+  ASSERT_EQ(full.blocked_by_sum, pg_map.blocked_by_sum);
+  ASSERT_EQ(full.pg_sum.stats.sum.num_bytes, pg_map.pg_sum.stats.sum.num_bytes);
+  for (int osd = 0; osd < 8; ++osd) {
+    ASSERT_EQ(full.get_num_pg_by_osd(osd), pg_map.get_num_pg_by_osd(osd));
+    ASSERT_EQ(full.get_num_primary_pg_by_osd(osd),
+	      pg_map.get_num_primary_pg_by_osd(osd));
+  }
+  for (auto& [pool, sum] : full.pg_pool_sum) {
+    ASSERT_EQ(sum.stats.sum.num_bytes,
+	      pg_map.pg_pool_sum[pool].stats.sum.num_bytes);
+  }
+}
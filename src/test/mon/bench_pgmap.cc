@@ -0,0 +1,141 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+/*
+ * Build a synthetic PGMap and time the ways the monitor and the mgr
+ * maintain its aggregates: applying an incremental that refreshes some
+ * fraction of the PGs, and recomputing everything with calc_stats().
+ */
+
+#include <iostream>
+#include <sstream>
+
+#include "include/types.h"
+#include "common/Clock.h"
+#include "common/ceph_argparse.h"
+#include "global/global_init.h"
+#include "mon/PGMap.h"
+
+using namespace std;
+
+void usage(const char *name) {
+  cout << name << " [--pgs N] [--pools N] [--osds N] [--size N]"
+       << " [--rounds N] [--update-pct N] [--remap-pct N]\n"
+       << "\t pgs: total number of PGs (default 1000000)\n"
+       << "\t pools: number of pools the PGs are spread over (default 16)\n"
+       << "\t osds: number of OSDs (default 1000)\n"
+       << "\t size: replicas per PG (default 3)\n"
+       << "\t rounds: number of incrementals to apply (default 10)\n"
+       << "\t update-pct: percent of PGs reported per round (default 100)\n"
+       << "\t remap-pct: percent of reported PGs that move (default 1)\n";
+}
+
+static pg_stat_t make_stat(unsigned osds, unsigned size, unsigned first,
+			   uint64_t objects)
+{
+  pg_stat_t s;
+  s.state = PG_STATE_ACTIVE | PG_STATE_CLEAN;
+  for (unsigned i = 0; i < size; ++i) {
+    s.up.push_back((first + i) % osds);
+  }
+  s.acting = s.up;
+  s.up_primary = s.acting_primary = s.up[0];
+  s.stats.sum.num_objects = objects;
+  s.stats.sum.num_bytes = objects << 22;
+  s.stats.sum.num_rd = objects * 3;
+  s.stats.sum.num_wr = objects * 2;
+  return s;
+}
+
+int main(int argc, const char **argv)
+{
+  auto args = argv_to_vec(argc, argv);
+  auto cct = global_init(NULL, args, CEPH_ENTITY_TYPE_CLIENT,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+  common_init_finish(g_ceph_context);
+
+  int pgs = 1000000, pools = 16, osds = 1000, size = 3;
+  int rounds = 10, update_pct = 100, remap_pct = 1;
+  for (auto i = args.begin(); i != args.end();) {
+    std::stringstream err;
+    if (ceph_argparse_double_dash(args, i)) {
+      break;
+    } else if (ceph_argparse_witharg(args, i, &pgs, err, "--pgs", (char*)NULL) ||
+	       ceph_argparse_witharg(args, i, &pools, err, "--pools", (char*)NULL) ||
+	       ceph_argparse_witharg(args, i, &osds, err, "--osds", (char*)NULL) ||
+	       ceph_argparse_witharg(args, i, &size, err, "--size", (char*)NULL) ||
+	       ceph_argparse_witharg(args, i, &rounds, err, "--rounds", (char*)NULL) ||
+	       ceph_argparse_witharg(args, i, &update_pct, err, "--update-pct", (char*)NULL) ||
+	       ceph_argparse_witharg(args, i, &remap_pct, err, "--remap-pct", (char*)NULL)) {
+      if (!err.str().empty()) {
+	cerr << err.str() << std::endl;
+	return EXIT_FAILURE;
+      }
+    } else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (pgs <= 0 || pools <= 0 || osds < size || size <= 0) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  unsigned pgs_per_pool = pgs / pools;
+
+  cout << "pgs " << pgs_per_pool * pools << " pools " << pools
+       << " osds " << osds << " size " << size << std::endl;
+
+  PGMap pg_map;
+  utime_t start = ceph_clock_now();
+  {
+    PGMap::Incremental inc;
+    inc.version = pg_map.version + 1;
+    inc.stamp = ceph_clock_now();
+    for (int pool = 0; pool < pools; ++pool) {
+      for (unsigned ps = 0; ps < pgs_per_pool; ++ps) {
+	inc.pg_stat_updates[pg_t(ps, pool + 1)] =
+	  make_stat(osds, size, ps * size + pool, ps % 1000);
+      }
+    }
+    pg_map.apply_incremental(g_ceph_context, inc);
+  }
+  cout << "populate: " << (ceph_clock_now() - start) << "s" << std::endl;
+
+  double inc_total = 0;
+  for (int round = 0; round < rounds; ++round) {
+    PGMap::Incremental inc;
+    inc.version = pg_map.version + 1;
+    inc.stamp = ceph_clock_now();
+    unsigned n = 0;
+    for (int pool = 0; pool < pools; ++pool) {
+      for (unsigned ps = 0; ps < pgs_per_pool; ++ps, ++n) {
+	if ((n * 7919u + round) % 100 >= (unsigned)update_pct) {
+	  continue;
+	}
+	unsigned first = ps * size + pool;
+	if ((n * 104729u + round) % 100 < (unsigned)remap_pct) {
+	  first += round + 1;
+	}
+	inc.pg_stat_updates[pg_t(ps, pool + 1)] =
+	  make_stat(osds, size, first, ps % 1000 + round + 1);
+      }
+    }
+    start = ceph_clock_now();
+    pg_map.apply_incremental(g_ceph_context, inc);
+    double t = ceph_clock_now() - start;
+    inc_total += t;
+    cout << "apply_incremental " << inc.pg_stat_updates.size() << " pgs: "
+	 << t << "s" << std::endl;
+  }
+
+  start = ceph_clock_now();
+  pg_map.calc_stats();
+  cout << "calc_stats: " << (ceph_clock_now() - start) << "s" << std::endl;
+  if (rounds > 0) {
+    cout << "apply_incremental avg: " << inc_total / rounds << "s" << std::endl;
+  }
+  cout << "num_pg " << pg_map.num_pg
+       << " bytes " << pg_map.pg_sum.stats.sum.num_bytes << std::endl;
+  return 0;
+}
@@ -19,12 +19,15 @@
 #include <string>
 #include <unistd.h>
 #include <iostream>
+#include <sys/resource.h>
 
 using namespace std;
 
 #include "common/ceph_argparse.h"
 #include "common/debug.h"
 #include "common/Cycles.h"
+#include "common/perf_histogram.h"
+#include "include/str_list.h"
 #include "global/global_init.h"
 #include "msg/Messenger.h"
 #include "messages/MOSDOp.h"
@@ -32,6 +35,75 @@ using namespace std;
 
 #include <atomic>
 
+/// Round trip latencies in microseconds, in 1us buckets up to 100ms.
+class LatencyHistogram : public PerfHistogram<1> {
+ public:
+  static constexpr int32_t BUCKETS = 100000 + 2;
+
+  LatencyHistogram()
+    : PerfHistogram<1>({{"latency_us", SCALE_LINEAR, 0, 1, BUCKETS}}) {}
+
+  void add_to(std::vector<uint64_t> *counts) const {
+    counts->resize(BUCKETS);
+    for (int32_t i = 0; i < BUCKETS; ++i) {
+      (*counts)[i] += read_bucket(i);
+    }
+  }
+  /// upper bound in us of the bucket holding the @p fraction of samples;
+  /// -1 if that is beyond the last bucket
+  static int64_t percentile(const std::vector<uint64_t>& counts, double p) {
+    uint64_t total = 0;
+    for (auto c : counts) {
+      total += c;
+    }
+    uint64_t want = std::max<uint64_t>(1, total * p + 0.5);
+    uint64_t seen = 0;
+    for (int32_t i = 0; i < (int32_t)counts.size(); ++i) {
+      seen += counts[i];
+      if (seen >= want) {
+        return i < BUCKETS - 1 ? i : -1;
+      }
+    }
+    return 0;
+  }
+};
+
+/// message data sizes and how often each one is sent, e.g. "4096:9,65536:1"
+struct SizeMix {
+  struct Entry {
+    int len;
+    int weight;
+    LatencyHistogram lat;
+  };
+  std::vector<std::unique_ptr<Entry>> entries;
+  int total_weight = 0;
+
+  bool parse(const string& s) {
+    for_each_substr(s, ",", [this] (auto item) {
+      string e(item);
+      auto pos = e.find(':');
+      int len = atoi(e.substr(0, pos).c_str());
+      int weight = pos == string::npos ? 1 : atoi(e.substr(pos + 1).c_str());
+      if (len > 0 && weight > 0) {
+        entries.emplace_back(new Entry{len, weight, {}});
+        total_weight += weight;
+      }
+    });
+    return !entries.empty();
+  }
+  /// the entry used for the @p i-th message, interleaving sizes by weight
+  Entry& pick(uint64_t i) {
+    int w = (i * 7919) % total_weight;
+    for (auto& e : entries) {
+      if (w < e->weight) {
+        return *e;
+      }
+      w -= e->weight;
+    }
+    ceph_abort();
+  }
+};
+
 class MessengerClient {
   class ClientThread;
   class ClientDispatcher : public Dispatcher {
@@ -70,8 +142,8 @@ class MessengerClient {
     object_t oid;
     object_locator_t oloc;
     pg_t pgid;
-    int msg_len;
-    bufferlist data;
+    SizeMix *mix;
+    bufferptr data;
     int ops;
     ClientDispatcher dispatcher;
 
@@ -79,31 +151,39 @@ class MessengerClient {
     ceph::mutex lock = ceph::make_mutex("MessengerBenchmark::ClientThread::lock");
     ceph::condition_variable cond;
     uint64_t inflight;
+    /// tid -> send time and latency histogram of the ops in flight
+    map<ceph_tid_t, pair<uint64_t, LatencyHistogram*>> sent;
 
-    ClientThread(Messenger *m, int c, ConnectionRef con, int len, int ops, int think_time_us):
-        msgr(m), concurrent(c), conn(con), oid("object-name"), oloc(1, 1), msg_len(len), ops(ops),
+    ClientThread(Messenger *m, int c, ConnectionRef con, SizeMix *mix, int ops, int think_time_us):
+        msgr(m), concurrent(c), conn(con), oid("object-name"), oloc(1, 1), mix(mix), ops(ops),
         dispatcher(think_time_us, this), inflight(0) {
       m->add_dispatcher_head(&dispatcher);
-      bufferptr ptr(msg_len);
-      memset(ptr.c_str(), 0, msg_len);
-      data.append(ptr);
+      int max_len = 0;
+      for (auto& e : mix->entries) {
+        max_len = std::max(max_len, e->len);
+      }
+      data = bufferptr(max_len);
+      memset(data.c_str(), 0, max_len);
     }
     void *entry() override {
       std::unique_lock locker{lock};
       for (int i = 0; i < ops; ++i) {
-        if (inflight > uint64_t(concurrent)) {
-	  cond.wait(locker);
-        }
+        cond.wait(locker, [this] { return inflight <= uint64_t(concurrent); });
 	hobject_t hobj(oid, oloc.key, CEPH_NOSNAP, pgid.ps(), pgid.pool(),
 		       oloc.nspace);
 	spg_t spgid(pgid);
-        MOSDOp *m = new MOSDOp(client_inc, 0, hobj, spgid, 0, 0, 0);
-        bufferlist msg_data(data);
-        m->write(0, msg_len, msg_data);
+        auto& e = mix->pick(i);
+        MOSDOp *m = new MOSDOp(client_inc, i + 1, hobj, spgid, 0, 0, 0);
+        bufferlist msg_data;
+        msg_data.append(data, 0, e.len);
+        m->write(0, e.len, msg_data);
         inflight++;
+        sent[i + 1] = {Cycles::rdtsc(), &e.lat};
         conn->send_message(m);
         //cerr << __func__ << " send m=" << m << std::endl;
       }
+      // wait for the replies, so that every op is accounted for
+      cond.wait(locker, [this] { return inflight == 0; });
       locker.unlock();
       msgr->shutdown();
       return 0;
@@ -130,7 +210,7 @@ class MessengerClient {
       msgrs[i]->wait();
     }
   }
-  void ready(int c, int jobs, int ops, int msg_len) {
+  void ready(int c, int jobs, int ops, SizeMix *mix) {
     entity_addr_t addr;
     addr.parse(serveraddr.c_str());
     addr.set_nonce(0);
@@ -142,7 +222,7 @@ class MessengerClient {
       msgr->start();
       entity_addrvec_t addrs(addr);
       ConnectionRef conn = msgr->connect_to_osd(addrs);
-      ClientThread *t = new ClientThread(msgr, c, conn, msg_len, ops, think_time_us);
+      ClientThread *t = new ClientThread(msgr, c, conn, mix, ops, think_time_us);
       msgrs.push_back(msgr);
       clients.push_back(t);
     }
@@ -157,13 +237,38 @@ class MessengerClient {
 };
 
 void MessengerClient::ClientDispatcher::ms_fast_dispatch(Message *m) {
+  uint64_t now = Cycles::rdtsc();
   usleep(think_time);
+  ceph_tid_t tid = m->get_tid();
   m->put();
   std::lock_guard l{thread->lock};
+  auto p = thread->sent.find(tid);
+  if (p != thread->sent.end()) {
+    p->second.second->inc(Cycles::to_microseconds(now - p->second.first));
+    thread->sent.erase(p);
+  }
   thread->inflight--;
   thread->cond.notify_all();
 }
 
+static double get_cpu_seconds()
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1000000.0 +
+    ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1000000.0;
+}
+
+static void print_latency(const string& name, const std::vector<uint64_t>& counts)
+{
+  auto us = [&counts] (double p) {
+    int64_t v = LatencyHistogram::percentile(counts, p);
+    return v < 0 ? string(">100000") : std::to_string(v);
+  };
+  cout << " " << name << " latency(us) p50 " << us(0.5)
+       << " p99 " << us(0.99) << " p999 " << us(0.999) << std::endl;
+}
+
 
 void usage(const string &name) {
   cout << "Usage: " << name << " [server ip:port] [numjobs] [concurrency] [ios] [thinktime us] [msg length]" << std::endl;
@@ -172,7 +277,12 @@ void usage(const string &name) {
   cout << "       [concurrency]: the max inflight messages(like iodepth in fio)" << std::endl;
   cout << "       [ios]: how much messages sent for each client" << std::endl;
   cout << "       [thinktime]: sleep time when do fast dispatching(match client logic)" << std::endl;
-  cout << "       [msg length]: message data bytes" << std::endl;
+  cout << "       [msg length]: message data bytes, or a mix of sizes and their weights" << std::endl;
+  cout << "                     like 4096:9,65536:1" << std::endl;
+  cout << std::endl;
+  cout << "The stack is chosen with --ms_type (async+posix, async+rdma, async+dpdk);" << std::endl;
+  cout << "secure or compressed modes with e.g. --ms_client_mode secure or" << std::endl;
+  cout << "--ms_osd_compress_mode force on both ends." << std::endl;
 }
 
 int main(int argc, char **argv)
@@ -194,7 +304,11 @@ int main(int argc, char **argv)
   int concurrent = atoi(args[2]);
   int ios = atoi(args[3]);
   int think_time = atoi(args[4]);
-  int len = atoi(args[5]);
+  SizeMix mix;
+  if (!mix.parse(args[5])) {
+    usage(argv[0]);
+    return 1;
+  }
 
   std::string public_msgr_type = g_ceph_context->_conf->ms_public_type.empty() ? g_ceph_context->_conf.get_val<std::string>("ms_type") : g_ceph_context->_conf->ms_public_type;
 
@@ -204,16 +318,33 @@ int main(int argc, char **argv)
   cout << "       concurrency " << concurrent << std::endl;
   cout << "       ios " << ios << std::endl;
   cout << "       thinktime(us) " << think_time << std::endl;
-  cout << "       message data bytes " << len << std::endl;
+  cout << "       message data bytes " << args[5] << std::endl;
 
   MessengerClient client(public_msgr_type, args[0], think_time);
 
-  client.ready(concurrent, numjobs, ios, len);
   Cycles::init();
+  client.ready(concurrent, numjobs, ios, &mix);
+  double cpu_start = get_cpu_seconds();
   uint64_t start = Cycles::rdtsc();
   client.start();
   uint64_t stop = Cycles::rdtsc();
-  cout << " Total op " << (ios * numjobs) << " run time " << Cycles::to_microseconds(stop - start) << "us." << std::endl;
+  double cpu = get_cpu_seconds() - cpu_start;
+  uint64_t total_ops = (uint64_t)ios * numjobs;
+  cout << " Total op " << total_ops << " run time " << Cycles::to_microseconds(stop - start) << "us." << std::endl;
+  cout << " Client cpu " << cpu << "s, "
+       << Cycles::from_seconds(cpu) / std::max<uint64_t>(total_ops, 1)
+       << " cycles/op" << std::endl;
+
+  std::vector<uint64_t> all;
+  for (auto& e : mix.entries) {
+    std::vector<uint64_t> counts;
+    e->lat.add_to(&counts);
+    e->lat.add_to(&all);
+    if (mix.entries.size() > 1) {
+      print_latency(std::to_string(e->len) + "B", counts);
+    }
+  }
+  print_latency("all", all);
 
   return 0;
 }
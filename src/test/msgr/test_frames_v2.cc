@@ -147,6 +147,19 @@ static bufferlist make_bufferlist(size_t len, char c) {
   return bl;
 }
 
+// same length as make_bufferlist(), but in many buffers of mixed sizes
+static bufferlist make_fragmented_bufferlist(size_t len) {
+  static const size_t frag_lens[] = {1, 15, 100, 2000, 37, 16, 4096};
+  bufferlist bl;
+  for (size_t i = 0; bl.length() < len; i++) {
+    size_t frag_len = std::min(frag_lens[i % std::size(frag_lens)],
+                               len - bl.length());
+    bl.append(buffer::copy(std::string(frag_len, 'a' + i % 26).data(),
+                           frag_len));
+  }
+  return bl;
+}
+
 bool disassemble_frame(FrameAssembler& frame_asm, bufferlist& frame_bl,
                        Tag& tag, segment_bls_t& segment_bls) {
   bufferlist preamble_bl;
@@ -233,7 +246,11 @@ protected:
   }
 
   void test_round_trip() {
-    auto tx_frame = TestFrame::Encode(m_header, m_front, m_middle, m_data);
+    test_round_trip(m_data);
+  }
+
+  void test_round_trip(const bufferlist& data) {
+    auto tx_frame = TestFrame::Encode(m_header, m_front, m_middle, data);
     auto onwire_bl = tx_frame.get_buffer(m_tx_frame_asm);
     check_frame_assembler(m_tx_frame_asm);
     EXPECT_EQ(m_tx_frame_asm.get_frame_onwire_len(), onwire_bl.length());
@@ -251,7 +268,7 @@ protected:
     EXPECT_TRUE(m_header.contents_equal(rx_frame.header()));
     EXPECT_TRUE(m_front.contents_equal(rx_frame.front()));
     EXPECT_TRUE(m_middle.contents_equal(rx_frame.middle()));
-    EXPECT_TRUE(m_data.contents_equal(rx_frame.data()));
+    EXPECT_TRUE(data.contents_equal(rx_frame.data()));
   }
 
   ceph::crypto::onwire::rxtx_t m_tx_crypto;
@@ -279,6 +296,10 @@ TEST_P(RoundTripTest, Reuse) {
   }
 }
 
+TEST_P(RoundTripTest, Fragmented) {
+  test_round_trip(make_fragmented_bufferlist(m_data.length()));
+}
+
 static const round_trip_instance_t round_trip_instances[] = {
   // first segment is empty
   { 0,   0,   0,   0, 1, {{32,  0,  17,   0,   0,  0},
@@ -436,6 +457,19 @@ TEST_P(RoundTripPerfTest, DISABLED_Basic) {
   }
 }
 
+TEST_P(RoundTripPerfTest, DISABLED_Fragmented) {
+  auto data = make_fragmented_bufferlist(m_data.length());
+  for (int i = 0; i < 100000; i++) {
+    auto tx_frame = TestFrame::Encode(m_header, m_front, m_middle, data);
+    auto onwire_bl = tx_frame.get_buffer(m_tx_frame_asm);
+
+    Tag rx_tag;
+    segment_bls_t rx_segment_bls;
+    ASSERT_TRUE(disassemble_frame(m_rx_frame_asm, onwire_bl, rx_tag,
+                                  rx_segment_bls));
+  }
+}
+
 static const round_trip_instance_t round_trip_perf_instances[] = {
   {41, 250, 0,       0, 2, {{32, 41, 250, 17,       0,  0},
                             {32, 48, 256, 32,       0,  0},
@@ -1062,6 +1062,78 @@ TEST_P(MessengerTest, SimpleMsgr2Test) {
   server_msgr->wait();
 }
 
+TEST_P(MessengerTest, RxBufferTest) {
+  FakeDispatcher cli_dispatcher(false), srv_dispatcher(false);
+  ConnectionRef srv_conn;
+  srv_dispatcher.last_accept_con_ptr = &srv_conn;
+  entity_addr_t legacy_addr;
+  legacy_addr.parse("v1:127.0.0.1");
+  entity_addr_t msgr2_addr;
+  msgr2_addr.parse("v2:127.0.0.1");
+  entity_addrvec_t bind_addrs;
+  bind_addrs.v.push_back(legacy_addr);
+  bind_addrs.v.push_back(msgr2_addr);
+  server_msgr->bindv(bind_addrs);
+  server_msgr->add_dispatcher_head(&srv_dispatcher);
+  server_msgr->start();
+
+  client_msgr->add_dispatcher_head(&cli_dispatcher);
+  client_msgr->start();
+
+  auto send_to_client = [&](ceph_tid_t tid, char c) {
+    bufferlist data;
+    data.append(std::string(4096, c));
+    MPing *m = new MPing();
+    m->set_tid(tid);
+    m->set_data(data);
+    ASSERT_EQ(srv_conn->send_message(m), 0);
+    std::unique_lock l{cli_dispatcher.lock};
+    cli_dispatcher.cond.wait(l, [&] { return cli_dispatcher.got_new; });
+    cli_dispatcher.got_new = false;
+  };
+
+  for (auto& addr : {server_msgr->get_myaddrs().legacy_addr(),
+		     server_msgr->get_myaddrs().msgr2_addr()}) {
+    ConnectionRef conn = client_msgr->connect_to(server_msgr->get_mytype(),
+						 entity_addrvec_t(addr));
+    {
+      ASSERT_EQ(conn->send_message(new MPing()), 0);
+      std::unique_lock l{srv_dispatcher.lock};
+      srv_dispatcher.cond.wait(l, [&] { return srv_dispatcher.got_new; });
+      srv_dispatcher.got_new = false;
+    }
+    ASSERT_TRUE(srv_conn);
+
+    // 1. the data of a message with a posted tid is read into the buffer
+    char buf[4096];
+    memset(buf, 0, sizeof(buf));
+    bufferlist rx;
+    rx.push_back(buffer::create_static(sizeof(buf), buf));
+    conn->post_rx_buffer(1234, rx);
+    send_to_client(1234, 'x');
+    ASSERT_EQ(std::string(sizeof(buf), 'x'), std::string(buf, sizeof(buf)));
+
+    // 2. each posting is used once
+    send_to_client(1234, 'y');
+    ASSERT_EQ(std::string(sizeof(buf), 'x'), std::string(buf, sizeof(buf)));
+
+    // 3. a revoked buffer is not written to
+    conn->post_rx_buffer(1235, rx);
+    conn->revoke_rx_buffer(1235);
+    send_to_client(1235, 'z');
+    ASSERT_EQ(std::string(sizeof(buf), 'x'), std::string(buf, sizeof(buf)));
+
+    conn->mark_down();
+    srv_conn->mark_down();
+    srv_conn.reset();
+  }
+
+  client_msgr->shutdown();
+  client_msgr->wait();
+  server_msgr->shutdown();
+  server_msgr->wait();
+}
+
 TEST_P(MessengerTest, FeatureTest) {
   FakeDispatcher cli_dispatcher(false), srv_dispatcher(true);
   entity_addr_t bind_addr;
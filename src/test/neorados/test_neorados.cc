@@ -34,6 +34,34 @@ TEST_F(TestNeoRADOS, MakeWithLibRADOS) {
     boost::system::system_error);
 }
 
+TEST_F(TestNeoRADOS, ExecuteBatch) {
+  librados::Rados paleo_rados;
+  auto result = connect_cluster_pp(paleo_rados);
+  ASSERT_EQ("", result);
+
+  auto rados = RADOS::make_with_librados(paleo_rados);
+
+  std::vector<bufferlist> bls(8);
+  std::vector<RADOS::BatchOp> ops;
+  for (auto& bl : bls) {
+    ReadOp op;
+    op.read(0, 0, nullptr);
+    ops.push_back({"dummy-obj", std::move(op), &bl});
+  }
+
+  // pool doesn't exist; every op fails and the batch reports the first
+  boost::system::error_code ec;
+  auto results = rados.execute_batch(
+    IOContext(std::numeric_limits<int64_t>::max(), std::string{}),
+    std::move(ops),
+    ceph::async::use_blocked[ec], 3);
+  ASSERT_TRUE(ec);
+  ASSERT_EQ(bls.size(), results.size());
+  for (auto& r : results) {
+    ASSERT_EQ(ec, r);
+  }
+}
+
 } // namespace neorados
 
 int main(int argc, char **argv) {
@@ -457,6 +457,55 @@ TEST_P(AllocTest, test_bonus_empty_fragmented)
   std::cout << "    empty storage frag.score=" << frag_score << std::endl;
 }
 
+// Many objects growing by interleaved appends, as RGW multipart uploads
+// do. Count the physical extents each object ends up with, once letting the
+// allocator place every chunk freely and once hinting the end of the
+// object's previous chunk.
+TEST_P(AllocTest, test_interleaved_appends_hint)
+{
+  uint64_t capacity = uint64_t(64) * 1024 * 1024 * 1024;
+  uint64_t alloc_unit = 64 * 1024;
+  const unsigned objects = 64;
+  const unsigned chunks = 256;
+  std::string allocator_name = GetParam();
+  std::cout << "Allocator: " << allocator_name << std::endl;
+
+  uint64_t extents[2] = {0, 0};
+  for (int use_hint = 0; use_hint < 2; ++use_hint) {
+    init_alloc(allocator_name, capacity, alloc_unit);
+    alloc->init_add_free(0, capacity);
+    std::vector<PExtentVector> objs(objects);
+    for (unsigned c = 0; c < chunks; ++c) {
+      for (auto& o : objs) {
+	int64_t hint = 0;
+	if (use_hint && !o.empty()) {
+	  hint = o.back().end();
+	}
+	PExtentVector tmp;
+	ASSERT_EQ((int64_t)alloc_unit,
+		  alloc->allocate(alloc_unit, alloc_unit, 0, hint, &tmp));
+	for (auto& e : tmp) {
+	  if (!o.empty() && o.back().end() == e.offset) {
+	    o.back().length += e.length;
+	  } else {
+	    o.push_back(e);
+	  }
+	}
+      }
+    }
+    for (auto& o : objs) {
+      extents[use_hint] += o.size();
+    }
+    init_close();
+  }
+  std::cout << "    extents per object: " << (double)extents[0] / objects
+	    << " without hint, " << (double)extents[1] / objects
+	    << " with hint" << std::endl;
+  if (allocator_name == "avl") {
+    ASSERT_LT(extents[1], extents[0]);
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
   Allocator,
   AllocTest,
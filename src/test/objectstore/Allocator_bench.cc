@@ -5,6 +5,7 @@
  * Author: Igor Fedotov, ifedotov@suse.com
  */
 #include <iostream>
+#include <thread>
 #include <boost/scoped_ptr.hpp>
 #include <gtest/gtest.h>
 
@@ -13,6 +14,7 @@
 #include "include/stringify.h"
 #include "include/Context.h"
 #include "os/bluestore/Allocator.h"
+#include "os/bluestore/MagazineAllocator.h"
 
 #include <boost/random/uniform_int.hpp>
 typedef boost::mt11213b gen_type;
@@ -328,6 +330,67 @@ TEST_P(AllocTest, test_alloc_bench_10_300)
   doOverwriteTest(capacity, prefill, overwrite);
 }
 
+// Concurrent small allocations and releases, as issued by kv_sync and
+// finisher threads, with and without the per-CPU extent caches in front.
+static double run_alloc_bench_mt(Allocator* alloc, unsigned num_threads,
+				 uint64_t ops, uint64_t alloc_unit)
+{
+  std::vector<std::thread> threads;
+  utime_t start = ceph_clock_now();
+  for (unsigned t = 0; t < num_threads; ++t) {
+    threads.emplace_back([=] {
+      gen_type rng(t);
+      boost::uniform_int<> u(1, 4);
+      std::vector<PExtentVector> held(64);
+      for (uint64_t i = 0; i < ops; ++i) {
+	auto& slot = held[i % held.size()];
+	if (!slot.empty()) {
+	  alloc->release(slot);
+	  slot.clear();
+	}
+	uint64_t want = alloc_unit * u(rng);
+	EXPECT_EQ(static_cast<int64_t>(want),
+		  alloc->allocate(want, alloc_unit, 0, 0, &slot));
+      }
+      for (auto& slot : held) {
+	alloc->release(slot);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  return (double)(ceph_clock_now() - start);
+}
+
+TEST_P(AllocTest, test_alloc_bench_mt)
+{
+  uint64_t capacity = uint64_t(1024) * 1024 * 1024 * 1024;
+  uint64_t alloc_unit = 4096;
+  unsigned num_threads = 8;
+  uint64_t ops = 1000000;
+
+  init_alloc(capacity, alloc_unit);
+  alloc->init_add_free(0, capacity);
+  double plain = run_alloc_bench_mt(alloc.get(), num_threads, ops, alloc_unit);
+  EXPECT_EQ(capacity, alloc->get_free());
+  init_close();
+
+  std::unique_ptr<MagazineAllocator> cached(
+    MagazineAllocator::create(g_ceph_context, GetParam(), capacity,
+			      alloc_unit, num_threads, 8, 64));
+  ASSERT_NE(nullptr, cached);
+  cached->init_add_free(0, capacity);
+  double with_cache =
+    run_alloc_bench_mt(cached.get(), num_threads, ops, alloc_unit);
+  EXPECT_EQ(capacity, cached->get_free());
+  cached->shutdown();
+
+  std::cout << num_threads << " threads x " << ops << " ops: "
+	    << plain << "s plain, " << with_cache << "s with per-cpu caches"
+	    << std::endl;
+}
+
 TEST_P(AllocTest, mempoolAccounting)
 {
   uint64_t bytes = mempool::bluestore_alloc::allocated_bytes();
@@ -13,6 +13,7 @@
 #include "include/stringify.h"
 #include "include/Context.h"
 #include "os/bluestore/Allocator.h"
+#include "os/bluestore/MagazineAllocator.h"
 
 using namespace std;
 
@@ -636,3 +637,71 @@ INSTANTIATE_TEST_SUITE_P(
   Allocator,
   AllocTest,
   ::testing::Values("stupid", "bitmap", "avl", "hybrid"));
+
+TEST(MagazineAllocator, cache_and_flush)
+{
+  uint64_t block = 0x1000;
+  uint64_t capacity = block * 1024;
+  std::unique_ptr<MagazineAllocator> alloc(
+    MagazineAllocator::create(g_ceph_context, "avl", capacity, block,
+			      1, 4, 8));
+  ASSERT_NE(nullptr, alloc);
+  alloc->init_add_free(0, capacity);
+  EXPECT_EQ(capacity, alloc->get_free());
+
+  // a miss refills the cache from the backend
+  PExtentVector extents;
+  EXPECT_EQ((int64_t)block, alloc->allocate(block, block, 0, 0, &extents));
+  EXPECT_GT(alloc->get_cached(), 0u);
+  EXPECT_EQ(capacity - block, alloc->get_free());
+
+  // a release is cached and handed out again
+  uint64_t backend_free = alloc->get_backend()->get_free();
+  alloc->release(extents);
+  EXPECT_EQ(backend_free, alloc->get_backend()->get_free());
+  EXPECT_EQ(capacity, alloc->get_free());
+  PExtentVector again;
+  EXPECT_EQ((int64_t)block, alloc->allocate(block, block, 0, 0, &again));
+  EXPECT_EQ(extents[0].offset, again[0].offset);
+  alloc->release(again);
+
+  // cached extents are free space for foreach
+  uint64_t seen = 0;
+  alloc->foreach([&](uint64_t off, uint64_t len) { seen += len; });
+  EXPECT_EQ(capacity, seen);
+
+  // sizes above max_units go straight to the backend
+  extents.clear();
+  EXPECT_EQ((int64_t)block * 16,
+	    alloc->allocate(block * 16, block, 0, 0, &extents));
+  alloc->release(extents);
+
+  alloc->flush();
+  EXPECT_EQ(0u, alloc->get_cached());
+  EXPECT_EQ(capacity, alloc->get_backend()->get_free());
+  alloc->shutdown();
+}
+
+TEST(MagazineAllocator, exhaust)
+{
+  uint64_t block = 0x1000;
+  uint64_t capacity = block * 64;
+  std::unique_ptr<MagazineAllocator> alloc(
+    MagazineAllocator::create(g_ceph_context, "avl", capacity, block,
+			      4, 4, 16));
+  ASSERT_NE(nullptr, alloc);
+  alloc->init_add_free(0, capacity);
+  // every block can be allocated although the caches hold some of them
+  interval_set<uint64_t> allocated;
+  for (uint64_t i = 0; i < capacity / block; ++i) {
+    PExtentVector extents;
+    ASSERT_EQ((int64_t)block, alloc->allocate(block, block, 0, 0, &extents));
+    allocated.insert(extents[0].offset, extents[0].length);
+  }
+  EXPECT_EQ(0u, alloc->get_free());
+  PExtentVector extents;
+  EXPECT_EQ(-ENOSPC, alloc->allocate(block, block, 0, 0, &extents));
+  alloc->release(allocated);
+  EXPECT_EQ(capacity, alloc->get_free());
+  alloc->shutdown();
+}
@@ -135,6 +135,10 @@ class Transaction {
     cerr << " decode op: " << Cycles::to_microseconds(Transaction::decode_ticks.ticks) << "us count: " << Transaction::decode_ticks.count << std::endl;
     cerr << " iterate op: " << Cycles::to_microseconds(Transaction::iterate_ticks.ticks) << "us count: " << Transaction::iterate_ticks.count << std::endl;
   }
+  static void reset_stat() {
+    write_ticks = setattr_ticks = omap_setkeys_ticks = omap_rmkey_ticks = Tick();
+    encode_ticks = decode_ticks = iterate_ticks = Tick();
+  }
 };
 
 class PerfCase {
@@ -187,7 +191,10 @@ class PerfCase {
     data[info_info_attr] = generate_random(560, 1);
   }
 
-  uint64_t rados_write_4k(int times) {
+  // with wire=false the transactions are consumed where they are built,
+  // like those a primary applies locally; with wire=true they also take
+  // the encode/decode round trip of a replica's transactions
+  uint64_t rados_write_4k(int times, bool wire) {
     uint64_t ticks = 0;
     uint64_t len = Kib *4;
     for (int i = 0; i < times; i++) {
@@ -199,7 +206,8 @@ class PerfCase {
         t.write(cid, oid, 0, len, data["4k"]);
         t.setattr(cid, oid, attr, data[attr]);
         t.setattr(cid, oid, snapset_attr, data[snapset_attr]);
-        t.apply_encode_decode();
+        if (wire)
+          t.apply_encode_decode();
         t.apply_iterate();
         ticks += Cycles::rdtsc() - start_time;
       }
@@ -214,7 +222,8 @@ class PerfCase {
         t.omap_setkeys(meta_cid, pglog_oid, pglog_attrset);
         t.omap_setkeys(meta_cid, info_oid, info_attrset);
         t.omap_rmkey(meta_cid, pglog_oid, pglog_attr);
-        t.apply_encode_decode();
+        if (wire)
+          t.apply_encode_decode();
         t.apply_iterate();
         ticks += Cycles::rdtsc() - start_time;
       }
@@ -235,7 +244,7 @@ Transaction::Tick Transaction::write_ticks, Transaction::setattr_ticks, Transact
 Transaction::Tick Transaction::encode_ticks, Transaction::decode_ticks, Transaction::iterate_ticks;
 
 void usage(const string &name) {
-  cerr << "Usage: " << name << " [times] "
+  cerr << "Usage: " << name << " [times] [wire|local|compare]"
        << std::endl;
 }
 
@@ -257,10 +266,21 @@ int main(int argc, char **argv)
   }
 
   uint64_t times = atoi(args[0]);
+  string mode = args.size() > 1 ? args[1] : "wire";
+  if (mode != "wire" && mode != "local" && mode != "compare") {
+    usage(argv[0]);
+    return 1;
+  }
   PerfCase c;
-  uint64_t ticks = c.rados_write_4k(times);
-  Transaction::dump_stat();
-  cerr << " Total rados op " << times << " run time " << Cycles::to_microseconds(ticks) << "us." << std::endl;
+  for (bool wire : {true, false}) {
+    if ((wire && mode == "local") || (!wire && mode == "wire"))
+      continue;
+    Transaction::reset_stat();
+    uint64_t ticks = c.rados_write_4k(times, wire);
+    cerr << (wire ? "wire" : "local") << ":" << std::endl;
+    Transaction::dump_stat();
+    cerr << " Total rados op " << times << " run time " << Cycles::to_microseconds(ticks) << "us." << std::endl;
+  }
 
   return 0;
 }
@@ -229,3 +229,33 @@ TEST(HybridAllocator, fragmentation)
     ASSERT_EQ(0.5 * 7 / 8 + 1.0 / 8, ha.get_fragmentation());
   }
 }
+
+TEST(HybridAllocator, adjacent_hint)
+{
+  uint64_t block = 0x1000;
+  uint64_t capacity = 0x10000000;
+  TestHybridAllocator ha(g_ceph_context, capacity, block,
+    4 * sizeof(range_seg_t), "test_hybrid_allocator");
+  auto alloc = &ha;
+  alloc->init_add_free(0, 0x10000);
+  alloc->init_add_free(0x100000, 0x100000);
+
+  // the space right at the hint is taken first
+  PExtentVector extents;
+  EXPECT_EQ(0x4000, alloc->allocate(0x4000, block, 0, 0x102000, &extents));
+  ASSERT_EQ(1u, extents.size());
+  EXPECT_EQ(0x102000u, extents[0].offset);
+
+  // partially free at the hint: take what is there, then look elsewhere
+  extents.clear();
+  EXPECT_EQ(0x4000, alloc->allocate(0x4000, block, 0, 0x1fe000, &extents));
+  ASSERT_EQ(2u, extents.size());
+  EXPECT_EQ(0x1fe000u, extents[0].offset);
+  EXPECT_EQ(0x2000u, extents[0].length);
+
+  // hint into allocated space is ignored
+  extents.clear();
+  EXPECT_EQ(0x1000, alloc->allocate(0x1000, block, 0, 0x102000, &extents));
+  ASSERT_EQ(1u, extents.size());
+  EXPECT_NE(0x102000u, extents[0].offset);
+}
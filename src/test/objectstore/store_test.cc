@@ -2367,6 +2367,125 @@ TEST_P(StoreTest, ManySmallWrite) {
   }
 }
 
+TEST_P(StoreTest, ReadAsync) {
+  int r;
+  coll_t cid;
+  ghobject_t a(hobject_t(sobject_t("Object 1", CEPH_NOSNAP)));
+  ghobject_t missing(hobject_t(sobject_t("Object 2", CEPH_NOSNAP)));
+  auto ch = store->create_new_collection(cid);
+  bufferlist bl;
+  for (int i = 0; i < 64; ++i) {
+    bl.append(string(4096, 'a' + i % 26));
+  }
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    t.write(cid, a, 0, bl.length(), bl);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  // drop the caches so that the read has to go to the device
+  ch.reset();
+  r = store->umount();
+  ASSERT_EQ(0, r);
+  r = store->mount();
+  ASSERT_EQ(0, r);
+  ch = store->open_collection(cid);
+  {
+    bufferlist out;
+    C_SaferCond c;
+    store->read_async(ch, a, 4096, 8 * 4096, &out, &c);
+    ASSERT_EQ(8 * 4096, c.wait());
+    bufferlist expected;
+    expected.substr_of(bl, 4096, 8 * 4096);
+    ASSERT_TRUE(bl_eq(expected, out));
+  }
+  {
+    bufferlist out;
+    C_SaferCond c;
+    store->read_async(ch, a, 0, 0, &out, &c);
+    ASSERT_EQ((int)bl.length(), c.wait());
+    ASSERT_TRUE(bl_eq(bl, out));
+  }
+  {
+    bufferlist out;
+    C_SaferCond c;
+    store->read_async(ch, a, bl.length(), 4096, &out, &c);
+    ASSERT_EQ(0, c.wait());
+    ASSERT_EQ(0u, out.length());
+  }
+  {
+    bufferlist out;
+    C_SaferCond c;
+    store->read_async(ch, missing, 0, 4096, &out, &c);
+    ASSERT_EQ(-ENOENT, c.wait());
+  }
+  {
+    ObjectStore::Transaction t;
+    t.remove(cid, a);
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+}
+
+TEST_P(StoreTest, ReadDigest) {
+  int r;
+  coll_t cid;
+  ghobject_t a(hobject_t(sobject_t("Object 1", CEPH_NOSNAP)));
+  ghobject_t missing(hobject_t(sobject_t("Object 2", CEPH_NOSNAP)));
+  auto ch = store->create_new_collection(cid);
+  bufferlist bl, tail;
+  for (int i = 0; i < 16; ++i) {
+    bl.append(string(4096, 'a' + i % 26));
+  }
+  tail.append(string(1000, 'z'));
+  {
+    // data, a hole, then a partial block
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    t.write(cid, a, 0, bl.length(), bl);
+    t.write(cid, a, 128 * 1024, tail.length(), tail);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  auto check = [&](uint64_t off, uint64_t len) {
+    bufferlist out;
+    int expected = store->read(ch, a, off, len, out);
+    uint32_t crc = 0x1234;
+    ASSERT_EQ(expected, store->read_digest(ch, a, off, len, &crc));
+    ASSERT_EQ(out.crc32c(0x1234), crc);
+  };
+  for (int pass = 0; pass < 2; ++pass) {
+    check(0, 0);
+    check(0, 4096);
+    check(4096, 8 * 4096);
+    check(100, 10000);
+    check(60 * 1024, 80 * 1024);
+    check(128 * 1024 + 10, 4096);
+    {
+      uint32_t crc = 0;
+      ASSERT_EQ(0, store->read_digest(ch, a, 256 * 1024, 4096, &crc));
+      ASSERT_EQ(0u, crc);
+      ASSERT_EQ(-ENOENT, store->read_digest(ch, missing, 0, 4096, &crc));
+    }
+    // drop the caches so that the reads have to go to the device
+    ch.reset();
+    r = store->umount();
+    ASSERT_EQ(0, r);
+    r = store->mount();
+    ASSERT_EQ(0, r);
+    ch = store->open_collection(cid);
+  }
+  {
+    ObjectStore::Transaction t;
+    t.remove(cid, a);
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+}
+
 TEST_P(StoreTest, MultiSmallWriteSameBlock) {
   int r;
   coll_t cid;
@@ -9150,6 +9269,63 @@ namespace {
   }
 }
 
+TEST_P(StoreTestSpecificAUSize, AllocationCheckpointReplay) {
+  if (string(GetParam()) != "bluestore")
+    return;
+  if (smr) {
+    cout << "SKIP: no allocation file with smr" << std::endl;
+    return;
+  }
+  SetVal(g_conf(), "bluestore_allocation_checkpoint_interval", "1");
+  SetVal(g_conf(), "bluestore_debug_inject_allocation_from_file_failure", "0");
+  StartDeferred(0x10000);
+
+  int r;
+  coll_t cid;
+  auto ch = store->create_new_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  auto write_objects = [&](size_t from, size_t to, char c) {
+    bufferlist bl;
+    bl.append(string(0x30000, c));
+    for (size_t i = from; i < to; ++i) {
+      ObjectStore::Transaction t;
+      t.write(cid, make_object(stringify(i).c_str(), 0), 0, bl.length(), bl);
+      ASSERT_EQ(queue_transaction(store, ch, std::move(t)), 0);
+    }
+  };
+  write_objects(0, 64, 'a');
+  sleep(3); // let a checkpoint be taken
+  write_objects(64, 128, 'b');
+  {
+    ObjectStore::Transaction t;
+    for (size_t i = 0; i < 32; ++i) {
+      t.remove(cid, make_object(stringify(i).c_str(), 0));
+    }
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  ch.reset();
+
+  // pretend the allocation file is gone, mount from checkpoint + journal
+  SetVal(g_conf(), "bluestore_debug_inject_allocation_from_file_failure", "1");
+  store->umount();
+  ASSERT_EQ(store->mount(), 0);
+  ch = store->open_collection(cid);
+  // reused space must not have been referenced
+  write_objects(128, 256, 'c');
+  ch.reset();
+  store->umount();
+
+  SetVal(g_conf(), "bluestore_debug_inject_allocation_from_file_failure", "0");
+  ASSERT_EQ(store->fsck(true), 0);
+  store->mount();
+}
+
 TEST_P(StoreTestSpecificAUSize, BluestoreRepairTest) {
   if (string(GetParam()) != "bluestore")
     return;
@@ -10860,6 +11036,74 @@ TEST_P(StoreTestOmapUpgrade, LargeLegacyToPG) {
   }
 }
 
+TEST_P(StoreTestOmapUpgrade, OnlineConversion) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  SetVal(g_conf(), "bluestore_debug_legacy_omap", "true");
+  g_conf().apply_changes(nullptr);
+
+  StartDeferred();
+  int64_t poolid = 11;
+  coll_t cid(spg_t(pg_t(1, poolid), shard_id_t::NO_SHARD));
+  auto ch = store->create_new_collection(cid);
+  int r;
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  size_t object_count = 200;
+  make_omap_data(object_count, poolid, cid);
+  check_omap_data(object_count, poolid, cid);
+
+  store->umount();
+  SetVal(g_conf(), "bluestore_debug_legacy_omap", "false");
+  SetVal(g_conf(), "bluestore_fsck_error_on_no_per_pool_omap", "true");
+  g_conf().apply_changes(nullptr);
+  ASSERT_EQ(store->fsck(false), (int)object_count + 1);
+
+  SetVal(g_conf(), "bluestore_omap_online_conversion", "true");
+  SetVal(g_conf(), "bluestore_omap_online_conversion_bytes_per_sec", "64K");
+  g_conf().apply_changes(nullptr);
+  store->mount();
+  ch = store->open_collection(cid);
+
+  // the store keeps serving omap while converting
+  check_omap_data(object_count, poolid, cid);
+
+  store_statfs_t statfs;
+  bool per_pool_omap = false;
+  for (int i = 0; i < 600 && !per_pool_omap; ++i) {
+    usleep(100000);
+    r = store->pool_statfs(poolid, &statfs, &per_pool_omap);
+    ASSERT_EQ(r, 0);
+  }
+  ASSERT_TRUE(per_pool_omap);
+  check_omap_data(object_count, poolid, cid);
+
+  store->umount();
+  ASSERT_EQ(store->fsck(false), 0);
+  SetVal(g_conf(), "bluestore_omap_online_conversion", "false");
+  SetVal(g_conf(), "bluestore_omap_online_conversion_bytes_per_sec", "64M");
+  g_conf().apply_changes(nullptr);
+  store->mount();
+  ch = store->open_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    for (size_t o = 0; o < object_count; o++)
+    {
+      std::string oid = generate_monotonic_name(object_count, o, 3.71, 0.5);
+      ghobject_t hoid(hobject_t(oid, "", CEPH_NOSNAP, 0, poolid, ""));
+      t.remove(cid, hoid);
+    }
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+}
+
 #endif  // WITH_BLUESTORE
 
 int main(int argc, char **argv) {
@@ -91,6 +91,50 @@ TEST(KernelDevice, Ticket45337) {
   b->close();
 }
 
+TEST(KernelDevice, WriteZeroesCopyRange) {
+  uint64_t size = 1048576ull * 16;
+  TempBdev bdev{ size };
+
+  std::unique_ptr<BlockDevice> b(
+    BlockDevice::create(g_ceph_context, bdev.path, NULL, NULL,
+      [](void* handle, void* aio) {}, NULL));
+  ASSERT_EQ(b->open(bdev.path), 0);
+
+  const uint64_t len = 0x10000;
+  bufferlist bl;
+  bl.append(string(len, 'x'));
+  ASSERT_EQ(b->write(0, bl, false), 0);
+  ASSERT_EQ(b->write(len, bl, false), 0);
+
+  char outbuf[len];
+  int r = b->write_zeroes(0x1000, 0x2000);
+  if (r == -EOPNOTSUPP) {
+    std::cout << "write_zeroes not supported here, skipping" << std::endl;
+  } else {
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(b->flush(), 0);
+    ASSERT_EQ(b->read_random(0, len, outbuf, false), 0);
+    ASSERT_EQ(string(outbuf, 0x1000), string(0x1000, 'x'));
+    ASSERT_EQ(string(outbuf + 0x1000, 0x2000), string(0x2000, '\0'));
+    ASSERT_EQ(string(outbuf + 0x3000, len - 0x3000), string(len - 0x3000, 'x'));
+  }
+
+  bufferlist src;
+  src.append(string(len, 'y'));
+  ASSERT_EQ(b->write(len * 2, src, false), 0);
+  r = b->copy_range(len * 2, len, len);
+  if (r == -EOPNOTSUPP) {
+    std::cout << "copy_range not supported here, skipping" << std::endl;
+  } else {
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(b->flush(), 0);
+    ASSERT_EQ(b->read_random(len, len, outbuf, false), 0);
+    ASSERT_EQ(string(outbuf, len), string(len, 'y'));
+  }
+
+  b->close();
+}
+
 int main(int argc, char **argv) {
   auto args = argv_to_vec(argc, argv);
   map<string,string> defaults = {
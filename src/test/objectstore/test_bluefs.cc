@@ -141,6 +141,54 @@ TEST(BlueFS, write_read) {
   fs.umount();
 }
 
+TEST(BlueFS, read_random_vec) {
+  uint64_t size = 1048576 * 128;
+  TempBdev bdev{size};
+  ConfSaver conf(g_ceph_context->_conf);
+  conf.SetVal("bluefs_buffered_io", "false");
+  conf.SetVal("bluefs_alloc_size", "65536");
+  conf.ApplyChanges();
+
+  BlueFS fs(g_ceph_context);
+  ASSERT_EQ(0, fs.add_block_device(BlueFS::BDEV_DB, bdev.path, false, 1048576));
+  uuid_d fsid;
+  ASSERT_EQ(0, fs.mkfs(fsid, { BlueFS::BDEV_DB, false, false }));
+  ASSERT_EQ(0, fs.mount());
+  ASSERT_EQ(0, fs.mkdir("dir"));
+  const size_t len = 1048576;
+  std::unique_ptr<char[]> data = gen_buffer(len);
+  {
+    BlueFS::FileWriter *h;
+    ASSERT_EQ(0, fs.open_for_write("dir", "file", &h, false));
+    h->append(data.get(), len);
+    fs.fsync(h);
+    fs.close_writer(h);
+  }
+  {
+    BlueFS::FileReader *h;
+    ASSERT_EQ(0, fs.open_for_read("dir", "file", &h, true));
+    // unaligned, crossing extents, and running past eof
+    std::vector<std::pair<uint64_t, uint64_t>> ranges = {
+      {0, 4096}, {123, 4567}, {65536 - 100, 200}, {300000, 200000},
+      {len - 10, 100}};
+    std::vector<std::unique_ptr<char[]>> bufs;
+    std::vector<BlueFS::read_request_t> reqs;
+    for (auto& [off, l] : ranges) {
+      bufs.emplace_back(new char[l]);
+      reqs.push_back({off, l, bufs.back().get()});
+    }
+    ASSERT_EQ(0, fs.read_random_vec(h, reqs));
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      auto [off, l] = ranges[i];
+      uint64_t expect = std::min(l, len - off);
+      ASSERT_EQ((int64_t)expect, reqs[i].result);
+      ASSERT_EQ(0, memcmp(bufs[i].get(), data.get() + off, expect));
+    }
+    delete h;
+  }
+  fs.umount();
+}
+
 TEST(BlueFS, small_appends) {
   uint64_t size = 1048576 * 128;
   TempBdev bdev{size};
@@ -817,6 +865,60 @@ TEST(BlueFS, test_replay_growth) {
   fs.umount();
 }
 
+TEST(BlueFS, test_compaction_background) {
+  uint64_t size = 1048576LL * (2 * 1024 + 128);
+  TempBdev bdev{size};
+
+  ConfSaver conf(g_ceph_context->_conf);
+  conf.SetVal("bluefs_alloc_size", "4096");
+  conf.SetVal("bluefs_shared_alloc_size", "4096");
+  conf.SetVal("bluefs_compact_log_sync", "false");
+  conf.SetVal("bluefs_compact_log_background", "true");
+  conf.SetVal("bluefs_log_compact_min_size", "65536");
+  conf.SetVal("bluefs_log_compact_min_ratio", "2");
+  conf.SetVal("bluefs_min_log_runway", "32768");
+  conf.SetVal("bluefs_max_log_runway", "65536");
+  conf.SetVal("bluefs_allocator", "stupid");
+  conf.ApplyChanges();
+
+  BlueFS fs(g_ceph_context);
+  ASSERT_EQ(0, fs.add_block_device(BlueFS::BDEV_DB, bdev.path, false, 1048576));
+  uuid_d fsid;
+  ASSERT_EQ(0, fs.mkfs(fsid, { BlueFS::BDEV_DB, false, false }));
+  ASSERT_EQ(0, fs.mount());
+  ASSERT_EQ(0, fs.mkdir("dir"));
+
+  char data[2000];
+  memset(data, 0x5a, sizeof(data));
+  for (int i = 0; i < 100; i++) {
+    BlueFS::FileWriter *h;
+    ASSERT_EQ(0, fs.open_for_write("dir", "file." + to_string(i), &h, false));
+    for (int j = 0; j < 20; j++) {
+      h->append(data, sizeof(data));
+      fs.fsync(h);
+    }
+    fs.close_writer(h);
+  }
+  // compactions run on the background thread, give it time to finish one
+  for (int i = 0; i < 100; i++) {
+    if (fs.get_perf_counters()->get(l_bluefs_log_compactions) > 0) {
+      break;
+    }
+    usleep(100000);
+  }
+  ASSERT_GT(fs.get_perf_counters()->get(l_bluefs_log_compactions), 0u);
+  fs.umount(true);
+
+  ASSERT_EQ(0, fs.mount());
+  for (int i = 0; i < 100; i++) {
+    uint64_t file_size;
+    utime_t mtime;
+    ASSERT_EQ(0, fs.stat("dir", "file." + to_string(i), &file_size, &mtime));
+    ASSERT_EQ(20 * sizeof(data), file_size);
+  }
+  fs.umount();
+}
+
 TEST(BlueFS, test_tracker_50965) {
   uint64_t size_wal = 1048576 * 64;
   TempBdev bdev_wal{size_wal};
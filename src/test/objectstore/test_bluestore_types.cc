@@ -9,6 +9,7 @@
 #include "os/bluestore/BlueStore.h"
 #include "os/bluestore/simple_bitmap.h"
 #include "os/bluestore/AvlAllocator.h"
+#include "os/bluestore/DeferredSizeTuner.h"
 #include "common/ceph_argparse.h"
 #include "global/global_init.h"
 #include "global/global_context.h"
@@ -397,6 +398,36 @@ TEST(bluestore_blob_t, calc_csum)
   }
 }
 
+TEST(bluestore_blob_t, calc_csum_fragmented)
+{
+  // blocks that straddle buffers must hash the same as contiguous ones
+  bufferlist bl;
+  bl.append(std::string(4096 * 4, 'a'));
+  bl.rebuild();
+  bufferlist frag;
+  frag.append(std::string(4096 + 100, 'a'));
+  frag.append(std::string(4096 * 2 - 200, 'a'));
+  frag.append(std::string(4096 + 100, 'a'));
+
+  for (unsigned csum_type = Checksummer::CSUM_NONE + 1;
+       csum_type < Checksummer::CSUM_MAX;
+       ++csum_type) {
+    bluestore_blob_t a, b;
+    a.init_csum(csum_type, 12, bl.length());
+    b.init_csum(csum_type, 12, frag.length());
+    a.calc_csum(0, bl);
+    b.calc_csum(0, frag);
+    ASSERT_EQ(a.csum_data.length(), b.csum_data.length());
+    ASSERT_EQ(0, memcmp(a.csum_data.c_str(), b.csum_data.c_str(),
+			a.csum_data.length()))
+      << Checksummer::get_csum_type_string(csum_type);
+    int bad_off;
+    uint64_t bad_csum;
+    ASSERT_EQ(0, a.verify_csum(0, frag, &bad_off, &bad_csum));
+    ASSERT_EQ(-1, bad_off);
+  }
+}
+
 TEST(bluestore_blob_t, csum_bench)
 {
   bufferlist bl;
@@ -2335,6 +2366,43 @@ TEST(bluestore_blob_use_tracker_t, mempool_stats_test)
   }
 }
 
+TEST(DeferredSizeTuner, adjust)
+{
+  DeferredSizeTuner t;
+  // out of bounds threshold is clamped first
+  ASSERT_EQ(4096u, t.adjust(1024, 4096, 65536, 10));
+  // writes far from the threshold are ignored
+  for (int i = 0; i < 100; ++i) {
+    t.note(16384, 512, true, 10);
+    t.note(16384, 1048576, false, 10000);
+  }
+  ASSERT_EQ(16384u, t.adjust(16384, 4096, 65536, 10));
+  // too few samples, threshold stays and samples are kept
+  for (int i = 0; i < 5; ++i) {
+    t.note(16384, 12288, true, 100);
+    t.note(16384, 20480, false, 1000);
+  }
+  ASSERT_EQ(16384u, t.adjust(16384, 4096, 65536, 10));
+  for (int i = 0; i < 5; ++i) {
+    t.note(16384, 12288, true, 100);
+    t.note(16384, 20480, false, 1000);
+  }
+  // direct writes are slower: defer more
+  ASSERT_EQ(32768u, t.adjust(16384, 4096, 65536, 10));
+  for (int i = 0; i < 10; ++i) {
+    t.note(65536, 65536, true, 1000);
+    t.note(65536, 65536, false, 1000);
+  }
+  // equal latency: stay put
+  ASSERT_EQ(65536u, t.adjust(65536, 4096, 65536, 10));
+  for (int i = 0; i < 10; ++i) {
+    t.note(65536, 49152, true, 5000);
+    t.note(65536, 81920, false, 100);
+  }
+  // deferred writes are slower: write directly
+  ASSERT_EQ(32768u, t.adjust(65536, 4096, 65536, 10));
+}
+
 int main(int argc, char **argv) {
   auto args = argv_to_vec(argc, argv);
   auto cct = global_init(NULL, args, CEPH_ENTITY_TYPE_CLIENT,
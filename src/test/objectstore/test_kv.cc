@@ -187,7 +187,7 @@ TEST_P(KVTest, BenchCommit) {
   data.append(bp);
   for (int i=0; i<n; ++i) {
     KeyValueDB::Transaction t = db->get_transaction();
-    t->set("prefix", "key" + stringify(i), data);
+    t->set("prefix", "key" + std::to_string(i), data);
     db->submit_transaction_sync(t);
   }
   utime_t end = ceph_clock_now();
@@ -405,6 +405,90 @@ TEST_P(KVTest, RocksDBColumnFamilyTest) {
   fini();
 }
 
+TEST_P(KVTest, RocksDBNoWALColumnFamily) {
+  if(string(GetParam()) != "rocksdb")
+    return;
+
+  std::string cfs("cf1 nowal(3)=wal=false");
+  ASSERT_EQ(0, db->init(g_conf()->bluestore_rocksdb_options));
+  ASSERT_EQ(0, db->create_and_open(cout, cfs));
+  {
+    KeyValueDB::Transaction t = db->get_transaction();
+    bufferlist value;
+    value.append("value");
+    t->set("prefix", "key", value);
+    t->set("cf1", "key", value);
+    for (int i = 0; i < 10; i++) {
+      t->set("nowal", "key" + std::to_string(i), value);
+    }
+    t->rmkey("nowal", "key9");
+    ASSERT_EQ(0, db->submit_transaction_sync(t));
+  }
+  {
+    bufferlist v;
+    ASSERT_EQ(0, db->get("nowal", "key0", &v));
+    ASSERT_EQ("value", _bl_to_str(v));
+    ASSERT_EQ(-ENOENT, db->get("nowal", "key9", &v));
+  }
+  // a clean close flushes the no-wal columns
+  fini();
+
+  init();
+  ASSERT_EQ(0, db->open(cout, cfs));
+  {
+    bufferlist v1, v2, v3;
+    ASSERT_EQ(0, db->get("prefix", "key", &v1));
+    ASSERT_EQ(0, db->get("cf1", "key", &v2));
+    for (int i = 0; i < 9; i++) {
+      v3.clear();
+      ASSERT_EQ(0, db->get("nowal", "key" + std::to_string(i), &v3));
+      ASSERT_EQ("value", _bl_to_str(v3));
+    }
+    ASSERT_EQ(-ENOENT, db->get("nowal", "key9", &v3));
+  }
+  fini();
+}
+
+TEST_P(KVTest, RocksDBMultiGet) {
+  if(string(GetParam()) != "rocksdb")
+    return;
+
+  std::string cfs("sh(3)");
+  ASSERT_EQ(0, db->init(g_conf()->bluestore_rocksdb_options));
+  ASSERT_EQ(0, db->create_and_open(cout, cfs));
+  {
+    KeyValueDB::Transaction t = db->get_transaction();
+    for (int i = 0; i < 10; i += 2) {
+      bufferlist value;
+      value.append("value" + std::to_string(i));
+      t->set("prefix", "key" + std::to_string(i), value);
+      t->set("sh", "key" + std::to_string(i), value);
+    }
+    ASSERT_EQ(0, db->submit_transaction_sync(t));
+  }
+  std::vector<std::string> keys;
+  for (int i = 0; i < 10; i++) {
+    keys.push_back("key" + std::to_string(i));
+  }
+  for (auto prefix : {"prefix", "sh"}) {
+    std::vector<bufferlist> values;
+    std::vector<int> rs;
+    ASSERT_EQ(0, db->get(prefix, keys, &values, &rs));
+    ASSERT_EQ(keys.size(), values.size());
+    ASSERT_EQ(keys.size(), rs.size());
+    for (int i = 0; i < 10; i++) {
+      if (i % 2 == 0) {
+	ASSERT_EQ(0, rs[i]);
+	ASSERT_EQ("value" + std::to_string(i), _bl_to_str(values[i]));
+      } else {
+	ASSERT_EQ(-ENOENT, rs[i]);
+	ASSERT_EQ(0u, values[i].length());
+      }
+    }
+  }
+  fini();
+}
+
 TEST_P(KVTest, RocksDBIteratorTest) {
   if(string(GetParam()) != "rocksdb")
     return;
@@ -79,6 +79,47 @@ TEST(Transaction, Swap)
   ASSERT_FALSE(b.empty());
 }
 
+TEST(Transaction, IteratorIndex)
+{
+  coll_t c1(spg_t(pg_t(1,2), shard_id_t::NO_SHARD));
+  coll_t c2(spg_t(pg_t(3,2), shard_id_t::NO_SHARD));
+  ghobject_t o1(hobject_t("obj1", "", 123, 456, -1, ""));
+  ghobject_t o2(hobject_t("obj2", "", 123, 456, -1, ""));
+  ghobject_t o3(hobject_t("obj3", "", 123, 456, -1, ""));
+
+  auto a = ObjectStore::Transaction{};
+  a.touch(c1, o1);
+  a.touch(c1, o2);
+  a.touch(c2, o1);
+  auto b = ObjectStore::Transaction{};
+  b.touch(c2, o3);
+  a.append(b);
+
+  auto check = [&](ObjectStore::Transaction& t) {
+    auto i = t.begin();
+    ASSERT_EQ(2u, i.colls.size());
+    ASSERT_EQ(3u, i.objects.size());
+    ASSERT_EQ(c1, i.get_cid(0));
+    ASSERT_EQ(c2, i.get_cid(1));
+    ASSERT_EQ(o1, i.get_oid(0));
+    ASSERT_EQ(o2, i.get_oid(1));
+    ASSERT_EQ(o3, i.get_oid(2));
+    vector<ghobject_t> objects(i.objects.begin(), i.objects.end());
+    ASSERT_EQ(vector<ghobject_t>({o1, o2, o3}), objects);
+  };
+  check(a);
+
+  auto copied = a;
+  a = ObjectStore::Transaction{};
+  check(copied);
+
+  bufferlist bl;
+  encode(copied, bl);
+  auto p = bl.cbegin();
+  auto decoded = ObjectStore::Transaction(p);
+  check(decoded);
+}
+
 ObjectStore::Transaction generate_transaction()
 {
   auto a = ObjectStore::Transaction{};
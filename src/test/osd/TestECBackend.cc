@@ -58,5 +58,19 @@ TEST(ECUtil, stripe_info_t)
 
   ASSERT_EQ(s.offset_len_to_stripe_bounds(make_pair(swidth-10, (uint64_t)20)),
             make_pair((uint64_t)0, 2*swidth));
+
+  // chunk size is 1024
+  ASSERT_EQ(s.logical_offset_to_chunk_position(0), 0u);
+  ASSERT_EQ(s.logical_offset_to_chunk_position(1024), 1u);
+  ASSERT_EQ(s.logical_offset_to_chunk_position(swidth + 3 * 1024 + 5), 3u);
+  ASSERT_EQ(s.logical_offset_to_shard_offset(5), 5u);
+  ASSERT_EQ(s.logical_offset_to_shard_offset(2 * 1024 + 5), 5u);
+  ASSERT_EQ(s.logical_offset_to_shard_offset(2 * swidth + 1024 + 5),
+	    2 * s.get_chunk_size() + 5);
+  ASSERT_TRUE(s.logical_extent_in_one_chunk(1024, 1024));
+  ASSERT_TRUE(s.logical_extent_in_one_chunk(swidth + 100, 200));
+  ASSERT_FALSE(s.logical_extent_in_one_chunk(1000, 100));
+  ASSERT_FALSE(s.logical_extent_in_one_chunk(1024, 1025));
+  ASSERT_FALSE(s.logical_extent_in_one_chunk(0, 0));
 }
 
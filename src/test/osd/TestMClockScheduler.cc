@@ -57,6 +57,10 @@ public:
       PGOpQueueable(spg_t()),
       scheduler_class(_scheduler_class) {}
 
+    MockDmclockItem(op_scheduler_class _scheduler_class, spg_t pgid) :
+      PGOpQueueable(pgid),
+      scheduler_class(_scheduler_class) {}
+
     MockDmclockItem()
       : MockDmclockItem(op_scheduler_class::background_best_effort) {}
 
@@ -254,3 +258,35 @@ TEST_F(mClockSchedulerTest, TestAllQueuesEnqueueDequeue) {
 
   ASSERT_TRUE(q.empty());
 }
+
+TEST_F(mClockSchedulerTest, TestPoolClientQoS) {
+  // clients of pool 1 get their own, low, limit; pool 2 is malformed
+  g_ceph_context->_conf.set_val_or_die(
+    "osd_mclock_scheduler_pool_client_qos", "1:0:1:0.01,2:0:0:1");
+  q.handle_conf_change(g_ceph_context->_conf,
+		       {"osd_mclock_scheduler_pool_client_qos"});
+
+  spg_t pool0(pg_t(0, 0)), pool1(pg_t(0, 1)), pool2(pg_t(0, 2));
+  for (unsigned i = 0; i < 10; ++i) {
+    q.enqueue(create_item(i, client1, op_scheduler_class::client, pool1));
+    q.enqueue(create_item(i + 100, client2, op_scheduler_class::client, pool0));
+    q.enqueue(create_item(i + 200, client3, op_scheduler_class::client, pool2));
+  }
+
+  unsigned dequeued = 0;
+  while (!q.empty()) {
+    WorkItem work_item = q.dequeue();
+    if (std::holds_alternative<double>(work_item)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+    get_item(std::move(work_item));
+    ++dequeued;
+  }
+  ASSERT_EQ(30u, dequeued);
+
+  g_ceph_context->_conf.set_val_or_die(
+    "osd_mclock_scheduler_pool_client_qos", "");
+  q.handle_conf_change(g_ceph_context->_conf,
+		       {"osd_mclock_scheduler_pool_client_qos"});
+}
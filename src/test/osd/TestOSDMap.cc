@@ -565,6 +565,90 @@ TEST_F(OSDMapTest, PrimaryAffinity) {
   }
 }
 
+TEST_F(OSDMapTest, IncrementalMapping) {
+  set_up_map();
+
+  ThreadPool tp(g_ceph_context, "IncrementalMapping::tp", "mapping_tp", 2);
+  tp.start();
+  ParallelPGMapper mapper(g_ceph_context, &tp);
+  auto check = [&]() {
+    for (auto pool : {my_ec_pool, my_rep_pool}) {
+      for (unsigned ps = 0; ps < (unsigned)osdmap.get_pg_num(pool); ++ps) {
+	pg_t pgid(ps, pool);
+	vector<int> up, acting, up2, acting2;
+	int up_primary, acting_primary, up_primary2, acting_primary2;
+	osdmap.pg_to_up_acting_osds(pgid, &up, &up_primary,
+				    &acting, &acting_primary);
+	mapping.get(pgid, &up2, &up_primary2, &acting2, &acting_primary2);
+	ASSERT_EQ(up, up2);
+	ASSERT_EQ(up_primary, up_primary2);
+	ASSERT_EQ(acting, acting2);
+	ASSERT_EQ(acting_primary, acting_primary2);
+      }
+    }
+  };
+  auto apply = [&](OSDMap::Incremental& inc) {
+    osdmap.apply_incremental(inc);
+    mapping.note_incremental(inc);
+    auto job = mapping.start_update(osdmap, mapper, 16);
+    job->wait();
+    ASSERT_EQ(osdmap.get_epoch(), mapping.get_epoch());
+    check();
+  };
+
+  // nothing noted yet: full
+  mapping.start_update(osdmap, mapper, 16)->wait();
+  check();
+
+  {
+    // an osd goes down
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_state[0] = CEPH_OSD_UP;
+    apply(inc);
+  }
+  {
+    // a pg_temp
+    vector<int> up, acting;
+    int up_primary, acting_primary;
+    pg_t pgid(3, my_rep_pool);
+    osdmap.pg_to_up_acting_osds(pgid, &up, &up_primary,
+				&acting, &acting_primary);
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_pg_temp[pgid] = mempool::osdmap::vector<int>(
+      acting.rbegin(), acting.rend());
+    apply(inc);
+  }
+  {
+    // an osd comes back up and another is marked out
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_state[0] = CEPH_OSD_UP;
+    inc.new_up_client[0] = osdmap.get_addrs(1);
+    inc.new_weight[1] = CEPH_OSD_OUT;
+    apply(inc);
+  }
+  {
+    // nothing mapping related: done without queueing any work
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_up_thru[2] = osdmap.get_epoch();
+    osdmap.apply_incremental(inc);
+    mapping.note_incremental(inc);
+    auto job = mapping.start_update(osdmap, mapper, 16);
+    ASSERT_TRUE(job->is_done());
+    ASSERT_EQ(osdmap.get_epoch(), mapping.get_epoch());
+    check();
+  }
+  {
+    // a gap in the noted incrementals falls back to a full update
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_weight[1] = CEPH_OSD_IN;
+    osdmap.apply_incremental(inc);
+    OSDMap::Incremental inc2(osdmap.get_epoch() + 1);
+    inc2.new_primary_affinity[2] = CEPH_OSD_MAX_PRIMARY_AFFINITY / 2;
+    apply(inc2);
+  }
+  tp.stop();
+}
+
 TEST_F(OSDMapTest, get_osd_crush_node_flags) {
   set_up_map();
 
@@ -634,6 +718,47 @@ TEST_F(OSDMapTest, parse_osd_id_list) {
   ASSERT_EQ(-EINVAL, osdmap.parse_osd_id_list({"-12"}, &out, &cout));
 }
 
+TEST_F(OSDMapTest, MapFanoutTree) {
+  set_up_map(20, true);
+  {
+    // osd.3 goes down; the tree is over the remaining up osds
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_state[3] = CEPH_OSD_UP;
+    osdmap.apply_incremental(inc);
+  }
+  const unsigned fanout = 3;
+  vector<int> roots;
+  osdmap.get_map_fanout_roots(fanout, &roots);
+  ASSERT_EQ((vector<int>{0, 1, 2}), roots);
+
+  // every up osd is reached exactly once, and down ones never
+  map<int, int> reached;
+  vector<int> queue = roots;
+  while (!queue.empty()) {
+    int osd = queue.back();
+    queue.pop_back();
+    reached[osd]++;
+    vector<int> children;
+    osdmap.get_map_fanout_children(osd, fanout, &children);
+    ASSERT_LE(children.size(), fanout);
+    queue.insert(queue.end(), children.begin(), children.end());
+  }
+  ASSERT_EQ(19u, reached.size());
+  ASSERT_EQ(0u, reached.count(3));
+  for (auto& [osd, n] : reached) {
+    ASSERT_EQ(1, n) << "osd." << osd;
+  }
+
+  // up osds in id order are 0 1 2 4 5 ...; index 0's children are 3..5
+  vector<int> children;
+  osdmap.get_map_fanout_children(0, fanout, &children);
+  ASSERT_EQ((vector<int>{4, 5, 6}), children);
+  osdmap.get_map_fanout_children(3, fanout, &children);
+  ASSERT_TRUE(children.empty());
+  osdmap.get_map_fanout_children(0, 0, &children);
+  ASSERT_TRUE(children.empty());
+}
+
 TEST_F(OSDMapTest, CleanPGUpmaps) {
   set_up_map();
 
@@ -1743,6 +1868,52 @@ TEST(PGTempMap, basic)
   ASSERT_EQ(998u, m.size());
 }
 
+TEST(PGUpmapItemsMap, encoding)
+{
+  // the compact map must encode like the plain map it replaced
+  mempool::osdmap::map<pg_t,PGUpmapItemsMap::items_t> ref;
+  for (auto i = 0; i < 1000; ++i) {
+    PGUpmapItemsMap::items_t items;
+    for (auto j = 0; j <= i % 3; ++j) {
+      items.push_back({i + j, i + j + 1000});
+    }
+    ref[pg_t(i, 1 + i % 3)] = items;
+  }
+  bufferlist bl;
+  encode(ref, bl);
+  PGUpmapItemsMap m;
+  auto p = bl.cbegin();
+  decode(m, p);
+  ASSERT_TRUE(p.end());
+  ASSERT_EQ(ref.size(), m.size());
+  for (auto& [pg, items] : ref) {
+    auto q = m.find(pg);
+    ASSERT_NE(q, m.end());
+    ASSERT_EQ(items, q->second.to_vector());
+  }
+
+  // entries set after decoding and removed ones
+  pg_t a(2000, 1);
+  m.set(a, {{1, 2}, {3, 4}});
+  ref[a] = {{1, 2}, {3, 4}};
+  m.set(pg_t(1, 2), {{5, 6}});
+  ref[pg_t(1, 2)] = {{5, 6}};
+  m.erase(pg_t(2, 3));
+  ref.erase(pg_t(2, 3));
+  ASSERT_EQ(0u, m.count(pg_t(2, 3)));
+  ASSERT_EQ(2u, m.find(a)->second.size());
+
+  bufferlist expected, actual;
+  encode(ref, expected);
+  encode(m, actual);
+  ASSERT_TRUE(expected.contents_equal(actual));
+  ASSERT_EQ(stringify(ref), stringify(m));
+
+  m.clear();
+  ASSERT_TRUE(m.empty());
+  ASSERT_EQ(m.begin(), m.end());
+}
+
 TEST_F(OSDMapTest, BUG_43124) {
   set_up_map(200);
   {
@@ -2234,7 +2234,7 @@ TEST_F(PGLogTest, ErrorNotIndexedByObject) {
   log.add(modify);
 
   EXPECT_TRUE(log.logged_object(oid));
-  pg_log_entry_t *entry = log.objects[oid];
+  pg_log_entry_t *entry = log.objects.find(oid)->second;
   EXPECT_EQ(modify.op, entry->op);
   EXPECT_EQ(modify.version, entry->version);
   EXPECT_EQ(modify.prior_version, entry->prior_version);
@@ -2248,7 +2248,7 @@ TEST_F(PGLogTest, ErrorNotIndexedByObject) {
   log.add(del);
 
   EXPECT_TRUE(log.logged_object(oid));
-  entry = log.objects[oid];
+  entry = log.objects.find(oid)->second;
   EXPECT_EQ(del.op, entry->op);
   EXPECT_EQ(del.version, entry->version);
   EXPECT_EQ(del.prior_version, entry->prior_version);
@@ -2261,7 +2261,7 @@ TEST_F(PGLogTest, ErrorNotIndexedByObject) {
 		   utime_t(20,1), -ENOENT));
 
   EXPECT_TRUE(log.logged_object(oid));
-  entry = log.objects[oid];
+  entry = log.objects.find(oid)->second;
   EXPECT_EQ(del.op, entry->op);
   EXPECT_EQ(del.version, entry->version);
   EXPECT_EQ(del.prior_version, entry->prior_version);
@@ -2702,6 +2702,50 @@ TEST_F(PGLogTrimTest, TestMakingCephContext)
 }
 
 
+TEST_F(PGLogTrimTest, TestIndexKeysPointIntoLog)
+{
+  SetUp(20);
+  PGLog::IndexedLog log;
+  log.head = mk_evt(24, 0);
+  log.skip_can_rollback_to_to_head();
+  log.head = mk_evt(9, 0);
+
+  auto e1 = mk_ple_mod(mk_obj(1), mk_evt(10, 100), mk_evt(8, 70),
+		       osd_reqid_t(entity_name_t::CLIENT(777), 8, 1));
+  log.add(e1);
+  log.add(mk_ple_mod(mk_obj(1), mk_evt(15, 150), mk_evt(10, 100),
+		     osd_reqid_t(entity_name_t::CLIENT(777), 8, 2)));
+
+  // the objects index is keyed by the newer entry's soid
+  EXPECT_TRUE(log.logged_object(mk_obj(1)));
+  auto p = log.objects.find(mk_obj(1));
+  ASSERT_NE(log.objects.end(), p);
+  EXPECT_EQ(&log.log.back(), p->second);
+  EXPECT_EQ(&log.log.back().soid, p->first);
+
+  // trimming the older entry leaves no dangling keys behind
+  std::set<eversion_t> trimmed;
+  std::set<std::string> trimmed_dups;
+  eversion_t write_from_dups = eversion_t::max();
+  log.trim(cct, mk_evt(10, 100), &trimmed, &trimmed_dups, &write_from_dups);
+  EXPECT_EQ(1u, log.log.size());
+  EXPECT_TRUE(log.logged_object(mk_obj(1)));
+  EXPECT_EQ(mk_evt(15, 150), log.objects.find(mk_obj(1))->second->version);
+
+  // the trimmed reqid is now found through the dups
+  eversion_t replay_version;
+  version_t user_version;
+  int return_code = 0;
+  std::vector<pg_log_op_return_item_t> op_returns;
+  EXPECT_TRUE(log.get_request(e1.reqid, &replay_version, &user_version,
+			      &return_code, &op_returns));
+  EXPECT_EQ(mk_evt(10, 100), replay_version);
+  auto d = log.dup_index.find(e1.reqid);
+  ASSERT_NE(log.dup_index.end(), d);
+  EXPECT_EQ(&log.dups.back().reqid, d->first);
+}
+
+
 TEST_F(PGLogTrimTest, TestPartialTrim)
 {
   SetUp(20);
@@ -122,6 +122,70 @@ TEST_F(BloomHitSetTest, RejectsNoMatch) {
   EXPECT_LT(matches, 2);
 }
 
+class BlockedBloomHitSetTest : public testing::Test, public HitSetTestStrap {
+public:
+
+  BlockedBloomHitSetTest()
+    : HitSetTestStrap(new HitSet(new BlockedBloomHitSet)) {}
+
+  void rebuild(double fp, uint64_t target, uint64_t seed) {
+    auto bparams = new BlockedBloomHitSet::Params(fp, target, seed);
+    HitSet::Params param(bparams);
+    HitSet new_set(param);
+    *hitset = new_set;
+  }
+};
+
+TEST_F(BlockedBloomHitSetTest, Construct) {
+  ASSERT_EQ(hitset->impl->get_type(), HitSet::TYPE_BLOCKED_BLOOM);
+  rebuild(0.1, 100, 1);
+  ASSERT_EQ(hitset->impl->get_type(), HitSet::TYPE_BLOCKED_BLOOM);
+  ASSERT_TRUE(HitSet::is_bloom_type(hitset->impl->get_type()));
+}
+
+TEST_F(BlockedBloomHitSetTest, InsertsMatch) {
+  rebuild(0.1, 100, 1);
+  fill(50);
+  verify_fill(50);
+  EXPECT_GE(hitset->approx_unique_insert_count(), 40u);
+  EXPECT_LE(hitset->approx_unique_insert_count(), 50u);
+  EXPECT_FALSE(hitset->is_full());
+
+  // survives copies and encoding
+  HitSet copy(*hitset);
+  bufferlist bl;
+  encode(copy, bl);
+  auto p = bl.cbegin();
+  decode(*hitset, p);
+  verify_fill(50);
+  EXPECT_EQ(50u, hitset->insert_count());
+}
+
+TEST_F(BlockedBloomHitSetTest, FillsUp) {
+  rebuild(0.1, 20, 1);
+  fill(20);
+  verify_fill(20);
+  EXPECT_TRUE(hitset->is_full());
+}
+
+TEST_F(BlockedBloomHitSetTest, RejectsNoMatch) {
+  rebuild(0.001, 1000, 1);
+  fill(1000);
+  verify_fill(1000);
+  EXPECT_TRUE(hitset->is_full());
+
+  char buf[50];
+  int matches = 0;
+  for (int i = 1000; i < 11000; ++i) {
+    sprintf(buf, "hitsettest_%d", i);
+    hobject_t obj(object_t(buf), "", 0, i, 0, "");
+    if (hitset->contains(obj))
+      ++matches;
+  }
+  // we set a 1 in 1000 false positive; allow some slack for the blocking
+  EXPECT_LT(matches, 30);
+}
+
 class ExplicitHashHitSetTest : public testing::Test, public HitSetTestStrap {
 public:
 
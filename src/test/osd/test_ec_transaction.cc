@@ -15,6 +15,7 @@
 #include <gtest/gtest.h>
 #include "osd/PGTransaction.h"
 #include "osd/ECTransaction.h"
+#include "test/erasure-code/ErasureCodeExample.h"
 
 #include "test/unit.cc"
 
@@ -122,3 +123,67 @@ TEST(ectransaction, many_writes)
   ASSERT_EQ(0u, plan.to_read.size());
   ASSERT_EQ(1u, plan.will_write.size());
 }
+
+TEST(ectransaction, parity_delta)
+{
+  hobject_t h;
+  ECUtil::stripe_info_t sinfo(2, 8192);
+  ErasureCodeInterfaceRef ecimpl(new ErasureCodeExample());
+  ECUtil::HashInfoRef hinfo(new ECUtil::HashInfo(3));
+  auto extents = [](uint64_t off, uint64_t len) {
+    extent_set s;
+    s.insert(off, len);
+    return s;
+  };
+  auto get_hinfo = [&](const hobject_t &i) {
+    hinfo->set_projected_total_logical_size(sinfo, 4 * 8192);
+    return hinfo;
+  };
+
+  // only the first data chunk of the second stripe is modified
+  {
+    PGTransactionUPtr t(new PGTransaction);
+    bufferlist a;
+    a.append_zero(200);
+    t->write(h, 8192 + 100, a.length(), a, 0);
+    auto plan = ECTransaction::get_write_plan(
+      sinfo, std::move(t), get_hinfo, &dpp);
+    ASSERT_EQ(1u, plan.to_read.size());
+    ECTransaction::plan_parity_delta(plan, sinfo, ecimpl, &dpp);
+    ASSERT_EQ(1u, plan.parity_delta.size());
+    auto &pd = plan.parity_delta[h];
+    ASSERT_EQ(extents(8192, 8192), pd.stripes);
+    ASSERT_EQ(extents(8192, 4096), pd.writes);
+    ASSERT_EQ(std::set<int>({0, 2}), pd.shards);
+
+    ECTransaction::use_parity_delta(plan, h);
+    ASSERT_EQ(0u, plan.to_read.size());
+    ASSERT_EQ(extents(8192, 4096), plan.will_write[h]);
+  }
+
+  // both data chunks are modified, re-encode the stripe
+  {
+    PGTransactionUPtr t(new PGTransaction);
+    bufferlist a;
+    a.append_zero(200);
+    t->write(h, 8192 + 4000, a.length(), a, 0);
+    auto plan = ECTransaction::get_write_plan(
+      sinfo, std::move(t), get_hinfo, &dpp);
+    ASSERT_EQ(1u, plan.to_read.size());
+    ECTransaction::plan_parity_delta(plan, sinfo, ecimpl, &dpp);
+    ASSERT_EQ(0u, plan.parity_delta.size());
+  }
+
+  // truncates are not handled
+  {
+    PGTransactionUPtr t(new PGTransaction);
+    bufferlist a;
+    a.append_zero(200);
+    t->write(h, 8192 + 100, a.length(), a, 0);
+    t->truncate(h, 3 * 8192 + 100);
+    auto plan = ECTransaction::get_write_plan(
+      sinfo, std::move(t), get_hinfo, &dpp);
+    ECTransaction::plan_parity_delta(plan, sinfo, ecimpl, &dpp);
+    ASSERT_EQ(0u, plan.parity_delta.size());
+  }
+}
@@ -280,3 +280,88 @@ TEST(extentcache, write_write_overlap2)
 
   c.release_write_pin(pin3);
 }
+
+TEST(extentcache, retain)
+{
+  hobject_t oid;
+  ExtentCache c;
+
+  // write and retain 0~10
+  {
+    ExtentCache::write_pin pin;
+    c.open_write_pin(pin);
+    auto to_write = iset_from_vector({{0, 10}});
+    auto must_read = c.reserve_extents_for_rmw(
+      oid, pin, to_write, extent_set());
+    ASSERT_TRUE(must_read.empty());
+    c.present_rmw_update(oid, pin, imap_from_iset(to_write));
+    c.release_write_pin(pin, true);
+  }
+  ASSERT_EQ(10u, c.get_cached_bytes());
+
+  // rmw of 0~20 only reads 10~10
+  {
+    ExtentCache::write_pin pin;
+    c.open_write_pin(pin);
+    auto to_rmw = iset_from_vector({{0, 20}});
+    auto must_read = c.reserve_extents_for_rmw(
+      oid, pin, to_rmw, to_rmw);
+    ASSERT_EQ(iset_from_vector({{10, 10}}), must_read);
+    ASSERT_EQ(0u, c.get_cached_bytes());
+    auto pending = c.get_remaining_extents_for_rmw(
+      oid, pin, iset_from_vector({{0, 10}}));
+    ASSERT_EQ(imap_from_iset(iset_from_vector({{0, 10}})), pending);
+    c.present_rmw_update(oid, pin, imap_from_iset(to_rmw));
+    c.release_write_pin(pin, true);
+  }
+  ASSERT_EQ(20u, c.get_cached_bytes());
+
+  // invalidated while pinned, not retained
+  {
+    ExtentCache::write_pin pin;
+    c.open_write_pin(pin);
+    auto to_write = iset_from_vector({{30, 10}});
+    c.reserve_extents_for_rmw(oid, pin, to_write, extent_set());
+    c.invalidate(oid);
+    ASSERT_EQ(0u, c.get_cached_bytes());
+    c.present_rmw_update(oid, pin, imap_from_iset(to_write));
+    c.release_write_pin(pin, true);
+  }
+  ASSERT_EQ(0u, c.get_cached_bytes());
+}
+
+TEST(extentcache, trim)
+{
+  hobject_t oid1 = hobject_t(sobject_t("foo", CEPH_NOSNAP));
+  hobject_t oid2 = hobject_t(sobject_t("bar", CEPH_NOSNAP));
+  ExtentCache c;
+
+  for (auto &oid : {oid1, oid2}) {
+    ExtentCache::write_pin pin;
+    c.open_write_pin(pin);
+    auto to_write = iset_from_vector({{0, 10}});
+    c.reserve_extents_for_rmw(oid, pin, to_write, extent_set());
+    c.present_rmw_update(oid, pin, imap_from_iset(to_write));
+    c.release_write_pin(pin, true);
+  }
+  ASSERT_EQ(20u, c.get_cached_bytes());
+
+  // the least recently written object goes first
+  c.trim(15);
+  ASSERT_EQ(10u, c.get_cached_bytes());
+  {
+    ExtentCache::write_pin pin;
+    c.open_write_pin(pin);
+    auto to_rmw = iset_from_vector({{0, 10}});
+    ASSERT_EQ(to_rmw, c.reserve_extents_for_rmw(oid1, pin, to_rmw, to_rmw));
+    c.release_write_pin(pin);
+  }
+  {
+    ExtentCache::write_pin pin;
+    c.open_write_pin(pin);
+    auto to_rmw = iset_from_vector({{0, 10}});
+    ASSERT_TRUE(c.reserve_extents_for_rmw(oid2, pin, to_rmw, to_rmw).empty());
+    c.release_write_pin(pin);
+  }
+  ASSERT_EQ(0u, c.get_cached_bytes());
+}
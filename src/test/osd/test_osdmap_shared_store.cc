@@ -0,0 +1,108 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+#include "global/global_context.h"
+#include "include/stringify.h"
+#include "osd/OSDMapSharedStore.h"
+
+class OSDMapSharedStoreTest : public ::testing::Test {
+protected:
+  std::string path;
+  uuid_d fsid;
+
+  void SetUp() override {
+    char tmpl[] = "/tmp/osdmap_shared_store.XXXXXX";
+    ASSERT_TRUE(mkdtemp(tmpl));
+    path = tmpl;
+    fsid.generate_random();
+  }
+  void TearDown() override {
+    ASSERT_EQ(0, system(("rm -rf " + path).c_str()));
+  }
+  std::string file(epoch_t e) {
+    return path + "/" + stringify(fsid) + "/osdmap." + stringify(e);
+  }
+};
+
+static ceph::buffer::list make_map(unsigned len, char c)
+{
+  ceph::buffer::list bl;
+  bl.append(std::string(len, c));
+  return bl;
+}
+
+TEST_F(OSDMapSharedStoreTest, ReadWrite)
+{
+  OSDMapSharedStore s(g_ceph_context, path, fsid);
+  ASSERT_EQ(0, s.init());
+  ceph::buffer::list bl;
+  ASSERT_FALSE(s.read(1, &bl));
+
+  ASSERT_EQ(0, s.write(1, make_map(10000, 'a')));
+  ASSERT_TRUE(s.read(1, &bl));
+  ASSERT_TRUE(bl.contents_equal(make_map(10000, 'a')));
+  ASSERT_TRUE(bl.is_page_aligned());
+
+  // the first copy stays
+  ASSERT_EQ(0, s.write(1, make_map(10000, 'b')));
+  ASSERT_TRUE(s.read(1, &bl));
+  ASSERT_TRUE(bl.contents_equal(make_map(10000, 'a')));
+
+  // another daemon of the host sees it too
+  OSDMapSharedStore other(g_ceph_context, path, fsid);
+  ASSERT_EQ(0, other.init());
+  ceph::buffer::list bl2;
+  ASSERT_TRUE(other.read(1, &bl2));
+  ASSERT_TRUE(bl2.contents_equal(bl));
+
+  // but not a daemon of another cluster
+  uuid_d fsid2;
+  fsid2.generate_random();
+  OSDMapSharedStore stranger(g_ceph_context, path, fsid2);
+  ASSERT_EQ(0, stranger.init());
+  ASSERT_FALSE(stranger.read(1, &bl2));
+}
+
+TEST_F(OSDMapSharedStoreTest, Corrupt)
+{
+  OSDMapSharedStore s(g_ceph_context, path, fsid);
+  ASSERT_EQ(0, s.init());
+  ASSERT_EQ(0, s.write(2, make_map(5000, 'a')));
+  int fd = ::open(file(2).c_str(), O_WRONLY);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(1, ::pwrite(fd, "b", 1, 100));
+  ::close(fd);
+  ceph::buffer::list bl;
+  ASSERT_FALSE(s.read(2, &bl));
+
+  // a map stored under the wrong epoch is ignored as well
+  ASSERT_EQ(0, s.write(3, make_map(5000, 'a')));
+  ASSERT_EQ(0, ::rename(file(3).c_str(), file(4).c_str()));
+  ASSERT_FALSE(s.read(4, &bl));
+}
+
+TEST_F(OSDMapSharedStoreTest, Trim)
+{
+  OSDMapSharedStore s(g_ceph_context, path, fsid);
+  ASSERT_EQ(0, s.init());
+  for (epoch_t e = 1; e <= 5; ++e) {
+    ASSERT_EQ(0, s.write(e, make_map(100, 'a' + e)));
+  }
+  ceph::buffer::list held;
+  ASSERT_TRUE(s.read(2, &held));
+  s.trim(4);
+  ceph::buffer::list bl;
+  for (epoch_t e = 1; e < 4; ++e) {
+    ASSERT_FALSE(s.read(e, &bl));
+  }
+  ASSERT_TRUE(s.read(4, &bl));
+  ASSERT_TRUE(s.read(5, &bl));
+  // maps already mapped outlive their file
+  ASSERT_TRUE(held.contents_equal(make_map(100, 'a' + 2)));
+}
@@ -0,0 +1,120 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <gtest/gtest.h>
+#include "osd/ReadCache.h"
+
+static hobject_t make_obj(const char *name)
+{
+  return hobject_t(object_t(name), "", CEPH_NOSNAP,
+		   ceph_str_hash_linux(name, strlen(name)), 1, "");
+}
+
+static ReadCache::Result make_result(unsigned len)
+{
+  ReadCache::Result r;
+  memset(&r.op, 0, sizeof(r.op));
+  r.op.op = CEPH_OSD_OP_READ;
+  r.op.extent.length = len;
+  r.outdata.append_zero(len);
+  return r;
+}
+
+TEST(ReadCache, Disabled)
+{
+  ReadCache c(1);
+  auto o = make_obj("foo");
+  ReadCache::Result r;
+  ASSERT_FALSE(c.enabled());
+  c.insert(o, eversion_t(1, 1), "k", make_result(10));
+  ASSERT_FALSE(c.lookup(o, eversion_t(1, 1), "k", &r));
+  ASSERT_EQ(0u, c.get_bytes());
+}
+
+TEST(ReadCache, HitAndVersion)
+{
+  ReadCache c(1);
+  c.set_max_bytes(1 << 20);
+  auto o = make_obj("foo");
+  ReadCache::Result r;
+  c.insert(o, eversion_t(1, 1), "a", make_result(10));
+  c.insert(o, eversion_t(1, 1), "b", make_result(20));
+  ASSERT_TRUE(c.lookup(o, eversion_t(1, 1), "a", &r));
+  ASSERT_EQ(10u, r.outdata.length());
+  ASSERT_EQ(10u, r.op.extent.length);
+  ASSERT_TRUE(c.lookup(o, eversion_t(1, 1), "b", &r));
+  ASSERT_EQ(20u, r.outdata.length());
+  ASSERT_FALSE(c.lookup(o, eversion_t(1, 1), "c", &r));
+
+  // a newer version drops everything cached for the object
+  ASSERT_FALSE(c.lookup(o, eversion_t(1, 2), "a", &r));
+  ASSERT_FALSE(c.lookup(o, eversion_t(1, 1), "b", &r));
+  ASSERT_EQ(0u, c.get_bytes());
+}
+
+TEST(ReadCache, Invalidate)
+{
+  ReadCache c(4);
+  c.set_max_bytes(1 << 20);
+  auto foo = make_obj("foo");
+  auto bar = make_obj("bar");
+  ReadCache::Result r;
+  c.insert(foo, eversion_t(1, 1), "a", make_result(10));
+  c.insert(bar, eversion_t(1, 1), "a", make_result(10));
+  c.invalidate(foo);
+  ASSERT_FALSE(c.lookup(foo, eversion_t(1, 1), "a", &r));
+  ASSERT_TRUE(c.lookup(bar, eversion_t(1, 1), "a", &r));
+  c.clear();
+  ASSERT_FALSE(c.lookup(bar, eversion_t(1, 1), "a", &r));
+  ASSERT_EQ(0u, c.get_bytes());
+}
+
+TEST(ReadCache, LRU)
+{
+  ReadCache c(1);
+  c.set_max_bytes(3 * (1000 + sizeof(ReadCache::Result) + 1));
+  auto a = make_obj("a");
+  auto b = make_obj("b");
+  auto d = make_obj("d");
+  auto e = make_obj("e");
+  ReadCache::Result r;
+  c.insert(a, eversion_t(1, 1), "k", make_result(1000));
+  c.insert(b, eversion_t(1, 1), "k", make_result(1000));
+  c.insert(d, eversion_t(1, 1), "k", make_result(1000));
+  // touch a so that b is the oldest
+  ASSERT_TRUE(c.lookup(a, eversion_t(1, 1), "k", &r));
+  c.insert(e, eversion_t(1, 1), "k", make_result(1000));
+  ASSERT_TRUE(c.lookup(a, eversion_t(1, 1), "k", &r));
+  ASSERT_FALSE(c.lookup(b, eversion_t(1, 1), "k", &r));
+  ASSERT_TRUE(c.lookup(d, eversion_t(1, 1), "k", &r));
+  ASSERT_TRUE(c.lookup(e, eversion_t(1, 1), "k", &r));
+  ASSERT_LE(c.get_bytes(), c.get_capacity());
+
+  // results larger than the cache are not kept
+  c.insert(a, eversion_t(1, 1), "big", make_result(1 << 20));
+  ASSERT_FALSE(c.lookup(a, eversion_t(1, 1), "big", &r));
+}
+
+TEST(ReadCache, PriorityCache)
+{
+  ReadCache c(1);
+  c.set_max_bytes(1 << 20);
+  c.insert(make_obj("a"), eversion_t(1, 1), "k", make_result(1000));
+  uint64_t used = c.get_bytes();
+  ASSERT_EQ((int64_t)used,
+	    c.request_cache_bytes(PriorityCache::Priority::PRI1, 1 << 30));
+  ASSERT_EQ((int64_t)((1 << 20) - used),
+	    c.request_cache_bytes(PriorityCache::Priority::PRI10, 1 << 30));
+  ASSERT_EQ(0, c.request_cache_bytes(PriorityCache::Priority::PRI5, 1 << 30));
+
+  // the committed size includes the manager's headroom chunk, but the
+  // cache never grows past its configured maximum
+  for (int i = 0; i <= PriorityCache::Priority::LAST; i++) {
+    c.set_cache_bytes(static_cast<PriorityCache::Priority>(i), 0);
+  }
+  c.set_cache_bytes(PriorityCache::Priority::PRI1, used);
+  c.commit_cache_size(1 << 30);
+  ASSERT_GE((uint64_t)c.get_committed_size(), used);
+  ASSERT_EQ(1u << 20, c.get_capacity());
+  ASSERT_EQ(used, c.get_bytes());
+}
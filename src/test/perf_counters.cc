@@ -374,6 +374,97 @@ TEST(PerfCounters, TestLabeledCountersOnly) {
   g_ceph_context->get_perfcounters_collection()->clear();
 }
 
+TEST(PerfCounters, TestCounterDumpDelta) {
+  std::string counter_key1 = ceph::perf_counters::key_create("name1", {{"label1", "val1"}});
+  std::string counter_key2 = ceph::perf_counters::key_create("name2", {{"label2", "val2"}});
+
+  PerfCounters* counters1 = setup_test_perfcounter4(counter_key1, g_ceph_context);
+  PerfCounters* counters2 = setup_test_perfcounter4(counter_key2, g_ceph_context);
+  counters1->set(TEST_PERFCOUNTERS2_ELEMENT_FOO, 2);
+
+  AdminSocketClient client(get_rand_socket_path());
+  std::string message;
+  const char *request = R"({ "prefix": "counter dump delta", "client": "test", "format": "raw" })";
+
+  // the first dump for a client has everything
+  ASSERT_EQ("", client.do_request(request, &message));
+  ASSERT_EQ(R"({
+    "full": true,
+    "counters": {
+        "name1": {
+            "labels": {
+                "label1": "val1"
+            },
+            "counters": {
+                "foo": 2,
+                "bar": 0.000000000
+            }
+        },
+        "name2": {
+            "labels": {
+                "label2": "val2"
+            },
+            "counters": {
+                "foo": 0,
+                "bar": 0.000000000
+            }
+        }
+    }
+}
+)", message);
+
+  ASSERT_EQ("", client.do_request(request, &message));
+  ASSERT_EQ(R"({
+    "full": false,
+    "counters": {}
+}
+)", message);
+
+  // only what changed
+  counters2->tset(TEST_PERFCOUNTERS2_ELEMENT_BAR, utime_t(1, 0));
+  ASSERT_EQ("", client.do_request(request, &message));
+  ASSERT_EQ(R"({
+    "full": false,
+    "counters": {
+        "name2": {
+            "labels": {
+                "label2": "val2"
+            },
+            "counters": {
+                "bar": 1.000000000
+            }
+        }
+    }
+}
+)", message);
+
+  // other clients have their own view
+  ASSERT_EQ("", client.do_request(R"({ "prefix": "counter dump delta", "client": "other", "format": "raw" })", &message));
+  ASSERT_NE(std::string::npos, message.find(R"("full": true)"));
+
+  // removing a logger means starting over
+  g_ceph_context->get_perfcounters_collection()->remove(counters1);
+  delete counters1;
+  ASSERT_EQ("", client.do_request(request, &message));
+  ASSERT_EQ(R"({
+    "full": true,
+    "counters": {
+        "name2": {
+            "labels": {
+                "label2": "val2"
+            },
+            "counters": {
+                "foo": 0,
+                "bar": 1.000000000
+            }
+        }
+    }
+}
+)", message);
+
+  g_ceph_context->get_perfcounters_collection()->clear();
+}
+
 TEST(PerfCounters, TestLabelStrings) {
   AdminSocketClient client(get_rand_socket_path());
   std::string message;
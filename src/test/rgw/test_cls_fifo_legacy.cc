@@ -15,6 +15,7 @@
 #include <cerrno>
 #include <iostream>
 #include <string_view>
+#include <thread>
 
 #include "include/scope_guard.h"
 #include "include/types.h"
@@ -527,6 +528,55 @@ TEST_F(LegacyFIFO, TestPushBatch)
   ASSERT_EQ(info.head_part_num, 4);
 }
 
+TEST_F(LegacyFIFO, TestConcurrentPushers)
+{
+  static constexpr auto threads = 8u;
+  static constexpr auto per_thread = 50u;
+
+  std::unique_ptr<RCf::FIFO> f;
+  auto r = RCf::FIFO::create(&dp, ioctx, fifo_id, &f, null_yield);
+  ASSERT_EQ(0, r);
+
+  /* single-entry pushes from many threads may be sent in groups */
+  std::vector<std::thread> pushers;
+  std::atomic<int> errors = 0;
+  for (auto t = 0u; t < threads; ++t) {
+    pushers.emplace_back([&, t] {
+      for (auto i = 0u; i < per_thread; ++i) {
+	cb::list bl;
+	encode(t, bl);
+	encode(i, bl);
+	if (f->push(&dp, bl, null_yield) < 0) {
+	  ++errors;
+	}
+      }
+    });
+  }
+  for (auto& p : pushers) {
+    p.join();
+  }
+  ASSERT_EQ(0, errors);
+
+  std::vector<RCf::list_entry> result;
+  bool more = false;
+  r = f->list(&dp, threads * per_thread, std::nullopt, &result, &more,
+	      null_yield);
+  ASSERT_EQ(0, r);
+  ASSERT_EQ(false, more);
+  ASSERT_EQ(threads * per_thread, result.size());
+  /* each thread's entries are in the order it pushed them */
+  std::vector<std::uint32_t> next(threads, 0);
+  for (auto& e : result) {
+    std::uint32_t t, i;
+    auto iter = e.data.cbegin();
+    decode(t, iter);
+    decode(i, iter);
+    ASSERT_LT(t, threads);
+    ASSERT_EQ(next[t], i);
+    ++next[t];
+  }
+}
+
 TEST_F(LegacyFIFO, TestAioTrim)
 {
   static constexpr auto max_part_size = 2048ull;
@@ -184,3 +184,49 @@ TEST(Compress, BillionZeros)
 
   ASSERT_EQ(d_sink.get_sink().length() , size*1000);
 }
+
+TEST(Compress, Window)
+{
+  CompressorRef plugin;
+  plugin = Compressor::create(g_ceph_context, Compressor::COMP_ALG_ZLIB);
+  ASSERT_NE(plugin.get(), nullptr);
+  g_ceph_context->_conf.set_val_or_die("rgw_compression_window", "4");
+
+  constexpr size_t size = 1000000;
+  constexpr int parts = 10;
+  bufferlist orig;
+  ut_put_sink c_sink;
+  {
+    RGWPutObj_Compress compressor(g_ceph_context, plugin, &c_sink);
+    for (int i = 0; i < parts; i++) {
+      bufferlist bl;
+      bl.append(std::string(size, 'a' + i));
+      orig.append(bl);
+      ASSERT_EQ(0, compressor.process(std::move(bl), size*i));
+    }
+    ASSERT_EQ(0, compressor.process({}, size*parts)); // flush
+    ASSERT_TRUE(compressor.is_compressed());
+
+    RGWCompressionInfo cs_info;
+    cs_info.compression_type = plugin->get_type_name();
+    cs_info.orig_size = size*parts;
+    cs_info.compressor_message = compressor.get_compressor_message();
+    cs_info.blocks = move(compressor.get_compression_blocks());
+    ASSERT_EQ((size_t)parts, cs_info.blocks.size());
+
+    ut_get_sink d_sink;
+    RGWGetObj_Decompress decompress(g_ceph_context, &cs_info, false, &d_sink);
+
+    off_t f_begin = 0;
+    off_t f_end = size*parts - 1;
+    decompress.fixup_range(f_begin, f_end);
+
+    decompress.handle_data(c_sink.get_sink(), 0, c_sink.get_sink().length());
+    bufferlist empty;
+    decompress.handle_data(empty, 0, 0);
+
+    // the parts come back in the order they were written
+    ASSERT_TRUE(d_sink.get_sink().contents_equal(orig));
+  }
+  g_ceph_context->_conf.set_val_or_die("rgw_compression_window", "1");
+}
@@ -96,6 +96,29 @@ TEST(Aio_Throttle, CostOverWindow)
   EXPECT_EQ(-EDEADLK, c.front().result);
 }
 
+TEST(Aio_Throttle, Resize)
+{
+  BlockingAioThrottle throttle(4);
+  auto obj = make_obj(__PRETTY_FUNCTION__);
+
+  throttle.resize(8);
+  {
+    // fits the resized window without waiting
+    scoped_completion op;
+    auto c = throttle.get(obj, wait_on(op), 8, 0);
+    EXPECT_TRUE(c.empty());
+  }
+  auto completions = throttle.drain();
+  ASSERT_EQ(1u, completions.size());
+  EXPECT_EQ(-ECANCELED, completions.front().result);
+
+  throttle.resize(2);
+  scoped_completion op;
+  auto c = throttle.get(obj, wait_on(op), 4, 0);
+  ASSERT_EQ(1u, c.size());
+  EXPECT_EQ(-EDEADLK, c.front().result);
+}
+
 TEST(Aio_Throttle, ThrottleOverMax)
 {
   constexpr uint64_t window = 4;
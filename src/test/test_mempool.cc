@@ -15,6 +15,9 @@
  */
 
 #include <stdio.h>
+#include <thread>
+
+#include "acconfig.h"
 
 #include "global/global_init.h"
 #include "common/ceph_argparse.h"
@@ -434,6 +437,49 @@ TEST(mempool, check_shard_select)
 }
 
 
+TEST(mempool, thread_exit)
+{
+  size_t before = mempool::unittest_1::allocated_bytes();
+  mempool::unittest_1::vector<int> *v = nullptr;
+  std::thread t([&v] {
+    v = new mempool::unittest_1::vector<int>(1000);
+  });
+  t.join();
+  // counted by the exited thread, freed by this one
+  ASSERT_EQ(before + 1000 * sizeof(int),
+	    mempool::unittest_1::allocated_bytes());
+  delete v;
+  ASSERT_EQ(before, mempool::unittest_1::allocated_bytes());
+}
+
+TEST(mempool, sample)
+{
+  mempool::set_sample_rate(1);
+  {
+    mempool::unittest_2::vector<int> v(100);
+    ostringstream ostr;
+    Formatter* f = Formatter::create("json-pretty", "json-pretty", "json-pretty");
+    f->open_object_section("pool");
+    mempool::get_pool(mempool::unittest_2::id).dump(f);
+    f->close_section();
+    f->flush(ostr);
+    delete f;
+#ifdef HAVE_EXECINFO_H
+    ASSERT_NE(ostr.str().find("samples"), std::string::npos);
+#endif
+  }
+  mempool::set_sample_rate(0);
+  ostringstream ostr;
+  Formatter* f = Formatter::create("json-pretty", "json-pretty", "json-pretty");
+  f->open_object_section("pool");
+  mempool::get_pool(mempool::unittest_2::id).dump(f);
+  f->close_section();
+  f->flush(ostr);
+  delete f;
+  ASSERT_EQ(ostr.str().find("samples"), std::string::npos);
+}
+
+
 int main(int argc, char **argv)
 {
   auto args = argv_to_vec(argc, argv);
@@ -281,3 +281,31 @@ TEST(PageSet, FreeHoles)
   pages.get_range(0, 8, range);
   ASSERT_EQ(0u, range.size());
 }
+
+TEST(PageSet, HugePageAllocator)
+{
+  const size_t page_size = 64 << 10;
+  auto& allocator = HugePageAllocator::get(page_size);
+  ASSERT_EQ(&allocator, &HugePageAllocator::get(page_size));
+
+  PageSet pages(page_size, &allocator);
+  PageSet::page_vector range;
+  pages.alloc_range(0, page_size * 4, range);
+  ASSERT_EQ(4u, range.size());
+  for (auto& page : range) {
+    ASSERT_TRUE(is_aligned(page.get()));
+    std::fill(page->data, page->data + page_size, 'x');
+  }
+  // pages are allocated back to front, so the last one got the start
+  // of a fresh huge page region
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(range[3]->data) %
+	    HugePageAllocator::HUGE_PAGE_SIZE);
+  char *freed = range[3]->data;
+  range.clear();
+
+  // freed buffers are reused
+  pages.free_pages_after(page_size * 3);
+  pages.alloc_range(page_size * 8, page_size, range);
+  ASSERT_EQ(1u, range.size());
+  ASSERT_EQ(freed, range[0]->data);
+}
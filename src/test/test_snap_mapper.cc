@@ -535,13 +535,15 @@ public:
     return mapper->make_purged_snap_key(std::forward<Args>(args)...);
   }
 
-  void trim_snap() {
+  /// with skip, leave some objects behind the first time they are returned
+  void trim_snap(bool skip = false) {
     std::lock_guard l{lock};
     if (snap_to_hobject.empty())
       return;
     map<snapid_t, set<hobject_t> >::iterator snap =
       rand_choose(snap_to_hobject);
     set<hobject_t> hobjects = snap->second;
+    set<hobject_t> skipped;
 
     vector<hobject_t> hoids;
     while (mapper->get_next_objects_to_trim(
@@ -549,6 +551,10 @@ public:
       for (auto &&hoid: hoids) {
 	ceph_assert(!hoid.is_max());
 	ceph_assert(hobjects.count(hoid));
+	if (skip && !skipped.count(hoid) && rand() % 3 == 0) {
+	  skipped.insert(hoid);
+	  continue;
+	}
 	hobjects.erase(hoid);
 
 	map<hobject_t, set<snapid_t>>::iterator j =
@@ -682,6 +688,19 @@ TEST_F(SnapMapperTest, Simple) {
   get_tester().trim_snap();
 }
 
+TEST_F(SnapMapperTest, TrimResumesAndRescans) {
+  init(1);
+  for (int i = 0; i < 5; ++i) {
+    get_tester().create_snap();
+  }
+  for (int i = 0; i < 200; ++i) {
+    get_tester().create_object();
+  }
+  for (int i = 0; i < 5; ++i) {
+    get_tester().trim_snap(true);
+  }
+}
+
 TEST_F(SnapMapperTest, More) {
   init(1);
   run();
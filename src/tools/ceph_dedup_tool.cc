@@ -72,34 +72,48 @@ struct EstimateResult {
     : cdc(CDC::create(alg, chunk_size)),
       chunk_size(1ull << chunk_size) {}
 
-  void add_chunk(bufferlist& chunk, const std::string& fp_algo) {
-    string fp;
+  static string fingerprint(bufferlist& chunk, const std::string& fp_algo) {
     if (fp_algo == "sha1") {
       sha1_digest_t sha1_val = crypto::digest<crypto::SHA1>(chunk);
-      fp = sha1_val.to_str();
+      return sha1_val.to_str();
     } else if (fp_algo == "sha256") {
       sha256_digest_t sha256_val = crypto::digest<crypto::SHA256>(chunk);
-      fp = sha256_val.to_str();
+      return sha256_val.to_str();
     } else if (fp_algo == "sha512") {
       sha512_digest_t sha512_val = crypto::digest<crypto::SHA512>(chunk);
-      fp = sha512_val.to_str();
+      return sha512_val.to_str();
     } else {
-      ceph_assert(0 == "no support fingerperint algorithm");
+      ceph_abort_msg("no support fingerperint algorithm");
+    }
+  }
+
+  /// fingerprint the chunks of an object and account for them in one go
+  void add_chunks(const bufferlist& bl,
+		  const vector<pair<uint64_t, uint64_t>>& chunks,
+		  const std::string& fp_algo) {
+    vector<pair<string, uint64_t>> fps;
+    fps.reserve(chunks.size());
+    for (auto& c : chunks) {
+      bufferlist chunk;
+      chunk.substr_of(bl, c.first, c.second);
+      fps.emplace_back(fingerprint(chunk, fp_algo), c.second);
     }
 
     std::lock_guard l(lock);
-    auto p = chunk_statistics.find(fp);
-    if (p != chunk_statistics.end()) {
-      p->second.first++;
-      if (p->second.second != chunk.length()) {
-	cerr << "warning: hash collision on " << fp
-	     << ": was " << p->second.second
-	     << " now " << chunk.length() << std::endl;
+    for (auto& [fp, len] : fps) {
+      auto p = chunk_statistics.find(fp);
+      if (p != chunk_statistics.end()) {
+	p->second.first++;
+	if (p->second.second != len) {
+	  cerr << "warning: hash collision on " << fp
+	       << ": was " << p->second.second
+	       << " now " << len << std::endl;
+	}
+      } else {
+	chunk_statistics.emplace(std::move(fp), make_pair(1, len));
       }
-    } else {
-      chunk_statistics[fp] = make_pair(1, chunk.length());
+      total_bytes += len;
     }
-    total_bytes += chunk.length();
   }
 
   void dump(Formatter *f) const {
@@ -133,6 +147,7 @@ map<uint64_t, EstimateResult> dedup_estimates;  // chunk size -> result
 using namespace librados;
 unsigned default_op_size = 1 << 26;
 unsigned default_max_thread = 2;
+unsigned default_read_ahead = 2;
 int32_t default_report_period = 10;
 ceph::mutex glock = ceph::make_mutex("glock");
 
@@ -173,6 +188,7 @@ po::options_description make_usage() {
     ("report-period", po::value<int>(), ": set report-period")
     ("max-seconds", po::value<int>(), ": set max runtime")
     ("max-read-size", po::value<int>(), ": set max read size")
+    ("read-ahead", po::value<int>(), ": set the number of objects each estimate thread reads ahead")
     ("pool", po::value<std::string>(), ": set pool name")
     ("min-chunk-size", po::value<int>(), ": min chunk size (byte)")
     ("max-chunk-size", po::value<int>(), ": max chunk size (byte)")
@@ -254,19 +270,30 @@ class EstimateDedupRatio : public CrawlerThread
   string fp_algo;
   uint64_t chunk_size;
   uint64_t max_seconds;
+  unsigned read_ahead;
+
+  /// an object whose first max_read_size bytes are being read
+  struct PendingRead {
+    string oid;
+    bufferlist bl;
+    std::unique_ptr<AioCompletion> c;
+  };
+  void start_read(PendingRead& r);
+  void finish_read(PendingRead& r);
 
 public:
   EstimateDedupRatio(
     IoCtx& io_ctx, int n, int m, ObjectCursor begin, ObjectCursor end,
     string chunk_algo, string fp_algo, uint64_t chunk_size, int32_t report_period,
     uint64_t num_objects, uint64_t max_read_size,
-    uint64_t max_seconds):
+    uint64_t max_seconds, unsigned read_ahead):
     CrawlerThread(io_ctx, n, m, begin, end, report_period, num_objects,
 		  max_read_size),
     chunk_algo(chunk_algo),
     fp_algo(fp_algo),
     chunk_size(chunk_size),
-    max_seconds(max_seconds) {
+    max_seconds(max_seconds),
+    read_ahead(read_ahead) {
   }
 
   void* entry() {
@@ -341,6 +368,32 @@ static void handle_signal(int signum)
   }
 }
 
+void EstimateDedupRatio::start_read(PendingRead& r)
+{
+  r.c.reset(Rados::aio_create_completion());
+  io_ctx.aio_read(r.oid, r.c.get(), &r.bl, max_read_size, 0);
+}
+
+void EstimateDedupRatio::finish_read(PendingRead& r)
+{
+  r.c->wait_for_complete();
+  int ret = r.c->get_return_value();
+  if (ret < 0 || (uint64_t)ret < max_read_size) {
+    return;
+  }
+  // read the rest of objects larger than a single read
+  uint64_t offset = ret;
+  while (true) {
+    bufferlist t;
+    ret = io_ctx.read(r.oid, t, max_read_size, offset);
+    if (ret <= 0) {
+      break;
+    }
+    offset += ret;
+    r.bl.claim_append(t);
+  }
+}
+
 void EstimateDedupRatio::estimate_dedup_ratio()
 {
   ObjectCursor shard_start;
@@ -367,68 +420,79 @@ void EstimateDedupRatio::estimate_dedup_ratio()
     next_report += report_period;
   }
 
+  // objects are read read_ahead objects ahead of the one being chunked
+  // and fingerprinted, so that the OSDs work while we hash
   ObjectCursor c(shard_start);
-  while (c < shard_end)
-  {
-    std::vector<ObjectItem> result;
-    int r = io_ctx.object_list(c, shard_end, 12, {}, &result, &c);
-    if (r < 0 ){
-      cerr << "error object_list : " << cpp_strerror(r) << std::endl;
-      return;
+  std::deque<ObjectItem> listed;
+  std::deque<PendingRead> reads;
+  auto drain = [&reads] {
+    for (auto& r : reads) {
+      r.c->wait_for_complete();
     }
-
-    unsigned op_size = max_read_size;
-
-    for (const auto & i : result) {
-      const auto &oid = i.oid;
-
-      utime_t now = ceph_clock_now();
-      if (max_seconds && now > end) {
-	m_stop = true;
+  };
+  while (true) {
+    while (reads.size() <= read_ahead) {
+      if (listed.empty() && c < shard_end) {
+	std::vector<ObjectItem> result;
+	int r = io_ctx.object_list(c, shard_end, 12, {}, &result, &c);
+	if (r < 0 ){
+	  cerr << "error object_list : " << cpp_strerror(r) << std::endl;
+	  drain();
+	  return;
+	}
+	listed.insert(listed.end(), result.begin(), result.end());
       }
-      if (m_stop) {
-	return;
+      if (listed.empty()) {
+	break;
       }
+      reads.emplace_back();
+      reads.back().oid = listed.front().oid;
+      listed.pop_front();
+      start_read(reads.back());
+    }
+    if (reads.empty()) {
+      break;
+    }
 
-      if (n == 0 && // first thread only
-	  next_report != utime_t() && now > next_report) {
-	cerr << (int)(now - start) << "s : read "
-	     << dedup_estimates.begin()->second.total_bytes << " bytes so far..."
-	     << std::endl;
-	print_dedup_estimate(cerr, chunk_algo);
-	next_report = now;
-	next_report += report_period;
-      }
+    utime_t now = ceph_clock_now();
+    if (max_seconds && now > end) {
+      m_stop = true;
+    }
+    if (m_stop) {
+      drain();
+      return;
+    }
 
-      // read entire object
-      bufferlist bl;
-      uint64_t offset = 0;
-      while (true) {
-	bufferlist t;
-	int ret = io_ctx.read(oid, t, op_size, offset);
-	if (ret <= 0) {
-	  break;
-	}
-	offset += ret;
-	bl.claim_append(t);
-      }
-      examined_objects++;
-      examined_bytes += bl.length();
+    if (n == 0 && // first thread only
+	next_report != utime_t() && now > next_report) {
+      cerr << (int)(now - start) << "s : read "
+	   << dedup_estimates.begin()->second.total_bytes << " bytes so far..."
+	   << std::endl;
+      print_dedup_estimate(cerr, chunk_algo);
+      next_report = now;
+      next_report += report_period;
+    }
 
-      // do the chunking
-      for (auto& i : dedup_estimates) {
-	vector<pair<uint64_t, uint64_t>> chunks;
-	i.second.cdc->calc_chunks(bl, &chunks);
+    // the read owns a pointer to its bufferlist until it completes
+    finish_read(reads.front());
+    PendingRead r = std::move(reads.front());
+    reads.pop_front();
+    const auto& oid = r.oid;
+    bufferlist& bl = r.bl;
+    examined_objects++;
+    examined_bytes += bl.length();
+
+    // do the chunking
+    for (auto& i : dedup_estimates) {
+      vector<pair<uint64_t, uint64_t>> chunks;
+      i.second.cdc->calc_chunks(bl, &chunks);
+      i.second.add_chunks(bl, chunks, fp_algo);
+      if (debug) {
 	for (auto& p : chunks) {
-	  bufferlist chunk;
-	  chunk.substr_of(bl, p.first, p.second);
-	  i.second.add_chunk(chunk, fp_algo);
-	  if (debug) {
-	    cout << " " << oid <<  " " << p.first << "~" << p.second << std::endl;
-	  }
+	  cout << " " << oid <<  " " << p.first << "~" << p.second << std::endl;
 	}
-	++i.second.total_objects;
       }
+      ++i.second.total_objects;
     }
   }
 }
@@ -987,6 +1051,7 @@ int estimate_dedup_ratio(const po::variables_map &opts)
   uint32_t report_period = default_report_period;
   uint64_t max_read_size = default_op_size;
   uint64_t max_seconds = 0;
+  unsigned read_ahead = default_read_ahead;
   int ret;
   std::map<std::string, std::string>::const_iterator i;
   bool debug = false;
@@ -1035,6 +1100,9 @@ int estimate_dedup_ratio(const po::variables_map &opts)
   } else {
     cout << default_op_size << " is set as max-read-size by default" << std::endl;
   }
+  if (opts.count("read-ahead")) {
+    read_ahead = opts["read-ahead"].as<int>();
+  }
   if (opts.count("debug")) {
     debug = true;
   }
@@ -1098,7 +1166,7 @@ int estimate_dedup_ratio(const po::variables_map &opts)
       new EstimateDedupRatio(io_ctx, i, max_thread, begin, end,
 			     chunk_algo, fp_algo, chunk_size,
 			     report_period, s.num_objects, max_read_size,
-			     max_seconds));
+			     max_seconds, read_ahead));
     ptr->create("estimate_thread");
     ptr->set_debug(debug);
     estimate_threads.push_back(move(ptr));
@@ -45,12 +45,13 @@ void usage(const char *pname)
     << "  rm-prefix <prefix>\n"
     << "  store-copy <path> [num-keys-per-tx] [rocksdb|...] \n"
     << "  store-crc <path>\n"
-    << "  compact\n"
+    << "  compact [threads]\n"
     << "  compact-prefix <prefix>\n"
     << "  compact-range <prefix> <start> <end>\n"
     << "  destructive-repair  (use only as last resort! may corrupt healthy data)\n"
     << "  stats\n"
     << "  histogram [prefix]\n"
+    << "  verify-checksums [threads]\n"
     << std::endl;
 }
 
@@ -329,7 +330,16 @@ int main(int argc, const char *argv[])
     std::cout << "store at '" << argv[4] << "' crc " << crc << std::endl;
 
   } else if (cmd == "compact") {
-    st.compact();
+    int threads = 1;
+    if (argc > 4) {
+      string err;
+      threads = strict_strtol(argv[4], 10, &err);
+      if (!err.empty() || threads < 1) {
+        std::cerr << "invalid threads: " << argv[4] << std::endl;
+        return 1;
+      }
+    }
+    st.compact(threads);
   } else if (cmd == "compact-prefix") {
     if (argc < 5) {
       usage(argv[0]);
@@ -353,6 +363,19 @@ int main(int argc, const char *argv[])
     if (argc > 4)
       prefix = url_unescape(argv[4]);
     st.build_size_histogram(prefix);
+  } else if (cmd == "verify-checksums") {
+    int threads = 1;
+    if (argc > 4) {
+      string err;
+      threads = strict_strtol(argv[4], 10, &err);
+      if (!err.empty() || threads < 1) {
+        std::cerr << "invalid threads: " << argv[4] << std::endl;
+        return 1;
+      }
+    }
+    if (st.verify_checksums(threads) != 0) {
+      return 1;
+    }
   } else {
     std::cerr << "Unrecognized command: " << cmd << std::endl;
     return 1;
@@ -1517,14 +1517,45 @@ int ObjectStoreTool::get_object(ObjectStore *store,
     }
   }
   if (!dry_run) {
-    wait_until_done(t, [&] {
-      store->queue_transaction(ch, std::move(*t));
-      ch->flush();
-    });
+    queue_import_transaction(store, ch, std::move(*t));
   }
   return 0;
 }
 
+void ObjectStoreTool::queue_import_transaction(
+  ObjectStore *store,
+  ObjectStore::CollectionHandle& ch,
+  ObjectStore::Transaction&& t)
+{
+  constexpr uint64_t max_in_flight = 64;
+  constexpr uint64_t max_in_flight_bytes = 256 << 20;
+  uint64_t bytes = t.get_num_bytes();
+  {
+    std::unique_lock l{import_lock};
+    import_cond.wait(l, [&] {
+      // always let one through, however large
+      return import_in_flight == 0 ||
+	(import_in_flight < max_in_flight &&
+	 import_in_flight_bytes + bytes <= max_in_flight_bytes);
+    });
+    ++import_in_flight;
+    import_in_flight_bytes += bytes;
+  }
+  t.register_on_complete(make_lambda_context([this, bytes](int) {
+    std::lock_guard l{import_lock};
+    --import_in_flight;
+    import_in_flight_bytes -= bytes;
+    import_cond.notify_all();
+  }));
+  store->queue_transaction(ch, std::move(t));
+}
+
+void ObjectStoreTool::wait_for_imports()
+{
+  std::unique_lock l{import_lock};
+  import_cond.wait(l, [this] { return import_in_flight == 0; });
+}
+
 int dump_pg_metadata(Formatter *formatter, bufferlist &bl, metadata_section &ms)
 {
   auto ebliter = bl.cbegin();
@@ -1927,7 +1958,10 @@ int ObjectStoreTool::do_import(ObjectStore *store, OSDSuperblock& sb,
       ceph_assert(found_metadata);
       ret = get_object(store, driver, mapper, coll, ebl, ms.osdmap,
 		       &skipped_objects);
-      if (ret) return ret;
+      if (ret) {
+	wait_for_imports();
+	return ret;
+      }
       break;
     case TYPE_PG_METADATA:
       ret = get_pg_metadata(store, ebl, ms, sb, pgid);
@@ -2093,6 +2127,7 @@ int ObjectStoreTool::do_import(ObjectStore *store, OSDSuperblock& sb,
       // make sure we flush onreadable items before mapper/driver are destroyed.
       ch->flush();
     });
+    wait_for_imports();
   }
   return 0;
 }
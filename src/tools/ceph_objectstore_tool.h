@@ -15,6 +15,9 @@
 #ifndef CEPH_OBJECTSTORE_TOOL_H_
 #define CEPH_OBJECTSTORE_TOOL_H_
 
+#include <condition_variable>
+#include <mutex>
+
 #include "RadosDump.h"
 
 class ObjectStoreTool : public RadosDump
@@ -39,6 +42,18 @@ class ObjectStoreTool : public RadosDump
     int export_file(
         ObjectStore *store, coll_t cid, ghobject_t &obj);
     int export_files(ObjectStore *store, coll_t coll);
+
+  private:
+    // imported objects commit while the next ones are read from the
+    // export, up to a bounded number and size of transactions
+    std::mutex import_lock;
+    std::condition_variable import_cond;
+    uint64_t import_in_flight = 0;
+    uint64_t import_in_flight_bytes = 0;
+    void queue_import_transaction(ObjectStore *store,
+				  ObjectStore::CollectionHandle& ch,
+				  ObjectStore::Transaction&& t);
+    void wait_for_imports();
 };
 
 #endif // CEPH_OBJECSTORE_TOOL_H_
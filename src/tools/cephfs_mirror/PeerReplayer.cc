@@ -1031,6 +1031,136 @@ int PeerReplayer::propagate_deleted_entries(const std::string &dir_root,
   return r;
 }
 
+int PeerReplayer::open_snapdiff(const std::string &dir_root, const std::string &epath,
+                                const Snapshot &current, const Snapshot &prev,
+                                ceph_snapdiff_info *sd_info) {
+  dout(20) << ": dir_root=" << dir_root << ", epath=" << epath << ", current="
+           << current << ", prev=" << prev << dendl;
+
+  int r = ceph_open_snapdiff(m_local_mount, dir_root.c_str(), epath.c_str(),
+                             prev.first.c_str(), current.first.c_str(), sd_info);
+  if (r < 0) {
+    derr << ": failed to open snapdiff for directory=" << epath << ": "
+         << cpp_strerror(r) << dendl;
+  }
+  return r;
+}
+
+int PeerReplayer::close_sync_entry(SyncEntry &entry) {
+  int r;
+  if (entry.use_snapdiff) {
+    r = ceph_close_snapdiff(&entry.sd_info);
+  } else {
+    r = ceph_closedir(m_local_mount, entry.dirp);
+  }
+  if (r < 0) {
+    derr << ": failed to close local directory=" << entry.epath << dendl;
+  }
+  return r;
+}
+
+int PeerReplayer::readdir_snapdiff(const std::string &dir_root, SyncEntry &entry,
+                                   const Snapshot &current, const FHandles &fh,
+                                   std::string *e_name, struct ceph_statx *stx) {
+  auto purge_remote = [this, &dir_root, &fh](const std::string &epath, mode_t mode) {
+    dout(5) << ": purging remote entry=" << epath << dendl;
+    int r;
+    if (S_ISDIR(mode)) {
+      r = cleanup_remote_dir(dir_root, epath, fh);
+    } else {
+      r = ceph_unlinkat(m_remote_mount, fh.r_fd_dir_root, epath.c_str(), 0);
+    }
+    if (r < 0 && r != -ENOENT) {
+      derr << ": failed to cleanup remote entry=" << epath << ": "
+           << cpp_strerror(r) << dendl;
+      return r;
+    }
+    return 0;
+  };
+
+  int r;
+  while (true) {
+    if (should_backoff(dir_root, &r)) {
+      dout(0) << ": backing off r=" << r << dendl;
+      return r;
+    }
+
+    ceph_snapdiff_entry_t sd_entry;
+    r = ceph_readdir_snapdiff(&entry.sd_info, &sd_entry);
+    if (r < 0) {
+      derr << ": failed to read snapdiff for directory=" << entry.epath << ": "
+           << cpp_strerror(r) << dendl;
+      return r;
+    }
+    if (r == 0) {
+      return 0;
+    }
+
+    auto d_name = std::string(sd_entry.dir_entry.d_name);
+    if (d_name == "." || d_name == "..") {
+      continue;
+    }
+
+    auto epath = entry_path(entry.epath, d_name);
+    r = ceph_statxat(m_local_mount, fh.c_fd, epath.c_str(), stx,
+                     CEPH_STATX_MODE | CEPH_STATX_UID | CEPH_STATX_GID |
+                     CEPH_STATX_SIZE | CEPH_STATX_ATIME | CEPH_STATX_MTIME,
+                     AT_STATX_DONT_SYNC | AT_SYMLINK_NOFOLLOW);
+    if (r < 0 && r != -ENOENT) {
+      derr << ": failed to stat local (cur) entry=" << epath << ": "
+           << cpp_strerror(r) << dendl;
+      return r;
+    }
+
+    struct ceph_statx pstx;
+    if (r == 0) {
+      if (sd_entry.snapid != current.second) {
+        // older version of an entry that still exists -- if it was
+        // modified, the diff lists it again as of the current snapshot.
+        continue;
+      }
+
+      // changed inode type -- purge the remote entry before the
+      // caller synchronizes the new one.
+      r = ceph_statxat(fh.p_mnt, fh.p_fd, epath.c_str(), &pstx,
+                       CEPH_STATX_MODE, AT_STATX_DONT_SYNC | AT_SYMLINK_NOFOLLOW);
+      if (r < 0 && r != -ENOENT && r != -ENOTDIR) {
+        derr << ": failed to stat prev entry=" << epath << ": " << cpp_strerror(r)
+             << dendl;
+        return r;
+      }
+      if (r == 0 && (pstx.stx_mode & S_IFMT) != (stx->stx_mode & S_IFMT)) {
+        dout(5) << ": mode mismatch for entry=" << epath << dendl;
+        r = purge_remote(epath, pstx.stx_mode);
+        if (r < 0) {
+          return r;
+        }
+      }
+
+      *e_name = d_name;
+      return 1;
+    }
+
+    // missing in the current snapshot -- deleted since the previous one
+    r = ceph_statxat(fh.p_mnt, fh.p_fd, epath.c_str(), &pstx,
+                     CEPH_STATX_MODE, AT_STATX_DONT_SYNC | AT_SYMLINK_NOFOLLOW);
+    if (r == -ENOENT) {
+      // neither in the previous snapshot (created and removed in between)
+      continue;
+    }
+    if (r < 0) {
+      derr << ": failed to stat prev entry=" << epath << ": " << cpp_strerror(r)
+           << dendl;
+      return r;
+    }
+    dout(5) << ": entry=" << epath << " missing in current snapshot" << dendl;
+    r = purge_remote(epath, pstx.stx_mode);
+    if (r < 0) {
+      return r;
+    }
+  }
+}
+
 int PeerReplayer::open_dir(MountRef mnt, const std::string &dir_path,
                            boost::optional<uint64_t> snap_id) {
   dout(20) << ": dir_path=" << dir_path << dendl;
@@ -1198,16 +1328,29 @@ int PeerReplayer::do_synchronize(const std::string &dir_root, const Snapshot &cu
     return r;
   }
 
-  ceph_dir_result *tdirp;
-  r = ceph_fdopendir(m_local_mount, fh.c_fd, &tdirp);
-  if (r < 0) {
-    derr << ": failed to open local snap=" << current.first << ": " << cpp_strerror(r)
-         << dendl;
-    return r;
-  }
+  // with the previous snapshot at hand, only walk what the MDS reports
+  // as changed between the two instead of comparing every entry.
+  bool use_snapdiff = prev && fh.p_mnt == m_local_mount &&
+    g_ceph_context->_conf.get_val<bool>("cephfs_mirror_use_snapdiff");
 
   std::stack<SyncEntry> sync_stack;
-  sync_stack.emplace(SyncEntry(".", tdirp, tstx));
+  if (use_snapdiff) {
+    ceph_snapdiff_info sd_info;
+    r = open_snapdiff(dir_root, ".", current, *prev, &sd_info);
+    if (r < 0) {
+      return r;
+    }
+    sync_stack.emplace(SyncEntry(".", sd_info, tstx));
+  } else {
+    ceph_dir_result *tdirp;
+    r = ceph_fdopendir(m_local_mount, fh.c_fd, &tdirp);
+    if (r < 0) {
+      derr << ": failed to open local snap=" << current.first << ": " << cpp_strerror(r)
+           << dendl;
+      return r;
+    }
+    sync_stack.emplace(SyncEntry(".", tdirp, tstx));
+  }
   while (!sync_stack.empty()) {
     if (should_backoff(dir_root, &r)) {
       dout(0) << ": backing off r=" << r << dendl;
@@ -1220,8 +1363,9 @@ int PeerReplayer::do_synchronize(const std::string &dir_root, const Snapshot &cu
     dout(20) << ": top of stack path=" << entry.epath << dendl;
     if (entry.is_directory()) {
       // entry is a directory -- propagate deletes for missing entries
-      // (and changed inode types) to the remote filesystem.
-      if (!entry.needs_remote_sync()) {
+      // (and changed inode types) to the remote filesystem. the snapdiff
+      // stream reports those along with the changed entries.
+      if (!entry.use_snapdiff && !entry.needs_remote_sync()) {
         r = propagate_deleted_entries(dir_root, entry.epath, fh);
         if (r < 0 && r != -ENOENT) {
           derr << ": failed to propagate missing dirs: " << cpp_strerror(r) << dendl;
@@ -1232,7 +1376,7 @@ int PeerReplayer::do_synchronize(const std::string &dir_root, const Snapshot &cu
 
       struct ceph_statx stx;
       struct dirent de;
-      while (true) {
+      while (!entry.use_snapdiff) {
         r = ceph_readdirplus_r(m_local_mount, entry.dirp, &de, &stx,
                                CEPH_STATX_MODE | CEPH_STATX_UID | CEPH_STATX_GID |
                                CEPH_STATX_SIZE | CEPH_STATX_ATIME | CEPH_STATX_MTIME,
@@ -1251,12 +1395,13 @@ int PeerReplayer::do_synchronize(const std::string &dir_root, const Snapshot &cu
           break;
         }
       }
+      if (entry.use_snapdiff) {
+        r = readdir_snapdiff(dir_root, entry, current, fh, &e_name, &stx);
+      }
 
       if (r == 0) {
         dout(10) << ": done for directory=" << entry.epath << dendl;
-        if (ceph_closedir(m_local_mount, entry.dirp) < 0) {
-          derr << ": failed to close local directory=" << entry.epath << dendl;
-        }
+        close_sync_entry(entry);
         sync_stack.pop();
         continue;
       }
@@ -1270,14 +1415,30 @@ int PeerReplayer::do_synchronize(const std::string &dir_root, const Snapshot &cu
         if (r < 0) {
           break;
         }
-        ceph_dir_result *dirp;
-        r = opendirat(m_local_mount, fh.c_fd, epath, AT_SYMLINK_NOFOLLOW, &dirp);
-        if (r < 0) {
-          derr << ": failed to open local directory=" << epath << ": "
-               << cpp_strerror(r) << dendl;
-          break;
+        // a directory that is new (or was not a directory) since the
+        // previous snapshot has nothing to diff against -- read it
+        // in full.
+        struct ceph_statx pstx;
+        if (entry.use_snapdiff &&
+            ceph_statxat(fh.p_mnt, fh.p_fd, epath.c_str(), &pstx, CEPH_STATX_MODE,
+                         AT_STATX_DONT_SYNC | AT_SYMLINK_NOFOLLOW) == 0 &&
+            S_ISDIR(pstx.stx_mode)) {
+          ceph_snapdiff_info sd_info;
+          r = open_snapdiff(dir_root, epath, current, *prev, &sd_info);
+          if (r < 0) {
+            break;
+          }
+          sync_stack.emplace(SyncEntry(epath, sd_info, stx));
+        } else {
+          ceph_dir_result *dirp;
+          r = opendirat(m_local_mount, fh.c_fd, epath, AT_SYMLINK_NOFOLLOW, &dirp);
+          if (r < 0) {
+            derr << ": failed to open local directory=" << epath << ": "
+                 << cpp_strerror(r) << dendl;
+            break;
+          }
+          sync_stack.emplace(SyncEntry(epath, dirp, stx));
         }
-        sync_stack.emplace(SyncEntry(epath, dirp, stx));
       } else {
         sync_stack.emplace(SyncEntry(epath, stx));
       }
@@ -1308,9 +1469,7 @@ int PeerReplayer::do_synchronize(const std::string &dir_root, const Snapshot &cu
     auto &entry = sync_stack.top();
     if (entry.is_directory()) {
       dout(20) << ": closing local directory=" << entry.epath << dendl;
-      if (ceph_closedir(m_local_mount, entry.dirp) < 0) {
-        derr << ": failed to close local directory=" << entry.epath << dendl;
-      }
+      close_sync_entry(entry);
     }
 
     sync_stack.pop();
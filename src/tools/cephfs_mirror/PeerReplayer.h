@@ -101,6 +101,10 @@ private:
   struct SyncEntry {
     std::string epath;
     ceph_dir_result *dirp; // valid for directories
+    // set for directories walked by snapshot diff against the
+    // previous snapshot rather than by reading @dirp.
+    bool use_snapdiff = false;
+    ceph_snapdiff_info sd_info;
     struct ceph_statx stx;
     // set by incremental sync _after_ ensuring missing entries
     // in the currently synced snapshot have been propagated to
@@ -119,6 +123,14 @@ private:
         dirp(dirp),
         stx(stx) {
     }
+    SyncEntry(std::string_view path,
+              const ceph_snapdiff_info &sd_info,
+              const struct ceph_statx &stx)
+      : epath(path),
+        use_snapdiff(true),
+        sd_info(sd_info),
+        stx(stx) {
+    }
 
     bool is_directory() const {
       return S_ISDIR(stx.stx_mode);
@@ -294,6 +306,14 @@ private:
   int should_sync_entry(const std::string &epath, const struct ceph_statx &cstx,
                         const FHandles &fh, bool *need_data_sync, bool *need_attr_sync);
 
+  int open_snapdiff(const std::string &dir_root, const std::string &epath,
+                    const Snapshot &current, const Snapshot &prev,
+                    ceph_snapdiff_info *sd_info);
+  int close_sync_entry(SyncEntry &entry);
+  int readdir_snapdiff(const std::string &dir_root, SyncEntry &entry,
+                       const Snapshot &current, const FHandles &fh,
+                       std::string *e_name, struct ceph_statx *stx);
+
   int open_dir(MountRef mnt, const std::string &dir_path, boost::optional<uint64_t> snap_id);
   int pre_sync_check_and_open_handles(const std::string &dir_root, const Snapshot &current,
                                       boost::optional<Snapshot> prev, FHandles *fh);
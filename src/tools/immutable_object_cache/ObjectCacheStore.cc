@@ -58,6 +58,8 @@ ObjectCacheStore::ObjectCacheStore(CephContext *cct)
 
   uint64_t max_inflight_ops =
     m_cct->_conf.get_val<uint64_t>("immutable_object_cache_max_inflight_ops");
+  uint64_t promote_threshold =
+    m_cct->_conf.get_val<uint64_t>("immutable_object_cache_promote_threshold");
 
   uint64_t limit = 0;
   if ((limit = m_cct->_conf.get_val<uint64_t>
@@ -88,7 +90,7 @@ ObjectCacheStore::ObjectCacheStore(CephContext *cct)
     cache_watermark = 0.9;
   }
   m_policy = new SimplePolicy(m_cct, cache_max_size, max_inflight_ops,
-                              cache_watermark);
+                              cache_watermark, promote_threshold);
 }
 
 ObjectCacheStore::~ObjectCacheStore() {
@@ -14,13 +14,16 @@ namespace ceph {
 namespace immutable_obj_cache {
 
 SimplePolicy::SimplePolicy(CephContext *cct, uint64_t cache_size,
-                           uint64_t max_inflight, double watermark)
+                           uint64_t max_inflight, double watermark,
+                           uint32_t promote_threshold)
   : cct(cct), m_watermark(watermark), m_max_inflight_ops(max_inflight),
-    m_max_cache_size(cache_size) {
+    m_max_cache_size(cache_size),
+    m_promote_threshold(std::max(promote_threshold, 1u)) {
 
   ldout(cct, 20) << "max cache size= " << m_max_cache_size
                  << " ,watermark= " << m_watermark
-                 << " ,max inflight ops= " << m_max_inflight_ops << dendl;
+                 << " ,max inflight ops= " << m_max_inflight_ops
+                 << " ,promote threshold= " << m_promote_threshold << dendl;
 
   m_cache_size = 0;
 
@@ -46,6 +49,11 @@ cache_status_t SimplePolicy::alloc_entry(std::string file_name) {
     return OBJ_CACHE_SKIP;
   }
 
+  if (!should_promote(file_name)) {
+    ldout(cct, 20) << "not accessed often enough yet: " << file_name << dendl;
+    return OBJ_CACHE_SKIP;
+  }
+
   if ((m_cache_size < m_max_cache_size) &&
       (inflight_ops < m_max_inflight_ops)) {
     Entry* entry = new Entry();
@@ -60,6 +68,23 @@ cache_status_t SimplePolicy::alloc_entry(std::string file_name) {
   return OBJ_CACHE_SKIP;
 }
 
+// called with m_cache_map_lock held exclusively
+bool SimplePolicy::should_promote(const std::string& file_name) {
+  if (m_promote_threshold <= 1) {
+    return true;
+  }
+
+  auto [it, inserted] = m_access_count.try_emplace(file_name, 0);
+  if (inserted) {
+    m_access_history.push_back(file_name);
+    while (m_access_history.size() > MAX_ACCESS_HISTORY) {
+      m_access_count.erase(m_access_history.front());
+      m_access_history.pop_front();
+    }
+  }
+  return ++it->second >= m_promote_threshold;
+}
+
 cache_status_t SimplePolicy::lookup_object(std::string file_name) {
   ldout(cct, 20) << "lookup: " << file_name << dendl;
 
@@ -76,6 +101,7 @@ cache_status_t SimplePolicy::lookup_object(std::string file_name) {
 
   if (entry->status == OBJ_CACHE_PROMOTED || entry->status == OBJ_CACHE_DNE) {
     // bump pos in lru on hit
+    std::lock_guard lru_locker{m_lru_lock};
     m_promoted_lru.lru_touch(entry);
   }
 
@@ -9,6 +9,7 @@
 #include "include/lru.h"
 #include "Policy.h"
 
+#include <list>
 #include <unordered_map>
 #include <string>
 
@@ -18,7 +19,7 @@ namespace immutable_obj_cache {
 class SimplePolicy : public Policy {
  public:
   SimplePolicy(CephContext *cct, uint64_t block_num, uint64_t max_inflight,
-               double watermark);
+               double watermark, uint32_t promote_threshold = 1);
   ~SimplePolicy();
 
   cache_status_t lookup_object(std::string file_name);
@@ -39,6 +40,7 @@ class SimplePolicy : public Policy {
 
  private:
   cache_status_t alloc_entry(std::string file_name);
+  bool should_promote(const std::string& file_name);
 
   class Entry : public LRUObject {
    public:
@@ -54,12 +56,23 @@ class SimplePolicy : public Policy {
   uint64_t m_max_cache_size;
   std::atomic<uint64_t> inflight_ops = 0;
 
+  // objects must be looked up this many times before they are promoted;
+  // misses are counted in a bounded FIFO history so that one-off reads
+  // (e.g. a full scan of the parent) don't wash out the hot set
+  uint32_t m_promote_threshold;
+  static constexpr size_t MAX_ACCESS_HISTORY = 1 << 16;
+  std::unordered_map<std::string, uint32_t> m_access_count;
+  std::list<std::string> m_access_history;
+
   std::unordered_map<std::string, Entry*> m_cache_map;
   ceph::shared_mutex m_cache_map_lock =
     ceph::make_shared_mutex("rbd::cache::SimplePolicy::m_cache_map_lock");
 
   std::atomic<uint64_t> m_cache_size;
 
+  // lookups touch the LRU while holding m_cache_map_lock shared
+  ceph::mutex m_lru_lock =
+    ceph::make_mutex("rbd::cache::SimplePolicy::m_lru_lock");
   LRU m_promoted_lru;
 };
 
@@ -357,9 +357,9 @@ int StoreTool::copy_store_to(const string& type, const string& other_path,
   return 0;
 }
 
-void StoreTool::compact()
+void StoreTool::compact(unsigned threads)
 {
-  db->compact();
+  db->compact_parallel(threads);
 }
 
 void StoreTool::compact_prefix(const string& prefix)
@@ -378,3 +378,17 @@ int StoreTool::destructive_repair()
 {
   return db->repair(std::cout);
 }
+
+int StoreTool::verify_checksums(unsigned threads)
+{
+  auto start = coarse_mono_clock::now();
+  int r = db->verify_checksums(threads, std::cout);
+  ceph::timespan duration = coarse_mono_clock::now() - start;
+  if (r < 0) {
+    std::cerr << "failed to verify checksums: " << cpp_strerror(r) << std::endl;
+    return r;
+  }
+  std::cout << r << " damaged files found in " << duration << " seconds"
+	    << std::endl;
+  return r;
+}
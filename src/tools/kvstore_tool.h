@@ -69,12 +69,13 @@ public:
                      const std::string& other_path, const int duration) const;
   int copy_store_to(const std::string& type, const std::string& other_path,
                     const int num_keys_per_tx, const std::string& other_type);
-  void compact();
+  void compact(unsigned threads = 1);
   void compact_prefix(const std::string& prefix);
   void compact_range(const std::string& prefix,
 		     const std::string& start,
 		     const std::string& end);
   int destructive_repair();
+  int verify_checksums(unsigned threads);
 
   int print_stats() const;
   int build_size_histogram(const std::string& prefix) const;
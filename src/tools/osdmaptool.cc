@@ -19,12 +19,15 @@
 #include "common/errno.h"
 #include "common/safe_io.h"
 #include "include/random.h"
+#include "include/stringify.h"
 #include "mon/health_check.h"
 #include <time.h>
 #include <algorithm>
 
+#include "common/WorkQueue.h"
 #include "global/global_init.h"
 #include "osd/OSDMap.h"
+#include "osd/OSDMapMapping.h"
 
 using namespace std;
 
@@ -70,9 +73,142 @@ void usage()
   cout << "   --read <file>           calculate pg upmap entries to balance pg primaries" << std::endl;
   cout << "   --read-pool <poolname>  specify which pool the read balancer should adjust" << std::endl;
   cout << "   --vstart                prefix upmap and read output with './bin/'" << std::endl;
+  cout << "   --simulate [--pool <poolid>] [--fail-osds <osdid>[,<osdid>,<...>]] [--fail-each] [--candidate <file>]" << std::endl;
+  cout << "                           compare placement, data movement and balance of the map" << std::endl;
+  cout << "                           with each OSD failure set and candidate map, in parallel" << std::endl;
+  cout << "   --sim-threads <count>   threads mapping pgs for --simulate [default: all cpus]" << std::endl;
+  cout << "   --sim-format <format>   output format of --simulate [default: json-pretty]" << std::endl;
   exit(1);
 }
 
+/// a map to compare with the base map in --simulate
+struct SimScenario {
+  std::string name;
+  std::vector<int> failed;  ///< osds marked down and out, if any
+  OSDMap map;
+  OSDMapMapping mapping;
+  std::unique_ptr<ParallelPGMapper::Job> job;
+  utime_t elapsed;
+};
+
+/// pg shards per osd of @mapping, against a target proportional to weight
+static void dump_sim_balance(Formatter *f, const OSDMap& m,
+			     const OSDMapMapping& mapping, int64_t pool)
+{
+  vector<unsigned> count(m.get_max_osd(), 0);
+  uint64_t total = 0;
+  for (auto& [id, p] : m.get_pools()) {
+    if (pool != -1 && id != pool)
+      continue;
+    vector<int> up;
+    for (unsigned ps = 0; ps < p.get_pg_num(); ++ps) {
+      mapping.get(pg_t(ps, id), &up, nullptr, nullptr, nullptr);
+      for (auto osd : up) {
+	if (osd != CRUSH_ITEM_NONE && osd < m.get_max_osd()) {
+	  count[osd]++;
+	  total++;
+	}
+      }
+    }
+  }
+  double weight_sum = 0;
+  vector<double> weight(m.get_max_osd(), 0);
+  for (int i = 0; i < m.get_max_osd(); ++i) {
+    if (m.is_up(i) && m.is_in(i) && m.crush->get_item_weightf(i) > 0) {
+      weight[i] = m.crush->get_item_weightf(i) * m.get_weightf(i);
+      weight_sum += weight[i];
+    }
+  }
+  int osds = 0, max_osd = -1;
+  double dev = 0, max_dev = 0;
+  for (int i = 0; i < m.get_max_osd(); ++i) {
+    if (weight[i] <= 0)
+      continue;
+    osds++;
+    double target = total * weight[i] / weight_sum;
+    double d = count[i] - target;
+    dev += d * d;
+    if (max_osd < 0 || fabs(d) > fabs(max_dev)) {
+      max_osd = i;
+      max_dev = d;
+    }
+  }
+  f->open_object_section("balance");
+  f->dump_int("osds", osds);
+  f->dump_unsigned("pg_shards", total);
+  f->dump_float("avg", osds ? (double)total / osds : 0);
+  f->dump_float("stddev", osds ? sqrt(dev / osds) : 0);
+  f->dump_int("max_deviation_osd", max_osd);
+  f->dump_float("max_deviation", max_dev);
+  f->close_section();
+}
+
+/// placement of @sc compared to @base
+static void dump_sim_scenario(Formatter *f, const OSDMap& base,
+			      const OSDMapMapping& base_mapping,
+			      const SimScenario& sc, int64_t pool)
+{
+  f->open_object_section("scenario");
+  f->dump_string("name", sc.name);
+  f->open_array_section("failed_osds");
+  for (auto osd : sc.failed) {
+    f->dump_int("osd", osd);
+  }
+  f->close_section();
+  f->dump_float("map_seconds", sc.elapsed);
+  uint64_t pgs = 0, remapped = 0, moved = 0, undersized = 0;
+  f->open_array_section("pools");
+  for (auto& [id, p] : base.get_pools()) {
+    if (pool != -1 && id != pool)
+      continue;
+    const pg_pool_t *q = sc.map.get_pg_pool(id);
+    if (!q || q->get_pg_num() != p.get_pg_num()) {
+      // split, merged or removed: nothing to compare pg by pg
+      continue;
+    }
+    uint64_t pool_remapped = 0, pool_moved = 0, pool_undersized = 0;
+    vector<int> from, to;
+    for (unsigned ps = 0; ps < p.get_pg_num(); ++ps) {
+      pg_t pgid(ps, id);
+      base_mapping.get(pgid, &from, nullptr, nullptr, nullptr);
+      sc.mapping.get(pgid, &to, nullptr, nullptr, nullptr);
+      unsigned shards = 0;
+      for (unsigned i = 0; i < to.size(); ++i) {
+	if (to[i] == CRUSH_ITEM_NONE)
+	  continue;
+	shards++;
+	bool had = q->can_shift_osds() ?
+	  std::find(from.begin(), from.end(), to[i]) != from.end() :
+	  i < from.size() && from[i] == to[i];
+	if (!had)
+	  pool_moved++;
+      }
+      if (from != to)
+	pool_remapped++;
+      if (shards < q->get_size())
+	pool_undersized++;
+    }
+    f->open_object_section("pool");
+    f->dump_int("pool", id);
+    f->dump_unsigned("pgs", p.get_pg_num());
+    f->dump_unsigned("pgs_remapped", pool_remapped);
+    f->dump_unsigned("shards_moved", pool_moved);
+    f->dump_unsigned("pgs_undersized", pool_undersized);
+    f->close_section();
+    pgs += p.get_pg_num();
+    remapped += pool_remapped;
+    moved += pool_moved;
+    undersized += pool_undersized;
+  }
+  f->close_section();
+  f->dump_unsigned("pgs", pgs);
+  f->dump_unsigned("pgs_remapped", remapped);
+  f->dump_unsigned("shards_moved", moved);
+  f->dump_unsigned("pgs_undersized", undersized);
+  dump_sim_balance(f, sc.map, sc.mapping, pool);
+  f->close_section();
+}
+
 void print_inc_upmaps(const OSDMap::Incremental& pending_inc, int fd, bool vstart, std::string cmd="ceph")
 {
   ostringstream ss;
@@ -181,6 +317,12 @@ int main(int argc, const char **argv)
   bool test_map_pgs_dump_all = false;
   bool save = false;
   bool vstart = false;
+  bool simulate = false;
+  bool fail_each = false;
+  std::vector<std::string> fail_osds;
+  std::vector<std::string> candidates;
+  int sim_threads = 0;
+  std::string sim_format = "json-pretty";
 
   std::string val;
   std::ostringstream err;
@@ -292,6 +434,20 @@ int main(int argc, const char **argv)
       save = true;
     } else if (ceph_argparse_flag(args, i, "--vstart", (char*)NULL)) {
       vstart = true;
+    } else if (ceph_argparse_flag(args, i, "--simulate", (char*)NULL)) {
+      simulate = true;
+    } else if (ceph_argparse_witharg(args, i, &val, "--fail-osds", (char*)NULL)) {
+      fail_osds.push_back(val);
+    } else if (ceph_argparse_flag(args, i, "--fail-each", (char*)NULL)) {
+      fail_each = true;
+    } else if (ceph_argparse_witharg(args, i, &val, "--candidate", (char*)NULL)) {
+      candidates.push_back(val);
+    } else if (ceph_argparse_witharg(args, i, &sim_threads, err, "--sim-threads", (char*)NULL)) {
+      if (!err.str().empty()) {
+        cerr << err.str() << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    } else if (ceph_argparse_witharg(args, i, &sim_format, "--sim-format", (char*)NULL)) {
     } else {
       ++i;
     }
@@ -856,6 +1012,96 @@ skip_upmap:
         cout << "size " << i << "\t" << size[i] << std::endl;
     }
   }
+  if (simulate) {
+    if (pool != -1 && !osdmap.have_pg_pool(pool)) {
+      cerr << "There is no pool " << pool << std::endl;
+      exit(1);
+    }
+    std::list<SimScenario> scenarios;
+    auto add_failure = [&](const std::string& name, const vector<int>& osds) {
+      auto& sc = scenarios.emplace_back();
+      sc.name = name;
+      sc.failed = osds;
+      sc.map.deepish_copy_from(osdmap);
+      for (auto osd : osds) {
+	sc.map.set_state(osd, sc.map.get_state(osd) & ~CEPH_OSD_UP);
+	sc.map.set_weight(osd, CEPH_OSD_OUT);
+      }
+    };
+    for (auto& spec : fail_osds) {
+      vector<int> osds;
+      for_each_substr(spec, ",", [&](auto s) {
+	std::string interr;
+	int osd = strict_strtol(std::string(s).c_str(), 10, &interr);
+	if (!interr.empty() || !osdmap.exists(osd)) {
+	  cerr << me << ": bad osd '" << s << "' in --fail-osds" << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+	osds.push_back(osd);
+      });
+      add_failure("fail " + spec, osds);
+    }
+    if (fail_each) {
+      for (int osd = 0; osd < osdmap.get_max_osd(); ++osd) {
+	if (osdmap.is_up(osd) && osdmap.is_in(osd)) {
+	  add_failure("fail " + stringify(osd), {osd});
+	}
+      }
+    }
+    for (auto& fn : candidates) {
+      bufferlist cbl;
+      std::string error;
+      if (cbl.read_file(fn.c_str(), &error) < 0) {
+	cerr << me << ": couldn't open " << fn << ": " << error << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      auto& sc = scenarios.emplace_back();
+      sc.name = fn;
+      try {
+	sc.map.decode(cbl);
+      } catch (const buffer::error &e) {
+	cerr << me << ": error decoding osdmap '" << fn << "'" << std::endl;
+	exit(EXIT_FAILURE);
+      }
+    }
+
+    if (sim_threads <= 0)
+      sim_threads = std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool tp(g_ceph_context, "osdmaptool::simulate", "tp_simulate",
+		  sim_threads);
+    tp.start();
+    ParallelPGMapper mapper(g_ceph_context, &tp);
+    const unsigned pgs_per_item = 128;
+    OSDMapMapping base_mapping;
+    base_mapping.start_update(osdmap, mapper, pgs_per_item)->wait();
+
+    boost::scoped_ptr<Formatter> f(Formatter::create(sim_format, "json-pretty",
+						     "json-pretty"));
+    f->open_object_section("simulation");
+    f->dump_int("threads", sim_threads);
+    f->open_object_section("base");
+    dump_sim_balance(f.get(), osdmap, base_mapping, pool);
+    f->close_section();
+    f->open_array_section("scenarios");
+    // map as many scenarios at once as there are threads, so that small
+    // pools still keep them busy, but no more, to bound the memory used
+    for (auto p = scenarios.begin(); p != scenarios.end(); ) {
+      auto end = p;
+      for (int n = 0; n < sim_threads && end != scenarios.end(); ++n, ++end) {
+	end->job = end->mapping.start_update(end->map, mapper, pgs_per_item);
+      }
+      for (; p != end; p = scenarios.erase(p)) {
+	p->job->wait();
+	p->elapsed = p->job->get_duration();
+	dump_sim_scenario(f.get(), osdmap, base_mapping, *p, pool);
+      }
+    }
+    f->close_section();
+    f->close_section();
+    f->flush(cout);
+    cout << std::endl;
+    tp.stop();
+  }
   if (test_crush) {
     int pass = 0;
     while (1) {
@@ -891,7 +1137,8 @@ skip_upmap:
       export_crush.empty() && import_crush.empty() && 
       test_map_pg.empty() && test_map_object.empty() &&
       !test_map_pgs && !test_map_pgs_dump && !test_map_pgs_dump_all &&
-      adjust_crush_weight.empty() && !upmap && !upmap_cleanup && !read) {
+      adjust_crush_weight.empty() && !upmap && !upmap_cleanup && !read &&
+      !simulate) {
     cerr << me << ": no action specified?" << std::endl;
     usage();
   }
@@ -120,7 +120,7 @@ void usage(ostream& out)
 "   rollback <obj-name> <snap-name>  roll back object to snap <snap-name>\n"
 "\n"
 "   listsnaps <obj-name>             list the snapshots of this object\n"
-"   bench <seconds> write|seq|rand [-t concurrent_operations] [--no-cleanup] [--run-name run_name] [--no-hints] [--reuse-bench]\n"
+"   bench <seconds> write|seq|rand [-t concurrent_operations] [--no-cleanup] [--run-name run_name] [--no-hints] [--reuse-bench] [--rate ops_per_sec]\n"
 "                                    default is 16 concurrent IOs and 4 MB ops\n"
 "                                    default is to clean up after write benchmark\n"
 "                                    default run-name is 'benchmark_last_metadata'\n"
@@ -239,6 +239,8 @@ void usage(ostream& out)
 "        Set number of concurrent I/O operations\n"
 "   --show-time\n"
 "        prefix output with date/time\n"
+"   --rate=N\n"
+"        issue N ops/sec (open loop) instead of keeping -t ops in flight\n"
 "   --no-verify\n"
 "        do not verify contents of read objects\n"
 "   --write-object\n"
@@ -1885,6 +1887,7 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
   bool cleanup = true;
   bool hints = true; // for rados bench
   bool reuse_bench = false;
+  double bench_rate = 0;
   bool no_verify = false;
   bool use_striper = false;
   bool with_clones = false;
@@ -2077,6 +2080,15 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
   if (i != opts.end()) {
     reuse_bench = true;
   }
+  i = opts.find("rate");
+  if (i != opts.end()) {
+    char *endptr = NULL;
+    bench_rate = strtod(i->second.c_str(), &endptr);
+    if (*endptr || bench_rate < 0) {
+      cerr << "Invalid value for rate: '" << i->second << "'" << std::endl;
+      return -EINVAL;
+    }
+  }
   i = opts.find("pretty-format");
   if (i != opts.end()) {
     pretty_format = true;
@@ -3304,6 +3316,7 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
     }
     RadosBencher bencher(g_ceph_context, rados, io_ctx);
     bencher.set_show_time(show_time);
+    bencher.set_target_rate(bench_rate);
     bencher.set_write_destination(static_cast<OpWriteDest>(bench_write_dest));
 
     ostream *outstream = NULL;
@@ -4110,6 +4123,8 @@ int main(int argc, const char **argv)
       opts["reuse-bench"] = "true";
     } else if (ceph_argparse_flag(args, i, "--no-verify", (char*)NULL)) {
       opts["no-verify"] = "true";
+    } else if (ceph_argparse_witharg(args, i, &val, "--rate", (char*)NULL)) {
+      opts["rate"] = val;
     } else if (ceph_argparse_witharg(args, i, &val, "--run-name", (char*)NULL)) {
       opts["run-name"] = val;
     } else if (ceph_argparse_witharg(args, i, &val, "--prefix", (char*)NULL)) {
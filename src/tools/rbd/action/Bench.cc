@@ -11,7 +11,11 @@
 #include "global/signal_handler.h"
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <vector>
+#include <sys/resource.h>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
 #include <boost/accumulators/statistics/rolling_sum.hpp>
@@ -105,12 +109,84 @@ void validate(boost::any& v, const std::vector<std::string>& values,
 
 } // anonymous namespace
 
+// log-linear histogram of IO latencies in microseconds: each power of two
+// is split into 2^SUB_BITS linear buckets, so reported percentiles are
+// within about 3% of the real value
+class LatencyHistogram {
+public:
+  void add(uint64_t usec) {
+    ++buckets[index(usec)];
+    ++count;
+    sum += usec;
+    min = std::min(min, usec);
+    max = std::max(max, usec);
+  }
+
+  uint64_t get_count() const {
+    return count;
+  }
+
+  void dump(std::ostream& os) const {
+    if (count == 0) {
+      return;
+    }
+    os << "min: " << min << "   "
+       << "avg: " << sum / count << "   "
+       << "max: " << max << std::endl << "  ";
+    for (auto p : {50.0, 90.0, 99.0, 99.9, 99.99}) {
+      os << " p" << p << ": " << percentile(p);
+    }
+    os << std::endl;
+  }
+
+private:
+  static constexpr unsigned SUB_BITS = 5;
+  static constexpr unsigned SUB = 1 << SUB_BITS;
+
+  std::vector<uint64_t> buckets = std::vector<uint64_t>(64 * SUB);
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t min = std::numeric_limits<uint64_t>::max();
+  uint64_t max = 0;
+
+  static unsigned index(uint64_t v) {
+    if (v < SUB) {
+      return v;
+    }
+    unsigned shift = 63 - __builtin_clzll(v) - SUB_BITS;
+    return (shift + 1) * SUB + ((v >> shift) - SUB);
+  }
+
+  // largest value that maps to bucket idx
+  static uint64_t upper_bound(unsigned idx) {
+    if (idx < SUB) {
+      return idx;
+    }
+    unsigned shift = idx / SUB - 1;
+    uint64_t base = idx % SUB + SUB;
+    return ((base + 1) << shift) - 1;
+  }
+
+  uint64_t percentile(double p) const {
+    uint64_t target = std::max<uint64_t>(1, std::ceil(p / 100 * count));
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < buckets.size(); ++i) {
+      seen += buckets[i];
+      if (seen >= target) {
+        return std::min(upper_bound(i), max);
+      }
+    }
+    return max;
+  }
+};
+
 static void rbd_bencher_completion(void *c, void *pc);
 struct rbd_bencher;
 
 struct bencher_completer {
   rbd_bencher *bencher;
   bufferlist *bl;
+  ceph::mono_time start = ceph::mono_clock::now();
 
 public:
   bencher_completer(rbd_bencher *bencher, bufferlist *bl)
@@ -132,6 +208,8 @@ struct rbd_bencher {
   io_type_t io_type;
   uint64_t io_size;
   bufferlist write_bl;
+  LatencyHistogram read_latency;
+  LatencyHistogram write_latency;
 
   explicit rbd_bencher(librbd::Image *i, io_type_t io_type, uint64_t io_size)
     : image(i),
@@ -177,6 +255,16 @@ struct rbd_bencher {
 
 };
 
+// user plus system CPU time used by this process so far
+static double get_cpu_seconds() {
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) < 0) {
+    return 0;
+  }
+  return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+         (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000000.0;
+}
+
 void rbd_bencher_completion(void *vc, void *pc)
 {
   librbd::RBD::AioCompletion *c = (librbd::RBD::AioCompletion *)vc;
@@ -191,7 +279,14 @@ void rbd_bencher_completion(void *vc, void *pc)
     std::cout << "read error: " << cpp_strerror(ret) << std::endl;
     exit(ret < 0 ? -ret : ret);
   }
+  auto usec = std::chrono::duration_cast<std::chrono::microseconds>(
+    ceph::mono_clock::now() - bc->start).count();
   b->lock.lock();
+  if (bc->bl != nullptr) {
+    b->read_latency.add(usec);
+  } else {
+    b->write_latency.add(usec);
+  }
   b->in_flight--;
   b->cond.notify_all();
   b->lock.unlock();
@@ -264,6 +359,7 @@ int do_bench(librbd::Image& image, io_type_t io_type,
   srand(time(NULL) % (unsigned long) -1);
 
   coarse_mono_time start = coarse_mono_clock::now();
+  double cpu_start = get_cpu_seconds();
   std::chrono::duration<double> last = std::chrono::duration<double>::zero();
   uint64_t ios = 0;
 
@@ -410,12 +506,27 @@ int do_bench(librbd::Image& image, io_type_t io_type,
 
   coarse_mono_time now = coarse_mono_clock::now();
   std::chrono::duration<double> elapsed = now - start;
+  double cpu = get_cpu_seconds() - cpu_start;
 
   std::cout << "elapsed: " << (int)elapsed.count() << "   "
             << "ops: " << ios << "   "
             << "ops/sec: " << (double)ios / elapsed.count() << "   "
             << "bytes/sec: " << byte_u_t((double)off / elapsed.count()) << "/s"
             << std::endl;
+  if (ios > 0) {
+    std::cout << "cpu: " << cpu << "s   "
+              << "cpu/op: " << cpu * 1000000 / ios << "us"
+              << std::endl;
+  }
+
+  if (b.read_latency.get_count() > 0) {
+    std::cout << (io_type == IO_TYPE_RW ? "read " : "") << "latency (us): ";
+    b.read_latency.dump(std::cout);
+  }
+  if (b.write_latency.get_count() > 0) {
+    std::cout << (io_type == IO_TYPE_RW ? "write " : "") << "latency (us): ";
+    b.write_latency.dump(std::cout);
+  }
 
   if (io_type == IO_TYPE_RW) {
   std::cout << "read_ops: " << read_ops << "   "
@@ -49,6 +49,7 @@
 #include <iostream>
 #include <memory>
 #include <regex>
+#include <vector>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -281,7 +282,9 @@ private:
     cond.notify_all();
   }
 
-  IOContext *wait_io_finish()
+  // grab everything that has completed so far so that the replies can be
+  // sent with a single writev
+  bool wait_io_finish(std::vector<std::unique_ptr<IOContext>> *ctxs)
   {
     std::unique_lock l{lock};
     cond.wait(l, [this] {
@@ -289,13 +292,12 @@ private:
                           (io_pending.empty() && terminated);
                  });
 
-    if (io_finished.empty())
-      return NULL;
-
-    IOContext *ret = io_finished.front();
-    io_finished.pop_front();
+    while (!io_finished.empty()) {
+      ctxs->emplace_back(io_finished.front());
+      io_finished.pop_front();
+    }
 
-    return ret;
+    return !ctxs->empty();
   }
 
   void wait_clean()
@@ -474,31 +476,34 @@ signal:
 
   void writer_entry()
   {
+    std::vector<std::unique_ptr<IOContext>> ctxs;
     while (true) {
       dout(20) << __func__ << ": waiting for io request" << dendl;
-      std::unique_ptr<IOContext> ctx(wait_io_finish());
-      if (!ctx) {
+      ctxs.clear();
+      if (!wait_io_finish(&ctxs)) {
 	dout(20) << __func__ << ": no io requests, terminating" << dendl;
         goto done;
       }
 
-      dout(20) << __func__ << ": got: " << *ctx << dendl;
+      bufferlist bl;
+      for (auto &ctx : ctxs) {
+        dout(20) << __func__ << ": got: " << *ctx << dendl;
+        bl.append(reinterpret_cast<const char *>(&ctx->reply),
+                  sizeof(struct nbd_reply));
+        if (ctx->command == NBD_CMD_READ && ctx->reply.error == htonl(0)) {
+          bl.claim_append(ctx->data);
+        }
+      }
 
-      int r = safe_write(fd, &ctx->reply, sizeof(struct nbd_reply));
+      int r = bl.write_fd(fd);
       if (r < 0) {
-	derr << *ctx << ": failed to write reply header: " << cpp_strerror(r)
-	     << dendl;
+	derr << "failed to write " << ctxs.size() << " replies: "
+	     << cpp_strerror(r) << dendl;
         goto error;
       }
-      if (ctx->command == NBD_CMD_READ && ctx->reply.error == htonl(0)) {
-	r = ctx->data.write_fd(fd);
-        if (r < 0) {
-	  derr << *ctx << ": failed to write replay data: " << cpp_strerror(r)
-	       << dendl;
-          goto error;
-	}
+      for (auto &ctx : ctxs) {
+        dout(20) << *ctx << ": finish" << dendl;
       }
-      dout(20) << *ctx << ": finish" << dendl;
     }
   error:
     wait_clean();